@@ -0,0 +1,352 @@
+#include <tw/channel_db/sql_batch.h>
+#include <tw/common/defs.h>
+#include <tw/common_str_util/fast_stream.h>
+#include <tw/log/defs.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace tw {
+namespace channel_db {
+
+static SqlBatch::eMode s_defaultMode = SqlBatch::kPrepared;
+static uint32_t s_defaultBulkLoadMinRows = 5000;
+
+SqlBatch::SqlBatch(const std::string& verb,
+                   const std::string& table,
+                   const std::string& columns,
+                   const std::string& updateStatement) : _verb(verb),
+                                                         _table(table),
+                                                         _columnsList(columns),
+                                                         _updateStatement(updateStatement),
+                                                         _mode(kPrepared),
+                                                         _hasMode(false) {
+    clear();
+}
+
+void SqlBatch::clear() {
+    // Values' storage is kept to be reused by next batch
+    //
+    _size = 0;
+    _rows = 0;
+    _columns = 0;
+}
+
+void SqlBatch::setDefaults(eMode mode, uint32_t bulkLoadMinRows) {
+    s_defaultMode = mode;
+    s_defaultBulkLoadMinRows = bulkLoadMinRows;
+}
+
+bool SqlBatch::setDefaults(const tw::common::Settings& settings) {
+    eMode mode = kPrepared;
+    if ( !parseMode(settings._db_write_mode, mode) ) {
+        LOGGER_ERRO << "Invalid db.write_mode: " << settings._db_write_mode << "\n";
+        return false;
+    }
+
+    setDefaults(mode, settings._db_bulk_load_min_rows);
+    LOGGER_INFO << "db.write_mode: " << modeToString(mode) << ", db.bulk_load_min_rows: " << settings._db_bulk_load_min_rows << "\n";
+    return true;
+}
+
+SqlBatch::eMode SqlBatch::defaultMode() {
+    return s_defaultMode;
+}
+
+uint32_t SqlBatch::defaultBulkLoadMinRows() {
+    return s_defaultBulkLoadMinRows;
+}
+
+bool SqlBatch::parseMode(const std::string& value, eMode& mode) {
+    std::string v = std::to_lower(value);
+    if ( v == "text" ) {
+        mode = kText;
+        return true;
+    }
+
+    if ( v == "prepared" ) {
+        mode = kPrepared;
+        return true;
+    }
+
+    if ( v == "bulk" ) {
+        mode = kBulkLoad;
+        return true;
+    }
+
+    return false;
+}
+
+const char* SqlBatch::modeToString(eMode mode) {
+    switch ( mode ) {
+        case kText:
+            return "text";
+        case kPrepared:
+            return "prepared";
+        case kBulkLoad:
+            return "bulk";
+    }
+
+    return "";
+}
+
+void SqlBatch::execute(ChannelDb::TStatementPtr& statement) {
+    if ( 0 == _rows )
+        return;
+
+    if ( !statement )
+        throw std::runtime_error("statement is NULL");
+
+    if ( _size != static_cast<size_t>(columns())*_rows )
+        throw std::runtime_error("inconsistent number of values in rows of: " + _table);
+
+    switch ( mode() ) {
+        case kText:
+            executeText(statement);
+            break;
+        case kBulkLoad:
+            if ( isBulkLoad() && executeBulkLoad(statement) )
+                break;
+
+            executePrepared(statement);
+            break;
+        case kPrepared:
+        default:
+            executePrepared(statement);
+            break;
+    }
+}
+
+bool SqlBatch::isBulkLoad() const {
+    return (kBulkLoad == mode() && _verb == "REPLACE" && _updateStatement.empty() && _rows > 0 && _rows >= defaultBulkLoadMinRows());
+}
+
+std::string SqlBatch::toString() const {
+    std::stringstream sql;
+    sql << header();
+
+    uint32_t cols = columns();
+    for ( uint32_t row = 0; row < _rows; ++row ) {
+        if ( row > 0 )
+            sql << ",";
+
+        sql << "(";
+        for ( uint32_t col = 0; col < cols; ++col ) {
+            if ( col > 0 )
+                sql << ",";
+
+            sql << textValue(_values[row*cols+col]);
+        }
+        sql << ")";
+    }
+
+    sql << footer();
+    return sql.str();
+}
+
+std::string SqlBatch::header() const {
+    return _verb + " INTO " + _table + " (" + _columnsList + ") VALUES ";
+}
+
+std::string SqlBatch::footer() const {
+    if ( _updateStatement.empty() )
+        return _updateStatement;
+
+    return " " + _updateStatement;
+}
+
+std::string SqlBatch::placeholders(uint32_t rows) const {
+    std::string row = "(";
+    for ( uint32_t col = 0; col < columns(); ++col ) {
+        if ( col > 0 )
+            row += ",";
+
+        row += "?";
+    }
+    row += ")";
+
+    std::string s;
+    s.reserve(rows*(row.size()+1));
+    for ( uint32_t i = 0; i < rows; ++i ) {
+        if ( i > 0 )
+            s += ",";
+
+        s += row;
+    }
+
+    return s;
+}
+
+std::string SqlBatch::textValue(const TValue& v) const {
+    if ( v._isDouble )
+        return "'" + std::replace_all(tw::common_str_util::to_string(v._double), "'", "\\'") + "'";
+
+    return "'" + std::replace_all(v._string, "'", "\\'") + "'";
+}
+
+void SqlBatch::executeText(ChannelDb::TStatementPtr& statement) {
+    statement->execute(toString());
+}
+
+void SqlBatch::getStatementsRows(uint32_t rows, uint32_t cols, TStatementsRows& statementsRows) {
+    statementsRows.clear();
+
+    uint32_t batchRows = kMaxRowsPerStatement;
+    if ( cols > 0 && batchRows*cols > kMaxParamsPerStatement )
+        batchRows = kMaxParamsPerStatement/cols;
+
+    if ( 0 == batchRows )
+        batchRows = 1;
+
+    for ( ; rows >= batchRows; rows -= batchRows )
+        statementsRows.push_back(batchRows);
+
+    // Remainder is less than batchRows, so it's the sum of distinct
+    // powers of 2, which aren't greater than batchRows
+    //
+    uint32_t count = 1;
+    while ( count*2 <= batchRows )
+        count <<= 1;
+
+    for ( ; rows > 0; count >>= 1 ) {
+        if ( rows >= count ) {
+            statementsRows.push_back(count);
+            rows -= count;
+        }
+    }
+}
+
+sql::PreparedStatement& SqlBatch::getPrepared(ChannelDb::TStatementPtr& statement, uint32_t rows) {
+    if ( _preparedStatement.lock() != statement ) {
+        _prepared.clear();
+        _preparedStatement = statement;
+    }
+
+    TPreparedStatementPtr& prepared = _prepared[rows];
+    if ( !prepared ) {
+        sql::Connection* connection = statement->getConnection();
+        if ( !connection )
+            throw std::runtime_error("connection is NULL");
+
+        prepared = TPreparedStatementPtr(connection->prepareStatement(header() + placeholders(rows) + footer()));
+    }
+
+    return *prepared;
+}
+
+void SqlBatch::bindRows(sql::PreparedStatement& prepared, uint32_t firstRow, uint32_t rows) {
+    uint32_t cols = columns();
+    size_t first = static_cast<size_t>(firstRow)*cols;
+    size_t last = first + static_cast<size_t>(rows)*cols;
+    for ( size_t i = first; i < last; ++i ) {
+        const TValue& v = _values[i];
+        unsigned int index = static_cast<unsigned int>(i-first+1);
+        if ( v._isDouble )
+            prepared.setDouble(index, v._double);
+        else
+            prepared.setString(index, v._string);
+    }
+}
+
+void SqlBatch::executePrepared(ChannelDb::TStatementPtr& statement) {
+    getStatementsRows(_rows, columns(), _statementsRows);
+
+    uint32_t row = 0;
+    for ( size_t i = 0; i < _statementsRows.size(); ++i ) {
+        uint32_t rows = _statementsRows[i];
+        sql::PreparedStatement& prepared = getPrepared(statement, rows);
+        bindRows(prepared, row, rows);
+        prepared.executeUpdate();
+        row += rows;
+    }
+}
+
+// Rows are written in LOAD DATA's default format: tab separated fields,
+// '\n' terminated lines and '\' escapes
+//
+static void writeEscaped(FILE* file, const std::string& value) {
+    for ( size_t i = 0; i < value.size(); ++i ) {
+        char c = value[i];
+        switch ( c ) {
+            case '\\':
+                fputs("\\\\", file);
+                break;
+            case '\t':
+                fputs("\\t", file);
+                break;
+            case '\n':
+                fputs("\\n", file);
+                break;
+            case '\r':
+                fputs("\\r", file);
+                break;
+            case '\0':
+                fputs("\\0", file);
+                break;
+            default:
+                fputc(c, file);
+                break;
+        }
+    }
+}
+
+bool SqlBatch::executeBulkLoad(ChannelDb::TStatementPtr& statement) {
+    char fileName[] = "/tmp/tw_sql_batch_XXXXXX";
+    int fd = ::mkstemp(fileName);
+    if ( fd < 0 ) {
+        LOGGER_WARN << "Failed to create temp file for bulk load of: " << _table << "\n";
+        return false;
+    }
+
+    FILE* file = ::fdopen(fd, "w");
+    if ( !file ) {
+        ::close(fd);
+        ::unlink(fileName);
+        LOGGER_WARN << "Failed to open temp file for bulk load of: " << _table << "\n";
+        return false;
+    }
+
+    uint32_t cols = columns();
+    for ( uint32_t row = 0; row < _rows; ++row ) {
+        for ( uint32_t col = 0; col < cols; ++col ) {
+            if ( col > 0 )
+                fputc('\t', file);
+
+            const TValue& v = _values[row*cols+col];
+            if ( v._isDouble )
+                writeEscaped(file, tw::common_str_util::to_string(v._double));
+            else
+                writeEscaped(file, v._string);
+        }
+        fputc('\n', file);
+    }
+
+    bool status = (0 == ::fflush(file)) && !::ferror(file);
+    ::fclose(file);
+
+    if ( status ) {
+        std::string sql = std::string("LOAD DATA LOCAL INFILE '") + fileName + "' "
+                        + "REPLACE INTO TABLE " + _table + " (" + _columnsList + ")";
+        try {
+            statement->execute(sql);
+            if ( statement->getWarnings() ) {
+                status = false;
+                LOGGER_WARN << "Bulk load reported warnings for: " << _table << " - rewriting with prepared statements" << "\n";
+            }
+        } catch(const std::exception& e) {
+            status = false;
+            LOGGER_WARN << "Bulk load failed for: " << _table << " - " << e.what() << "\n";
+        }
+    } else {
+        LOGGER_WARN << "Failed to write temp file for bulk load of: " << _table << "\n";
+    }
+
+    ::unlink(fileName);
+    return status;
+}
+
+} // namespace channel_db
+} // namespace tw
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <tw/channel_db/channel_db.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace tw {
+namespace channel_db {
+
+// Accumulates rows of a generated INSERT/REPLACE query and writes them to
+// db in one of the following modes:
+//
+//  kText - one multi-row text statement with quoted values (legacy path)
+//  kPrepared - server-side prepared multi-row statements, values are bound
+//      as parameters. Rows are split into statements of up to
+//      kMaxRowsPerStatement rows and the remainder into statements of
+//      power of 2 rows (e.g. 100 rows as 64+32+4), so that each of at
+//      most 9 sizes is prepared once per connection and reused by every
+//      flush, whatever its number of rows
+//  kBulkLoad - rows of REPLACE queries are streamed to a temp file and
+//      loaded with 'LOAD DATA LOCAL INFILE' if there are at least
+//      bulkLoadMinRows of them. LOCAL load skips rows with duplicate keys
+//      or bad values with warnings instead of failing, so INSERT queries,
+//      queries with UpdateStatement and smaller batches go via kPrepared
+//      path, as does a load which failed or reported warnings (REPLACE
+//      rewrites already loaded rows). Requires local_infile to be enabled
+//      on both client and server
+//
+class SqlBatch {
+public:
+    enum eMode {
+        kText,
+        kPrepared,
+        kBulkLoad
+    };
+
+    typedef boost::shared_ptr<sql::PreparedStatement> TPreparedStatementPtr;
+    typedef std::vector<uint32_t> TStatementsRows;
+
+    static const uint32_t kMaxRowsPerStatement = 256;
+    static const uint32_t kMaxParamsPerStatement = 65535;
+
+public:
+    SqlBatch(const std::string& verb,
+             const std::string& table,
+             const std::string& columns,
+             const std::string& updateStatement = "");
+
+    void clear();
+
+public:
+    // Defaults are used by batches without explicitly set mode and are set
+    // once from settings on storages' init
+    //
+    static void setDefaults(eMode mode, uint32_t bulkLoadMinRows);
+    static bool setDefaults(const tw::common::Settings& settings);
+    static eMode defaultMode();
+    static uint32_t defaultBulkLoadMinRows();
+
+    static bool parseMode(const std::string& value, eMode& mode);
+    static const char* modeToString(eMode mode);
+
+    void setMode(eMode mode) {
+        _mode = mode;
+        _hasMode = true;
+    }
+
+    eMode mode() const {
+        return _hasMode ? _mode : defaultMode();
+    }
+
+public:
+    uint32_t rows() const {
+        return _rows;
+    }
+
+    // Whether execute() writes current rows with 'LOAD DATA'
+    //
+    bool isBulkLoad() const;
+
+    // Columns' count is taken from the first row
+    //
+    void beginRow() {
+        if ( 2 == ++_rows )
+            _columns = static_cast<uint32_t>(_size);
+    }
+
+    void bind(double value) {
+        TValue& v = next();
+        v._isDouble = true;
+        v._double = value;
+        v._string.clear();
+    }
+
+    void bind(const std::string& value) {
+        TValue& v = next();
+        v._isDouble = false;
+        v._double = 0.0;
+        v._string = value;
+    }
+
+    // Throws on db errors - generated queries catch and log them
+    //
+    void execute(ChannelDb::TStatementPtr& statement);
+
+    // Text of what is executed (for logging of failures)
+    //
+    std::string toString() const;
+
+    // Numbers of rows of prepared statements, which rows of cols columns
+    // are written with in kPrepared mode
+    //
+    static void getStatementsRows(uint32_t rows, uint32_t cols, TStatementsRows& statementsRows);
+
+private:
+    struct TValue {
+        TValue() : _isDouble(false),
+                   _double(0.0) {
+        }
+
+        bool _isDouble;
+        double _double;
+        std::string _string;
+    };
+
+    typedef std::vector<TValue> TValues;
+
+private:
+    TValue& next() {
+        if ( _size == _values.size() )
+            _values.resize(_size+1);
+
+        return _values[_size++];
+    }
+
+    uint32_t columns() const {
+        return (_rows > 1) ? _columns : static_cast<uint32_t>(_size);
+    }
+
+    std::string header() const;
+    std::string footer() const;
+    std::string placeholders(uint32_t rows) const;
+    std::string textValue(const TValue& v) const;
+
+    void executeText(ChannelDb::TStatementPtr& statement);
+    void executePrepared(ChannelDb::TStatementPtr& statement);
+    bool executeBulkLoad(ChannelDb::TStatementPtr& statement);
+
+    sql::PreparedStatement& getPrepared(ChannelDb::TStatementPtr& statement, uint32_t rows);
+    void bindRows(sql::PreparedStatement& prepared, uint32_t firstRow, uint32_t rows);
+
+private:
+    std::string _verb;
+    std::string _table;
+    std::string _columnsList;
+    std::string _updateStatement;
+
+    eMode _mode;
+    bool _hasMode;
+
+    TValues _values;
+    size_t _size;
+    uint32_t _rows;
+    uint32_t _columns;
+
+    // Prepared statements by number of rows are kept for the statement
+    // (and so the connection) they were prepared with and are dropped
+    // once storage replaces it, e.g. on stop()/start(). Weak pointer
+    // isn't fooled by a new statement allocated at the old address
+    //
+    typedef std::map<uint32_t, TPreparedStatementPtr> TPreparedStatements;
+
+    boost::weak_ptr<sql::Statement> _preparedStatement;
+    TPreparedStatements _prepared;
+    TStatementsRows _statementsRows;
+};
+
+} // namespace channel_db
+} // namespace tw
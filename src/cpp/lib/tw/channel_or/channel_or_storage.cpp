@@ -5,6 +5,7 @@
 #include <tw/common_strat/strategy_container.h>
 
 #include <tw/generated/commands_common.h>
+#include <tw/common/thread_placement.h>
 
 #include <OnixS/FIXEngine.h>
 
@@ -25,6 +26,37 @@ const std::string& get_FIELDS_DELIM_REPLACEMENT() {
 bool is_STORAGE_ITEM_FIELDS_DELIM(const char c) {
     return c==STORAGE_ITEM_FIELDS_DELIM;
 }
+
+// Publishes claimed event on scope exit - failing to fill claimed event
+// must not stall the ring, such event is skipped by events thread
+//
+class EventPublisher {
+public:
+    EventPublisher(tw::common_thread::RingBuffer<ChannelOrStorageEvent>& events,
+                   ChannelOrStorageEvent* event,
+                   uint64_t pos) : _events(events),
+                                   _event(event),
+                                   _pos(pos),
+                                   _committed(false) {
+    }
+    
+    ~EventPublisher() {
+        if ( !_committed )
+            _event->_type = tw::common::eChannelOrStorageItemType::kUnknown;
+        
+        _events.publish(_pos);
+    }
+    
+    void commit() {
+        _committed = true;
+    }
+    
+private:
+    tw::common_thread::RingBuffer<ChannelOrStorageEvent>& _events;
+    ChannelOrStorageEvent* _event;
+    uint64_t _pos;
+    bool _committed;
+};
   
 uint32_t ChannelOrStorageItem::_counter = 0;
 
@@ -323,10 +355,15 @@ void ChannelOrStorage::clear() {
     _isDoneDb = false;
     _isDoneDbThread = false;
     _isDoneFile = false;
+    _isDoneEvents = false;
+    _isEventsFullAlerted = 0;
     _stopPersistingToDb = false;
+    _readFillsFromColumnStore = false;
     
     _threadDb.reset();
     _threadFile.reset();
+    _threadEvents.reset();
+    tw::common::TimerServer::clearTimerId(_timerId);
     
     _itemsCacheSize = 0;
     _itemsCache.clear();
@@ -383,6 +420,14 @@ bool ChannelOrStorage::init(const tw::common::Settings& settings) {
             return false;
         }
         
+        if ( !tw::channel_db::SqlBatch::setDefaults(settings) )
+            return false;
+        
+        if ( !settings._column_store_dir.empty() && !_columnStore.open(settings._column_store_dir) )
+            return false;
+        
+        _readFillsFromColumnStore = (settings._column_store_read_fills && _columnStore.isOpen());
+        
         if ( !_channelDb.init(settings._db_connection_str) ) {
             LOGGER_ERRO << "Failed to init channelDb with: "  << settings._db_connection_str << "\n";
             return false;
@@ -459,7 +504,13 @@ bool ChannelOrStorage::init(const tw::common::Settings& settings) {
                 return false;
         }
         
-        _threadDb = TThreadPtr(new TThread(boost::bind(&ChannelOrStorage::threadMainPersistToDb, this)));
+        _threadDb = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kStorage, boost::bind(&ChannelOrStorage::threadMainPersistToDb, this));
+        
+        _events.init(_settings._storage_events_ring_size);
+        _threadEvents = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kStorage, boost::bind(&ChannelOrStorage::threadMainEvents, this));
+        
+        if ( !tw::common::TimerServer::instance().registerClient(this, 100, false, _timerId) )
+            LOGGER_ERRO << "Failed to register with timer server - events thread's alerts are only logged" << "\n";
         
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -484,8 +535,10 @@ void ChannelOrStorage::stop() {
         if ( isStopped() )
             return;
         
+        terminateThreadEvents();
         terminateThreadDb();        
         flushDbCache();
+        reportAlerts();
         
         _isDoneFile = true;        
         
@@ -593,8 +646,31 @@ bool ChannelOrStorage::getOpenOrdersForAccount(std::vector<Order>& results, cons
     return true;
 }
 
+// Day of fills in column store is day of their timestamp1 (UTC) and not
+// of time of their db insert
+//
+bool ChannelOrStorage::getColumnStoreFillsFilter(const std::string& date, tw::common::StoreFilter& filter) {
+    int64_t from = tw::common::StoreTime::fromSqlTime(date.substr(0, 10));
+    if ( tw::common::StoreTime::kNullTime == from ) {
+        LOGGER_ERRO << "Invalid date: "  << date << "\n";
+        return false;
+    }
+    
+    filter.setTimeRange("timestamp1", from, from+tw::common::StoreTime::kMicrosInDay-1);
+    return true;
+}
+
 bool ChannelOrStorage::getFillsForDate(std::vector<Fill>& results, const std::string& date) {
     try {
+        if ( _readFillsFromColumnStore ) {
+            tw::common::StoreFilter filter;
+            if ( !getColumnStoreFillsFilter(date, filter) )
+                return false;
+            
+            results.clear();
+            return _columnStore.read("Fills", filter, results);
+        }
+        
         Fills_GetAllForDate query;
 
         if ( !query.execute(_channelDb, date) )
@@ -614,6 +690,17 @@ bool ChannelOrStorage::getFillsForDate(std::vector<Fill>& results, const std::st
 
 bool ChannelOrStorage::getFillsForAccountForDate(std::vector<Fill>& results, const tw::risk::TAccountId& accId, const std::string& date) {
     try {
+        // Account is matched by store's scan (and its zone maps)
+        //
+        if ( _readFillsFromColumnStore ) {
+            tw::common::StoreFilter filter;
+            if ( !getColumnStoreFillsFilter(date, filter) )
+                return false;
+            
+            filter.addEquals("accountId", accId);
+            return _columnStore.read("Fills", filter, results);
+        }
+        
         std::vector<Fill> r;
         if ( !getFillsForDate(r, date) )
             return false;
@@ -785,10 +872,15 @@ bool ChannelOrStorage::persist(const tw::common::Command& command) {
 
 bool ChannelOrStorage::persist(const tw::channel_or::TOrderPtr& order) {
     try {
-        TChannelOrStorageItemPtr item = getItem();
-        item->set(*order);
+        uint64_t pos = 0;
+        ChannelOrStorageEvent* event = claimEvent(pos);
+        if ( !event )
+            return false;
         
-        return doPersist(item);
+        EventPublisher publisher(_events, event, pos);
+        event->set(*order);
+        event->_timestamp = tw::common::THighResTime::now();
+        publisher.commit();
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
         return false;
@@ -802,10 +894,15 @@ bool ChannelOrStorage::persist(const tw::channel_or::TOrderPtr& order) {
 
 bool ChannelOrStorage::persist(const tw::channel_or::TOrderPtr& order, const tw::channel_or::Reject& rej) {
     try {
-        TChannelOrStorageItemPtr item = getItem();
-        item->set(*order, rej);
+        uint64_t pos = 0;
+        ChannelOrStorageEvent* event = claimEvent(pos);
+        if ( !event )
+            return false;
         
-        return doPersist(item);
+        EventPublisher publisher(_events, event, pos);
+        event->set(*order, rej);
+        event->_timestamp = tw::common::THighResTime::now();
+        publisher.commit();
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
         return false;
@@ -817,12 +914,52 @@ bool ChannelOrStorage::persist(const tw::channel_or::TOrderPtr& order, const tw:
     return true;
 }
 
+// All orders of the batch are published with the same timestamp, rejected
+// ones - with their rejects
+//
+bool ChannelOrStorage::persist(const tw::channel_or::OrdersBatch& batch) {
+    bool status = true;
+    try {
+        tw::common::THighResTime now = tw::common::THighResTime::now();
+        for ( size_t i = 0; i < batch.size(); ++i ) {
+            uint64_t pos = 0;
+            ChannelOrStorageEvent* event = claimEvent(pos);
+            if ( !event ) {
+                status = false;
+                continue;
+            }
+            
+            EventPublisher publisher(_events, event, pos);
+            if ( batch._rejected[i] )
+                event->set(*(batch._orders[i]), batch._rejs[i]);
+            else
+                event->set(*(batch._orders[i]));
+            
+            event->_timestamp = now;
+            publisher.commit();
+        }
+    } catch(const std::exception& e) {        
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        return false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        return false;
+    }
+    
+    return status;
+}
+
 bool ChannelOrStorage::persist(const tw::channel_or::Fill& fill) {
     try {
-        TChannelOrStorageItemPtr item = getItem();
-        item->set(fill);
+        uint64_t pos = 0;
+        ChannelOrStorageEvent* event = claimEvent(pos);
+        if ( !event )
+            return false;
         
-        return doPersist(item);
+        EventPublisher publisher(_events, event, pos);
+        event->set(fill);
+        event->_timestamp = tw::common::THighResTime::now();
+        publisher.commit();
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
         return false;
@@ -902,10 +1039,70 @@ bool ChannelOrStorage::persist(const tw::channel_or::PnLAuditTrailInfo& pnlAudit
     return true;
 }
 
-bool ChannelOrStorage::doPersist(const TChannelOrStorageItemPtr& item) {
-    try {
-        tw::common::THighResTime now = tw::common::THighResTime::now();
+ChannelOrStorageEvent* ChannelOrStorage::claimEvent(uint64_t& pos) {
+    if ( !_threadEvents || _isDoneEvents || !isValid() ) {
+        LOGGER_ERRO << "Can't persist event - storage is not started" << "\n";
+        return NULL;
+    }
+    
+    ChannelOrStorageEvent* event = _events.claim(pos);
+    if ( event )
+        return event;
+    
+    // Events thread fell behind - wait for it rather than drop or reorder
+    // order's transitions. Alert is raised once by whichever producer
+    // gets here first and re-armed by events thread once ring drains
+    //
+    if ( __sync_bool_compare_and_swap(&_isEventsFullAlerted, 0, 1) ) {
+        tw::channel_or::Alert alert;
+        alert._type = tw::channel_or::eAlertType::kChannelDbMaxQueueSize;
+        alert._text = "ChannelOrStorage exceeded events ring's size of: " + boost::lexical_cast<std::string>(_events.capacity());
+        tw::common_strat::ConsumerProxy::instance().onAlert(alert);
+    }
+    
+    while ( !_isDoneEvents ) {
+        event = _events.claim(pos);
+        if ( event )
+            return event;
+        
+        tw::common_thread::cpuRelax();
+    }
+    
+    return NULL;
+}
+
+uint32_t ChannelOrStorage::processEvents() {
+    uint32_t count = 0;
+    
+    ChannelOrStorageEvent* event = NULL;
+    while ( NULL != (event = _events.front()) ) {
+        try {
+            if ( tw::common::eChannelOrStorageItemType::kUnknown != event->_type ) {
+                TChannelOrStorageItemPtr item = getItem();
+                event->get(*item);
+                doPersist(item, event->_timestamp);
+            }
+        } catch(const std::exception& e) {        
+            LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        } catch(...) {
+            LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        }
         
+        event->release();
+        _events.pop();
+        ++count;
+    }
+    
+    if ( count > 0 && _isEventsFullAlerted && _events.size() < _events.capacity()/2 ) {
+        if ( __sync_bool_compare_and_swap(&_isEventsFullAlerted, 1, 0) )
+            LOGGER_WARN << "ChannelOrStorage's events ring drained below half of: " << _events.capacity() << "\n";
+    }
+    
+    return count;
+}
+
+bool ChannelOrStorage::doPersist(const TChannelOrStorageItemPtr& item, const tw::common::THighResTime& now) {
+    try {
         if ( !isValid() ) {
             LOGGER_ERRO << "Can't persist item: " << item->toString() << "\n";
             return false;
@@ -953,7 +1150,7 @@ bool ChannelOrStorage::doPersist(const TChannelOrStorageItemPtr& item) {
             alert._type = tw::channel_or::eAlertType::kChannelDbMaxQueueSize;
             alert._text = "ChannelOrStorage_Db exceeded FILE storage's max queue size of: " + boost::lexical_cast<std::string>(_settings._storage_max_queue_size_file);
             alert._text += " ==> Can't persist to either db or file item: " + item->toString();
-            tw::common_strat::ConsumerProxy::instance().onAlert(alert);
+            raiseAlert(alert);
             
             return false;
         }
@@ -966,7 +1163,7 @@ bool ChannelOrStorage::doPersist(const TChannelOrStorageItemPtr& item) {
         tw::channel_or::Alert alert;
         alert._type = tw::channel_or::eAlertType::kChannelDbMaxQueueSize;
         alert._text = "ChannelOrStorage_Db exceeded FILE storage's max queue size of: " + boost::lexical_cast<std::string>(_settings._storage_max_queue_size_file);
-        tw::common_strat::ConsumerProxy::instance().onAlert(alert);
+        raiseAlert(alert);
             
         _threadPipeFile.push(item);        
         startThreadPersistToFile("doPersist(): failed to persist to db");
@@ -1189,6 +1386,7 @@ bool ChannelOrStorage::doFlushToDb() {
             }
             
             _connection->commit();
+            appendToColumnStore(count);
             
             _statsPersistedDb._counterCommands += _commandsLog_SaveCommandLog.count();
             _statsPersistedDb._counterFills += _fills_SaveFill.count();
@@ -1213,6 +1411,36 @@ bool ChannelOrStorage::doFlushToDb() {
     return true;
 }
 
+void ChannelOrStorage::appendToColumnStore(size_t count) {
+    if ( !_columnStore.isOpen() )
+        return;
+    
+    std::vector<Fill> fills;
+    std::vector<PnLAuditTrailInfo> pnlAuditTrailInfos;
+    for ( size_t i = 0; i < count; ++i ) {
+        const TChannelOrStorageItemPtr& item = _itemsCache[i];
+        switch ( item->_type ) {
+            case tw::common::eChannelOrStorageItemType::kFill:
+                fills.push_back(item->_fill);
+                break;
+            case tw::common::eChannelOrStorageItemType::kPnLAuditTrailInfo:
+                pnlAuditTrailInfos.push_back(item->_pnlAuditTrailInfo);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // Db is the system of record - failures are logged and don't fail
+    // the flush
+    //
+    if ( !_columnStore.append("Fills", "timestamp1", fills) )
+        LOGGER_ERRO << "Failed to append fills to column store: "  << fills.size() << "\n";
+    
+    if ( !_columnStore.append("PnLAuditTrail", "eventTimestamp", pnlAuditTrailInfos) )
+        LOGGER_ERRO << "Failed to append pnl audit trail to column store: "  << pnlAuditTrailInfos.size() << "\n";
+}
+
 void ChannelOrStorage::sendToMsgBus(const TChannelOrStorageItemPtr& item) {
     try {
         if ( item->_isSendToMsgBus )
@@ -1236,7 +1464,7 @@ void ChannelOrStorage::sendToMsgBus(const TChannelOrStorageItemPtr& item) {
         }
         
         cmnd._type = tw::common::eCommandType::kChannelOr;
-        tw::common_strat::StrategyContainer::instance().sendToAllMsgBusConnections(cmnd.toString()+"\n");
+        tw::common_strat::StrategyContainer::instance().sendToAllMsgBusConnections(cmnd);
         item->_isSendToMsgBus = true;
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -1431,6 +1659,57 @@ void ChannelOrStorage::terminateThreadDb() {
     return;
 }
 
+void ChannelOrStorage::terminateThreadEvents() {
+    LOGGER_INFO << "Started to terminate threadEvents" << "\n";
+    
+    try {
+        // Events thread drains the ring before exiting
+        //
+        _isDoneEvents = true;
+        
+        if ( _threadEvents ) {
+            _threadEvents->join();
+            _threadEvents.reset();
+        }
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+    
+    LOGGER_INFO << "Finished terminating threadEvents" << "\n";
+}
+
+void ChannelOrStorage::threadMainEvents() {
+    LOGGER_INFO << "Started" << "\n";
+    
+    isEventsThread() = true;
+    try {
+        while ( true ) {
+            bool isDone = _isDoneEvents;
+            if ( processEvents() > 0 )
+                continue;
+            
+            if ( isDone )
+                break;
+            
+            // Events are off critical path - unless configured to busy
+            // poll, check for new ones every 1 ms
+            //
+            if ( tw::common_thread::currentThreadBusyPoll() )
+                tw::common_thread::cpuRelax();
+            else
+                tw::common_thread::sleep(1);
+        }
+    } catch(const std::exception& e) {        
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+    
+    LOGGER_INFO << "Finished" << "\n";
+}
+
 void ChannelOrStorage::threadMainPersistToDb() {
     LOGGER_INFO << "Started" << "\n";
     
@@ -1520,14 +1799,14 @@ void ChannelOrStorage::startThreadPersistToFile(const std::string& reason) {
             if ( _threadFile.get() != NULL )
                 return;
             
-            _threadFile = TThreadPtr(new TThread(boost::bind(&ChannelOrStorage::threadMainPersistToFile, this)));
+            _threadFile = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kStorage, boost::bind(&ChannelOrStorage::threadMainPersistToFile, this));
         }
         
         tw::channel_or::Alert alert;
         alert._type = tw::channel_or::eAlertType::kChannelDbMaxQueueSize;
         alert._text = reason + ":: ChannelOrStorage_Db - starting to persist to file instead of db";
 
-        tw::common_strat::ConsumerProxy::instance().onAlert(alert);
+        raiseAlert(alert);
         LOGGER_ERRO << "Alert: "  << alert.toString() << "\n" << "\n";
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -1536,5 +1815,50 @@ void ChannelOrStorage::startThreadPersistToFile(const std::string& reason) {
     }
 }
 
+void ChannelOrStorage::raiseAlert(const tw::channel_or::Alert& alert) {
+    if ( !isEventsThread() ) {
+        tw::common_strat::ConsumerProxy::instance().onAlert(alert);
+        return;
+    }
+    
+    // Lock for thread synchronization
+    //
+    tw::common_thread::LockGuard<TLock> lock(_alertsLock);
+    if ( _alerts.size() < MAX_PENDING_ALERTS )
+        _alerts.push_back(alert);
+    else
+        LOGGER_ERRO << "Dropped alert - too many pending: "  << alert.toString() << "\n" << "\n";
+}
+
+void ChannelOrStorage::reportAlerts() {
+    std::vector<tw::channel_or::Alert> alerts;
+    {
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_alertsLock);
+        alerts.swap(_alerts);
+    }
+    
+    for ( size_t i = 0; i < alerts.size(); ++i )
+        tw::common_strat::ConsumerProxy::instance().onAlert(alerts[i]);
+}
+
+bool ChannelOrStorage::onTimeout(const tw::common::TTimerId& id) {
+    try {
+        // Registration of previous init() - cancel it
+        //
+        if ( id != _timerId )
+            return false;
+        
+        reportAlerts();
+    } catch(const std::exception& e) {        
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+    
+    return true;
+}
+
 } // namespace channel_or
 } // namespace tw
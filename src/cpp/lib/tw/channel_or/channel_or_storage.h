@@ -4,13 +4,18 @@
 #include <tw/common/pool.h>
 #include <tw/common/singleton.h>
 #include <tw/common/filesystem.h>
+#include <tw/common/column_store.h>
+#include <tw/common/timer_server.h>
 #include <tw/common_thread/locks.h>
 #include <tw/common_thread/thread.h>
 #include <tw/common_thread/thread_pipe.h>
+#include <tw/common_thread/ring_buffer.h>
 #include <tw/generated/channel_or_defs.h>
 #include <tw/generated/enums_common.h>
 #include <tw/channel_or/settings.h>
+#include <tw/channel_or/processor.h>
 #include <tw/channel_db/channel_db.h>
+#include <tw/channel_db/sql_batch.h>
 
 #include <boost/algorithm/string.hpp>
 
@@ -87,6 +92,73 @@ struct ChannelOrStorageItem {
 
 typedef boost::shared_ptr<ChannelOrStorageItem> TChannelOrStorageItemPtr;
 
+// Order path's persistence event - preallocated slot of ChannelOrStorage's
+// events ring. Only copies persisted fields of order/fill into slot's own
+// order/fill, whose strings keep their capacity between uses, so publishing
+// an event doesn't allocate. Events are converted to ChannelOrStorageItems
+// by storage's events thread
+//
+struct ChannelOrStorageEvent {
+    ChannelOrStorageEvent() {
+        _type = tw::common::eChannelOrStorageItemType::kUnknown;
+    }
+    
+    void set(const tw::channel_or::Order& order) {
+        _type = tw::common::eChannelOrStorageItemType::kOrder;
+        _order = order;
+    }
+    
+    void set(const tw::channel_or::Order& order, const tw::channel_or::Reject& rej) {
+        _type = tw::common::eChannelOrStorageItemType::kOrderAndRej;
+        _order = order;
+        _rej = rej;
+    }
+    
+    void set(const tw::channel_or::Fill& fill) {
+        _type = tw::common::eChannelOrStorageItemType::kFill;
+        _fill = fill;
+        if ( _fill._order )
+            _order = *(_fill._order);
+    }
+    
+    // Rebuilds storage item - same as if item was set directly
+    // from order/fill at the time of publishing
+    //
+    void get(ChannelOrStorageItem& item) const {
+        item._type = _type;
+        switch ( _type ) {
+            case tw::common::eChannelOrStorageItemType::kOrder:
+                item._order = _order;
+                break;
+            case tw::common::eChannelOrStorageItemType::kOrderAndRej:
+                item._order = _order;
+                item._rej = _rej;
+                break;
+            case tw::common::eChannelOrStorageItemType::kFill:
+                item._fill = _fill;
+                if ( _fill._order )
+                    item._order = _order;
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // Releases references to order/instrument held by the slot
+    //
+    void release() {
+        _type = tw::common::eChannelOrStorageItemType::kUnknown;
+        _order._instrument.reset();
+        _fill._order.reset();
+    }
+    
+    tw::common::eChannelOrStorageItemType _type;
+    tw::common::THighResTime _timestamp;
+    tw::channel_or::Order _order;
+    tw::channel_or::Reject _rej;
+    tw::channel_or::Fill _fill;
+};
+
 class ChannelOrStorageFile {
 public:
     ChannelOrStorageFile();
@@ -120,7 +192,10 @@ private:
     std::ofstream _writer;
 };
     
-class ChannelOrStorage : public tw::common::Singleton<ChannelOrStorage> {
+class ChannelOrStorage : public tw::common::Singleton<ChannelOrStorage>,
+                         public tw::common::TimerClient {
+    static const size_t MAX_PENDING_ALERTS = 1024;
+    
 public:
     ChannelOrStorage();
     ~ChannelOrStorage();
@@ -139,6 +214,15 @@ public:
     //
     bool getOpenOrders(std::vector<Order>& results);
     bool getOpenOrdersForAccount(std::vector<Order>& results, const tw::risk::TAccountId& accId);
+    
+    // NOTE: with column_store.read_fills fills are read from column store,
+    // which differs from db in that:
+    //      1. date is matched against UTC day of fills' timestamp1 and not
+    //      against time of their db insert
+    //      2. store only has fills, which were persisted since it was
+    //      configured (there is no backfill from db) - earlier dates come
+    //      back empty or incomplete
+    //
     bool getFillsForDate(std::vector<Fill>& results, const std::string& date);    
     bool getFillsForAccountForDate(std::vector<Fill>& results, const tw::risk::TAccountId& accId, const std::string& date);
     bool getPositions(std::vector<PosUpdate>& results);    
@@ -159,6 +243,10 @@ public:
         return ((_threadDb != NULL) || (_threadFile != NULL));
     }
     
+    size_t eventsQueueSize() const {
+        return _events.size();
+    }
+    
     bool canPersist() const {
         return (_threadPipeFile.size() > _settings._storage_max_queue_size_file ) ? false : true;
     }
@@ -172,6 +260,7 @@ public:
     bool persist(const tw::common::Command& command);
     bool persist(const tw::channel_or::TOrderPtr& order);
     bool persist(const tw::channel_or::TOrderPtr& order, const tw::channel_or::Reject& rej);
+    bool persist(const tw::channel_or::OrdersBatch& batch);
     bool persist(const tw::channel_or::Fill& fill);
     bool persist(const tw::channel_or::FixSessionCMEState& state);
     bool persist(const tw::channel_or::FixSessionCMEMsg& msg);
@@ -184,6 +273,11 @@ public:
     //
     bool persist(const tw::channel_or::PnLAuditTrailInfo& pnlAuditTrailInfo);
     
+public:
+    // TimerClient interface - reports alerts raised on events thread
+    //
+    bool onTimeout(const tw::common::TTimerId& id);
+    
 private:
     TChannelOrStorageItemPtr getItem(bool restored = false) {
         TChannelOrStorageItemPtr item(_pool.obtain(), _pool.getDeleter());
@@ -197,16 +291,27 @@ private:
     void clearQueries();
     void closeDbResources();
     
-    bool doPersist(const TChannelOrStorageItemPtr& item);
+    bool doPersist(const TChannelOrStorageItemPtr& item) {
+        return doPersist(item, tw::common::THighResTime::now());
+    }
+    
+    bool doPersist(const TChannelOrStorageItemPtr& item, const tw::common::THighResTime& now);
+    
+    ChannelOrStorageEvent* claimEvent(uint64_t& pos);
+    uint32_t processEvents();
     bool flushToDb();
     bool doFlushToDb();
     bool persistToDb(const TChannelOrStorageItemPtr& item);
     bool persistToFile(const TChannelOrStorageItemPtr& item);
+    void appendToColumnStore(size_t count);
+    bool getColumnStoreFillsFilter(const std::string& date, tw::common::StoreFilter& filter);
     
     void flushDbCache();
     void flushFileCache();
     
     void terminateThreadDb();
+    void terminateThreadEvents();
+    void threadMainEvents();
     void threadMainPersistToDb();
     void threadMainPersistToFile();
     
@@ -215,6 +320,8 @@ private:
     bool isStopped() const {
         return ( !_threadDb 
                 && !_threadFile 
+                && !_threadEvents
+                && _events.empty()
                 && _threadPipeDb.empty()
                 && _threadPipeFile.empty()
                 && _itemsCache.empty() );
@@ -222,6 +329,19 @@ private:
     
     void startThreadPersistToFile(const std::string& reason);
     
+    // Events thread must never call ConsumerProxy: strategy thread, which
+    // waits for events ring's free slot, holds StrategyContainer's lock,
+    // which ConsumerProxy::onAlert() takes. Alerts raised on events thread
+    // are queued and reported by timer's thread instead
+    //
+    void raiseAlert(const tw::channel_or::Alert& alert);
+    void reportAlerts();
+    
+    static bool& isEventsThread() {
+        static __thread bool value = false;
+        return value;
+    }
+    
 private:
     void addMessagingForExchanges(const std::string& symbol, const tw::instr::eExchange& exchange, const TAccountId& accountId, const tw::channel_or::Messaging& v) {
         tw::channel_or::MessagingForExchange m;
@@ -239,6 +359,7 @@ private:
     
     typedef tw::common::Pool<ChannelOrStorageItem, tw::common_thread::Lock> TPool;
     typedef tw::common_thread::ThreadPipe<TChannelOrStorageItemPtr> TThreadPipe;
+    typedef tw::common_thread::RingBuffer<ChannelOrStorageEvent> TEvents;
     
     typedef tw::channel_db::ChannelDb TChannelDb;
     typedef std::vector<TChannelOrStorageItemPtr> TItemsCache;
@@ -252,6 +373,8 @@ private:
     bool _isDoneDb;
     bool _isDoneDbThread;
     bool _isDoneFile;
+    volatile bool _isDoneEvents;
+    volatile uint32_t _isEventsFullAlerted;
     bool _stopPersistingToDb;
     tw::channel_or::Settings _settings;
     TChannelDb _channelDb;
@@ -260,11 +383,23 @@ private:
     tw::channel_db::ChannelDb::TConnectionPtr _connection;
     tw::channel_db::ChannelDb::TStatementPtr _statement;
     
+    // Local copy of fills and pnl audit trail, populated once db
+    // transaction is committed
+    //
+    tw::common::ColumnStore _columnStore;
+    bool _readFillsFromColumnStore;
+    
     TPool _pool;
     TThreadPtr _threadDb;
     TThreadPtr _threadFile;
     TThreadPipe _threadPipeDb;
     TThreadPipe _threadPipeFile;
+    TThreadPtr _threadEvents;
+    TEvents _events;
+    
+    TLock _alertsLock;
+    std::vector<tw::channel_or::Alert> _alerts;
+    tw::common::TTimerId _timerId;
     
     size_t _itemsCacheSize;
     TItemsCache _itemsCache;
@@ -2,12 +2,51 @@
 
 #include <tw/common/uuid.h>
 #include <tw/common/command.h>
+#include <tw/common/instrumentation.h>
 #include <tw/generated/channel_or_defs.h>
 #include <tw/common/settings.h>
+#include <tw/log/defs.h>
+
+#include <vector>
 
 namespace tw {
 namespace channel_or {
     
+// Orders sent through ProcessorOut chain in one call
+//
+// '_rejected[i]' - set once any stage rejects '_orders[i]', with reason in
+// '_rejs[i]'
+//
+struct OrdersBatch {
+    OrdersBatch() {
+        clear();
+    }
+    
+    void clear() {
+        _orders.clear();
+        _rejs.clear();
+        _rejected.clear();
+    }
+    
+    void add(const TOrderPtr& order) {
+        _orders.push_back(order);
+        _rejs.push_back(Reject());
+        _rejected.push_back(false);
+    }
+    
+    size_t size() const {
+        return _orders.size();
+    }
+    
+    bool empty() const {
+        return _orders.empty();
+    }
+    
+    std::vector<TOrderPtr> _orders;
+    std::vector<Reject> _rejs;
+    std::vector<bool> _rejected;
+};
+    
 class ProcessorOutNull {
 public:
     // Administrative methods
@@ -42,19 +81,94 @@ public:
     void onRebuildOrderRej(const TOrderPtr& order, const Reject& rej) {}
 };
 
+// Per request type operations of ProcessorOut's batched pass: send() of
+// processor's impl, sendBatched() of the next processor in chain (end of
+// chain accepts) and reject() which rolls impl back
+//
+struct BatchOpNew {
+    template <typename TProcessor>
+    static bool send(TProcessor& p, const TOrderPtr& order, Reject& rej) {
+        return p.sendNew(order, rej);
+    }
+    
+    template <typename TProcessor>
+    static bool sendBatched(TProcessor& p, const TOrderPtr& order, Reject& rej) {
+        return p.template sendBatched<BatchOpNew>(order, rej);
+    }
+    
+    static bool sendBatched(ProcessorOutNull& p, const TOrderPtr& order, Reject& rej) {
+        return true;
+    }
+    
+    template <typename TProcessor>
+    static void reject(TProcessor& p, const TOrderPtr& order, const Reject& rej) {
+        p.onNewRej(order, rej);
+    }
+};
+
+struct BatchOpMod {
+    template <typename TProcessor>
+    static bool send(TProcessor& p, const TOrderPtr& order, Reject& rej) {
+        return p.sendMod(order, rej);
+    }
+    
+    template <typename TProcessor>
+    static bool sendBatched(TProcessor& p, const TOrderPtr& order, Reject& rej) {
+        return p.template sendBatched<BatchOpMod>(order, rej);
+    }
+    
+    static bool sendBatched(ProcessorOutNull& p, const TOrderPtr& order, Reject& rej) {
+        return true;
+    }
+    
+    template <typename TProcessor>
+    static void reject(TProcessor& p, const TOrderPtr& order, const Reject& rej) {
+        p.onModRej(order, rej);
+    }
+};
+
+struct BatchOpCxl {
+    template <typename TProcessor>
+    static bool send(TProcessor& p, const TOrderPtr& order, Reject& rej) {
+        return p.sendCxl(order, rej);
+    }
+    
+    template <typename TProcessor>
+    static bool sendBatched(TProcessor& p, const TOrderPtr& order, Reject& rej) {
+        return p.template sendBatched<BatchOpCxl>(order, rej);
+    }
+    
+    static bool sendBatched(ProcessorOutNull& p, const TOrderPtr& order, Reject& rej) {
+        return true;
+    }
+    
+    template <typename TProcessor>
+    static void reject(TProcessor& p, const TOrderPtr& order, const Reject& rej) {
+        p.onCxlRej(order, rej);
+    }
+};
+
 static ProcessorOutNull nextOutNull;
 static ProcessorInNull nextInNull;
 
+// 'stage' - if not NULL, time spent in impl's (excluding next processors')
+// sendNew()/sendMod()/sendCxl() is recorded in 'processor_out.<stage>'
+// instrumentation histogram
+//
 template <typename TImpl, typename TProcessorNext = ProcessorOutNull>
 class ProcessorOut {
 public:
-    ProcessorOut(TImpl& impl) : _impl(impl),
-                                _next(nextOutNull) {        
+    ProcessorOut(TImpl& impl,
+                 const char* stage = NULL) : _impl(impl),
+                                             _next(nextOutNull),
+                                             _stage(registerStage(stage)) {
     }
     
     ProcessorOut(TImpl& impl,
-                   TProcessorNext& next) : _impl(impl),
-                                           _next(next) {        
+                   TProcessorNext& next,
+                   const char* stage = NULL) : _impl(impl),
+                                               _next(next),
+                                               _stage(registerStage(stage)) {
     }
     
 public:
@@ -91,8 +205,11 @@ public:
     
 public:
     bool sendNew(const TOrderPtr& order, Reject& rej) {
-        if ( !_impl.sendNew(order, rej) )
-            return false;
+        {
+            tw::common::LatencyScope timer(_stage);
+            if ( !_impl.sendNew(order, rej) )
+                return false;
+        }
         
         if ( !_next.sendNew(order,rej) ) {
             _impl.onNewRej(order, rej);
@@ -102,9 +219,32 @@ public:
         return true;
     }
     
+    // Batched sendNew()/sendMod()/sendCxl(): each order goes through the
+    // whole chain before the next one, so that batch's result is the same
+    // as of consecutive single order calls (e.g. risk limits see open
+    // quantity of batch's earlier orders only). Order which throws is
+    // rejected - stages which already accepted it roll it back the same
+    // way as when a later stage rejects it - and the rest of the batch is
+    // still sent
+    //
+    void sendNew(OrdersBatch& batch) {
+        sendBatch<BatchOpNew>(batch);
+    }
+    
+    void sendMod(OrdersBatch& batch) {
+        sendBatch<BatchOpMod>(batch);
+    }
+    
+    void sendCxl(OrdersBatch& batch) {
+        sendBatch<BatchOpCxl>(batch);
+    }
+    
     bool sendMod(const TOrderPtr& order, Reject& rej) {
-        if ( !_impl.sendMod(order, rej) )
-            return false;
+        {
+            tw::common::LatencyScope timer(_stage);
+            if ( !_impl.sendMod(order, rej) )
+                return false;
+        }
         
         if ( !_next.sendMod(order,rej) ) {
             _impl.onModRej(order, rej);
@@ -115,8 +255,11 @@ public:
     }
     
     bool sendCxl(const TOrderPtr& order, Reject& rej) {
-        if ( !_impl.sendCxl(order, rej) )
-            return false;
+        {
+            tw::common::LatencyScope timer(_stage);
+            if ( !_impl.sendCxl(order, rej) )
+                return false;
+        }
         
         if ( !_next.sendCxl(order,rej) ) {
             _impl.onCxlRej(order, rej);
@@ -153,9 +296,100 @@ public:
         _next.rebuildPos(update);
     }
     
+    // Order of a batch through the rest of the chain - if a later stage
+    // rejects the order or throws, impl rolls it back before the reject
+    // or exception is passed on
+    //
+    template <typename TOp>
+    bool sendBatched(const TOrderPtr& order, Reject& rej) {
+        {
+            tw::common::LatencyScope timer(_stage);
+            if ( !TOp::send(_impl, order, rej) )
+                return false;
+        }
+        
+        bool status = false;
+        try {
+            status = TOp::sendBatched(_next, order, rej);
+        } catch(const std::exception& e) {
+            setRej(rej, e.what());
+            TOp::reject(_impl, order, rej);
+            throw;
+        } catch(...) {
+            setRej(rej, "UNKNOWN");
+            TOp::reject(_impl, order, rej);
+            throw;
+        }
+        
+        if ( !status ) {
+            TOp::reject(_impl, order, rej);
+            return false;
+        }
+        
+        return true;
+    }
+    
+private:
+    template <typename TOp>
+    void sendBatch(OrdersBatch& batch) {
+        for ( size_t i = 0; i < batch.size(); ++i ) {
+            if ( batch._rejected[i] )
+                continue;
+            
+            try {
+                if ( !sendBatched<TOp>(batch._orders[i], batch._rejs[i]) )
+                    batch._rejected[i] = true;
+            } catch(const std::exception& e) {
+                LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+                setRej(batch._rejs[i], e.what());
+                batch._rejected[i] = true;
+            } catch(...) {
+                LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+                setRej(batch._rejs[i], "UNKNOWN");
+                batch._rejected[i] = true;
+            }
+        }
+    }
+    
+    static void setRej(Reject& rej, const std::string& text) {
+        rej._rejType = eRejectType::kInternal;
+        rej._rejReason = eRejectReason::kSystemError;
+        rej._text = "Exception: " + text;
+    }
+    
+    static tw::common::LatencyHistogram* registerStage(const char* stage) {
+        if ( NULL == stage )
+            return NULL;
+        
+        return &(tw::common::Instrumentation::instance().registerStage(std::string("processor_out.") + stage));
+    }
+    
 private:
     TImpl& _impl;
     TProcessorNext _next;
+    tw::common::LatencyHistogram* _stage;
+};
+
+// Stage of ProcessorOut chain which can be compiled out: if 'enabled' is
+// false, stage's type is next processor's type and create() returns next
+// processor, so there are no runtime checks for disabled stages
+//
+template <bool enabled, typename TImpl, typename TProcessorNext = ProcessorOutNull>
+struct ProcessorOutStage {
+    typedef ProcessorOut<TImpl, TProcessorNext> TType;
+    
+    static TType create(TImpl& impl, TProcessorNext& next, const char* stage = NULL) {
+        return TType(impl, next, stage);
+    }
+};
+
+template <typename TImpl, typename TProcessorNext>
+struct ProcessorOutStage<false, TImpl, TProcessorNext> {
+    typedef TProcessorNext TType;
+    
+    static TType create(TImpl& impl, TProcessorNext& next, const char* stage = NULL) {
+        return next;
+    }
 };
 
 template <typename TImpl, typename TProcessorNext = ProcessorInNull>
@@ -13,6 +13,7 @@ static const uint32_t MAX_MOD_REJ_COUNTER = 5;
 static const uint32_t MAX_CXL_REJ_COUNTER = 5;
 
 ProcessorOrders::ProcessorOrders() {
+    _stuckOrdersBase = tw::common::THighResTime::now();
     clear();    
 }
 
@@ -23,9 +24,12 @@ ProcessorOrders::~ProcessorOrders() {
 void ProcessorOrders::clear() {
     _pool.clear();    
     _table.clear();
+    _ordersByAccountStrategy.clear();
+    _ordersByInstrument.clear();
     
-    _accountInstrOpenOrdersPos.clear();
+    _riskSlots.clearOpenOrdersPos();
     _strategyInstrOpenOrdersPos.clear();
+    _stuckOrders.clear();
 }
 
 TOrderPtr ProcessorOrders::createOrder(bool createOrderId) {
@@ -44,47 +48,60 @@ TOrders ProcessorOrders::getAll() const {
 }
 
 TOrders ProcessorOrders::getAllForAccount(const TAccountId& x) const {
-    return _table.get(FilterAccountId(x));
+    TOrders orders;
+    
+    TOrdersByAccountStrategy::const_iterator iter = _ordersByAccountStrategy.lower_bound(TAccountStrategy(x, TStrategyId()));
+    TOrdersByAccountStrategy::const_iterator end = _ordersByAccountStrategy.end();
+    for ( ; iter != end && iter->first.first == x; ++iter ) {
+        TOrders v = iter->second.get(FilterNull());
+        orders.insert(orders.end(), v.begin(), v.end());
+    }
+    
+    return orders;
 }
 
 TOrders ProcessorOrders::getAllForAccountStrategy(const TAccountId& x, const TStrategyId& y) const {
-    return _table.get(FilterAccountIdStrategyId(x, y));
+    TOrdersByAccountStrategy::const_iterator iter = _ordersByAccountStrategy.find(TAccountStrategy(x, y));
+    if ( iter == _ordersByAccountStrategy.end() )
+        return TOrders();
+    
+    return iter->second.get(FilterNull());
 }
 
 TOrders ProcessorOrders::getAllForAccountStrategyInstr(const TAccountId& x, const TStrategyId& y, const tw::instr::Instrument::TKeyId& z) const {
-    return _table.get(FilterAccountIdStrategyIdInstr(x, y, z));
+    TOrdersByAccountStrategy::const_iterator iter = _ordersByAccountStrategy.find(TAccountStrategy(x, y));
+    if ( iter == _ordersByAccountStrategy.end() )
+        return TOrders();
+    
+    return iter->second.get(FilterInstrumentId(z));
 }
 
 TOrders ProcessorOrders::getAllForInstrument(const tw::instr::Instrument::TKeyId& x) const {
-    return _table.get(FilterInstrumentId(x));
-}
-
-const ProcessorOrders::TInstrOpenOrdersPos& ProcessorOrders::getAllInstrOpenOrdersPosForAccount(const TAccountId& x) {
-    TAccountInstrOpenOrdersPos::iterator iter = _accountInstrOpenOrdersPos.find(x);
-    if ( iter == _accountInstrOpenOrdersPos.end() ) {
-        iter = _accountInstrOpenOrdersPos.insert(TAccountInstrOpenOrdersPos::value_type(x, TInstrOpenOrdersPos())).first;
-    }
+    TOrdersByInstrument::const_iterator iter = _ordersByInstrument.find(x);
+    if ( iter == _ordersByInstrument.end() )
+        return TOrders();
     
-    return iter->second;
+    return iter->second.get(FilterNull());
 }
 
 const AccountInstrOpenOrdersPos& ProcessorOrders::getInstrOpenOrdersPosForAccountInstr(const TAccountId& x, const tw::instr::Instrument::TKeyId& y) {
-    TInstrOpenOrdersPos& instrOpenOrdersPos = const_cast<TInstrOpenOrdersPos&>(getAllInstrOpenOrdersPosForAccount(x));
-    
-    TInstrOpenOrdersPos::iterator iter = instrOpenOrdersPos.find(y);
-    if ( iter == instrOpenOrdersPos.end() ) {
-        iter = instrOpenOrdersPos.insert(TInstrOpenOrdersPos::value_type(y, AccountInstrOpenOrdersPos())).first;
-        iter->second._accountId = x;
-        iter->second._instrumentId = y;        
-        iter->second._bids.set(0);
-        iter->second._asks.set(0);
+    return getOpenOrdersPos(_riskSlots.getOrCreate(x, y));
+}
+
+const AccountInstrOpenOrdersPos& ProcessorOrders::getInstrOpenOrdersPosForAccountInstr(const TOrderPtr& order) {
+    return getOpenOrdersPos(_riskSlots.get(order));
+}
+
+AccountInstrOpenOrdersPos& ProcessorOrders::getOpenOrdersPos(RiskSlot& slot) {
+    if ( !slot._isOpenOrdersPosSet ) {
+        slot._isOpenOrdersPosSet = true;
         
-        tw::instr::InstrumentPtr instrument = tw::instr::InstrumentManager::instance().getByKeyId(y);
+        tw::instr::InstrumentPtr instrument = tw::instr::InstrumentManager::instance().getByKeyId(slot._instrumentId);
         if ( instrument )
-            iter->second._displayName = instrument->_displayName;
-    }   
+            slot._openOrdersPos._displayName = instrument->_displayName;
+    }
     
-    return iter->second;
+    return slot._openOrdersPos;
 }
 
 const ProcessorOrders::TInstrStratOpenOrdersPos& ProcessorOrders::getAllInstrOpenOrdersPosForStrategy(const TStrategyId& x) {
@@ -158,7 +175,10 @@ void ProcessorOrders::stop() {
     tw::channel_or::UuidFactory::instance().stop();
     
     _table.clear();
-    _accountInstrOpenOrdersPos.clear();
+    _ordersByAccountStrategy.clear();
+    _ordersByInstrument.clear();
+    _riskSlots.clearOpenOrdersPos();
+    _stuckOrders.clear();
 }
 
 bool ProcessorOrders::sendNew(const TOrderPtr& order, Reject& rej) {
@@ -185,7 +205,9 @@ bool ProcessorOrders::sendNew(const TOrderPtr& order, Reject& rej) {
         return false;
     }
     
+    index(order);
     changeOpenOrdersCounts(order, 1);
+    trackStuck(order);
     return true;
 }
 
@@ -227,6 +249,9 @@ bool ProcessorOrders::sendMod(const TOrderPtr& order, Reject& rej) {
             break;
     }
     
+    if ( status )
+        trackStuck(order);
+    
     return status;
 }
 
@@ -247,6 +272,7 @@ bool ProcessorOrders::sendCxl(const TOrderPtr& order, Reject& rej) {
             break;
     }
     
+    trackStuck(order);
     return true;
 }
 
@@ -270,24 +296,27 @@ void ProcessorOrders::onCommand(const tw::common::Command& command) {
             return;
         }
         
-        tw::common_str_util::FastStream<1024*2> buffer;
-        const TInstrOpenOrdersPos& positions =  getAllInstrOpenOrdersPosForAccount(accountId);
+        RiskSlots::TRiskSlotPtrs slots;
+        _riskSlots.getAllForAccount(accountId, slots);
         
-        TInstrOpenOrdersPos::const_iterator iter = positions.begin();
-        TInstrOpenOrdersPos::const_iterator end = positions.end();
+        RiskSlots::TRiskSlotPtrs::const_iterator iter = slots.begin();
+        RiskSlots::TRiskSlotPtrs::const_iterator end = slots.end();
         for ( ; iter != end; ++iter ) {
-            buffer.clear();
+            if ( !(*iter)->_isOpenOrdersPosSet )
+                continue;
+            
+            const AccountInstrOpenOrdersPos& v = (*iter)->_openOrdersPos;
             c.clear();
             
-            c.addParams("accountId", iter->second._accountId);
-            c.addParams("instrumentId", iter->second._instrumentId);
-            c.addParams("displayName", iter->second._displayName);
-            c.addParams("pos", iter->second._pos);
+            c.addParams("accountId", v._accountId);
+            c.addParams("instrumentId", v._instrumentId);
+            c.addParams("displayName", v._displayName);
+            c.addParams("pos", v._pos);
                     
             c._type = command._type;
             c._subType = command._subType;
             
-            tw::common_strat::StrategyContainer::instance().sendToMsgBusConnection(command._connectionId, c.toString()+"\n");
+            tw::common_strat::StrategyContainer::instance().sendToMsgBusConnection(command._connectionId, c);
         }
     } else {
         TOrders orders = getAll();
@@ -301,7 +330,7 @@ void ProcessorOrders::onCommand(const tw::common::Command& command) {
             c._type = tw::common::eCommandType::kProcessorOrders;
             c._subType = tw::common::eCommandSubType::kOpenOrders;
             
-            tw::common_strat::StrategyContainer::instance().sendToMsgBusConnection(command._connectionId, c.toString()+"\n");
+            tw::common_strat::StrategyContainer::instance().sendToMsgBusConnection(command._connectionId, c);
         }
     }
 }
@@ -312,6 +341,8 @@ bool ProcessorOrders::rebuildOrder(const TOrderPtr& order, Reject& rej) {
         return false;
     }
     
+    index(order);
+    
     order->_instrument = tw::instr::InstrumentManager::instance().getByKeyId(order->_instrumentId);
     if ( NULL == order->_instrument ) {
         rej = getRej(eRejectReason::kSymbolNotConfigured);
@@ -319,6 +350,7 @@ bool ProcessorOrders::rebuildOrder(const TOrderPtr& order, Reject& rej) {
     }
     
     changeOpenOrdersCounts(order, 1);
+    trackStuck(order);
     return true;
 }
 
@@ -351,6 +383,7 @@ void ProcessorOrders::onNewAck(const TOrderPtr& order) {
     }
     
     order->_state = eOrderState::kWorking;
+    trackStuck(order);
 }
 
 void ProcessorOrders::onNewRej(const TOrderPtr& order, const Reject& rej) {
@@ -395,8 +428,10 @@ void ProcessorOrders::doOnModPost(const TOrderPtr& order, bool updatePrice) {
         return;
     }
     
-    if ( 0 == --order->_modCounter )
+    if ( 0 == --order->_modCounter ) {
         order->_state = eOrderState::kWorking;
+        trackStuck(order);
+    }
     
     if ( updatePrice ) {
         order->_price = order->_newPrice;
@@ -424,6 +459,7 @@ void ProcessorOrders::onCxlRej(const TOrderPtr& order, const Reject& rej) {
     }
     
     order->_state = eOrderState::kWorking;
+    trackStuck(order);
 }
 
 void ProcessorOrders::onFill(const Fill& fill) {        
@@ -468,32 +504,31 @@ void ProcessorOrders::onRebuildOrderRej(const TOrderPtr& order, const Reject& re
 }
 
 bool ProcessorOrders::onTimeout(const tw::common::TTimerId& id) {
-    tw::common::THighResTime now = tw::common::THighResTime::now();
+    int64_t now = tw::common::THighResTime::now() - _stuckOrdersBase;
     
-    // Check all open orders
+    // Check only orders with expired deadlines - deadline is set when
+    // order is queued on send, so order which was re-sent since then is
+    // already queued with its actual deadline. Stuck orders stay queued
+    // to be reported on next check as well
     //
     typedef std::map<TStrategyId, TOrders> TStrategyStuckOrders;
     
     TStrategyStuckOrders strats;
     {
-        TOrders orders = getAll();
+        // Deadlines which are not after now are expired
+        //
+        TOrders orders;
+        _stuckOrders.popExpired(now+1, orders);
+        
         TOrders::iterator iter = orders.begin();
         TOrders::iterator end = orders.end();
         for ( ; iter != end; ++iter ) {
             TOrderPtr& order = *iter;
-            switch ( order->_state ) {
-                case eOrderState::kPending:
-                case eOrderState::kModifying:
-                case eOrderState::kCancelling:
-                {
-                    uint64_t delta = now - order->_timestamp1;
-                    if ( delta > _settings._strategy_container_stuck_orders_timeout*1000)
-                        strats[order->_strategyId].push_back(order);
-                }
-                    break;
-                default:
-                    break;
-            }
+            if ( !isStuckState(order) )
+                continue;
+            
+            strats[order->_strategyId].push_back(order);
+            _stuckOrders.add(order, now);
         }
     }
     
@@ -528,14 +563,32 @@ bool ProcessorOrders::onTimeout(const tw::common::TTimerId& id) {
  
 void ProcessorOrders::remove(const TOrderPtr& order) {
     changeOpenOrdersCounts(order, -1);
+    _stuckOrders.rem(order);
     
     if ( !_table.rem(order->_orderId) ) {
         LOGGER_ERRO << "can't remove order: " << order->_orderId.toString() << " :: " << order->toString() << "\n";
     }
+    
+    unindex(order);
+}
+
+void ProcessorOrders::index(const TOrderPtr& order) {
+    _ordersByAccountStrategy[TAccountStrategy(order->_accountId, order->_strategyId)].add(order->_orderId, order);
+    _ordersByInstrument[order->_instrumentId].add(order->_orderId, order);
+}
+
+void ProcessorOrders::unindex(const TOrderPtr& order) {
+    TOrdersByAccountStrategy::iterator iter = _ordersByAccountStrategy.find(TAccountStrategy(order->_accountId, order->_strategyId));
+    if ( iter != _ordersByAccountStrategy.end() )
+        iter->second.rem(order->_orderId);
+    
+    TOrdersByInstrument::iterator iterInstr = _ordersByInstrument.find(order->_instrumentId);
+    if ( iterInstr != _ordersByInstrument.end() )
+        iterInstr->second.rem(order->_orderId);
 }
 
 void ProcessorOrders::changeOpenOrdersCounts(const TOrderPtr& order, int8_t multiplier) {
-    AccountInstrOpenOrdersPos& v = const_cast<AccountInstrOpenOrdersPos&>(getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId));
+    AccountInstrOpenOrdersPos& v = getOpenOrdersPos(_riskSlots.get(order));
     StrategyInstrOpenOrdersPos& s = const_cast<StrategyInstrOpenOrdersPos&>(getInstrOpenOrdersPosForStrategyInstr(order->_strategyId, order->_instrumentId));
     
     tw::price::Size delta = order->_qty - order->_cumQty;
@@ -564,7 +617,13 @@ void ProcessorOrders::changeOpenOrdersCounts(const TOrderPtr& order, int8_t mult
 }
 
 void ProcessorOrders::changePosCounts(const Fill& fill) {
-    AccountInstrOpenOrdersPos& v = const_cast<AccountInstrOpenOrdersPos&>(getInstrOpenOrdersPosForAccountInstr(fill._accountId, fill._instrumentId));
+    // Order's cached slot is used unless fill is for different instrument (e.g. spread's leg)
+    //
+    RiskSlot* slot = (fill._order != NULL) ? fill._order->_riskSlot : NULL;
+    if ( NULL == slot || slot->_accountId != fill._accountId || slot->_instrumentId != fill._instrumentId )
+        slot = &(_riskSlots.getOrCreate(fill._accountId, fill._instrumentId));
+    
+    AccountInstrOpenOrdersPos& v = getOpenOrdersPos(*slot);
     StrategyInstrOpenOrdersPos& s = const_cast<StrategyInstrOpenOrdersPos&>(getInstrOpenOrdersPosForStrategyInstr(fill._strategyId, fill._instrumentId));
     
     switch ( fill._side ) {
@@ -617,5 +676,12 @@ void ProcessorOrders::changePosCounts(const Fill& fill) {
     const_cast<Fill&>(fill)._posAccount.set(v._pos);
 }
     
+void ProcessorOrders::trackStuck(const TOrderPtr& order) {
+    if ( isStuckState(order) )
+        _stuckOrders.add(order, getStuckDeadline());
+    else
+        _stuckOrders.rem(order);
+}
+
 } // namespace channel_or
 } // namespace tw
@@ -6,6 +6,8 @@
 #include <tw/generated/channel_or_defs.h>
 #include <tw/channel_or/uuid_factory.h>
 #include <tw/channel_or/orders_table.h>
+#include <tw/channel_or/risk_slot.h>
+#include <tw/channel_or/stuck_orders_queue.h>
 #include <tw/common/settings.h>
 #include <tw/common/timer_server.h>
 
@@ -17,9 +19,6 @@ namespace channel_or {
 class ProcessorOrders : public tw::common::Singleton<ProcessorOrders>,
                         public tw::common::TimerClient {
 public:
-    typedef std::map<tw::instr::Instrument::TKeyId, AccountInstrOpenOrdersPos> TInstrOpenOrdersPos;
-    typedef std::map<tw::channel_or::TAccountId, TInstrOpenOrdersPos> TAccountInstrOpenOrdersPos;
-    
     typedef std::map<tw::instr::Instrument::TKeyId, StrategyInstrOpenOrdersPos> TInstrStratOpenOrdersPos;
     typedef std::map<tw::channel_or::TStrategyId, TInstrStratOpenOrdersPos> TStrategyInstrOpenOrdersPos;
     
@@ -44,12 +43,24 @@ public:
     TOrders getAllForInstrument(const tw::instr::Instrument::TKeyId& x) const;
     
 public:
-    const TInstrOpenOrdersPos& getAllInstrOpenOrdersPosForAccount(const TAccountId& x);
     const AccountInstrOpenOrdersPos& getInstrOpenOrdersPosForAccountInstr(const TAccountId& x, const tw::instr::Instrument::TKeyId& y);
+    const AccountInstrOpenOrdersPos& getInstrOpenOrdersPosForAccountInstr(const TOrderPtr& order);
     
     const TInstrStratOpenOrdersPos& getAllInstrOpenOrdersPosForStrategy(const TStrategyId& x);
     const StrategyInstrOpenOrdersPos& getInstrOpenOrdersPosForStrategyInstr(const TStrategyId& x, const tw::instr::Instrument::TKeyId& y);
     
+public:
+    // Account's open orders/pos are kept in risk slots shared with
+    // ProcessorRisk - see risk_slot.h
+    //
+    RiskSlots& getRiskSlots() {
+        return _riskSlots;
+    }
+    
+    RiskSlot& getRiskSlot(const TOrderPtr& order) {
+        return _riskSlots.get(order);
+    }
+    
 public:
     bool isOrderLive(const TOrderPtr& order);
     
@@ -95,8 +106,37 @@ public:
     
 private:
     void remove(const TOrderPtr& order);
+    void index(const TOrderPtr& order);
+    void unindex(const TOrderPtr& order);
     void changeOpenOrdersCounts(const TOrderPtr& order, int8_t multiplier);
     void changePosCounts(const Fill& fill);
+    AccountInstrOpenOrdersPos& getOpenOrdersPos(RiskSlot& slot);
+    
+    // Queues order waiting for exchange's response for stuck orders
+    // check and dequeues all others
+    //
+    void trackStuck(const TOrderPtr& order);
+    
+    static bool isStuckState(const TOrderPtr& order) {
+        switch ( order->_state ) {
+            case eOrderState::kPending:
+            case eOrderState::kModifying:
+            case eOrderState::kCancelling:
+                return true;
+            default:
+                break;
+        }
+        
+        return false;
+    }
+    
+    // NOTE: deadline is taken from now rather than from order's _timestamp1,
+    // since StrategyContainer sets _timestamp1 only after processors' chain
+    // returns
+    //
+    int64_t getStuckDeadline() const {
+        return (tw::common::THighResTime::now() - _stuckOrdersBase) + static_cast<int64_t>(_settings._strategy_container_stuck_orders_timeout)*1000;
+    }
     
     Reject getRej(eRejectReason reason) {
         tw::channel_or::Reject rej;
@@ -112,13 +152,27 @@ private:
     typedef tw::common::Pool<Order> TPool;
     typedef tw::channel_or::OrderTable<> TOrderTable;
     
+    // Secondary indexes of _table, so that getAllFor...() (mass cancels)
+    // take time proportional to number of orders returned
+    //
+    typedef std::pair<TAccountId, TStrategyId> TAccountStrategy;
+    typedef std::map<TAccountStrategy, TOrderTable> TOrdersByAccountStrategy;
+    typedef std::map<tw::instr::Instrument::TKeyId, TOrderTable> TOrdersByInstrument;
+    
 private:
     tw::common::Settings _settings;
     TPool _pool;
     TOrderTable _table;
+    TOrdersByAccountStrategy _ordersByAccountStrategy;
+    TOrdersByInstrument _ordersByInstrument;
     
-    TAccountInstrOpenOrdersPos _accountInstrOpenOrdersPos;
+    RiskSlots _riskSlots;
     TStrategyInstrOpenOrdersPos _strategyInstrOpenOrdersPos;
+    
+    // Deadlines in queue are in micros since _stuckOrdersBase
+    //
+    tw::common::THighResTime _stuckOrdersBase;
+    StuckOrdersQueue _stuckOrders;
 };
 
     
@@ -21,6 +21,7 @@ void ProcessorPnL::clear() {
     _account.clear();
     _accountPnL.clear();
     _stratsPnL.clear();
+    _instrumentsIndex.clear();
 }
 
 bool ProcessorPnL::init(const tw::risk::Account& account, const std::vector<tw::risk::Strategy>& strats) {
@@ -108,7 +109,7 @@ bool ProcessorPnL::sendNew(const TOrderPtr& order, Reject& rej) {
     
     pnl_amount = -1 * _accountPnL.getRealizedPnL();
     if ( (pnl_amount+fees_amount) > _account._maxRealizedLoss ) {
-        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId);
+        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order);
         if ( isToReject(order, openOrdersPos._pos) ) {
             rej = getRej(eRejectReason::kMaxRealizedLossAccount);
             
@@ -123,7 +124,7 @@ bool ProcessorPnL::sendNew(const TOrderPtr& order, Reject& rej) {
     
     pnl_amount = -1 * _accountPnL.getUnrealizedPnL();
     if ( (pnl_amount+fees_amount) > _account._maxUnrealizedLoss ) {
-        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId);
+        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order);
         if ( isToReject(order, openOrdersPos._pos) ) {
             rej = getRej(eRejectReason::kMaxUnrealizedLossAccount);
             
@@ -138,7 +139,7 @@ bool ProcessorPnL::sendNew(const TOrderPtr& order, Reject& rej) {
 
     std::string reason;
     if ( isAccountTotalLossReached(pnl_amount, reason) ) {
-        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId);
+        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order);
         if ( isToReject(order, openOrdersPos._pos) ) {
             rej = getRej(eRejectReason::kMaxTotalLossAccount);
             rej._text = reason;
@@ -149,7 +150,7 @@ bool ProcessorPnL::sendNew(const TOrderPtr& order, Reject& rej) {
     }
     
     if ( (_accountPnL.getRealizedDrawdown()+fees_amount) > _account._maxRealizedDrawdown ) {
-        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId);
+        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order);
         if ( isToReject(order, openOrdersPos._pos) ) {
             rej = getRej(eRejectReason::kMaxRealizedDrawdownAccount);
             
@@ -163,7 +164,7 @@ bool ProcessorPnL::sendNew(const TOrderPtr& order, Reject& rej) {
     }
     
     if ( (_accountPnL.getUnrealizedDrawdown()+fees_amount) > _account._maxUnrealizedDrawdown ) {
-        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId);
+        const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order);
         if ( isToReject(order, openOrdersPos._pos) ) {
             rej = getRej(eRejectReason::kMaxUnrealizedDrawdownAccount);
             
@@ -298,6 +299,7 @@ TPnL& ProcessorPnL::getOrCreatePnl(const tw::risk::TStrategyId& x,  const tw::in
         iterPnl = instrumentsPnl.insert(StratPnL::TInstrumentsPnL::value_type(y, TPnL())).first;
         iterPnl->second.setObserver(&(stratPnl._stratPnL));
         stratPnl._stratPnL.addComponent(&iterPnl->second);
+        _instrumentsIndex[y].push_back(&iterPnl->second);
     }
 
     return iterPnl->second;
@@ -342,17 +344,16 @@ void ProcessorPnL::logPnl() const {
 }
 
 void ProcessorPnL::updatePnLForTvForStratInstrument(const tw::instr::Instrument::TKeyId& instrId) {
-    TStratsPnL::iterator iter = _stratsPnL.begin();
-    TStratsPnL::iterator end = _stratsPnL.end();
-    for ( ; iter!=end; ++iter ) {
-        StratPnL::TInstrumentsPnL::iterator iter2 = iter->second._instrumentsPnL.begin();
-        StratPnL::TInstrumentsPnL::iterator end2 = iter->second._instrumentsPnL.end();
-        for ( ; iter2 != end2; ++iter2 ) {
-            if ( iter2->second.getInstrument() && instrId == iter2->second.getInstrument()->_keyId ) {
-                tw::common_trade::WboManager::TTv& tv = tw::common_trade::WboManager::instance().getOrCreateTv(iter2->second.getInstrument()->_keyId);    
-                iter2->second.onTv(tv);
-            }
-        }
+    TInstrumentsIndex::iterator iter = _instrumentsIndex.find(instrId);
+    if ( iter == _instrumentsIndex.end() )
+        return;
+    
+    tw::common_trade::WboManager::TTv& tv = tw::common_trade::WboManager::instance().getOrCreateTv(instrId);
+    
+    TPnLs& pnls = iter->second;
+    for ( size_t i = 0; i < pnls.size(); ++i ) {
+        if ( pnls[i]->getInstrument() )
+            pnls[i]->onTv(tv);
     }
 }
 
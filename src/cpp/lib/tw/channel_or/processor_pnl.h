@@ -13,6 +13,8 @@
 #include <tw/generated/risk_defs.h>
 
 #include <map>
+#include <vector>
+#include <tr1/unordered_map>
 
 namespace tw {
 namespace channel_or {
@@ -42,45 +44,19 @@ struct StratPnL {
         return NULL;
     }
     
+    // Aggregates are maintained by _stratPnL composite on every fill/tv
+    // update of instruments' pnls, so no iteration over instruments
+    //
     TLongsShorts getLongsShorts() const {
-        TLongsShorts longsShorts;
-        longsShorts.first = longsShorts.second = tw::price::Size(0);
-        
-        TInstrumentsPnL::const_iterator iter = _instrumentsPnL.begin();
-        TInstrumentsPnL::const_iterator end = _instrumentsPnL.end();
-        for ( ; iter != end; ++iter ) {
-            tw::price::Size pos = iter->second.getPosition();
-            if ( pos.get() > 0 )
-                longsShorts.first += pos;
-            else
-                longsShorts.second += pos;
-        }
-        
-        return longsShorts;
+        return TLongsShorts(_stratPnL.getLongs(), _stratPnL.getShorts());
     }
     
     double getRealizedPnL() const {
-        double pnl = 0.0;
-        
-        TInstrumentsPnL::const_iterator iter = _instrumentsPnL.begin();
-        TInstrumentsPnL::const_iterator end = _instrumentsPnL.end();
-        for ( ; iter != end; ++iter ) {
-            pnl += iter->second.getRealizedPnL();
-        }
-        
-        return pnl;
+        return _stratPnL.getRealizedPnL();
     }
     
     double getUnrealizedPnL() const {
-        double pnl = 0.0;
-        
-        TInstrumentsPnL::const_iterator iter = _instrumentsPnL.begin();
-        TInstrumentsPnL::const_iterator end = _instrumentsPnL.end();
-        for ( ; iter != end; ++iter ) {
-            pnl += iter->second.getUnrealizedPnL();
-        }
-        
-        return pnl;
+        return _stratPnL.getUnrealizedPnL();
     }
     
     TInstrumentsPnL _instrumentsPnL;
@@ -92,6 +68,12 @@ class ProcessorPnL : public tw::common::Singleton<ProcessorPnL> {
 public:
     typedef std::map<tw::risk::TStrategyId, StratPnL> TStratsPnL;
     
+    // Reverse index of all strategies' pnls by instrument - pnls are stored
+    // in node based maps, so pointers stay valid until clear()
+    //
+    typedef std::vector<TPnL*> TPnLs;
+    typedef std::tr1::unordered_map<tw::instr::Instrument::TKeyId, TPnLs> TInstrumentsIndex;
+    
 public:
     ProcessorPnL();
     ~ProcessorPnL();
@@ -125,18 +107,7 @@ public:
     }
     
     TLongsShorts getAccountLongsShorts() const {
-        TLongsShorts longsShorts;
-        longsShorts.first = longsShorts.second = tw::price::Size(0);
-        
-        TStratsPnL::const_iterator iter = _stratsPnL.begin();
-        TStratsPnL::const_iterator end = _stratsPnL.end();
-        for ( ; iter!=end; ++iter ) {
-            TLongsShorts ls = iter->second.getLongsShorts();
-            longsShorts.first += ls.first;
-            longsShorts.second += ls.second;
-        }
-        
-        return longsShorts;
+        return TLongsShorts(_accountPnL.getLongs(), _accountPnL.getShorts());
     }
     
     void updatePnLForTvForStratInstrument(const tw::instr::Instrument::TKeyId& instrId);
@@ -192,6 +163,7 @@ private:
     
     TPnLComposite _accountPnL;
     TStratsPnL _stratsPnL;
+    TInstrumentsIndex _instrumentsIndex;
 };
 
     
@@ -17,6 +17,7 @@ ProcessorRisk::~ProcessorRisk() {
 void ProcessorRisk::clear() {
     _account.clear();
     _params.clear();
+    ProcessorOrders::instance().getRiskSlots().clearRiskParams();
 }
 
 bool ProcessorRisk::init(const tw::risk::Account& account, const std::vector<tw::risk::AccountRiskParams>& params) {
@@ -24,9 +25,10 @@ bool ProcessorRisk::init(const tw::risk::Account& account, const std::vector<tw:
     tw::instr::InstrumentPtr instrument;
     for ( size_t i = 0; i < params.size(); ++i ) {    
         instrument = tw::instr::InstrumentManager::instance().getByDisplayName(params[i]._displayName);
-        if ( instrument )
+        if ( instrument ) {
             _params[instrument->_keyId] = params[i];
-        else
+            ProcessorOrders::instance().getRiskSlots().getOrCreate(_account._id, instrument->_keyId).setRiskParams(params[i]);
+        } else
             LOGGER_WARN << "Can't find instrument, trading is disabled for: " << params[i].toString() << "\n";
     }
     
@@ -75,32 +77,31 @@ bool ProcessorRisk::sendNew(const TOrderPtr& order, Reject& rej) {
     // If instrument is not configured to be tradable buy this account,
     // reject the order
     //
-    TInstrAccountRiskParams::iterator iter = _params.find(order->_instrumentId);
-    if ( iter == _params.end() ) {
+    const RiskSlot& slot = ProcessorOrders::instance().getRiskSlot(order);
+    if ( !slot._isRiskParamsSet ) {
         rej = getRej(eRejectReason::kSymbolNotConfigured);
         rej._text = _account.toString() + " :: " + order->_instrument->toString();
         return false;
     }
     
-    tw::risk::AccountRiskParams& param = iter->second;
-    if ( !param._tradeEnabled ) {
+    if ( !slot._tradeEnabled ) {
         rej = getRej(eRejectReason::kSymbolDisabled);
-        rej._text = _account.toString() + " :: " + param.toString();
+        rej._text = _account.toString() + " :: " + _params[order->_instrumentId].toString();
         return false;
     }
     
     // Check max clip size
     //
-    if ( order->_qty > static_cast<int32_t>(param._clipSize) ) {
+    if ( order->_qty > static_cast<int32_t>(slot._clipSize) ) {
         rej = getRej(eRejectReason::kSymbolClipSize);
-        rej._text = _account.toString() + " :: " + param.toString();
+        rej._text = _account.toString() + " :: " + _params[order->_instrumentId].toString();
         return false;
     }
     
     // Assumptions is made that ProcessorOrders has been called already
     //
     int32_t size = 0;
-    const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(order->_accountId, order->_instrumentId);
+    const AccountInstrOpenOrdersPos& openOrdersPos = slot._openOrdersPos;
     switch ( order->_side ) {
         case eOrderSide::kBuy:
             size = openOrdersPos._pos + openOrdersPos._bids.get();
@@ -114,9 +115,9 @@ bool ProcessorRisk::sendNew(const TOrderPtr& order, Reject& rej) {
             return false;
     }
     
-    if ( size > static_cast<int32_t>(param._maxPos) ) {
+    if ( size > static_cast<int32_t>(slot._maxPos) ) {
         rej = getRej(eRejectReason::kSymbolMaxPos);
-        rej._text = boost::lexical_cast<std::string>(size) + " :: " + param.toString();
+        rej._text = boost::lexical_cast<std::string>(size) + " :: " + _params[order->_instrumentId].toString();
         return false;
     }    
     
@@ -166,6 +167,7 @@ void ProcessorRisk::onCommand(const tw::common::Command& command) {
                 if ( iter->second._displayName == update._displayName ) {
                     LOGGER_WARN << "'UpdateAccountInstrument' \n==> Old: \n" << "\n" << iter->second.toStringVerbose() << "==> New: \n" << update.toStringVerbose() << "\n";
                     iter->second = update;
+                    ProcessorOrders::instance().getRiskSlots().getOrCreate(_account._id, iter->first).setRiskParams(update);
                 }
             }
             
@@ -207,21 +209,20 @@ bool ProcessorRisk::canSend(const TAccountId& accountId, tw::instr::Instrument::
     // If instrument is not configured to be tradable buy this account,
     // reject the order
     //
-    TInstrAccountRiskParams::iterator iter = _params.find(instrumentId);
-    if ( iter == _params.end() )
+    const RiskSlot* slot = ProcessorOrders::instance().getRiskSlots().find(accountId, instrumentId);
+    if ( NULL == slot || !slot->_isRiskParamsSet )
         return false;
     
-    tw::risk::AccountRiskParams& param = iter->second;
-    if ( !param._tradeEnabled )
+    if ( !slot->_tradeEnabled )
         return false;
     
     // Check max clip size
     //
-    if ( qty > static_cast<int32_t>(param._clipSize) )
+    if ( qty > static_cast<int32_t>(slot->_clipSize) )
         return false;
     
     int32_t size = 0;
-    const AccountInstrOpenOrdersPos& openOrdersPos = ProcessorOrders::instance().getInstrOpenOrdersPosForAccountInstr(accountId, instrumentId);
+    const AccountInstrOpenOrdersPos& openOrdersPos = slot->_openOrdersPos;
     switch ( side ) {
         case eOrderSide::kBuy:
             size = openOrdersPos._pos + openOrdersPos._bids.get();
@@ -233,22 +234,18 @@ bool ProcessorRisk::canSend(const TAccountId& accountId, tw::instr::Instrument::
             return false;
     }
     
-    if ( size + qty > static_cast<int32_t>(param._maxPos) )
+    if ( size + qty > static_cast<int32_t>(slot->_maxPos) )
         return false;
     
     return true;
 }
 
 bool ProcessorRisk::isTradeable(tw::instr::Instrument::TKeyId id) {
-    TInstrAccountRiskParams::iterator iter = _params.find(id);
-    if ( iter == _params.end() )
+    const RiskSlot* slot = ProcessorOrders::instance().getRiskSlots().find(_account._id, id);
+    if ( NULL == slot || !slot->_isRiskParamsSet )
         return false;
     
-    tw::risk::AccountRiskParams& param = iter->second;
-    if ( !param._tradeEnabled )
-        return false;
-    
-    return true;
+    return slot->_tradeEnabled;
 }
     
 } // namespace channel_or
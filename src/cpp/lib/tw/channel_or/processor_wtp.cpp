@@ -44,11 +44,19 @@ void ProcessorWTP::stop() {
 bool ProcessorWTP::canSend(const tw::instr::InstrumentConstPtr& instrument, eOrderSide side, const tw::price::Ticks& price, Reject& rej) {
     TOrdersBook& ordersBook = getOrCreateOrdersBook(instrument->_keyId);
     
+    // Only own order at the best price on the other side needs to be
+    // checked for crossing
+    //
     TOrderPtr crossingOrder;
-    if ( eOrderSide::kBuy == side )
-        crossingOrder = getCrossingOrder(ordersBook.second, price, std::greater_equal<tw::price::Ticks>());
-    else
-        crossingOrder = getCrossingOrder(ordersBook.first, price, std::less_equal<tw::price::Ticks>());
+    if ( eOrderSide::kBuy == side ) {
+        crossingOrder = ordersBook.second.getBest();
+        if ( NULL != crossingOrder && !(price >= crossingOrder->_wtpPrice) )
+            crossingOrder.reset();
+    } else {
+        crossingOrder = ordersBook.first.getBest();
+        if ( NULL != crossingOrder && !(price <= crossingOrder->_wtpPrice) )
+            crossingOrder.reset();
+    }
     
     if ( NULL != crossingOrder ) {
         if ( _settings._trading_wtp_use_quotes && instrument ) {
@@ -80,16 +88,16 @@ bool ProcessorWTP::sendNew(const TOrderPtr& order, Reject& rej) {
     if ( !canSend(order, order->_price, rej) )
         return false;
     
-    if ( eOrderSide::kBuy == order->_side )
-        getOrCreateOrdersBook(order->_instrumentId).first.push_back(order);
-    else
-        getOrCreateOrdersBook(order->_instrumentId).second.push_back(order);
-    
+    add(order);
     return true;
 }
 
 bool ProcessorWTP::sendMod(const TOrderPtr& order, Reject& rej) {
-    return canSend(order, order->_newPrice, rej);
+    if ( !canSend(order, order->_newPrice, rej) )
+        return false;
+    
+    add(order);
+    return true;
 }
 
 bool ProcessorWTP::sendCxl(const TOrderPtr& order, Reject& rej) {
@@ -101,6 +109,13 @@ void ProcessorWTP::onCommand(const tw::common::Command& command) {
     //
 }
 
+void ProcessorWTP::add(const TOrderPtr& order) {
+    if ( eOrderSide::kBuy == order->_side )
+        getOrCreateOrdersBook(order->_instrumentId).first.add(order);
+    else
+        getOrCreateOrdersBook(order->_instrumentId).second.add(order);
+}
+
 ProcessorWTP::TOrdersBook& ProcessorWTP::getOrCreateOrdersBook(const tw::instr::Instrument::TKeyId& v) {
     TOrdersBooks::iterator iter = _ordersBooks.find(v);
     if ( iter == _ordersBooks.end() )
@@ -5,16 +5,151 @@
 #include <tw/common/singleton.h>
 #include <tw/generated/channel_or_defs.h>
 
+#include <functional>
 #include <list>
 #include <map>
 
 namespace tw {
 namespace channel_or {
 
+// Own orders on one side of instrument's book, grouped by price level
+// from the most aggressive one. Each order is indexed once at its most
+// aggressive price (_price or _newPrice being modified to), which is
+// cached in Order::_wtpPrice. ProcessorWTP doesn't see acks/fills, so
+// orders which are no longer live or became less aggressive are removed
+// or re-indexed lazily when they reach the best level
+//
+template <typename TCompare>
+class OrdersLadder {
+public:
+    typedef std::list<TOrderPtr> TOrdersPerLevel;
+    typedef std::map<tw::price::Ticks, TOrdersPerLevel, TCompare> TLevels;
+    
+public:
+    OrdersLadder() : _size(0) {
+    }
+    
+    void clear() {
+        _levels.clear();
+        _size = 0;
+    }
+    
+    // Number of indexed orders
+    //
+    size_t size() const {
+        return _size;
+    }
+    
+    bool empty() const {
+        return (0 == _size);
+    }
+    
+public:
+    // Indexes order at its most aggressive price, considering _newPrice
+    // as order is about to be modified
+    //
+    void add(const TOrderPtr& order) {
+        rem(order);
+        
+        tw::price::Ticks price = getPrice(order, true);
+        if ( !price.isValid() )
+            return;
+        
+        order->_wtpPrice = price;
+        _levels[price].push_back(order);
+        ++_size;
+    }
+    
+    void rem(const TOrderPtr& order) {
+        if ( !order->_wtpPrice.isValid() )
+            return;
+        
+        typename TLevels::iterator iter = _levels.find(order->_wtpPrice);
+        order->_wtpPrice.clear();
+        if ( iter == _levels.end() )
+            return;
+        
+        TOrdersPerLevel& level = iter->second;
+        typename TOrdersPerLevel::iterator i = level.begin();
+        typename TOrdersPerLevel::iterator end = level.end();
+        for ( ; i != end; ++i ) {
+            if ( (*i) == order ) {
+                level.erase(i);
+                --_size;
+                break;
+            }
+        }
+        
+        if ( level.empty() )
+            _levels.erase(iter);
+    }
+    
+    // Returns live order at the most aggressive price (its price is in
+    // order's _wtpPrice) or empty pointer if there are no live orders
+    //
+    TOrderPtr getBest() {
+        while ( !_levels.empty() ) {
+            typename TLevels::iterator iter = _levels.begin();
+            TOrdersPerLevel& level = iter->second;
+            while ( !level.empty() ) {
+                TOrderPtr order = level.front();
+                bool live = isLive(order);
+                tw::price::Ticks price;
+                if ( live ) {
+                    price = getPrice(order, (eOrderState::kModifying == order->_state));
+                    if ( price == iter->first )
+                        return order;
+                }
+                
+                level.pop_front();
+                order->_wtpPrice.clear();
+                --_size;
+                
+                if ( live && price.isValid() ) {
+                    order->_wtpPrice = price;
+                    _levels[price].push_back(order);
+                    ++_size;
+                }
+            }
+            
+            _levels.erase(iter);
+        }
+        
+        return TOrderPtr();
+    }
+    
+private:
+    static bool isLive(const TOrderPtr& order) {
+        switch ( order->_state ) {
+            case eOrderState::kCancelled:
+            case eOrderState::kRejected:
+            case eOrderState::kFilled:
+                return false;
+            default:
+                break;
+        }
+        
+        return true;
+    }
+    
+    static tw::price::Ticks getPrice(const TOrderPtr& order, bool modifying) {
+        tw::price::Ticks price = order->_price;
+        if ( modifying && order->_newPrice.isValid() && (!price.isValid() || TCompare()(order->_newPrice, price)) )
+            price = order->_newPrice;
+        
+        return price;
+    }
+    
+private:
+    TLevels _levels;
+    size_t _size;
+};
+
 class ProcessorWTP : public tw::common::Singleton<ProcessorWTP> {
 public:
-    typedef std::list<TOrderPtr> TOrdersPerSide;
-    typedef std::pair<TOrdersPerSide, TOrdersPerSide> TOrdersBook;
+    typedef OrdersLadder<std::greater<tw::price::Ticks> > TBids;
+    typedef OrdersLadder<std::less<tw::price::Ticks> > TAsks;
+    typedef std::pair<TBids, TAsks> TOrdersBook;
     typedef std::map<tw::instr::Instrument::TKeyId, TOrdersBook> TOrdersBooks;
     
 public:
@@ -52,36 +187,8 @@ public:
     bool canSend(const TOrderPtr& order, const tw::price::Ticks& price, Reject& rej);
 
 private:
-    template <typename TOp>
-    TOrderPtr getCrossingOrder(TOrdersPerSide& ordersPerSide, const tw::price::Ticks& price, TOp op) {
-        if ( ordersPerSide.empty() )
-            return TOrderPtr();
-        
-        TOrdersPerSide::iterator iter = ordersPerSide.begin();
-        TOrdersPerSide::iterator end = ordersPerSide.end();
-        
-        while( iter != end ) {
-            switch ( (*iter)->_state ) {
-                case eOrderState::kCancelled:
-                case eOrderState::kRejected:
-                case eOrderState::kFilled:
-                    iter = ordersPerSide.erase(iter);
-                    break;
-                case eOrderState::kModifying:
-                    if ( (*iter)->_newPrice.isValid() && op(price, (*iter)->_newPrice) )
-                        return (*iter);
-                default:
-                    if ( (*iter)->_price.isValid() && op(price, (*iter)->_price) )
-                        return (*iter);
-                    ++iter;
-                    break;
-            }
-        }
-        
-        return TOrderPtr();
-    }
+    void add(const TOrderPtr& order);
     
-private:
     Reject getRej(eRejectReason reason) {
         tw::channel_or::Reject rej;
         
@@ -0,0 +1,57 @@
+#include <tw/channel_or/risk_slot.h>
+
+namespace tw {
+namespace channel_or {
+
+void RiskSlots::clearRiskParams() {
+    TSlots::iterator iter = _slots.begin();
+    TSlots::iterator end = _slots.end();
+    for ( ; iter != end; ++iter )
+        iter->clearRiskParams();
+}
+
+void RiskSlots::clearOpenOrdersPos() {
+    TSlots::iterator iter = _slots.begin();
+    TSlots::iterator end = _slots.end();
+    for ( ; iter != end; ++iter )
+        iter->clearOpenOrdersPos();
+}
+
+RiskSlot& RiskSlots::getOrCreate(const TAccountId& x, const tw::instr::Instrument::TKeyId& y) {
+    TIndex::iterator iter = _index.find(getKey(x, y));
+    if ( iter != _index.end() )
+        return *(iter->second);
+
+    _slots.push_back(RiskSlot());
+
+    RiskSlot& slot = _slots.back();
+    slot._accountId = x;
+    slot._instrumentId = y;
+    slot.clearOpenOrdersPos();
+
+    _index[getKey(x, y)] = &slot;
+
+    return slot;
+}
+
+RiskSlot* RiskSlots::find(const TAccountId& x, const tw::instr::Instrument::TKeyId& y) const {
+    TIndex::const_iterator iter = _index.find(getKey(x, y));
+    if ( iter == _index.end() )
+        return NULL;
+
+    return iter->second;
+}
+
+void RiskSlots::getAllForAccount(const TAccountId& x, TRiskSlotPtrs& slots) const {
+    slots.clear();
+
+    TSlots::const_iterator iter = _slots.begin();
+    TSlots::const_iterator end = _slots.end();
+    for ( ; iter != end; ++iter ) {
+        if ( iter->_accountId == x )
+            slots.push_back(const_cast<RiskSlot*>(&(*iter)));
+    }
+}
+
+} // namespace channel_or
+} // namespace tw
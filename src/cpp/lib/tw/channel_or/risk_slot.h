@@ -0,0 +1,123 @@
+#pragma once
+
+#include <tw/generated/channel_or_defs.h>
+#include <tw/generated/risk_defs.h>
+
+#include <deque>
+#include <vector>
+#include <tr1/unordered_map>
+
+namespace tw {
+namespace channel_or {
+
+// Per (account, instrument) state checked by out processors on every
+// order - risk limits (set by ProcessorRisk) and open orders/pos counts
+// (maintained by ProcessorOrders) are kept together, so the whole check
+// touches one slot instead of walking processors' maps
+//
+struct RiskSlot {
+    RiskSlot() {
+        clear();
+    }
+
+    void clear() {
+        _accountId = TAccountId();
+        _instrumentId = tw::instr::Instrument::TKeyId();
+
+        clearRiskParams();
+        clearOpenOrdersPos();
+    }
+
+    void clearRiskParams() {
+        _isRiskParamsSet = false;
+        _tradeEnabled = false;
+        _clipSize = 0;
+        _maxPos = 0;
+    }
+
+    void clearOpenOrdersPos() {
+        _isOpenOrdersPosSet = false;
+        _openOrdersPos.clear();
+        _openOrdersPos._accountId = _accountId;
+        _openOrdersPos._instrumentId = _instrumentId;
+        _openOrdersPos._bids.set(0);
+        _openOrdersPos._asks.set(0);
+    }
+
+    void setRiskParams(const tw::risk::AccountRiskParams& params) {
+        _isRiskParamsSet = true;
+        _tradeEnabled = params._tradeEnabled;
+        _clipSize = params._clipSize;
+        _maxPos = params._maxPos;
+    }
+
+    TAccountId _accountId;
+    tw::instr::Instrument::TKeyId _instrumentId;
+
+    // Copy of tw::risk::AccountRiskParams limits, _isRiskParamsSet is false
+    // if instrument isn't configured for account
+    //
+    bool _isRiskParamsSet;
+    bool _tradeEnabled;
+    uint32_t _clipSize;
+    uint32_t _maxPos;
+
+    bool _isOpenOrdersPosSet;
+    AccountInstrOpenOrdersPos _openOrdersPos;
+};
+
+// Table of risk slots - slots are never removed (clearXXX() only reset
+// their state), so slot pointers cached in Order::_riskSlot stay valid
+// for the lifetime of the table
+//
+class RiskSlots {
+public:
+    typedef std::vector<RiskSlot*> TRiskSlotPtrs;
+
+public:
+    RiskSlots() {
+    }
+
+    void clearRiskParams();
+    void clearOpenOrdersPos();
+
+    size_t size() const {
+        return _slots.size();
+    }
+
+public:
+    RiskSlot& getOrCreate(const TAccountId& x, const tw::instr::Instrument::TKeyId& y);
+    RiskSlot* find(const TAccountId& x, const tw::instr::Instrument::TKeyId& y) const;
+    void getAllForAccount(const TAccountId& x, TRiskSlotPtrs& slots) const;
+
+    // Resolves order's slot once and caches it on the order
+    //
+    RiskSlot& get(const TOrderPtr& order) {
+        RiskSlot* slot = order->_riskSlot;
+        if ( NULL == slot || slot->_accountId != order->_accountId || slot->_instrumentId != order->_instrumentId ) {
+            slot = &getOrCreate(order->_accountId, order->_instrumentId);
+            order->_riskSlot = slot;
+        }
+
+        return *slot;
+    }
+
+private:
+    typedef std::deque<RiskSlot> TSlots;
+    typedef std::tr1::unordered_map<uint64_t, RiskSlot*> TIndex;
+
+    static uint64_t getKey(const TAccountId& x, const tw::instr::Instrument::TKeyId& y) {
+        return (static_cast<uint64_t>(x) << 32) | static_cast<uint64_t>(y);
+    }
+
+private:
+    RiskSlots(const RiskSlots&);
+    RiskSlots& operator=(const RiskSlots&);
+
+private:
+    TSlots _slots;
+    TIndex _index;
+};
+
+} // namespace channel_or
+} // namespace tw
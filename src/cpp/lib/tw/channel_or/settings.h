@@ -27,6 +27,7 @@ public:
             (("storage.batch_cache_size"), _storage_batch_cache_size, "storage's batch cache size", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(100))
             (("storage.max_batch_cache_size"), _storage_max_batch_cache_size, "storage's max batch cache size", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(400))
             (("storage.persist_commands"), _storage_persist_commands, "specifies if to save commands log to db", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
+            (("storage.events_ring_size"), _storage_events_ring_size, "storage's preallocated ring size for orders/fills persistence events (rounded up to power of 2)", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(16384))
         
         ;
     }
@@ -38,6 +39,7 @@ public:
         _storage_batch_cache_size = 0;
         _storage_max_batch_cache_size = 0;
         _storage_persist_commands = false;
+        _storage_events_ring_size = 0;
     }
     
 public:
@@ -47,6 +49,7 @@ public:
     uint32_t _storage_batch_cache_size;
     uint32_t _storage_max_batch_cache_size;
     bool _storage_persist_commands;
+    uint32_t _storage_events_ring_size;
 };
     
 } // namespace channel_or
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <tw/generated/channel_or_defs.h>
+#include <tw/channel_or/orders_table.h>
+
+#include <set>
+#include <utility>
+
+namespace tw {
+namespace channel_or {
+
+// Orders waiting for exchange's response (pending/modifying/cancelling)
+// sorted by deadline after which they are considered 'stuck'. Deadline
+// of queued order is cached in Order::_stuckDeadline, so order can be
+// removed on ack without scanning the queue
+//
+class StuckOrdersQueue {
+public:
+    typedef std::pair<int64_t, TOrderPtr> TEntry;
+    typedef std::set<TEntry> TEntries;
+
+public:
+    StuckOrdersQueue() {
+    }
+
+    void clear() {
+        _entries.clear();
+    }
+
+    size_t size() const {
+        return _entries.size();
+    }
+
+    bool empty() const {
+        return _entries.empty();
+    }
+
+public:
+    // Adds order or moves already queued order to new deadline
+    //
+    void add(const TOrderPtr& order, int64_t deadline) {
+        rem(order);
+
+        order->_stuckDeadline = deadline;
+        _entries.insert(TEntry(deadline, order));
+    }
+
+    void rem(const TOrderPtr& order) {
+        _entries.erase(TEntry(order->_stuckDeadline, order));
+    }
+
+    // Removes from queue and returns orders with deadline before 'now'
+    //
+    void popExpired(int64_t now, TOrders& orders) {
+        orders.clear();
+
+        TEntries::iterator iter = _entries.begin();
+        TEntries::iterator end = _entries.end();
+        for ( ; iter != end && iter->first < now; ++iter )
+            orders.push_back(iter->second);
+
+        _entries.erase(_entries.begin(), iter);
+    }
+
+private:
+    TEntries _entries;
+};
+
+} // namespace channel_or
+} // namespace tw
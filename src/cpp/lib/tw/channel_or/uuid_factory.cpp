@@ -1,5 +1,6 @@
 #include <tw/channel_or/uuid_factory.h>
 #include <tw/common_thread/utils.h>
+#include <tw/common/thread_placement.h>
 #include <tw/log/defs.h>
 
 namespace tw {
@@ -28,7 +29,7 @@ bool UuidFactory::start(uint32_t size) {
         }
         
         _size = size;
-        _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&UuidFactory::ThreadMain, this)));
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kIdFactory, boost::bind(&UuidFactory::ThreadMain, this));
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
         status = false;
@@ -3,6 +3,7 @@
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/common_strat/strategy_container.h>
 #include <tw/common_thread/utils.h>
+#include <tw/common/instrumentation.h>
 #include <tw/channel_or_cme/id_factory.h>
 #include <tw/generated/channel_or_defs.h>
 #include <tw/generated/commands_common.h>
@@ -237,6 +238,7 @@ bool ChannelOrOnix::sendNew(const TOrderPtr& order, Reject& rej) {
             // Mark order timers
             //
             tw::common::THighResTimeScope orderTimer(order->_timestamp2, order->_timestamp3);
+            tw::common::LatencyScope sendTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kFixSend));
             
             _session->send(&(_translator.getMsgNew()));
         }
@@ -268,6 +270,7 @@ bool ChannelOrOnix::sendMod(const TOrderPtr& order, Reject& rej) {
             // Mark order timers
             //
             tw::common::THighResTimeScope orderTimer(order->_timestamp2, order->_timestamp3);
+            tw::common::LatencyScope sendTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kFixSend));
             
             _session->send(&(_translator.getMsgMod()));
         }
@@ -304,6 +307,7 @@ bool ChannelOrOnix::sendCxl(const TOrderPtr& order, Reject& rej) {
             // Mark order timers
             //
             tw::common::THighResTimeScope orderTimer(order->_timestamp2, order->_timestamp3);
+            tw::common::LatencyScope sendTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kFixSend));
 
             _session->send(&(_translator.getMsgCxl()));
         }
@@ -342,7 +346,7 @@ void ChannelOrOnix::onCommand(const tw::common::Command& command) {
     c._connectionId = command._connectionId;
     c._type = command._type;
     c._subType = command._subType;
-    tw::common_strat::StrategyContainer::instance().sendToMsgBusConnection(c._connectionId, c.toString()+"\n");
+    tw::common_strat::StrategyContainer::instance().sendToMsgBusConnection(c._connectionId, c);
 }
 
 bool ChannelOrOnix::rebuildOrder(const TOrderPtr& order, Reject& rej) {
@@ -0,0 +1,79 @@
+#include <tw/channel_or_cme/fix_message_view.h>
+
+#include <string.h>
+
+namespace tw {
+namespace channel_or_cme {
+
+FixMessageView::FixMessageView() {
+    _fields.reserve(64);
+}
+
+bool FixMessageView::parse(const char* data, size_t size) {
+    clear();
+
+    const char* p = data;
+    const char* end = data+size;
+    while ( p < end ) {
+        Field field;
+        field._tag = 0;
+
+        const char* tag = p;
+        while ( p < end && *p >= '0' && *p <= '9' )
+            field._tag = field._tag*10 + (*p++ - '0');
+
+        if ( p == tag || p == end || '=' != *p ) {
+            clear();
+            return false;
+        }
+
+        field._value = ++p;
+        while ( p < end && SOH != *p )
+            ++p;
+
+        field._length = p - field._value;
+        _fields.push_back(field);
+
+        // Skip SOH
+        //
+        ++p;
+    }
+
+    return !_fields.empty();
+}
+
+const FixMessageView::Field* FixMessageView::find(int32_t tag) const {
+    for ( size_t i = 0; i < _fields.size(); ++i ) {
+        if ( _fields[i]._tag == tag )
+            return &_fields[i];
+    }
+
+    return NULL;
+}
+
+std::string FixMessageView::get(int32_t tag) const {
+    const Field* field = find(tag);
+    if ( !field )
+        return std::string();
+
+    return std::string(field->_value, field->_length);
+}
+
+char FixMessageView::getChar(int32_t tag) const {
+    const Field* field = find(tag);
+    if ( !field || 0 == field->_length )
+        return '\0';
+
+    return field->_value[0];
+}
+
+bool FixMessageView::isEqual(int32_t tag, const char* value) const {
+    const Field* field = find(tag);
+    if ( !field )
+        return false;
+
+    return (::strlen(value) == field->_length && 0 == ::memcmp(field->_value, value, field->_length));
+}
+
+} // namespace channel_or_cme
+} // namespace tw
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <tw/common/defs.h>
+
+#include <string>
+#include <vector>
+
+namespace tw {
+namespace channel_or_cme {
+
+// Read only view of a raw SOH delimited FIX message: parse() tokenizes
+// message into tag/value fields in a single pass, values point into
+// caller's buffer, so nothing is copied or allocated (fields' storage is
+// reused by subsequent parse() calls)
+//
+// Only first occurrence of a tag is looked up, i.e. fields of repeating
+// groups are not distinguished
+//
+// NOTE: buffer must outlive the view and must not change while view is used
+//
+class FixMessageView {
+public:
+    static const char SOH = '\001';
+
+    struct Field {
+        int32_t _tag;
+        const char* _value;
+        size_t _length;
+    };
+
+    typedef std::vector<Field> TFields;
+
+public:
+    FixMessageView();
+
+    void clear() {
+        _fields.clear();
+    }
+
+    bool parse(const char* data, size_t size);
+
+    bool parse(const std::string& raw) {
+        return parse(raw.data(), raw.size());
+    }
+
+public:
+    const TFields& getFields() const {
+        return _fields;
+    }
+
+    const Field* find(int32_t tag) const;
+
+    bool contain(int32_t tag) const {
+        return (NULL != find(tag));
+    }
+
+    // Returns empty string if tag isn't present
+    //
+    std::string get(int32_t tag) const;
+
+    // Returns first char of tag's value or '\0' if tag isn't present or empty
+    //
+    char getChar(int32_t tag) const;
+
+    bool isEqual(int32_t tag, const char* value) const;
+
+    // MsgType(35)
+    //
+    char getType() const {
+        return getChar(35);
+    }
+
+private:
+    TFields _fields;
+};
+
+} // namespace channel_or_cme
+} // namespace tw
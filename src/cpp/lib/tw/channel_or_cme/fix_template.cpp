@@ -0,0 +1,231 @@
+#include <tw/channel_or_cme/fix_template.h>
+#include <tw/common_str_util/fast_numtoa.h>
+#include <tw/log/defs.h>
+
+#include <algorithm>
+#include <stdlib.h>
+
+namespace tw {
+namespace channel_or_cme {
+
+static const std::string TAG_BEGIN_STRING = "8";
+static const std::string TAG_BODY_LENGTH = "9";
+static const std::string TAG_CHECKSUM = "10";
+
+static uint32_t sum(const char* data, size_t size) {
+    uint32_t result = 0;
+    for ( size_t i = 0; i < size; ++i )
+        result += static_cast<unsigned char>(data[i]);
+
+    return result;
+}
+
+static uint32_t sum(const std::string& data) {
+    return sum(data.c_str(), data.size());
+}
+
+FixTemplate::FixTemplate() {
+    clear();
+}
+
+void FixTemplate::clear() {
+    _beginString.clear();
+    _beginStringSum = 0;
+    _suffix.clear();
+    _suffixSum = 0;
+    _fields.clear();
+    _message.clear();
+}
+
+bool FixTemplate::init(const std::string& raw, const TTags& tags) {
+    bool status = true;
+    try {
+        clear();
+
+        std::string pending;
+        size_t begin = 0;
+        while ( begin < raw.size() ) {
+            size_t end = raw.find(SOH, begin);
+            if ( std::string::npos == end )
+                end = raw.size();
+
+            std::string field = raw.substr(begin, end-begin);
+            begin = end+1;
+
+            size_t separator = field.find('=');
+            if ( std::string::npos == separator ) {
+                LOGGER_ERRO << "Invalid field: " << field << "\n";
+                clear();
+                return false;
+            }
+
+            std::string tag = field.substr(0, separator);
+            if ( tag == TAG_BEGIN_STRING ) {
+                _beginString = field + SOH;
+                continue;
+            }
+
+            if ( tag == TAG_BODY_LENGTH || tag == TAG_CHECKSUM )
+                continue;
+
+            int32_t tagNum = ::atoi(tag.c_str());
+            if ( std::find(tags.begin(), tags.end(), tagNum) == tags.end() ) {
+                pending += field + SOH;
+                continue;
+            }
+
+            if ( find(tagNum) ) {
+                LOGGER_ERRO << "Duplicate variable field: " << tagNum << "\n";
+                clear();
+                return false;
+            }
+
+            Field f;
+            f._tag = tagNum;
+            f._prefix = pending + field.substr(0, separator+1);
+            f._prefixSum = sum(f._prefix);
+            f._value = field.substr(separator+1);
+            f._valueSum = sum(f._value);
+            _fields.push_back(f);
+
+            pending = SOH;
+        }
+
+        _suffix = pending;
+        _suffixSum = sum(_suffix);
+
+        if ( _beginString.empty() ) {
+            LOGGER_ERRO << "No BeginString in: " << raw << "\n";
+            clear();
+            return false;
+        }
+        _beginStringSum = sum(_beginString);
+
+        if ( _fields.size() != tags.size() ) {
+            LOGGER_ERRO << "Not all variable fields are present: " << _fields.size() << " != " << tags.size() << "\n";
+            clear();
+            return false;
+        }
+
+        _message.reserve(raw.size()*2);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        status = false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        status = false;
+    }
+
+    if ( !status )
+        clear();
+
+    return status;
+}
+
+FixTemplate::Field* FixTemplate::find(int32_t tag) {
+    for ( size_t i = 0; i < _fields.size(); ++i ) {
+        if ( _fields[i]._tag == tag )
+            return &_fields[i];
+    }
+
+    return NULL;
+}
+
+bool FixTemplate::set(int32_t tag, const char* value, size_t length) {
+    Field* f = find(tag);
+    if ( !f )
+        return false;
+
+    f->_value.assign(value, length);
+    f->_valueSum = sum(value, length);
+    return true;
+}
+
+bool FixTemplate::set(int32_t tag, int64_t value) {
+    char buffer[32];
+    int32_t length = fast_litoa10(value, buffer);
+    return set(tag, buffer, length);
+}
+
+bool FixTemplate::set(int32_t tag, double value, int32_t precision) {
+    // NOTE: fast_dtoa2() drops trailing zeros, same as FIX engine does
+    //
+    char buffer[64];
+    int32_t length = fast_dtoa2(value, buffer, precision);
+    return set(tag, buffer, length);
+}
+
+const std::string& FixTemplate::encode() {
+    size_t bodyLength = _suffix.size();
+    uint32_t checksum = _beginStringSum + _suffixSum;
+
+    TFields::const_iterator iter = _fields.begin();
+    TFields::const_iterator end = _fields.end();
+    for ( ; iter != end; ++iter ) {
+        bodyLength += iter->_prefix.size() + iter->_value.size();
+        checksum += iter->_prefixSum + iter->_valueSum;
+    }
+
+    char buffer[32];
+    buffer[0] = '9';
+    buffer[1] = '=';
+    int32_t length = fast_uitoa10(static_cast<uint32_t>(bodyLength), buffer+2) + 2;
+    buffer[length++] = SOH;
+    checksum += sum(buffer, length);
+
+    _message.clear();
+    _message.append(_beginString);
+    _message.append(buffer, length);
+
+    for ( iter = _fields.begin(); iter != end; ++iter ) {
+        _message.append(iter->_prefix);
+        _message.append(iter->_value);
+    }
+
+    _message.append(_suffix);
+
+    checksum %= 256;
+    buffer[0] = '1';
+    buffer[1] = '0';
+    buffer[2] = '=';
+    buffer[3] = static_cast<char>('0' + checksum/100);
+    buffer[4] = static_cast<char>('0' + (checksum/10)%10);
+    buffer[5] = static_cast<char>('0' + checksum%10);
+    buffer[6] = SOH;
+    _message.append(buffer, 7);
+
+    return _message;
+}
+
+uint32_t FixTemplate::checksum(const char* data, size_t size) {
+    return sum(data, size) % 256;
+}
+
+bool FixTemplate::verify(const std::string& message) {
+    // Checksum
+    //
+    size_t checksumPos = message.rfind(std::string(1, SOH) + TAG_CHECKSUM + "=");
+    if ( std::string::npos == checksumPos )
+        return false;
+
+    ++checksumPos;
+    uint32_t value = ::atoi(message.c_str() + checksumPos + TAG_CHECKSUM.size() + 1);
+    if ( value != checksum(message.c_str(), checksumPos) )
+        return false;
+
+    // Body length
+    //
+    size_t bodyLengthPos = message.find(std::string(1, SOH) + TAG_BODY_LENGTH + "=");
+    if ( std::string::npos == bodyLengthPos )
+        return false;
+
+    size_t bodyPos = message.find(SOH, bodyLengthPos+1);
+    if ( std::string::npos == bodyPos )
+        return false;
+
+    uint32_t bodyLength = ::atoi(message.c_str() + bodyLengthPos + TAG_BODY_LENGTH.size() + 2);
+    return (bodyLength == checksumPos - (bodyPos+1));
+}
+
+} // namespace channel_or_cme
+} // namespace tw
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <tw/common/defs.h>
+
+#include <string>
+#include <vector>
+
+namespace tw {
+namespace channel_or_cme {
+
+// Pre-encoded FIX message, which is built once from a serialized prototype
+// message and in which only variable fields are patched in place.  Checksums
+// and lengths of the constant parts are precalculated, so encode() only copies
+// bytes and sums variable values to fix up BodyLength(9) and CheckSum(10)
+//
+// NOTE: template is NOT thread safe - synchronization is responsibility of the owner
+//
+class FixTemplate {
+public:
+    static const char SOH = '\001';
+
+    typedef std::vector<int32_t> TTags;
+
+public:
+    FixTemplate();
+
+    void clear();
+
+    bool isValid() const {
+        return !_beginString.empty();
+    }
+
+public:
+    // 'raw' - SOH delimited prototype message (BodyLength and CheckSum, if present,
+    // are ignored), 'tags' - variable fields, each of which must be present in 'raw'
+    //
+    bool init(const std::string& raw, const TTags& tags);
+
+    bool set(int32_t tag, const char* value, size_t length);
+
+    bool set(int32_t tag, const std::string& value) {
+        return set(tag, value.c_str(), value.size());
+    }
+
+    bool setChar(int32_t tag, char value) {
+        return set(tag, &value, 1);
+    }
+
+    bool setFlag(int32_t tag, bool value) {
+        return setChar(tag, value ? 'Y' : 'N');
+    }
+
+    bool set(int32_t tag, int64_t value);
+    bool set(int32_t tag, double value, int32_t precision);
+
+    // Returns complete message w/ recalculated BodyLength(9) and CheckSum(10)
+    //
+    const std::string& encode();
+
+    const std::string& get() const {
+        return _message;
+    }
+
+public:
+    // Helpers, used by unit tests/benchmarks to validate encoded messages
+    //
+    static uint32_t checksum(const char* data, size_t size);
+    static bool verify(const std::string& message);
+
+private:
+    struct Field {
+        Field() : _tag(0),
+                  _prefixSum(0),
+                  _valueSum(0) {
+        }
+
+        int32_t _tag;
+        std::string _prefix;        // constant bytes preceding value, including "<tag>="
+        uint32_t _prefixSum;
+        std::string _value;
+        uint32_t _valueSum;
+    };
+
+    typedef std::vector<Field> TFields;
+
+    Field* find(int32_t tag);
+
+private:
+    std::string _beginString;       // "8=FIX.4.2<SOH>"
+    uint32_t _beginStringSum;
+    std::string _suffix;            // constant bytes after last variable value
+    uint32_t _suffixSum;
+    TFields _fields;
+    std::string _message;
+};
+
+} // namespace channel_or_cme
+} // namespace tw
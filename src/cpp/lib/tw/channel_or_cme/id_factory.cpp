@@ -1,6 +1,7 @@
 #include <tw/channel_or_cme/id_factory.h>
 #include <tw/log/defs.h>
 #include <tw/common_thread/utils.h>
+#include <tw/common/thread_placement.h>
 
 #include "tw/common/high_res_time.h"
 
@@ -95,7 +96,7 @@ bool IdFactory::start(const Id::Type lastId, const uint32_t size) {
         }
         
         _size = size;
-        _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&IdFactory::ThreadMain, this)));
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kIdFactory, boost::bind(&IdFactory::ThreadMain, this));
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
         status = false;
@@ -20,6 +20,14 @@ void Translator::clear() {
     _msgNew.reset();
     _msgMod.reset();
     _msgCxl.reset();
+    
+    _templatesNew.clear();
+    _templatesMod.clear();
+    _templatesCxl.clear();
+    
+    _rawNew.clear();
+    _rawMod.clear();
+    _rawCxl.clear();
 }
 
 void Translator::setConstantFields(Message& msg) {
@@ -295,6 +303,247 @@ bool Translator::translateCxl(const tw::channel_or::TOrderPtr& order, tw::channe
     return status;
 }
 
+void Translator::setSessionFields(Message& msg, uint32_t seqNum, const std::string& sendingTime) {
+    msg.set(Tags::MsgSeqNum, static_cast<int32_t>(seqNum));
+    msg.set(Tags::SenderCompID, _settings->_senderCompId);
+    msg.set(Tags::SenderSubID, _settings->_senderSubId);
+    msg.set(Tags::SenderLocationID, _settings->_senderLocationId);
+    msg.set(Tags::TargetCompID, _settings->_targetCompId);
+    msg.set(Tags::TargetSubID, _settings->_targetSubId);
+    msg.set(Tags::SendingTime, sendingTime);
+}
+
+FixTemplate& Translator::getTemplate(TTemplates& templates, const tw::channel_or::TOrderPtr& order, bool useTimeInForce) {
+    bool ioc = useTimeInForce && (tw::channel_or::eTimeInForce::kIOC == order->_timeInForce);
+    return templates[TTemplateKey(order->_instrument->_keyId, ioc)];
+}
+
+bool Translator::buildTemplate(const Message& msg, uint32_t seqNum, const FixTemplate::TTags& tags, FixTemplate& t) {
+    Message prototype(msg);
+    setSessionFields(prototype, seqNum, msg.get(Tags::TransactTime));
+    
+    if ( !t.init(prototype.toString(FixTemplate::SOH), tags) ) {
+        LOGGER_ERRO << "Failed to build template from: " << prototype.toString(FIX_FIELDS_DELIMITER) << "\n";
+        return false;
+    }
+    
+    LOGGER_INFO << "Built template from: " << prototype.toString(FIX_FIELDS_DELIMITER) << "\n";
+    return true;
+}
+
+bool Translator::encodeNew(const tw::channel_or::TOrderPtr& order, uint32_t seqNum, tw::channel_or::Reject& rej) {
+    bool status = true;
+    try {
+        FixTemplate& t = getTemplate(_templatesNew, order, true);
+        
+        // Template is built from the first order translated by FIX engine
+        //
+        if ( !t.isValid() ) {
+            if ( !translateNew(order, rej) )
+                return false;
+            
+            FixTemplate::TTags tags;
+            tags.push_back(Tags::MsgSeqNum);
+            tags.push_back(Tags::SendingTime);
+            tags.push_back(Tags::Price);
+            tags.push_back(Tags::Side);
+            tags.push_back(Tags::OrderQty);
+            tags.push_back(CustomTags::ManualOrderIndicator);
+            tags.push_back(Tags::TransactTime);
+            tags.push_back(Tags::ClOrdID);
+            
+            if ( !buildTemplate(_msgNew, seqNum, tags, t) ) {
+                rej = getRej(tw::channel_or::eRejectReason::kSystemError);
+                return false;
+            }
+            
+            _rawNew = t.encode();
+            return true;
+        }
+        
+        if ( tw::channel_or::eOrderType::kLimit != order->_type ) {
+            rej = getRej(tw::channel_or::eRejectReason::kType);
+            return false;
+        }
+        
+        switch ( order->_side ) {
+            case tw::channel_or::eOrderSide::kBuy:
+                t.setChar(Tags::Side, '1');
+                break;
+            case tw::channel_or::eOrderSide::kSell:
+                t.setChar(Tags::Side, '2');
+                break;
+            default:
+                rej = getRej(tw::channel_or::eRejectReason::kSide);
+                return false;
+        }
+        
+        order->_exPrice = order->_instrument->_tc->toExchangePrice(order->_price);
+        t.set(Tags::Price, order->_exPrice, order->_instrument->_precision);
+        t.set(Tags::OrderQty, static_cast<int64_t>(order->_qty.get()));
+        t.setFlag(CustomTags::ManualOrderIndicator, order->_manual);
+        
+        std::string now = Timestamp::getUtcTimestampWithMilliseconds();
+        t.set(Tags::TransactTime, now);
+        t.set(Tags::SendingTime, now);
+        t.set(Tags::MsgSeqNum, static_cast<int64_t>(seqNum));
+        
+        order->_origClOrderId = order->_clOrderId = order->_corrClOrderId = IdFactory::instance().get().c_str();
+        order->_exSessionName = _settings->_senderCompId;
+        t.set(Tags::ClOrdID, order->_clOrderId);
+        
+        _rawNew = t.encode();
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
+        status = false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        status = false;
+    }
+    
+    return status;
+}
+
+bool Translator::encodeMod(const tw::channel_or::TOrderPtr& order, uint32_t seqNum, tw::channel_or::Reject& rej) {
+    bool status = true;
+    try {
+        FixTemplate& t = getTemplate(_templatesMod, order, true);
+        
+        if ( !t.isValid() ) {
+            if ( !translateMod(order, rej) )
+                return false;
+            
+            FixTemplate::TTags tags;
+            tags.push_back(Tags::MsgSeqNum);
+            tags.push_back(Tags::SendingTime);
+            tags.push_back(Tags::Price);
+            tags.push_back(Tags::Side);
+            tags.push_back(Tags::OrderQty);
+            tags.push_back(CustomTags::ManualOrderIndicator);
+            tags.push_back(Tags::TransactTime);
+            tags.push_back(Tags::ClOrdID);
+            tags.push_back(Tags::OrderID);
+            tags.push_back(Tags::OrigClOrdID);
+            
+            if ( !buildTemplate(_msgMod, seqNum, tags, t) ) {
+                rej = getRej(tw::channel_or::eRejectReason::kSystemError);
+                return false;
+            }
+            
+            _rawMod = t.encode();
+            return true;
+        }
+        
+        if ( tw::channel_or::eOrderType::kLimit != order->_type ) {
+            rej = getRej(tw::channel_or::eRejectReason::kType);
+            return false;
+        }
+        
+        switch ( order->_side ) {
+            case tw::channel_or::eOrderSide::kBuy:
+                t.setChar(Tags::Side, '1');
+                break;
+            case tw::channel_or::eOrderSide::kSell:
+                t.setChar(Tags::Side, '2');
+                break;
+            default:
+                rej = getRej(tw::channel_or::eRejectReason::kSide);
+                return false;
+        }
+        
+        order->_exNewPrice = order->_instrument->_tc->toExchangePrice(order->_newPrice);
+        t.set(Tags::Price, order->_exNewPrice, order->_instrument->_precision);
+        t.set(Tags::OrderQty, static_cast<int64_t>(order->_qty.get()));
+        t.setFlag(CustomTags::ManualOrderIndicator, order->_manual);
+        
+        std::string now = Timestamp::getUtcTimestampWithMilliseconds();
+        t.set(Tags::TransactTime, now);
+        t.set(Tags::SendingTime, now);
+        t.set(Tags::MsgSeqNum, static_cast<int64_t>(seqNum));
+        
+        order->_clOrderId = IdFactory::instance().get().c_str();
+        t.set(Tags::ClOrdID, order->_clOrderId);
+        t.set(Tags::OrderID, order->_exOrderId);
+        t.set(Tags::OrigClOrdID, order->_origClOrderId);
+        
+        _rawMod = t.encode();
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
+        status = false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        status = false;
+    }
+    
+    return status;
+}
+
+bool Translator::encodeCxl(const tw::channel_or::TOrderPtr& order, uint32_t seqNum, tw::channel_or::Reject& rej) {
+    bool status = true;
+    try {
+        FixTemplate& t = getTemplate(_templatesCxl, order, false);
+        
+        if ( !t.isValid() ) {
+            if ( !translateCxl(order, rej) )
+                return false;
+            
+            FixTemplate::TTags tags;
+            tags.push_back(Tags::MsgSeqNum);
+            tags.push_back(Tags::SendingTime);
+            tags.push_back(Tags::Side);
+            tags.push_back(CustomTags::ManualOrderIndicator);
+            tags.push_back(Tags::TransactTime);
+            tags.push_back(Tags::ClOrdID);
+            tags.push_back(Tags::OrderID);
+            tags.push_back(Tags::OrigClOrdID);
+            tags.push_back(CustomTags::CorrelationClOrdID);
+            
+            if ( !buildTemplate(_msgCxl, seqNum, tags, t) ) {
+                rej = getRej(tw::channel_or::eRejectReason::kSystemError);
+                return false;
+            }
+            
+            _rawCxl = t.encode();
+            return true;
+        }
+        
+        switch ( order->_side ) {
+            case tw::channel_or::eOrderSide::kBuy:
+                t.setChar(Tags::Side, '1');
+                break;
+            case tw::channel_or::eOrderSide::kSell:
+                t.setChar(Tags::Side, '2');
+                break;
+            default:
+                rej = getRej(tw::channel_or::eRejectReason::kSide);
+                return false;
+        }
+        
+        t.setFlag(CustomTags::ManualOrderIndicator, order->_manual);
+        
+        std::string now = Timestamp::getUtcTimestampWithMilliseconds();
+        t.set(Tags::TransactTime, now);
+        t.set(Tags::SendingTime, now);
+        t.set(Tags::MsgSeqNum, static_cast<int64_t>(seqNum));
+        
+        order->_clOrderId = IdFactory::instance().get().c_str();
+        t.set(Tags::ClOrdID, order->_clOrderId);
+        t.set(Tags::OrderID, order->_exOrderId);
+        t.set(Tags::OrigClOrdID, order->_origClOrderId);
+        t.set(CustomTags::CorrelationClOrdID, order->_corrClOrderId);
+        
+        _rawCxl = t.encode();
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
+        status = false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        status = false;
+    }
+    
+    return status;
+}
+
 bool Translator::translateMsgRej(const Message& rej, const Message& rejMsg, TMessagePtr& rejAckMsg) {
     bool status = true;
     try {
@@ -2,12 +2,15 @@
 
 #include <tw/common/defs.h>
 #include <tw/channel_or_cme/settings.h>
+#include <tw/channel_or_cme/fix_template.h>
 #include <tw/generated/channel_or_defs.h>
 
 #include <OnixS/FIXEngine.h>
 
 #include <boost/shared_ptr.hpp>
 
+#include <map>
+
 namespace tw {
 namespace channel_or_cme { 
     
@@ -60,6 +63,11 @@ public:
         return _settings;
     }
     
+    // Sets session level header fields, which are otherwise set by FIX engine's
+    // session on send
+    //
+    void setSessionFields(Message& msg, uint32_t seqNum, const std::string& sendingTime);
+    
 public:
     // Preformatted messages
     //
@@ -91,6 +99,31 @@ public:
     bool translateMod(const tw::channel_or::TOrderPtr& order, tw::channel_or::Reject& rej);
     bool translateCxl(const tw::channel_or::TOrderPtr& order, tw::channel_or::Reject& rej);
     
+public:
+    // 'Out' (prop to FIX wire format) pre-encoded translation
+    //
+    
+    // NOTE: templates are built per instrument/timeInForce on first use from messages
+    // above, as serialized by FIX engine, after which only variable fields (ClOrdID,
+    // price, qty, side, seqNum, times, etc.) are patched in place.  Translated orders'
+    // fields are updated the same way as by translateXXX() methods
+    //
+    bool encodeNew(const tw::channel_or::TOrderPtr& order, uint32_t seqNum, tw::channel_or::Reject& rej);
+    bool encodeMod(const tw::channel_or::TOrderPtr& order, uint32_t seqNum, tw::channel_or::Reject& rej);
+    bool encodeCxl(const tw::channel_or::TOrderPtr& order, uint32_t seqNum, tw::channel_or::Reject& rej);
+    
+    const std::string& getRawNew() const {
+        return _rawNew;
+    }
+    
+    const std::string& getRawMod() const {
+        return _rawMod;
+    }
+    
+    const std::string& getRawCxl() const {
+        return _rawCxl;
+    }
+    
 public:
     // 'In' (FIX to FIX) translation
     //
@@ -104,6 +137,13 @@ public:
     tw::channel_or::eOrderRespType getOrderRespTypeExecutionReport(const Message& msg);
     tw::channel_or::eOrderRespType getOrderRespTypeCancelReject(const Message& msg);
     
+protected:
+    typedef std::pair<tw::instr::Instrument::TKeyId, bool> TTemplateKey;
+    typedef std::map<TTemplateKey, FixTemplate> TTemplates;
+    
+    FixTemplate& getTemplate(TTemplates& templates, const tw::channel_or::TOrderPtr& order, bool useTimeInForce);
+    bool buildTemplate(const Message& msg, uint32_t seqNum, const FixTemplate::TTags& tags, FixTemplate& t);
+    
 protected:
     void setConstantFields(Message& msg);
     bool translateResp(const Message& msg, tw::channel_or::OrderResp& orderResp);
@@ -193,6 +233,14 @@ protected:
     Message _msgNew;
     Message _msgMod;
     Message _msgCxl;
+    
+    TTemplates _templatesNew;
+    TTemplates _templatesMod;
+    TTemplates _templatesCxl;
+    
+    std::string _rawNew;
+    std::string _rawMod;
+    std::string _rawCxl;
 };
     
 } // namespace channel_or_cme
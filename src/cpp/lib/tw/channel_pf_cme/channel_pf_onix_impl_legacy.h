@@ -4,6 +4,7 @@
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/price/ticks_converter.h>
 #include <tw/common/high_res_time.h>
+#include <tw/common/thread_placement.h>
 
 #include <stdio.h>
 #include <tw/common_str_util/fast_numtoa.h>
@@ -389,6 +390,10 @@ void ChannelPfOnix::onDirectBooksOutOfDate(const OnixS::CME::MarketData::Channel
 //
 void ChannelPfOnix::onDirectBookUpdated(const OnixS::CME::MarketData::Book& book,
                                         const OnixS::CME::MarketData::ChannelId& channelId) {
+    // OnixS's feed threads are registered on their first callback
+    //
+    tw::common::ThreadPlacement::instance().registerCurrentThread(tw::common::ThreadPlacement::kFeedHandler);
+    
     tw::price::QuoteStore::TQuote& quote = tw::price::QuoteStore::instance().getQuoteByKeyNum1(book.securityId());
     if ( !quote.isValid() || !quote.isSubscribed() )
         return;
@@ -3,6 +3,7 @@
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/price/ticks_converter.h>
 #include <tw/common/high_res_time.h>
+#include <tw/common/thread_placement.h>
 
 #include <stdio.h>
 #include <tw/common_str_util/fast_numtoa.h>
@@ -31,12 +32,25 @@ static void checkExchangeSlow(const OnixS::CME::MarketData::ChannelId& channelId
 
 static bool getMessageSendingTime(tw::common::THighResTime& timestamp, const OnixS::CME::MarketData::Message& message) {
     static const uint32_t tag_SendingTime = 52;
+#ifdef TW_HIGH_RES_TIME_NATIVE
+    OnixS::CME::MarketData::Timestamp value;
+    if ( !message.get(tag_SendingTime).toTimestamp(value) )
+        return false;
+    
+    timestamp = tw::common::THighResTime::fromNanos(value.sinceEpoch());
+    return true;
+#else
     return message.get(tag_SendingTime).toTimestamp(timestamp.getImpl());
+#endif
 }
 
 static bool getMessageStats(tw::price::Quote& quote, const OnixS::CME::MarketData::Message& message) {
     quote._seqNum = message.seqNum();
+#ifdef TW_HIGH_RES_TIME_NATIVE
+    quote._timestamp1 = tw::common::THighResTime::fromNanos(message.receiveTime().sinceEpoch());
+#else
     quote._timestamp1 = message.receiveTime();
+#endif
     if ( !quote._timestamp1.isValid() )
         quote._timestamp1.setToNow();
     
@@ -325,6 +339,10 @@ bool ChannelPfOnix::unsubscribe(tw::instr::InstrumentConstPtr instrument) {
 // need to revisit later
 //
 void ChannelPfOnix::onDirectBookUpdated(const OnixS::CME::MarketData::DirectBook& book, const OnixS::CME::MarketData::ChannelId& channelId) {
+    // OnixS's feed threads are registered on their first callback
+    //
+    tw::common::ThreadPlacement::instance().registerCurrentThread(tw::common::ThreadPlacement::kFeedHandler);
+    
     tw::price::QuoteStore::TQuote& quote = _quoteStoreManager.getStore().getQuoteByKeyNum1(book.securityId());
     if ( !quote.isValid() || !quote.isSubscribed() )
         return;
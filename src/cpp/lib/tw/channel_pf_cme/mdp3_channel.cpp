@@ -0,0 +1,660 @@
+#include <tw/channel_pf_cme/mdp3_channel.h>
+#include <tw/common_strat/consumer_proxy.h>
+#include <tw/log/defs.h>
+
+namespace tw {
+namespace channel_pf_cme {
+
+Mdp3Channel::Mdp3Channel() {
+    clear();
+}
+
+Mdp3Channel::~Mdp3Channel() {
+}
+
+void Mdp3Channel::clear() {
+    _channelId.clear();
+    _verbose = false;
+    _lastSeqNum = 0;
+    _seqNum = 0;
+    _books.clear();
+    _dirtyBooks.clear();
+    _stats.clear();
+}
+
+bool Mdp3Channel::subscribe(tw::instr::InstrumentConstPtr instrument) {
+    if ( !instrument || !instrument->isValid() ) {
+        LOGGER_ERRO << "Invalid instrument" << "\n";
+        return false;
+    }
+
+    TQuote& quote = tw::price::QuoteStore::instance().getQuoteByKeyNum1(instrument->_keyNum1);
+    if ( !quote.isValid() ) {
+        LOGGER_ERRO << "No quote for: " << instrument->_displayName << " :: " << instrument->_keyNum1 << "\n";
+        return false;
+    }
+
+    Book& book = _books[static_cast<int32_t>(instrument->_keyNum1)];
+    book.clear();
+    book._quote = &quote;
+
+    LOGGER_INFO << "Subscribed: " << _channelId << " :: " << instrument->_displayName << " :: " << instrument->_keyNum1 << "\n";
+
+    return true;
+}
+
+bool Mdp3Channel::unsubscribe(tw::instr::InstrumentConstPtr instrument) {
+    if ( !instrument )
+        return false;
+
+    _dirtyBooks.clear();
+    return (_books.erase(static_cast<int32_t>(instrument->_keyNum1)) > 0);
+}
+
+bool Mdp3Channel::isStale(int32_t securityId) const {
+    TBooks::const_iterator iter = _books.find(securityId);
+    if ( iter == _books.end() )
+        return false;
+
+    return iter->second._stale;
+}
+
+uint32_t Mdp3Channel::getRptSeq(int32_t securityId) const {
+    TBooks::const_iterator iter = _books.find(securityId);
+    if ( iter == _books.end() )
+        return 0;
+
+    return iter->second._rptSeq;
+}
+
+bool Mdp3Channel::onIncrementalPacket(const char* data, size_t size) {
+    _packetTime.setToNow();
+
+    if ( size < mdp3::PACKET_HEADER_SIZE ) {
+        ++_stats._decodeErrors;
+        return false;
+    }
+
+    ++_stats._packets;
+
+    // A/B feeds arbitration - MsgSeqNum resets to 1 at the start of the week
+    //
+    uint32_t seqNum = mdp3::get<uint32_t>(data);
+    if ( 0 != _lastSeqNum ) {
+        if ( seqNum <= _lastSeqNum && !(1 == seqNum && _lastSeqNum > 1) ) {
+            ++_stats._duplicatePackets;
+            return true;
+        }
+
+        if ( seqNum > _lastSeqNum+1 ) {
+            ++_stats._gaps;
+            LOGGER_WARN << "Packet gap in channel: " << _channelId << " :: " << _lastSeqNum << " -> " << seqNum << "\n";
+        }
+    }
+
+    _lastSeqNum = seqNum;
+    _seqNum = seqNum;
+
+    bool status = true;
+    const char* end = data + size;
+    const char* message = data + mdp3::PACKET_HEADER_SIZE;
+    while ( message < end ) {
+        if ( static_cast<size_t>(end - message) < mdp3::MESSAGE_SIZE_SIZE + mdp3::MESSAGE_HEADER_SIZE ) {
+            ++_stats._decodeErrors;
+            status = false;
+            break;
+        }
+
+        uint16_t messageSize = mdp3::get<uint16_t>(message);
+        if ( messageSize < mdp3::MESSAGE_SIZE_SIZE + mdp3::MESSAGE_HEADER_SIZE || messageSize > end - message ) {
+            ++_stats._decodeErrors;
+            status = false;
+            break;
+        }
+
+        uint16_t blockLength = mdp3::get<uint16_t>(message + mdp3::MESSAGE_SIZE_SIZE);
+        uint16_t templateId = mdp3::get<uint16_t>(message + mdp3::MESSAGE_SIZE_SIZE + 2);
+
+        ++_stats._messages;
+        if ( !processMessage(templateId, blockLength, message + mdp3::MESSAGE_SIZE_SIZE + mdp3::MESSAGE_HEADER_SIZE, message + messageSize) )
+            ++_stats._decodeErrors;
+
+        message += messageSize;
+    }
+
+    publishDirty();
+
+    return status;
+}
+
+bool Mdp3Channel::onSnapshotPacket(const char* data, size_t size) {
+    _packetTime.setToNow();
+
+    if ( size < mdp3::PACKET_HEADER_SIZE ) {
+        ++_stats._decodeErrors;
+        return false;
+    }
+
+    bool status = true;
+    const char* end = data + size;
+    const char* message = data + mdp3::PACKET_HEADER_SIZE;
+    while ( message < end ) {
+        if ( static_cast<size_t>(end - message) < mdp3::MESSAGE_SIZE_SIZE + mdp3::MESSAGE_HEADER_SIZE ) {
+            ++_stats._decodeErrors;
+            status = false;
+            break;
+        }
+
+        uint16_t messageSize = mdp3::get<uint16_t>(message);
+        if ( messageSize < mdp3::MESSAGE_SIZE_SIZE + mdp3::MESSAGE_HEADER_SIZE || messageSize > end - message ) {
+            ++_stats._decodeErrors;
+            status = false;
+            break;
+        }
+
+        uint16_t blockLength = mdp3::get<uint16_t>(message + mdp3::MESSAGE_SIZE_SIZE);
+        uint16_t templateId = mdp3::get<uint16_t>(message + mdp3::MESSAGE_SIZE_SIZE + 2);
+
+        if ( mdp3::kSnapshotFullRefresh == templateId ) {
+            if ( !processSnapshot(blockLength, message + mdp3::MESSAGE_SIZE_SIZE + mdp3::MESSAGE_HEADER_SIZE, message + messageSize) )
+                ++_stats._decodeErrors;
+        }
+
+        message += messageSize;
+    }
+
+    publishDirty();
+
+    return status;
+}
+
+bool Mdp3Channel::processMessage(uint16_t templateId, uint16_t blockLength, const char* data, const char* end) {
+    switch ( templateId ) {
+        case mdp3::kIncrementalRefreshBook:
+        case mdp3::kIncrementalRefreshTradeSummary:
+        case mdp3::kIncrementalRefreshVolume:
+        case mdp3::kIncrementalRefreshDailyStatistics:
+        case mdp3::kIncrementalRefreshLimitsBanding:
+        case mdp3::kIncrementalRefreshSessionStatistics:
+            return processIncremental(templateId, blockLength, data, end);
+        case mdp3::kChannelReset:
+            return processChannelReset();
+        case mdp3::kSecurityStatus:
+            return processSecurityStatus(blockLength, data, end);
+        default:
+            break;
+    }
+
+    return true;
+}
+
+bool Mdp3Channel::processIncremental(uint16_t templateId, uint16_t blockLength, const char* data, const char* end) {
+    if ( static_cast<size_t>(end - data) < blockLength + mdp3::GROUP_SIZE_SIZE )
+        return false;
+
+    uint8_t matchEventIndicator = 0;
+    size_t entrySize = 0;
+    const mdp3::SequenceEntryLayout* layout = NULL;
+    switch ( templateId ) {
+        case mdp3::kIncrementalRefreshBook:
+            if ( blockLength < mdp3::IncrementalRefreshLayout::ROOT_SIZE )
+                return false;
+
+            matchEventIndicator = mdp3::get<uint8_t>(data + mdp3::IncrementalRefreshLayout::MATCH_EVENT_INDICATOR);
+            entrySize = mdp3::BookEntryLayout::ENTRY_TYPE + 1;
+            break;
+        case mdp3::kIncrementalRefreshTradeSummary:
+            if ( blockLength < mdp3::IncrementalRefreshLayout::ROOT_SIZE )
+                return false;
+
+            matchEventIndicator = mdp3::get<uint8_t>(data + mdp3::IncrementalRefreshLayout::MATCH_EVENT_INDICATOR);
+            entrySize = mdp3::TradeEntryLayout::UPDATE_ACTION + 1;
+            break;
+        default:
+            for ( size_t i = 0; i < mdp3::SEQUENCE_ENTRY_LAYOUTS_SIZE; ++i ) {
+                if ( mdp3::SEQUENCE_ENTRY_LAYOUTS[i]._templateId == templateId ) {
+                    layout = &mdp3::SEQUENCE_ENTRY_LAYOUTS[i];
+                    break;
+                }
+            }
+
+            if ( !layout )
+                return true;
+
+            entrySize = layout->_rptSeq + sizeof(uint32_t);
+            break;
+    }
+
+    const char* group = data + blockLength;
+    uint16_t entryBlockLength = mdp3::get<uint16_t>(group);
+    uint8_t numInGroup = mdp3::get<uint8_t>(group + 2);
+    group += mdp3::GROUP_SIZE_SIZE;
+
+    if ( entryBlockLength < entrySize || static_cast<size_t>(end - group) < static_cast<size_t>(entryBlockLength) * numInGroup )
+        return false;
+
+    mdp3::Entry entry;
+    for ( uint8_t i = 0; i < numInGroup; ++i, group += entryBlockLength ) {
+        switch ( templateId ) {
+            case mdp3::kIncrementalRefreshBook:
+                entry._kind = mdp3::Entry::kKindBook;
+                entry._price = mdp3::get<int64_t>(group + mdp3::BookEntryLayout::PRICE);
+                entry._qty = mdp3::get<int32_t>(group + mdp3::BookEntryLayout::QTY);
+                entry._securityId = mdp3::get<int32_t>(group + mdp3::BookEntryLayout::SECURITY_ID);
+                entry._rptSeq = mdp3::get<uint32_t>(group + mdp3::BookEntryLayout::RPT_SEQ);
+                entry._numOrders = mdp3::get<int32_t>(group + mdp3::BookEntryLayout::NUM_ORDERS);
+                entry._level = mdp3::get<uint8_t>(group + mdp3::BookEntryLayout::PRICE_LEVEL);
+                entry._action = mdp3::get<uint8_t>(group + mdp3::BookEntryLayout::UPDATE_ACTION);
+                entry._type = mdp3::get<char>(group + mdp3::BookEntryLayout::ENTRY_TYPE);
+                break;
+            case mdp3::kIncrementalRefreshTradeSummary:
+                entry._kind = mdp3::Entry::kKindTrade;
+                entry._price = mdp3::get<int64_t>(group + mdp3::TradeEntryLayout::PRICE);
+                entry._qty = mdp3::get<int32_t>(group + mdp3::TradeEntryLayout::QTY);
+                entry._securityId = mdp3::get<int32_t>(group + mdp3::TradeEntryLayout::SECURITY_ID);
+                entry._rptSeq = mdp3::get<uint32_t>(group + mdp3::TradeEntryLayout::RPT_SEQ);
+                entry._numOrders = mdp3::get<int32_t>(group + mdp3::TradeEntryLayout::NUM_ORDERS);
+                entry._aggressorSide = mdp3::get<uint8_t>(group + mdp3::TradeEntryLayout::AGGRESSOR_SIDE);
+                entry._action = mdp3::get<uint8_t>(group + mdp3::TradeEntryLayout::UPDATE_ACTION);
+                entry._type = mdp3::kTrade;
+                break;
+            default:
+                entry._kind = mdp3::Entry::kKindSequence;
+                entry._securityId = mdp3::get<int32_t>(group + layout->_securityId);
+                entry._rptSeq = mdp3::get<uint32_t>(group + layout->_rptSeq);
+                break;
+        }
+
+        onEntry(entry);
+    }
+
+    if ( matchEventIndicator & mdp3::END_OF_EVENT )
+        publishDirty();
+
+    return true;
+}
+
+bool Mdp3Channel::processSnapshot(uint16_t blockLength, const char* data, const char* end) {
+    if ( blockLength < mdp3::SnapshotLayout::ROOT_SIZE || static_cast<size_t>(end - data) < blockLength + mdp3::GROUP_SIZE_SIZE )
+        return false;
+
+    int32_t securityId = mdp3::get<int32_t>(data + mdp3::SnapshotLayout::SECURITY_ID);
+    Book* book = getBook(securityId);
+    if ( !book )
+        return true;
+
+    // Snapshots are only needed for books which are stale or were
+    // never initialized
+    //
+    if ( !book->_stale && 0 != book->_rptSeq )
+        return true;
+
+    // Snapshot must cover everything up to first queued entry, otherwise
+    // wait for the next snapshot cycle
+    //
+    uint32_t rptSeq = mdp3::get<uint32_t>(data + mdp3::SnapshotLayout::RPT_SEQ);
+    uint32_t required = book->_pending.empty() ? book->_lastSeenRptSeq : book->_pending.front()._rptSeq - 1;
+    if ( rptSeq < required )
+        return true;
+
+    const char* group = data + blockLength;
+    uint16_t entryBlockLength = mdp3::get<uint16_t>(group);
+    uint8_t numInGroup = mdp3::get<uint8_t>(group + 2);
+    group += mdp3::GROUP_SIZE_SIZE;
+
+    if ( entryBlockLength < mdp3::SnapshotEntryLayout::ENTRY_TYPE + 1 || static_cast<size_t>(end - group) < static_cast<size_t>(entryBlockLength) * numInGroup )
+        return false;
+
+    book->clearLevels();
+    for ( uint8_t i = 0; i < numInGroup; ++i, group += entryBlockLength ) {
+        char type = mdp3::get<char>(group + mdp3::SnapshotEntryLayout::ENTRY_TYPE);
+        if ( mdp3::kBid != type && mdp3::kOffer != type )
+            continue;
+
+        int8_t level = mdp3::get<int8_t>(group + mdp3::SnapshotEntryLayout::PRICE_LEVEL);
+        if ( level < 1 || static_cast<uint32_t>(level) > MAX_DEPTH )
+            continue;
+
+        Level& to = (mdp3::kBid == type) ? book->_bids[level-1] : book->_asks[level-1];
+        to._price = mdp3::get<int64_t>(group + mdp3::SnapshotEntryLayout::PRICE);
+        to._qty = mdp3::get<int32_t>(group + mdp3::SnapshotEntryLayout::QTY);
+        to._numOrders = mdp3::get<int32_t>(group + mdp3::SnapshotEntryLayout::NUM_ORDERS);
+    }
+
+    book->_rptSeq = rptSeq;
+    if ( book->_lastSeenRptSeq < rptSeq )
+        book->_lastSeenRptSeq = rptSeq;
+
+    ++_stats._snapshotsApplied;
+
+    // Apply queued entries - trades are not published, since they are
+    // already stale
+    //
+    while ( !book->_pending.empty() ) {
+        const mdp3::Entry& entry = book->_pending.front();
+        if ( entry._rptSeq > book->_rptSeq+1 )
+            break;
+
+        if ( entry._rptSeq == book->_rptSeq+1 )
+            applyEntry(*book, entry, false);
+
+        book->_pending.pop_front();
+    }
+
+    if ( !book->_pending.empty() ) {
+        LOGGER_WARN << "Book is still stale after snapshot: " << _channelId << " :: " << securityId << " :: " << book->_rptSeq << " -> " << book->_pending.front()._rptSeq << "\n";
+        return true;
+    }
+
+    if ( book->_stale ) {
+        book->_stale = false;
+        publishStatus(*book, tw::price::Quote::kDataRecoveryFinish);
+
+        if ( _verbose )
+            LOGGER_INFO << "Book recovered: " << _channelId << " :: " << securityId << " :: " << book->_rptSeq << "\n";
+    }
+
+    markDirty(*book);
+
+    return true;
+}
+
+bool Mdp3Channel::processChannelReset() {
+    LOGGER_WARN << "Channel reset: " << _channelId << "\n";
+
+    publishDirty();
+
+    TBooks::iterator iter = _books.begin();
+    TBooks::iterator end = _books.end();
+    for ( ; iter != end; ++iter ) {
+        iter->second.clear();
+        markDirty(iter->second);
+    }
+
+    return true;
+}
+
+bool Mdp3Channel::processSecurityStatus(uint16_t blockLength, const char* data, const char* end) {
+    if ( blockLength < mdp3::SecurityStatusLayout::ROOT_SIZE || static_cast<size_t>(end - data) < blockLength )
+        return false;
+
+    int32_t securityId = mdp3::get<int32_t>(data + mdp3::SecurityStatusLayout::SECURITY_ID);
+    if ( mdp3::INT32_NULL == securityId )
+        return true;
+
+    Book* book = getBook(securityId);
+    if ( !book )
+        return true;
+
+    switch ( mdp3::get<uint8_t>(data + mdp3::SecurityStatusLayout::SECURITY_TRADING_STATUS) ) {
+        case mdp3::kTradingHalt:
+            publishStatus(*book, tw::price::Quote::kTradingHaltedOrStopped);
+            break;
+        case mdp3::kReadyToTrade:
+            publishStatus(*book, tw::price::Quote::kTradingResumeOrOpen);
+            break;
+        case mdp3::kClose:
+        case mdp3::kPostClose:
+            publishStatus(*book, tw::price::Quote::kTradingSessionEnd);
+            break;
+        case mdp3::kNotAvailableForTrading:
+            publishStatus(*book, tw::price::Quote::kTradingPause);
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+void Mdp3Channel::onEntry(const mdp3::Entry& entry) {
+    Book* book = getBook(entry._securityId);
+    if ( !book )
+        return;
+
+    if ( book->_lastSeenRptSeq < entry._rptSeq )
+        book->_lastSeenRptSeq = entry._rptSeq;
+
+    if ( book->_stale ) {
+        if ( book->_pending.size() >= MAX_PENDING_ENTRIES ) {
+            LOGGER_WARN << "Too many queued entries, dropping: " << _channelId << " :: " << entry._securityId << "\n";
+            book->_pending.clear();
+        }
+
+        book->_pending.push_back(entry);
+        return;
+    }
+
+    if ( entry._rptSeq <= book->_rptSeq )
+        return;
+
+    if ( entry._rptSeq != book->_rptSeq+1 ) {
+        ++_stats._bookGaps;
+        LOGGER_WARN << "RptSeq gap: " << _channelId << " :: " << entry._securityId << " :: " << book->_rptSeq << " -> " << entry._rptSeq << "\n";
+
+        setStale(*book);
+        book->_pending.push_back(entry);
+        return;
+    }
+
+    applyEntry(*book, entry, true);
+}
+
+void Mdp3Channel::applyEntry(Book& book, const mdp3::Entry& entry, bool publish) {
+    book._rptSeq = entry._rptSeq;
+
+    switch ( entry._kind ) {
+        case mdp3::Entry::kKindBook:
+            applyBookEntry(book, entry);
+            break;
+        case mdp3::Entry::kKindTrade:
+            if ( publish )
+                applyTradeEntry(book, entry);
+            break;
+        default:
+            break;
+    }
+}
+
+void Mdp3Channel::applyBookEntry(Book& book, const mdp3::Entry& entry) {
+    Level value;
+    value._price = entry._price;
+    value._qty = entry._qty;
+    value._numOrders = entry._numOrders;
+
+    switch ( entry._type ) {
+        case mdp3::kBid:
+            updateLevels(book._bids, entry._action, entry._level, value);
+            break;
+        case mdp3::kOffer:
+            updateLevels(book._asks, entry._action, entry._level, value);
+            break;
+        case mdp3::kBookReset:
+            book.clearLevels();
+            break;
+        default:
+            // NOTE: implied books are not built
+            //
+            return;
+    }
+
+    markDirty(book);
+}
+
+void Mdp3Channel::updateLevels(Level* levels, uint8_t action, uint8_t level, const Level& value) {
+    if ( mdp3::kDeleteThru == action ) {
+        for ( uint32_t i = 0; i < MAX_DEPTH; ++i )
+            levels[i].clear();
+        return;
+    }
+
+    if ( level < 1 || level > MAX_DEPTH )
+        return;
+
+    uint32_t index = level-1;
+    switch ( action ) {
+        case mdp3::kNew:
+            for ( uint32_t i = MAX_DEPTH-1; i > index; --i )
+                levels[i] = levels[i-1];
+            levels[index] = value;
+            break;
+        case mdp3::kChange:
+        case mdp3::kOverlay:
+            levels[index] = value;
+            break;
+        case mdp3::kDelete:
+            for ( uint32_t i = index; i < MAX_DEPTH-1; ++i )
+                levels[i] = levels[i+1];
+            levels[MAX_DEPTH-1].clear();
+            break;
+        case mdp3::kDeleteFrom:
+            for ( uint32_t i = 0; i < MAX_DEPTH; ++i ) {
+                if ( i+level < MAX_DEPTH )
+                    levels[i] = levels[i+level];
+                else
+                    levels[i].clear();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void Mdp3Channel::applyTradeEntry(Book& book, const mdp3::Entry& entry) {
+    TQuote& quote = *book._quote;
+
+    quote.clearRuntime();
+    quote._timestamp1 = _packetTime;
+
+    quote._trade._condition = tw::price::Trade::kConditionUnknown;
+    quote._trade._tickDirection = tw::price::Trade::kTickDirectionUnknown;
+
+    switch ( entry._action ) {
+        case mdp3::kNew:
+            quote._trade._updateAction = tw::price::Trade::kUpdateActionNew;
+            break;
+        case mdp3::kDelete:
+            quote._trade._updateAction = tw::price::Trade::kUpdateActionDelete;
+            break;
+        default:
+            quote._trade._updateAction = tw::price::Trade::kUpdateActionUnknown;
+            break;
+    }
+
+    switch ( entry._aggressorSide ) {
+        case mdp3::kAggressorBuy:
+            quote._trade._aggressorSide = tw::price::Trade::kAggressorSideBuy;
+            break;
+        case mdp3::kAggressorSell:
+            quote._trade._aggressorSide = tw::price::Trade::kAggressorSideSell;
+            break;
+        default:
+            quote._trade._aggressorSide = tw::price::Trade::kAggressorSideUnknown;
+            break;
+    }
+
+    quote._trade._price = quote._convertFrom(entry._price * mdp3::PRICE_EXPONENT);
+    quote._trade._size.set(entry._qty);
+    quote.setTrade();
+    quote._seqNum = _seqNum;
+    quote._timestamp2.setToNow();
+
+    tw::common_strat::ConsumerProxy::instance().onQuote(quote);
+    ++_stats._quotesPublished;
+
+    if ( _verbose )
+        LOGGER_INFO << "TRADES: " << _channelId << " :: " << quote.toString() << "\n";
+}
+
+void Mdp3Channel::setStale(Book& book) {
+    book._stale = true;
+    publishStatus(book, tw::price::Quote::kStaleQuote);
+}
+
+void Mdp3Channel::publishStatus(Book& book, tw::price::Quote::eStatus status) {
+    TQuote& quote = *book._quote;
+
+    quote.clearRuntime();
+    quote._timestamp1 = _packetTime;
+    quote._status = status;
+    quote._timestamp2.setToNow();
+
+    tw::common_strat::ConsumerProxy::instance().onQuote(quote);
+    ++_stats._quotesPublished;
+}
+
+void Mdp3Channel::publishDirty() {
+    TDirtyBooks::iterator iter = _dirtyBooks.begin();
+    TDirtyBooks::iterator end = _dirtyBooks.end();
+    for ( ; iter != end; ++iter ) {
+        Book& book = *(*iter);
+        book._dirty = false;
+        if ( !book._stale )
+            publish(book);
+    }
+
+    _dirtyBooks.clear();
+}
+
+void Mdp3Channel::publish(Book& book) {
+    TQuote& quote = *book._quote;
+
+    quote.clearRuntime();
+    quote._timestamp1 = _packetTime;
+
+    uint32_t numOfLevels = std::min(MAX_DEPTH, static_cast<uint32_t>(TQuote::SIZE));
+    for ( uint32_t count = 0; count < numOfLevels; ++count ) {
+        {
+            // Set bid
+            //
+            const Level& priceLevelFrom = book._bids[count];
+            tw::price::PriceSizeNumOfOrders& priceLevelTo = quote._book[count]._bid;
+
+            tw::price::Ticks ticks;
+            if ( priceLevelFrom._qty > 0 )
+                ticks = quote._convertFrom(priceLevelFrom._price * mdp3::PRICE_EXPONENT);
+
+            if ( ticks != priceLevelTo._price )
+                quote.setBidPrice(ticks, count);
+
+            tw::price::Size size(static_cast<tw::price::Size::type>(priceLevelFrom._qty));
+            if ( size != priceLevelTo._size )
+                quote.setBidSize(size, count);
+
+            priceLevelTo._numOrders = priceLevelFrom._numOrders;
+        }
+
+        {
+            // Set ask
+            //
+            const Level& priceLevelFrom = book._asks[count];
+            tw::price::PriceSizeNumOfOrders& priceLevelTo = quote._book[count]._ask;
+
+            tw::price::Ticks ticks;
+            if ( priceLevelFrom._qty > 0 )
+                ticks = quote._convertFrom(priceLevelFrom._price * mdp3::PRICE_EXPONENT);
+
+            if ( ticks != priceLevelTo._price )
+                quote.setAskPrice(ticks, count);
+
+            tw::price::Size size(static_cast<tw::price::Size::type>(priceLevelFrom._qty));
+            if ( size != priceLevelTo._size )
+                quote.setAskSize(size, count);
+
+            priceLevelTo._numOrders = priceLevelFrom._numOrders;
+        }
+    }
+
+    if ( quote.isChanged() ) {
+        quote._seqNum = _seqNum;
+        quote._timestamp2.setToNow();
+        tw::common_strat::ConsumerProxy::instance().onQuote(quote);
+        ++_stats._quotesPublished;
+
+        if ( _verbose )
+            LOGGER_INFO << "BOOKS: " << _channelId << " :: " << quote.toString() << "\n";
+    }
+}
+
+} // namespace channel_pf_cme
+} // namespace tw
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/channel_pf_cme/mdp3_defs.h>
+#include <tw/generated/instrument.h>
+#include <tw/price/quote_store.h>
+
+#include <deque>
+#include <vector>
+
+#include <tr1/unordered_map>
+
+namespace tw {
+namespace channel_pf_cme {
+
+// Native decoder and price level book builder for a single CME MDP3 channel,
+// which writes books/trades directly into tw::price::QuoteStore's quotes
+// and notifies consumers through tw::common_strat::ConsumerProxy
+//
+// Sequencing:
+//      - incremental packets from A/B feeds are arbitrated by packet's
+//      MsgSeqNum - duplicates are dropped, gaps are counted
+//      - each instrument's book is sequenced by RptSeq - on RptSeq gap, book
+//      is marked stale (kStaleQuote is published) and incremental entries are
+//      queued until SnapshotFullRefresh(52) from snapshot feed is received,
+//      after which queued entries are applied and kDataRecoveryFinish is published
+//
+// NOTE: no thread synchronization provisions are implemented in this class -
+// all calls must be done from the same thread (same assumptions as for
+// ChannelPfOnix)
+//
+class Mdp3Channel {
+public:
+    static const uint32_t MAX_DEPTH = 10;
+    static const size_t MAX_PENDING_ENTRIES = 10000;
+
+    typedef tw::price::QuoteStore::TQuote TQuote;
+
+    struct Stats {
+        Stats() {
+            clear();
+        }
+
+        void clear() {
+            _packets = 0;
+            _duplicatePackets = 0;
+            _gaps = 0;
+            _messages = 0;
+            _decodeErrors = 0;
+            _snapshotsApplied = 0;
+            _bookGaps = 0;
+            _quotesPublished = 0;
+        }
+
+        uint64_t _packets;
+        uint64_t _duplicatePackets;
+        uint64_t _gaps;
+        uint64_t _messages;
+        uint64_t _decodeErrors;
+        uint64_t _snapshotsApplied;
+        uint64_t _bookGaps;
+        uint64_t _quotesPublished;
+    };
+
+public:
+    Mdp3Channel();
+    ~Mdp3Channel();
+
+    void clear();
+
+public:
+    void setChannelId(const std::string& channelId) {
+        _channelId = channelId;
+    }
+
+    const std::string& getChannelId() const {
+        return _channelId;
+    }
+
+    void setVerbose(bool verbose) {
+        _verbose = verbose;
+    }
+
+    // Only subscribed instruments' books are built; instrument's keyNum1
+    // is CME's SecurityID
+    //
+    bool subscribe(tw::instr::InstrumentConstPtr instrument);
+    bool unsubscribe(tw::instr::InstrumentConstPtr instrument);
+
+public:
+    bool onIncrementalPacket(const char* data, size_t size);
+    bool onSnapshotPacket(const char* data, size_t size);
+
+public:
+    const Stats& getStats() const {
+        return _stats;
+    }
+
+    uint32_t getLastSeqNum() const {
+        return _lastSeqNum;
+    }
+
+    bool isStale(int32_t securityId) const;
+    uint32_t getRptSeq(int32_t securityId) const;
+
+private:
+    struct Level {
+        Level() {
+            clear();
+        }
+
+        void clear() {
+            _price = 0;
+            _qty = 0;
+            _numOrders = 0;
+        }
+
+        int64_t _price;
+        int32_t _qty;
+        int32_t _numOrders;
+    };
+
+    typedef std::deque<mdp3::Entry> TEntries;
+
+    struct Book {
+        Book() : _quote(NULL) {
+            clear();
+        }
+
+        void clear() {
+            _rptSeq = 0;
+            _lastSeenRptSeq = 0;
+            _stale = false;
+            _dirty = false;
+            _pending.clear();
+            clearLevels();
+        }
+
+        void clearLevels() {
+            for ( uint32_t i = 0; i < MAX_DEPTH; ++i ) {
+                _bids[i].clear();
+                _asks[i].clear();
+            }
+        }
+
+        TQuote* _quote;
+        uint32_t _rptSeq;
+        uint32_t _lastSeenRptSeq;
+        bool _stale;
+        bool _dirty;
+        Level _bids[MAX_DEPTH];
+        Level _asks[MAX_DEPTH];
+        TEntries _pending;
+    };
+
+    typedef std::tr1::unordered_map<int32_t, Book> TBooks;
+    typedef std::vector<Book*> TDirtyBooks;
+
+private:
+    bool processMessage(uint16_t templateId, uint16_t blockLength, const char* data, const char* end);
+
+    bool processIncremental(uint16_t templateId, uint16_t blockLength, const char* data, const char* end);
+    bool processSnapshot(uint16_t blockLength, const char* data, const char* end);
+    bool processChannelReset();
+    bool processSecurityStatus(uint16_t blockLength, const char* data, const char* end);
+
+    void onEntry(const mdp3::Entry& entry);
+    void applyEntry(Book& book, const mdp3::Entry& entry, bool publish);
+    void applyBookEntry(Book& book, const mdp3::Entry& entry);
+    void applyTradeEntry(Book& book, const mdp3::Entry& entry);
+
+    void setStale(Book& book);
+    void publishStatus(Book& book, tw::price::Quote::eStatus status);
+    void publishDirty();
+    void publish(Book& book);
+
+    Book* getBook(int32_t securityId) {
+        TBooks::iterator iter = _books.find(securityId);
+        if ( iter == _books.end() )
+            return NULL;
+
+        return &(iter->second);
+    }
+
+    void markDirty(Book& book) {
+        if ( !book._dirty ) {
+            book._dirty = true;
+            _dirtyBooks.push_back(&book);
+        }
+    }
+
+    static void updateLevels(Level* levels, uint8_t action, uint8_t level, const Level& value);
+
+private:
+    std::string _channelId;
+    bool _verbose;
+    uint32_t _lastSeqNum;
+    uint32_t _seqNum;
+    tw::common::THighResTime _packetTime;
+    TBooks _books;
+    TDirtyBooks _dirtyBooks;
+    Stats _stats;
+};
+
+} // namespace channel_pf_cme
+} // namespace tw
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <tw/common/defs.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+// CME MDP 3.0 (SBE encoded) wire format definitions - only templates needed
+// to build price level books and trades are decoded, everything else is
+// skipped using message's size
+//
+// NOTE: all integers on the wire are little-endian, same as host (x86)
+//
+// Packet layout:
+//
+//      uint32_t    MsgSeqNum
+//      uint64_t    SendingTime (nanoseconds since epoch)
+//      {
+//          uint16_t    MsgSize (including MsgSize itself)
+//          uint16_t    BlockLength  --|
+//          uint16_t    TemplateID     |-- SBE message header
+//          uint16_t    SchemaID       |
+//          uint16_t    Version      --|
+//          char[]      root block (BlockLength bytes), followed by repeating groups
+//      }*
+//
+namespace tw {
+namespace channel_pf_cme {
+namespace mdp3 {
+
+template <typename TValue>
+inline TValue get(const char* data) {
+    TValue value;
+    ::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+template <typename TValue>
+inline void put(char* data, TValue value) {
+    ::memcpy(data, &value, sizeof(value));
+}
+
+static const size_t PACKET_HEADER_SIZE = 12;
+static const size_t MESSAGE_SIZE_SIZE = 2;
+static const size_t MESSAGE_HEADER_SIZE = 8;
+static const size_t GROUP_SIZE_SIZE = 3;        // uint16_t blockLength, uint8_t numInGroup
+
+static const uint16_t SCHEMA_ID = 1;
+static const uint16_t SCHEMA_VERSION = 9;
+
+static const int32_t INT32_NULL = 2147483647;
+static const int64_t PRICE_NULL = 9223372036854775807LL;
+static const double PRICE_EXPONENT = 1e-9;
+
+static const uint8_t END_OF_EVENT = 0x80;       // MatchEventIndicator's bit
+
+enum eTemplateId {
+    kChannelReset = 4,
+    kSecurityStatus = 30,
+    kIncrementalRefreshVolume = 37,
+    kIncrementalRefreshBook = 46,
+    kIncrementalRefreshTradeSummary = 48,
+    kIncrementalRefreshDailyStatistics = 49,
+    kIncrementalRefreshLimitsBanding = 50,
+    kIncrementalRefreshSessionStatistics = 51,
+    kSnapshotFullRefresh = 52
+};
+
+enum eUpdateAction {
+    kNew = 0,
+    kChange = 1,
+    kDelete = 2,
+    kDeleteThru = 3,
+    kDeleteFrom = 4,
+    kOverlay = 5
+};
+
+enum eEntryType {
+    kBid = '0',
+    kOffer = '1',
+    kTrade = '2',
+    kBookReset = 'J'
+};
+
+enum eAggressorSide {
+    kAggressorNone = 0,
+    kAggressorBuy = 1,
+    kAggressorSell = 2
+};
+
+enum eSecurityTradingStatus {
+    kTradingHalt = 2,
+    kClose = 4,
+    kReadyToTrade = 17,
+    kNotAvailableForTrading = 18,
+    kPreOpen = 21,
+    kPostClose = 26
+};
+
+// Root blocks' and entries' layouts (offsets from the start of a block)
+//
+struct IncrementalRefreshLayout {       // 46 (book) and 48 (trade summary)
+    static const uint16_t ROOT_SIZE = 11;
+    static const size_t TRANSACT_TIME = 0;
+    static const size_t MATCH_EVENT_INDICATOR = 8;
+};
+
+struct BookEntryLayout {                // 46
+    static const uint16_t SIZE = 32;
+    static const size_t PRICE = 0;
+    static const size_t QTY = 8;
+    static const size_t SECURITY_ID = 12;
+    static const size_t RPT_SEQ = 16;
+    static const size_t NUM_ORDERS = 20;
+    static const size_t PRICE_LEVEL = 24;
+    static const size_t UPDATE_ACTION = 25;
+    static const size_t ENTRY_TYPE = 26;
+};
+
+struct TradeEntryLayout {               // 48
+    static const uint16_t SIZE = 32;
+    static const size_t PRICE = 0;
+    static const size_t QTY = 8;
+    static const size_t SECURITY_ID = 12;
+    static const size_t RPT_SEQ = 16;
+    static const size_t NUM_ORDERS = 20;
+    static const size_t AGGRESSOR_SIDE = 24;
+    static const size_t UPDATE_ACTION = 25;
+};
+
+struct SequenceEntryLayout {            // 37, 49, 50, 51 - only instrument's sequencing is used
+    uint16_t _templateId;
+    size_t _securityId;
+    size_t _rptSeq;
+};
+
+static const SequenceEntryLayout SEQUENCE_ENTRY_LAYOUTS[] = {
+    { kIncrementalRefreshVolume, 4, 8 },
+    { kIncrementalRefreshDailyStatistics, 12, 16 },
+    { kIncrementalRefreshLimitsBanding, 24, 28 },
+    { kIncrementalRefreshSessionStatistics, 8, 12 }
+};
+
+static const size_t SEQUENCE_ENTRY_LAYOUTS_SIZE = sizeof(SEQUENCE_ENTRY_LAYOUTS)/sizeof(SEQUENCE_ENTRY_LAYOUTS[0]);
+
+struct SnapshotLayout {                 // 52
+    static const uint16_t ROOT_SIZE = 59;
+    static const size_t LAST_MSG_SEQ_NUM_PROCESSED = 0;
+    static const size_t TOT_NUM_REPORTS = 4;
+    static const size_t SECURITY_ID = 8;
+    static const size_t RPT_SEQ = 12;
+    static const size_t TRANSACT_TIME = 16;
+};
+
+struct SnapshotEntryLayout {            // 52
+    static const uint16_t SIZE = 22;
+    static const size_t PRICE = 0;
+    static const size_t QTY = 8;
+    static const size_t NUM_ORDERS = 12;
+    static const size_t PRICE_LEVEL = 16;
+    static const size_t ENTRY_TYPE = 21;
+};
+
+struct ChannelResetLayout {             // 4
+    static const uint16_t ROOT_SIZE = 9;
+    static const size_t TRANSACT_TIME = 0;
+    static const size_t MATCH_EVENT_INDICATOR = 8;
+    static const uint16_t ENTRY_SIZE = 2;
+};
+
+struct SecurityStatusLayout {           // 30
+    static const uint16_t ROOT_SIZE = 30;
+    static const size_t TRANSACT_TIME = 0;
+    static const size_t SECURITY_ID = 20;
+    static const size_t MATCH_EVENT_INDICATOR = 26;
+    static const size_t SECURITY_TRADING_STATUS = 27;
+};
+
+// Decoded incremental entry - book, trade or sequence only (statistics)
+//
+struct Entry {
+    enum eKind {
+        kKindBook = 1,
+        kKindTrade = 2,
+        kKindSequence = 3
+    };
+
+    Entry() {
+        clear();
+    }
+
+    void clear() {
+        _kind = kKindSequence;
+        _price = 0;
+        _qty = 0;
+        _securityId = 0;
+        _rptSeq = 0;
+        _numOrders = 0;
+        _level = 0;
+        _action = 0;
+        _type = 0;
+        _aggressorSide = 0;
+    }
+
+    uint8_t _kind;
+    int64_t _price;
+    int32_t _qty;
+    int32_t _securityId;
+    uint32_t _rptSeq;
+    int32_t _numOrders;
+    uint8_t _level;
+    uint8_t _action;
+    char _type;
+    uint8_t _aggressorSide;
+};
+
+} // namespace mdp3
+} // namespace channel_pf_cme
+} // namespace tw
@@ -0,0 +1,97 @@
+#include <tw/channel_pf_cme/mdp3_replay.h>
+#include <tw/log/defs.h>
+
+namespace tw {
+namespace channel_pf_cme {
+
+Mdp3Replay::Mdp3Replay() {
+    clear();
+}
+
+void Mdp3Replay::clear() {
+    _feeds.clear();
+    _stats.clear();
+}
+
+bool Mdp3Replay::addFeed(const std::string& ip, uint16_t port, eFeedType type, Mdp3Channel* channel) {
+    if ( !channel ) {
+        LOGGER_ERRO << "channel is NULL for: " << ip << ":" << port << "\n";
+        return false;
+    }
+
+    Feed feed;
+    feed._ip = 0;
+    if ( !ip.empty() ) {
+        feed._ip = tw::common_comm::PcapReader::parseIp(ip);
+        if ( 0 == feed._ip ) {
+            LOGGER_ERRO << "Invalid ip: " << ip << "\n";
+            return false;
+        }
+    }
+
+    feed._port = port;
+    feed._type = type;
+    feed._channel = channel;
+    _feeds.push_back(feed);
+
+    return true;
+}
+
+bool Mdp3Replay::onPacket(const tw::common_comm::PcapPacket& packet) {
+    TFeeds::const_iterator iter = _feeds.begin();
+    TFeeds::const_iterator end = _feeds.end();
+    for ( ; iter != end; ++iter ) {
+        if ( iter->_port != packet._dstPort || (0 != iter->_ip && iter->_ip != packet._dstIp) )
+            continue;
+
+        ++_stats._packets;
+
+        bool status = (kIncremental == iter->_type) ? iter->_channel->onIncrementalPacket(packet._data, packet._size) :
+                                                      iter->_channel->onSnapshotPacket(packet._data, packet._size);
+        if ( !status )
+            ++_stats._failedPackets;
+
+        return status;
+    }
+
+    ++_stats._unmatchedPackets;
+    return false;
+}
+
+bool Mdp3Replay::replay(const std::string& fileName, uint64_t maxPackets) {
+    bool status = true;
+    try {
+        tw::common_comm::PcapReader reader;
+        if ( !reader.open(fileName) )
+            return false;
+
+        tw::common_comm::PcapPacket packet;
+        while ( reader.next(packet) ) {
+            onPacket(packet);
+            if ( 0 != maxPackets && _stats._packets >= maxPackets )
+                break;
+        }
+
+        if ( reader.isError() ) {
+            LOGGER_ERRO << "Failed to read: " << fileName << "\n";
+            status = false;
+        }
+
+        LOGGER_INFO << "Replayed: " << fileName
+                    << " :: records=" << reader.getRecordsCount()
+                    << ", packets=" << _stats._packets
+                    << ", unmatched=" << _stats._unmatchedPackets
+                    << ", failed=" << _stats._failedPackets << "\n";
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        status = false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        status = false;
+    }
+
+    return status;
+}
+
+} // namespace channel_pf_cme
+} // namespace tw
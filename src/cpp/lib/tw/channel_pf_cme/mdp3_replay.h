@@ -0,0 +1,76 @@
+#pragma once
+
+#include <tw/common/defs.h>
+#include <tw/common_comm/pcap.h>
+#include <tw/channel_pf_cme/mdp3_channel.h>
+
+#include <vector>
+
+namespace tw {
+namespace channel_pf_cme {
+
+// Drives Mdp3Channel(s) from pcap captures of CME multicast feeds - each
+// feed (incremental A/B, snapshot) is matched by UDP destination ip/port
+//
+class Mdp3Replay {
+public:
+    enum eFeedType {
+        kIncremental = 1,
+        kSnapshot = 2
+    };
+
+    struct Stats {
+        Stats() {
+            clear();
+        }
+
+        void clear() {
+            _packets = 0;
+            _unmatchedPackets = 0;
+            _failedPackets = 0;
+        }
+
+        uint64_t _packets;
+        uint64_t _unmatchedPackets;
+        uint64_t _failedPackets;
+    };
+
+public:
+    Mdp3Replay();
+
+    void clear();
+
+public:
+    // 'ip' - multicast group (e.g. "224.0.31.1"), empty string matches any ip
+    //
+    bool addFeed(const std::string& ip, uint16_t port, eFeedType type, Mdp3Channel* channel);
+
+    // Replays up to 'maxPackets' (0 - all) matched packets
+    //
+    bool replay(const std::string& fileName, uint64_t maxPackets = 0);
+
+    // Dispatches a single packet to matching feed's channel
+    //
+    bool onPacket(const tw::common_comm::PcapPacket& packet);
+
+    const Stats& getStats() const {
+        return _stats;
+    }
+
+private:
+    struct Feed {
+        uint32_t _ip;
+        uint16_t _port;
+        eFeedType _type;
+        Mdp3Channel* _channel;
+    };
+
+    typedef std::vector<Feed> TFeeds;
+
+private:
+    TFeeds _feeds;
+    Stats _stats;
+};
+
+} // namespace channel_pf_cme
+} // namespace tw
@@ -33,6 +33,10 @@ bool ChannelPfHistorical::init(const tw::common::Settings& settings) {
     try {
         _settings = settings;                
         tw::price::QuoteStore::instance().setQuoteNotificationStatsInterval(10000);
+        
+        if ( !tw::common_comm::TcpIpReactor::instance().init(_settings) )
+            return false;
+        
         return true;
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
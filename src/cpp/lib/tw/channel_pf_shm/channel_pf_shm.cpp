@@ -0,0 +1,165 @@
+#include <tw/channel_pf_shm/channel_pf_shm.h>
+#include <tw/log/defs.h>
+#include <tw/price/quote_store.h>
+#include <tw/common_strat/consumer_proxy.h>
+#include <tw/common_thread/utils.h>
+#include <tw/common/thread_placement.h>
+
+#include <boost/bind.hpp>
+
+namespace tw {
+namespace channel_pf_shm {
+
+// Sleep between polls of empty ring for threads, which aren't configured
+// to busy poll (see 'threads.busy_poll'), and of ring, which isn't attached
+// yet (publisher isn't up or is recreating it)
+//
+static const uint32_t IDLE_SLEEP_USECS = 50;
+
+ChannelPfShm::ChannelPfShm() : _settings(),
+                               _done(false) {
+}
+
+ChannelPfShm::~ChannelPfShm() {
+    stop();
+}
+
+// tw::channel_pf::IChannelImpl interface
+//
+bool ChannelPfShm::init(const tw::common::Settings& settings) {
+    try {
+        _settings = settings;
+        tw::price::QuoteStore::instance().setQuoteNotificationStatsInterval(10000);
+        
+        if ( _settings._channel_pf_shm_name.empty() ) {
+            LOGGER_ERRO << "channel_pf_shm.name isn't specified" << "\n";
+            return false;
+        }
+        
+        // Publisher might not be up yet - ring keeps trying to attach in read()
+        //
+        if ( !_ring.attach(_settings._channel_pf_shm_name) )
+            LOGGER_WARN << "Can't attach to quotes ring (yet): " << _settings._channel_pf_shm_name << "\n";
+        
+        return true;
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+    
+    return false;
+}
+
+bool ChannelPfShm::start() {
+    try {
+        LOGGER_INFO_EMPHASIS << "Starting channel price feed shm: " << _settings._channel_pf_shm_name << " ..." << "\n";
+        
+        _done = false;
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kFeedHandler, boost::bind(&ChannelPfShm::ThreadMain, this));
+        
+        LOGGER_INFO_EMPHASIS << "Started channel price feed shm" << "\n";
+        return true;
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+
+    stop();
+    return false;
+}
+
+void ChannelPfShm::stop() {    
+    try {
+        LOGGER_INFO_EMPHASIS << "Stopping channel price feed shm..." << "\n";
+        
+        _done = true;
+        if ( _thread != NULL ) {
+            _thread->join();
+            _thread = tw::common_thread::ThreadPtr();
+        }
+        
+        if ( _ring.isOpen() )
+            LOGGER_INFO << "Quotes lost due to overruns: " << _ring.overruns() << "\n";
+        
+        _ring.close();
+        
+        LOGGER_INFO_EMPHASIS << "Stopped channel price feed shm" << "\n";
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+// All quotes are in the ring - subscriptions are checked per quote in QuoteStore
+//
+bool ChannelPfShm::subscribe(tw::instr::InstrumentConstPtr instrument) {
+    LOGGER_INFO << "Request to subscribe to: " << instrument->_displayName << "\n";
+    return true;
+}
+
+bool ChannelPfShm::unsubscribe(tw::instr::InstrumentConstPtr instrument) {    
+    return true;
+}
+
+void ChannelPfShm::ThreadMain() {
+    LOGGER_INFO << "Started" << "\n";
+    
+    QuoteShm record;
+    uint64_t overruns = 0;
+    bool busyPoll = tw::common_thread::currentThreadBusyPoll();
+    
+    while ( !_done ) {
+        switch ( _ring.read(record) ) {
+            case TQuoteShmRing::kSuccess:
+                process(record);
+                break;
+            case TQuoteShmRing::kOverrun:
+                LOGGER_WARN << "Reader was overrun by publisher, quotes lost: " << (_ring.overruns()-overruns) << "\n";
+                overruns = _ring.overruns();
+                break;
+            default:
+                if ( busyPoll && _ring.isOpen() )
+                    tw::common_thread::cpuRelax();
+                else
+                    tw::common_thread::sleepUSecs(IDLE_SLEEP_USECS);
+                break;
+        }
+    }
+    
+    LOGGER_INFO << "Finished" << "\n";
+}
+
+void ChannelPfShm::process(const QuoteShm& record) {
+    try {
+        tw::common::THighResTime now = tw::common::THighResTime::now();
+        tw::price::QuoteStore::TQuote& quote = tw::price::QuoteStore::instance().getQuoteByKeyId(record._quoteWire._instrumentId);
+        if ( !quote.isValid() || !quote.isSubscribed() )
+            return;
+        
+        quote.clearRuntime();
+        
+        static_cast<tw::price::QuoteWire&>(quote) = record._quoteWire;
+        
+        if ( quote.isChanged() ) {
+            quote._exTimestamp = record._timestamp;
+            quote._timestamp1 = now;
+            quote._timestamp2.setToNow();
+            tw::common_strat::ConsumerProxy::instance().onQuote(quote);
+            
+            if ( _settings._common_comm_verbose ) {
+                LOGGER_INFO << "BOOKS: __________________________" << "\n";
+                LOGGER_INFO << "TO: \n" << quote.toString() << "\n";
+            }
+        }
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+    
+} // channel_pf_shm
+} // tw
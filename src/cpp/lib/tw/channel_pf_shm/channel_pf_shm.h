@@ -0,0 +1,63 @@
+#pragma once
+
+#include <tw/common/high_res_time.h>
+#include <tw/common/settings.h>
+#include <tw/common_thread/thread.h>
+#include <tw/common_thread/shm_ring.h>
+#include <tw/channel_pf/ichannel_impl.h>
+#include <tw/price/quote.h>
+
+// Price feed channel, which reads quotes published by channel_pf_simple_publisher
+// into shared memory ring (see tw/common_thread/shm_ring.h) - publisher writes
+// each quote once regardless of number of strategy processes reading it and
+// readers don't make any syscalls while there are quotes to read
+//
+// NOTE: no thread synchornization provisions are implemented in this class
+// (same assumptions as in ChannelPfHistorical apply):
+//      1. ALL calls to subscribe()/unsubscribe() methods are done AFTER init() 
+//      but BEFORE start() or AFTER stop()
+//      2. All tw::price::TQuotes objects are created BEFORE init() call and destroyed
+//      AFTER stop() call 
+//
+
+namespace tw {
+namespace channel_pf_shm {
+
+// Record in shared memory ring - publisher's timestamp and quote's wire part
+//
+struct QuoteShm {
+    tw::common::THighResTime _timestamp;
+    tw::price::QuoteWire _quoteWire;
+};
+
+typedef tw::common_thread::ShmRing<QuoteShm> TQuoteShmRing;
+
+class ChannelPfShm : public tw::channel_pf::IChannelImpl {
+public:
+    ChannelPfShm();
+    virtual ~ChannelPfShm();
+
+public:
+    // tw::channel_pf::IChannelImpl interface
+    //
+    virtual bool init(const tw::common::Settings& settings);
+    virtual bool start();    
+    virtual void stop();
+    
+    virtual bool subscribe(tw::instr::InstrumentConstPtr instrument);
+    virtual bool unsubscribe(tw::instr::InstrumentConstPtr instrument);
+    
+private:
+    void ThreadMain();
+    void process(const QuoteShm& record);
+    
+private:
+    tw::common::Settings _settings;
+    TQuoteShmRing _ring;
+    
+    volatile bool _done;
+    tw::common_thread::ThreadPtr _thread;
+};
+	
+} // channel_pf_shm
+} // tw
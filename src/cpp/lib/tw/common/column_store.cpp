@@ -0,0 +1,1056 @@
+#include <tw/common/column_store.h>
+#include <tw/common/filesystem.h>
+#include <tw/log/defs.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/date_time/gregorian/gregorian.hpp>
+
+#include <algorithm>
+#include <map>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tw {
+namespace common {
+
+// Block format (all integers are little endian):
+//
+//  uint32 magic
+//  uint32 number of bytes of the rest of block
+//  uint8  version
+//  varint rows
+//  varint columns
+//  for each column:
+//      string name, uint8 type, uint8 encoding
+//      min, max (zigzag varints for ints, 8 bytes for doubles, strings)
+//      varint number of bytes of payload, payload
+//
+// Strings are varint length followed by bytes
+//
+static const uint32_t BLOCK_MAGIC = 0x53435754; // "TWCS"
+static const uint8_t BLOCK_VERSION = 1;
+static const uint32_t MAX_BLOCK_BYTES = 1024*1024*1024;
+
+enum eEncoding {
+    kConstant = 0,
+    kPlain = 1,
+    kDelta = 2,
+    kDictionary = 3
+};
+
+const int64_t StoreTime::kNullTime = std::numeric_limits<int64_t>::min();
+const int64_t StoreTime::kMicrosInDay = 86400LL*1000000LL;
+
+const char* ColumnStore::FILE_EXT = ".tcs";
+
+// StoreTime
+//
+static const boost::posix_time::ptime& unixEpoch() {
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return epoch;
+}
+
+int64_t StoreTime::toMicros(const THighResTime& value) {
+    if ( !value.isValid() )
+        return kNullTime;
+
+#if defined(TW_HIGH_RES_TIME_NATIVE)
+    int64_t nanos = value.nanos();
+    return (nanos >= 0) ? nanos/1000 : -((-nanos+999)/1000);
+#else
+    static const THighResTime epoch = THighResTime::parse("19700101-00:00:00.000000");
+    return value - epoch;
+#endif
+}
+
+THighResTime StoreTime::fromMicros(int64_t micros) {
+    if ( kNullTime == micros )
+        return THighResTime();
+
+#if defined(TW_HIGH_RES_TIME_NATIVE)
+    return THighResTime::fromNanos(micros*1000);
+#else
+    boost::posix_time::ptime t = unixEpoch() + boost::posix_time::microseconds(micros);
+    boost::posix_time::time_duration d = t.time_of_day();
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "-%02d:%02d:%02d.%06d",
+             static_cast<int>(d.hours()),
+             static_cast<int>(d.minutes()),
+             static_cast<int>(d.seconds()),
+             static_cast<int>(d.fractional_seconds()));
+
+    return THighResTime::parse(boost::gregorian::to_iso_string(t.date()) + buffer);
+#endif
+}
+
+int64_t StoreTime::fromSqlTime(const std::string& time) {
+    if ( 10 == time.length() )
+        return toMicros(THighResTime::parseSqlTime(time + " 00:00:00.000000"));
+
+    return toMicros(THighResTime::parseSqlTime(time));
+}
+
+std::string StoreTime::dayOf(int64_t micros) {
+    if ( kNullTime == micros )
+        return boost::gregorian::to_iso_string(boost::gregorian::day_clock::universal_day());
+
+    int64_t days = micros/kMicrosInDay;
+    if ( micros < 0 && (micros%kMicrosInDay) != 0 )
+        --days;
+
+    boost::gregorian::date d = unixEpoch().date() + boost::gregorian::date_duration(static_cast<long>(days));
+    return boost::gregorian::to_iso_string(d);
+}
+
+// Encoding helpers
+//
+namespace {
+
+class Output {
+public:
+    Output(std::vector<char>& buffer) : _buffer(buffer) {
+    }
+
+    void putU8(uint8_t v) {
+        _buffer.push_back(static_cast<char>(v));
+    }
+
+    void putU32(uint32_t v) {
+        for ( int i = 0; i < 4; ++i )
+            _buffer.push_back(static_cast<char>((v >> (8*i)) & 0xFF));
+    }
+
+    void setU32(size_t pos, uint32_t v) {
+        for ( int i = 0; i < 4; ++i )
+            _buffer[pos+i] = static_cast<char>((v >> (8*i)) & 0xFF);
+    }
+
+    void putVarint(uint64_t v) {
+        while ( v >= 0x80 ) {
+            _buffer.push_back(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        _buffer.push_back(static_cast<char>(v));
+    }
+
+    void putZigzag(int64_t v) {
+        putVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    void putDouble(double v) {
+        uint64_t bits = 0;
+        ::memcpy(&bits, &v, sizeof(bits));
+        for ( int i = 0; i < 8; ++i )
+            _buffer.push_back(static_cast<char>((bits >> (8*i)) & 0xFF));
+    }
+
+    void putString(const std::string& v) {
+        putVarint(v.size());
+        _buffer.insert(_buffer.end(), v.begin(), v.end());
+    }
+
+    void putBytes(const std::vector<char>& v) {
+        _buffer.insert(_buffer.end(), v.begin(), v.end());
+    }
+
+    size_t size() const {
+        return _buffer.size();
+    }
+
+private:
+    std::vector<char>& _buffer;
+};
+
+class Input {
+public:
+    Input(const char* begin, const char* end) : _p(begin),
+                                                _end(end),
+                                                _ok(true) {
+    }
+
+    bool ok() const {
+        return _ok;
+    }
+
+    const char* pos() const {
+        return _p;
+    }
+
+    bool skip(size_t bytes) {
+        if ( !check(bytes) )
+            return false;
+
+        _p += bytes;
+        return true;
+    }
+
+    uint8_t getU8() {
+        if ( !check(1) )
+            return 0;
+
+        return static_cast<uint8_t>(*_p++);
+    }
+
+    uint64_t getVarint() {
+        uint64_t v = 0;
+        for ( uint32_t shift = 0; shift < 64; shift += 7 ) {
+            if ( !check(1) )
+                return 0;
+
+            uint8_t b = static_cast<uint8_t>(*_p++);
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ( !(b & 0x80) )
+                return v;
+        }
+
+        _ok = false;
+        return 0;
+    }
+
+    int64_t getZigzag() {
+        uint64_t v = getVarint();
+        return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    double getDouble() {
+        if ( !check(8) )
+            return 0.0;
+
+        uint64_t bits = 0;
+        for ( int i = 0; i < 8; ++i )
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(_p[i])) << (8*i);
+
+        _p += 8;
+
+        double v = 0.0;
+        ::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    void getString(std::string& v) {
+        uint64_t size = getVarint();
+        if ( !check(size) ) {
+            v.clear();
+            return;
+        }
+
+        v.assign(_p, static_cast<size_t>(size));
+        _p += size;
+    }
+
+private:
+    bool check(uint64_t bytes) {
+        if ( !_ok || static_cast<uint64_t>(_end-_p) < bytes ) {
+            _ok = false;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    const char* _p;
+    const char* _end;
+    bool _ok;
+};
+
+static uint32_t readU32(const char* p) {
+    uint32_t v = 0;
+    for ( int i = 0; i < 4; ++i )
+        v |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8*i);
+
+    return v;
+}
+
+// Column's header as read from block - payload is decoded only if needed
+//
+struct ColumnHeader {
+    ColumnHeader() : _type(StoreColumn::kString),
+                     _encoding(kPlain),
+                     _minInt(0),
+                     _maxInt(0),
+                     _minDouble(0.0),
+                     _maxDouble(0.0),
+                     _payload(NULL),
+                     _payloadSize(0) {
+    }
+
+    std::string _name;
+    StoreColumn::eType _type;
+    eEncoding _encoding;
+
+    int64_t _minInt;
+    int64_t _maxInt;
+    double _minDouble;
+    double _maxDouble;
+    std::string _minString;
+    std::string _maxString;
+
+    const char* _payload;
+    size_t _payloadSize;
+};
+
+typedef std::vector<ColumnHeader> TColumnHeaders;
+
+static void encodeColumn(const StoreColumn& column, size_t first, size_t last, const std::vector<size_t>& rows, Output& out) {
+    size_t count = last-first;
+    std::vector<char> payload;
+    Output p(payload);
+
+    out.putString(column._name);
+    out.putU8(static_cast<uint8_t>(column._type));
+
+    switch ( column._type ) {
+        case StoreColumn::kInt64:
+        {
+            int64_t minValue = column._ints[rows[first]];
+            int64_t maxValue = minValue;
+            for ( size_t i = first; i < last; ++i ) {
+                int64_t v = column._ints[rows[i]];
+                if ( v < minValue )
+                    minValue = v;
+                if ( v > maxValue )
+                    maxValue = v;
+            }
+
+            if ( minValue != maxValue ) {
+                uint64_t prev = 0;
+                for ( size_t i = first; i < last; ++i ) {
+                    uint64_t v = static_cast<uint64_t>(column._ints[rows[i]]);
+                    p.putZigzag(static_cast<int64_t>(v-prev));
+                    prev = v;
+                }
+            }
+
+            out.putU8((minValue == maxValue) ? kConstant : kDelta);
+            out.putZigzag(minValue);
+            out.putZigzag(maxValue);
+        }
+            break;
+        case StoreColumn::kDouble:
+        {
+            double minValue = column._doubles[rows[first]];
+            double maxValue = minValue;
+            bool constant = true;
+            for ( size_t i = first; i < last; ++i ) {
+                double v = column._doubles[rows[i]];
+                if ( v < minValue )
+                    minValue = v;
+                if ( v > maxValue )
+                    maxValue = v;
+                if ( ::memcmp(&v, &column._doubles[rows[first]], sizeof(v)) != 0 )
+                    constant = false;
+            }
+
+            if ( !constant ) {
+                for ( size_t i = first; i < last; ++i )
+                    p.putDouble(column._doubles[rows[i]]);
+            }
+
+            out.putU8(constant ? kConstant : kPlain);
+            out.putDouble(constant ? column._doubles[rows[first]] : minValue);
+            out.putDouble(constant ? column._doubles[rows[first]] : maxValue);
+        }
+            break;
+        case StoreColumn::kString:
+        {
+            typedef std::map<std::string, uint32_t> TDictionary;
+
+            const std::string* minValue = &column._strings[rows[first]];
+            const std::string* maxValue = minValue;
+            TDictionary dictionary;
+            std::vector<const std::string*> values;
+            std::vector<uint32_t> ids;
+            bool useDictionary = true;
+            for ( size_t i = first; i < last; ++i ) {
+                const std::string& v = column._strings[rows[i]];
+                if ( v < *minValue )
+                    minValue = &v;
+                if ( *maxValue < v )
+                    maxValue = &v;
+
+                if ( useDictionary ) {
+                    std::pair<TDictionary::iterator, bool> r = dictionary.insert(TDictionary::value_type(v, static_cast<uint32_t>(values.size())));
+                    if ( r.second )
+                        values.push_back(&r.first->first);
+
+                    ids.push_back(r.first->second);
+                    if ( values.size() > 1 && values.size() > count/2 )
+                        useDictionary = false;
+                }
+            }
+
+            eEncoding encoding = kPlain;
+            if ( useDictionary && values.size() == 1 ) {
+                encoding = kConstant;
+            } else if ( useDictionary ) {
+                encoding = kDictionary;
+                p.putVarint(values.size());
+                for ( size_t i = 0; i < values.size(); ++i )
+                    p.putString(*values[i]);
+
+                for ( size_t i = 0; i < ids.size(); ++i )
+                    p.putVarint(ids[i]);
+            } else {
+                for ( size_t i = first; i < last; ++i )
+                    p.putString(column._strings[rows[i]]);
+            }
+
+            out.putU8(encoding);
+            out.putString(*minValue);
+            out.putString(*maxValue);
+        }
+            break;
+    }
+
+    out.putVarint(payload.size());
+    out.putBytes(payload);
+}
+
+static bool readHeaders(const std::vector<char>& buffer, size_t& rows, TColumnHeaders& headers) {
+    Input in(&buffer[0], &buffer[0]+buffer.size());
+    if ( BLOCK_VERSION != in.getU8() )
+        return false;
+
+    rows = static_cast<size_t>(in.getVarint());
+    size_t columns = static_cast<size_t>(in.getVarint());
+    if ( !in.ok() || columns > buffer.size() )
+        return false;
+
+    headers.resize(columns);
+    for ( size_t i = 0; i < columns && in.ok(); ++i ) {
+        ColumnHeader& h = headers[i];
+        in.getString(h._name);
+        h._type = static_cast<StoreColumn::eType>(in.getU8());
+        h._encoding = static_cast<eEncoding>(in.getU8());
+
+        switch ( h._type ) {
+            case StoreColumn::kInt64:
+                h._minInt = in.getZigzag();
+                h._maxInt = in.getZigzag();
+                break;
+            case StoreColumn::kDouble:
+                h._minDouble = in.getDouble();
+                h._maxDouble = in.getDouble();
+                break;
+            case StoreColumn::kString:
+                in.getString(h._minString);
+                in.getString(h._maxString);
+                break;
+            default:
+                return false;
+        }
+
+        h._payloadSize = static_cast<size_t>(in.getVarint());
+        h._payload = in.pos();
+        in.skip(h._payloadSize);
+    }
+
+    return in.ok();
+}
+
+static bool decodeColumn(const ColumnHeader& h, size_t rows, StoreColumn& column) {
+    column._name = h._name;
+    column._type = h._type;
+    column.clear();
+
+    Input in(h._payload, h._payload+h._payloadSize);
+    switch ( h._type ) {
+        case StoreColumn::kInt64:
+            if ( kConstant == h._encoding ) {
+                column._ints.assign(rows, h._minInt);
+            } else {
+                column._ints.resize(rows);
+                uint64_t prev = 0;
+                for ( size_t i = 0; i < rows; ++i ) {
+                    prev += static_cast<uint64_t>(in.getZigzag());
+                    column._ints[i] = static_cast<int64_t>(prev);
+                }
+            }
+            break;
+        case StoreColumn::kDouble:
+            if ( kConstant == h._encoding ) {
+                column._doubles.assign(rows, h._minDouble);
+            } else {
+                column._doubles.resize(rows);
+                for ( size_t i = 0; i < rows; ++i )
+                    column._doubles[i] = in.getDouble();
+            }
+            break;
+        case StoreColumn::kString:
+            if ( kConstant == h._encoding ) {
+                column._strings.assign(rows, h._minString);
+            } else if ( kDictionary == h._encoding ) {
+                std::vector<std::string> dictionary(static_cast<size_t>(in.getVarint()));
+                for ( size_t i = 0; i < dictionary.size() && in.ok(); ++i )
+                    in.getString(dictionary[i]);
+
+                column._strings.resize(rows);
+                for ( size_t i = 0; i < rows && in.ok(); ++i ) {
+                    uint64_t id = in.getVarint();
+                    if ( id >= dictionary.size() )
+                        return false;
+
+                    column._strings[i] = dictionary[id];
+                }
+            } else {
+                column._strings.resize(rows);
+                for ( size_t i = 0; i < rows && in.ok(); ++i )
+                    in.getString(column._strings[i]);
+            }
+            break;
+    }
+
+    return in.ok();
+}
+
+// Returns false if no value of column within header's min/max can be equal
+//
+static bool mayEqual(const ColumnHeader& h, const std::string& value) {
+    try {
+        switch ( h._type ) {
+            case StoreColumn::kInt64:
+            {
+                int64_t v = boost::lexical_cast<int64_t>(value);
+                return (h._minInt <= v && v <= h._maxInt);
+            }
+            case StoreColumn::kDouble:
+            {
+                double v = boost::lexical_cast<double>(value);
+                return (h._minDouble <= v && v <= h._maxDouble);
+            }
+            case StoreColumn::kString:
+                return (h._minString <= value && value <= h._maxString);
+        }
+    } catch(...) {
+    }
+
+    return false;
+}
+
+static void matchEqual(const StoreColumn& column, const std::string& value, std::vector<char>& mask) {
+    try {
+        switch ( column._type ) {
+            case StoreColumn::kInt64:
+            {
+                int64_t v = boost::lexical_cast<int64_t>(value);
+                for ( size_t i = 0; i < mask.size(); ++i )
+                    mask[i] = mask[i] && (column._ints[i] == v);
+            }
+                return;
+            case StoreColumn::kDouble:
+            {
+                double v = boost::lexical_cast<double>(value);
+                for ( size_t i = 0; i < mask.size(); ++i )
+                    mask[i] = mask[i] && (column._doubles[i] == v);
+            }
+                return;
+            case StoreColumn::kString:
+                for ( size_t i = 0; i < mask.size(); ++i )
+                    mask[i] = mask[i] && (column._strings[i] == value);
+                return;
+        }
+    } catch(...) {
+    }
+
+    std::fill(mask.begin(), mask.end(), 0);
+}
+
+static void compact(StoreColumn& column, const std::vector<char>& mask) {
+    size_t j = 0;
+    for ( size_t i = 0; i < mask.size(); ++i ) {
+        if ( !mask[i] )
+            continue;
+
+        if ( i != j ) {
+            switch ( column._type ) {
+                case StoreColumn::kInt64:
+                    column._ints[j] = column._ints[i];
+                    break;
+                case StoreColumn::kDouble:
+                    column._doubles[j] = column._doubles[i];
+                    break;
+                case StoreColumn::kString:
+                    column._strings[j].swap(column._strings[i]);
+                    break;
+            }
+        }
+        ++j;
+    }
+
+    column._ints.resize(StoreColumn::kInt64 == column._type ? j : 0);
+    column._doubles.resize(StoreColumn::kDouble == column._type ? j : 0);
+    column._strings.resize(StoreColumn::kString == column._type ? j : 0);
+}
+
+} // namespace
+
+// StoreRowReader
+//
+const StoreColumn* StoreRowReader::column(const char* name, StoreColumn::eType type) {
+    if ( _index == _byPosition.size() ) {
+        const StoreColumn* c = NULL;
+        for ( size_t i = 0; i < _columns.size(); ++i ) {
+            if ( _columns[i]._name == name ) {
+                c = &_columns[i];
+                break;
+            }
+        }
+
+        _byPosition.push_back(c);
+    }
+
+    const StoreColumn* c = _byPosition[_index++];
+    if ( !c || c->_type != type || c->size() <= _row )
+        return NULL;
+
+    return c;
+}
+
+// StoreScanner
+//
+StoreScanner::StoreScanner(const ColumnStore& store, const std::string& table, const StoreFilter& filter, const TNames& names) : _store(store),
+                                                                                                                           _filter(filter),
+                                                                                                                           _names(names),
+                                                                                                                           _fileIndex(0),
+                                                                                                                           _file(NULL),
+                                                                                                                           _fileOffset(0),
+                                                                                                                           _fileLength(0),
+                                                                                                                           _failed(false),
+                                                                                                                           _blocksScanned(0),
+                                                                                                                           _blocksSkipped(0) {
+    std::string fromDay;
+    std::string toDay;
+    if ( !_filter.timeColumn().empty() ) {
+        if ( _filter.from() != std::numeric_limits<int64_t>::min() && _filter.from() != StoreTime::kNullTime )
+            fromDay = StoreTime::dayOf(_filter.from());
+
+        if ( _filter.to() != std::numeric_limits<int64_t>::max() )
+            toDay = StoreTime::dayOf(_filter.to());
+    }
+
+    _files = store.getPartitions(table, fromDay, toDay);
+}
+
+StoreScanner::~StoreScanner() {
+    if ( _file )
+        ::fclose(_file);
+}
+
+bool StoreScanner::openNextFile() {
+    if ( _file ) {
+        ::fclose(_file);
+        _file = NULL;
+    }
+
+    while ( _fileIndex < _files.size() ) {
+        const std::string& fileName = _files[_fileIndex++];
+        _fileOffset = 0;
+        _fileLength = _store.getCommittedLength(fileName);
+        _file = ::fopen(fileName.c_str(), "rb");
+        if ( _file )
+            return true;
+
+        LOGGER_ERRO << "Failed to open: " << fileName << "\n";
+        _failed = true;
+    }
+
+    return false;
+}
+
+bool StoreScanner::readBlock(std::vector<char>& buffer) {
+    if ( _fileOffset >= _fileLength )
+        return false;
+
+    // Incomplete block at the end of file is being appended by other
+    // process (or was left by interrupted append) - it's the last one
+    //
+    char header[8];
+    if ( _fileOffset+sizeof(header) > _fileLength || sizeof(header) != ::fread(header, 1, sizeof(header), _file) ) {
+        LOGGER_WARN << "Incomplete block header at the end of: " << _files[_fileIndex-1] << "\n";
+        return false;
+    }
+
+    uint32_t size = readU32(header+4);
+    if ( BLOCK_MAGIC != readU32(header) || size > MAX_BLOCK_BYTES ) {
+        LOGGER_ERRO << "Corrupted block in: " << _files[_fileIndex-1] << "\n";
+        _failed = true;
+        return false;
+    }
+
+    if ( _fileOffset+sizeof(header)+size > _fileLength ) {
+        LOGGER_WARN << "Incomplete block at the end of: " << _files[_fileIndex-1] << "\n";
+        return false;
+    }
+
+    buffer.resize(size);
+    if ( size > 0 && size != ::fread(&buffer[0], 1, size, _file) ) {
+        LOGGER_ERRO << "Failed to read block in: " << _files[_fileIndex-1] << "\n";
+        _failed = true;
+        return false;
+    }
+
+    _fileOffset += sizeof(header)+size;
+    return true;
+}
+
+bool StoreScanner::processBlock(const std::vector<char>& buffer, TStoreColumns& columns) {
+    size_t rows = 0;
+    TColumnHeaders headers;
+    if ( buffer.empty() || !readHeaders(buffer, rows, headers) ) {
+        LOGGER_ERRO << "Corrupted block in: " << _files[_fileIndex-1] << "\n";
+        _failed = true;
+        return false;
+    }
+
+    // Zone maps
+    //
+    const ColumnHeader* timeHeader = NULL;
+    std::vector<const ColumnHeader*> equalsHeaders(_filter.equals().size(), static_cast<const ColumnHeader*>(NULL));
+    for ( size_t i = 0; i < headers.size(); ++i ) {
+        if ( !_filter.timeColumn().empty() && headers[i]._name == _filter.timeColumn() )
+            timeHeader = &headers[i];
+
+        for ( size_t j = 0; j < equalsHeaders.size(); ++j ) {
+            if ( headers[i]._name == _filter.equals()[j]._column )
+                equalsHeaders[j] = &headers[i];
+        }
+    }
+
+    if ( !_filter.timeColumn().empty() ) {
+        if ( !timeHeader || StoreColumn::kInt64 != timeHeader->_type )
+            return false;
+
+        if ( timeHeader->_maxInt < _filter.from() || timeHeader->_minInt > _filter.to() )
+            return false;
+    }
+
+    for ( size_t j = 0; j < equalsHeaders.size(); ++j ) {
+        if ( !equalsHeaders[j] || !mayEqual(*equalsHeaders[j], _filter.equals()[j]._value) )
+            return false;
+    }
+
+    // Rows' mask from filter's columns
+    //
+    std::vector<char> mask(rows, 1);
+    StoreColumn column;
+    if ( timeHeader ) {
+        if ( !decodeColumn(*timeHeader, rows, column) ) {
+            _failed = true;
+            return false;
+        }
+
+        for ( size_t i = 0; i < rows; ++i )
+            mask[i] = (_filter.from() <= column._ints[i] && column._ints[i] <= _filter.to());
+    }
+
+    for ( size_t j = 0; j < equalsHeaders.size(); ++j ) {
+        if ( !decodeColumn(*equalsHeaders[j], rows, column) ) {
+            _failed = true;
+            return false;
+        }
+
+        matchEqual(column, _filter.equals()[j]._value, mask);
+    }
+
+    if ( std::find(mask.begin(), mask.end(), 1) == mask.end() )
+        return false;
+
+    // Requested columns
+    //
+    columns.clear();
+    for ( size_t i = 0; i < headers.size(); ++i ) {
+        if ( !_names.empty() && std::find(_names.begin(), _names.end(), headers[i]._name) == _names.end() )
+            continue;
+
+        columns.push_back(StoreColumn());
+        if ( !decodeColumn(headers[i], rows, columns.back()) ) {
+            _failed = true;
+            return false;
+        }
+
+        compact(columns.back(), mask);
+    }
+
+    return true;
+}
+
+bool StoreScanner::next(TStoreColumns& columns) {
+    columns.clear();
+    while ( !_failed ) {
+        if ( !_file && !openNextFile() )
+            return false;
+
+        if ( !readBlock(_buffer) ) {
+            if ( _failed )
+                return false;
+
+            if ( !openNextFile() )
+                return false;
+
+            continue;
+        }
+
+        ++_blocksScanned;
+        if ( processBlock(_buffer, columns) )
+            return true;
+
+        ++_blocksSkipped;
+    }
+
+    return false;
+}
+
+// ColumnStore
+//
+ColumnStore::ColumnStore() {
+}
+
+bool ColumnStore::open(const std::string& dir) {
+    if ( dir.empty() || !Filesystem::create_dir(dir) ) {
+        LOGGER_ERRO << "Failed to open column store dir: " << dir << "\n";
+        return false;
+    }
+
+    _dir = dir;
+    return true;
+}
+
+std::vector<std::string> ColumnStore::getPartitions(const std::string& table, const std::string& fromDay, const std::string& toDay) const {
+    std::vector<std::string> partitions;
+    if ( !isOpen() )
+        return partitions;
+
+    const std::string ext(FILE_EXT);
+    Filesystem::TFilesList files = Filesystem::getDirFiles(_dir + "/" + table);
+    for ( size_t i = 0; i < files.size(); ++i ) {
+        std::string name = Filesystem::TPath(files[i]).filename().string();
+        if ( name.size() <= ext.size() || name.substr(name.size()-ext.size()) != ext )
+            continue;
+
+        std::string day = name.substr(0, name.size()-ext.size());
+        if ( !fromDay.empty() && day < fromDay )
+            continue;
+
+        if ( !toDay.empty() && day > toDay )
+            continue;
+
+        partitions.push_back(files[i]);
+    }
+
+    std::sort(partitions.begin(), partitions.end());
+    return partitions;
+}
+
+bool ColumnStore::appendColumns(const std::string& table, const std::string& timeColumn, const TStoreColumns& columns) {
+    if ( !isOpen() ) {
+        LOGGER_ERRO << "Column store is not open" << "\n";
+        return false;
+    }
+
+    if ( columns.empty() || 0 == columns[0].size() )
+        return true;
+
+    size_t rows = columns[0].size();
+    const StoreColumn* time = NULL;
+    for ( size_t i = 0; i < columns.size(); ++i ) {
+        if ( columns[i].size() != rows ) {
+            LOGGER_ERRO << "Inconsistent number of rows in column: " << table << "." << columns[i]._name << "\n";
+            return false;
+        }
+
+        if ( columns[i]._name == timeColumn && StoreColumn::kInt64 == columns[i]._type )
+            time = &columns[i];
+    }
+
+    if ( !time ) {
+        LOGGER_ERRO << "No time column: " << table << "." << timeColumn << "\n";
+        return false;
+    }
+
+    // Rows of each day (in original order) go to day's partition, rows
+    // with null time go to today's partition
+    //
+    typedef std::map<int64_t, std::vector<size_t> > TDays;
+    TDays days;
+    for ( size_t i = 0; i < rows; ++i ) {
+        int64_t micros = time->_ints[i];
+        int64_t day = StoreTime::kNullTime;
+        if ( StoreTime::kNullTime != micros ) {
+            day = micros/StoreTime::kMicrosInDay;
+            if ( micros < 0 && (micros%StoreTime::kMicrosInDay) != 0 )
+                --day;
+        }
+
+        days[day].push_back(i);
+    }
+
+    std::vector<char> buffer;
+    for ( TDays::const_iterator iter = days.begin(); iter != days.end(); ++iter ) {
+        const std::vector<size_t>& dayRows = iter->second;
+
+        buffer.clear();
+        Output out(buffer);
+        out.putU32(BLOCK_MAGIC);
+        out.putU32(0);
+        out.putU8(BLOCK_VERSION);
+        out.putVarint(dayRows.size());
+        out.putVarint(columns.size());
+        for ( size_t i = 0; i < columns.size(); ++i )
+            encodeColumn(columns[i], 0, dayRows.size(), dayRows, out);
+
+        out.setU32(4, static_cast<uint32_t>(buffer.size()-8));
+
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        std::string tableDir = _dir + "/" + table;
+        if ( !Filesystem::create_dir(tableDir) )
+            return false;
+
+        std::string day = StoreTime::dayOf((StoreTime::kNullTime == iter->first) ? StoreTime::kNullTime : iter->first*StoreTime::kMicrosInDay);
+        std::string fileName = tableDir + "/" + day + FILE_EXT;
+        if ( _recoveredFiles.find(fileName) == _recoveredFiles.end() ) {
+            if ( !recoverTail(fileName) )
+                return false;
+
+            _recoveredFiles.insert(fileName);
+        }
+
+        FILE* file = ::fopen(fileName.c_str(), "ab");
+        if ( !file ) {
+            LOGGER_ERRO << "Failed to open: " << fileName << "\n";
+            return false;
+        }
+
+        bool status = (buffer.size() == ::fwrite(&buffer[0], 1, buffer.size(), file));
+        status = (0 == ::fclose(file)) && status;
+        if ( !status ) {
+            LOGGER_ERRO << "Failed to write: " << fileName << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint64_t ColumnStore::getCommittedLength(const std::string& fileName) const {
+    tw::common_thread::LockGuard<TLock> lock(const_cast<ColumnStore*>(this)->_lock);
+
+    struct stat info;
+    if ( 0 != ::stat(fileName.c_str(), &info) )
+        return 0;
+
+    return static_cast<uint64_t>(info.st_size);
+}
+
+bool ColumnStore::recoverTail(const std::string& fileName) {
+    struct stat info;
+    if ( 0 != ::stat(fileName.c_str(), &info) )
+        return true;
+
+    FILE* file = ::fopen(fileName.c_str(), "rb");
+    if ( !file ) {
+        LOGGER_ERRO << "Failed to open: " << fileName << "\n";
+        return false;
+    }
+
+    // Only blocks' headers are read - walks from block to block until
+    // the end of file or the first incomplete/corrupted block
+    //
+    uint64_t length = static_cast<uint64_t>(info.st_size);
+    uint64_t offset = 0;
+    char header[8];
+    while ( offset+sizeof(header) <= length ) {
+        if ( 0 != ::fseeko(file, static_cast<off_t>(offset), SEEK_SET) || sizeof(header) != ::fread(header, 1, sizeof(header), file) )
+            break;
+
+        uint32_t size = readU32(header+4);
+        if ( BLOCK_MAGIC != readU32(header) || size > MAX_BLOCK_BYTES || offset+sizeof(header)+size > length )
+            break;
+
+        offset += sizeof(header)+size;
+    }
+
+    ::fclose(file);
+
+    if ( offset == length )
+        return true;
+
+    LOGGER_WARN << "Truncating incomplete or corrupted block at the end of: " << fileName << " from: " << length << " to: " << offset << " bytes" << "\n";
+    if ( 0 != ::truncate(fileName.c_str(), static_cast<off_t>(offset)) ) {
+        LOGGER_ERRO << "Failed to truncate: " << fileName << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool ColumnStore::readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, StoreColumn& values) const {
+    StoreScanner::TNames names(1, name);
+    StoreScanner scanner(*this, table, filter, names);
+    TStoreColumns columns;
+    while ( scanner.next(columns) ) {
+        if ( columns.empty() )
+            continue;
+
+        const StoreColumn& c = columns[0];
+        if ( values._name.empty() ) {
+            values._name = c._name;
+            values._type = c._type;
+        }
+
+        if ( c._type != values._type ) {
+            LOGGER_ERRO << "Inconsistent type of column: " << table << "." << name << "\n";
+            return false;
+        }
+
+        values._ints.insert(values._ints.end(), c._ints.begin(), c._ints.end());
+        values._doubles.insert(values._doubles.end(), c._doubles.begin(), c._doubles.end());
+        values._strings.insert(values._strings.end(), c._strings.begin(), c._strings.end());
+    }
+
+    return !scanner.failed();
+}
+
+bool ColumnStore::readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, std::vector<int64_t>& values) const {
+    StoreColumn c(name, StoreColumn::kInt64);
+    c._name.clear();
+    if ( !readColumn(table, filter, name, c) )
+        return false;
+
+    if ( !c._name.empty() && StoreColumn::kInt64 != c._type )
+        return false;
+
+    values.insert(values.end(), c._ints.begin(), c._ints.end());
+    return true;
+}
+
+bool ColumnStore::readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, std::vector<double>& values) const {
+    StoreColumn c(name, StoreColumn::kDouble);
+    c._name.clear();
+    if ( !readColumn(table, filter, name, c) )
+        return false;
+
+    if ( !c._name.empty() && StoreColumn::kDouble != c._type )
+        return false;
+
+    values.insert(values.end(), c._doubles.begin(), c._doubles.end());
+    return true;
+}
+
+bool ColumnStore::readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, std::vector<std::string>& values) const {
+    StoreColumn c(name, StoreColumn::kString);
+    c._name.clear();
+    if ( !readColumn(table, filter, name, c) )
+        return false;
+
+    if ( !c._name.empty() && StoreColumn::kString != c._type )
+        return false;
+
+    values.insert(values.end(), c._strings.begin(), c._strings.end());
+    return true;
+}
+
+} // namespace common
+} // namespace tw
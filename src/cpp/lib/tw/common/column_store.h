@@ -0,0 +1,491 @@
+#pragma once
+
+#include <tw/common/type_wrap.h>
+#include <tw/common/high_res_time.h>
+#include <tw/common_thread/locks.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace tw {
+namespace common {
+
+// Append-only columnar file store of history records (bars, fills, pnl
+// audit trail, etc.) for local access without db round trips
+//
+// Layout is <dir>/<table>/<YYYYMMDD>.tcs - one file per table and day of
+// records' time column. Every append adds a block of rows to the end of
+// the day's file. Each column of a block is encoded on its own (delta
+// varints for integers/timestamps, dictionary or plain for strings,
+// constant for single valued columns) and keeps its min/max (zone map),
+// so that scans skip blocks which can't match without decoding them
+//
+// Append of a block isn't atomic - a crash can leave incomplete block at
+// the end of a file. Before the first append to a file, writer truncates
+// it back to its last complete block, so that no block is ever appended
+// behind a torn one. Scanners read each file only up to its length at the
+// time they open it, which is a block boundary for appends of the same
+// store (appends and the length snapshot are done under the store's lock),
+// and stop at an incomplete block at the end (append of other process)
+//
+// Records are mapped to columns through generated visitFields(visitor)
+// of serializable structs: integers, bools, Ticks/Size and timestamps
+// (micros since epoch) are int64 columns, floats/doubles are double
+// columns and everything else is stored as its string form
+//
+struct StoreColumn {
+    enum eType {
+        kInt64 = 1,
+        kDouble = 2,
+        kString = 3
+    };
+
+    StoreColumn() : _type(kString) {
+    }
+
+    StoreColumn(const std::string& name, eType type) : _name(name),
+                                                      _type(type) {
+    }
+
+    size_t size() const {
+        switch ( _type ) {
+            case kInt64:
+                return _ints.size();
+            case kDouble:
+                return _doubles.size();
+            case kString:
+                return _strings.size();
+        }
+
+        return 0;
+    }
+
+    void clear() {
+        _ints.clear();
+        _doubles.clear();
+        _strings.clear();
+    }
+
+    std::string _name;
+    eType _type;
+
+    std::vector<int64_t> _ints;
+    std::vector<double> _doubles;
+    std::vector<std::string> _strings;
+};
+
+typedef std::vector<StoreColumn> TStoreColumns;
+
+// Timestamps are stored as micros since epoch, invalid ones as kNullTime
+//
+struct StoreTime {
+    static const int64_t kNullTime;
+    static const int64_t kMicrosInDay;
+
+    static int64_t toMicros(const THighResTime& value);
+    static THighResTime fromMicros(int64_t micros);
+
+    // "YYYY-MM-DD[ HH:MM:SS[.ffffff]]" (date only is its midnight)
+    //
+    static int64_t fromSqlTime(const std::string& time);
+
+    // "YYYYMMDD" of micros (today's date for kNullTime)
+    //
+    static std::string dayOf(int64_t micros);
+};
+
+// Rows matching time range (inclusive) of time column and all of
+// equality conditions. Values of conditions are compared in column's
+// type
+//
+class StoreFilter {
+public:
+    struct TEquals {
+        std::string _column;
+        std::string _value;
+    };
+
+    typedef std::vector<TEquals> TEqualsList;
+
+public:
+    StoreFilter() : _from(std::numeric_limits<int64_t>::min()),
+                    _to(std::numeric_limits<int64_t>::max()) {
+    }
+
+    StoreFilter& setTimeRange(const std::string& column, int64_t from, int64_t to) {
+        _timeColumn = column;
+        _from = from;
+        _to = to;
+        return *this;
+    }
+
+    StoreFilter& setTimeRange(const std::string& column, const THighResTime& from, const THighResTime& to) {
+        return setTimeRange(column, StoreTime::toMicros(from), StoreTime::toMicros(to));
+    }
+
+    template <typename TValue>
+    StoreFilter& addEquals(const std::string& column, const TValue& value) {
+        TEquals e;
+        e._column = column;
+        e._value = boost::lexical_cast<std::string>(value);
+        _equals.push_back(e);
+        return *this;
+    }
+
+    const std::string& timeColumn() const {
+        return _timeColumn;
+    }
+
+    int64_t from() const {
+        return _from;
+    }
+
+    int64_t to() const {
+        return _to;
+    }
+
+    const TEqualsList& equals() const {
+        return _equals;
+    }
+
+private:
+    std::string _timeColumn;
+    int64_t _from;
+    int64_t _to;
+    TEqualsList _equals;
+};
+
+// Appends fields of one record as next row of columns
+//
+class StoreRowWriter {
+public:
+    StoreRowWriter(TStoreColumns& columns) : _columns(columns),
+                                             _index(0) {
+    }
+
+    void reset() {
+        _index = 0;
+    }
+
+    void operator()(const char* name, const bool& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(value ? 1 : 0);
+    }
+
+    void operator()(const char* name, const int16_t& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(value);
+    }
+
+    void operator()(const char* name, const uint16_t& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(value);
+    }
+
+    void operator()(const char* name, const int32_t& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(value);
+    }
+
+    void operator()(const char* name, const uint32_t& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(value);
+    }
+
+    void operator()(const char* name, const int64_t& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(value);
+    }
+
+    void operator()(const char* name, const uint64_t& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(static_cast<int64_t>(value));
+    }
+
+    void operator()(const char* name, const float& value) {
+        column(name, StoreColumn::kDouble)._doubles.push_back(value);
+    }
+
+    void operator()(const char* name, const double& value) {
+        column(name, StoreColumn::kDouble)._doubles.push_back(value);
+    }
+
+    void operator()(const char* name, const std::string& value) {
+        column(name, StoreColumn::kString)._strings.push_back(value);
+    }
+
+    void operator()(const char* name, const THighResTime& value) {
+        column(name, StoreColumn::kInt64)._ints.push_back(StoreTime::toMicros(value));
+    }
+
+    template <typename TType, bool TTypeDefault>
+    void operator()(const char* name, const TypeWrap<TType, TTypeDefault>& value) {
+        const TType v = value.get();
+        (*this)(name, v);
+    }
+
+    template <typename TValue>
+    void operator()(const char* name, const TValue& value) {
+        column(name, StoreColumn::kString)._strings.push_back(boost::lexical_cast<std::string>(value));
+    }
+
+private:
+    // Records of a table have the same fields in the same order
+    //
+    StoreColumn& column(const char* name, StoreColumn::eType type) {
+        if ( _index == _columns.size() )
+            _columns.push_back(StoreColumn(name, type));
+
+        return _columns[_index++];
+    }
+
+private:
+    TStoreColumns& _columns;
+    size_t _index;
+};
+
+// Reads fields of a record from a row of columns - fields without
+// column (or with column of other type) are left untouched
+//
+class StoreRowReader {
+public:
+    StoreRowReader(const TStoreColumns& columns) : _columns(columns),
+                                                   _row(0),
+                                                   _index(0) {
+    }
+
+    void setRow(size_t row) {
+        _row = row;
+        _index = 0;
+    }
+
+    void operator()(const char* name, bool& value) {
+        const StoreColumn* c = column(name, StoreColumn::kInt64);
+        if ( c )
+            value = (c->_ints[_row] != 0);
+    }
+
+    void operator()(const char* name, int16_t& value) {
+        readInt(name, value);
+    }
+
+    void operator()(const char* name, uint16_t& value) {
+        readInt(name, value);
+    }
+
+    void operator()(const char* name, int32_t& value) {
+        readInt(name, value);
+    }
+
+    void operator()(const char* name, uint32_t& value) {
+        readInt(name, value);
+    }
+
+    void operator()(const char* name, int64_t& value) {
+        readInt(name, value);
+    }
+
+    void operator()(const char* name, uint64_t& value) {
+        readInt(name, value);
+    }
+
+    void operator()(const char* name, float& value) {
+        const StoreColumn* c = column(name, StoreColumn::kDouble);
+        if ( c )
+            value = static_cast<float>(c->_doubles[_row]);
+    }
+
+    void operator()(const char* name, double& value) {
+        const StoreColumn* c = column(name, StoreColumn::kDouble);
+        if ( c )
+            value = c->_doubles[_row];
+    }
+
+    void operator()(const char* name, std::string& value) {
+        const StoreColumn* c = column(name, StoreColumn::kString);
+        if ( c )
+            value = c->_strings[_row];
+    }
+
+    void operator()(const char* name, THighResTime& value) {
+        const StoreColumn* c = column(name, StoreColumn::kInt64);
+        if ( c )
+            value = StoreTime::fromMicros(c->_ints[_row]);
+    }
+
+    template <typename TType, bool TTypeDefault>
+    void operator()(const char* name, TypeWrap<TType, TTypeDefault>& value) {
+        TType v = value.get();
+        (*this)(name, v);
+        value.set(v);
+    }
+
+    template <typename TValue>
+    void operator()(const char* name, TValue& value) {
+        const StoreColumn* c = column(name, StoreColumn::kString);
+        if ( !c || c->_strings[_row].empty() )
+            return;
+
+        try {
+            value = boost::lexical_cast<TValue>(c->_strings[_row]);
+        } catch(...) {
+        }
+    }
+
+private:
+    template <typename TValue>
+    void readInt(const char* name, TValue& value) {
+        const StoreColumn* c = column(name, StoreColumn::kInt64);
+        if ( c )
+            value = static_cast<TValue>(c->_ints[_row]);
+    }
+
+    const StoreColumn* column(const char* name, StoreColumn::eType type);
+
+private:
+    const TStoreColumns& _columns;
+    std::vector<const StoreColumn*> _byPosition;
+    size_t _row;
+    size_t _index;
+};
+
+class ColumnStore;
+
+// Scans blocks of a table's partitions within filter's time range and
+// returns filter's matching rows one block at a time
+//
+class StoreScanner {
+public:
+    typedef std::vector<std::string> TNames;
+
+public:
+    // Empty names mean all columns
+    //
+    StoreScanner(const ColumnStore& store, const std::string& table, const StoreFilter& filter, const TNames& names = TNames());
+    ~StoreScanner();
+
+    // Returns false when there are no more blocks with matching rows
+    //
+    bool next(TStoreColumns& columns);
+
+    bool failed() const {
+        return _failed;
+    }
+
+    uint32_t blocksScanned() const {
+        return _blocksScanned;
+    }
+
+    uint32_t blocksSkipped() const {
+        return _blocksSkipped;
+    }
+
+private:
+    bool openNextFile();
+    bool readBlock(std::vector<char>& buffer);
+    bool processBlock(const std::vector<char>& buffer, TStoreColumns& columns);
+
+private:
+    const ColumnStore& _store;
+    StoreFilter _filter;
+    TNames _names;
+    std::vector<std::string> _files;
+    size_t _fileIndex;
+    FILE* _file;
+    uint64_t _fileOffset;
+    uint64_t _fileLength;
+    std::vector<char> _buffer;
+    bool _failed;
+    uint32_t _blocksScanned;
+    uint32_t _blocksSkipped;
+};
+
+class ColumnStore {
+public:
+    typedef tw::common_thread::Lock TLock;
+
+    static const char* FILE_EXT;
+
+public:
+    ColumnStore();
+
+    bool open(const std::string& dir);
+
+    bool isOpen() const {
+        return !_dir.empty();
+    }
+
+    const std::string& dir() const {
+        return _dir;
+    }
+
+    // Partition files of a table in ascending order of days, limited to
+    // days from/to (inclusive) when they are not empty
+    //
+    std::vector<std::string> getPartitions(const std::string& table, const std::string& fromDay = "", const std::string& toDay = "") const;
+
+public:
+    template <typename TRecord>
+    bool append(const std::string& table, const std::string& timeColumn, const std::vector<TRecord>& records) {
+        if ( records.empty() )
+            return true;
+
+        TStoreColumns columns;
+        StoreRowWriter writer(columns);
+        for ( size_t i = 0; i < records.size(); ++i ) {
+            writer.reset();
+            records[i].visitFields(writer);
+        }
+
+        return appendColumns(table, timeColumn, columns);
+    }
+
+    // Rows are split into days' partitions by time column
+    //
+    bool appendColumns(const std::string& table, const std::string& timeColumn, const TStoreColumns& columns);
+
+    template <typename TRecord>
+    bool read(const std::string& table, const StoreFilter& filter, std::vector<TRecord>& records) const {
+        StoreScanner scanner(*this, table, filter);
+        TStoreColumns columns;
+        while ( scanner.next(columns) ) {
+            size_t rows = columns.empty() ? 0 : columns[0].size();
+            StoreRowReader reader(columns);
+            for ( size_t i = 0; i < rows; ++i ) {
+                records.push_back(TRecord());
+                reader.setRow(i);
+                records.back().visitFields(reader);
+            }
+        }
+
+        return !scanner.failed();
+    }
+
+    bool readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, std::vector<int64_t>& values) const;
+    bool readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, std::vector<double>& values) const;
+    bool readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, std::vector<std::string>& values) const;
+
+    // Length of a partition file, which is safe to read - file isn't
+    // appended to by this store while it's taken
+    //
+    uint64_t getCommittedLength(const std::string& fileName) const;
+
+    // Truncates incomplete block (left by interrupted append) and anything
+    // after it at the end of a partition file, returns false if the file
+    // can't be read or truncated
+    //
+    static bool recoverTail(const std::string& fileName);
+
+private:
+    bool readColumn(const std::string& table, const StoreFilter& filter, const std::string& name, StoreColumn& values) const;
+
+private:
+    TLock _lock;
+    std::string _dir;
+
+    // Files, which were checked for torn tails before first append
+    //
+    std::set<std::string> _recoveredFiles;
+};
+
+} // namespace common
+} // namespace tw
@@ -2,6 +2,7 @@
 
 #include <tw/common/defs.h>
 #include <tw/common_comm/tcp_ip_server.h>
+#include <tw/common_comm/binary_frame.h>
 #include <tw/log/defs.h>
 #include <tw/generated/enums_common.h>
 
@@ -150,6 +151,102 @@ struct Command {
         return true;
     }
     
+    // Binary (schema encoded) form of command for connections, which negotiated
+    // binary framing (see tw::common_comm::BinaryFrame) - type/subType are encoded
+    // as their numeric values generated from enums_common.xml:
+    //
+    //      uint16_t type, uint16_t subType, uint16_t paramsCount,
+    //      paramsCount x (uint16_t nameLength, name, uint32_t valueLength, value)
+    //
+    void toBinary(std::string& frame) const {
+        typedef tw::common_comm::BinaryFrame TFrame;
+        
+        size_t offset = TFrame::begin(frame, TFrame::kCommand);
+        TFrame::append(frame, static_cast<uint16_t>(_type._enum));
+        TFrame::append(frame, static_cast<uint16_t>(_subType._enum));
+        TFrame::append(frame, static_cast<uint16_t>(_params.size()));
+        
+        TParams::const_iterator iter = _params.begin();
+        TParams::const_iterator end = _params.end();
+        
+        for ( ; iter != end; ++iter ) {
+            TFrame::append(frame, static_cast<uint16_t>(iter->first.size()));
+            frame.append(iter->first);
+            TFrame::append(frame, static_cast<uint32_t>(iter->second.size()));
+            frame.append(iter->second);
+        }
+        
+        TFrame::finish(frame, offset);
+    }
+    
+    std::string toBinary() const {
+        std::string frame;
+        toBinary(frame);
+        return frame;
+    }
+    
+    // Decodes frame's payload (i.e. w/o length prefix) of either binary
+    // or text kind
+    //
+    bool fromBinary(const char* data, size_t size) {
+        typedef tw::common_comm::BinaryFrame TFrame;
+        
+        const char* end = data+size;
+        
+        uint8_t kind = 0;
+        if ( !TFrame::read(data, end, kind) )
+            return false;
+        
+        switch ( kind ) {
+            case TFrame::kText:
+                return fromString(std::string(data, end));
+            case TFrame::kCommand:
+                break;
+            default:
+                LOGGER_ERRO << "unsupported frame kind: " << static_cast<uint32_t>(kind) << "\n";
+                return false;
+        }
+        
+        uint16_t type = 0;
+        uint16_t subType = 0;
+        uint16_t count = 0;
+        if ( !TFrame::read(data, end, type) || !TFrame::read(data, end, subType) || !TFrame::read(data, end, count) ) {
+            LOGGER_ERRO << "corrupted frame header" << "\n";
+            return false;
+        }
+        
+        _type.fromValue(type);
+        _subType.fromValue(subType);
+        
+        std::string name;
+        for ( uint16_t i = 0; i < count; ++i ) {
+            uint16_t nameLength = 0;
+            uint32_t valueLength = 0;
+            
+            if ( !TFrame::read(data, end, nameLength) || !TFrame::read(data, end, nameLength, name) ) {
+                LOGGER_ERRO << "corrupted param name: " << i << "\n";
+                return false;
+            }
+            
+            if ( has(name) ) {
+                LOGGER_ERRO << "params with the same name are NOT supported: " << name << "\n";
+                return false;
+            }
+            
+            if ( !TFrame::read(data, end, valueLength) || !TFrame::read(data, end, valueLength, _params[name]) ) {
+                LOGGER_ERRO << "corrupted param value: " << name << "\n";
+                return false;
+            }
+        }
+        
+        if ( data != end ) {
+            LOGGER_ERRO << "trailing bytes in frame: " << static_cast<uint32_t>(end-data) << "\n";
+            return false;
+        }
+        
+        return true;
+    }
+    
     template <typename TType>
     void addParams(const std::string& name, const TType& value) {
         _params[name] = boost::lexical_cast<std::string>(value);
@@ -1,4 +1,6 @@
-#ifdef ONIX_VER_LEGACY
+#if defined(TW_HIGH_RES_TIME_NATIVE)
+#include "high_res_time_native_impl.h"
+#elif defined(ONIX_VER_LEGACY)
 #include "high_res_time_onix_impl_legacy.h"
 #else
 #include "high_res_time_onix_impl_upgrade.h"
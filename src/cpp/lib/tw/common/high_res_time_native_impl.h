@@ -0,0 +1,657 @@
+#pragma once
+
+#include <tw/common/tsc_clock.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/date_time/gregorian/gregorian.hpp>
+
+#include <stdexcept>
+#include <cstring>
+#include <cctype>
+#include <ctime>
+#include <ostream>
+#include <istream>
+#include <string>
+#include <stdint.h>
+
+namespace tw {
+namespace common {
+
+// Self contained high resolution time (no dependency on Onix) - timestamps
+// are nanoseconds since epoch (UTC) read from TSC based clock (see
+// tw/common/tsc_clock.h). Selected with -DTW_HIGH_RES_TIME_NATIVE
+//
+
+static const std::string INVALID_TIME = "00000000-00:00:00.000000";
+
+typedef struct HighResTimeFields {
+    HighResTimeFields() {
+        clear();
+    }
+
+    void clear() {
+        year = 0;
+        month = 0;
+        day = 0;
+        hour = 0;
+        minute = 0;
+        seconds = 0;
+        microseconds = 0;
+    }
+
+    unsigned short year;
+    unsigned short month;
+    unsigned short day;
+    unsigned short hour;
+    unsigned short minute;
+    unsigned short seconds;
+    unsigned int microseconds;
+} THighResTimeFields;
+
+struct eHighResTimeUnits {
+    enum _ENUM {
+        kUnknown=0,
+
+        kUsecs=1,
+        kSecs=2,
+        kMins=3,
+        kHours=4
+    };
+
+    eHighResTimeUnits () {
+        _enum = kUnknown;
+    }
+
+    eHighResTimeUnits (_ENUM value) {
+        _enum = value;
+    }
+
+    bool isValid() const {
+        return (_enum != kUnknown);
+    }
+
+    operator _ENUM() const {
+        return _enum;
+    }
+
+    const char* toString() const {
+        switch (_enum) {
+
+            case kUsecs: return "uSecs";
+            case kSecs: return "Secs";
+            case kMins: return "Mins";
+            case kHours: return "Hours";
+            default: return "Unknown";
+        }
+    }
+
+    void fromString(const std::string& value) {
+
+        if ( boost::iequals(value, "usecs") ) {
+            _enum = kUsecs;
+            return;
+        }
+
+        if ( boost::iequals(value, "Secs") ) {
+            _enum = kSecs;
+            return;
+        }
+
+        if ( boost::iequals(value, "Mins") ) {
+            _enum = kMins;
+            return;
+        }
+
+        if ( boost::iequals(value, "Hours") ) {
+            _enum = kHours;
+            return;
+        }
+
+        _enum = kUnknown;
+    }
+
+    _ENUM _enum;
+};
+
+class HighResTimeSpan {
+public:
+    explicit HighResTimeSpan(int64_t nanos = 0) : _nanos(nanos) {
+    }
+
+    int64_t totalSeconds() const {
+        return _nanos/NANOS_IN_SEC;
+    }
+
+    // Nanoseconds part of the span (has the same sign as the span)
+    //
+    int64_t nanoseconds() const {
+        return _nanos%NANOS_IN_SEC;
+    }
+
+    int64_t totalNanoseconds() const {
+        return _nanos;
+    }
+
+private:
+    static const int64_t NANOS_IN_SEC = 1000000000LL;
+
+    int64_t _nanos;
+};
+
+// Nanoseconds since epoch, 0 is invalid (default) timestamp
+//
+class HighResTimestamp {
+    static const int64_t NANOS_IN_SEC = 1000000000LL;
+    static const int64_t SECS_IN_DAY = 24*60*60;
+
+public:
+    explicit HighResTimestamp(int64_t nanos = 0) : _nanos(nanos) {
+    }
+
+    static HighResTimestamp utcNow() {
+        return HighResTimestamp(TscClock::nowNanos());
+    }
+
+    // Example: "20111222-13:55:21.154378", fractional part is optional
+    // and can have up to 9 digits
+    //
+    static HighResTimestamp deserialize(const std::string& value) {
+        static const char* FORMAT = "DDDDDDDD-DD:DD:DD";
+
+        const size_t length = ::strlen(FORMAT);
+        if ( value.length() < length )
+            throw std::invalid_argument("invalid timestamp: " + value);
+
+        for ( size_t i = 0; i < length; ++i ) {
+            if ( 'D' == FORMAT[i] ? !::isdigit(value[i]) : FORMAT[i] != value[i] )
+                throw std::invalid_argument("invalid timestamp: " + value);
+        }
+
+        int64_t nanos = 0;
+        if ( value.length() > length ) {
+            if ( '.' != value[length] || value.length() > length+10 )
+                throw std::invalid_argument("invalid timestamp: " + value);
+
+            int64_t scale = NANOS_IN_SEC;
+            for ( size_t i = length+1; i < value.length(); ++i ) {
+                if ( !::isdigit(value[i]) )
+                    throw std::invalid_argument("invalid timestamp: " + value);
+
+                scale /= 10;
+                nanos += (value[i]-'0')*scale;
+            }
+        }
+
+        int64_t days = daysFromCivil(toInt(value, 0, 4), toInt(value, 4, 2), toInt(value, 6, 2));
+        int64_t secs = days*SECS_IN_DAY + toInt(value, 9, 2)*3600 + toInt(value, 12, 2)*60 + toInt(value, 15, 2);
+
+        return HighResTimestamp(secs*NANOS_IN_SEC + nanos);
+    }
+
+public:
+    bool isValid() const {
+        return (0 != _nanos);
+    }
+
+    int64_t sinceEpoch() const {
+        return _nanos;
+    }
+
+    // Invalid timestamp has year 1 - as in Onix's Timestamp
+    //
+    unsigned short year() const {
+        if ( !isValid() )
+            return 1;
+
+        THighResTimeFields f;
+        getFields(f);
+        return f.year;
+    }
+
+    unsigned short month() const {
+        THighResTimeFields f;
+        getFields(f);
+        return f.month;
+    }
+
+    unsigned short day() const {
+        THighResTimeFields f;
+        getFields(f);
+        return f.day;
+    }
+
+    unsigned short hour() const {
+        return static_cast<unsigned short>(secondsOfDay()/3600);
+    }
+
+    unsigned short minute() const {
+        return static_cast<unsigned short>((secondsOfDay()/60)%60);
+    }
+
+    unsigned short second() const {
+        return static_cast<unsigned short>(secondsOfDay()%60);
+    }
+
+    unsigned int microsecond() const {
+        return static_cast<unsigned int>(floorMod(_nanos, NANOS_IN_SEC)/1000);
+    }
+
+    void getFields(THighResTimeFields& f) const {
+        int64_t secs = floorDiv(_nanos, NANOS_IN_SEC);
+        int64_t secsOfDay = floorMod(secs, SECS_IN_DAY);
+        int64_t y = 0;
+        int64_t m = 0;
+        int64_t d = 0;
+        civilFromDays(floorDiv(secs, SECS_IN_DAY), y, m, d);
+
+        f.year = static_cast<unsigned short>(y);
+        f.month = static_cast<unsigned short>(m);
+        f.day = static_cast<unsigned short>(d);
+        f.hour = static_cast<unsigned short>(secsOfDay/3600);
+        f.minute = static_cast<unsigned short>((secsOfDay/60)%60);
+        f.seconds = static_cast<unsigned short>(secsOfDay%60);
+        f.microseconds = static_cast<unsigned int>(floorMod(_nanos, NANOS_IN_SEC)/1000);
+    }
+
+    // Formats as "YYYYMMDD-HH:MM:SS.ffffff" - date/time part is cached per
+    // thread for the last formatted second, so formatting of consecutive
+    // timestamps only formats microseconds
+    //
+    std::string toString() const {
+        char buffer[24];
+        format(buffer);
+        return std::string(buffer, sizeof(buffer));
+    }
+
+    void format(char* buffer) const {
+        static __thread int64_t cachedSecs = 0;
+        static __thread char cachedPrefix[17];
+
+        int64_t secs = floorDiv(_nanos, NANOS_IN_SEC);
+        if ( secs != cachedSecs || 0 == cachedPrefix[0] ) {
+            THighResTimeFields f;
+            getFields(f);
+
+            toChars(cachedPrefix, f.year, 4);
+            toChars(cachedPrefix+4, f.month, 2);
+            toChars(cachedPrefix+6, f.day, 2);
+            cachedPrefix[8] = '-';
+            toChars(cachedPrefix+9, f.hour, 2);
+            cachedPrefix[11] = ':';
+            toChars(cachedPrefix+12, f.minute, 2);
+            cachedPrefix[14] = ':';
+            toChars(cachedPrefix+15, f.seconds, 2);
+            cachedSecs = secs;
+        }
+
+        ::memcpy(buffer, cachedPrefix, sizeof(cachedPrefix));
+        buffer[17] = '.';
+        toChars(buffer+18, static_cast<uint32_t>(floorMod(_nanos, NANOS_IN_SEC)/1000), 6);
+    }
+
+public:
+    bool operator==(const HighResTimestamp& rhs) const {
+        return _nanos == rhs._nanos;
+    }
+
+    bool operator!=(const HighResTimestamp& rhs) const {
+        return _nanos != rhs._nanos;
+    }
+
+    bool operator<(const HighResTimestamp& rhs) const {
+        return _nanos < rhs._nanos;
+    }
+
+    HighResTimeSpan operator-(const HighResTimestamp& rhs) const {
+        return HighResTimeSpan(_nanos-rhs._nanos);
+    }
+
+    HighResTimestamp& operator+=(const HighResTimeSpan& rhs) {
+        _nanos += rhs.totalNanoseconds();
+        return *this;
+    }
+
+    HighResTimestamp& operator-=(const HighResTimeSpan& rhs) {
+        _nanos -= rhs.totalNanoseconds();
+        return *this;
+    }
+
+private:
+    int64_t secondsOfDay() const {
+        return floorMod(floorDiv(_nanos, NANOS_IN_SEC), SECS_IN_DAY);
+    }
+
+    static int64_t floorDiv(int64_t a, int64_t b) {
+        return (a >= 0) ? (a/b) : ((a-b+1)/b);
+    }
+
+    static int64_t floorMod(int64_t a, int64_t b) {
+        return a-floorDiv(a, b)*b;
+    }
+
+    static int64_t toInt(const std::string& value, size_t pos, size_t length) {
+        int64_t v = 0;
+        for ( size_t i = pos; i < pos+length; ++i )
+            v = v*10 + (value[i]-'0');
+
+        return v;
+    }
+
+    static void toChars(char* buffer, uint32_t value, uint32_t length) {
+        for ( int32_t i = static_cast<int32_t>(length)-1; i >= 0; --i ) {
+            buffer[i] = static_cast<char>('0' + value%10);
+            value /= 10;
+        }
+    }
+
+    // Proleptic gregorian calendar conversions (H. Hinnant's algorithms)
+    //
+    static int64_t daysFromCivil(int64_t y, int64_t m, int64_t d) {
+        y -= (m <= 2) ? 1 : 0;
+        int64_t era = ((y >= 0) ? y : (y-399))/400;
+        int64_t yoe = y-era*400;
+        int64_t doy = (153*((m > 2) ? (m-3) : (m+9)) + 2)/5 + d-1;
+        int64_t doe = yoe*365 + yoe/4 - yoe/100 + doy;
+        return era*146097 + doe - 719468;
+    }
+
+    static void civilFromDays(int64_t z, int64_t& y, int64_t& m, int64_t& d) {
+        z += 719468;
+        int64_t era = ((z >= 0) ? z : (z-146096))/146097;
+        int64_t doe = z-era*146097;
+        int64_t yoe = (doe - doe/1460 + doe/36524 - doe/146096)/365;
+        int64_t doy = doe - (365*yoe + yoe/4 - yoe/100);
+        int64_t mp = (5*doy + 2)/153;
+        d = doy - (153*mp + 2)/5 + 1;
+        m = (mp < 10) ? (mp+3) : (mp-9);
+        y = yoe + era*400 + ((m <= 2) ? 1 : 0);
+    }
+
+private:
+    int64_t _nanos;
+};
+
+typedef HighResTimeSpan THighResTimeSpanImpl;
+typedef HighResTimestamp THighResTimeImpl;
+
+class THighResTime {
+    static const uint32_t STANDARD_LENGTH = 24;
+    static const uint32_t MIN_STANDARD_LENGTH = 17;
+
+public:
+    static THighResTime now() {
+        THighResTime value;
+        value._impl = THighResTimeImpl::utcNow();
+        return value;
+    }
+
+    static THighResTime fromNanos(int64_t nanos) {
+        THighResTime value;
+        value._impl = THighResTimeImpl(nanos);
+        return value;
+    }
+
+    static std::string nowDate() {
+        return now()._impl.toString().substr(0,8);
+    }
+
+    // Example: "20111222-13:55:21.154378"
+    //
+    static THighResTime parse(const std::string& time) {
+        THighResTime value;
+        if ( STANDARD_LENGTH <= time.length() )
+            value._impl = THighResTimeImpl::deserialize(time.substr(0, STANDARD_LENGTH));
+        else if ( MIN_STANDARD_LENGTH <= time.length() )
+            value._impl = THighResTimeImpl::deserialize(time);
+
+        return value;
+    }
+
+    // Example: "2012-01-17 14:41:01.548" => "20120117-14:41:01.548"
+    //
+    static THighResTime parseSqlTime(const std::string& time) {
+        std::string t = time;
+        boost::algorithm::erase_all(t, "-");
+        boost::algorithm::replace_first(t, " ", "-");
+
+        return parse(t);
+    }
+
+    // Example: "20120117144101548" => "20120117-14:41:01.548"
+    //
+    static THighResTime parseCMETime(const std::string& time) {
+        if ( time.length() < MIN_STANDARD_LENGTH )
+            return now();
+
+        std::string t = time;
+        t.insert(14, ".");
+        t.insert(12, ":");
+        t.insert(10, ":");
+        t.insert(8, "-");
+
+        return parse(t);
+    }
+
+    // This will produce output in HH:MM:SS.ffffff format.
+    // NOTE: will work for durations of up to 24 hours only!
+    //
+    static std::string deltaToString(int64_t delta) {
+        boost::posix_time::time_duration td = boost::posix_time::microseconds(delta);
+        return boost::posix_time::to_simple_string(td);
+    }
+
+    static int32_t daysToMinutes(int32_t days) {
+        return days * 24 * 60;
+    }
+
+    // This will produce output in YYYYMMDD format.
+    //
+    static std::string dateISOString(int32_t offset=0) {
+        if ( !offset )
+            return boost::gregorian::to_iso_string(boost::gregorian::day_clock::local_day());
+
+        return boost::gregorian::to_iso_string(boost::gregorian::day_clock::local_day()+boost::gregorian::days(offset));
+    }
+
+    static int32_t getUtcOffset() {
+        std::time_t current_time;
+        std::time(&current_time);
+        struct std::tm *timeinfo = std::localtime(&current_time);
+        return (-timeinfo->tm_gmtoff/3600);
+    }
+
+    // This will produce output in YYYY-MM-DD HH:MM::SS format.
+    //
+    static std::string sqlString(int32_t offsetInSec=0, bool GMT_mode=false) {
+        if (!GMT_mode)
+            return boost::posix_time::to_iso_extended_string(boost::posix_time::second_clock::local_time()+boost::posix_time::seconds(offsetInSec));
+
+        return boost::posix_time::to_iso_extended_string(boost::posix_time::second_clock::universal_time()+boost::posix_time::seconds(offsetInSec));
+    }
+
+public:
+    THighResTime() {
+        clear();
+    }
+
+    THighResTime(const THighResTime& rhs) {
+        *this = rhs;
+    }
+
+    THighResTime(const THighResTimeImpl& rhs) {
+        *this = rhs;
+    }
+
+    THighResTime& operator=(const THighResTime& rhs) {
+        _impl = rhs._impl;
+        return *this;
+    }
+
+    THighResTime& operator=(const THighResTimeImpl& rhs) {
+        _impl = rhs;
+        return *this;
+    }
+
+    void clear() {
+        _impl = THighResTimeImpl();
+    }
+
+    THighResTimeImpl& getImpl() {
+        return _impl;
+    }
+
+    const THighResTimeImpl& getImpl() const {
+        return _impl;
+    }
+
+    int64_t nanos() const {
+        return _impl.sinceEpoch();
+    }
+
+    unsigned short hour() const {
+        return _impl.hour();
+    }
+
+    unsigned short minute() const {
+        return _impl.minute();
+    }
+
+    unsigned short seconds() const {
+        return _impl.second();
+    }
+
+    unsigned int microseconds() const {
+        return _impl.microsecond();
+    }
+
+public:
+    bool isValid() const {
+        return _impl.isValid();
+    }
+
+    bool isBad() const {
+        return !_impl.isValid();
+    }
+
+    void setToNow() {
+        _impl = THighResTimeImpl::utcNow();
+    }
+
+    uint64_t getUsecsFromMidnight() const {
+        return getUnitsFromMidnight(tw::common::eHighResTimeUnits::kUsecs);
+    }
+
+    uint64_t getUnitsFromMidnight(eHighResTimeUnits units) const {
+        THighResTimeFields f;
+        _impl.getFields(f);
+
+        return getUnitsFromMidnight(units, f);
+    }
+
+    static uint64_t getUnitsFromMidnight(eHighResTimeUnits units, const THighResTimeFields& f) {
+        uint64_t v = 0;
+        switch (units) {
+            case eHighResTimeUnits::kUsecs:
+                v += static_cast<uint64_t>(f.hour) * 60 * 60 * 1000 * 1000;
+                v += static_cast<uint64_t>(f.minute) * 60 * 1000 * 1000;
+                v += static_cast<uint64_t>(f.seconds) * 1000 * 1000;
+                v += static_cast<uint64_t>(f.microseconds);
+                break;
+            case eHighResTimeUnits::kSecs:
+                v += static_cast<uint64_t>(f.hour) * 60 * 60;
+                v += static_cast<uint64_t>(f.minute) * 60;
+                v += static_cast<uint64_t>(f.seconds);
+                break;
+            case eHighResTimeUnits::kMins:
+                v += static_cast<uint64_t>(f.hour) * 60;
+                v += static_cast<uint64_t>(f.minute);
+                break;
+            case eHighResTimeUnits::kHours:
+                v += static_cast<uint64_t>(f.hour);
+                break;
+            default:
+                break;
+        }
+
+        return v;
+    }
+
+    std::string toString() const {
+        if ( !isValid() )
+            return INVALID_TIME;
+
+        return _impl.toString();
+    }
+
+    bool operator==(const THighResTime& rhs) const {
+        return _impl == rhs._impl;
+    }
+
+    bool operator!=(const THighResTime& rhs) const {
+        return _impl != rhs._impl;
+    }
+
+    bool operator<(const THighResTime& rhs) const {
+        return _impl < rhs._impl;
+    }
+
+    int64_t operator-(const THighResTime& rhs) const {
+        return (_impl-rhs._impl).totalNanoseconds()/1000;
+    }
+
+    int64_t deltaSeconds(const THighResTime& rhs) const {
+        return (_impl-rhs._impl).totalSeconds();
+    }
+
+    friend std::ostream& operator<<(std::ostream& ostream, const THighResTime& x) {
+        return ostream << x.toString();
+    }
+
+    friend bool operator>>(std::istream& istream, THighResTime& x) {
+        try {
+            std::string str;
+            istream >> str;
+
+            if ( INVALID_TIME == str )
+                return true;
+
+            x = THighResTime::parse(str);
+        } catch(...) {
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    THighResTimeImpl _impl;
+};
+
+class THighResTimeScope {
+public:
+    THighResTimeScope(THighResTime& t1,
+                      THighResTime& t2) : _t1(t1),
+                                          _t2(t2) {
+        _t1.setToNow();
+    }
+
+    THighResTimeScope(const THighResTime& now,
+                      THighResTime& t1,
+                      THighResTime& t2) : _t1(t1),
+                                          _t2(t2) {
+        _t1 = now;
+    }
+
+    ~THighResTimeScope() {
+        _t2.setToNow();
+    }
+
+private:
+    THighResTime& _t1;
+    THighResTime& _t2;
+};
+
+
+} // namespace common
+} // namespace tw
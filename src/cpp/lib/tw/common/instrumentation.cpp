@@ -0,0 +1,355 @@
+#include <tw/common/instrumentation.h>
+
+#include <fstream>
+
+namespace tw {
+namespace common {
+
+// LatencyHistogram class
+//
+LatencyHistogram LatencyScope::_null;
+
+LatencyHistogram::Snapshot& LatencyHistogram::Snapshot::operator-=(const Snapshot& rhs) {
+    if ( rhs._count > _count || rhs._buckets.size() != _buckets.size() ) {
+        clear();
+        return *this;
+    }
+
+    _count -= rhs._count;
+    _sum -= rhs._sum;
+
+    uint64_t max = 0;
+    for ( size_t i = 0; i < _buckets.size(); ++i ) {
+        _buckets[i] = (_buckets[i] > rhs._buckets[i]) ? (_buckets[i] - rhs._buckets[i]) : 0;
+        if ( _buckets[i] > 0 )
+            max = bucketHighValue(static_cast<uint32_t>(i));
+    }
+
+    if ( max < _max )
+        _max = max;
+
+    return *this;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double p) const {
+    if ( 0 == _count )
+        return 0;
+
+    if ( p < 0.0 )
+        p = 0.0;
+    else if ( p > 1.0 )
+        p = 1.0;
+
+    uint64_t rank = static_cast<uint64_t>(p * _count + 0.5);
+    if ( 0 == rank )
+        rank = 1;
+
+    uint64_t total = 0;
+    for ( size_t i = 0; i < _buckets.size(); ++i ) {
+        total += _buckets[i];
+        if ( total >= rank ) {
+            uint64_t value = bucketHighValue(static_cast<uint32_t>(i));
+            return (value < _max) ? value : _max;
+        }
+    }
+
+    return _max;
+}
+
+std::string LatencyHistogram::Snapshot::toString() const {
+    std::stringstream s;
+
+    s << "count=" << _count
+      << ",mean=" << mean()
+      << ",p010=" << percentile(0.01)
+      << ",p100=" << percentile(0.1)
+      << ",p250=" << percentile(0.25)
+      << ",p500=" << percentile(0.5)
+      << ",p750=" << percentile(0.75)
+      << ",p900=" << percentile(0.9)
+      << ",p990=" << percentile(0.99)
+      << ",p999=" << percentile(0.999)
+      << ",max=" << _max;
+
+    return s.str();
+}
+
+// Instrumentation class
+//
+const char* Instrumentation::toString(eStage stage) {
+    switch ( stage ) {
+        case kFeedDecode: return "feed_decode";
+        case kQuoteStorePublish: return "quote_store_publish";
+        case kStratCallback: return "strat_callback";
+        case kProcessorChain: return "processor_chain";
+        case kFixSend: return "fix_send";
+        case kAck: return "ack";
+        default: return "unknown";
+    }
+}
+
+Instrumentation::Instrumentation() : _enabled(false) {
+    for ( int32_t i = 0; i < kStagesCount; ++i ) {
+        _stages.push_back(createStage(toString(static_cast<eStage>(i))));
+        _wellKnownStages[i] = &(_stages.back()->_histogram);
+    }
+}
+
+Instrumentation::TStagePtr Instrumentation::createStage(const std::string& name) {
+    TStagePtr stage(new Stage());
+    stage->_name = name;
+    stage->_histogram.setEnabled(_enabled);
+
+    return stage;
+}
+
+bool Instrumentation::init(const tw::common::Settings& settings) {
+    {
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        _dumpFile = settings._instrumentation_dumpFile;
+    }
+
+    setEnabled(settings._instrumentation_enabled);
+    if ( _enabled )
+        LOGGER_INFO << "Enabled instrumentation, dumpFile: " << (_dumpFile.empty() ? "none" : _dumpFile) << "\n";
+
+    return true;
+}
+
+void Instrumentation::stop() {
+    if ( !_enabled )
+        return;
+
+    LOGGER_INFO << "Instrumentation: " << toString() << "\n";
+
+    if ( !_dumpFile.empty() )
+        dump(_dumpFile);
+}
+
+void Instrumentation::setEnabled(bool value) {
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    _enabled = value;
+    for ( size_t i = 0; i < _stages.size(); ++i )
+        _stages[i]->_histogram.setEnabled(value);
+}
+
+LatencyHistogram& Instrumentation::registerStage(const std::string& name) {
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    for ( size_t i = 0; i < _stages.size(); ++i ) {
+        if ( _stages[i]->_name == name )
+            return _stages[i]->_histogram;
+    }
+
+    _stages.push_back(createStage(name));
+    return _stages.back()->_histogram;
+}
+
+void Instrumentation::getSnapshots(TNamedSnapshots& snapshots) {
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    snapshots.clear();
+    for ( size_t i = 0; i < _stages.size(); ++i ) {
+        const Stage& stage = *(_stages[i]);
+
+        LatencyHistogram::Snapshot s;
+        stage._histogram.snapshot(s);
+        s -= stage._baseline;
+        if ( 0 == s._count )
+            continue;
+
+        snapshots.push_back(TNamedSnapshot(stage._name, s));
+    }
+}
+
+void Instrumentation::reset() {
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    for ( size_t i = 0; i < _stages.size(); ++i )
+        _stages[i]->_histogram.snapshot(_stages[i]->_baseline);
+}
+
+std::string Instrumentation::toString() {
+    TNamedSnapshots snapshots;
+    getSnapshots(snapshots);
+
+    std::stringstream s;
+    for ( size_t i = 0; i < snapshots.size(); ++i ) {
+        if ( i > 0 )
+            s << " <==> ";
+
+        s << "name=" << snapshots[i].first << "," << snapshots[i].second.toString();
+    }
+
+    return s.str();
+}
+
+bool Instrumentation::dump(const std::string& fileName) {
+    try {
+        TNamedSnapshots snapshots;
+        getSnapshots(snapshots);
+
+        std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if ( !out.good() ) {
+            LOGGER_ERRO << "Failed to open: " << fileName << "\n";
+            return false;
+        }
+
+        uint32_t header[5] = { DUMP_MAGIC, DUMP_VERSION, LatencyHistogram::SUB_BUCKET_BITS, LatencyHistogram::MAX_BITS, static_cast<uint32_t>(snapshots.size()) };
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        for ( size_t i = 0; i < snapshots.size(); ++i ) {
+            const std::string& name = snapshots[i].first;
+            const LatencyHistogram::Snapshot& s = snapshots[i].second;
+
+            uint32_t length = static_cast<uint32_t>(name.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(name.data(), length);
+
+            uint64_t values[3] = { s._count, s._sum, s._max };
+            out.write(reinterpret_cast<const char*>(values), sizeof(values));
+            out.write(reinterpret_cast<const char*>(&(s._buckets[0])), s._buckets.size()*sizeof(uint64_t));
+        }
+
+        if ( !out.good() ) {
+            LOGGER_ERRO << "Failed to write: " << fileName << "\n";
+            return false;
+        }
+
+        LOGGER_INFO << "Dumped " << snapshots.size() << " stage(s) to: " << fileName << "\n";
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        return false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool Instrumentation::readDump(const std::string& fileName, TNamedSnapshots& snapshots) {
+    try {
+        snapshots.clear();
+
+        std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+        if ( !in.good() ) {
+            LOGGER_ERRO << "Failed to open: " << fileName << "\n";
+            return false;
+        }
+
+        uint32_t header[5];
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        if ( !in.good() || DUMP_MAGIC != header[0] || DUMP_VERSION != header[1] ) {
+            LOGGER_ERRO << "Not an instrumentation dump: " << fileName << "\n";
+            return false;
+        }
+
+        if ( LatencyHistogram::SUB_BUCKET_BITS != header[2] || LatencyHistogram::MAX_BITS != header[3] ) {
+            LOGGER_ERRO << "Unsupported buckets layout: " << header[2] << "," << header[3] << " in: " << fileName << "\n";
+            return false;
+        }
+
+        for ( uint32_t i = 0; i < header[4]; ++i ) {
+            uint32_t length = 0;
+            in.read(reinterpret_cast<char*>(&length), sizeof(length));
+            if ( !in.good() || length > 1024 ) {
+                LOGGER_ERRO << "Corrupted stage: " << i << " in: " << fileName << "\n";
+                return false;
+            }
+
+            TNamedSnapshot item;
+            item.first.resize(length);
+            if ( length > 0 )
+                in.read(&(item.first[0]), length);
+
+            uint64_t values[3];
+            in.read(reinterpret_cast<char*>(values), sizeof(values));
+            item.second._count = values[0];
+            item.second._sum = values[1];
+            item.second._max = values[2];
+            in.read(reinterpret_cast<char*>(&(item.second._buckets[0])), item.second._buckets.size()*sizeof(uint64_t));
+
+            if ( !in.good() ) {
+                LOGGER_ERRO << "Truncated stage: " << i << " in: " << fileName << "\n";
+                return false;
+            }
+
+            snapshots.push_back(item);
+        }
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        return false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool Instrumentation::processCommand(tw::common::Command& cmnd) {
+    try {
+        if ( cmnd._type != tw::common::eCommandType::kInstrumentation ) {
+            LOGGER_ERRO << "cmnd._type != tw::common::eCommandType::kInstrumentation in: "  << cmnd.toString() << "\n";
+            return false;
+        }
+
+        if ( cmnd._subType != tw::common::eCommandSubType::kStatus ) {
+            LOGGER_ERRO << "command._subType != tw::common::eCommandSubType::kStatus in: "  << cmnd.toString() << "\n";
+            return false;
+        }
+
+        std::string name;
+        std::string fileName;
+        std::string doReset;
+
+        if ( cmnd.has("stage") )
+            cmnd.get("stage", name);
+
+        if ( cmnd.has("file") )
+            cmnd.get("file", fileName);
+
+        if ( cmnd.has("reset") )
+            cmnd.get("reset", doReset);
+
+        if ( !fileName.empty() && !dump(fileName) )
+            return false;
+
+        TNamedSnapshots snapshots;
+        getSnapshots(snapshots);
+
+        tw::common::Command c;
+        c.addParams("enabled", _enabled);
+        for ( size_t i = 0; i < snapshots.size(); ++i ) {
+            const std::string& stage = snapshots[i].first;
+            const LatencyHistogram::Snapshot& s = snapshots[i].second;
+            if ( !name.empty() && name != stage )
+                continue;
+
+            c.addParams(stage + ".count", s._count);
+            c.addParams(stage + ".mean", s.mean());
+            c.addParams(stage + ".p500", s.percentile(0.5));
+            c.addParams(stage + ".p900", s.percentile(0.9));
+            c.addParams(stage + ".p990", s.percentile(0.99));
+            c.addParams(stage + ".p999", s.percentile(0.999));
+            c.addParams(stage + ".max", s._max);
+        }
+
+        if ( "1" == doReset || boost::iequals(doReset, "true") )
+            reset();
+
+        cmnd._params = c._params;
+        return true;
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+
+    return false;
+}
+
+} // namespace common
+} // namespace tw
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <tw/common/defs.h>
+#include <tw/common/settings.h>
+#include <tw/common/singleton.h>
+#include <tw/common/command.h>
+#include <tw/common/tsc_clock.h>
+#include <tw/common_thread/locks.h>
+#include <tw/log/defs.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+namespace tw {
+namespace common {
+
+// Log-linear (HDR style) histogram of latencies in nanos: values below
+// SUB_BUCKETS are counted exactly, larger values with relative precision of
+// 1/SUB_BUCKETS (~3%), values of 2^MAX_BITS (~18 minutes) and above are
+// counted in the last bucket
+//
+// NOTE: record() is lock free and meant to be called from a single writer
+// thread (stage's hot path) - snapshot() can be called from any thread and
+// might miss values being recorded at the same time
+//
+class LatencyHistogram {
+public:
+    static const uint32_t SUB_BUCKET_BITS = 5;
+    static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const uint32_t MAX_BITS = 40;
+    static const uint32_t BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot {
+        Snapshot() {
+            clear();
+        }
+
+        void clear() {
+            _count = 0;
+            _sum = 0;
+            _max = 0;
+            _buckets.assign(BUCKETS, 0);
+        }
+
+        // Counts recorded since 'rhs' was taken - max is estimated from
+        // the highest non empty bucket
+        //
+        Snapshot& operator-=(const Snapshot& rhs);
+
+        // 'p' - in range [0.0, 1.0], returns highest value equivalent to
+        // the bucket of the percentile
+        //
+        uint64_t percentile(double p) const;
+
+        uint64_t mean() const {
+            return (_count > 0) ? (_sum / _count) : 0;
+        }
+
+        std::string toString() const;
+
+        uint64_t _count;
+        uint64_t _sum;
+        uint64_t _max;
+        std::vector<uint64_t> _buckets;
+    };
+
+public:
+    LatencyHistogram() : _enabled(false) {
+        clear();
+    }
+
+    void clear() {
+        _count = 0;
+        _sum = 0;
+        _max = 0;
+        for ( uint32_t i = 0; i < BUCKETS; ++i )
+            _buckets[i] = 0;
+    }
+
+    bool isEnabled() const {
+        return _enabled;
+    }
+
+    void setEnabled(bool value) {
+        _enabled = value;
+    }
+
+public:
+    static uint32_t bucketIndex(uint64_t value) {
+        if ( value < SUB_BUCKETS )
+            return static_cast<uint32_t>(value);
+
+        uint32_t msb = 63 - __builtin_clzll(value);
+        if ( msb >= MAX_BITS )
+            return BUCKETS-1;
+
+        uint32_t shift = msb - SUB_BUCKET_BITS;
+        return (shift+1) * SUB_BUCKETS + static_cast<uint32_t>((value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t bucketLowValue(uint32_t index) {
+        if ( index < SUB_BUCKETS )
+            return index;
+
+        uint32_t shift = index / SUB_BUCKETS - 1;
+        return static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    }
+
+    static uint64_t bucketHighValue(uint32_t index) {
+        if ( index < SUB_BUCKETS )
+            return index;
+
+        uint32_t shift = index / SUB_BUCKETS - 1;
+        return bucketLowValue(index) + (static_cast<uint64_t>(1) << shift) - 1;
+    }
+
+public:
+    void record(int64_t value) {
+        uint64_t v = (value > 0) ? static_cast<uint64_t>(value) : 0;
+
+        ++_buckets[bucketIndex(v)];
+        ++_count;
+        _sum += v;
+        if ( v > _max )
+            _max = v;
+    }
+
+    void snapshot(Snapshot& s) const {
+        s._count = _count;
+        s._sum = _sum;
+        s._max = _max;
+        s._buckets.assign(_buckets, _buckets+BUCKETS);
+    }
+
+private:
+    bool _enabled;
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _max;
+    uint64_t _buckets[BUCKETS];
+};
+
+// Monotonic clock in nanos used for stages' timings (TSC based, falls
+// back to CLOCK_MONOTONIC if TSC isn't invariant)
+//
+inline int64_t nowNanos() {
+    return TscClock::monotonicNanos();
+}
+
+// Records time spent in the scope into histogram - does not read the
+// clock if histogram is disabled
+//
+class LatencyScope {
+public:
+    LatencyScope(LatencyHistogram& histogram) : _histogram(histogram),
+                                                _start(histogram.isEnabled() ? nowNanos() : 0) {
+    }
+
+    LatencyScope(LatencyHistogram* histogram) : _histogram(histogram ? *histogram : _null),
+                                                _start(_histogram.isEnabled() ? nowNanos() : 0) {
+    }
+
+    ~LatencyScope() {
+        if ( _histogram.isEnabled() )
+            _histogram.record(nowNanos() - _start);
+    }
+
+private:
+    static LatencyHistogram _null;
+
+    LatencyHistogram& _histogram;
+    int64_t _start;
+};
+
+// Registry of hot path latency histograms - well known stages are
+// preallocated and addressed by index, others (e.g. processors in
+// channel_or chain) are registered by name on construction
+//
+// Stats are exposed over msg bus with 'Instrumentation,Status' command:
+//      stage=<name>    - only report specified stage
+//      reset=true      - start new reporting interval after reporting
+//      file=<name>     - dump histograms to binary file (see dump())
+//
+class Instrumentation : public Singleton<Instrumentation> {
+public:
+    enum eStage {
+        kFeedDecode = 0,
+        kQuoteStorePublish = 1,
+        kStratCallback = 2,
+        kProcessorChain = 3,
+        kFixSend = 4,
+        kAck = 5,
+        kStagesCount
+    };
+
+    static const char* toString(eStage stage);
+
+    // Binary dump file format (host byte order):
+    //      header:         uint32 magic, uint32 version, uint32 SUB_BUCKET_BITS, uint32 MAX_BITS, uint32 stagesCount
+    //      each stage:     uint32 nameLength, char name[nameLength], uint64 count, uint64 sum, uint64 max, uint64 buckets[BUCKETS]
+    //
+    static const uint32_t DUMP_MAGIC = 0x484C5754; // "TWLH"
+    static const uint32_t DUMP_VERSION = 1;
+
+    typedef std::pair<std::string, LatencyHistogram::Snapshot> TNamedSnapshot;
+    typedef std::vector<TNamedSnapshot> TNamedSnapshots;
+
+public:
+    Instrumentation();
+
+    bool init(const tw::common::Settings& settings);
+    void stop();
+
+public:
+    bool isEnabled() const {
+        return _enabled;
+    }
+
+    void setEnabled(bool value);
+
+    LatencyHistogram& getStage(eStage stage) {
+        return *(_wellKnownStages[stage]);
+    }
+
+    // Returns existing histogram if stage with 'name' is already registered
+    //
+    LatencyHistogram& registerStage(const std::string& name);
+
+    // Snapshots of all stages with recorded values since last reset()
+    //
+    void getSnapshots(TNamedSnapshots& snapshots);
+
+    // Starts new reporting interval - histograms are not cleared (writers
+    // are never blocked), reported values are deltas from reset time
+    //
+    void reset();
+
+    bool dump(const std::string& fileName);
+    static bool readDump(const std::string& fileName, TNamedSnapshots& snapshots);
+
+    std::string toString();
+
+public:
+    bool processCommand(tw::common::Command& cmnd);
+
+private:
+    struct Stage {
+        std::string _name;
+        LatencyHistogram _histogram;
+        LatencyHistogram::Snapshot _baseline;
+    };
+
+    typedef boost::shared_ptr<Stage> TStagePtr;
+    typedef std::vector<TStagePtr> TStages;
+    typedef tw::common_thread::Lock TLock;
+
+    TStagePtr createStage(const std::string& name);
+
+private:
+    TLock _lock;
+    bool _enabled;
+    std::string _dumpFile;
+    TStages _stages;
+    LatencyHistogram* _wellKnownStages[kStagesCount];
+};
+
+} // namespace common
+} // namespace tw
@@ -291,6 +291,10 @@ public:
         
             (("db.connection_str"), _db_connection_str, "specifies db connection string")
             (("db.listen_connection_str"), _db_listen_connection_str, "specifies db connection string for Vert which is object of listener")    
+            (("db.write_mode"), _db_write_mode, "specifies how batches are written to db - can be: text, prepared, bulk", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>("prepared"))
+            (("db.bulk_load_min_rows"), _db_bulk_load_min_rows, "min number of rows in a batch to use bulk load for in 'bulk' write mode", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(5000))
+            (("column_store.dir"), _column_store_dir, "dir of local columnar store which storages also write bars, fills and pnl audit trail to - empty disables the store", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("column_store.read_fills"), _column_store_read_fills, "specifies whether fills for date are read from local columnar store instead of db - store matches date against UTC day of fills' timestamp1 (not time of db insert) and only has fills persisted since column_store.dir was set", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
             
             (("trading.account"), _trading_account, "specifies trading account")
             (("trading.print_pnl"), _trading_print_pnl, "specifies if to log pnl on every update for debugging purposes", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
@@ -324,6 +328,16 @@ public:
             (("common_comm.verbose"), _common_comm_verbose, "specifies if tcp/ip connection is verbose", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
             (("common_comm.tcp_verbose"), _common_comm_tcp_verbose, "specifies if logging tcp/ip traffic", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
             (("common_comm.tcp_no_delay"), _common_comm_tcp_no_delay, "specifies if tcp/ip nagle is disabled or not", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
+            (("common_comm.reactor_mode"), _common_comm_reactor_mode, "specifies if tcp/ip connections are serviced by single epoll reactor thread instead of send/recv threads per connection", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
+            (("common_comm.reactor_max_queued_bytes"), _common_comm_reactor_max_queued_bytes, "specifies max bytes queued for sending per connection in reactor mode before connection is dropped", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(4*1024*1024))
+        
+            (("instrumentation.enabled"), _instrumentation_enabled, "specifies if to record hot path latency histograms (feed decode, quote publish, strategy callback, processors, fix send, ack)", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
+            (("instrumentation.dumpFile"), _instrumentation_dumpFile, "file name to dump latency histograms to on stop, empty - no dump", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+        
+            (("threads.affinity"), _threads_affinity, "space separated <role>=<cpus> list of threads' cpu affinities, cpus in taskset format (e.g. 'feed_handler=3 logger=0-1,6')", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("threads.scheduler"), _threads_scheduler, "space separated <role>=<policy>[:<priority>] list of threads' scheduler policies - other, batch, idle, fifo or rr (e.g. 'feed_handler=fifo:80')", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("threads.numa_local"), _threads_numa_local, "space separated list of thread roles which allocate memory from their local numa node", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("threads.busy_poll"), _threads_busy_poll, "space separated list of thread roles which spin instead of blocking when waiting for work", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
         
             (("strategy_container.channel_pf"), _strategy_container_channel_pf, "specifies if to create channel_pf objects", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(true))
             (("strategy_container.channel_or"), _strategy_container_channel_or, "specifies if to create channel_or objects", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(true))
@@ -341,6 +355,8 @@ public:
             (("channel_pf_historical.date"), _channel_pf_historical_date, "date for historical start", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
             (("channel_pf_historical.time"), _channel_pf_historical_time, "time for historical start", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
             
+            (("channel_pf_shm.name"), _channel_pf_shm_name, "name of publisher_pf's shared memory quotes ring to read prices from (e.g. '/tw_quotes'), empty value turns channel_pf_shm off", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            
             (("channel_or.dataSourceType"), _channel_or_dataSourceType, "data source type (e.g. 'file', 'db', etc.)", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>("file"))
             (("channel_or.dataSource"), _channel_or_dataSource, "data source string (e.g file name, db connection string)")
         
@@ -351,10 +367,16 @@ public:
             (("channel_or_drop_cme.dataSource"), _channel_or_drop_cme_dataSource, "data source string (e.g file name, db connection string)")
         
             (("audit_cme.outputFileName"), _audit_cme_outputFileName, "cme dir/file name to output audit files to")
+            (("audit_cme.threads"), _audit_cme_threads, "number of worker threads formatting audit records", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(4))
+            (("audit_cme.chunk_size"), _audit_cme_chunk_size, "number of fix messages read from source at a time", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(10000))
+            (("audit_cme.source_file"), _audit_cme_source_file, "file with fix messages to use instead of db", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
             
             (("spreader_perf_reporter.report_instr_blotter"), _spreader_perf_reporter_report_instr_blotter, "specifies if to report instr blotter for all strategies combined", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
         
             (("bars_manager.bars_restore_mode"), reinterpret_cast<int32_t&>(_bars_manager_bars_restore_mode), "specifies whether to restore bars from database or file", tw::config::EnumOptionNeed::eOptional, boost::optional<int32_t>(static_cast<int32_t>(eBarsRestoreMode::kUnknown)))
+            (("bars_manager.use_cache"), _bars_manager_use_cache, "specifies whether bars managers cache formed bars and patterns in column_store.dir and restore from it on start, rebuilding only bars after the cached ones", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
+            (("bars_manager.cache_checkpoint_bars"), _bars_manager_cache_checkpoint_bars, "number of bars between checkpoints of patterns in bars cache - 0 disables checkpoints (patterns are then reprocessed for all cached bars)", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(30))
+            (("bars_manager.restore_threads"), _bars_manager_restore_threads, "number of worker threads bars managers' instruments are restored on at start - 0 or 1 restores them on the calling thread", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(4))
         
             (("bars_storage.outputToDb"), _bars_storage_outputToDb, "specifies if to save bars and bars patterns to db", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
             (("bars_storage.processPatterns"), _bars_storage_processPatterns, "specifies if to process bars patterns", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(true))
@@ -383,6 +405,8 @@ public:
             (("publisher_pf.end_time"), _publisher_pf_end_time, "specifies publisher_pf replay end time for historical prices", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
             (("publisher_pf.symbol"), _publisher_pf_symbol, "specifies publisher_pf symbol for historical prices replayVerify() mode, empty value indicates all symbols", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
             (("publisher_pf.confirm_break"), _publisher_pf_confirm_break, "specifies if to confirm breakout in sim trades in replayVerify() mode", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
+            (("publisher_pf.shm_name"), _publisher_pf_shm_name, "name of shared memory quotes ring to publish prices to in realtime/replay modes (e.g. '/tw_quotes'), empty value turns it off", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("publisher_pf.shm_capacity"), _publisher_pf_shm_capacity, "number of quotes in shared memory quotes ring", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(64*1024))
         
             (("publisher_pf.range"), _publisher_pf_range, "range in ticks to analyze", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(0))
             (("publisher_pf.minVol"), _publisher_pf_minVol, "range's minVol to analyze", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(0))
@@ -393,6 +417,10 @@ public:
             (("pnl_audit.mode"), reinterpret_cast<int32_t&>(_pnl_audit_mode), "specifies whether pnl_audit produces results for account, strat or both", tw::config::EnumOptionNeed::eOptional, boost::optional<int32_t>(static_cast<int32_t>(ePnLAuditMode::kBoth)))
             (("pnl_audit.start_time"), _pnl_audit_start_time, "specifies start_time for pnl_audit records", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
             (("pnl_audit.end_time"), _pnl_audit_end_time, "specifies start_time for pnl_audit records", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("pnl_audit.threads"), _pnl_audit_threads, "number of worker threads processing accounts concurrently", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(4))
+            (("pnl_audit.chunk_size"), _pnl_audit_chunk_size, "number of records read from source at a time", tw::config::EnumOptionNeed::eOptional, boost::optional<uint32_t>(10000))
+            (("pnl_audit.source_file"), _pnl_audit_source_file, "file with PnLAuditTrailInfo records to use instead of db", tw::config::EnumOptionNeed::eOptional, boost::optional<std::string>(""))
+            (("pnl_audit.use_column_store"), _pnl_audit_use_column_store, "specifies whether PnLAuditTrailInfo records are read from column_store.dir instead of db", tw::config::EnumOptionNeed::eOptional, boost::optional<bool>(false))
             
         ;
     }
@@ -407,6 +435,10 @@ public:
     
     std::string _db_connection_str;
     std::string _db_listen_connection_str;
+    std::string _db_write_mode;
+    uint32_t _db_bulk_load_min_rows;
+    std::string _column_store_dir;
+    bool _column_store_read_fills;
     
     std::string _trading_account;
     bool _trading_print_pnl;
@@ -439,6 +471,16 @@ public:
     bool _common_comm_verbose;
     bool _common_comm_tcp_verbose;
     bool _common_comm_tcp_no_delay;
+    bool _common_comm_reactor_mode;
+    uint32_t _common_comm_reactor_max_queued_bytes;
+    
+    bool _instrumentation_enabled;
+    std::string _instrumentation_dumpFile;
+    
+    std::string _threads_affinity;
+    std::string _threads_scheduler;
+    std::string _threads_numa_local;
+    std::string _threads_busy_poll;
     
     bool _strategy_container_channel_pf;
     bool _strategy_container_channel_or;
@@ -456,6 +498,8 @@ public:
     std::string _channel_pf_historical_date;
     std::string _channel_pf_historical_time;
     
+    std::string _channel_pf_shm_name;
+    
     std::string _channel_or_dataSourceType;
     std::string _channel_or_dataSource;
     
@@ -466,10 +510,16 @@ public:
     std::string _channel_or_drop_cme_dataSource;
     
     std::string _audit_cme_outputFileName;
+    uint32_t _audit_cme_threads;
+    uint32_t _audit_cme_chunk_size;
+    std::string _audit_cme_source_file;
     
     bool _spreader_perf_reporter_report_instr_blotter;
     
     eBarsRestoreMode _bars_manager_bars_restore_mode;
+    bool _bars_manager_use_cache;
+    uint32_t _bars_manager_cache_checkpoint_bars;
+    uint32_t _bars_manager_restore_threads;
     
     bool _bars_storage_outputToDb;
     bool _bars_storage_processPatterns;
@@ -495,6 +545,8 @@ public:
     std::string _publisher_pf_end_time;
     std::string _publisher_pf_symbol;
     bool _publisher_pf_confirm_break;
+    std::string _publisher_pf_shm_name;
+    uint32_t _publisher_pf_shm_capacity;
     uint32_t _publisher_pf_range;
     uint32_t _publisher_pf_minVol;
     uint32_t _publisher_pf_stopInTicks;
@@ -504,6 +556,10 @@ public:
     ePnLAuditMode _pnl_audit_mode;
     std::string _pnl_audit_start_time;
     std::string _pnl_audit_end_time;
+    uint32_t _pnl_audit_threads;
+    uint32_t _pnl_audit_chunk_size;
+    std::string _pnl_audit_source_file;
+    bool _pnl_audit_use_column_store;
     
 };
     
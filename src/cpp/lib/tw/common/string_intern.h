@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <stdint.h>
+
+namespace tw {
+namespace common {
+
+// Maps strings to dense ids (assigned by caller, e.g. index in a vector)
+// with open addressing table, which is kept at most half full. Each slot
+// stores full 64 bit hash of the key, so strings are compared only on
+// hash match, which makes a lookup a single probe in most cases
+//
+// Not thread safe - meant to be filled at load time and read afterwards
+//
+class StringIntern {
+    struct Slot {
+        Slot() : _hash(0),
+                 _id(NULL_ID) {
+        }
+
+        uint64_t _hash;
+        uint32_t _id;
+        std::string _key;
+    };
+
+public:
+    static const uint32_t NULL_ID = 0xFFFFFFFF;
+
+public:
+    StringIntern() : _mask(0),
+                     _size(0) {
+        clear();
+    }
+
+    void clear() {
+        _slots.clear();
+        _slots.resize(16);
+        _mask = _slots.size()-1;
+        _size = 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+public:
+    // FNV-1a
+    //
+    static uint64_t hash(const char* key, size_t length) {
+        uint64_t h = 14695981039346656037ULL;
+        for ( size_t i = 0; i < length; ++i ) {
+            h ^= static_cast<uint8_t>(key[i]);
+            h *= 1099511628211ULL;
+        }
+
+        return h;
+    }
+
+public:
+    uint32_t find(const std::string& key) const {
+        return find(key.c_str(), key.size());
+    }
+
+    uint32_t find(const char* key, size_t length) const {
+        uint64_t h = hash(key, length);
+        for ( uint64_t i = h & _mask; ; i = (i+1) & _mask ) {
+            const Slot& slot = _slots[i];
+            if ( NULL_ID == slot._id )
+                return NULL_ID;
+
+            if ( slot._hash == h && slot._key.size() == length && 0 == ::memcmp(slot._key.c_str(), key, length) )
+                return slot._id;
+        }
+
+        return NULL_ID;
+    }
+
+    // Returns false if key is already interned (id isn't changed)
+    //
+    bool add(const std::string& key, uint32_t id) {
+        if ( NULL_ID == id || NULL_ID != find(key) )
+            return false;
+
+        if ( 2*(_size+1) > _slots.size() )
+            grow();
+
+        insert(hash(key.c_str(), key.size()), key, id);
+        ++_size;
+        return true;
+    }
+
+private:
+    void insert(uint64_t h, const std::string& key, uint32_t id) {
+        uint64_t i = h & _mask;
+        while ( NULL_ID != _slots[i]._id )
+            i = (i+1) & _mask;
+
+        _slots[i]._hash = h;
+        _slots[i]._id = id;
+        _slots[i]._key = key;
+    }
+
+    void grow() {
+        std::vector<Slot> slots(2*_slots.size());
+        slots.swap(_slots);
+        _mask = _slots.size()-1;
+
+        for ( size_t i = 0; i < slots.size(); ++i ) {
+            if ( NULL_ID != slots[i]._id )
+                insert(slots[i]._hash, slots[i]._key, slots[i]._id);
+        }
+    }
+
+private:
+    std::vector<Slot> _slots;
+    uint64_t _mask;
+    size_t _size;
+};
+
+} // namespace common
+} // namespace tw
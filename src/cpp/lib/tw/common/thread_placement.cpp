@@ -0,0 +1,437 @@
+#include <tw/common/thread_placement.h>
+#include <tw/log/defs.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+
+#include <sstream>
+
+#include <sys/syscall.h>
+#include <errno.h>
+#include <unistd.h>
+
+// From <numaif.h> - not to depend on libnuma for a single syscall
+//
+#ifndef MPOL_LOCAL
+#define MPOL_LOCAL 4
+#endif
+
+namespace tw {
+namespace common {
+
+static bool& currentThreadRegistered() {
+    static __thread bool registered = false;
+    return registered;
+}
+
+static const char* policyToString(int32_t policy) {
+    switch ( policy ) {
+        case SCHED_OTHER: return "other";
+        case SCHED_BATCH: return "batch";
+        case SCHED_IDLE: return "idle";
+        case SCHED_FIFO: return "fifo";
+        case SCHED_RR: return "rr";
+        default: return "unknown";
+    }
+}
+
+static std::vector<std::string> split(const std::string& value) {
+    std::vector<std::string> values;
+    std::string trimmed = boost::algorithm::trim_copy(value);
+    if ( !trimmed.empty() )
+        boost::algorithm::split(values, trimmed, boost::algorithm::is_space(), boost::algorithm::token_compress_on);
+
+    return values;
+}
+
+static bool splitPair(const std::string& value, std::string& name, std::string& rhs) {
+    std::string::size_type pos = value.find('=');
+    if ( std::string::npos == pos || 0 == pos || value.size()-1 == pos )
+        return false;
+
+    name = value.substr(0, pos);
+    rhs = value.substr(pos+1);
+    return true;
+}
+
+// ThreadPlacement::RoleSettings class
+//
+std::string ThreadPlacement::RoleSettings::toString() const {
+    std::stringstream s;
+
+    s << "cpus=";
+    if ( _cpus.empty() ) {
+        s << "any";
+    } else {
+        for ( size_t i = 0; i < _cpus.size(); ++i )
+            s << (i > 0 ? "," : "") << _cpus[i];
+    }
+
+    s << ",scheduler=";
+    if ( _isSchedulerSet )
+        s << policyToString(_policy) << ":" << _priority;
+    else
+        s << "default";
+
+    s << ",numa_local=" << (_numaLocal ? "true" : "false")
+      << ",busy_poll=" << (_busyPoll ? "true" : "false");
+
+    return s.str();
+}
+
+// ThreadPlacement class
+//
+const char* ThreadPlacement::toString(eRole role) {
+    switch ( role ) {
+        case kStrategyContainer: return "strategy_container";
+        case kFeedHandler: return "feed_handler";
+        case kQuoteStore: return "quote_store";
+        case kLogger: return "logger";
+        case kTimerServer: return "timer_server";
+        case kStorage: return "storage";
+        case kTcpServer: return "tcp_server";
+        case kTcpConnection: return "tcp_connection";
+        case kTcpReactor: return "tcp_reactor";
+        case kIdFactory: return "id_factory";
+        case kExchangeSim: return "exchange_sim";
+        case kWorker: return "worker";
+        default: return "unknown";
+    }
+}
+
+bool ThreadPlacement::fromString(const std::string& name, eRole& role) {
+    for ( int32_t i = 0; i < kRolesCount; ++i ) {
+        if ( name == toString(static_cast<eRole>(i)) ) {
+            role = static_cast<eRole>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPlacement::parseCpus(const std::string& value, std::vector<int32_t>& cpus) {
+    cpus.clear();
+
+    try {
+        std::vector<std::string> ranges;
+        boost::algorithm::split(ranges, value, boost::algorithm::is_any_of(","));
+        for ( size_t i = 0; i < ranges.size(); ++i ) {
+            std::string::size_type pos = ranges[i].find('-');
+            int32_t first = 0;
+            int32_t last = 0;
+            if ( std::string::npos == pos ) {
+                first = last = boost::lexical_cast<int32_t>(ranges[i]);
+            } else {
+                first = boost::lexical_cast<int32_t>(ranges[i].substr(0, pos));
+                last = boost::lexical_cast<int32_t>(ranges[i].substr(pos+1));
+            }
+
+            if ( first < 0 || last < first || last >= CPU_SETSIZE )
+                return false;
+
+            for ( int32_t cpu = first; cpu <= last; ++cpu )
+                cpus.push_back(cpu);
+        }
+    } catch(const std::exception&) {
+        cpus.clear();
+        return false;
+    }
+
+    return !cpus.empty();
+}
+
+bool ThreadPlacement::parsePolicy(const std::string& value, int32_t& policy, int32_t& priority) {
+    std::string name = value;
+    priority = 0;
+
+    std::string::size_type pos = value.find(':');
+    if ( std::string::npos != pos ) {
+        name = value.substr(0, pos);
+        try {
+            priority = boost::lexical_cast<int32_t>(value.substr(pos+1));
+        } catch(const std::exception&) {
+            return false;
+        }
+    }
+
+    if ( name == "other" )
+        policy = SCHED_OTHER;
+    else if ( name == "batch" )
+        policy = SCHED_BATCH;
+    else if ( name == "idle" )
+        policy = SCHED_IDLE;
+    else if ( name == "fifo" )
+        policy = SCHED_FIFO;
+    else if ( name == "rr" )
+        policy = SCHED_RR;
+    else
+        return false;
+
+    if ( priority < sched_get_priority_min(policy) || priority > sched_get_priority_max(policy) )
+        return false;
+
+    return true;
+}
+
+bool ThreadPlacement::parse(const tw::common::Settings& settings, std::vector<RoleSettings>& roles) {
+    roles.clear();
+    roles.resize(kRolesCount);
+
+    std::vector<std::string> values;
+    std::string name;
+    std::string rhs;
+    eRole role;
+
+    values = split(settings._threads_affinity);
+    for ( size_t i = 0; i < values.size(); ++i ) {
+        if ( !splitPair(values[i], name, rhs) || !fromString(name, role) || !parseCpus(rhs, roles[role]._cpus) ) {
+            LOGGER_ERRO << "Invalid threads.affinity entry: " << values[i] << "\n";
+            return false;
+        }
+    }
+
+    values = split(settings._threads_scheduler);
+    for ( size_t i = 0; i < values.size(); ++i ) {
+        if ( !splitPair(values[i], name, rhs) || !fromString(name, role) || !parsePolicy(rhs, roles[role]._policy, roles[role]._priority) ) {
+            LOGGER_ERRO << "Invalid threads.scheduler entry: " << values[i] << "\n";
+            return false;
+        }
+
+        roles[role]._isSchedulerSet = true;
+    }
+
+    values = split(settings._threads_numa_local);
+    for ( size_t i = 0; i < values.size(); ++i ) {
+        if ( !fromString(values[i], role) ) {
+            LOGGER_ERRO << "Invalid threads.numa_local role: " << values[i] << "\n";
+            return false;
+        }
+
+        roles[role]._numaLocal = true;
+    }
+
+    values = split(settings._threads_busy_poll);
+    for ( size_t i = 0; i < values.size(); ++i ) {
+        if ( !fromString(values[i], role) ) {
+            LOGGER_ERRO << "Invalid threads.busy_poll role: " << values[i] << "\n";
+            return false;
+        }
+
+        roles[role]._busyPoll = true;
+    }
+
+    return true;
+}
+
+// ThreadPlacement::Registration class
+//
+ThreadPlacement::Registration::Registration(ThreadPlacement& owner, eRole role) : _owner(owner),
+                                                                                  _iter(owner.add(role)) {
+}
+
+ThreadPlacement::Registration::~Registration() {
+    _owner.remove(_iter);
+    currentThreadRegistered() = false;
+}
+
+// ThreadPlacement class
+//
+ThreadPlacement::ThreadPlacement() : _isInitialized(false),
+                                     _roles(kRolesCount) {
+    // Registrations of threads not created by the framework are destroyed
+    // by key's destructor when those threads exit
+    //
+    pthread_key_create(&_key, &ThreadPlacement::onThreadExit);
+}
+
+bool ThreadPlacement::init(const tw::common::Settings& settings) {
+    std::vector<RoleSettings> roles;
+    if ( !parse(settings, roles) )
+        return false;
+
+    {
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        _roles = roles;
+        _isInitialized = true;
+
+        // Threads created before init() - only affinity/scheduler can be
+        // changed from outside of the thread
+        //
+        TThreads::iterator iter = _threads.begin();
+        TThreads::iterator end = _threads.end();
+        for ( ; iter != end; ++iter )
+            applyRemote(*iter, _roles[iter->_role]);
+    }
+
+    for ( int32_t i = 0; i < kRolesCount; ++i ) {
+        if ( roles[i].isSet() )
+            LOGGER_INFO << "Configured thread placement for " << toString(static_cast<eRole>(i)) << ": " << roles[i].toString() << "\n";
+    }
+
+    LOGGER_INFO << "Threads placement:" << "\n" << toString() << "\n";
+
+    return true;
+}
+
+tw::common_thread::ThreadPtr ThreadPlacement::createThread(eRole role, const boost::function<void()>& threadMain) {
+    return tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&ThreadPlacement::threadMain, this, role, threadMain)));
+}
+
+void ThreadPlacement::registerCurrentThread(eRole role) {
+    if ( currentThreadRegistered() )
+        return;
+
+    pthread_setspecific(_key, new Registration(*this, role));
+}
+
+void ThreadPlacement::unregisterCurrentThread() {
+    Registration* registration = static_cast<Registration*>(pthread_getspecific(_key));
+    if ( NULL == registration )
+        return;
+
+    pthread_setspecific(_key, NULL);
+    delete registration;
+}
+
+void ThreadPlacement::onThreadExit(void* registration) {
+    delete static_cast<Registration*>(registration);
+}
+
+void ThreadPlacement::threadMain(eRole role, boost::function<void()> threadMain) {
+    Registration registration(*this, role);
+    threadMain();
+}
+
+ThreadPlacement::TThreads::iterator ThreadPlacement::add(eRole role) {
+    ThreadInfo info;
+    info._role = role;
+    info._handle = pthread_self();
+    info._tid = static_cast<int32_t>(syscall(SYS_gettid));
+
+    currentThreadRegistered() = true;
+
+    TThreads::iterator iter;
+    RoleSettings settings;
+    bool isInitialized = false;
+    {
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        iter = _threads.insert(_threads.end(), info);
+        isInitialized = _isInitialized;
+        settings = _roles[role];
+    }
+
+    if ( isInitialized && settings.isSet() ) {
+        applyRemote(info, settings);
+        applyCurrent(settings);
+
+        // Logger's own thread can't log its placement
+        //
+        if ( kLogger != role )
+            LOGGER_INFO << "Placed thread: " << toString(info) << "\n";
+    }
+
+    return iter;
+}
+
+void ThreadPlacement::remove(TThreads::iterator iter) {
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+    _threads.erase(iter);
+}
+
+bool ThreadPlacement::applyRemote(const ThreadInfo& info, const RoleSettings& settings) {
+    bool status = true;
+
+    if ( !settings._cpus.empty() ) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for ( size_t i = 0; i < settings._cpus.size(); ++i )
+            CPU_SET(settings._cpus[i], &cpuset);
+
+        int32_t rc = pthread_setaffinity_np(info._handle, sizeof(cpuset), &cpuset);
+        if ( 0 != rc ) {
+            LOGGER_ERRO << "Failed to set affinity of " << toString(info._role) << " thread: " << info._tid << " -- rc=" << rc << "\n";
+            status = false;
+        }
+    }
+
+    if ( settings._isSchedulerSet ) {
+        sched_param param;
+        param.sched_priority = settings._priority;
+
+        int32_t rc = pthread_setschedparam(info._handle, settings._policy, &param);
+        if ( 0 != rc ) {
+            LOGGER_ERRO << "Failed to set scheduler of " << toString(info._role) << " thread: " << info._tid << " -- rc=" << rc << "\n";
+            status = false;
+        }
+    }
+
+    return status;
+}
+
+bool ThreadPlacement::applyCurrent(const RoleSettings& settings) {
+    bool status = true;
+
+    if ( settings._numaLocal ) {
+        if ( 0 != syscall(SYS_set_mempolicy, MPOL_LOCAL, NULL, 0) ) {
+            LOGGER_ERRO << "Failed to set local numa memory policy, errno=" << errno << "\n";
+            status = false;
+        }
+    }
+
+    tw::common_thread::currentThreadBusyPoll() = settings._busyPoll;
+
+    return status;
+}
+
+std::string ThreadPlacement::toString(const ThreadInfo& info) {
+    std::stringstream s;
+
+    s << "role=" << toString(info._role) << ",tid=" << info._tid;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    s << ",cpus=";
+    if ( 0 == pthread_getaffinity_np(info._handle, sizeof(cpuset), &cpuset) ) {
+        bool first = true;
+        for ( int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+            if ( CPU_ISSET(cpu, &cpuset) ) {
+                s << (first ? "" : ",") << cpu;
+                first = false;
+            }
+        }
+    } else {
+        s << "unknown";
+    }
+
+    int32_t policy = 0;
+    sched_param param;
+    s << ",scheduler=";
+    if ( 0 == pthread_getschedparam(info._handle, &policy, &param) )
+        s << policyToString(policy) << ":" << param.sched_priority;
+    else
+        s << "unknown";
+
+    return s.str();
+}
+
+std::string ThreadPlacement::toString() {
+    std::stringstream s;
+
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+    TThreads::iterator iter = _threads.begin();
+    TThreads::iterator end = _threads.end();
+    for ( ; iter != end; ++iter ) {
+        const RoleSettings& settings = _roles[iter->_role];
+        s << toString(*iter)
+          << ",numa_local=" << (settings._numaLocal ? "true" : "false")
+          << ",busy_poll=" << (settings._busyPoll ? "true" : "false")
+          << "\n";
+    }
+
+    return s.str();
+}
+
+} // namespace common
+} // namespace tw
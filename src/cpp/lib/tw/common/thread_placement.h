@@ -0,0 +1,176 @@
+#pragma once
+
+#include <tw/common/defs.h>
+#include <tw/common/settings.h>
+#include <tw/common/singleton.h>
+#include <tw/common_thread/locks.h>
+#include <tw/common_thread/thread.h>
+
+#include <boost/function.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace tw {
+namespace common {
+
+// Registry of framework's threads by role and of their placement configured
+// in settings file ('threads.*'):
+//      affinity        - cpus thread is pinned to
+//      scheduler       - scheduling policy/priority
+//      numa_local      - memory is allocated from thread's local numa node
+//      busy_poll       - thread spins instead of blocking in ThreadPipe::read()
+//
+// Roles (names as used in settings):
+//      strategy_container  - container's shutdown thread, which cancels open
+//                            orders on stop(); strategies' callbacks run on
+//                            the threads delivering events to them (e.g.
+//                            feed_handler, timer_server, tcp_connection)
+//      feed_handler        - market data feeds' threads
+//      quote_store         - quote store's dispatch thread
+//      logger              - logger's writer thread
+//      timer_server        - timers' thread
+//      storage             - db/file persistence
+//      tcp_server          - msg bus server's accept/cleanup threads
+//      tcp_connection      - msg bus connections' send/recv threads
+//      tcp_reactor         - shared reactor of msg bus connections
+//      id_factory          - order id/uuid pre-generation threads
+//      exchange_sim        - exchange simulator's matcher thread
+//      worker              - cpu bound worker pools (e.g. startup restore
+//                            of bars, offline tools' processing)
+//
+// Threads are created with createThread(), which registers and places new
+// thread before running its main and removes it from registry once main
+// returns or throws. Threads created before init() (e.g.
+// logger's) get their affinity/scheduler applied in init(), numa/busy poll
+// settings can only be applied by the thread itself and take effect for
+// threads created after init()
+//
+class ThreadPlacement : public Singleton<ThreadPlacement> {
+public:
+    enum eRole {
+        kStrategyContainer = 0,
+        kFeedHandler = 1,
+        kQuoteStore = 2,
+        kLogger = 3,
+        kTimerServer = 4,
+        kStorage = 5,
+        kTcpServer = 6,
+        kTcpConnection = 7,
+        kTcpReactor = 8,
+        kIdFactory = 9,
+        kExchangeSim = 10,
+        kWorker = 11,
+        kRolesCount
+    };
+
+    static const char* toString(eRole role);
+    static bool fromString(const std::string& name, eRole& role);
+
+    struct RoleSettings {
+        RoleSettings() {
+            clear();
+        }
+
+        void clear() {
+            _cpus.clear();
+            _policy = SCHED_OTHER;
+            _priority = 0;
+            _isSchedulerSet = false;
+            _numaLocal = false;
+            _busyPoll = false;
+        }
+
+        bool isSet() const {
+            return (!_cpus.empty() || _isSchedulerSet || _numaLocal || _busyPoll);
+        }
+
+        std::string toString() const;
+
+        std::vector<int32_t> _cpus;
+        int32_t _policy;
+        int32_t _priority;
+        bool _isSchedulerSet;
+        bool _numaLocal;
+        bool _busyPoll;
+    };
+
+public:
+    ThreadPlacement();
+
+    bool init(const tw::common::Settings& settings);
+
+    // Parses 'threads.*' settings into per role settings
+    //
+    static bool parse(const tw::common::Settings& settings, std::vector<RoleSettings>& roles);
+    static bool parseCpus(const std::string& value, std::vector<int32_t>& cpus);
+    static bool parsePolicy(const std::string& value, int32_t& policy, int32_t& priority);
+
+public:
+    const RoleSettings& getRoleSettings(eRole role) const {
+        return _roles[role];
+    }
+
+    // Creates thread running 'threadMain' placed according to its role
+    //
+    tw::common_thread::ThreadPtr createThread(eRole role, const boost::function<void()>& threadMain);
+
+    // Registers and places current thread, if not done already - for
+    // threads not created by the framework (e.g. feed handler's callbacks).
+    // Thread is removed from registry when it exits or is unregistered
+    //
+    void registerCurrentThread(eRole role);
+    void unregisterCurrentThread();
+
+    // Startup report of registered threads' actual placement
+    //
+    std::string toString();
+
+private:
+    struct ThreadInfo {
+        eRole _role;
+        pthread_t _handle;
+        int32_t _tid;
+    };
+
+    typedef std::list<ThreadInfo> TThreads;
+    typedef tw::common_thread::Lock TLock;
+
+    // Registration of current thread - removes it from registry on
+    // destruction
+    //
+    class Registration {
+    public:
+        Registration(ThreadPlacement& owner, eRole role);
+        ~Registration();
+
+    private:
+        ThreadPlacement& _owner;
+        TThreads::iterator _iter;
+    };
+
+    static void onThreadExit(void* registration);
+
+    void threadMain(eRole role, boost::function<void()> threadMain);
+    TThreads::iterator add(eRole role);
+    void remove(TThreads::iterator iter);
+
+    bool applyRemote(const ThreadInfo& info, const RoleSettings& settings);
+    bool applyCurrent(const RoleSettings& settings);
+
+    static std::string toString(const ThreadInfo& info);
+
+private:
+    TLock _lock;
+    pthread_key_t _key;
+    bool _isInitialized;
+    std::vector<RoleSettings> _roles;
+    TThreads _threads;
+};
+
+} // namespace common
+} // namespace tw
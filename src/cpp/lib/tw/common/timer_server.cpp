@@ -1,5 +1,6 @@
 #include <tw/common/timer_server.h>
 #include <tw/common_strat/consumer_proxy.h>
+#include <tw/common/thread_placement.h>
 
 #include "../common_thread/utils.h"
 
@@ -77,7 +78,7 @@ bool TimerServer::start() {
             LOGGER_ERRO << "TimerServer already started" << "\n";
         }                        
         
-        _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TimerServer::ThreadMain, this)));
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTimerServer, boost::bind(&TimerServer::ThreadMain, this));
         
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+namespace tw {
+namespace common {
+
+// Clock based on cpu's time stamp counter (TSC) - reading it takes a few
+// nanos vs. tens of nanos for clock_gettime() (more on virtualized hosts)
+//
+// Two clocks are provided:
+//      monotonicNanos()    - nanos since process start at TSC rate measured
+//                            on start, never goes back - for measuring
+//                            intervals
+//      nowNanos()          - nanos since epoch (UTC), extrapolated from the
+//                            last sync with realtime clock with calibrated
+//                            TSC rate. Periodically (with interval growing
+//                            from 10ms to 1sec after start) first caller
+//                            syncs it with clock_gettime() again and refines
+//                            the rate, so it follows ntp adjustments and
+//                            stays within microseconds of realtime clock
+//
+// If TSC isn't invariant (i.e. its rate depends on cpu's frequency/state)
+// both clocks fall back to clock_gettime()
+//
+// NOTE: relies on x86's ordering of stores/loads - only compiler
+// barriers are used
+//
+class TscClock {
+    static const int64_t NANOS_IN_SEC = 1000000000LL;
+    static const int64_t CALIBRATION_NANOS = 10*1000*1000LL;
+    static const int64_t SYNC_INTERVAL_NANOS = NANOS_IN_SEC;
+    static const uint32_t SHIFT = 32;
+
+    struct State {
+        bool _isEnabled;
+        uint64_t _startTsc;
+        uint64_t _startMult;
+        int64_t _syncIntervalNanos;
+        uint64_t _syncIntervalTicks;
+
+        // Realtime anchor, guarded by _seq (odd while being updated)
+        //
+        volatile uint64_t _seq;
+        volatile uint64_t _mult;
+        volatile uint64_t _baseTsc;
+        volatile int64_t _baseNanos;
+    };
+
+public:
+    static bool isEnabled() {
+        return state()._isEnabled;
+    }
+
+    static uint64_t ticks() {
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+
+    static int64_t monotonicNanos() {
+        const State& s = state();
+        if ( !s._isEnabled )
+            return clockNanos(CLOCK_MONOTONIC);
+
+        return scale(ticks()-s._startTsc, s._startMult);
+    }
+
+    static int64_t nowNanos() {
+        State& s = state();
+        uint64_t seq = s._seq;
+        barrier();
+
+        if ( !s._isEnabled || (seq & 1) )
+            return clockNanos(CLOCK_REALTIME);
+
+        uint64_t tsc = ticks();
+        uint64_t baseTsc = s._baseTsc;
+        int64_t baseNanos = s._baseNanos;
+        uint64_t mult = s._mult;
+        barrier();
+
+        if ( seq != s._seq )
+            return clockNanos(CLOCK_REALTIME);
+
+        uint64_t delta = tsc-baseTsc;
+        if ( tsc < baseTsc || delta > s._syncIntervalTicks )
+            return sync(s, seq);
+
+        return baseNanos+scale(delta, mult);
+    }
+
+    static int64_t clockNanos(clockid_t clock) {
+        struct timespec ts;
+        ::clock_gettime(clock, &ts);
+        return static_cast<int64_t>(ts.tv_sec)*NANOS_IN_SEC + ts.tv_nsec;
+    }
+
+private:
+    static State& state() {
+        static State s = init();
+        return s;
+    }
+
+    static State init() {
+        State s;
+        s._isEnabled = isInvariant();
+        s._seq = 0;
+        s._mult = 0;
+        s._startMult = 0;
+        s._startTsc = ticks();
+        s._baseTsc = s._startTsc;
+        s._baseNanos = clockNanos(CLOCK_REALTIME);
+        s._syncIntervalNanos = CALIBRATION_NANOS;
+        s._syncIntervalTicks = 0;
+
+        if ( !s._isEnabled )
+            return s;
+
+        // Busy wait for calibration interval to measure TSC's rate
+        //
+        int64_t nanos = 0;
+        uint64_t tsc = 0;
+        do {
+            tsc = ticks();
+            nanos = clockNanos(CLOCK_REALTIME);
+        } while ( nanos-s._baseNanos < CALIBRATION_NANOS && nanos >= s._baseNanos );
+
+        if ( tsc <= s._baseTsc || nanos <= s._baseNanos ) {
+            s._isEnabled = false;
+            return s;
+        }
+
+        s._mult = (static_cast<uint64_t>(nanos-s._baseNanos) << SHIFT) / (tsc-s._baseTsc);
+        s._startMult = s._mult;
+        s._baseTsc = tsc;
+        s._baseNanos = nanos;
+        s._syncIntervalTicks = (static_cast<uint64_t>(s._syncIntervalNanos) << SHIFT) / s._mult;
+        return s;
+    }
+
+    // Re-anchors realtime extrapolation and refines TSC rate over the
+    // interval since the last sync. Only one thread syncs - others read
+    // realtime clock in the meantime
+    //
+    static int64_t sync(State& s, uint64_t seq) {
+        if ( !__sync_bool_compare_and_swap(&s._seq, seq, seq+1) )
+            return clockNanos(CLOCK_REALTIME);
+
+        barrier();
+        uint64_t tsc = ticks();
+        int64_t nanos = clockNanos(CLOCK_REALTIME);
+
+        uint64_t deltaTsc = tsc-s._baseTsc;
+        int64_t deltaNanos = nanos-s._baseNanos;
+        if ( tsc > s._baseTsc && deltaNanos > 0 && deltaNanos < 4*SYNC_INTERVAL_NANOS ) {
+            s._mult = (static_cast<uint64_t>(deltaNanos) << SHIFT) / deltaTsc;
+            if ( s._syncIntervalNanos < SYNC_INTERVAL_NANOS )
+                s._syncIntervalNanos = (2*s._syncIntervalNanos < SYNC_INTERVAL_NANOS) ? 2*s._syncIntervalNanos : SYNC_INTERVAL_NANOS;
+
+            s._syncIntervalTicks = (static_cast<uint64_t>(s._syncIntervalNanos) << SHIFT) / s._mult;
+        }
+
+        s._baseTsc = tsc;
+        s._baseNanos = nanos;
+        barrier();
+        s._seq = seq+2;
+
+        return nanos;
+    }
+
+    // Invariant TSC - cpuid leaf 0x80000007, edx bit 8
+    //
+    static bool isInvariant() {
+        uint32_t eax = 0x80000000;
+        uint32_t ebx = 0;
+        uint32_t ecx = 0;
+        uint32_t edx = 0;
+        cpuid(eax, ebx, ecx, edx);
+        if ( eax < 0x80000007 )
+            return false;
+
+        eax = 0x80000007;
+        cpuid(eax, ebx, ecx, edx);
+        return (0 != (edx & (1 << 8)));
+    }
+
+    static void cpuid(uint32_t& eax, uint32_t& ebx, uint32_t& ecx, uint32_t& edx) {
+        __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+    }
+
+    // (ticks*mult) >> SHIFT without 128 bit arithmetic
+    //
+    static int64_t scale(uint64_t ticks, uint64_t mult) {
+        return static_cast<int64_t>((ticks >> SHIFT)*mult + (((ticks & 0xFFFFFFFFULL)*mult) >> SHIFT));
+    }
+
+    static void barrier() {
+        __asm__ __volatile__("" ::: "memory");
+    }
+};
+
+} // namespace common
+} // namespace tw
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <tw/common/defs.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+namespace tw {
+namespace common_comm {
+
+static const char* BINARY_FRAMING_REQUEST = "BINARY";
+static const char* BINARY_FRAMING_ACK = "BINARY_ACK";
+static const char* BINARY_FRAMING_NACK = "BINARY_NACK";
+
+// Length-prefixed binary framing, which can be negotiated per connection
+// instead of default '\n' (new line) terminated text messages
+//
+// Negotiation: client sends BINARY_FRAMING_REQUEST line, server replies with
+// BINARY_FRAMING_ACK line (after which both directions are binary framed) or
+// with BINARY_FRAMING_NACK line (connection stays text)
+//
+// Frame layout (all integers are little-endian):
+//
+//      uint32_t    length of payload (0 - heartbeat, no payload)
+//      uint8_t     payload's kind (see eKind)
+//      char[]      payload's body
+//
+// Command's body has numeric type/subType and count of params, followed by
+// params as length-prefixed name/value strings - params aren't typed, so
+// their values are the same strings as in text messages
+//
+struct BinaryFrame {
+    enum eKind {
+        kText = 1,          // body is text message w/o '\n'
+        kCommand = 2        // body is command (see tw::common::Command::toBinary())
+    };
+
+    static const size_t HEADER_SIZE = sizeof(uint32_t);
+    static const size_t KIND_SIZE = sizeof(uint8_t);
+    static const uint32_t MAX_PAYLOAD_SIZE = 1024*1024;
+
+public:
+    static uint32_t readLength(const char* data) {
+        uint32_t length = 0;
+        ::memcpy(&length, data, sizeof(length));
+        return length;
+    }
+
+    // Appends frame's header and kind to 'frame', returns offset of the header
+    // to be passed to finish() once body is appended
+    //
+    static size_t begin(std::string& frame, eKind kind) {
+        size_t offset = frame.size();
+        frame.append(HEADER_SIZE, '\0');
+        frame.push_back(static_cast<char>(kind));
+        return offset;
+    }
+
+    static void finish(std::string& frame, size_t offset) {
+        uint32_t length = static_cast<uint32_t>(frame.size() - offset - HEADER_SIZE);
+        ::memcpy(&frame[offset], &length, sizeof(length));
+    }
+
+    // Wraps text message (w/ or w/o trailing '\n') into a frame
+    //
+    static void encodeText(const std::string& message, std::string& frame) {
+        size_t length = message.size();
+        while ( length > 0 && ('\n' == message[length-1] || '\r' == message[length-1]) )
+            --length;
+
+        size_t offset = begin(frame, kText);
+        frame.append(message, 0, length);
+        finish(frame, offset);
+    }
+
+public:
+    // Helpers for encoding/decoding of frame's body
+    //
+    template <typename TValue>
+    static void append(std::string& frame, TValue value) {
+        frame.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename TValue>
+    static bool read(const char*& data, const char* end, TValue& value) {
+        if ( static_cast<size_t>(end - data) < sizeof(value) )
+            return false;
+
+        ::memcpy(&value, data, sizeof(value));
+        data += sizeof(value);
+        return true;
+    }
+
+    static bool read(const char*& data, const char* end, size_t length, std::string& value) {
+        if ( static_cast<size_t>(end - data) < length )
+            return false;
+
+        value.assign(data, length);
+        data += length;
+        return true;
+    }
+
+public:
+    static const std::string& heartbeat() {
+        static const std::string HEARTBEAT(HEADER_SIZE, '\0');
+        return HEARTBEAT;
+    }
+};
+
+} // namespace common_comm
+} // namespace tw
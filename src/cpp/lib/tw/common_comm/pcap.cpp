@@ -0,0 +1,375 @@
+#include <tw/common_comm/pcap.h>
+#include <tw/log/defs.h>
+
+#include <arpa/inet.h>
+#include <string.h>
+
+namespace tw {
+namespace common_comm {
+
+static const uint32_t PCAP_MAGIC_MICROS = 0xa1b2c3d4;
+static const uint32_t PCAP_MAGIC_NANOS = 0xa1b23c4d;
+
+static const uint32_t LINKTYPE_ETHERNET = 1;
+static const uint32_t LINKTYPE_LINUX_SLL = 113;
+
+static const size_t GLOBAL_HEADER_SIZE = 24;
+static const size_t RECORD_HEADER_SIZE = 16;
+static const size_t ETHERNET_HEADER_SIZE = 14;
+static const size_t VLAN_TAG_SIZE = 4;
+static const size_t SLL_HEADER_SIZE = 16;
+static const size_t IP_HEADER_SIZE = 20;
+static const size_t UDP_HEADER_SIZE = 8;
+
+static const uint16_t ETHERTYPE_IP = 0x0800;
+static const uint16_t ETHERTYPE_VLAN = 0x8100;
+static const uint8_t IPPROTO_UDP_NUM = 17;
+
+static const uint32_t MAX_RECORD_SIZE = 256*1024;
+
+static uint16_t readNet16(const char* data) {
+    uint16_t value;
+    ::memcpy(&value, data, sizeof(value));
+    return ntohs(value);
+}
+
+static uint32_t readNet32(const char* data) {
+    uint32_t value;
+    ::memcpy(&value, data, sizeof(value));
+    return ntohl(value);
+}
+
+static void writeNet16(char* data, uint16_t value) {
+    value = htons(value);
+    ::memcpy(data, &value, sizeof(value));
+}
+
+static void writeNet32(char* data, uint32_t value) {
+    value = htonl(value);
+    ::memcpy(data, &value, sizeof(value));
+}
+
+// PcapReader
+//
+PcapReader::PcapReader() : _file(NULL) {
+    clear();
+}
+
+PcapReader::~PcapReader() {
+    close();
+}
+
+void PcapReader::clear() {
+    _swapped = false;
+    _nanos = false;
+    _linkType = 0;
+    _error = false;
+    _recordsCount = 0;
+    _skippedCount = 0;
+}
+
+bool PcapReader::open(const std::string& fileName) {
+    close();
+
+    _file = ::fopen(fileName.c_str(), "rb");
+    if ( !_file ) {
+        LOGGER_ERRO << "Can't open pcap file: " << fileName << "\n";
+        return false;
+    }
+
+    char header[GLOBAL_HEADER_SIZE];
+    if ( GLOBAL_HEADER_SIZE != ::fread(header, 1, GLOBAL_HEADER_SIZE, _file) ) {
+        LOGGER_ERRO << "Can't read pcap header: " << fileName << "\n";
+        close();
+        return false;
+    }
+
+    uint32_t magic;
+    ::memcpy(&magic, header, sizeof(magic));
+    switch ( magic ) {
+        case PCAP_MAGIC_MICROS:
+            break;
+        case PCAP_MAGIC_NANOS:
+            _nanos = true;
+            break;
+        default:
+            magic = __builtin_bswap32(magic);
+            if ( PCAP_MAGIC_MICROS == magic ) {
+                _swapped = true;
+            } else if ( PCAP_MAGIC_NANOS == magic ) {
+                _swapped = true;
+                _nanos = true;
+            } else {
+                LOGGER_ERRO << "Not a pcap file: " << fileName << "\n";
+                close();
+                return false;
+            }
+            break;
+    }
+
+    uint32_t linkType;
+    ::memcpy(&linkType, header+20, sizeof(linkType));
+    _linkType = swap(linkType);
+    if ( LINKTYPE_ETHERNET != _linkType && LINKTYPE_LINUX_SLL != _linkType ) {
+        LOGGER_ERRO << "Unsupported pcap link type: " << _linkType << " in: " << fileName << "\n";
+        close();
+        return false;
+    }
+
+    _buffer.resize(MAX_RECORD_SIZE);
+
+    return true;
+}
+
+void PcapReader::close() {
+    if ( _file ) {
+        ::fclose(_file);
+        _file = NULL;
+    }
+
+    clear();
+}
+
+bool PcapReader::next(PcapPacket& packet) {
+    if ( !_file || _error )
+        return false;
+
+    char header[RECORD_HEADER_SIZE];
+    while ( true ) {
+        size_t count = ::fread(header, 1, RECORD_HEADER_SIZE, _file);
+        if ( RECORD_HEADER_SIZE != count ) {
+            if ( 0 != count ) {
+                LOGGER_ERRO << "Truncated pcap record header" << "\n";
+                _error = true;
+            }
+
+            return false;
+        }
+
+        uint32_t values[4];
+        ::memcpy(values, header, sizeof(values));
+
+        uint32_t length = swap(values[2]);
+        if ( length > MAX_RECORD_SIZE ) {
+            LOGGER_ERRO << "Invalid pcap record length: " << length << "\n";
+            _error = true;
+            return false;
+        }
+
+        if ( length != ::fread(&_buffer[0], 1, length, _file) ) {
+            LOGGER_ERRO << "Truncated pcap record: " << length << "\n";
+            _error = true;
+            return false;
+        }
+
+        ++_recordsCount;
+
+        packet.clear();
+        if ( !parseFrame(&_buffer[0], length, packet) ) {
+            ++_skippedCount;
+            continue;
+        }
+
+        uint64_t fraction = swap(values[1]);
+        packet._timestamp = static_cast<uint64_t>(swap(values[0])) * 1000000000ULL + (_nanos ? fraction : fraction * 1000ULL);
+        return true;
+    }
+
+    return false;
+}
+
+bool PcapReader::parseFrame(const char* data, size_t size, PcapPacket& packet) const {
+    size_t offset = 0;
+    uint16_t etherType = 0;
+
+    if ( LINKTYPE_ETHERNET == _linkType ) {
+        if ( size < ETHERNET_HEADER_SIZE )
+            return false;
+
+        etherType = readNet16(data+12);
+        offset = ETHERNET_HEADER_SIZE;
+        while ( ETHERTYPE_VLAN == etherType ) {
+            if ( size < offset + VLAN_TAG_SIZE )
+                return false;
+
+            etherType = readNet16(data+offset+2);
+            offset += VLAN_TAG_SIZE;
+        }
+    } else {
+        if ( size < SLL_HEADER_SIZE )
+            return false;
+
+        etherType = readNet16(data+14);
+        offset = SLL_HEADER_SIZE;
+    }
+
+    if ( ETHERTYPE_IP != etherType )
+        return false;
+
+    // IPv4
+    //
+    if ( size < offset + IP_HEADER_SIZE )
+        return false;
+
+    const char* ip = data+offset;
+    if ( 4 != ((ip[0] >> 4) & 0x0F) )
+        return false;
+
+    size_t ipHeaderSize = (ip[0] & 0x0F) * 4;
+    if ( ipHeaderSize < IP_HEADER_SIZE || size < offset + ipHeaderSize + UDP_HEADER_SIZE )
+        return false;
+
+    if ( IPPROTO_UDP_NUM != static_cast<uint8_t>(ip[9]) )
+        return false;
+
+    // NOTE: fragmented datagrams are not reassembled - market data
+    // feeds don't fragment
+    //
+    if ( 0 != (readNet16(ip+6) & 0x3FFF) )
+        return false;
+
+    packet._srcIp = readNet32(ip+12);
+    packet._dstIp = readNet32(ip+16);
+
+    // UDP
+    //
+    const char* udp = ip+ipHeaderSize;
+    packet._srcPort = readNet16(udp);
+    packet._dstPort = readNet16(udp+2);
+
+    size_t udpLength = readNet16(udp+4);
+    if ( udpLength < UDP_HEADER_SIZE )
+        return false;
+
+    packet._data = udp+UDP_HEADER_SIZE;
+    packet._size = udpLength - UDP_HEADER_SIZE;
+    if ( packet._data + packet._size > data + size )
+        return false;
+
+    return true;
+}
+
+uint32_t PcapReader::parseIp(const std::string& ip) {
+    struct in_addr addr;
+    if ( 0 == ::inet_aton(ip.c_str(), &addr) )
+        return 0;
+
+    return ntohl(addr.s_addr);
+}
+
+std::string PcapReader::ipToString(uint32_t ip) {
+    struct in_addr addr;
+    addr.s_addr = htonl(ip);
+    return ::inet_ntoa(addr);
+}
+
+// PcapWriter
+//
+PcapWriter::PcapWriter() : _file(NULL) {
+}
+
+PcapWriter::~PcapWriter() {
+    close();
+}
+
+bool PcapWriter::open(const std::string& fileName) {
+    close();
+
+    _file = ::fopen(fileName.c_str(), "wb");
+    if ( !_file ) {
+        LOGGER_ERRO << "Can't create pcap file: " << fileName << "\n";
+        return false;
+    }
+
+    char header[GLOBAL_HEADER_SIZE];
+    uint32_t magic = PCAP_MAGIC_NANOS;
+    uint16_t versionMajor = 2;
+    uint16_t versionMinor = 4;
+    uint32_t zero = 0;
+    uint32_t snapLength = MAX_RECORD_SIZE;
+    uint32_t linkType = LINKTYPE_ETHERNET;
+
+    ::memcpy(header, &magic, 4);
+    ::memcpy(header+4, &versionMajor, 2);
+    ::memcpy(header+6, &versionMinor, 2);
+    ::memcpy(header+8, &zero, 4);
+    ::memcpy(header+12, &zero, 4);
+    ::memcpy(header+16, &snapLength, 4);
+    ::memcpy(header+20, &linkType, 4);
+
+    if ( GLOBAL_HEADER_SIZE != ::fwrite(header, 1, GLOBAL_HEADER_SIZE, _file) ) {
+        LOGGER_ERRO << "Can't write pcap header: " << fileName << "\n";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void PcapWriter::close() {
+    if ( _file ) {
+        ::fclose(_file);
+        _file = NULL;
+    }
+}
+
+bool PcapWriter::writeUdp(uint64_t timestamp,
+                          uint32_t srcIp,
+                          uint16_t srcPort,
+                          uint32_t dstIp,
+                          uint16_t dstPort,
+                          const char* payload,
+                          size_t size) {
+    if ( !_file )
+        return false;
+
+    size_t length = ETHERNET_HEADER_SIZE + IP_HEADER_SIZE + UDP_HEADER_SIZE + size;
+    if ( length > MAX_RECORD_SIZE )
+        return false;
+
+    _buffer.assign(RECORD_HEADER_SIZE + length, '\0');
+    char* record = &_buffer[0];
+
+    uint32_t values[4];
+    values[0] = static_cast<uint32_t>(timestamp / 1000000000ULL);
+    values[1] = static_cast<uint32_t>(timestamp % 1000000000ULL);
+    values[2] = static_cast<uint32_t>(length);
+    values[3] = static_cast<uint32_t>(length);
+    ::memcpy(record, values, sizeof(values));
+
+    // Ethernet - multicast destination mac
+    //
+    char* frame = record + RECORD_HEADER_SIZE;
+    frame[0] = 0x01;
+    frame[1] = 0x00;
+    frame[2] = 0x5e;
+    frame[3] = static_cast<char>((dstIp >> 16) & 0x7F);
+    frame[4] = static_cast<char>((dstIp >> 8) & 0xFF);
+    frame[5] = static_cast<char>(dstIp & 0xFF);
+    writeNet16(frame+12, ETHERTYPE_IP);
+
+    // IPv4
+    //
+    char* ip = frame + ETHERNET_HEADER_SIZE;
+    ip[0] = 0x45;
+    writeNet16(ip+2, static_cast<uint16_t>(IP_HEADER_SIZE + UDP_HEADER_SIZE + size));
+    ip[8] = 64;
+    ip[9] = IPPROTO_UDP_NUM;
+    writeNet32(ip+12, srcIp);
+    writeNet32(ip+16, dstIp);
+
+    // UDP (checksum is optional for IPv4)
+    //
+    char* udp = ip + IP_HEADER_SIZE;
+    writeNet16(udp, srcPort);
+    writeNet16(udp+2, dstPort);
+    writeNet16(udp+4, static_cast<uint16_t>(UDP_HEADER_SIZE + size));
+
+    if ( size > 0 )
+        ::memcpy(udp + UDP_HEADER_SIZE, payload, size);
+
+    return (_buffer.size() == ::fwrite(record, 1, _buffer.size(), _file));
+}
+
+} // namespace common_comm
+} // namespace tw
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <tw/common/defs.h>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+namespace tw {
+namespace common_comm {
+
+// Minimal libpcap file format support (no dependency on libpcap) - enough
+// to replay captured UDP multicast traffic (e.g. exchange market data) and
+// to create such captures for unit tests and benchmarks
+//
+// Supported link layers: Ethernet (w/ or w/o 802.1Q vlan tags) and Linux
+// 'cooked' capture; only IPv4/UDP packets are returned by PcapReader,
+// everything else is skipped
+//
+struct PcapPacket {
+    PcapPacket() {
+        clear();
+    }
+
+    void clear() {
+        _timestamp = 0;
+        _srcIp = 0;
+        _dstIp = 0;
+        _srcPort = 0;
+        _dstPort = 0;
+        _data = NULL;
+        _size = 0;
+    }
+
+    uint64_t _timestamp;        // capture time, nanoseconds since epoch
+    uint32_t _srcIp;            // host byte order
+    uint32_t _dstIp;            // host byte order
+    uint16_t _srcPort;
+    uint16_t _dstPort;
+    const char* _data;          // UDP payload - valid until next call to PcapReader::next()
+    size_t _size;
+};
+
+class PcapReader {
+public:
+    PcapReader();
+    ~PcapReader();
+
+    void clear();
+
+public:
+    bool open(const std::string& fileName);
+    void close();
+
+    bool isOpen() const {
+        return (NULL != _file);
+    }
+
+    // Returns false on end of file or on error (see isError())
+    //
+    bool next(PcapPacket& packet);
+
+    bool isError() const {
+        return _error;
+    }
+
+    uint64_t getRecordsCount() const {
+        return _recordsCount;
+    }
+
+    uint64_t getSkippedCount() const {
+        return _skippedCount;
+    }
+
+public:
+    static uint32_t parseIp(const std::string& ip);
+    static std::string ipToString(uint32_t ip);
+
+private:
+    bool parseFrame(const char* data, size_t size, PcapPacket& packet) const;
+
+    uint32_t swap(uint32_t value) const {
+        return _swapped ? __builtin_bswap32(value) : value;
+    }
+
+private:
+    FILE* _file;
+    bool _swapped;
+    bool _nanos;
+    uint32_t _linkType;
+    bool _error;
+    uint64_t _recordsCount;
+    uint64_t _skippedCount;
+    std::vector<char> _buffer;
+};
+
+class PcapWriter {
+public:
+    PcapWriter();
+    ~PcapWriter();
+
+public:
+    bool open(const std::string& fileName);
+    void close();
+
+    // Writes Ethernet/IPv4/UDP frame with 'payload'
+    //
+    bool writeUdp(uint64_t timestamp,
+                  uint32_t srcIp,
+                  uint16_t srcPort,
+                  uint32_t dstIp,
+                  uint16_t dstPort,
+                  const char* payload,
+                  size_t size);
+
+private:
+    FILE* _file;
+    std::vector<char> _buffer;
+};
+
+} // namespace common_comm
+} // namespace tw
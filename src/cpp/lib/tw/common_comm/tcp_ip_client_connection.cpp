@@ -1,5 +1,6 @@
 #include <tw/common_comm/tcp_ip_client_connection.h>
 #include <tw/common_thread/utils.h>
+#include <tw/common/thread_placement.h>
 
 #include <errno.h>
 
@@ -20,6 +21,10 @@ TcpIpClientConnection::TcpIpClientConnection() : _connected(false),
                                                  _sendQueue(),
                                                  _threadSend(),
                                                  _threadRecv(),
+                                                 _reactorMode(false),
+                                                 _reactorWriteInterest(false),
+                                                 _reactorLock(),
+                                                 _reactorSendQueue(),
                                                  _parent(NULL),
                                                  _buffer(),
                                                  _socket(-1),
@@ -65,11 +70,16 @@ bool TcpIpClientConnection::start() {
         
         if ( !connect() )
             return false;
+        
+        if ( TcpIpReactor::instance().isEnabled() ) {
+            _reactorMode = true;
+            return TcpIpReactor::instance().add(_socket, this);
+        }
 
         // Start send/recv threads
         //
-        _threadSend = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TcpIpClientConnection::threadMainSend, this)));
-        _threadRecv = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TcpIpClientConnection::threadMainRecv, this)));
+        _threadSend = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpConnection, boost::bind(&TcpIpClientConnection::threadMainSend, this));
+        _threadRecv = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpConnection, boost::bind(&TcpIpClientConnection::threadMainRecv, this));
         
         return true;
     } catch(const std::exception& e) {
@@ -88,6 +98,16 @@ void TcpIpClientConnection::stop() {
         
         if ( validSocket ) {
             LOGGER_INFO << socket << " :: Closing connection..."  << "\n";
+            
+            // NOTE: socket has to be removed from reactor before it's closed,
+            // since its descriptor can be reused right away
+            //
+            if ( _reactorMode ) {
+                TcpIpReactor::instance().remove(_socket);
+                
+                tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_reactorLock);
+                _reactorSendQueue.clear();
+            }
         
             ::shutdown(_socket, SHUT_RDWR);
             ::close(_socket);
@@ -202,6 +222,11 @@ void TcpIpClientConnection::send(const std::string& message) {
         if ( !isValid() )
             return;
         
+        if ( _reactorMode ) {
+            send(makeSharedBuffer(message));
+            return;
+        }
+        
         if ( _sendQueue.size() > MAX_MSG_QUEUE_SIZE ) {
             LOGGER_ERRO << "Messages queue overflow: "  << _sendQueue.size() << " :: " << MAX_MSG_QUEUE_SIZE << "\n" << "\n";            
             onConnectionError("MAX_MSG_QUEUE_SIZE");
@@ -219,6 +244,47 @@ void TcpIpClientConnection::send(const std::string& message) {
     }
 }
     
+void TcpIpClientConnection::send(const TSharedBuffer& message) {
+    try {
+        if ( !isValid() || !message )
+            return;
+        
+        if ( !_reactorMode ) {
+            send(*message);
+            return;
+        }
+        
+        bool overflow = false;
+        {
+            tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_reactorLock);
+            if ( _reactorSendQueue.size() > MAX_MSG_QUEUE_SIZE || (_reactorSendQueue.bytes() + message->size()) > TcpIpReactor::instance().getMaxQueuedBytes() ) {
+                LOGGER_ERRO << "Messages queue overflow: "  << _reactorSendQueue.size() << " :: " << MAX_MSG_QUEUE_SIZE << " :: bytes=" << _reactorSendQueue.bytes() << "\n" << "\n";
+                overflow = true;
+            } else {
+                _reactorSendQueue.push(message);
+                if ( MSG_QUEUE_HIGH_WATER_MARK == _reactorSendQueue.size() )
+                    LOGGER_WARN << "Reached MSG_QUEUE_HIGH_WATER_MARK: "  << MSG_QUEUE_HIGH_WATER_MARK << "\n" << "\n";
+                
+                if ( !_reactorWriteInterest )
+                    _reactorWriteInterest = TcpIpReactor::instance().setWriteInterest(_socket, true);
+            }
+        }
+        
+        if ( overflow ) {
+            onConnectionError("MAX_MSG_QUEUE_SIZE");
+            return;
+        }
+        
+        if ( _parent && _parent->verbose() )
+            LOGGER_INFO << "\n\t" << "@ tcp/ip ==> " << *message << "\n";
+        
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+    
 int32_t TcpIpClientConnection::process(char* data, size_t size) {
     // diagnostic logging for 2015-06-01; delete later
     if ( data && size > 0 ) {
@@ -350,6 +416,58 @@ void TcpIpClientConnection::threadMainRecv() {
     LOGGER_INFO << socket << " :: Exited"  << "\n";
 }
 
+// TcpIpReactorHandler interface
+//
+void TcpIpClientConnection::onReactorRead() {
+    while ( isValid() ) {
+        ssize_t bytes = ::recv(_socket, _buffer.getFreeBuffer(), _buffer.getFreeSize(), 0);
+        
+        if ( _parent && _parent->verbose() && (bytes > -1) )
+            LOGGER_INFO << "TCP bytes=" << bytes << ", buffer.getFreeSize()=" << _buffer.getFreeSize() << "\n";
+        
+        if ( bytes > 0 ) {
+            _buffer.process(bytes);
+            continue;
+        }
+        
+        if ( 0 == bytes ) {
+            onReactorError("Connection closed by peer");
+            return;
+        }
+        
+        switch ( errno ) {
+            case EAGAIN:
+                return;
+            case EINTR:
+                break;
+            default:
+                LOGGER_ERRO << _socket << " :: failed to receive - error: " << errno << " :: " << ::strerror(errno) << "\n";
+                onReactorError("Failed to receive");
+                return;
+        }
+    }
+}
+
+void TcpIpClientConnection::onReactorWrite() {
+    TcpIpReactorSendQueue::eFlushStatus status = TcpIpReactorSendQueue::kFlushDone;
+    {
+        tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_reactorLock);
+        status = _reactorSendQueue.flush(_socket);
+        if ( TcpIpReactorSendQueue::kFlushDone == status && _reactorWriteInterest ) 
+            _reactorWriteInterest = !TcpIpReactor::instance().setWriteInterest(_socket, false);
+    }
+    
+    if ( TcpIpReactorSendQueue::kFlushError == status )
+        onReactorError("Send error");
+}
+
+void TcpIpClientConnection::onReactorError(const std::string& reason) {
+    // NOTE: socket is removed from reactor right away to stop level triggered
+    // notifications until connection is stopped by its owner
+    //
+    TcpIpReactor::instance().remove(_socket);
+    onConnectionError(reason);
+}
+
 } // namespace common_comm
 } // namespace tw
-
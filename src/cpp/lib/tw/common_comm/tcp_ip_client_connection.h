@@ -1,6 +1,8 @@
 #pragma once
 
 #include <tw/common_comm/buffer.h>
+#include <tw/common_comm/tcp_ip_reactor.h>
+#include <tw/common_thread/locks.h>
 #include <tw/common_thread/thread.h>
 #include <tw/log/defs.h>
 
@@ -27,7 +29,10 @@ class TcpIpClientCallback;
     
 // TcpIpClientConnection class
 //
-class TcpIpClientConnection {
+// NOTE: if 'common_comm.reactor_mode' is set, connection is serviced by
+// TcpIpReactor instead of its own send/recv threads
+//
+class TcpIpClientConnection : public TcpIpReactorHandler {
 public:
     typedef boost::shared_ptr<TcpIpClientConnection> pointer;
     typedef int native_type;
@@ -68,11 +73,19 @@ public:
     bool start();
     void stop();
     void send(const std::string& message);
+    void send(const TSharedBuffer& message);
     
     bool connect();
     
 public:
     int32_t process(char* data, size_t size);
+    
+public:
+    // TcpIpReactorHandler interface
+    //
+    virtual void onReactorRead();
+    virtual void onReactorWrite();
+    virtual void onReactorError(const std::string& reason);
 
 private:
     void init(const std::string& host, int port, TParent* parent, bool rawProcessing);
@@ -97,6 +110,11 @@ private:
     tw::common_thread::ThreadPtr _threadSend;
     tw::common_thread::ThreadPtr _threadRecv;
     
+    bool _reactorMode;
+    bool _reactorWriteInterest;
+    tw::common_thread::Lock _reactorLock;
+    TcpIpReactorSendQueue _reactorSendQueue;
+    
     TParent* _parent;
     TBuffer _buffer;
     TSocket _socket;
@@ -0,0 +1,283 @@
+#include <tw/common_comm/tcp_ip_reactor.h>
+#include <tw/common/high_res_time.h>
+#include <tw/common/thread_placement.h>
+
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace tw {
+namespace common_comm {
+
+static const int MAX_EVENTS = 64;
+
+// TcpIpReactor implementation
+//
+TcpIpReactor::TcpIpReactor() : _lock(),
+                               _isDone(false),
+                               _enabled(false),
+                               _maxQueuedBytes(0),
+                               _epoll(-1),
+                               _handlers(),
+                               _thread() {
+}
+
+TcpIpReactor::~TcpIpReactor() {
+    stop();
+}
+
+void TcpIpReactor::clear() {
+    // Lock for thread synchronization
+    //
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    _handlers.clear();
+}
+
+bool TcpIpReactor::init(const tw::common::Settings& settings) {
+    // Lock for thread synchronization
+    //
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    _enabled = settings._common_comm_reactor_mode;
+    _maxQueuedBytes = settings._common_comm_reactor_max_queued_bytes;
+
+    if ( _enabled )
+        LOGGER_INFO << "Reactor mode enabled - max_queued_bytes=" << _maxQueuedBytes << "\n";
+
+    return true;
+}
+
+bool TcpIpReactor::start() {
+    try {
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+
+        if ( _thread != NULL )
+            return true;
+
+        _epoll = ::epoll_create(MAX_EVENTS);
+        if ( -1 == _epoll ) {
+            LOGGER_ERRO << "Failed to epoll_create(): " << ::strerror(errno) << "\n" << "\n";
+            return false;
+        }
+
+        _isDone = false;
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpReactor, boost::bind(&TcpIpReactor::threadMain, this));
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        return false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void TcpIpReactor::stop() {
+    try {
+        if ( _thread == NULL )
+            return;
+
+        LOGGER_INFO << "Stopping..." << "\n";
+
+        _isDone = true;
+        _thread->join();
+        _thread.reset();
+
+        if ( -1 != _epoll ) {
+            ::close(_epoll);
+            _epoll = -1;
+        }
+
+        clear();
+
+        LOGGER_INFO << "Stopped" << "\n";
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+bool TcpIpReactor::add(int socket, TcpIpReactorHandler* handler) {
+    try {
+        if ( !handler || -1 == socket )
+            return false;
+
+        if ( !start() )
+            return false;
+
+        int flags = ::fcntl(socket, F_GETFL, 0);
+        if ( -1 == flags || -1 == ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) ) {
+            LOGGER_ERRO << socket << " :: Failed to set O_NONBLOCK: " << ::strerror(errno) << "\n" << "\n";
+            return false;
+        }
+
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+
+        struct epoll_event event;
+        ::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = socket;
+
+        if ( -1 == ::epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event) ) {
+            LOGGER_ERRO << socket << " :: Failed to epoll_ctl(EPOLL_CTL_ADD): " << ::strerror(errno) << "\n" << "\n";
+            return false;
+        }
+
+        _handlers[socket] = handler;
+        LOGGER_INFO << socket << " :: Added to reactor" << "\n";
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        return false;
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void TcpIpReactor::remove(int socket) {
+    try {
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+
+        THandlers::iterator iter = _handlers.find(socket);
+        if ( iter == _handlers.end() )
+            return;
+
+        _handlers.erase(iter);
+        if ( -1 != _epoll )
+            ::epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, NULL);
+
+        LOGGER_INFO << socket << " :: Removed from reactor" << "\n";
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+bool TcpIpReactor::setWriteInterest(int socket, bool enabled) {
+    // NOTE: epoll_ctl() is thread safe, so no locking is needed here
+    //
+    struct epoll_event event;
+    ::memset(&event, 0, sizeof(event));
+    event.events = enabled ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.fd = socket;
+
+    if ( -1 == ::epoll_ctl(_epoll, EPOLL_CTL_MOD, socket, &event) ) {
+        LOGGER_ERRO << socket << " :: Failed to epoll_ctl(EPOLL_CTL_MOD): " << ::strerror(errno) << "\n" << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void TcpIpReactor::dispatch(int socket, uint32_t events) {
+    try {
+        THandlers::iterator iter = _handlers.find(socket);
+        if ( iter == _handlers.end() )
+            return;
+
+        if ( events & EPOLLIN ) {
+            iter->second->onReactorRead();
+
+            // NOTE: handler might have removed itself during the callback
+            //
+            iter = _handlers.find(socket);
+            if ( iter == _handlers.end() )
+                return;
+        }
+
+        if ( events & EPOLLOUT ) {
+            iter->second->onReactorWrite();
+
+            iter = _handlers.find(socket);
+            if ( iter == _handlers.end() )
+                return;
+        }
+
+        if ( (events & (EPOLLERR | EPOLLHUP)) && !(events & EPOLLIN) )
+            iter->second->onReactorError("EPOLLERR/EPOLLHUP");
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << socket << " :: Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << socket << " :: Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void TcpIpReactor::dispatchTimeout(TcpIpReactorHandler* handler) {
+    try {
+        handler->onReactorTimeout();
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void TcpIpReactor::threadMain() {
+    LOGGER_INFO << "Started" << "\n";
+
+    try {
+        struct epoll_event events[MAX_EVENTS];
+        std::vector<int> sockets;
+
+        tw::common::THighResTime timer = tw::common::THighResTime::now();
+        while ( !_isDone ) {
+            int count = ::epoll_wait(_epoll, events, MAX_EVENTS, TIMEOUT_RESOLUTION);
+            if ( count < 0 && EINTR != errno ) {
+                LOGGER_ERRO << "Failed to epoll_wait(): " << ::strerror(errno) << "\n";
+                continue;
+            }
+
+            // Lock for thread synchronization
+            //
+            tw::common_thread::LockGuard<TLock> lock(_lock);
+
+            for ( int i = 0; i < count; ++i ) {
+                dispatch(events[i].data.fd, events[i].events);
+            }
+
+            if ( (tw::common::THighResTime::now() - timer)/1000 < TIMEOUT_RESOLUTION )
+                continue;
+
+            // NOTE: copy of sockets is made since handlers might remove themselves
+            // in the callback, which would invalidate iterators
+            //
+            sockets.clear();
+            THandlers::iterator iter = _handlers.begin();
+            THandlers::iterator end = _handlers.end();
+            for ( ; iter != end; ++iter ) {
+                sockets.push_back(iter->first);
+            }
+
+            for ( size_t i = 0; i < sockets.size(); ++i ) {
+                iter = _handlers.find(sockets[i]);
+                if ( iter != _handlers.end() )
+                    dispatchTimeout(iter->second);
+            }
+
+            timer.setToNow();
+        }
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+
+    LOGGER_INFO << "Exited" << "\n";
+}
+
+} // namespace common_comm
+} // namespace tw
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <tw/common/defs.h>
+#include <tw/common/settings.h>
+#include <tw/common/singleton.h>
+#include <tw/common_thread/locks.h>
+#include <tw/common_thread/thread.h>
+#include <tw/log/defs.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+
+#include <deque>
+#include <map>
+#include <string>
+
+namespace tw {
+namespace common_comm {
+
+// Reference counted immutable message buffer - allows the same message to be
+// queued for many connections (e.g. TcpIpServer::sendToAll()) without copying
+//
+typedef boost::shared_ptr<const std::string> TSharedBuffer;
+
+inline TSharedBuffer makeSharedBuffer(const std::string& message) {
+    return TSharedBuffer(new std::string(message));
+}
+
+// Per connection send queue of shared buffers, flushed with scatter-gather
+// writes (sendmsg() w/MSG_NOSIGNAL, i.e. writev() w/o SIGPIPE) on non-blocking sockets
+//
+// NOTE: queue is NOT thread safe - synchronization is responsibility of the owner
+//
+class TcpIpReactorSendQueue {
+public:
+    // Max number of buffers passed to a single sendmsg() call
+    //
+    static const size_t MAX_IOV = 64;
+
+    enum eFlushStatus {
+        kFlushDone,
+        kFlushPartial,
+        kFlushError
+    };
+
+public:
+    TcpIpReactorSendQueue() {
+        clear();
+    }
+
+    void clear() {
+        _buffers.clear();
+        _offset = 0;
+        _bytes = 0;
+    }
+
+    bool empty() const {
+        return _buffers.empty();
+    }
+
+    size_t size() const {
+        return _buffers.size();
+    }
+
+    size_t bytes() const {
+        return _bytes;
+    }
+
+public:
+    void push(const TSharedBuffer& buffer) {
+        if ( !buffer || buffer->empty() )
+            return;
+
+        _buffers.push_back(buffer);
+        _bytes += buffer->size();
+    }
+
+    // Writes as much of queued data as socket accepts without blocking
+    //
+    eFlushStatus flush(int socket) {
+        while ( !_buffers.empty() ) {
+            struct iovec iov[MAX_IOV];
+            size_t count = 0;
+
+            TBuffers::const_iterator iter = _buffers.begin();
+            TBuffers::const_iterator end = _buffers.end();
+            for ( ; iter != end && count < MAX_IOV; ++iter, ++count ) {
+                const std::string& buffer = *(*iter);
+                size_t offset = (0 == count) ? _offset : 0;
+
+                iov[count].iov_base = const_cast<char*>(buffer.data()) + offset;
+                iov[count].iov_len = buffer.size() - offset;
+            }
+
+            struct msghdr msg;
+            ::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+
+            ssize_t written = ::sendmsg(socket, &msg, MSG_NOSIGNAL);
+            if ( written < 0 ) {
+                if ( EAGAIN == errno || EWOULDBLOCK == errno )
+                    return kFlushPartial;
+
+                if ( EINTR == errno )
+                    continue;
+
+                return kFlushError;
+            }
+
+            advance(written);
+        }
+
+        return kFlushDone;
+    }
+
+private:
+    void advance(size_t written) {
+        _bytes -= written;
+        while ( written > 0 && !_buffers.empty() ) {
+            size_t remaining = _buffers.front()->size() - _offset;
+            if ( written < remaining ) {
+                _offset += written;
+                return;
+            }
+
+            written -= remaining;
+            _offset = 0;
+            _buffers.pop_front();
+        }
+    }
+
+private:
+    typedef std::deque<TSharedBuffer> TBuffers;
+
+    TBuffers _buffers;
+    size_t _offset;
+    size_t _bytes;
+};
+
+// Interface implemented by connections, which are driven by TcpIpReactor
+//
+class TcpIpReactorHandler {
+public:
+    virtual ~TcpIpReactorHandler() {
+    }
+
+public:
+    virtual void onReactorRead() = 0;
+    virtual void onReactorWrite() = 0;
+    virtual void onReactorError(const std::string& reason) = 0;
+
+    // Called every TIMEOUT_RESOLUTION ms from reactor's thread (e.g. for heartbeats)
+    //
+    virtual void onReactorTimeout() {
+    }
+};
+
+// Single threaded epoll based reactor, which services all registered non-blocking
+// sockets instead of dedicated send/recv threads per connection
+//
+// NOTE: reactor's lock is held while dispatching events, so once remove() returns
+// it is guaranteed that no callbacks are in progress for the removed handler
+//
+class TcpIpReactor : public tw::common::Singleton<TcpIpReactor> {
+public:
+    static const int TIMEOUT_RESOLUTION = 10;  // 10 ms
+
+public:
+    TcpIpReactor();
+    ~TcpIpReactor();
+
+    void clear();
+
+public:
+    bool init(const tw::common::Settings& settings);
+    bool start();
+    void stop();
+
+    bool isEnabled() const {
+        return _enabled;
+    }
+
+    size_t getMaxQueuedBytes() const {
+        return _maxQueuedBytes;
+    }
+
+public:
+    bool add(int socket, TcpIpReactorHandler* handler);
+    void remove(int socket);
+
+    // Enables/disables notifications about socket's write readiness
+    //
+    bool setWriteInterest(int socket, bool enabled);
+
+private:
+    void dispatch(int socket, uint32_t events);
+    void dispatchTimeout(TcpIpReactorHandler* handler);
+    void threadMain();
+
+private:
+    typedef tw::common_thread::Lock TLock;
+    typedef std::map<int, TcpIpReactorHandler*> THandlers;
+
+    TLock _lock;
+    bool _isDone;
+    bool _enabled;
+    size_t _maxQueuedBytes;
+    int _epoll;
+    THandlers _handlers;
+    tw::common_thread::ThreadPtr _thread;
+};
+
+} // namespace common_comm
+} // namespace tw
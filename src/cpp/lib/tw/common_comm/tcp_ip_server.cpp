@@ -1,4 +1,5 @@
 #include <tw/common_comm/tcp_ip_server.h>
+#include <tw/common/thread_placement.h>
 
 namespace tw {
 namespace common_comm {
@@ -40,6 +41,9 @@ bool TcpIpServer::init(const tw::common::Settings& settings) {
         if ( !_server.listen() )
             return false;
         
+        if ( !TcpIpReactor::instance().init(settings) )
+            return false;
+        
         _settings = settings;
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
@@ -64,9 +68,9 @@ bool TcpIpServer::start(TClient* client, bool async) {
         if ( !async )
             run();
         else
-           _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TcpIpServer::run, this))); 
+           _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpServer, boost::bind(&TcpIpServer::run, this)); 
             
-        _threadDisconnectedConnections = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TcpIpServer::threadMainDisconnectedConnections, this)));
+        _threadDisconnectedConnections = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpServer, boost::bind(&TcpIpServer::threadMainDisconnectedConnections, this));
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
         status = false;
@@ -135,6 +139,56 @@ void TcpIpServer::onData(TConnection::native_type id, const std::string& message
     }
 }
 
+void TcpIpServer::onFrame(TConnection::native_type id, const char* data, size_t size) {
+    try {
+        if ( _client )
+            _client->onConnectionFrame(id, data, size);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+TcpIpServer::TConnectionPtr TcpIpServer::getConnection(TConnection::native_type id) {
+    // Lock for thread synchronization
+    //
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+
+    TConnections::iterator iter = _connections.find(id);
+    if ( iter == _connections.end() ) {
+        LOGGER_ERRO << "Can't find connection: " << id << "\n";
+        return TConnectionPtr();
+    }
+    
+    return iter->second;
+}
+
+bool TcpIpServer::isBinary(TConnection::native_type id) {
+    try {
+        TConnectionPtr connection = getConnection(id);
+        return (connection && connection->isBinary());
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+    
+    return false;
+}
+
+void TcpIpServer::sendFrameToConnection(TConnection::native_type id, const TSharedBuffer& frame) {
+    try {
+        TConnectionPtr connection = getConnection(id);
+        if ( connection )
+            connection->sendFrame(frame);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
 void TcpIpServer::sendToConnection(TConnection::native_type id, const std::string& message) {
     try {
         TConnectionPtr connection;
@@ -162,6 +216,13 @@ void TcpIpServer::sendToConnection(TConnection::native_type id, const std::strin
 }
 
 void TcpIpServer::sendToAll(const std::string& message) {
+    // NOTE: message is copied only once into shared buffer, which is
+    // then queued for all connections in reactor mode
+    //
+    sendToAll(makeSharedBuffer(message));
+}
+
+void TcpIpServer::sendToAll(const TSharedBuffer& message) {
     try {
         // NOTE: copy of connections is made in case sendMessage() triggers
         // onConnectionError() call in the same call stack, which would
@@ -188,6 +249,34 @@ void TcpIpServer::sendToAll(const std::string& message) {
     }
 }
 
+void TcpIpServer::getConnections(TConnections& connections) {
+    // Lock for thread synchronization
+    //
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+    connections = _connections;
+}
+
+void TcpIpServer::sendToAll(const TSharedBuffer& message, const TSharedBuffer& frame) {
+    try {
+        TConnections connections;
+        getConnections(connections);
+        
+        TConnections::iterator iter = connections.begin();
+        TConnections::iterator end = connections.end();
+        
+        for ( ; iter != end; ++iter ) {
+            if ( iter->second->isBinary() )
+                iter->second->sendFrame(frame);
+            else
+                iter->second->send(message);
+        }
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
 void TcpIpServer::onConnectionError(TConnection::native_type id, const std::string& reason) {
     try {
         LOGGER_WARN << "Notifying client of down connection: " << id << " :: " << reason << "\n";
@@ -34,6 +34,18 @@ public:
     // NOTE: all messages are assumed to be '\n' (new line) terminated
     //
     virtual void onConnectionData(TConnection::native_type id, const std::string& message) = 0;
+    
+    // Binary framing (see BinaryFrame) support - clients, which support it, need
+    // to override both methods
+    //
+    virtual bool isBinaryFramingSupported() const {
+        return false;
+    }
+    
+    // NOTE: 'data' is frame's payload (i.e. w/o length prefix)
+    //
+    virtual void onConnectionFrame(TConnection::native_type id, const char* data, size_t size) {
+    }
 };
 
 
@@ -72,17 +84,68 @@ public:
         return _settings._common_comm_tcp_no_delay;
     }
     
+    bool isBinaryFramingSupported() const {
+        return (_client && _client->isBinaryFramingSupported());
+    }
+    
 public:
     void sendToConnection(TConnection::native_type id, const std::string& message);
     void sendToAll(const std::string& message);
+    void sendToAll(const TSharedBuffer& message);
+    
+    // Binary framing related methods - 'frame' is sent to binary connections,
+    // 'message' (text) to the rest
+    //
+    bool isBinary(TConnection::native_type id);
+    void sendFrameToConnection(TConnection::native_type id, const TSharedBuffer& frame);
+    void sendToAll(const TSharedBuffer& message, const TSharedBuffer& frame);
+    
+    // Sends 'message' to all connections, encoding it only into framings
+    // connections actually use: TMessage::toString() (w/o '\n') for text
+    // connections and TMessage::toBinary() for binary ones
+    //
+    template <typename TMessage>
+    void sendToAllEncoded(const TMessage& message) {
+        try {
+            TConnections connections;
+            getConnections(connections);
+            
+            TSharedBuffer text;
+            TSharedBuffer frame;
+            
+            TConnections::iterator iter = connections.begin();
+            TConnections::iterator end = connections.end();
+            
+            for ( ; iter != end; ++iter ) {
+                if ( iter->second->isBinary() ) {
+                    if ( !frame )
+                        frame = makeSharedBuffer(message.toBinary());
+                    
+                    iter->second->sendFrame(frame);
+                } else {
+                    if ( !text )
+                        text = makeSharedBuffer(message.toString()+"\n");
+                    
+                    iter->second->send(text);
+                }
+            }
+        } catch(const std::exception& e) {
+            LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+        } catch(...) {
+            LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+        }
+    }
     
 public:    
     void onConnectionError(TConnection::native_type id, const std::string& reason);
     void onData(TConnection::native_type id, const std::string& message);
+    void onFrame(TConnection::native_type id, const char* data, size_t size);
     
 private:
     void doOnConnectionError(TConnection::native_type id, const std::string& reason);
     void removeConnection(TConnection::native_type id);
+    TConnectionPtr getConnection(TConnection::native_type id);
+    void getConnections(TConnections& connections);
     
     void threadMainDisconnectedConnections();
     void run();
@@ -1,6 +1,7 @@
 #include <tw/common_comm/tcp_ip_server_connection.h>
 #include <tw/common_comm/tcp_ip_server.h>
 #include <tw/common_thread/utils.h>
+#include <tw/common/thread_placement.h>
 
 #include <errno.h>
 
@@ -25,9 +26,15 @@ static uint32_t ACCEPT_SOCKET_TIMEOUT_MS = 2000; // 2 secs
 // TcpIpServerConnection implementation
 //
 TcpIpServerConnection::TcpIpServerConnection() : _connected(false),
+                                                 _binary(false),
+                                                 _framingLock(),
                                                  _sendQueue(),
                                                  _threadSend(),
                                                  _threadRecv(),
+                                                 _reactorMode(false),
+                                                 _reactorWriteInterest(false),
+                                                 _reactorLock(),
+                                                 _reactorSendQueue(),
                                                  _parent(NULL),
                                                  _buffer(),
                                                  _socket(-1),
@@ -163,11 +170,24 @@ bool TcpIpServerConnection::start(TParent* parent, TSocket& socket) {
         _socket = socket;
         _buffer.setParser(this);
         _connected = true;
+        
+        if ( TcpIpReactor::instance().isEnabled() ) {
+            _reactorMode = true;
+            _reactorTimer.setToNow();
+            if ( !TcpIpReactor::instance().add(_socket, this) ) {
+                _socket = -1;
+                _connected = false;
+                return false;
+            }
+            
+            LOGGER_INFO << _socket << " :: Connection open (reactor mode)"  << "\n";
+            return true;
+        }
 
         // Start send/recv threads
         //
-        _threadSend = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TcpIpServerConnection::threadMainSend, this)));
-        _threadRecv = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&TcpIpServerConnection::threadMainRecv, this)));
+        _threadSend = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpConnection, boost::bind(&TcpIpServerConnection::threadMainSend, this));
+        _threadRecv = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kTcpConnection, boost::bind(&TcpIpServerConnection::threadMainRecv, this));
         
         LOGGER_INFO << _socket << " :: Connection open"  << "\n";
     } catch(const std::exception& e) {
@@ -189,6 +209,16 @@ void TcpIpServerConnection::stop() {
         TSocket socket = _socket;
         LOGGER_INFO << socket << " :: Closing connection..."  << "\n";
         
+        // NOTE: socket has to be removed from reactor before it's closed,
+        // since its descriptor can be reused right away
+        //
+        if ( _reactorMode ) {
+            TcpIpReactor::instance().remove(_socket);
+            
+            tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_reactorLock);
+            _reactorSendQueue.clear();
+        }
+        
         ::shutdown(_socket, SHUT_RDWR);
         ::close(_socket);
         _socket = -1;
@@ -273,10 +303,76 @@ bool TcpIpServerConnection::setTcpNoDelay(TSocket& socket) {
 }
     
 void TcpIpServerConnection::send(const std::string& message) {
+    try {
+        // NOTE: lock guarantees that no text messages are queued after
+        // connection was switched to binary framing
+        //
+        tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_framingLock);
+        if ( !_binary ) {
+            enqueue(message);
+            return;
+        }
+        
+        std::string frame;
+        BinaryFrame::encodeText(message, frame);
+        enqueue(frame);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void TcpIpServerConnection::send(const TSharedBuffer& message) {
+    try {
+        if ( !message )
+            return;
+        
+        tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_framingLock);
+        if ( !_binary ) {
+            enqueue(message);
+            return;
+        }
+        
+        std::string frame;
+        BinaryFrame::encodeText(*message, frame);
+        enqueue(frame);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void TcpIpServerConnection::sendFrame(const TSharedBuffer& frame) {
+    try {
+        if ( !frame )
+            return;
+        
+        tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_framingLock);
+        if ( !_binary ) {
+            LOGGER_ERRO << _socket << " :: Can't send binary frame to text connection" << "\n";
+            return;
+        }
+        
+        enqueue(frame);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void TcpIpServerConnection::enqueue(const std::string& message) {
     try {
         if ( !isValid() )
             return;
         
+        if ( _reactorMode ) {
+            enqueue(makeSharedBuffer(message));
+            return;
+        }
+        
         if ( _sendQueue.size() > MAX_MSG_QUEUE_SIZE ) {
             LOGGER_ERRO << "Messages queue overflow: "  << _sendQueue.size() << " :: " << MAX_MSG_QUEUE_SIZE << "\n" << "\n";            
             onConnectionError("MAX_MSG_QUEUE_SIZE");
@@ -294,7 +390,51 @@ void TcpIpServerConnection::send(const std::string& message) {
     }
 }
     
+void TcpIpServerConnection::enqueue(const TSharedBuffer& message) {
+    try {
+        if ( !isValid() || !message )
+            return;
+        
+        if ( !_reactorMode ) {
+            enqueue(*message);
+            return;
+        }
+        
+        bool overflow = false;
+        {
+            tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_reactorLock);
+            if ( _reactorSendQueue.size() > MAX_MSG_QUEUE_SIZE || (_reactorSendQueue.bytes() + message->size()) > TcpIpReactor::instance().getMaxQueuedBytes() ) {
+                LOGGER_ERRO << "Messages queue overflow: "  << _reactorSendQueue.size() << " :: " << MAX_MSG_QUEUE_SIZE << " :: bytes=" << _reactorSendQueue.bytes() << "\n" << "\n";
+                overflow = true;
+            } else {
+                _reactorSendQueue.push(message);
+                if ( MSG_QUEUE_HIGH_WATER_MARK == _reactorSendQueue.size() )
+                    LOGGER_WARN << "Reached MSG_QUEUE_HIGH_WATER_MARK: "  << MSG_QUEUE_HIGH_WATER_MARK << "\n" << "\n";
+                
+                if ( !_reactorWriteInterest )
+                    _reactorWriteInterest = TcpIpReactor::instance().setWriteInterest(_socket, true);
+            }
+        }
+        
+        if ( overflow ) {
+            onConnectionError("MAX_MSG_QUEUE_SIZE");
+            return;
+        }
+        
+        if ( _parent && _parent->verbose() )
+            LOGGER_INFO << "\n\t" << "@ tcp/ip ==> " << *message << "\n";
+        
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+    
 int32_t TcpIpServerConnection::process(char* data, size_t size) {
+    if ( _binary )
+        return processFrame(data, size);
+    
     char* end = data+size;
     char* iter = std::find(data, end, DELIM);
     if ( iter == end )
@@ -305,13 +445,57 @@ int32_t TcpIpServerConnection::process(char* data, size_t size) {
     else
         _message.assign(data, iter);    
     
-    if ( _parent && !(_message == HEARTBEAT) ) {  
+    if ( _message == BINARY_FRAMING_REQUEST ) {
+        onBinaryFramingRequest();
+    } else if ( _parent && !(_message == HEARTBEAT) ) {  
         _parent->onData(id(), _message);
     }
 
     return (iter-data+1);
 }
 
+int32_t TcpIpServerConnection::processFrame(char* data, size_t size) {
+    if ( size < BinaryFrame::HEADER_SIZE )
+        return 0;
+    
+    uint32_t length = BinaryFrame::readLength(data);
+    if ( length > BinaryFrame::MAX_PAYLOAD_SIZE ) {
+        LOGGER_ERRO << _socket << " :: Invalid frame length: " << length << "\n";
+        if ( _reactorMode )
+            onReactorError("Invalid frame length");
+        else
+            onConnectionError("Invalid frame length");
+        
+        return size;
+    }
+    
+    if ( size < BinaryFrame::HEADER_SIZE + length )
+        return 0;
+    
+    // NOTE: zero length frame is a heartbeat
+    //
+    if ( _parent && length > 0 )
+        _parent->onFrame(id(), data+BinaryFrame::HEADER_SIZE, length);
+    
+    return (BinaryFrame::HEADER_SIZE + length);
+}
+
+void TcpIpServerConnection::onBinaryFramingRequest() {
+    tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_framingLock);
+    if ( !_parent || !_parent->isBinaryFramingSupported() ) {
+        LOGGER_WARN << _socket << " :: Binary framing is not supported" << "\n";
+        enqueue(std::string(BINARY_FRAMING_NACK) + DELIM);
+        return;
+    }
+    
+    // NOTE: ack is the last text message sent on the connection
+    //
+    enqueue(std::string(BINARY_FRAMING_ACK) + DELIM);
+    _binary = true;
+    
+    LOGGER_INFO << _socket << " :: Switched to binary framing" << "\n";
+}
+
 bool TcpIpServerConnection::onTimeout() {
     tw::common::THighResTime now = tw::common::THighResTime::now();
     
@@ -330,7 +514,10 @@ bool TcpIpServerConnection::onTimeout() {
         ++_timeSlicesWithoutMsgs;
     }
     
-    send(HEARTBEAT_W_DELIM);
+    {
+        tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_framingLock);
+        enqueue(_binary ? BinaryFrame::heartbeat() : HEARTBEAT_W_DELIM);
+    }
     _timeoutTimer = now;
     
     return true;
@@ -406,7 +593,6 @@ void TcpIpServerConnection::threadMainRecv() {
     try {
         bool isDone = false;
         tw::common::THighResTime timer = tw::common::THighResTime::now();
-        int64_t delta = 0;
         while ( !isDone && isValid() ) {
             ssize_t bytes = ::recv(_socket, _buffer.getFreeBuffer(), _buffer.getFreeSize(), 0);
             if ( bytes > 0 ) {
@@ -427,24 +613,8 @@ void TcpIpServerConnection::threadMainRecv() {
                 }
             }
             
-            // NOTE: resolution is made to be 10 ms
-            //
-            delta = (tw::common::THighResTime::now() - timer)/1000 + TIMEOUT_RESOLUTION;
-            if ( delta >= _parent->getHeartbeatInterval() ) {
-                if ( onTimeout() ) {
-                    if ( _timeSlicesWithoutMsgs > MAX_NUMBER_OF_TIMEOUTS ) {
-                        LOGGER_ERRO << _socket << " :: Didn't receive messages for: " << _timeSlicesWithoutMsgs << " > " << MAX_NUMBER_OF_TIMEOUTS << " timeouts" << "\n";                        
-                        onConnectionError("onTimeout(): idle connection");
-                        isDone = true;
-                    }
-                } else {
-                    LOGGER_ERRO << _socket << " :: onTimeout() failed - socket disconnected" << "\n";                        
-                    onConnectionError("onTimeout() failed - socket disconnected");
-                    isDone = true;
-                }
-                
-                timer.setToNow();
-            }
+            if ( !checkTimeout(timer) )
+                isDone = true;
         }
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -455,6 +625,86 @@ void TcpIpServerConnection::threadMainRecv() {
     LOGGER_INFO << socket << " :: Exited"  << "\n";
 }
 
+// Returns false if connection needs to be dropped
+//
+bool TcpIpServerConnection::checkTimeout(tw::common::THighResTime& timer) {
+    // NOTE: resolution is made to be 10 ms
+    //
+    int64_t delta = (tw::common::THighResTime::now() - timer)/1000 + TIMEOUT_RESOLUTION;
+    if ( delta < _parent->getHeartbeatInterval() )
+        return true;
+    
+    bool status = true;
+    if ( onTimeout() ) {
+        if ( _timeSlicesWithoutMsgs > MAX_NUMBER_OF_TIMEOUTS ) {
+            LOGGER_ERRO << _socket << " :: Didn't receive messages for: " << _timeSlicesWithoutMsgs << " > " << MAX_NUMBER_OF_TIMEOUTS << " timeouts" << "\n";                        
+            onConnectionError("onTimeout(): idle connection");
+            status = false;
+        }
+    } else {
+        LOGGER_ERRO << _socket << " :: onTimeout() failed - socket disconnected" << "\n";                        
+        onConnectionError("onTimeout() failed - socket disconnected");
+        status = false;
+    }
+    
+    timer.setToNow();
+    return status;
+}
+
+// TcpIpReactorHandler interface
+//
+void TcpIpServerConnection::onReactorRead() {
+    while ( isValid() ) {
+        ssize_t bytes = ::recv(_socket, _buffer.getFreeBuffer(), _buffer.getFreeSize(), 0);
+        if ( bytes > 0 ) {
+            ++_msgRecvPerTimeSlice;
+            _buffer.process(bytes);
+            continue;
+        }
+        
+        if ( 0 == bytes ) {
+            onReactorError("Connection closed by peer");
+            return;
+        }
+        
+        switch ( errno ) {
+            case EAGAIN:
+                return;
+            case EINTR:
+                break;
+            default:
+                LOGGER_ERRO << _socket << " :: failed to receive - error: " << errno << " :: " << ::strerror(errno) << "\n";
+                onReactorError("Failed to receive");
+                return;
+        }
+    }
+}
+
+void TcpIpServerConnection::onReactorWrite() {
+    TcpIpReactorSendQueue::eFlushStatus status = TcpIpReactorSendQueue::kFlushDone;
+    {
+        tw::common_thread::LockGuard<tw::common_thread::Lock> lock(_reactorLock);
+        status = _reactorSendQueue.flush(_socket);
+        if ( TcpIpReactorSendQueue::kFlushDone == status && _reactorWriteInterest ) 
+            _reactorWriteInterest = !TcpIpReactor::instance().setWriteInterest(_socket, false);
+    }
+    
+    if ( TcpIpReactorSendQueue::kFlushError == status )
+        onReactorError("Send error");
+}
+
+void TcpIpServerConnection::onReactorError(const std::string& reason) {
+    // NOTE: socket is removed from reactor right away to stop level triggered
+    // notifications until TcpIpServer removes the connection
+    //
+    TcpIpReactor::instance().remove(_socket);
+    onConnectionError(reason);
+}
+
+void TcpIpServerConnection::onReactorTimeout() {
+    if ( !checkTimeout(_reactorTimer) )
+        TcpIpReactor::instance().remove(_socket);
+}
+
 } // namespace common_comm
 } // namespace tw
-
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <tw/common_comm/buffer.h>
+#include <tw/common_comm/binary_frame.h>
+#include <tw/common_comm/tcp_ip_reactor.h>
+#include <tw/common_thread/locks.h>
 #include <tw/common_thread/thread.h>
 #include <tw/log/defs.h>
 
@@ -27,7 +30,13 @@ class TcpIpServer;
 
 // TcpIpServerConnection class
 //
-class TcpIpServerConnection {
+// NOTE: if 'common_comm.reactor_mode' is set, connection is serviced by
+// TcpIpReactor instead of its own send/recv threads
+//
+// NOTE: connection starts in text ('\n' terminated) mode and can be switched by
+// client to binary framing (see BinaryFrame), if server's client supports it
+//
+class TcpIpServerConnection : public TcpIpReactorHandler {
 public:
     typedef boost::shared_ptr<TcpIpServerConnection> pointer;
     typedef int native_type;
@@ -47,6 +56,10 @@ public:
         return (_socket != -1);
     }
     
+    bool isBinary() const {
+        return _binary;
+    }
+    
 public:
     // Server socket related methods
     //
@@ -58,10 +71,25 @@ public:
 public:
     bool start(TParent* parent, TSocket& socket);
     void stop();
+    // Text messages - wrapped into text frames for binary connections
+    //
     void send(const std::string& message);
+    void send(const TSharedBuffer& message);
+    
+    // Already encoded binary frames - only for binary connections
+    //
+    void sendFrame(const TSharedBuffer& frame);
     
 public:
     int32_t process(char* data, size_t size);
+    
+public:
+    // TcpIpReactorHandler interface
+    //
+    virtual void onReactorRead();
+    virtual void onReactorWrite();
+    virtual void onReactorError(const std::string& reason);
+    virtual void onReactorTimeout();
 
 private:
     bool setTimeout(const uint32_t ms, TSocket& socket);
@@ -69,11 +97,19 @@ private:
     bool onTimeout();
     void onConnectionError(const std::string& reason);
     
+    void enqueue(const std::string& message);
+    void enqueue(const TSharedBuffer& message);
+    
+    int32_t processFrame(char* data, size_t size);
+    void onBinaryFramingRequest();
+    
     bool doSend(const std::string& message);
     
     void threadMainSend();
     void threadMainRecv();
     
+    bool checkTimeout(tw::common::THighResTime& timer);
+    
 private:
     // NOTE: size of the messages are limited to 4K for now
     //
@@ -82,12 +118,20 @@ private:
     
 private:
     bool _connected;
+    bool _binary;
+    tw::common_thread::Lock _framingLock;
     tw::common::THighResTime _timeoutTimer;
     
     TThreadPipe _sendQueue;
     tw::common_thread::ThreadPtr _threadSend;
     tw::common_thread::ThreadPtr _threadRecv;
     
+    bool _reactorMode;
+    bool _reactorWriteInterest;
+    tw::common_thread::Lock _reactorLock;
+    TcpIpReactorSendQueue _reactorSendQueue;
+    tw::common::THighResTime _reactorTimer;
+    
     TParent* _parent;
     TBuffer _buffer;
     TSocket _socket;
@@ -4,6 +4,7 @@
 #include <tw/common_thread/utils.h>
 
 #include <tw/common/timer_server.h>
+#include <tw/common/instrumentation.h>
 #include <tw/config/settings_config_file.h>
 #include <tw/instr/instrument_manager.h>
 #include <tw/common_trade/bars_storage.h>
@@ -17,16 +18,30 @@
 #include <tw/channel_or/processor_pnl.h>
 #include <tw/channel_or/pnl_audit_trail.h>
 #include <tw/risk/risk_storage.h>
+#include <tw/common/thread_placement.h>
 
 namespace tw {
 namespace common_strat {
-StrategyContainer::StrategyContainer() : _channelOrProcessorOutManager(tw::channel_or::ChannelOrManager::instance()),
-                                         _channelOrProcessorOutPnL(tw::channel_or::ProcessorPnL::instance(), _channelOrProcessorOutManager),
-                                         _channelOrProcessorOutRisk(tw::channel_or::ProcessorRisk::instance(), _channelOrProcessorOutPnL),
-                                         _channelOrProcessorOutWTP(tw::channel_or::ProcessorWTP::instance(), _channelOrProcessorOutRisk),
-                                         _channelOrProcessorOutThrottle(tw::channel_or::ProcessorThrottle::instance(), _channelOrProcessorOutWTP),
-                                         _channelOrProcessorOutOrders(tw::channel_or::ProcessorOrders::instance(), _channelOrProcessorOutThrottle),
-                                         _channelOrProcessorOut(tw::channel_or::ProcessorMessaging::instance(), _channelOrProcessorOutOrders),
+
+// Records time from sending request to receiving its ack (in nanos)
+//
+static void recordAckLatency(const tw::channel_or::TOrderPtr& order, const tw::common::THighResTime& now) {
+    tw::common::LatencyHistogram& stage = tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kAck);
+    if ( !stage.isEnabled() )
+        return;
+    
+    int64_t delta = now - order->_timestamp1;
+    if ( delta >= 0 )
+        stage.record(delta * 1000);
+}
+
+StrategyContainer::StrategyContainer() : _channelOrProcessorOutManager(tw::channel_or::ChannelOrManager::instance(), "manager"),
+                                         _channelOrProcessorOutPnL(TStagePnL::create(tw::channel_or::ProcessorPnL::instance(), _channelOrProcessorOutManager, "pnl")),
+                                         _channelOrProcessorOutRisk(TStageRisk::create(tw::channel_or::ProcessorRisk::instance(), _channelOrProcessorOutPnL, "risk")),
+                                         _channelOrProcessorOutWTP(TStageWTP::create(tw::channel_or::ProcessorWTP::instance(), _channelOrProcessorOutRisk, "wtp")),
+                                         _channelOrProcessorOutThrottle(TStageThrottle::create(tw::channel_or::ProcessorThrottle::instance(), _channelOrProcessorOutWTP, "throttle")),
+                                         _channelOrProcessorOutOrders(tw::channel_or::ProcessorOrders::instance(), _channelOrProcessorOutThrottle, "orders"),
+                                         _channelOrProcessorOut(TStageMessaging::create(tw::channel_or::ProcessorMessaging::instance(), _channelOrProcessorOutOrders, "messaging")),
                                          _channelOrProcessorInOrders(tw::channel_or::ProcessorOrders::instance()),
                                          _channelOrProcessorInMessaging(tw::channel_or::ProcessorMessaging::instance(), _channelOrProcessorInOrders),
                                          _channelOrProcessorIn(tw::channel_or::ProcessorPnL::instance(), _channelOrProcessorInMessaging) {
@@ -52,6 +67,7 @@ void StrategyContainer::clear() {
         
         _channelPfCme = TChannelPfCmePtr();
         _channelPfHistorical = TChannelPfHistoricalPtr();
+        _channelPfShm = TChannelPfShmPtr();
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
     } catch(...) {
@@ -77,6 +93,14 @@ bool StrategyContainer::init(const tw::common::Settings& settings) {
             throw(_exception);
         }
         
+        // Init threads placement - has to be done before any of
+        // framework's threads (other than logger's) are started
+        //
+        if ( !tw::common::ThreadPlacement::instance().init(settings) ) {
+            _exception << "failed to init threads placement: " << settings.toString() << "\n";
+            throw(_exception);
+        }
+
         // Init timer sever
         //
         if ( !tw::common::TimerServer::instance().init(settings) ) {
@@ -84,6 +108,13 @@ bool StrategyContainer::init(const tw::common::Settings& settings) {
             throw(_exception);
         }
         
+        // Init hot path instrumentation
+        //
+        if ( !tw::common::Instrumentation::instance().init(settings) ) {
+            _exception << "failed to init instrumentation: " << settings.toString() << "\n";
+            throw(_exception);
+        }
+        
         // Register itself with consumer_proxy for timeouts
         //
         tw::common_strat::ConsumerProxy::instance().registerCallbackTimer(this);
@@ -143,10 +174,15 @@ void StrategyContainer::initChannelPfs(const tw::common::Settings& settings) {
     
     // Create/initialize channel_pfs related objects
     //
-    // TODO: right now only channel_pf_cme_onix or channel_pf_historical (cme only for now) is supported
+    // TODO: right now only channel_pf_cme_onix, channel_pf_historical or
+    // channel_pf_shm (cme only for now) is supported
     //
     tw::channel_pf::IChannelImpl* channelImpl = NULL;
-    if ( tw::common::eChannelPfHistoricalMode::kUnknown == settings._channel_pf_historical_mode ) {
+    if ( !settings._channel_pf_shm_name.empty() ) {
+        _channelPfShm = TChannelPfShmPtr(new tw::channel_pf_shm::ChannelPfShm());
+        channelImpl = _channelPfShm.get();
+        LOGGER_INFO << "Using tw::channel_pf_shm::ChannelPfShm() for channel_pf_impl";
+    } else if ( tw::common::eChannelPfHistoricalMode::kUnknown == settings._channel_pf_historical_mode ) {
         _channelPfCme = TChannelPfCmePtr(new tw::channel_pf_cme::ChannelPfOnix());
         channelImpl = _channelPfCme.get();
         LOGGER_INFO << "Using tw::channel_pf_cme::ChannelPfOnix() for channel_pf_impl";
@@ -463,7 +499,7 @@ void  StrategyContainer::stop() {
         if ( _settings._strategy_container_channel_or ) {
             // Cancel all open order
             //
-            _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&StrategyContainer::ThreadMain, this)));
+            _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kStrategyContainer, boost::bind(&StrategyContainer::ThreadMain, this));
             if ( _thread != NULL ) {
                 _thread->join();
                 _thread = tw::common_thread::ThreadPtr();
@@ -486,6 +522,10 @@ void  StrategyContainer::stop() {
                 LOGGER_ERRO << "Failed to stop msgBusServer" << "\n";
         }
         
+        // Stop tcp/ip reactor (if any) once all connections are down
+        //
+        tw::common_comm::TcpIpReactor::instance().stop();
+        
         // Stop risk storage
         //
         tw::risk::RiskStorage::instance().stop();
@@ -494,6 +534,10 @@ void  StrategyContainer::stop() {
         //
         tw::common_trade::BarsStorage::instance().stop();
         
+        // Print/dump instrumentation histograms
+        //
+        tw::common::Instrumentation::instance().stop();
+        
         // Lock for thread synchronization
         //
         tw::common_thread::LockGuard<TLock> lock(_lock);
@@ -627,7 +671,10 @@ bool StrategyContainer::sendNew(const tw::channel_or::TOrderPtr& order, tw::chan
         }
         
         // fix for account risk processor failure observed in ve_alpha on 2014-05-19
-        status = _channelOrProcessorOut.sendNew(order, rej);
+        {
+            tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+            status = _channelOrProcessorOut.sendNew(order, rej);
+        }
         if ( !status )
             order->_client.onNewRej(order, rej);
         
@@ -669,7 +716,10 @@ bool StrategyContainer::sendMod(const tw::channel_or::TOrderPtr& order, tw::chan
             return false;
         }        
         
-        status = _channelOrProcessorOut.sendMod(order, rej);
+        {
+            tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+            status = _channelOrProcessorOut.sendMod(order, rej);
+        }
         if ( !status ) {
             if ( tw::channel_or::eRejectSubType::kProcessorOrders == rej._rejSubType )
                 tw::channel_or::ProcessorOrders::instance().onModRej(order, rej);
@@ -708,7 +758,10 @@ bool StrategyContainer::sendCxl(const tw::channel_or::TOrderPtr& order, tw::chan
         //
         tw::common_thread::LockGuard<TLock> lock(_lock);        
         
-        status = _channelOrProcessorOut.sendCxl(order, rej);
+        {
+            tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+            status = _channelOrProcessorOut.sendCxl(order, rej);
+        }
         if ( !status )
             order->_client.onCxlRej(order, rej);
         
@@ -730,6 +783,148 @@ bool StrategyContainer::sendCxl(const tw::channel_or::TOrderPtr& order, tw::chan
     return status;
 }
 
+void StrategyContainer::sendNew(tw::channel_or::OrdersBatch& batch) {
+    try {
+        if ( batch.empty() )
+            return;
+        
+        tw::common::THighResTime now = tw::common::THighResTime::now();
+        
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        
+        if ( !tw::channel_or::ChannelOrStorage::instance().canPersist() ) {
+            tw::channel_or::Reject rej = getRej();
+            rej._text = "Can't persist request";
+            for ( size_t i = 0; i < batch.size(); ++i ) {
+                batch._rejected[i] = true;
+                batch._rejs[i] = rej;
+            }
+            return;
+        }
+        
+        {
+            tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+            _channelOrProcessorOut.sendNew(batch);
+        }
+        
+        for ( size_t i = 0; i < batch.size(); ++i ) {
+            const tw::channel_or::TOrderPtr& order = batch._orders[i];
+            if ( batch._rejected[i] )
+                order->_client.onNewRej(order, batch._rejs[i]);
+            
+            order->_timestamp1 = now;
+        }
+        
+        tw::channel_or::ChannelOrStorage::instance().persist(batch);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void StrategyContainer::sendMod(tw::channel_or::OrdersBatch& batch) {
+    try {
+        if ( batch.empty() )
+            return;
+        
+        tw::common::THighResTime now = tw::common::THighResTime::now();
+        
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        
+        if ( !tw::channel_or::ChannelOrStorage::instance().canPersist() ) {
+            tw::channel_or::Reject rej = getRej();
+            rej._text = "Can't persist request";
+            for ( size_t i = 0; i < batch.size(); ++i ) {
+                batch._rejected[i] = true;
+                batch._rejs[i] = rej;
+            }
+            return;
+        }
+        
+        {
+            tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+            _channelOrProcessorOut.sendMod(batch);
+        }
+        
+        for ( size_t i = 0; i < batch.size(); ++i ) {
+            const tw::channel_or::TOrderPtr& order = batch._orders[i];
+            if ( batch._rejected[i] ) {
+                const tw::channel_or::Reject& rej = batch._rejs[i];
+                if ( tw::channel_or::eRejectSubType::kProcessorOrders == rej._rejSubType )
+                    tw::channel_or::ProcessorOrders::instance().onModRej(order, rej);
+                
+                order->_client.onModRej(order, rej);
+                tw::channel_or::ProcessorOrders::instance().onModRejPost(order, rej);
+            }
+            
+            order->_timestamp1 = now;
+        }
+        
+        tw::channel_or::ChannelOrStorage::instance().persist(batch);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void StrategyContainer::sendCxl(tw::channel_or::OrdersBatch& batch) {
+    try {
+        // Orders already being cancelled are skipped, same as in single
+        // order's sendCxl()
+        //
+        tw::channel_or::OrdersBatch cxls;
+        for ( size_t i = 0; i < batch.size(); ++i ) {
+            if ( tw::channel_or::eOrderState::kCancelling != batch._orders[i]->_state )
+                cxls.add(batch._orders[i]);
+        }
+        
+        if ( cxls.empty() )
+            return;
+        
+        tw::common::THighResTime now = tw::common::THighResTime::now();
+        
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        
+        {
+            tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+            _channelOrProcessorOut.sendCxl(cxls);
+        }
+        
+        for ( size_t i = 0; i < cxls.size(); ++i ) {
+            const tw::channel_or::TOrderPtr& order = cxls._orders[i];
+            if ( cxls._rejected[i] )
+                order->_client.onCxlRej(order, cxls._rejs[i]);
+            
+            order->_timestamp1 = now;
+        }
+        
+        tw::channel_or::ChannelOrStorage::instance().persist(cxls);
+        
+        // Copy results back for orders which were sent
+        //
+        for ( size_t i = 0, j = 0; i < batch.size() && j < cxls.size(); ++i ) {
+            if ( batch._orders[i] != cxls._orders[j] )
+                continue;
+            
+            batch._rejected[i] = cxls._rejected[j];
+            batch._rejs[i] = cxls._rejs[j];
+            ++j;
+        }
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
 bool StrategyContainer::rebuildOrder(const tw::channel_or::TOrderPtr& order, tw::channel_or::Reject& rej) {
     // Not implemented - nothing to do
     //
@@ -804,13 +999,15 @@ void StrategyContainer::sendCxlForBatch(const tw::channel_or::TOrders& orders, c
         //
         tw::common_thread::LockGuard<TLock> lock(_lock);
         
+        tw::channel_or::OrdersBatch batch;
         tw::channel_or::TOrders::const_iterator iter = orders.begin();
         tw::channel_or::TOrders::const_iterator end = orders.end();
-        tw::channel_or::Reject rej;
         for ( ; iter != end; ++iter ) {
             (*iter)->_stratReason = reason;
-            sendCxl(*iter, rej);            
+            batch.add(*iter);
         }
+        
+        sendCxl(batch);
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
     } catch(...) {
@@ -952,7 +1149,7 @@ inline void StrategyContainer::onAlert(const tw::channel_or::Alert& alert) {
         cmnd._type = tw::common::eCommandType::kChannelOr;
         cmnd._subType = tw::common::eCommandSubType::kAlert;
 
-        tw::common_strat::StrategyContainer::instance().sendToAllMsgBusConnections(cmnd.toString()+"\n");
+        tw::common_strat::StrategyContainer::instance().sendToAllMsgBusConnections(cmnd);
         LOGGER_WARN << "Send alert: "  << alert.toString() << "\n";
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -969,6 +1166,7 @@ inline void StrategyContainer::onNewAck(tw::channel_or::TOrderPtr& order, const
         {
             // Mark order timers
             //
+            recordAckLatency(order, now);
             tw::common::THighResTimeScope orderTimer(now, order->_timestamp2, order->_timestamp3);
         }
         
@@ -1009,6 +1207,7 @@ inline void StrategyContainer::onModAck(tw::channel_or::TOrderPtr& order, const
         {
             // Mark order timers
             //
+            recordAckLatency(order, now);
             tw::common::THighResTimeScope orderTimer(now, order->_timestamp2, order->_timestamp3);
         }
 
@@ -1050,6 +1249,7 @@ inline void StrategyContainer::onCxlAck(tw::channel_or::TOrderPtr& order, const
         {
             // Mark order timers
             //
+            recordAckLatency(order, now);
             tw::common::THighResTimeScope orderTimer(now, order->_timestamp2, order->_timestamp3);
         }
         
@@ -1147,13 +1347,6 @@ void StrategyContainer::onConnectionDown(TConnection::native_type id) {
 
 void StrategyContainer::onConnectionData(TConnection::native_type id, const std::string& message) {
     try {
-        // Lock for thread synchronization
-        //
-        tw::common_thread::LockGuard<TLock> lock(_lock);
-        
-        // TODO: right now all commands are being passed to strategy(ies) - need to
-        // partition command better later
-        //
         if ( _settings._trading_verbose )
             LOGGER_INFO << "raw command = " << message << "\n";
         
@@ -1164,6 +1357,45 @@ void StrategyContainer::onConnectionData(TConnection::native_type id, const std:
         }
         cmnd._connectionId = id;
         
+        processMsgBusCommand(cmnd);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void StrategyContainer::onConnectionFrame(TConnection::native_type id, const char* data, size_t size) {
+    try {
+        tw::common::Command cmnd;
+        if ( !cmnd.fromBinary(data, size) ) {
+            LOGGER_ERRO << "Not a valid binary command from: " << id << " :: size=" << size << "\n";
+            return;
+        }
+        cmnd._connectionId = id;
+        
+        if ( _settings._trading_verbose )
+            LOGGER_INFO << "binary command = " << cmnd.toString() << "\n";
+        
+        processMsgBusCommand(cmnd);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void StrategyContainer::processMsgBusCommand(tw::common::Command& cmnd) {
+    try {
+        // Lock for thread synchronization
+        //
+        tw::common_thread::LockGuard<TLock> lock(_lock);
+        
+        // TODO: right now all commands are being passed to strategy(ies) - need to
+        // partition command better later
+        //
+        TConnection::native_type id = cmnd._connectionId;
+        
         // Persist to database
         //
         if ( _settings._strategy_container_channel_or )
@@ -1172,7 +1404,11 @@ void StrategyContainer::onConnectionData(TConnection::native_type id, const std:
         switch ( cmnd._type ) {
             case tw::common::eCommandType::kQuoteStore:
                 if ( tw::price::QuoteStore::instance().processCommand(cmnd) )
-                    sendToMsgBusConnection(id, cmnd.toString()+"\n");
+                    sendToMsgBusConnection(id, cmnd);
+                break;
+            case tw::common::eCommandType::kInstrumentation:
+                if ( tw::common::Instrumentation::instance().processCommand(cmnd) )
+                    sendToMsgBusConnection(id, cmnd);
                 break;
             case tw::common::eCommandType::kChannelPf:                
             {
@@ -1339,6 +1575,32 @@ void StrategyContainer::sendToAllMsgBusConnections(const std::string& message) {
     }
 }
 
+void StrategyContainer::sendToMsgBusConnection(TConnection::native_type id, const tw::common::Command& cmnd) {
+    try {
+        if ( _msgBusServer.isBinary(id) )
+            _msgBusServer.sendFrameToConnection(id, tw::common_comm::makeSharedBuffer(cmnd.toBinary()));
+        else
+            _msgBusServer.sendToConnection(id, cmnd.toString()+"\n");
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
+void StrategyContainer::sendToAllMsgBusConnections(const tw::common::Command& cmnd) {
+    try {
+        // NOTE: each encoding is done at most once regardless of number of
+        // connections and only if a connection of its framing exists
+        //
+        _msgBusServer.sendToAllEncoded(cmnd);
+    } catch(const std::exception& e) {
+        LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
+    } catch(...) {
+        LOGGER_ERRO << "Exception: UNKNOWN" << "\n" << "\n";
+    }
+}
+
 void StrategyContainer::ThreadMain() {
     LOGGER_INFO << "Started cancelling open orders" << "\n";
     
@@ -13,6 +13,7 @@
 #include <tw/channel_pf/channel.h>
 #include <tw/channel_pf_cme/channel_pf_onix.h>
 #include <tw/channel_pf_historical/channel_pf_historical.h>
+#include <tw/channel_pf_shm/channel_pf_shm.h>
 #include <tw/channel_or/processor.h>
 #include <tw/channel_or/processor_orders.h>
 #include <tw/channel_or/processor_wtp.h>
@@ -25,6 +26,40 @@
 #include <map>
 #include <vector>
 
+// Optional ProcessorOut stages can be compiled out per deployment with
+// -DTW_PROCESSOR_OUT_DISABLE_<STAGE> (see TW_PROCESSORS_OUT_DISABLED in
+// Makefile)
+//
+#ifdef TW_PROCESSOR_OUT_DISABLE_MESSAGING
+#define TW_PROCESSOR_OUT_MESSAGING false
+#else
+#define TW_PROCESSOR_OUT_MESSAGING true
+#endif
+
+#ifdef TW_PROCESSOR_OUT_DISABLE_THROTTLE
+#define TW_PROCESSOR_OUT_THROTTLE false
+#else
+#define TW_PROCESSOR_OUT_THROTTLE true
+#endif
+
+#ifdef TW_PROCESSOR_OUT_DISABLE_WTP
+#define TW_PROCESSOR_OUT_WTP false
+#else
+#define TW_PROCESSOR_OUT_WTP true
+#endif
+
+#ifdef TW_PROCESSOR_OUT_DISABLE_RISK
+#define TW_PROCESSOR_OUT_RISK false
+#else
+#define TW_PROCESSOR_OUT_RISK true
+#endif
+
+#ifdef TW_PROCESSOR_OUT_DISABLE_PNL
+#define TW_PROCESSOR_OUT_PNL false
+#else
+#define TW_PROCESSOR_OUT_PNL true
+#endif
+
 namespace tw {
 namespace common_strat {
     
@@ -38,6 +73,7 @@ class StrategyContainer : public tw::common::Singleton<StrategyContainer>,
     typedef std::map<tw::instr::eExchange::_ENUM, TChannelPfPtr> TChannelsPf;        
     typedef boost::shared_ptr<tw::channel_pf_cme::ChannelPfOnix> TChannelPfCmePtr;
     typedef boost::shared_ptr<tw::channel_pf_historical::ChannelPfHistorical> TChannelPfHistoricalPtr;
+    typedef boost::shared_ptr<tw::channel_pf_shm::ChannelPfShm> TChannelPfShmPtr;
     
 public:
     enum eState {
@@ -75,8 +111,20 @@ public:
     virtual void onConnectionDown(TConnection::native_type id);    
     virtual void onConnectionData(TConnection::native_type id, const std::string& message);
     
+    virtual bool isBinaryFramingSupported() const {
+        return true;
+    }
+    
+    virtual void onConnectionFrame(TConnection::native_type id, const char* data, size_t size);
+    
     void sendToMsgBusConnection(TConnection::native_type id, const std::string& message);    
     void sendToAllMsgBusConnections(const std::string& message);
+    
+    // NOTE: commands are encoded according to connection's negotiated framing
+    // (text or binary) and encoded only once for all connections
+    //
+    void sendToMsgBusConnection(TConnection::native_type id, const tw::common::Command& cmnd);
+    void sendToAllMsgBusConnections(const tw::common::Command& cmnd);
 
 public:
     // Method to communicate commands between strategies
@@ -284,6 +332,14 @@ public:
     bool sendMod(const tw::channel_or::TOrderPtr& order, tw::channel_or::Reject& rej);    
     bool sendCxl(const tw::channel_or::TOrderPtr& order, tw::channel_or::Reject& rej);
     
+    // Batch requests - orders go through processors' chain one after
+    // another under one lock and are persisted as one batch, results and
+    // clients' reject notifications are the same as for single requests
+    //
+    void sendNew(tw::channel_or::OrdersBatch& batch);
+    void sendMod(tw::channel_or::OrdersBatch& batch);
+    void sendCxl(tw::channel_or::OrdersBatch& batch);
+    
     bool rebuildOrder(const tw::channel_or::TOrderPtr& order, tw::channel_or::Reject& rej);
     
 public:
@@ -371,6 +427,7 @@ private:
 private:
     void ThreadMain();
     void processExternalFill(const tw::common::Command& cmnd);
+    void processMsgBusCommand(tw::common::Command& cmnd);
     
     IStrategy* getStrategy(const tw::channel_or::TStrategyId& strategyId) const {
         TStrategies::const_iterator iter = _strategies.begin();
@@ -388,13 +445,21 @@ private:
     // NOTE: the order of template initialization is from last channel_or_processor
     // to first one
     //
+    // Optional stages (see TW_PROCESSOR_OUT_* above) are compiled out of
+    // the chain, ProcessorIn chain is not affected
+    //
     typedef tw::channel_or::ProcessorOut<tw::channel_or::ChannelOrManager> TProcessorOutChannelOrManager;
-    typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorPnL, TProcessorOutChannelOrManager> TProcessorOutPnL;
-    typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorRisk, TProcessorOutPnL> TProcessorOutRisk;
-    typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorWTP, TProcessorOutRisk> TProcessorOutWTP;
-    typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorThrottle, TProcessorOutWTP> TProcessorOutThrottle;
+    typedef tw::channel_or::ProcessorOutStage<TW_PROCESSOR_OUT_PNL, tw::channel_or::ProcessorPnL, TProcessorOutChannelOrManager> TStagePnL;
+    typedef TStagePnL::TType TProcessorOutPnL;
+    typedef tw::channel_or::ProcessorOutStage<TW_PROCESSOR_OUT_RISK, tw::channel_or::ProcessorRisk, TProcessorOutPnL> TStageRisk;
+    typedef TStageRisk::TType TProcessorOutRisk;
+    typedef tw::channel_or::ProcessorOutStage<TW_PROCESSOR_OUT_WTP, tw::channel_or::ProcessorWTP, TProcessorOutRisk> TStageWTP;
+    typedef TStageWTP::TType TProcessorOutWTP;
+    typedef tw::channel_or::ProcessorOutStage<TW_PROCESSOR_OUT_THROTTLE, tw::channel_or::ProcessorThrottle, TProcessorOutWTP> TStageThrottle;
+    typedef TStageThrottle::TType TProcessorOutThrottle;
     typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorOrders, TProcessorOutThrottle> TProcessorOutOrders;
-    typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorMessaging, TProcessorOutOrders> TProcessorOut;
+    typedef tw::channel_or::ProcessorOutStage<TW_PROCESSOR_OUT_MESSAGING, tw::channel_or::ProcessorMessaging, TProcessorOutOrders> TStageMessaging;
+    typedef TStageMessaging::TType TProcessorOut;
     
     typedef tw::channel_or::ProcessorIn<tw::channel_or::ProcessorOrders> TProcessorInOrders;
     typedef tw::channel_or::ProcessorIn<tw::channel_or::ProcessorMessaging, TProcessorInOrders> TProcessorInMessaging;
@@ -411,6 +476,7 @@ private:
     
     TChannelPfCmePtr _channelPfCme;
     TChannelPfHistoricalPtr _channelPfHistorical;
+    TChannelPfShmPtr _channelPfShm;
     TStrategies _strategies;
     TChannelsPf _channelsPfs;
     
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <tw/common_thread/thread.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+#include <stdint.h>
+
+namespace tw {
+namespace common_thread {
+
+// Preallocated bounded ring buffer (disruptor style - see thread_pipe.h)
+// for multiple producers and a single consumer. Values are written/read
+// in place in ring's slots, so slots can keep their resources (e.g.
+// strings' capacity) between uses
+//
+// Producer:
+//      TValue* slot = ring.claim(pos);
+//      if ( slot ) {
+//          ...fill *slot...
+//          ring.publish(pos);
+//      }
+//
+// Consumer:
+//      TValue* slot = ring.front();
+//      if ( slot ) {
+//          ...read *slot...
+//          ring.pop();
+//      }
+//
+// NOTE: relies on x86's ordering of stores/loads - only compiler
+// barriers are used
+//
+template <typename TValue>
+class RingBuffer : private boost::noncopyable {
+    struct Slot {
+        volatile uint64_t _seq;
+        TValue _value;
+    };
+
+public:
+    RingBuffer() : _mask(0),
+                   _enqueuePos(0),
+                   _dequeuePos(0) {
+    }
+
+    // Capacity is rounded up to power of 2
+    //
+    void init(uint32_t capacity) {
+        uint64_t size = 2;
+        while ( size < capacity )
+            size <<= 1;
+
+        _slots.clear();
+        _slots.resize(size);
+        for ( uint64_t i = 0; i < size; ++i )
+            _slots[i]._seq = i;
+
+        _mask = size-1;
+        _enqueuePos = 0;
+        _dequeuePos = 0;
+    }
+
+    size_t capacity() const {
+        return _slots.size();
+    }
+
+    size_t size() const {
+        uint64_t enqueuePos = _enqueuePos;
+        uint64_t dequeuePos = _dequeuePos;
+        return (enqueuePos > dequeuePos) ? static_cast<size_t>(enqueuePos-dequeuePos) : 0;
+    }
+
+    bool empty() const {
+        return (0 == size());
+    }
+
+public:
+    // Returns slot to be filled by producer or NULL if ring is full
+    //
+    TValue* claim(uint64_t& pos) {
+        pos = _enqueuePos;
+        while ( true ) {
+            Slot& slot = _slots[pos & _mask];
+            barrier();
+            int64_t diff = static_cast<int64_t>(slot._seq - pos);
+            if ( 0 == diff ) {
+                uint64_t prev = __sync_val_compare_and_swap(&_enqueuePos, pos, pos+1);
+                if ( prev == pos )
+                    return &(slot._value);
+
+                pos = prev;
+            } else if ( diff < 0 ) {
+                return NULL;
+            } else {
+                pos = _enqueuePos;
+            }
+        }
+
+        return NULL;
+    }
+
+    // Makes claimed slot visible to consumer
+    //
+    void publish(uint64_t pos) {
+        barrier();
+        _slots[pos & _mask]._seq = pos+1;
+    }
+
+    // Returns next published slot or NULL if there is none
+    //
+    TValue* front() {
+        Slot& slot = _slots[_dequeuePos & _mask];
+        if ( slot._seq != _dequeuePos+1 )
+            return NULL;
+
+        barrier();
+        return &(slot._value);
+    }
+
+    // Releases slot returned by front() back to producers
+    //
+    void pop() {
+        barrier();
+        _slots[_dequeuePos & _mask]._seq = _dequeuePos+_mask+1;
+        _dequeuePos = _dequeuePos+1;
+    }
+
+private:
+    static void barrier() {
+        __asm__ __volatile__("" ::: "memory");
+    }
+
+private:
+    std::vector<Slot> _slots;
+    uint64_t _mask;
+
+    // Producers' and consumer's positions are kept on separate cache lines
+    //
+    char _pad1[64];
+    volatile uint64_t _enqueuePos;
+    char _pad2[64];
+    volatile uint64_t _dequeuePos;
+    char _pad3[64];
+};
+
+} // common_thread
+} // tw
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <stdint.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace tw {
+namespace common_thread {
+
+// Single writer/multiple readers ring buffer in named POSIX shared memory
+// segment (/dev/shm/<name>), for fanning out fixed size records (e.g.
+// quotes) from one process to any number of other processes
+//
+// Writer never waits for readers - each reader keeps its own position and
+// detects when writer has lapped it (overrun), in which case it skips to
+// writer's current position. Each slot has a sequence number, which is
+// reset by writer before slot is overwritten, so reader validates slot's
+// sequence before and after copying the value out (seqlock style)
+//
+// Writer:
+//      ring.create("name", capacity);
+//      ring.write(value);
+//
+// Reader:
+//      ring.attach("name");
+//      switch ( ring.read(value) ) {
+//          case TRing::kSuccess:   ...process value...
+//          case TRing::kEmpty:     ...nothing new...
+//          case TRing::kOverrun:   ...records were lost...
+//      }
+//
+// NOTE: TValue is copied in/out with assignment and must not own any
+// resources (pointers aren't valid across processes). Writer and readers
+// must be built with the same TValue layout - segment's header keeps
+// sizeof(TValue) to catch obvious mismatches
+//
+// NOTE: relies on x86's ordering of stores/loads - only compiler
+// barriers are used
+//
+template <typename TValue>
+class ShmRing : private boost::noncopyable {
+    static const uint64_t MAGIC = 0x5457534852494E47ULL;
+
+    struct Header {
+        uint64_t _magic;
+        uint64_t _valueSize;
+        uint64_t _capacity;
+        char _pad1[40];
+        volatile uint64_t _writePos;
+        char _pad2[56];
+    };
+
+    struct Slot {
+        volatile uint64_t _seq;
+        TValue _value;
+    };
+
+public:
+    static const uint32_t ATTACH_RETRY_READS = 4096;
+
+    enum eReadStatus {
+        kEmpty = 0,
+        kSuccess = 1,
+        kOverrun = 2
+    };
+
+public:
+    ShmRing() : _name(),
+                _header(NULL),
+                _slots(NULL),
+                _length(0),
+                _mask(0),
+                _pos(0),
+                _overruns(0),
+                _attachRetries(0) {
+    }
+
+    ~ShmRing() {
+        close();
+    }
+
+public:
+    // Creates (or reopens) segment for writing. Capacity is rounded up
+    // to power of 2. Reopened segment with the same geometry keeps its
+    // position, so that attached readers can continue after writer's
+    // restart. Segment of different geometry is never resized in place
+    // (readers, which still have it mapped, would fault on truncated
+    // pages) - it's marked as stale, unlinked and a new one is created,
+    // while readers keep their mappings of the old one until they
+    // re-attach
+    //
+    bool create(const std::string& name, uint32_t capacity) {
+        close();
+
+        uint64_t size = 2;
+        while ( size < capacity )
+            size <<= 1;
+
+        size_t length = sizeof(Header)+size*sizeof(Slot);
+        if ( open(name, O_RDWR, 0) ) {
+            if ( length == _length && MAGIC == _header->_magic && sizeof(TValue) == _header->_valueSize && size == _header->_capacity ) {
+                _mask = size-1;
+                _pos = _header->_writePos;
+                return true;
+            }
+
+            _header->_magic = 0;
+            close();
+        }
+
+        ::shm_unlink(name.c_str());
+        if ( !open(name, O_CREAT | O_EXCL | O_RDWR, length) )
+            return false;
+
+        _mask = size-1;
+
+        for ( uint64_t i = 0; i < size; ++i )
+            _slots[i]._seq = 0;
+
+        _header->_valueSize = sizeof(TValue);
+        _header->_capacity = size;
+        _header->_writePos = 0;
+        barrier();
+        _header->_magic = MAGIC;
+
+        _pos = 0;
+        return true;
+    }
+
+    // Attaches to existing segment for reading, starting from writer's
+    // current position. If segment isn't there (or not initialized) yet,
+    // read() keeps retrying to attach to it, at most once per
+    // ATTACH_RETRY_READS calls, so that busy polling reader doesn't make
+    // shm_open() syscall on every poll
+    //
+    bool attach(const std::string& name) {
+        close();
+
+        bool status = open(name, O_RDONLY, 0);
+        if ( status && (MAGIC != _header->_magic || sizeof(TValue) != _header->_valueSize || _length < sizeof(Header)+_header->_capacity*sizeof(Slot)) ) {
+            close();
+            status = false;
+        }
+
+        _name = name;
+        if ( !status )
+            return false;
+
+        _mask = _header->_capacity-1;
+        _pos = _header->_writePos;
+        _attachRetries = 0;
+        return true;
+    }
+
+    void close() {
+        if ( NULL != _header )
+            ::munmap(_header, _length);
+
+        _name.clear();
+        _header = NULL;
+        _slots = NULL;
+        _length = 0;
+        _mask = 0;
+        _pos = 0;
+        _overruns = 0;
+    }
+
+    // Removes segment's name - attached readers keep their mappings
+    //
+    static bool remove(const std::string& name) {
+        return (0 == ::shm_unlink(name.c_str()));
+    }
+
+public:
+    bool isOpen() const {
+        return (NULL != _header);
+    }
+
+    size_t capacity() const {
+        return isOpen() ? static_cast<size_t>(_mask+1) : 0;
+    }
+
+    // Number of records reader is behind writer
+    //
+    uint64_t lag() const {
+        if ( !isOpen() )
+            return 0;
+
+        uint64_t writePos = _header->_writePos;
+        return (writePos > _pos) ? (writePos-_pos) : 0;
+    }
+
+    // Number of records reader lost due to overruns
+    //
+    uint64_t overruns() const {
+        return _overruns;
+    }
+
+public:
+    // Writer's methods
+    //
+    void write(const TValue& value) {
+        Slot& slot = _slots[_pos & _mask];
+        slot._seq = 0;
+        barrier();
+        slot._value = value;
+        barrier();
+        slot._seq = _pos+1;
+        _header->_writePos = ++_pos;
+    }
+
+public:
+    // Reader's methods
+    //
+    eReadStatus read(TValue& value) {
+        if ( !isOpen() ) {
+            if ( !_name.empty() && 0 == (_attachRetries++ % ATTACH_RETRY_READS) )
+                attach(std::string(_name));
+
+            return kEmpty;
+        }
+
+        if ( MAGIC != _header->_magic )
+            return reattach();
+
+        uint64_t writePos = _header->_writePos;
+        if ( writePos == _pos )
+            return kEmpty;
+
+        if ( writePos < _pos )
+            return reattach();
+
+        if ( writePos-_pos > _mask+1 )
+            return skip(writePos);
+
+        barrier();
+        const Slot& slot = _slots[_pos & _mask];
+        uint64_t seq = slot._seq;
+        if ( seq != _pos+1 )
+            return skip(_header->_writePos);
+
+        barrier();
+        value = slot._value;
+        barrier();
+
+        if ( seq != slot._seq )
+            return skip(_header->_writePos);
+
+        ++_pos;
+        return kSuccess;
+    }
+
+private:
+    // Writer has recreated segment (possibly of different size) - reader
+    // maps the new one and continues from writer's position
+    //
+    eReadStatus reattach() {
+        uint64_t overruns = _overruns+1;
+        attach(std::string(_name));
+
+        _overruns = overruns;
+        return kOverrun;
+    }
+
+    eReadStatus skip(uint64_t writePos) {
+        _overruns += (writePos > _pos) ? (writePos-_pos) : 1;
+        _pos = writePos;
+        return kOverrun;
+    }
+
+    // Maps segment - new segment (O_CREAT) is sized to length, existing
+    // one is mapped as a whole
+    //
+    bool open(const std::string& name, int flags, size_t length) {
+        int fd = ::shm_open(name.c_str(), flags, 0666);
+        if ( -1 == fd )
+            return false;
+
+        struct stat info;
+        if ( flags & O_CREAT ) {
+            if ( 0 != ::ftruncate(fd, length) ) {
+                ::close(fd);
+                return false;
+            }
+        } else {
+            if ( 0 != ::fstat(fd, &info) || static_cast<size_t>(info.st_size) < sizeof(Header) ) {
+                ::close(fd);
+                return false;
+            }
+
+            length = static_cast<size_t>(info.st_size);
+        }
+
+        bool isWriter = (O_RDWR == (flags & O_ACCMODE));
+        void* address = ::mmap(NULL, length, isWriter ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if ( MAP_FAILED == address )
+            return false;
+
+        _header = reinterpret_cast<Header*>(address);
+        _slots = reinterpret_cast<Slot*>(reinterpret_cast<char*>(address)+sizeof(Header));
+        _length = length;
+        return true;
+    }
+
+    static void barrier() {
+        __asm__ __volatile__("" ::: "memory");
+    }
+
+private:
+    std::string _name;
+    Header* _header;
+    Slot* _slots;
+    size_t _length;
+    uint64_t _mask;
+    uint64_t _pos;
+    uint64_t _overruns;
+    uint32_t _attachRetries;
+};
+
+} // common_thread
+} // tw
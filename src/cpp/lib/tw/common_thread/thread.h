@@ -8,6 +8,17 @@ namespace common_thread {
     typedef boost::thread Thread;
     typedef boost::shared_ptr<Thread> ThreadPtr;
     
+    // Wait mode of current thread (set by tw::common::ThreadPlacement) -
+    // busy polling thread spins instead of blocking in ThreadPipe::read()
+    //
+    inline bool& currentThreadBusyPoll() {
+        static __thread bool busyPoll = false;
+        return busyPoll;
+    }
+    
+    inline void cpuRelax() {
+        __asm__ __volatile__("pause" ::: "memory");
+    }
+    
 } // common_thread
 } // tw
-
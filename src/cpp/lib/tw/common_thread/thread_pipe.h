@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tw/common_thread/locks.h>
+#include <tw/common_thread/thread.h>
 
 #include <deque>
 
@@ -121,6 +122,11 @@ public:
     }
     
     void read(TValue& value, bool remove=true) {
+        if ( currentThreadBusyPoll() ) {
+            spinRead(value, remove);
+            return;
+        }
+        
         TLockGuard lock(_lock);
         while ( !_isDone && _container.empty() ) {
             wait(lock);
@@ -141,6 +147,26 @@ public:
     }
 
 private:
+    // Busy polling read - never sleeps on the event, so wake up latency
+    // is not paid by reader thread pinned to its own core
+    //
+    void spinRead(TValue& value, bool remove) {
+        while ( true ) {
+            {
+                TLockGuard lock(_lock);
+                if ( !_container.empty() ) {
+                    getValue(value, remove);
+                    return;
+                }
+                
+                if ( _isDone )
+                    return;
+            }
+            
+            cpuRelax();
+        }
+    }
+    
     void getValue(TValue& value, bool remove=true) {
          value = _container.front();
          if ( remove )
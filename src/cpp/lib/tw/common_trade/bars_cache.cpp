@@ -0,0 +1,251 @@
+#include <tw/common_trade/bars_cache.h>
+#include <tw/log/defs.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdlib.h>
+
+namespace tw {
+namespace common_trade {
+
+static std::string joinIndexes(const std::vector<uint32_t>& indexes) {
+    std::string s;
+    for ( size_t i = 0; i < indexes.size(); ++i ) {
+        if ( i > 0 )
+            s += ",";
+
+        s += boost::lexical_cast<std::string>(indexes[i]);
+    }
+
+    return s;
+}
+
+static void splitIndexes(const std::string& s, std::vector<uint32_t>& indexes) {
+    indexes.clear();
+
+    const char* p = s.c_str();
+    while ( *p ) {
+        char* end = NULL;
+        indexes.push_back(static_cast<uint32_t>(::strtoul(p, &end, 10)));
+        if ( end == p )
+            break;
+
+        p = (',' == *end) ? end+1 : end;
+    }
+}
+
+// class BarsCache
+//
+BarsCache::BarsCache() : _barLength(0),
+                         _run(0) {
+}
+
+bool BarsCache::open(const std::string& dir, uint32_t barLength, int32_t simpleHitchMaxBars, uint32_t atrNumOfPeriods) {
+    if ( 0 == barLength ) {
+        LOGGER_ERRO << "0 == barLength" << "\n";
+        return false;
+    }
+
+    std::string suffix = boost::lexical_cast<std::string>(barLength)
+                         + "_" + boost::lexical_cast<std::string>(simpleHitchMaxBars)
+                         + "_" + boost::lexical_cast<std::string>(atrNumOfPeriods);
+
+    _barsTable = "BarsCache_" + suffix;
+    _patternsTable = "BarsPatternsCache_" + suffix;
+    _barLength = barLength;
+    _run = tw::common::StoreTime::toMicros(tw::common::THighResTime::now());
+    _bars.clear();
+    _patterns.clear();
+
+    return _store.open(dir);
+}
+
+bool BarsCache::restore(TInstrumentsCache& cache) {
+    cache.clear();
+    if ( !isOpen() )
+        return false;
+
+    // Find the latest run other than this one
+    //
+    int64_t now = tw::common::StoreTime::toMicros(tw::common::THighResTime::now());
+
+    tw::common::StoreFilter filterRuns;
+    filterRuns.setTimeRange("timestamp", now-tw::common::StoreTime::kMicrosInDay, now);
+
+    std::vector<int64_t> runs;
+    if ( !_store.readColumn(_barsTable, filterRuns, "run", runs) ) {
+        LOGGER_ERRO << "Failed to read runs of: " << _barsTable << "\n";
+        return false;
+    }
+
+    int64_t run = 0;
+    for ( size_t i = 0; i < runs.size(); ++i ) {
+        if ( runs[i] != _run && runs[i] > run )
+            run = runs[i];
+    }
+
+    if ( 0 == run )
+        return true;
+
+    tw::common::StoreFilter filter;
+    filter.setTimeRange("timestamp", run, std::numeric_limits<int64_t>::max());
+    filter.addEquals("run", run);
+
+    std::vector<BarsCacheBar> bars;
+    if ( !_store.read(_barsTable, filter, bars) ) {
+        LOGGER_ERRO << "Failed to read: " << _barsTable << "\n";
+        return false;
+    }
+
+    for ( size_t i = 0; i < bars.size(); ++i ) {
+        TBars& instrumentBars = cache[bars[i]._instrumentId]._bars;
+        instrumentBars.push_back(bars[i]._bar);
+        instrumentBars.back()._instrument = tw::instr::InstrumentManager::instance().getByKeyId(bars[i]._instrumentId);
+    }
+
+    std::vector<BarsCachePattern> patterns;
+    if ( !_store.read(_patternsTable, filter, patterns) ) {
+        LOGGER_ERRO << "Failed to read: " << _patternsTable << "\n";
+        return false;
+    }
+
+    restoreCheckpoints(patterns, cache);
+
+    // Historical data of intervals after the last cached bar is still
+    // needed to rebuild bars which weren't formed before restart
+    //
+    const int64_t interval = static_cast<int64_t>(_barLength)*1000000LL;
+    TInstrumentsCache::iterator iter = cache.begin();
+    TInstrumentsCache::iterator end = cache.end();
+    for ( ; iter != end; ++iter ) {
+        const tw::common::THighResTime& last = iter->second._bars.back()._open_timestamp;
+        if ( !last.isValid() )
+            continue;
+
+        int64_t fromMidnight = static_cast<int64_t>(last.getUnitsFromMidnight(tw::common::eHighResTimeUnits::kUsecs));
+        iter->second._tailFrom = tw::common::StoreTime::fromMicros(tw::common::StoreTime::toMicros(last) - fromMidnight%interval + interval);
+    }
+
+    return true;
+}
+
+void BarsCache::erase(TInstrumentCache& cache, size_t count) {
+    if ( 0 == count )
+        return;
+
+    count = std::min(count, cache._bars.size());
+    cache._bars.erase(cache._bars.begin(), cache._bars.begin()+count);
+    cache._checkpoint.clear();
+}
+
+void BarsCache::restoreCheckpoints(const std::vector<BarsCachePattern>& rows, TInstrumentsCache& cache) {
+    for ( size_t i = 0; i < rows.size(); ++i ) {
+        const BarsCachePattern& row = rows[i];
+
+        TInstrumentsCache::iterator iter = cache.find(row._instrumentId);
+        if ( iter == cache.end() || row._barsCount > iter->second._bars.size() )
+            continue;
+
+        // Rows are in order of appends - the latest checkpoint wins
+        //
+        TCheckpoint& checkpoint = iter->second._checkpoint;
+        if ( row._barsCount != checkpoint._barsCount ) {
+            checkpoint.clear();
+            checkpoint._barsCount = row._barsCount;
+        }
+
+        TBarPatterns* patterns = NULL;
+        switch ( row._pattern._parentType ) {
+            case ePatternsType::kSimple:
+                patterns = &checkpoint._simple;
+                break;
+            case ePatternsType::kSwingLevel1:
+                patterns = &checkpoint._swingLevel1;
+                break;
+            case ePatternsType::kSwingLevel2:
+                patterns = &checkpoint._swingLevel2;
+                break;
+            default:
+                break;
+        }
+
+        if ( !patterns )
+            continue;
+
+        patterns->push_back(row._pattern);
+
+        BarPattern& pattern = patterns->back();
+        pattern._instrument = iter->second._bars.back()._instrument;
+        splitIndexes(row._trendSwingIndexes, pattern._trendSwingIndexes);
+        splitIndexes(row._counterTrendSwingIndexes, pattern._counterTrendSwingIndexes);
+    }
+}
+
+void BarsCache::add(const TKeyId& x, const Bar& bar) {
+    _bars.push_back(BarsCacheBar());
+
+    BarsCacheBar& row = _bars.back();
+    row._run = _run;
+    row._instrumentId = x;
+    row._bar = bar;
+}
+
+void BarsCache::addCheckpoint(const TKeyId& x, uint32_t barsCount, const TBarPatterns& simple, const TBarPatterns& swingLevel1, const TBarPatterns& swingLevel2) {
+    _patterns.push_back(BarsCachePattern());
+
+    BarsCachePattern& row = _patterns.back();
+    row._run = _run;
+    row._instrumentId = x;
+    row._barsCount = barsCount;
+
+    addPatterns(x, barsCount, simple);
+    addPatterns(x, barsCount, swingLevel1);
+    addPatterns(x, barsCount, swingLevel2);
+}
+
+void BarsCache::addPatterns(const TKeyId& x, uint32_t barsCount, const TBarPatterns& patterns) {
+    for ( size_t i = 0; i < patterns.size(); ++i ) {
+        _patterns.push_back(BarsCachePattern());
+
+        BarsCachePattern& row = _patterns.back();
+        row._run = _run;
+        row._instrumentId = x;
+        row._barsCount = barsCount;
+        row._pattern = patterns[i];
+        row._trendSwingIndexes = joinIndexes(patterns[i]._trendSwingIndexes);
+        row._counterTrendSwingIndexes = joinIndexes(patterns[i]._counterTrendSwingIndexes);
+    }
+}
+
+bool BarsCache::flush() {
+    if ( !isOpen() )
+        return false;
+
+    tw::common::THighResTime now = tw::common::THighResTime::now();
+    for ( size_t i = 0; i < _bars.size(); ++i )
+        _bars[i]._timestamp = now;
+
+    for ( size_t i = 0; i < _patterns.size(); ++i )
+        _patterns[i]._timestamp = now;
+
+    // Bars go first, so that checkpoint is never ahead of bars
+    //
+    bool status = true;
+    if ( !_store.append(_barsTable, "timestamp", _bars) ) {
+        LOGGER_ERRO << "Failed to append bars to: " << _barsTable << " -- " << _bars.size() << "\n";
+        status = false;
+    } else if ( !_store.append(_patternsTable, "timestamp", _patterns) ) {
+        LOGGER_ERRO << "Failed to append patterns to: " << _patternsTable << " -- " << _patterns.size() << "\n";
+        status = false;
+    }
+
+    _bars.clear();
+    _patterns.clear();
+
+    return status;
+}
+
+} // namespace common_trade
+} // namespace tw
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <tw/common/column_store.h>
+#include <tw/instr/instrument_manager.h>
+
+#include <tw/generated/bars.h>
+
+#include <map>
+#include <vector>
+
+namespace tw {
+namespace common_trade {
+
+// Row of bars cache table - formed bar of an instrument
+//
+struct BarsCacheBar {
+    BarsCacheBar() : _run(0),
+                     _instrumentId(0) {
+    }
+
+    template <typename TVisitor>
+    void visitFields(TVisitor& visitor) const {
+        visitor("run", _run);
+        visitor("timestamp", _timestamp);
+        visitor("instrumentId", _instrumentId);
+        _bar.visitFields(visitor);
+    }
+
+    template <typename TVisitor>
+    void visitFields(TVisitor& visitor) {
+        visitor("run", _run);
+        visitor("timestamp", _timestamp);
+        visitor("instrumentId", _instrumentId);
+        _bar.visitFields(visitor);
+    }
+
+    int64_t _run;
+    tw::common::THighResTime _timestamp;
+    tw::instr::Instrument::TKeyId _instrumentId;
+    Bar _bar;
+};
+
+// Row of bars patterns cache table - pattern of a checkpoint, including
+// patterns' processing state which isn't serialized to db. Each checkpoint
+// also has a row with unknown parentType, so that checkpoints without
+// patterns are restored as well
+//
+struct BarsCachePattern {
+    BarsCachePattern() : _run(0),
+                         _instrumentId(0),
+                         _barsCount(0) {
+    }
+
+    template <typename TVisitor>
+    void visitFields(TVisitor& visitor) const {
+        visitor("run", _run);
+        visitor("timestamp", _timestamp);
+        visitor("instrumentId", _instrumentId);
+        visitor("barsCount", _barsCount);
+        _pattern.visitFields(visitor);
+        visitor("isDirty", _pattern._isDirty);
+        visitor("simpleHitchCount", _pattern._simpleHitchCount);
+        visitor("simpleSwingLastBarIndex", _pattern._simpleSwingLastBarIndex);
+        visitor("trendSwingIndexes", _trendSwingIndexes);
+        visitor("counterTrendSwingIndexes", _counterTrendSwingIndexes);
+    }
+
+    template <typename TVisitor>
+    void visitFields(TVisitor& visitor) {
+        visitor("run", _run);
+        visitor("timestamp", _timestamp);
+        visitor("instrumentId", _instrumentId);
+        visitor("barsCount", _barsCount);
+        _pattern.visitFields(visitor);
+        visitor("isDirty", _pattern._isDirty);
+        visitor("simpleHitchCount", _pattern._simpleHitchCount);
+        visitor("simpleSwingLastBarIndex", _pattern._simpleSwingLastBarIndex);
+        visitor("trendSwingIndexes", _trendSwingIndexes);
+        visitor("counterTrendSwingIndexes", _counterTrendSwingIndexes);
+    }
+
+    int64_t _run;
+    tw::common::THighResTime _timestamp;
+    tw::instr::Instrument::TKeyId _instrumentId;
+    uint32_t _barsCount;
+    BarPattern _pattern;
+    std::string _trendSwingIndexes;
+    std::string _counterTrendSwingIndexes;
+};
+
+// Local cache of bars manager's formed bars and patterns in column store
+// (see column_store.dir), so that restarted bars manager restores them
+// without db queries/replay of publisher's log and without reprocessing
+// of patterns bar by bar
+//
+// Each bars manager (bar length, simple hitch max bars, atr periods) has
+// its own tables. Every open() begins a new run: bars restored on start are
+// written again with run's id and then formed bars are added as they
+// close, so that rows of a run are bars manager's bars in order. Patterns
+// of all levels are checkpointed after every N-th bar - restore takes
+// the latest checkpoint and only bars after it need processing of patterns
+//
+class BarsCache {
+public:
+    typedef tw::instr::Instrument::TKeyId TKeyId;
+    typedef std::vector<Bar> TBars;
+    typedef std::vector<BarPattern> TBarPatterns;
+
+    struct TCheckpoint {
+        TCheckpoint() : _barsCount(0) {
+        }
+
+        void clear() {
+            _barsCount = 0;
+            _simple.clear();
+            _swingLevel1.clear();
+            _swingLevel2.clear();
+        }
+
+        // Number of instrument's bars patterns were processed for -
+        // 0 means there is no checkpoint
+        //
+        uint32_t _barsCount;
+        TBarPatterns _simple;
+        TBarPatterns _swingLevel1;
+        TBarPatterns _swingLevel2;
+    };
+
+    struct TInstrumentCache {
+        TBars _bars;
+        TCheckpoint _checkpoint;
+
+        // Open time of the first bar's interval which isn't in cache
+        //
+        tw::common::THighResTime _tailFrom;
+    };
+
+    typedef std::map<TKeyId, TInstrumentCache> TInstrumentsCache;
+
+public:
+    BarsCache();
+
+    bool open(const std::string& dir, uint32_t barLength, int32_t simpleHitchMaxBars, uint32_t atrNumOfPeriods);
+
+    bool isOpen() const {
+        return _store.isOpen();
+    }
+
+    // Reads bars and the latest checkpoints of previous run (if it wrote
+    // anything within the last day)
+    //
+    bool restore(TInstrumentsCache& cache);
+
+    // Erases count of the oldest bars of instrument's cache. Checkpoint's
+    // patterns refer to erased bars, so it's dropped and patterns are
+    // reprocessed for the rest of bars
+    //
+    static void erase(TInstrumentCache& cache, size_t count);
+
+public:
+    void add(const TKeyId& x, const Bar& bar);
+    void addCheckpoint(const TKeyId& x, uint32_t barsCount, const TBarPatterns& simple, const TBarPatterns& swingLevel1, const TBarPatterns& swingLevel2);
+
+    // Appends added bars and checkpoints to store
+    //
+    bool flush();
+
+private:
+    void addPatterns(const TKeyId& x, uint32_t barsCount, const TBarPatterns& patterns);
+    void restoreCheckpoints(const std::vector<BarsCachePattern>& rows, TInstrumentsCache& cache);
+
+private:
+    tw::common::ColumnStore _store;
+    std::string _barsTable;
+    std::string _patternsTable;
+    uint32_t _barLength;
+    int64_t _run;
+
+    std::vector<BarsCacheBar> _bars;
+    std::vector<BarsCachePattern> _patterns;
+};
+
+} // namespace common_trade
+} // namespace tw
@@ -2,13 +2,18 @@
 
 #include <tw/common/singleton.h>
 #include <tw/common/timer_server.h>
+#include <tw/common/thread_placement.h>
 #include <tw/price/quote_store.h>
 #include <tw/common_trade/bars_storage.h>
+#include <tw/common_trade/bars_cache.h>
 #include <tw/common_trade/atr.h>
 #include <tw/channel_or/uuid_factory.h>
 
 #include <tw/generated/bars.h>
 
+#include <boost/bind.hpp>
+
+#include <algorithm>
 #include <map>
 
 #include <tw/common_thread/utils.h>
@@ -167,6 +172,13 @@ public:
         return _barPatternsNull;
     }
     
+    // Used to restore patterns from checkpoint instead of processing them
+    // for all of instrument's bars
+    //
+    void setBarPatterns(const tw::instr::Instrument::TKeyId& x, const TBarPatterns& v) {
+        _instrumentsPatterns[x] = v;
+    }
+    
 protected:
     ePatternDir getPatternDir(const THLOCInfo& hloc) const {
         if ( hloc._open < hloc._close )
@@ -653,6 +665,29 @@ public:
     typedef std::pair<uint32_t, TBars> TBarsInfo;
     typedef std::map<tw::instr::Instrument::TKeyId, TBarsInfo> TInstrumentBarsInfo;
     
+private:
+    // Instrument's own patterns while it's being restored on start
+    //
+    struct TInstrumentRestore {
+        TInstrumentRestore(int32_t simpleHitchMaxBars) : _swingLevel1(_simple, simpleHitchMaxBars),
+                                                         _swingLevel2(_simple, _swingLevel1, simpleHitchMaxBars),
+                                                         _cachedCount(0),
+                                                         _rebuiltCount(0),
+                                                         _micros(0) {
+        }
+        
+        BarPatternsSimple _simple;
+        BarPatternsSwingLevel1 _swingLevel1;
+        BarPatternsSwingLevel2 _swingLevel2;
+        size_t _cachedCount;
+        size_t _rebuiltCount;
+        int64_t _micros;
+        std::string _displayName;
+    };
+    
+    typedef boost::shared_ptr<TInstrumentRestore> TInstrumentRestorePtr;
+    typedef std::map<tw::instr::Instrument::TKeyId, TInstrumentRestorePtr> TInstrumentsRestore;
+    
 public:
     BarsManagerImpl(uint32_t barLength=60, int32_t simpleHitchMaxBars=-1, uint32_t atrPeriods=0) : _barPatternsSwingLevel1(_barPatternsSimple, simpleHitchMaxBars),
                                                                                                    _barPatternsSwingLevel2(_barPatternsSimple, _barPatternsSwingLevel1, simpleHitchMaxBars) {
@@ -671,6 +706,8 @@ public:
         _instrumentsBars.clear();
         _instrumentsBarsInfo.clear();
         _instrumentTrades.clear();
+        _instrumentsCache.clear();
+        _instrumentsRestore.clear();
         
         _barPatternsSimple.clear();
         _barPatternsSwingLevel1.clear();
@@ -717,45 +754,143 @@ public:
         return true;
     }
     
+    // Same as beginStart(), restoreInstrument() of each of instruments and
+    // endStart() - see BarsManagersRestorer for restore of instruments on
+    // worker threads
+    //
     bool start(const tw::common::Settings& settings) {
+        if ( !beginStart(settings) )
+            return false;
+        
+        TInstrumentBarsInfo::const_iterator iter = _instrumentsBarsInfo.begin();
+        TInstrumentBarsInfo::const_iterator end = _instrumentsBarsInfo.end();
+        for ( ; iter != end; ++iter ) {
+            if ( !restoreInstrument(iter->first) )
+                return false;
+        }
+        
+        return endStart();
+    }
+    
+    // Reads cached and historical bars of all of instruments
+    //
+    bool beginStart(const tw::common::Settings& settings) {
         LOGGER_INFO << "Restoring bars..." << "\n";
         _settings = settings;
+        _instrumentsRestore.clear();
+        
+        if ( !restoreCache() )
+            return false;
         
         if ( !restoreBars() ) 
             return false;
         
-        TInstrumentBarsInfo::iterator iter = _instrumentsBarsInfo.begin();
-        TInstrumentBarsInfo::iterator end = _instrumentsBarsInfo.end();
+        // Restore state of all of instruments is created upfront, so that
+        // restoreInstrument() of different instruments can run concurrently
+        //
+        TInstrumentBarsInfo::const_iterator iter = _instrumentsBarsInfo.begin();
+        TInstrumentBarsInfo::const_iterator end = _instrumentsBarsInfo.end();
+        for ( ; iter != end; ++iter )
+            _instrumentsRestore[iter->first].reset(new TInstrumentRestore(_simpleHitchMaxBars));
+        
+        return true;
+    }
+    
+    void getInstruments(std::vector<tw::instr::Instrument::TKeyId>& instruments) const {
+        TInstrumentBarsInfo::const_iterator iter = _instrumentsBarsInfo.begin();
+        TInstrumentBarsInfo::const_iterator end = _instrumentsBarsInfo.end();
+        for ( ; iter != end; ++iter )
+            instruments.push_back(iter->first);
+    }
+    
+    // Rebuilds instrument's bars and its own copy of patterns (merged in
+    // endStart()) - touches nothing shared with other instruments, so
+    // different instruments can be restored concurrently
+    //
+    bool restoreInstrument(const tw::instr::Instrument::TKeyId& x) {
+        tw::common::THighResTime startTime = tw::common::THighResTime::now();
+        
+        TInstrumentsRestore::iterator iterRestore = _instrumentsRestore.find(x);
+        TInstrumentBarsInfo::iterator iter = _instrumentsBarsInfo.find(x);
+        TInstrumentBars::iterator iter2 = _instrumentsBars.find(x);
+        if ( iterRestore == _instrumentsRestore.end() || iter == _instrumentsBarsInfo.end() || iter2 == _instrumentsBars.end() ) {
+            LOGGER_ERRO << "Failed to find subscription for: " << x << "\n";
+            return false;
+        }
+        
+        TInstrumentRestore& restore = *(iterRestore->second);
+        
+        // Cached bars (if any) go first and historical bars only
+        // rebuild the rest. Patterns of cached bars are restored from
+        // the latest checkpoint rather than processed bar by bar
+        //
+        const BarsCache::TInstrumentCache& cache = getInstrumentCache(x);
+        const TBars& cachedBars = cache._bars;
+        const TBars& historicalBars = iter->second.second;
+        TBars& bars = iter2->second;
         
         TBar tempBar;
+        size_t count = cachedBars.size() + historicalBars.size();
+        for ( size_t i = 0; i < count; ++i ) {
+            tempBar = bars.back();
+            bars.back() = (i < cachedBars.size()) ? cachedBars[i] : historicalBars[i-cachedBars.size()];
+            bars.back()._index = tempBar._index;
+            bars.back()._instrument = tempBar._instrument;
+            
+            if ( bars.size() > cache._checkpoint._barsCount )
+                processPatterns(bars, false, restore._simple, restore._swingLevel1, restore._swingLevel2);
+            else if ( bars.size() == cache._checkpoint._barsCount )
+                restoreCheckpoint(x, cache._checkpoint, restore);
+            
+            if ( i < count-1 )
+                createNewBar(iter2);
+        }
+        
+        // Bars restored from cache are formed - don't let quotes update
+        // the last of them
+        //
+        if ( !cachedBars.empty() && bars.back()._formed )
+            createNewBar(iter2);
+        
+        restore._cachedCount = cachedBars.size();
+        restore._rebuiltCount = historicalBars.size();
+        restore._micros = tw::common::THighResTime::now()-startTime;
+        restore._displayName = tempBar._displayName;
+        return true;
+    }
+    
+    // Merges restored patterns and outputs restored bars to db and cache
+    // in order of instruments
+    //
+    bool endStart() {
+        TInstrumentBarsInfo::iterator iter = _instrumentsBarsInfo.begin();
+        TInstrumentBarsInfo::iterator end = _instrumentsBarsInfo.end();
         for ( ; iter != end; ++iter ) {
+            TInstrumentsRestore::iterator iterRestore = _instrumentsRestore.find(iter->first);
             TInstrumentBars::iterator iter2 = _instrumentsBars.find(iter->first);
-            if ( iter2 == _instrumentsBars.end() ) {
+            if ( iterRestore == _instrumentsRestore.end() || iter2 == _instrumentsBars.end() ) {
                 LOGGER_ERRO << "Failed to find subscription for: " << iter->first << "\n";
                 return false;
             }
             
-            const TBars& historicalBars = iter->second.second;
+            const TInstrumentRestore& restore = *(iterRestore->second);
             TBars& bars = iter2->second;
             
-            for ( size_t i = 0; i < historicalBars.size(); ++i ) {
-                tempBar = bars.back();
-                bars.back() = historicalBars[i];
-                bars.back()._index = tempBar._index;
-                bars.back()._instrument = tempBar._instrument;
-                
-                processPatterns(bars, false);
-                
-                if ( i < historicalBars.size()-1 )
-                    createNewBar(iter2);
-            }
-            
+            mergePatterns(iter->first, restore);
             outputToDbOnStart(bars);
+            addToCacheOnStart(iter->first, bars);
             
-            if ( !historicalBars.empty() )
-                LOGGER_WARN << "Restored: " << historicalBars.size() << " bars for lookbackMinutes: " << iter->second.first << " for: " << tempBar._displayName << "\n";
+            size_t count = restore._cachedCount + restore._rebuiltCount;
+            if ( count > 0 )
+                LOGGER_WARN << "Restored: " << count << " bars (" << restore._cachedCount << " cached, " << restore._rebuiltCount << " rebuilt) for lookbackMinutes: " << iter->second.first << " for: " << restore._displayName << " in: " << restore._micros << " us" << "\n";
         }
         
+        if ( _barsCache.isOpen() )
+            _barsCache.flush();
+        
+        _instrumentsCache.clear();
+        _instrumentsRestore.clear();
+        
         LOGGER_INFO << "Restored bars" << "\n";
         return true;
     }
@@ -791,12 +926,16 @@ public:
                         LOGGER_INFO << iter->second.back().toString() << "\n";
 
                     outputToDb(iter->second);
+                    addToCache(iter->first, iter->second);
                 }
             }
             
             createNewBar(iter);
         }        
         
+        if ( _barsCache.isOpen() )
+            _barsCache.flush();
+        
         TRouter::registerTimerClient(this, calcCycleTimeout(), true, _timerId);
         return false;
     }
@@ -975,6 +1114,10 @@ private:
     
 private:
     void processPatterns(const TBars& bars, bool isDynamic) {
+        processPatterns(bars, isDynamic, _barPatternsSimple, _barPatternsSwingLevel1, _barPatternsSwingLevel2);
+    }
+    
+    void processPatterns(const TBars& bars, bool isDynamic, BarPatternsSimple& simple, BarPatternsSwingLevel1& swingLevel1, BarPatternsSwingLevel2& swingLevel2) {
         if ( bars.empty() || bars.back()._numOfTrades == 0 || !bars.back()._close.isValid() ) {
             if ( !bars.empty() && bars.back()._numOfTrades > 0 )
                 LOGGER_ERRO << "!bars.empty() && bars.back()._numOfTrades > 0 for: " << bars.back().toString() << "\n";
@@ -985,9 +1128,9 @@ private:
         if ( !TRouter::processPatterns() )
             return;
         
-        _barPatternsSimple.processPatterns(bars, isDynamic);
-        _barPatternsSwingLevel1.processPatterns(bars, isDynamic);
-        _barPatternsSwingLevel2.processPatterns(bars, isDynamic);
+        simple.processPatterns(bars, isDynamic);
+        swingLevel1.processPatterns(bars, isDynamic);
+        swingLevel2.processPatterns(bars, isDynamic);
     }
     
     void outputToDb(const TBars& bars) {
@@ -1031,6 +1174,142 @@ private:
         outputToDb(_barPatternsSwingLevel2, instrumentId, true);
     }
     
+    bool restoreCache() {
+        _instrumentsCache.clear();
+        if ( !_settings._bars_manager_use_cache )
+            return true;
+        
+        if ( _settings._column_store_dir.empty() ) {
+            LOGGER_ERRO << "column_store.dir is not set for bars_manager.use_cache" << "\n";
+            return false;
+        }
+        
+        if ( !_barsCache.open(_settings._column_store_dir, _barLength, _simpleHitchMaxBars, _atrNumOfPeriods) )
+            return false;
+        
+        tw::common::THighResTime startTime = tw::common::THighResTime::now();
+        if ( !_barsCache.restore(_instrumentsCache) )
+            return false;
+        
+        trimCache();
+        
+        LOGGER_INFO << "Read bars cache for: " << _instrumentsCache.size() << " instruments in: " << (tw::common::THighResTime::now()-startTime) << " us" << "\n";
+        return true;
+    }
+    
+    // Cached bars are limited to lookbackMinutes of instrument the same way
+    // as bars read from db (or to the last day if lookbackMinutes is 0), so
+    // that cached restore gets the same bars as not cached one and each run
+    // doesn't carry forward all of bars of previous ones
+    //
+    void trimCache() {
+        tw::common::THighResTime now = tw::common::THighResTime::now();
+        
+        BarsCache::TInstrumentsCache::iterator iter = _instrumentsCache.begin();
+        while ( iter != _instrumentsCache.end() ) {
+            TInstrumentBarsInfo::const_iterator iterInfo = _instrumentsBarsInfo.find(iter->first);
+            if ( iterInfo == _instrumentsBarsInfo.end() ) {
+                _instrumentsCache.erase(iter++);
+                continue;
+            }
+            
+            int64_t lookback = (iterInfo->second.first > 0) ? static_cast<int64_t>(iterInfo->second.first)*60000000LL : tw::common::StoreTime::kMicrosInDay;
+            
+            const TBars& bars = iter->second._bars;
+            size_t count = 0;
+            while ( count < bars.size() && bars[count]._open_timestamp.isValid() && (now-bars[count]._open_timestamp) > lookback )
+                ++count;
+            
+            if ( count == bars.size() ) {
+                _instrumentsCache.erase(iter++);
+                continue;
+            }
+            
+            BarsCache::erase(iter->second, count);
+            ++iter;
+        }
+    }
+    
+    const BarsCache::TInstrumentCache& getInstrumentCache(const tw::instr::Instrument::TKeyId& x) const {
+        BarsCache::TInstrumentsCache::const_iterator iter = _instrumentsCache.find(x);
+        if ( iter != _instrumentsCache.end() )
+            return iter->second;
+        
+        return _instrumentCacheNull;
+    }
+    
+    // Returns true if historical data at timestamp is already in cached bars
+    //
+    bool isCached(const tw::instr::Instrument::TKeyId& x, const tw::common::THighResTime& timestamp) const {
+        if ( _instrumentsCache.empty() )
+            return false;
+        
+        const BarsCache::TInstrumentCache& cache = getInstrumentCache(x);
+        return (cache._tailFrom.isValid() && timestamp < cache._tailFrom);
+    }
+    
+    void restoreCheckpoint(const tw::instr::Instrument::TKeyId& x, const BarsCache::TCheckpoint& checkpoint, TInstrumentRestore& restore) {
+        if ( !TRouter::processPatterns() )
+            return;
+        
+        restore._simple.setBarPatterns(x, checkpoint._simple);
+        restore._swingLevel1.setBarPatterns(x, checkpoint._swingLevel1);
+        restore._swingLevel2.setBarPatterns(x, checkpoint._swingLevel2);
+    }
+    
+    void mergePatterns(const tw::instr::Instrument::TKeyId& x, const TInstrumentRestore& restore) {
+        if ( !TRouter::processPatterns() )
+            return;
+        
+        mergePatterns(x, restore._simple, _barPatternsSimple);
+        mergePatterns(x, restore._swingLevel1, _barPatternsSwingLevel1);
+        mergePatterns(x, restore._swingLevel2, _barPatternsSwingLevel2);
+    }
+    
+    void mergePatterns(const tw::instr::Instrument::TKeyId& x, const BarPatterns& from, BarPatterns& to) {
+        const TBarPatterns& patterns = from.getBarPatterns(x);
+        if ( !patterns.empty() )
+            to.setBarPatterns(x, patterns);
+    }
+    
+    void addCheckpoint(const tw::instr::Instrument::TKeyId& x, uint32_t barsCount) {
+        if ( !TRouter::processPatterns() )
+            return;
+        
+        _barsCache.addCheckpoint(x,
+                                 barsCount,
+                                 _barPatternsSimple.getBarPatterns(x),
+                                 _barPatternsSwingLevel1.getBarPatterns(x),
+                                 _barPatternsSwingLevel2.getBarPatterns(x));
+    }
+    
+    void addToCache(const tw::instr::Instrument::TKeyId& x, const TBars& bars) {
+        if ( !_barsCache.isOpen() || bars.empty() )
+            return;
+        
+        _barsCache.add(x, bars.back());
+        
+        uint32_t checkpointBars = _settings._bars_manager_cache_checkpoint_bars;
+        if ( checkpointBars > 0 && 0 == bars.size()%checkpointBars )
+            addCheckpoint(x, bars.size());
+    }
+    
+    // Starts instrument's bars of new run of cache with all restored bars
+    // but the current one. Patterns are checkpointed only if they weren't
+    // processed for the current (not yet formed) bar
+    //
+    void addToCacheOnStart(const tw::instr::Instrument::TKeyId& x, const TBars& bars) {
+        if ( !_barsCache.isOpen() || bars.empty() )
+            return;
+        
+        size_t count = bars.back()._formed ? bars.size() : bars.size()-1;
+        for ( size_t i = 0; i < count; ++i )
+            _barsCache.add(x, bars[i]);
+        
+        if ( count > 0 && (bars.back()._formed || 0 == bars.back()._numOfTrades) )
+            addCheckpoint(x, count);
+    }
+    
     bool restoreBars() {
         bool status = true;
         switch ( _settings._bars_manager_bars_restore_mode ) {
@@ -1053,10 +1332,29 @@ private:
         
         for ( ; iter != end; ++iter ) {
             if ( iter->second.first > 0 ) {
-                if ( !TRouter::readBars(iter->first, _barLength, iter->second.first, _atrNumOfPeriods, iter->second.second) ) {
+                // Only bars after cached ones are needed
+                //
+                uint32_t lookbackMinutes = iter->second.first;
+                const BarsCache::TInstrumentCache& cache = getInstrumentCache(iter->first);
+                if ( cache._tailFrom.isValid() ) {
+                    int64_t tailMinutes = (tw::common::THighResTime::now()-cache._tailFrom)/60000000LL + 1;
+                    if ( tailMinutes < static_cast<int64_t>(lookbackMinutes) )
+                        lookbackMinutes = static_cast<uint32_t>(std::max(tailMinutes, static_cast<int64_t>(1)));
+                }
+                
+                TBars& bars = iter->second.second;
+                if ( !TRouter::readBars(iter->first, _barLength, lookbackMinutes, _atrNumOfPeriods, bars) ) {
                     LOGGER_ERRO << "Failed to read bars for instrumentId: " << iter->first << "\n";
                     return false;
                 }
+                
+                if ( cache._tailFrom.isValid() ) {
+                    size_t i = 0;
+                    while ( i < bars.size() && bars[i]._open_timestamp < cache._tailFrom )
+                        ++i;
+                    
+                    bars.erase(bars.begin(), bars.begin()+i);
+                }
             }
         }
         
@@ -1068,6 +1366,9 @@ private:
         
         TInstrumentBarsInfo::iterator iter = _instrumentsBarsInfo.find(quote._instrumentId);
         if ( iter != _instrumentsBarsInfo.end() ) {
+            if ( isCached(quote._instrumentId, currHistoricalTimestamp) )
+                return;
+            
             if ( iter->second.second.empty() ) {
                 needToGetNewBar = true;
             } else {
@@ -1098,6 +1399,23 @@ private:
         }
     }
     
+    std::string getCachedTimestamp() const {
+        tw::common::THighResTime timestamp;
+        
+        TInstrumentBarsInfo::const_iterator iter = _instrumentsBarsInfo.begin();
+        TInstrumentBarsInfo::const_iterator end = _instrumentsBarsInfo.end();
+        for ( ; iter != end; ++iter ) {
+            const BarsCache::TInstrumentCache& cache = getInstrumentCache(iter->first);
+            if ( !cache._tailFrom.isValid() )
+                return std::string();
+            
+            if ( !timestamp.isValid() || cache._tailFrom < timestamp )
+                timestamp = cache._tailFrom;
+        }
+        
+        return (timestamp.isValid() ? timestamp.toString() : std::string());
+    }
+    
     bool readBarsFromFile() {
         static const uint32_t TIMESTAMP_LENGTH = 26;
         static const uint32_t HEADER_LENGTH = 26;
@@ -1127,6 +1445,11 @@ private:
             }                            
             file.seekg(0);
             
+            // Records before the earliest end of cached bars are skipped
+            // without parsing - if all of instruments are cached
+            //
+            const std::string tailFrom = getCachedTimestamp();
+            
             tw::common::THighResTime currHistoricalTimestamp;
             while ( true ) {
                 buffer.clear();
@@ -1139,6 +1462,9 @@ private:
                 if ( file.gcount() != DATA_LENGTH )
                     break;
                 
+                if ( !tailFrom.empty() && buffer.compare(0, TIMESTAMP_LENGTH-2, tailFrom) < 0 )
+                    continue;
+                
                 if ( NULL_TIMESTAMP != buffer.substr(0, NULL_TIMESTAMP.length()) ) {
                     currHistoricalTimestamp = tw::common::THighResTime::parse(buffer.substr(0, TIMESTAMP_LENGTH-2));
                     tw::price::QuoteWire* quoteWire=reinterpret_cast<tw::price::QuoteWire*>(&buffer[HEADER_LENGTH]);
@@ -1150,15 +1476,25 @@ private:
                 }
             }
             
-            // Delete all bars which occurred longer than lookbackMinutes ago
+            // Delete all bars which occurred longer than lookbackMinutes ago -
+            // cached bars go first, so they are deleted before historical ones
             //
             TInstrumentBarsInfo::iterator iter = _instrumentsBarsInfo.begin();
             TInstrumentBarsInfo::iterator end = _instrumentsBarsInfo.end();        
             
             for ( ; iter != end; ++iter ) {
                 TBars& historicalBars = iter->second.second;
-                if ( 0 < iter->second.first && iter->second.first < historicalBars.size() ) {
-                    historicalBars.erase(historicalBars.begin(), historicalBars.begin()+(historicalBars.size()-iter->second.first-1));
+                BarsCache::TInstrumentsCache::iterator iterCache = _instrumentsCache.find(iter->first);
+                size_t cachedCount = (iterCache != _instrumentsCache.end()) ? iterCache->second._bars.size() : 0;
+                size_t count = cachedCount + historicalBars.size();
+                if ( 0 < iter->second.first && iter->second.first < count ) {
+                    size_t excess = count-iter->second.first-1;
+                    if ( cachedCount > 0 ) {
+                        BarsCache::erase(iterCache->second, std::min(excess, cachedCount));
+                        excess -= std::min(excess, cachedCount);
+                    }
+                    
+                    historicalBars.erase(historicalBars.begin(), historicalBars.begin()+excess);
                 }
             }
             
@@ -1211,6 +1547,11 @@ private:
     TTrades _tradesNull;
     tw::common::Settings _settings;
     
+    BarsCache _barsCache;
+    BarsCache::TInstrumentsCache _instrumentsCache;
+    BarsCache::TInstrumentCache _instrumentCacheNull;
+    TInstrumentsRestore _instrumentsRestore;
+    
     BarPatternsSimple _barPatternsSimple;
     BarPatternsSwingLevel1 _barPatternsSwingLevel1;
     BarPatternsSwingLevel2 _barPatternsSwingLevel2;
@@ -1287,6 +1628,22 @@ public:
         return _impl.start(settings);
     }
     
+    bool beginStart(const tw::common::Settings& settings) {
+        return _impl.beginStart(settings);
+    }
+    
+    void getInstruments(std::vector<tw::instr::Instrument::TKeyId>& instruments) const {
+        _impl.getInstruments(instruments);
+    }
+    
+    bool restoreInstrument(const tw::instr::Instrument::TKeyId& x) {
+        return _impl.restoreInstrument(x);
+    }
+    
+    bool endStart() {
+        return _impl.endStart();
+    }
+    
 public:
     static bool registerTimerClient(TImpl* impl, const uint32_t msecs, const bool once, tw::common::TTimerId& id) {
         return tw::common::TimerServer::instance().registerClient(impl, msecs, once, id);
@@ -1349,6 +1706,100 @@ private:
     TImpl _impl;
 };
 
+// Starts bars managers with their instruments restored on a pool of worker
+// threads: each manager reads its data first (beginStart()), then all of
+// managers' instruments are restored concurrently, one instrument per
+// task, and merged back into managers (endStart()) - results are the same
+// as of managers' serial start()
+//
+template <typename TManager>
+class BarsManagersRestorer {
+    typedef std::pair<TManager*, tw::instr::Instrument::TKeyId> TTask;
+    typedef std::vector<TTask> TTasks;
+    typedef std::vector<tw::common_thread::ThreadPtr> TThreads;
+    typedef tw::common_thread::Lock TLock;
+    
+public:
+    BarsManagersRestorer() : _next(0),
+                             _failed(0) {
+    }
+    
+    void add(TManager* manager) {
+        _managers.push_back(manager);
+    }
+    
+    bool run(const tw::common::Settings& settings, uint32_t threadsCount) {
+        tw::common::THighResTime startTime = tw::common::THighResTime::now();
+        
+        _tasks.clear();
+        _next = 0;
+        _failed = 0;
+        
+        std::vector<tw::instr::Instrument::TKeyId> instruments;
+        for ( size_t i = 0; i < _managers.size(); ++i ) {
+            if ( !_managers[i]->beginStart(settings) )
+                return false;
+            
+            instruments.clear();
+            _managers[i]->getInstruments(instruments);
+            for ( size_t j = 0; j < instruments.size(); ++j )
+                _tasks.push_back(TTask(_managers[i], instruments[j]));
+        }
+        
+        threadsCount = std::min(threadsCount, static_cast<uint32_t>(_tasks.size()));
+        if ( threadsCount < 2 ) {
+            threadsCount = 1;
+            threadMain();
+        } else {
+            TThreads threads;
+            for ( uint32_t i = 0; i < threadsCount; ++i )
+                threads.push_back(tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kWorker, boost::bind(&BarsManagersRestorer::threadMain, this)));
+            
+            for ( size_t i = 0; i < threads.size(); ++i )
+                threads[i]->join();
+        }
+        
+        if ( _failed > 0 ) {
+            LOGGER_ERRO << "Failed to restore: " << _failed << " instruments" << "\n";
+            return false;
+        }
+        
+        for ( size_t i = 0; i < _managers.size(); ++i ) {
+            if ( !_managers[i]->endStart() )
+                return false;
+        }
+        
+        LOGGER_INFO << "Restored: " << _tasks.size() << " instruments of " << _managers.size() << " bars managers on " << threadsCount << " threads in: " << (tw::common::THighResTime::now()-startTime) << " us" << "\n";
+        return true;
+    }
+    
+private:
+    void threadMain() {
+        while ( true ) {
+            TTask task;
+            {
+                tw::common_thread::LockGuard<TLock> lock(_lock);
+                if ( _next == _tasks.size() )
+                    return;
+                
+                task = _tasks[_next++];
+            }
+            
+            if ( !task.first->restoreInstrument(task.second) ) {
+                tw::common_thread::LockGuard<TLock> lock(_lock);
+                ++_failed;
+            }
+        }
+    }
+    
+private:
+    TLock _lock;
+    std::vector<TManager*> _managers;
+    TTasks _tasks;
+    size_t _next;
+    uint32_t _failed;
+};
+
 class BarsManagerFactory : public tw::common::Singleton<BarsManagerFactory> {
 public:
     typedef boost::shared_ptr<BarsManager> TBarsManagerPtr;
@@ -1372,15 +1823,14 @@ public:
     }
 
     bool start(const tw::common::Settings& settings) {
+        BarsManagersRestorer<BarsManager> restorer;
+        
         TBarsManagers::iterator iter = _barsManagers.begin();
         TBarsManagers::iterator end = _barsManagers.end();
+        for ( ; iter != end; ++iter )
+            restorer.add(iter->second.get());
         
-        for ( ; iter != end; ++iter ) {
-            if ( !iter->second->start(settings) )
-                return false;
-        }
-        
-        return true;
+        return restorer.run(settings, settings._bars_manager_restore_threads);
     }
     
 private:
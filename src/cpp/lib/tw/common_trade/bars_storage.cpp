@@ -3,6 +3,7 @@
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/common_thread/utils.h>
 #include <tw/common_strat/strategy_container.h>
+#include <tw/common/thread_placement.h>
 
 namespace tw {
 namespace common_trade {
@@ -78,6 +79,12 @@ bool BarsStorage::init(const tw::common::Settings& settings) {
             return false;
         }
         
+        if ( !tw::channel_db::SqlBatch::setDefaults(settings) )
+            return false;
+        
+        if ( !settings._column_store_dir.empty() && !_columnStore.open(settings._column_store_dir) )
+            return false;
+        
         if ( !_channelDb.init(settings._db_connection_str) ) {
             LOGGER_ERRO << "Failed to init channelDb with: "  << settings._db_connection_str << "\n";
             return false;
@@ -98,7 +105,7 @@ bool BarsStorage::init(const tw::common::Settings& settings) {
             status = false;
         }
         
-        _threadDb = TThreadPtr(new TThread(boost::bind(&BarsStorage::threadMainPersistToDb, this)));
+        _threadDb = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kStorage, boost::bind(&BarsStorage::threadMainPersistToDb, this));
         
     } catch(const std::exception& e) {        
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";
@@ -282,6 +289,7 @@ bool BarsStorage::flushToDb() {
             }
             
             _connection->commit();
+            appendToColumnStore(count);
             
             _itemsCache.erase(first, last);
             _itemsCacheSize = _itemsCache.size();
@@ -297,6 +305,21 @@ bool BarsStorage::flushToDb() {
     return true;
 }
 
+void BarsStorage::appendToColumnStore(size_t count) {
+    if ( !_columnStore.isOpen() )
+        return;
+    
+    TBars bars;
+    for ( size_t i = 0; i < count; ++i ) {
+        const TBarsStorageItemPtr& item = _itemsCache[i];
+        if ( tw::common::eBarsStorageItemType::kBar == item->_type )
+            bars.push_back(item->_bar);
+    }
+    
+    if ( !_columnStore.append("Bars", "open_timestamp", bars) )
+        LOGGER_ERRO << "Failed to append bars to column store: "  << bars.size() << "\n";
+}
+
 bool BarsStorage::persistToDb(const TBarsStorageItemPtr& item) {
     try {
         if ( !item )
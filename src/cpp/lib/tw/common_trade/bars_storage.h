@@ -4,10 +4,12 @@
 #include <tw/common/pool.h>
 #include <tw/common/singleton.h>
 #include <tw/common/filesystem.h>
+#include <tw/common/column_store.h>
 #include <tw/common_thread/locks.h>
 #include <tw/common_thread/thread.h>
 #include <tw/common_thread/thread_pipe.h>
 #include <tw/channel_db/channel_db.h>
+#include <tw/channel_db/sql_batch.h>
 
 #include <tw/generated/bars.h>
 #include <tw/generated/enums_common.h>
@@ -151,6 +153,7 @@ private:
     
     bool doPersist(const TBarsStorageItemPtr& item);
     bool flushToDb();
+    void appendToColumnStore(size_t count);
     bool persistToDb(const TBarsStorageItemPtr& item);
     
     void flushDbCache();
@@ -189,6 +192,10 @@ private:
     tw::channel_db::ChannelDb::TConnectionPtr _connection;
     tw::channel_db::ChannelDb::TStatementPtr _statement;
     
+    // Local copy of bars, populated once db transaction is committed
+    //
+    tw::common::ColumnStore _columnStore;
+    
     TPool _pool;
     TThreadPtr _threadDb;
     TThreadPipe _threadPipeDb;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tw/common/defs.h>
+#include <tw/price/ticks_converter.h>
 #include <tw/generated/instrument.h>
 
 namespace tw {
@@ -25,6 +26,7 @@ public:
             _instrument = rhs._instrument;
             _isTvSet = rhs._isTvSet;
             _tv = rhs._tv;
+            _ratio = rhs._ratio;
         }
         
         return *this;
@@ -34,6 +36,7 @@ public:
         _instrument.reset();
         _isTvSet = false;
         _tv = 0.0;
+        _ratio.set(1, 1);
     }
     
     // Done for unit testing
@@ -48,6 +51,7 @@ public:
             return false;
         
         _instrument = instrument;
+        _ratio.set(_instrument->_tickNumerator, _instrument->_tickDenominator);
         return true;        
     }
     
@@ -78,13 +82,14 @@ public:
         if ( !isValid() )
             return 0.0;
         
-        return _instrument->_tc->fractionalTicks(_tv);;
+        return _ratio.toFractionalTicks(_tv);
     }
    
 protected:
     tw::instr::InstrumentConstPtr _instrument;
     bool _isTvSet;
     double _tv;
+    tw::price::TicksRatio _ratio;
 };
 
 } // common_trade
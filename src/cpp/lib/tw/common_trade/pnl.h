@@ -34,6 +34,7 @@ public:
              _isTVSet = rhs._isTVSet;
              _tv = rhs._tv;
              _avgPrice = rhs._avgPrice;
+             _ratio = rhs._ratio;
         }
         
         return *this;
@@ -45,6 +46,7 @@ public:
         _isTVSet = false;
         _tv = 0.0;
         _avgPrice = 0.0;
+        _ratio.set(1, 1);
     }
     
 public:
@@ -64,6 +66,8 @@ public:
                 _instrument.reset();
                 return false;
             }
+            
+            _ratio.set(_instrument->_tickNumerator, _instrument->_tickDenominator);
         }
         
         return true;
@@ -131,7 +135,7 @@ private:
         if ( !isValid() )
             return 0.0;
         
-        return _instrument->_tc->fractionalTicks(_avgPrice-price) * _instrument->_tickValue * qty * -sign;
+        return _ratio.toFractionalTicks(_avgPrice-price) * _instrument->_tickValue * qty * -sign;
     }
     
     void updateRealizedPnL(const tw::price::Size& qty, double price, const tw::price::Size& position, int32_t sign) {
@@ -197,7 +201,7 @@ private:
         if ( _observer )
             _observer->preProcess(*this);
         
-        double price = useFillAvgPrice ? fill._avgPrice : _instrument->_tc->toExchangePrice(fill._price);
+        double price = useFillAvgPrice ? fill._avgPrice : _ratio.toExchangePrice(fill._price);
         if ( !_isTVSet )
             setTv(price);
         
@@ -227,6 +231,7 @@ private:
     bool _isTVSet;
     double _tv;
     double _avgPrice;
+    tw::price::TicksRatio _ratio;
 };
 
 } // common_trade
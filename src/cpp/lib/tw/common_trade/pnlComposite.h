@@ -29,6 +29,8 @@ public:
              static_cast<Parent&>(*this) = static_cast<const Parent&>(rhs);
              _components = rhs._components;
              _observer = rhs._observer;
+             _longs = rhs._longs;
+             _shorts = rhs._shorts;
         }
         
         return *this;
@@ -38,6 +40,8 @@ public:
         Parent::clear();
         _components.clear();
         _observer = NULL;
+        _longs.set(0);
+        _shorts.set(0);
     }
     
 public:
@@ -48,6 +52,17 @@ public:
         _components.push_back(c);
     }
     
+    // Sums of long and short (negative) positions of leaf components,
+    // maintained by deltas in preProcess()/postProcess()
+    //
+    tw::price::Size getLongs() const {
+        return _longs;
+    }
+    
+    tw::price::Size getShorts() const {
+        return _shorts;
+    }
+    
 public:
     // IPnL interface
     //
@@ -110,6 +125,7 @@ public:
         _pnl._unrealizedPnL -= c.getPnLInfo()._unrealizedPnL;
         _pnl._realizedPnL -= c.getPnLInfo()._realizedPnL;
         _pnl._position -= c.getPnLInfo()._position;
+        updateLongsShorts(c.getPnLInfo()._position, false);
         
         _fees -= c.getFeesPaid();
                 
@@ -121,6 +137,7 @@ public:
         _pnl._unrealizedPnL += c.getPnLInfo()._unrealizedPnL;
         _pnl._realizedPnL += c.getPnLInfo()._realizedPnL;
         _pnl._position += c.getPnLInfo()._position;
+        updateLongsShorts(c.getPnLInfo()._position, true);
         
         Parent::updateRealizedPnL();
         Parent::updateUnrealizedPnL(!isFlat());
@@ -145,8 +162,19 @@ public:
         return true;
     }
     
+private:
+    void updateLongsShorts(const tw::price::Size& position, bool add) {
+        tw::price::Size& v = (position.get() > 0) ? _longs : _shorts;
+        if ( add )
+            v += position;
+        else
+            v -= position;
+    }
+    
 private:
     TComponents _components;
+    tw::price::Size _longs;
+    tw::price::Size _shorts;
 };
 
 } // common_trade
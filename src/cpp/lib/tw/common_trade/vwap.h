@@ -28,7 +28,7 @@ public:
     Vwap& operator=(const Vwap& rhs) {
         if ( this != &rhs ) {
             static_cast<Parent&>(*this) = static_cast<const Parent&>(rhs);
-            _volume = rhs._volume;
+            _notional = rhs._notional;
         }
         
         return *this;
@@ -36,7 +36,7 @@ public:
     
     void clear() {
         Parent::clear();
-        _volume = 0.0;
+        _notional.clear();
     }
     
 public:
@@ -51,16 +51,17 @@ public:
         if ( tw::price::Quote::kSuccess != quote._status || !quote.isTrade() || !quote._trade.isValid() )
             return;
      
-        _tv *= _volume;
-        _tv += _instrument->_tc->toExchangePrice(quote._trade._price) * quote._trade._size.get();
-        _volume += quote._trade._size.get();
-        _tv /= _volume;
+        // Notional is accumulated in integer ticks, so vwap doesn't drift
+        // with number of trades
+        //
+        _notional.add(quote._trade._price, quote._trade._size);
+        _tv = _notional.getAvgPrice(_ratio);
 
         _isTvSet = true;
     }
     
 private:
-    double _volume;
+    tw::price::TicksNotional _notional;
 };
 
 } // common_trade
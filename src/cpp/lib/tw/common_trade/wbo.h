@@ -9,30 +9,38 @@
 namespace tw {
 namespace common_trade {
     
+// Both calcs are done in integer ticks and sizes - with b/o bid/offer
+// ticks, bs/os their sizes and points = tickNumerator/tickDenominator:
+//
+//  wbo1 = (0.5*b + 0.5*o - 0.5)*points + bs/(bs+os)*points
+//       = ((b+o-1)*(bs+os) + 2*bs)/(2*(bs+os)) ticks
+//
+//  wbo2 = b*points + bs/(bs+os)*(o-b)*points
+//       = (b*os + o*bs)/(bs+os) ticks
+//
+// and converted to exchange price once
+//
 class Wbo_calc1 {
 public:
-    double operator()(const tw::price::Quote& quote, const tw::instr::InstrumentConstPtr& instrument, double points) {
-        double b1 = instrument->_tc->toExchangePrice(quote._book[0]._bid._price);
-        double o1 = instrument->_tc->toExchangePrice(quote._book[0]._ask._price);
+    double operator()(const tw::price::Quote& quote, const tw::price::TicksRatio& ratio) {
+        int64_t b = quote._book[0]._bid._price.get();
+        int64_t o = quote._book[0]._ask._price.get();
+        int64_t bs = quote._book[0]._bid._size.get();
+        int64_t os = quote._book[0]._ask._size.get();
         
-        double wbo_initial = 0.5*b1 + 0.5*o1 - 0.5*points;
-        double wbo_multiplier = quote._book[0]._bid._size.toDouble()/(quote._book[0]._bid._size.toDouble()+quote._book[0]._ask._size.toDouble());
-        
-        return (wbo_initial + wbo_multiplier*points);
+        return ratio.toExchangePrice((b+o-1)*(bs+os) + 2*bs, 2*(bs+os));
     }
 };
 
 class Wbo_calc2 {
 public:
-    double operator()(const tw::price::Quote& quote, const tw::instr::InstrumentConstPtr& instrument, double points) {
-        double b1 = instrument->_tc->toExchangePrice(quote._book[0]._bid._price);
-        double o1 = instrument->_tc->toExchangePrice(quote._book[0]._ask._price);
-        
-        double wbo_initial = b1;
-        double wbo_multiplier = quote._book[0]._bid._size.toDouble()/(quote._book[0]._bid._size.toDouble()+quote._book[0]._ask._size.toDouble());
-        double wbo_width = o1 - b1;
+    double operator()(const tw::price::Quote& quote, const tw::price::TicksRatio& ratio) {
+        int64_t b = quote._book[0]._bid._price.get();
+        int64_t o = quote._book[0]._ask._price.get();
+        int64_t bs = quote._book[0]._bid._size.get();
+        int64_t os = quote._book[0]._ask._size.get();
         
-        return (wbo_initial + wbo_multiplier*wbo_width);
+        return ratio.toExchangePrice(b*os + o*bs, bs+os);
     }
 };
 
@@ -56,7 +64,6 @@ public:
     Wbo& operator=(const Wbo& rhs) {
         if ( this != &rhs ) {
             static_cast<Parent&>(*this) = static_cast<const Parent&>(rhs);
-            _points = rhs._points;
         }
         
         return *this;
@@ -64,7 +71,6 @@ public:
     
     void clear() {
         Parent::clear();
-        _points = 1;
     }
     
     virtual bool setInstrument(tw::instr::InstrumentConstPtr instrument) {
@@ -74,7 +80,6 @@ public:
         if ( 0 == _instrument->_tickDenominator )
             return false;
         
-        _points = static_cast<double>(_instrument->_tickNumerator)/static_cast<double>(_instrument->_tickDenominator);
         return true;
     }
     
@@ -85,19 +90,17 @@ public:
                 LOGGER_ERRO << "Severe error - unknown or invalid instrument for id: " << quote._instrumentId << "\n";
                 return;
             }
-            _points = static_cast<double>(_instrument->_tickNumerator)/static_cast<double>(_instrument->_tickDenominator);
         }
 
         if ( !quote._book[0].isValid() )
             return;
         
-       _tv = _calc(quote, _instrument, _points);
+       _tv = _calc(quote, _ratio);
        _isTvSet = true;
     }
     
 private:
     TCalc _calc;
-    double _points;
 };
 
 } // common_trade
@@ -4,6 +4,7 @@
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/channel_or_cme/translator.h>
 #include <tw/common_thread/utils.h>
+#include <tw/common/thread_placement.h>
 
 namespace tw {
 namespace exchange_sim {
@@ -22,6 +23,7 @@ void MatcherManagerCME::clear() {
     _done = false;
     
     _matchers.clear();
+    _matchersByInternId.clear();
     _sessions.clear();
     
     _connectionsSubs.clear();
@@ -113,6 +115,11 @@ bool MatcherManagerCME::start(const tw::common::Settings& settings) {
                     return false;
                 }
                 _matchers[(*iter)->_displayName] = matcher;
+                
+                if ( _matchersByInternId.size() <= (*iter)->_internId )
+                    _matchersByInternId.resize((*iter)->_internId+1);
+                _matchersByInternId[(*iter)->_internId] = matcher;
+                
                 LOGGER_ERRO << "Added matcher for: " << (*iter)->_displayName << "::" << (*iter)->toString() << "\n";
             }
         }
@@ -167,7 +174,7 @@ bool MatcherManagerCME::start(const tw::common::Settings& settings) {
         // Start subs thread
         //
         _done = false;        
-        _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&MatcherManagerCME::ThreadMain, this)));
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kExchangeSim, boost::bind(&MatcherManagerCME::ThreadMain, this));
         
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
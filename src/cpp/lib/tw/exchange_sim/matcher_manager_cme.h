@@ -66,12 +66,15 @@ private:
     void sendAck(const OnixS::FIX::Message& msg, OnixS::FIX::Session* sn);
     void sendRej(const OnixS::FIX::Message& msg, OnixS::FIX::Session* sn, const std::string& reason);
     
+    // Called per order message - resolves matcher through instrument's
+    // interned id instead of map lookup by display name
+    //
     const TMatcherPtr& getMatcher(const std::string& displayName) const {
         static TMatcherPtr nullMatcher;
         
-        TMatchers::const_iterator iter = _matchers.find(displayName);
-        if ( iter != _matchers.end() )
-            return iter->second;
+        uint32_t id = tw::instr::InstrumentManager::instance().getInternId(displayName);
+        if ( id < _matchersByInternId.size() )
+            return _matchersByInternId[id];
         
         return nullMatcher;
     }
@@ -92,6 +95,7 @@ private:
 private:
     typedef tw::common_thread::Lock TLock;
     typedef std::map<std::string, TMatcherPtr> TMatchers;    
+    typedef std::vector<TMatcherPtr> TMatchersByInternId;
     typedef std::map<std::string, TSessionPtr> TSessions;
     
     typedef boost::shared_ptr<tw::channel_pf::Channel> TChannelPfPtr;
@@ -112,6 +116,7 @@ private:
     tw::common_thread::ThreadPipe<const Matcher*> _threadPipe;
     
     TMatchers _matchers;
+    TMatchersByInternId _matchersByInternId;
     TSessions _sessions;
     
     TConnectionsSubs _connectionsSubs;
@@ -164,6 +164,9 @@ void InstrumentManager::clear() {
     _header.clear();
     _settings.clear();
     _table.clear();    
+    
+    _byInternId.clear();
+    _displayNames.clear();
 }
 
 bool InstrumentManager::loadInstruments(const tw::common::Settings& settings, bool validate) {
@@ -357,7 +360,7 @@ void InstrumentManager::load(const std::string& row, bool validate) {
         }
     }
     
-    _table.insert(instrument);
+    insert(instrument);
     if ( _settings._instruments_createQuotesOnLoad )
         tw::price::QuoteStore::instance().getQuote(instrument);
 }
@@ -365,11 +368,26 @@ void InstrumentManager::load(const std::string& row, bool validate) {
 void InstrumentManager::addInstrument(InstrumentPtr instrument) {
     tw::common_thread::LockGuard<TLock> lock(_lock);
  
-    _table.insert(instrument);
+    insert(instrument);
     if ( _settings._instruments_verbose )
         LOGGER_WARN << "Added [Instrument]: " << instrument->_displayName << "\n";
 }
 
+void InstrumentManager::insert(InstrumentPtr instrument) {
+    // Lock for thread synchronization
+    //
+    tw::common_thread::LockGuard<TLock> lock(_lock);
+    
+    if ( !_table.insert(instrument).second )
+        return;
+    
+    // Assign interned id to newly added instrument
+    //
+    instrument->_internId = static_cast<uint32_t>(_byInternId.size());
+    _byInternId.push_back(instrument);
+    _displayNames.add(instrument->_displayName, instrument->_internId);
+}
+
 tw::instr::Settlement& InstrumentManager::getOrCreateSettlement(const tw::instr::eExchange& exchange, const std::string& displayName, const std::string& settlDate) {
     std::string key = getSettlKey(exchange, displayName, settlDate);
     TSettlements::iterator iter = _settlements.find(key);
@@ -8,6 +8,7 @@
 
 #include <tw/common/singleton.h>
 #include <tw/common/settings.h>
+#include <tw/common/string_intern.h>
 #include <tw/generated/instrument.h>
 
 namespace tw {
@@ -78,6 +79,36 @@ public:
         return getInstrument<5>(key);
     }
     
+public:
+    // Interned ids - dense ids assigned to instruments in order of loading,
+    // which are meant to be resolved once and then used to index vectors
+    // in hot paths instead of string lookups
+    //
+    // Instruments can be added at runtime, so intern tables are read under
+    // manager's lock and instruments are returned by value
+    //
+    static const uint32_t NULL_INTERN_ID = tw::common::StringIntern::NULL_ID;
+    
+    uint32_t getInternId(const std::string& displayName) const {
+        tw::common_thread::LockGuard<TLock> lock(const_cast<InstrumentManager*>(this)->_lock);
+        return _displayNames.find(displayName);
+    }
+    
+    uint32_t getInternIdsCount() const {
+        tw::common_thread::LockGuard<TLock> lock(const_cast<InstrumentManager*>(this)->_lock);
+        return static_cast<uint32_t>(_byInternId.size());
+    }
+    
+    // Returns null instrument for unknown ids (including NULL_INTERN_ID)
+    //
+    InstrumentPtr getByInternId(uint32_t id) const {
+        tw::common_thread::LockGuard<TLock> lock(const_cast<InstrumentManager*>(this)->_lock);
+        if ( id < _byInternId.size() )
+            return _byInternId[id];
+        
+        return InstrumentPtr();
+    }
+    
 public:
     TInstruments getByExchange(tw::instr::eExchange exchange) const {
         TInstruments instruments;
@@ -125,6 +156,7 @@ private:
     void loadFromDb(const std::string& connectionString, bool validate);
     
     void load(const std::string& row, bool validate);
+    void insert(InstrumentPtr instrument);
     
     void saveToFile();
     void saveToDb();    
@@ -149,6 +181,9 @@ private:
     std::string _header;
     tw::common::Settings _settings;
     InstrumentTable _table; 
+    
+    TInstruments _byInternId;
+    tw::common::StringIntern _displayNames;
 
     typedef tw::common_thread::Lock TLock;
     TLock _lock;
@@ -2,6 +2,7 @@
 #include <tw/log/defs.h>
 #include <tw/common/pool.h>
 #include <tw/common/filesystem.h>
+#include <tw/common/thread_placement.h>
 
 #define LOG_LOGGER_INFO std::cout << "INFO: " << TW_LOG_AT
 #define LOG_LOGGER_WARN std::cout << "WARN: " << TW_LOG_AT
@@ -125,7 +126,7 @@ bool Logger::start(const tw::common::Settings& settings) {
         }
         
         _settings = settings;
-        _thread = tw::common_thread::ThreadPtr(new tw::common_thread::Thread(boost::bind(&Logger::ThreadMain, this)));
+        _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kLogger, boost::bind(&Logger::ThreadMain, this));
     } catch(const std::exception& e) {
         LOG_LOGGER_ERRO << "Exception: "  << e.what() << "\n\n";        
         status = false;
@@ -2,6 +2,7 @@
 
 #include <tw/common/defs.h>
 #include <tw/common/singleton.h>
+#include <tw/common/instrumentation.h>
 #include <tw/functional/utils.hpp>
 #include <tw/price/quote.h>
 #include <tw/price/client_container.h>
@@ -88,6 +89,8 @@ public:
             _subscribers.onQuote(*this);
         }
         
+        recordLatencies();
+        
         if ( _quoteNotificationStatsInterval > 0 ) {
             if ( Quote::kSuccess != ncThis->_status || !(ncThis->isBookUpdate() || ncThis->isTrade()) )
                 return;
@@ -106,6 +109,21 @@ public:
         }
     }
     
+    // Timestamps are in micros, histograms are in nanos
+    //
+    void recordLatencies() const {
+        tw::common::Instrumentation& instrumentation = tw::common::Instrumentation::instance();
+        if ( !instrumentation.isEnabled() )
+            return;
+        
+        if ( Quote::kSuccess != _status || !(isBookUpdate() || isTrade()) )
+            return;
+        
+        instrumentation.getStage(tw::common::Instrumentation::kFeedDecode).record((_timestamp2 - _timestamp1) * 1000);
+        instrumentation.getStage(tw::common::Instrumentation::kQuoteStorePublish).record((_timestamp3 - _timestamp2) * 1000);
+        instrumentation.getStage(tw::common::Instrumentation::kStratCallback).record((_timestamp4 - _timestamp3) * 1000);
+    }
+    
     void printNotificationStats() const {
         printNotificationStats(_notification_stats_onix, "stats_onix");
         printNotificationStats(_notification_stats_tw, "stats_tw");
@@ -144,6 +162,7 @@ public:
     typedef QuoteSubscribers TQuote;
     typedef std::tr1::unordered_map<tw::instr::Instrument::TKeyId, TQuote> TQuotes;
     typedef std::tr1::unordered_map<uint32_t, TQuote*> TQuotesIndex;    
+    typedef std::vector<TQuote*> TQuotesByInternId;
     
 public:
     QuoteStore() : _quoteNotificationStatsInterval(0) {
@@ -154,6 +173,7 @@ public:
         _quotes.clear();
         _index1.clear();
         _index2.clear();
+        _byInternId.clear();
     }
     
     void copy(const QuoteStore& rhs) {
@@ -167,6 +187,7 @@ public:
             if ( instrument ) {
                 _index1[instrument->_keyNum1] = &(iter->second);
                 _index2[instrument->_keyNum2] = &(iter->second);            
+                setByInternId(instrument, &(iter->second));
                 
                 LOGGER_INFO << "Added Quote for: " << instrument->_displayName << " :: " << instrument->_keyNum1 << " :: " << instrument->_keyNum2 << "\n";
             }
@@ -284,6 +305,7 @@ public:
             
             _index1[instrument->_keyNum1] = &(iter->second);
             _index2[instrument->_keyNum2] = &(iter->second);
+            setByInternId(instrument, &(iter->second));
             
             LOGGER_INFO << "Added Quote for: " << instrument->_displayName 
                     << " :: " << instrument->_keyNum1 << " :: " << instrument->_keyNum2 << "\n";
@@ -299,8 +321,18 @@ public:
         return getQuote(tw::instr::InstrumentManager::instance().getByKeyId(key));
     }
     
+    // getQuoteByDisplayName(const std::string&) resolves display name to
+    // interned id and gets quote by it (creates quote if not found)
+    //
     TQuote& getQuoteByDisplayName(const std::string& key) {
-        return getQuote(tw::instr::InstrumentManager::instance().getByDisplayName(key));
+        return getQuoteByInternId(tw::instr::InstrumentManager::instance().getInternId(key));
+    }
+    
+    TQuote& getQuoteByInternId(uint32_t id) {
+        if ( id < _byInternId.size() && NULL != _byInternId[id] )
+            return (*_byInternId[id]);
+        
+        return getQuote(tw::instr::InstrumentManager::instance().getByInternId(id));
     }
     
     // getQuoteByKeyNum1(uint32_t key) gets (and DOESN'T create if not found)
@@ -340,11 +372,23 @@ public:
         _quoteNotificationStatsInterval = quoteNotificationStatsInterval;
     }
 
+private:
+    void setByInternId(const tw::instr::InstrumentConstPtr& instrument, TQuote* quote) {
+        if ( instrument != tw::instr::InstrumentManager::instance().getByInternId(instrument->_internId) )
+            return;
+        
+        if ( _byInternId.size() <= instrument->_internId )
+            _byInternId.resize(instrument->_internId+1, NULL);
+        
+        _byInternId[instrument->_internId] = quote;
+    }
+    
 private:    
     TQuote _nullQuote;
     TQuotes _quotes;    
     TQuotesIndex _index1;
     TQuotesIndex _index2;
+    TQuotesByInternId _byInternId;
     unsigned _quoteNotificationStatsInterval;
 };
 
@@ -5,6 +5,7 @@
 #include <tw/common_thread/thread_pipe.h>
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/price/quote_store.h>
+#include <tw/common/thread_placement.h>
 
 namespace tw {
 namespace price {
@@ -35,7 +36,7 @@ public:
                 
                 // Create and start thread
                 //
-                _thread = TThreadPtr(new TThread(boost::bind(&QuoteStoreManager::threadMain, this)));
+                _thread = tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kQuoteStore, boost::bind(&QuoteStoreManager::threadMain, this));
             }
             
             LOGGER_INFO << "Started QuoteStoreManager in _isMultithreaded=" << (_isMultithreaded ? "true" : "false") << " mode" << "\n";
@@ -9,7 +9,7 @@ namespace price {
 
 // Allows precision to 4th decimal place
 //
-const double TicksConverter::_g_epsilon = 0.0001;
+const double TicksRatioBase::_g_epsilon = 0.0001;
 
 TicksConverter::TicksConverter(tw::instr::InstrumentConstPtr instrument) {
     resetWithNewInstrument(instrument);
@@ -22,30 +22,12 @@ void TicksConverter::resetWithNewInstrument(tw::instr::InstrumentConstPtr instru
     if ( !instrument->isValid() )
         throw std::invalid_argument("invalid instrument: " + instrument->toString());
     
-    if ( instrument->_tickNumerator == instrument->_tickDenominator ) {
-        _convertFrom = createFrom();
-        _convertTo = createTo();
-        _convertToFractional = createToFractional();
-        _convertFractional = createFractional();
-    } else if ( 1 == instrument->_tickDenominator ) {
-        _converterNum.set(instrument->_tickNumerator);
-        _convertFrom = createFrom(&_converterNum);
-        _convertTo = createTo(&_converterNum);
-        _convertToFractional = createToFractional(&_converterNum);
-        _convertFractional = createFractional(&_converterNum);
-    } else if ( 1 == instrument->_tickNumerator ) {
-        _converterDenom.set(instrument->_tickDenominator);
-        _convertFrom = createFrom(&_converterDenom);
-        _convertTo = createTo(&_converterDenom);
-        _convertToFractional = createToFractional(&_converterDenom);
-        _convertFractional = createFractional(&_converterDenom);
-    } else {
-        _converterFull.set(instrument->_tickNumerator, instrument->_tickDenominator);
-        _convertFrom = createFrom(&_converterFull);
-        _convertTo = createTo(&_converterFull);
-        _convertToFractional = createToFractional(&_converterFull);
-        _convertFractional = createFractional(&_converterFull);
-    }
+    _ratio.set(instrument->_tickNumerator, instrument->_tickDenominator);
+    
+    _convertFrom = TConverterFrom(_ratio);
+    _convertTo = TConverterTo(_ratio);
+    _convertToFractional = TConverterToFractional(_ratio);
+    _convertFractional = TConverterFractional(_ratio);
 }
  
 Ticks TicksConverter::nearestTick(double fractionalTicks) {
@@ -60,11 +42,11 @@ Ticks TicksConverter::nearestTick(double fractionalTicks, double tol) {
 }
     
 Ticks TicksConverter::nearestTickAbove(double fractionalTicks) {
-    return Ticks(static_cast<Ticks::type>(tw::math::ceil(fractionalTicks-_g_epsilon)));
+    return Ticks(static_cast<Ticks::type>(tw::math::ceil(fractionalTicks-TicksRatioBase::_g_epsilon)));
 }
 
 Ticks TicksConverter::nearestTickBelow(double fractionalTicks) {
-    return Ticks(static_cast<Ticks::type>(tw::math::floor(fractionalTicks+_g_epsilon)));
+    return Ticks(static_cast<Ticks::type>(tw::math::floor(fractionalTicks+TicksRatioBase::_g_epsilon)));
 }
 
 Ticks TicksConverter::nextTickAbove(double fractionalTicks) {
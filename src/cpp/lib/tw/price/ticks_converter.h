@@ -2,11 +2,314 @@
 
 #include <tw/instr/fwdDefs.h>
 #include <tw/price/defs.h>
-#include <tw/functional/delegate.hpp>
+
+#include <stdint.h>
 
 namespace tw {
 namespace price {
 
+// Conversions for each class of tick ratio (tickNumerator/tickDenominator)
+// - compile time specialized, so that converters of known ratio class
+// inline all of the math (see TicksRatioConverter) and TicksRatio only
+// dispatches on ratio class
+//
+struct TicksRatioBase {
+    // Allows precision to 4th decimal place
+    //
+    static const double _g_epsilon;
+};
+
+// num == denom
+//
+struct TicksRatioNull : public TicksRatioBase {
+    static Ticks fromExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return Ticks(static_cast<Ticks::type>(price));
+    }
+    
+    static double toExchangePrice(const Ticks& ticks, uint32_t num, uint32_t denom) {
+        return ticks.toDouble();
+    }
+    
+    static double toFractionalExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return price;
+    }
+    
+    static double toFractionalTicks(const double& price, uint32_t num, uint32_t denom) {
+        return price;
+    }
+};
+
+// denom == 1
+//
+struct TicksRatioNum : public TicksRatioBase {
+    static Ticks fromExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return Ticks(static_cast<Ticks::type>(toFractionalTicks(price, num, denom)+_g_epsilon));
+    }
+    
+    static double toExchangePrice(const Ticks& ticks, uint32_t num, uint32_t denom) {
+        return ticks*num;
+    }
+    
+    static double toFractionalExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return price*num;
+    }
+    
+    static double toFractionalTicks(const double& price, uint32_t num, uint32_t denom) {
+        return price/num;
+    }
+};
+
+// num == 1
+//
+struct TicksRatioDenom : public TicksRatioBase {
+    static Ticks fromExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return Ticks(static_cast<Ticks::type>(toFractionalTicks(price, num, denom)+_g_epsilon));
+    }
+    
+    static double toExchangePrice(const Ticks& ticks, uint32_t num, uint32_t denom) {
+        return static_cast<double>(ticks)/denom;
+    }
+    
+    static double toFractionalExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return price/denom;
+    }
+    
+    static double toFractionalTicks(const double& price, uint32_t num, uint32_t denom) {
+        return (price*denom);
+    }
+};
+
+struct TicksRatioFull : public TicksRatioBase {
+    static Ticks fromExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return Ticks(static_cast<Ticks::type>(toFractionalTicks(price, num, denom)+_g_epsilon));
+    }
+    
+    static double toExchangePrice(const Ticks& ticks, uint32_t num, uint32_t denom) {
+        return static_cast<double>(ticks)*num/denom;
+    }
+    
+    static double toFractionalExchangePrice(const double& price, uint32_t num, uint32_t denom) {
+        return price*num/denom;
+    }
+    
+    static double toFractionalTicks(const double& price, uint32_t num, uint32_t denom) {
+        return ((price*denom)/num);
+    }
+};
+
+// Converter of a ratio class known at compile time - for code which knows
+// instrument's ratio class upfront. Instruments' converters (TicksConverter
+// and its function objects) resolve ratio class at run time and dispatch
+// on it per call (see TicksRatio)
+//
+template <typename TRatio>
+class TicksRatioConverter {
+public:
+    TicksRatioConverter(uint32_t num = 1, uint32_t denom = 1) : _num(num),
+                                                                _denom(denom) {
+    }
+    
+public:
+    Ticks fromExchangePrice(const double& price) const {
+        return TRatio::fromExchangePrice(price, _num, _denom);
+    }
+    
+    double toExchangePrice(const Ticks& ticks) const {
+        return TRatio::toExchangePrice(ticks, _num, _denom);
+    }
+    
+    double toFractionalExchangePrice(const double& price) const {
+        return TRatio::toFractionalExchangePrice(price, _num, _denom);
+    }
+    
+    double toFractionalTicks(const double& price) const {
+        return TRatio::toFractionalTicks(price, _num, _denom);
+    }
+    
+private:
+    uint32_t _num;
+    uint32_t _denom;
+};
+
+// Instrument's tick ratio - ratio class is resolved once in set() and
+// each conversion is a switch on it with inlined math of the class. Price
+// of x ticks is x*tickNumerator/tickDenominator, so calculations on ticks
+// and sizes can be done in integers and only the final value converted
+// to double with a single rounding
+//
+// Meant to be cached per instrument by per quote analytics (see ITv)
+//
+class TicksRatio {
+public:
+    enum eClass {
+        kNull,
+        kNum,
+        kDenom,
+        kFull
+    };
+    
+public:
+    TicksRatio() {
+        set(1, 1);
+    }
+    
+    TicksRatio(uint32_t num, uint32_t denom) {
+        set(num, denom);
+    }
+    
+    void set(uint32_t num, uint32_t denom) {
+        _num = num;
+        _denom = denom;
+        
+        if ( num == denom )
+            _class = kNull;
+        else if ( 1 == denom )
+            _class = kNum;
+        else if ( 1 == num )
+            _class = kDenom;
+        else
+            _class = kFull;
+    }
+    
+    eClass getClass() const {
+        return _class;
+    }
+    
+    uint32_t getNumerator() const {
+        return _num;
+    }
+    
+    uint32_t getDenominator() const {
+        return _denom;
+    }
+    
+public:
+    Ticks fromExchangePrice(const double& price) const {
+        switch ( _class ) {
+            case kNum:
+                return TicksRatioNum::fromExchangePrice(price, _num, _denom);
+            case kDenom:
+                return TicksRatioDenom::fromExchangePrice(price, _num, _denom);
+            case kFull:
+                return TicksRatioFull::fromExchangePrice(price, _num, _denom);
+            default:
+                return TicksRatioNull::fromExchangePrice(price, _num, _denom);
+        }
+    }
+    
+    double toExchangePrice(const Ticks& ticks) const {
+        switch ( _class ) {
+            case kNum:
+                return TicksRatioNum::toExchangePrice(ticks, _num, _denom);
+            case kDenom:
+                return TicksRatioDenom::toExchangePrice(ticks, _num, _denom);
+            case kFull:
+                return TicksRatioFull::toExchangePrice(ticks, _num, _denom);
+            default:
+                return TicksRatioNull::toExchangePrice(ticks, _num, _denom);
+        }
+    }
+    
+    // Exchange price of fractional ticks given as ticksNumerator/ticksDenominator
+    // (e.g. notional in ticks over volume)
+    //
+    double toExchangePrice(int64_t ticksNumerator, int64_t ticksDenominator) const {
+        return (static_cast<double>(ticksNumerator)*_num)/(static_cast<double>(ticksDenominator)*_denom);
+    }
+    
+    double toFractionalExchangePrice(const double& price) const {
+        switch ( _class ) {
+            case kNum:
+                return TicksRatioNum::toFractionalExchangePrice(price, _num, _denom);
+            case kDenom:
+                return TicksRatioDenom::toFractionalExchangePrice(price, _num, _denom);
+            case kFull:
+                return TicksRatioFull::toFractionalExchangePrice(price, _num, _denom);
+            default:
+                return TicksRatioNull::toFractionalExchangePrice(price, _num, _denom);
+        }
+    }
+    
+    double toFractionalTicks(const double& price) const {
+        switch ( _class ) {
+            case kNum:
+                return TicksRatioNum::toFractionalTicks(price, _num, _denom);
+            case kDenom:
+                return TicksRatioDenom::toFractionalTicks(price, _num, _denom);
+            case kFull:
+                return TicksRatioFull::toFractionalTicks(price, _num, _denom);
+            default:
+                return TicksRatioNull::toFractionalTicks(price, _num, _denom);
+        }
+    }
+    
+private:
+    eClass _class;
+    uint32_t _num;
+    uint32_t _denom;
+};
+
+// Sum of price*size in ticks (e.g. notional of trades) and of sizes, kept
+// exact in integers however many are added
+//
+class TicksNotional {
+public:
+    TicksNotional() {
+        clear();
+    }
+    
+    void clear() {
+        _ticks = 0;
+        _size = 0;
+    }
+    
+    void add(const Ticks& price, const Size& size) {
+        _ticks += static_cast<int64_t>(price.get())*size.get();
+        _size += size.get();
+    }
+    
+public:
+    int64_t getTicks() const {
+        return _ticks;
+    }
+    
+    int64_t getSize() const {
+        return _size;
+    }
+    
+    double getAvgTicks() const {
+        return (0 != _size) ? static_cast<double>(_ticks)/_size : 0.0;
+    }
+    
+    double getAvgPrice(const TicksRatio& ratio) const {
+        return (0 != _size) ? ratio.toExchangePrice(_ticks, _size) : 0.0;
+    }
+    
+private:
+    int64_t _ticks;
+    int64_t _size;
+};
+
+// Function object of one of TicksRatio's conversions - held by value
+// (e.g. in QuoteSubscribers) and called as a function
+//
+template <typename TResult, typename TArg, TResult (TicksRatio::*TMethod)(const TArg&) const>
+class TicksRatioFunction {
+public:
+    TicksRatioFunction() {
+    }
+    
+    explicit TicksRatioFunction(const TicksRatio& ratio) : _ratio(ratio) {
+    }
+    
+    TResult operator()(const TArg& v) const {
+        return (_ratio.*TMethod)(v);
+    }
+    
+private:
+    TicksRatio _ratio;
+};
+
 // NOTE:  this class might need to be made a base class if more than
 // one kind of tick converters are needed, for example, if there are
 // different tick sizes based on price levels for the same instrument
@@ -15,34 +318,28 @@ namespace price {
 
 class TicksConverter 
 {
-    static const double _g_epsilon;
-    
 public:
-    typedef tw::functional::delegate1<Ticks, const double&> TConverterFrom;
-    typedef tw::functional::delegate1<double, const Ticks&> TConverterTo;
-    typedef tw::functional::delegate1<double, const double&> TConverterToFractional;
-    typedef tw::functional::delegate1<double, const double&> TConverterFractional;
+    typedef TicksRatioFunction<Ticks, double, &TicksRatio::fromExchangePrice> TConverterFrom;
+    typedef TicksRatioFunction<double, Ticks, &TicksRatio::toExchangePrice> TConverterTo;
+    typedef TicksRatioFunction<double, double, &TicksRatio::toFractionalExchangePrice> TConverterToFractional;
+    typedef TicksRatioFunction<double, double, &TicksRatio::toFractionalTicks> TConverterFractional;
     
     // Create NULL converters
     //
     static TConverterFrom createFrom() {
-        static ConverterNull _converterNull;
-        return TConverterFrom::from_method<ConverterNull, &ConverterNull::fromExchangePrice>(&_converterNull);
+        return TConverterFrom();
     }    
     
     static TConverterTo createTo() {
-        static ConverterNull _converterNull;
-        return TConverterTo::from_method<ConverterNull, &ConverterNull::toExchangePrice>(&_converterNull);
+        return TConverterTo();
     }
     
     static TConverterToFractional createToFractional() {
-        static ConverterNull _converterNull;
-        return TConverterFractional::from_method<ConverterNull, &ConverterNull::toFractionalExchangePrice>(&_converterNull);
+        return TConverterToFractional();
     }
     
     static TConverterFractional createFractional() {
-        static ConverterNull _converterNull;
-        return TConverterFractional::from_method<ConverterNull, &ConverterNull::toFractionalTicks>(&_converterNull);
+        return TConverterFractional();
     }
         
 public:
@@ -120,28 +417,28 @@ public:
     // (e.g.: from price feed or matching engine) to ticks
     //
     Ticks fromExchangePrice(const double& price) {
-        return _convertFrom(price);
+        return _ratio.fromExchangePrice(price);
     }
     
     // Use this method to convert ticks to prices to send to exchange
     // (e.g.: matching engine)
     //
     double toExchangePrice(const Ticks& ticks) {
-        return _convertTo(ticks);
+        return _ratio.toExchangePrice(ticks);
     }
     
     // Use this method to convert fractional ticks to prices in exchange format
     // (e.g.: matching engine)
     //
     double toFractionalExchangePrice(const double& price) {
-        return _convertToFractional(price);
+        return _ratio.toFractionalExchangePrice(price);
     }
     
     // Use this method to calculate fractional number
     // of ticks (e.g. for avgPrice - fill._price)
     //
     double fractionalTicks(const double& price) {
-        return _convertFractional(price);
+        return _ratio.toFractionalTicks(price);
     }
     
 public:
@@ -157,148 +454,12 @@ public:
         return _convertToFractional;
     }
     
-private:
-    // Optimized converters for different numerator/denominator values
-    //
-    class ConverterNull {
-    public:
-        Ticks fromExchangePrice(const double& price) {
-            return Ticks(static_cast<Ticks::type>(price));
-        }
-        
-        double toExchangePrice(const Ticks& ticks) {
-            return ticks.toDouble();
-        }
-        
-        double toFractionalExchangePrice(const double& price) {
-            return price;
-        }
-        
-        double toFractionalTicks(const double& price) {
-            return price;
-        }
-    };
-
-    class ConverterNum {
-    public:
-        ConverterNum() {            
-            set(1);
-        }
-        
-        void set(uint32_t value) {
-            _num = value;
-        }
-        
-    public:
-        Ticks fromExchangePrice(const double& price) {
-            return Ticks(static_cast<Ticks::type>(toFractionalTicks(price)+_g_epsilon));
-        }
-        
-        double toExchangePrice(const Ticks& ticks) {
-            return ticks*_num;
-        }
-        
-        double toFractionalExchangePrice(const double& price) {
-            return price*_num;
-        }
-        
-        double toFractionalTicks(const double& price) {
-            return price/_num;
-        }
-        
-    private:
-        uint32_t _num;
-    };
-    
-    class ConverterDenom {
-    public:
-        ConverterDenom() {            
-            set(1);
-        }
-        
-        void set(uint32_t value) {
-            _denom = value;
-        }
-        
-    public:
-        Ticks fromExchangePrice(const double& price) {
-            return Ticks(static_cast<Ticks::type>(toFractionalTicks(price)+_g_epsilon));
-        }
-        
-        double toExchangePrice(const Ticks& ticks) {
-            return static_cast<double>(ticks)/_denom;
-        }
-        
-        double toFractionalExchangePrice(const double& price) {
-            return price/_denom;
-        }
-        
-        double toFractionalTicks(const double& price) {
-            return (price*_denom);
-        }
-        
-    private:
-        uint32_t _denom;
-    };
-    
-    class ConverterFull {
-    public:
-        ConverterFull() {
-            set(1, 1);
-        }
-                      
-        void set(uint32_t num, uint32_t denom) {
-            _num = num;
-            _denom = denom;
-        }
-        
-    public:
-        Ticks fromExchangePrice(const double& price) {
-            return Ticks(static_cast<Ticks::type>(toFractionalTicks(price)+_g_epsilon));
-        }
-        
-        double toExchangePrice(const Ticks& ticks) {
-            return static_cast<double>(ticks)*_num/_denom;
-        }
-        
-        double toFractionalExchangePrice(const double& price) {
-            return price*_num/_denom;
-        }
-        
-        double toFractionalTicks(const double& price) {
-            return ((price*_denom)/_num);
-        }
-        
-    private:
-        uint32_t _num;
-        uint32_t _denom;
-    };
-    
-private:
-    template<typename TClient>
-    TConverterFrom createFrom(TClient* client) {
-        return TConverterFrom::from_method<TClient, &TClient::fromExchangePrice>(client);
+    const TicksRatio& getRatio() const {
+        return _ratio;
     }
     
-    template<typename TClient>
-    TConverterTo createTo(TClient* client) {
-        return TConverterTo::from_method<TClient, &TClient::toExchangePrice>(client);
-    }
-    
-    template<typename TClient>
-    TConverterToFractional createToFractional(TClient* client) {
-        return TConverterToFractional::from_method<TClient, &TClient::toFractionalExchangePrice>(client);
-    }
-    
-    template<typename TClient>
-    TConverterFractional createFractional(TClient* client) {
-        return TConverterFractional::from_method<TClient, &TClient::toFractionalTicks>(client);
-    }
-
 private:    
-    ConverterNum _converterNum;
-    ConverterDenom _converterDenom;
-    ConverterFull _converterFull;
+    TicksRatio _ratio;
     
     TConverterFrom _convertFrom;
     TConverterTo _convertTo;
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <tw/log/defs.h>
+#include <tw/instr/instrument_manager.h>
+#include <tw/channel_or_cme/fix_message_view.h>
+#include <tw/generated/channel_or_defs.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace tw {
+namespace audit_cme {
+
+    // FIX 4.2 tags (and FIX 4.3 CFICode) of CME messages used in audit
+    //
+    namespace tags {
+        static const int32_t Account = 1;
+        static const int32_t ClOrdID = 11;
+        static const int32_t LastPx = 31;
+        static const int32_t LastShares = 32;
+        static const int32_t OrderID = 37;
+        static const int32_t OrderQty = 38;
+        static const int32_t OrdType = 40;
+        static const int32_t Price = 44;
+        static const int32_t SenderCompID = 49;
+        static const int32_t SenderSubID = 50;
+        static const int32_t SendingTime = 52;
+        static const int32_t Side = 54;
+        static const int32_t Symbol = 55;
+        static const int32_t TargetCompID = 56;
+        static const int32_t TargetSubID = 57;
+        static const int32_t Text = 58;
+        static const int32_t TimeInForce = 59;
+        static const int32_t StopPx = 99;
+        static const int32_t CxlRejReason = 102;
+        static const int32_t OrdRejReason = 103;
+        static const int32_t SecurityDesc = 107;
+        static const int32_t SenderLocationID = 142;
+        static const int32_t ExecType = 150;
+        static const int32_t MaturityMonthYear = 200;
+        static const int32_t StrikePrice = 202;
+        static const int32_t CustomerOrFirm = 204;
+        static const int32_t MaturityDay = 205;
+        static const int32_t MaxShow = 210;
+        static const int32_t CFICode = 461;
+        static const int32_t ManualOrderIndicator = 1028;
+        static const int32_t CorrelationClOrdID = 9717;
+    } // namespace tags
+
+    // Maps stored FIX session message to AuditCme record. Message is
+    // tokenized in place by FixMessageView (no OnixS engine/message is
+    // needed) and instruments looked up by SecurityDesc are cached, so
+    // that formatters on different threads don't contend on
+    // InstrumentManager
+    //
+    // NOTE: formatter is NOT thread safe - each thread needs its own
+    //
+    class AuditCmeFormatter {
+        typedef std::map<std::string, tw::instr::InstrumentPtr> TInstruments;
+
+    public:
+        // Returns false for messages, which aren't audited
+        //
+        bool format(const tw::channel_or::FixSessionCMEMsgForAudit& record, tw::channel_or::AuditCme& auditRecord) {
+            if ( !_message.parse(record._message) ) {
+                LOGGER_ERRO << "Failed to parse message: " << record._index << " :: " << record._message << "\n";
+                return false;
+            }
+
+            auditRecord.clear();
+            switch ( _message.getType() ) {
+                case 'D':   // New order single
+                    auditRecord._messageType = "NEW ORDER";
+                    break;
+                case 'F':   // Cancel
+                    auditRecord._messageType = "CANCEL";
+                    break;
+                case 'G':   // Modify
+                    auditRecord._messageType = "MODIFY";
+                    break;
+                case '8':   // Execution report
+                {
+                    auditRecord._messageType = "EXECUTION";
+                    switch ( _message.getChar(tags::ExecType) ) {
+                        case '0':
+                            auditRecord._orderStatus = "NEW ORDER ACK";
+                            break;
+                        case '1':
+                            auditRecord._orderStatus = "PARTIAL FILL";
+                            auditRecord._lastShares = getValue(tags::LastShares);
+                            auditRecord._fillPrice = getValue(tags::LastPx);
+                            break;
+                        case '2':
+                            auditRecord._orderStatus = "COMPLETE FILL";
+                            auditRecord._lastShares = getValue(tags::LastShares);
+                            auditRecord._fillPrice = getValue(tags::LastPx);
+                            break;
+                        case '4':
+                            auditRecord._orderStatus = "CANCEL ACK";
+                            break;
+                        case '5':
+                            auditRecord._orderStatus = "MODIFY ACK";
+                            break;
+                        case '8':
+                            auditRecord._orderStatus = "ORDER REJECTED";
+                            break;
+                        case 'C':
+                            auditRecord._orderStatus = "EXPIRED";
+                            break;
+                        case 'H':
+                            auditRecord._orderStatus = "TRADE CANCEL";
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                    auditRecord._reasonCode = getValue(tags::OrdRejReason);
+                    break;
+                case '9':   // Order Cancel reject
+                    auditRecord._messageType = "ORDER_CANCEL_REJECT";
+                    auditRecord._reasonCode = getValue(tags::CxlRejReason);
+                    break;
+                case '3':   // Business reject
+                    auditRecord._messageType = "BUSINESS_REJECT";
+                    auditRecord._reasonCode = getValue(tags::Text);
+                    break;
+                default:
+                    return false;
+            }
+
+            auditRecord._serverTransactionNumber = boost::lexical_cast<std::string>(record._index);
+            auditRecord._serverTimestamp = getValue(tags::SendingTime);
+            auditRecord._senderLocationID = getValue(tags::SenderLocationID);
+            auditRecord._manualOrderIdentifier = getValue(tags::ManualOrderIndicator);
+            auditRecord._exchangeCode = "CME";              // TODO: what values to put?
+            auditRecord._origin = "0";                      // NOTE: Per Ron Timpone from RCG as noted in email from 03/04/2015
+            if ( tw::channel_or::eDirection::kOutbound == record._direction ) {
+                auditRecord._messageDirection = "TO CME";       // NOTE: Per Ron Timpone from RCG email from 03/05/2015
+                setSession(getValue(tags::SenderCompID), auditRecord);
+                auditRecord._tag50 = getValue(tags::SenderSubID);
+            } else {
+                auditRecord._messageDirection = "FROM CME";     // NOTE: Per Ron Timpone from RCG email from 03/05/2015
+                setSession(getValue(tags::TargetCompID), auditRecord);
+                auditRecord._tag50 = getValue(tags::TargetSubID);
+            }
+            auditRecord._status = "OK";                     // TODO: what values to put?
+
+            auditRecord._accountNumber = getValue(tags::Account);
+            auditRecord._clientOrderID = getValue(tags::ClOrdID);
+            auditRecord._correlationClOrdID = getValue(tags::CorrelationClOrdID);
+            auditRecord._hostOrderNumber = getValue(tags::OrderID);
+
+            if ( _message.contain(tags::Side) ) {
+                if ( _message.isEqual(tags::Side, "1") )
+                    auditRecord._buyOrSellIndicator = "B";
+                else if ( _message.isEqual(tags::Side, "2") )
+                    auditRecord._buyOrSellIndicator = "S";
+                else
+                    auditRecord._buyOrSellIndicator = "?";
+            }
+
+            auditRecord._orderQty = getValue(tags::OrderQty);
+            auditRecord._maxShow = getValue(tags::MaxShow);
+            auditRecord._securityDesc = getValue(tags::SecurityDesc);
+            auditRecord._symbol = getValue(tags::Symbol);
+            auditRecord._strikePrice = getValue(tags::StrikePrice);
+            auditRecord._limitPrice = getValue(tags::Price);
+            auditRecord._stopPrice = getValue(tags::StopPx);
+
+            if ( _message.contain(tags::OrdType) ) {
+                if ( _message.isEqual(tags::OrdType, "2") )     // Limit
+                    auditRecord._orderType = "2";
+                else
+                    auditRecord._orderType = "?";
+            }
+
+            if ( !_message.contain(tags::TimeInForce) ) {
+                auditRecord._orderQualifier = "Day";
+            } else {
+                if ( _message.isEqual(tags::TimeInForce, "0") )
+                    auditRecord._orderQualifier = "Day";
+                else if ( _message.isEqual(tags::TimeInForce, "1") )
+                    auditRecord._orderQualifier = "GTC";
+                else
+                    auditRecord._orderQualifier = "?";
+            }
+
+            if ( _message.contain(tags::CustomerOrFirm) ) {
+                if ( _message.isEqual(tags::CustomerOrFirm, "0") )
+                    auditRecord._customerTypeIndicator = "4";
+                else if ( _message.isEqual(tags::CustomerOrFirm, "1") )
+                    auditRecord._customerTypeIndicator = "2";
+                else
+                    auditRecord._customerTypeIndicator = "?";
+            }
+
+            auditRecord._giveUpFirm = "";           // TODO: what values to put?
+            auditRecord._giveUpIndicator = "";      // TODO: what values to put?
+            auditRecord._allocAccount = "";         // TODO: what values to put?
+
+            tw::instr::InstrumentPtr instrument = getInstrument(auditRecord._securityDesc);
+            if ( instrument ) {
+                auditRecord._CFICode = instrument->_CFICode;
+                if ( instrument->_expirationDate.length() > 6 )
+                    auditRecord._maturityDate = instrument->_expirationDate.substr(0, 7);
+                else
+                    auditRecord._maturityDate = instrument->_expirationDate;
+            } else {
+                auditRecord._CFICode = getValue(tags::CFICode);
+                auditRecord._maturityDate = getValue(tags::MaturityMonthYear);
+                auditRecord._maturityDate += " ";
+                auditRecord._maturityDate += getValue(tags::MaturityDay);
+            }
+
+            return true;
+        }
+
+    private:
+        // Commas are replaced, since they delimit audit file's fields
+        //
+        std::string getValue(int32_t tag) const {
+            std::string value = _message.get(tag);
+            std::replace(value.begin(), value.end(), ',', '_');
+            return value;
+        }
+
+        static void setSession(const std::string& compId, tw::channel_or::AuditCme& auditRecord) {
+            if ( compId.length() > 3 )
+                auditRecord._sessionID = compId.substr(0, 3);
+
+            if ( compId.length() > 5 )
+                auditRecord._executingFirmNumber = compId.substr(3, 3);
+        }
+
+        tw::instr::InstrumentPtr getInstrument(const std::string& securityDesc) {
+            TInstruments::iterator iter = _instruments.find(securityDesc);
+            if ( iter != _instruments.end() )
+                return iter->second;
+
+            tw::instr::InstrumentPtr instrument = tw::instr::InstrumentManager::instance().getByDisplayName(securityDesc);
+            _instruments[securityDesc] = instrument;
+            return instrument;
+        }
+
+    private:
+        tw::channel_or_cme::FixMessageView _message;
+        TInstruments _instruments;
+    };
+
+} // namespace audit_cme
+} // namespace tw
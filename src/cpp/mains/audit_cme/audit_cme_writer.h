@@ -0,0 +1,156 @@
+#pragma once
+
+#include <tw/common/thread_placement.h>
+#include <tw/common_thread/thread_pipe.h>
+
+#include "selector_fix_msgs.h"
+#include "audit_cme_formatter.h"
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <ostream>
+
+namespace tw {
+namespace audit_cme {
+
+    // Streams records from selector to audit file in chunks of
+    // audit_cme.chunk_size: each chunk is split into contiguous slices,
+    // which are formatted by a pool of audit_cme.threads worker threads
+    // (started once per run) while the next chunk is read from selector,
+    // and slices are written in order, so output is the same as of serial
+    // processing and at most two chunks are in memory at once
+    //
+    class AuditCmeWriter {
+        typedef std::vector<AuditCmeFormatter> TFormatters;
+        typedef std::vector<std::string> TSlices;
+        typedef std::vector<tw::common_thread::ThreadPtr> TThreads;
+        typedef tw::common_thread::ThreadPipe<const TRecords*> TJobs;
+        typedef boost::shared_ptr<TJobs> TJobsPtr;
+        typedef tw::common_thread::ThreadPipe<size_t> TDone;
+
+    public:
+        AuditCmeWriter(uint32_t threads, uint32_t chunkSize) : _formatters((threads > 0) ? threads : 1),
+                                                               _slices(_formatters.size()),
+                                                               _chunkSize((chunkSize > 0) ? chunkSize : 1),
+                                                               _count(0) {
+        }
+
+        // Writes header and audit records of all selector's records
+        //
+        bool run(ISelectorFixMsgs& selector, std::ostream& out) {
+            _count = 0;
+            out << tw::channel_or::AuditCme::header() << "\n";
+
+            TRecords records;
+            TRecords next;
+            if ( !selector.readChunk(_chunkSize, records) )
+                return false;
+
+            if ( _formatters.size() > 1 )
+                startThreads();
+
+            bool status = true;
+            while ( status && !records.empty() ) {
+                if ( _threads.empty() ) {
+                    formatSlice(records, 0);
+                    status = selector.readChunk(_chunkSize, next);
+                } else {
+                    for ( size_t i = 0; i < _jobs.size(); ++i )
+                        _jobs[i]->push(&records);
+
+                    status = selector.readChunk(_chunkSize, next);
+
+                    size_t slice = 0;
+                    for ( size_t i = 0; i < _jobs.size(); ++i )
+                        _done.read(slice);
+                }
+
+                for ( size_t i = 0; i < _slices.size(); ++i )
+                    out << _slices[i];
+
+                status = status && out.good();
+                if ( status ) {
+                    _count += records.size();
+                    records.swap(next);
+                }
+            }
+
+            stopThreads();
+            if ( !status )
+                return false;
+
+            out.flush();
+            return out.good();
+        }
+
+        // Number of records read from selector by last run()
+        //
+        uint64_t getCount() const {
+            return _count;
+        }
+
+    private:
+        void startThreads() {
+            for ( size_t i = 0; i < _formatters.size(); ++i )
+                _jobs.push_back(TJobsPtr(new TJobs()));
+
+            for ( size_t i = 0; i < _jobs.size(); ++i )
+                _threads.push_back(tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kWorker, boost::bind(&AuditCmeWriter::threadMain, this, _jobs[i], i)));
+        }
+
+        void stopThreads() {
+            for ( size_t i = 0; i < _jobs.size(); ++i )
+                _jobs[i]->stop();
+
+            for ( size_t i = 0; i < _threads.size(); ++i )
+                _threads[i]->join();
+
+            _threads.clear();
+            _jobs.clear();
+        }
+
+        // Formats its slice of each chunk until stopped
+        //
+        void threadMain(TJobsPtr jobs, size_t slice) {
+            while ( true ) {
+                const TRecords* records = NULL;
+                jobs->read(records);
+                if ( NULL == records )
+                    return;
+
+                formatSlice(*records, slice);
+                _done.push(slice);
+            }
+        }
+
+        void formatSlice(const TRecords& records, size_t slice) {
+            size_t size = (records.size() + _slices.size() - 1) / _slices.size();
+            size_t begin = std::min(records.size(), slice*size);
+            size_t end = std::min(records.size(), begin+size);
+
+            std::string& out = _slices[slice];
+            out.clear();
+
+            AuditCmeFormatter& formatter = _formatters[slice];
+            tw::channel_or::AuditCme auditRecord;
+            for ( size_t i = begin; i < end; ++i ) {
+                if ( formatter.format(records[i], auditRecord) ) {
+                    out += auditRecord.toString();
+                    out += "\n";
+                }
+            }
+        }
+
+    private:
+        TFormatters _formatters;
+        TSlices _slices;
+        TThreads _threads;
+        std::vector<TJobsPtr> _jobs;
+        TDone _done;
+        uint32_t _chunkSize;
+        uint64_t _count;
+    };
+
+} // namespace audit_cme
+} // namespace tw
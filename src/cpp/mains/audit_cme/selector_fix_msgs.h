@@ -0,0 +1,156 @@
+#pragma once
+
+#include <tw/log/defs.h>
+#include <tw/common/settings.h>
+#include <tw/channel_db/channel_db.h>
+#include <tw/generated/channel_or_defs.h>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <fstream>
+#include <vector>
+
+namespace tw {
+namespace audit_cme {
+
+    typedef std::vector<tw::channel_or::FixSessionCMEMsgForAudit> TRecords;
+
+    // Source of stored FIX session messages - messages are read in chunks
+    // in order of their index, so that all messages never have to be in
+    // memory at once
+    //
+    class ISelectorFixMsgs {
+    public:
+        virtual ~ISelectorFixMsgs() {
+        }
+
+        virtual bool start(const tw::common::Settings& settings) = 0;
+
+        // Reads up to count next records - records are empty when all
+        // records were read
+        //
+        virtual bool readChunk(uint32_t count, TRecords& records) = 0;
+    };
+
+    typedef boost::shared_ptr<ISelectorFixMsgs> TSelectorFixMsgsPtr;
+
+    // Keyset scan of FixSessionCMEMsgs: each chunk continues after the last
+    // index of the previous one, so query's cost doesn't grow with offset
+    //
+    class SelectorFixMsgs : public ISelectorFixMsgs {
+    public:
+        SelectorFixMsgs() : _lastIndex(0) {
+        }
+
+        bool start(const tw::common::Settings& settings) {
+            _lastIndex = 0;
+            if ( !_channelDb.init(settings._db_connection_str) ) {
+                LOGGER_ERRO << "Failed to init channelDb with: "  << settings._db_connection_str << "\n";
+                return false;
+            }
+
+            return true;
+        }
+
+        bool readChunk(uint32_t count, TRecords& records) {
+            records.clear();
+
+            tw::channel_or::FixSessionCMEMsgs_GetChunk query;
+            if ( !query.execute(_channelDb, _lastIndex, count) ) {
+                LOGGER_ERRO << "Failed to execute FixSessionCMEMsgs_GetChunk() for: "
+                            << "last_index=" << _lastIndex
+                            << ",count=" << count
+                            << "\n";
+                return false;
+            }
+
+            records.swap(query._o1);
+            if ( !records.empty() )
+                _lastIndex = records.back()._index;
+
+            return true;
+        }
+
+    private:
+        tw::channel_db::ChannelDb _channelDb;
+        uint32_t _lastIndex;
+    };
+
+    // Stand-in for db: reads records from audit_cme.source_file, one record
+    // per line as: index<TAB>direction<TAB>raw FIX message. Records'
+    // toString() format can't be used, since FIX values may have commas in
+    // them. Empty lines and lines starting with '#' are skipped
+    //
+    class SelectorFixMsgsFile : public ISelectorFixMsgs {
+    public:
+        static const char DELIM = '\t';
+
+    public:
+        bool start(const tw::common::Settings& settings) {
+            _fileName = settings._audit_cme_source_file;
+
+            _file.close();
+            _file.clear();
+            _file.open(_fileName.c_str());
+            if ( !_file.good() ) {
+                LOGGER_ERRO << "Failed to open file: " << _fileName << "\n";
+                return false;
+            }
+
+            return true;
+        }
+
+        bool readChunk(uint32_t count, TRecords& records) {
+            records.clear();
+            if ( !_file.is_open() )
+                return false;
+
+            std::string line;
+            while ( records.size() < count && std::getline(_file, line) ) {
+                if ( line.empty() || '#' == line[0] )
+                    continue;
+
+                records.push_back(tw::channel_or::FixSessionCMEMsgForAudit());
+                if ( !parse(line, records.back()) ) {
+                    LOGGER_ERRO << "Failed to parse: " << line << "\n";
+                    records.pop_back();
+                }
+            }
+
+            return true;
+        }
+
+        static std::string toLine(const tw::channel_or::FixSessionCMEMsgForAudit& record) {
+            return boost::lexical_cast<std::string>(record._index) + DELIM + record._direction.toString() + DELIM + record._message;
+        }
+
+    private:
+        static bool parse(const std::string& line, tw::channel_or::FixSessionCMEMsgForAudit& record) {
+            size_t first = line.find(DELIM);
+            if ( std::string::npos == first )
+                return false;
+
+            size_t second = line.find(DELIM, first+1);
+            if ( std::string::npos == second )
+                return false;
+
+            try {
+                record._index = boost::lexical_cast<uint32_t>(line.substr(0, first));
+            } catch(...) {
+                return false;
+            }
+
+            record._direction.fromString(line.substr(first+1, second-first-1));
+            record._message = line.substr(second+1);
+
+            return record._direction.isValid();
+        }
+
+    private:
+        std::string _fileName;
+        std::ifstream _file;
+    };
+
+} // namespace audit_cme
+} // namespace tw
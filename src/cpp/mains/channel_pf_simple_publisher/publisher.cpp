@@ -101,6 +101,10 @@ void Publisher::clear() {
     
     terminateThreadRecord();
     terminateThreadReplay();
+    
+    // Segment itself is kept for readers to continue after restart
+    //
+    _shmRing.close();
 }
 
 void Publisher::waitForReplayToFinish() {
@@ -243,6 +247,15 @@ bool Publisher::init(const tw::common::Settings& settings, const tw::risk::Strat
                 break;
         }
         
+        if ( !settings._publisher_pf_shm_name.empty() && tw::common::ePublisherPfMode::kRecord != settings._publisher_pf_mode ) {
+            if ( !_shmRing.create(settings._publisher_pf_shm_name, settings._publisher_pf_shm_capacity) ) {
+                LOGGER_ERRO << "Can't create shared memory quotes ring: " << settings._publisher_pf_shm_name << "\n";
+                return false;
+            }
+            
+            LOGGER_INFO << "Publishing to shared memory quotes ring: " << settings._publisher_pf_shm_name << " of capacity: " << _shmRing.capacity() << "\n";
+        }
+        
         _settings = settings;
     } catch(const std::exception& e) {
         LOGGER_ERRO << "Exception: "  << e.what() << "\n" << "\n";        
@@ -412,6 +425,8 @@ void Publisher::onQuote(const tw::price::Quote& quote) {
             return;
         }
         
+        publishToShm(quote._timestamp1, quote);
+        
         TConnectionSubscriptions::iterator iter = _connectionSubscriptions.begin();
         TConnectionSubscriptions::iterator end = _connectionSubscriptions.end();
         
@@ -432,6 +447,18 @@ void Publisher::onQuote(const tw::price::Quote& quote) {
     }
 }
 
+// Single write to shared memory ring serves all strategy processes attached
+// to it with channel_pf_shm
+//
+void Publisher::publishToShm(const tw::common::THighResTime& timestamp, const tw::price::QuoteWire& quoteWire) {
+    if ( !_shmRing.isOpen() )
+        return;
+    
+    _shmQuote._timestamp = timestamp;
+    _shmQuote._quoteWire = quoteWire;
+    _shmRing.write(_shmQuote);
+}
+
 void Publisher::serializeQuote(const tw::price::Quote& quote) {
     static uint64_t counter = 0;
     const tw::price::TicksConverter::TConverterTo& c = quote.getInstrument()->_tc->getConverterTo();
@@ -582,10 +609,12 @@ void Publisher::replay() {
                     }
                 }
 
-                tw::common::THighResTime::now().toString().copy(&buffer[0], TIMESTAMP_LENGTH);
+                tw::common::THighResTime now = tw::common::THighResTime::now();
+                now.toString().copy(&buffer[0], TIMESTAMP_LENGTH);
                 tw::common_strat::StrategyContainer::instance().sendToAllMsgBusConnections(buffer);
                 
                 tw::price::QuoteWire* quoteWire=reinterpret_cast<tw::price::QuoteWire*>(&buffer[TIMESTAMP_LENGTH+HEADER_LENGTH]);
+                publishToShm(now, *quoteWire);
                 tw::price::QuoteStore::TQuote& quote = tw::price::QuoteStore::instance().getQuoteByKeyId(quoteWire->_instrumentId);
                 if ( quote.isValid() )
                     static_cast<tw::price::QuoteWire&>(quote) = *quoteWire;
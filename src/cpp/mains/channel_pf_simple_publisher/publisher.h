@@ -3,6 +3,7 @@
 #include <tw/log/defs.h>
 #include <tw/instr/instrument_manager.h>
 #include <tw/channel_pf_cme/settings.h>
+#include <tw/channel_pf_shm/channel_pf_shm.h>
 
 #include <tw/common_strat/istrategy.h>
 #include <tw/common_strat/strategy_container.h>
@@ -81,6 +82,7 @@ private:
     
 private:
     void serializeQuote(const tw::price::Quote& quote);
+    void publishToShm(const tw::common::THighResTime& timestamp, const tw::price::QuoteWire& quoteWire);
     
     void threadMainRecord();
     void terminateThreadRecord();
@@ -117,4 +119,7 @@ private:
     
     TPool _pool;
     TThreadPipe _threadPipe;
+    
+    tw::channel_pf_shm::TQuoteShmRing _shmRing;
+    tw::channel_pf_shm::QuoteShm _shmQuote;
 };
@@ -10,6 +10,8 @@
 #include <tw/generated/channel_or_defs.h>
 
 #include <fstream>
+#include <map>
+#include <vector>
 
 namespace tw {
 namespace pnl_audit {
@@ -17,19 +19,18 @@ namespace pnl_audit {
     public:
         typedef tw::channel_or::PnLAuditTrailInfo TPnLAuditTrailInfo;
         typedef std::vector<tw::channel_or::PnLAuditTrailInfo> TPnLAuditTrailInfos;
-        typedef std::map<std::string, std::string> TStratPreviousInfo;
         
         typedef tw::channel_or::PnLAuditStatsInfo TPnLAuditStatsInfo;
         typedef tw::channel_or::PnLAuditStratStatsInfo TPnLAuditStratStatsInfo;
         typedef std::map<std::string, TPnLAuditStratStatsInfo> TPnLAuditStratStatsInfos;
         
     public:
-        PnLAudit() {
+        PnLAudit() : _mode(tw::common::ePnLAuditMode::kBoth) {
         }
         
         void clear() {
             _timestamps.clear();
-            _stratsToPnLAuditTrailInfos.clear();
+            _strats.clear();
             _pnLAuditStratStatsInfos.clear();
         }
         
@@ -38,85 +39,139 @@ namespace pnl_audit {
             return tw::common::Filesystem::create_dir(_dirName);
         }
         
+        const std::string& getDirName() const {
+            return _dirName;
+        }
+        
+        void setDirName(const std::string& dirName) {
+            _dirName = dirName;
+        }
+        
+        std::string getFileName(const tw::common::Settings& settings, const std::string account) {
+            std::string fileName = _dirName + "/pnl_audit_";
+            fileName += formatTimestamp(settings._pnl_audit_start_time) + "_" + formatTimestamp(settings._pnl_audit_end_time);
+            fileName += "_" + account + ".csv";
+            return fileName;
+        }
+        
         bool process(const TPnLAuditTrailInfos& infos, const tw::common::Settings& settings, const std::string& account) {
+            if ( !begin(settings, account) )
+                return false;
+            
+            process(infos);
+            return end();
+        }
+        
+    public:
+        // Streaming interface - account's records are passed to process()
+        // in chunks (in storage's order) between begin() and end(), only
+        // per strategy/timestamp aggregates are kept in between
+        //
+        bool begin(const tw::common::Settings& settings, const std::string& account) {
             clear();
             
-            std::string filename = getFileName(settings, account);
-            std::ofstream file(filename.c_str(), std::ios_base::out | std::ios_base::trunc);
-            if ( !file.good() ) {
-                LOGGER_ERRO << "Failed to open file: " << filename << "\n";
+            _mode = settings._pnl_audit_mode;
+            _fileName = getFileName(settings, account);
+            
+            _file.close();
+            _file.clear();
+            _file.open(_fileName.c_str(), std::ios_base::out | std::ios_base::trunc);
+            if ( !_file.good() ) {
+                LOGGER_ERRO << "Failed to open file: " << _fileName << "\n";
                 return false;
             }
             
-            LOGGER_INFO << "Results will be written to file: " << filename << "\n";
-            
-            bool status = true;
-            switch ( settings._pnl_audit_mode ) {
+            LOGGER_INFO << "Results will be written to file: " << _fileName << "\n";
+            return true;
+        }
+        
+        void process(const TPnLAuditTrailInfos& infos) {
+            switch ( _mode ) {
                 case tw::common::ePnLAuditMode::kPnLAnalysis:
-                    status = processAnalysis(infos, settings, file);
+                    for ( size_t i = 0; i < infos.size(); ++i )
+                        processAnalysis(infos[i]);
                     break;
                 default:
-                    status = processNormal(infos, settings, file);
+                    for ( size_t i = 0; i < infos.size(); ++i )
+                        processNormal(infos[i]);
+                    break;
+            }
+        }
+        
+        bool end() {
+            switch ( _mode ) {
+                case tw::common::ePnLAuditMode::kPnLAnalysis:
+                    outputAnalysis(_file);
+                    break;
+                default:
+                    outputNormal(_file);
                     break;
             }
             
-            file.close();
+            bool status = _file.good();
+            _file.close();
+            clear();
+            
+            if ( !status )
+                LOGGER_ERRO << "Failed to write file: " << _fileName << "\n";
+            
             return status;
         }
         
-        bool processAnalysis(const TPnLAuditTrailInfos& infos, const tw::common::Settings& settings, std::ofstream& file) {
-            for ( size_t i = 0; i < infos.size(); ++i ) {
-                TPnLAuditTrailInfo info = infos[i];
-                if ( "ACCOUNT" != info._parentType ) {
-                    TPnLAuditStratStatsInfo& stratStatsInfo = _pnLAuditStratStatsInfos[getStratName(info)];
+    private:
+        void processAnalysis(const TPnLAuditTrailInfo& record) {
+            TPnLAuditTrailInfo info = record;
+            if ( "ACCOUNT" != info._parentType ) {
+                TPnLAuditStratStatsInfo& stratStatsInfo = _pnLAuditStratStatsInfos[getStratName(info)];
 
-                    stratStatsInfo._accountId = info._accountId;
-                    stratStatsInfo._strategyId = info._strategyId;
-                    
-                    if ( NULL != info._instrument1.get() )
-                        stratStatsInfo._instrument1 = info._instrument1;
-                    
-                    if ( NULL != info._instrument2.get() )
-                        stratStatsInfo._instrument2 = info._instrument2;
-                    
+                stratStatsInfo._accountId = info._accountId;
+                stratStatsInfo._strategyId = info._strategyId;
+                
+                if ( NULL != info._instrument1.get() )
+                    stratStatsInfo._instrument1 = info._instrument1;
+                
+                if ( NULL != info._instrument2.get() )
+                    stratStatsInfo._instrument2 = info._instrument2;
+                
+                
+                if ( 0 != info._pos1.get() || 0 != info._pos2.get() ) {
+                    if ( 0 == stratStatsInfo._pos1.get() && 0 == stratStatsInfo._pos2.get() ) {
+                        TPnLAuditStatsInfo statsInfo;
+                        statsInfo._timestamp1 = info._eventTimestamp;
+                        stratStatsInfo._statsInfos.push_back(statsInfo);
+                    }
                     
-                    if ( 0 != info._pos1.get() || 0 != info._pos2.get() ) {
-                        if ( 0 == stratStatsInfo._pos1.get() && 0 == stratStatsInfo._pos2.get() ) {
-                            TPnLAuditStatsInfo statsInfo;
-                            statsInfo._timestamp1 = info._eventTimestamp;
-                            stratStatsInfo._statsInfos.push_back(statsInfo);
-                        }
-                        
-                        if ( 0 == stratStatsInfo._pos1.get() && 0 != info._pos1.get() )
-                            stratStatsInfo._statsInfos.back()._entrySide1 = (0 < info._pos1.get()) ? tw::channel_or::eOrderSide::kBuy : tw::channel_or::eOrderSide::kSell;
-                        else if ( 0 == stratStatsInfo._pos2.get() && 0 != info._pos2.get() )
-                            stratStatsInfo._statsInfos.back()._entrySide2 = (0 < info._pos2.get()) ? tw::channel_or::eOrderSide::kBuy : tw::channel_or::eOrderSide::kSell;
+                    if ( 0 == stratStatsInfo._pos1.get() && 0 != info._pos1.get() )
+                        stratStatsInfo._statsInfos.back()._entrySide1 = (0 < info._pos1.get()) ? tw::channel_or::eOrderSide::kBuy : tw::channel_or::eOrderSide::kSell;
+                    else if ( 0 == stratStatsInfo._pos2.get() && 0 != info._pos2.get() )
+                        stratStatsInfo._statsInfos.back()._entrySide2 = (0 < info._pos2.get()) ? tw::channel_or::eOrderSide::kBuy : tw::channel_or::eOrderSide::kSell;
 
-                        stratStatsInfo._pos1 = info._pos1;
-                        stratStatsInfo._pos2 = info._pos2;
-                        updateStatsInfo(info, stratStatsInfo._statsInfos.back());
-                    } else if ( 0 != stratStatsInfo._pos1.get() || 0 != stratStatsInfo._pos2.get() ) {
-                        TPnLAuditStatsInfo& statsInfo = stratStatsInfo._statsInfos.back();
-                        statsInfo._timestamp2 = info._eventTimestamp;
+                    stratStatsInfo._pos1 = info._pos1;
+                    stratStatsInfo._pos2 = info._pos2;
+                    updateStatsInfo(info, stratStatsInfo._statsInfos.back());
+                } else if ( 0 != stratStatsInfo._pos1.get() || 0 != stratStatsInfo._pos2.get() ) {
+                    TPnLAuditStatsInfo& statsInfo = stratStatsInfo._statsInfos.back();
+                    statsInfo._timestamp2 = info._eventTimestamp;
 
-                        stratStatsInfo._pos1 = info._pos1;
-                        stratStatsInfo._pos2 = info._pos2;
+                    stratStatsInfo._pos1 = info._pos1;
+                    stratStatsInfo._pos2 = info._pos2;
 
-                        if ( info._instrument1.get() != NULL )
-                            statsInfo._netTicks1 = (info._realizedInDollars1 - stratStatsInfo._prevPnL1) / info._instrument1->_tickValue;
+                    if ( info._instrument1.get() != NULL )
+                        statsInfo._netTicks1 = (info._realizedInDollars1 - stratStatsInfo._prevPnL1) / info._instrument1->_tickValue;
 
-                        if ( info._instrument2.get() != NULL )
-                            statsInfo._netTicks2 = (info._realizedInDollars2 - stratStatsInfo._prevPnL2) / info._instrument2->_tickValue;
+                    if ( info._instrument2.get() != NULL )
+                        statsInfo._netTicks2 = (info._realizedInDollars2 - stratStatsInfo._prevPnL2) / info._instrument2->_tickValue;
 
-                        statsInfo._netPnL = info._realizedInDollars - stratStatsInfo._prevPnLTotal;
+                    statsInfo._netPnL = info._realizedInDollars - stratStatsInfo._prevPnLTotal;
 
-                        stratStatsInfo._prevPnL1 = info._realizedInDollars1;
-                        stratStatsInfo._prevPnL2 = info._realizedInDollars2;
-                        stratStatsInfo._prevPnLTotal = info._realizedInDollars;
-                    }
+                    stratStatsInfo._prevPnL1 = info._realizedInDollars1;
+                    stratStatsInfo._prevPnL2 = info._realizedInDollars2;
+                    stratStatsInfo._prevPnLTotal = info._realizedInDollars;
                 }
             }
-            
+        }
+        
+        void outputAnalysis(std::ofstream& file) {
             // Output header
             //
             file << "AccountId,StratId,StratName,Trade #,StartTime,EndTime,Time In Trade(in secs),EntrySideSym1,EntrySideSym2,NetTicksSym1,NetTicksSym2,NetPnL$,Best$UnRPnLSym1,Worst$UnRPnLSym1,Best$UnRPnLSym2,Worst$UnRPnLSym2,Best$UnRPnLSpread,Worst$UnRSpread" << "\n";
@@ -156,62 +211,48 @@ namespace pnl_audit {
                     }
                 }
             }
-            
-            return true;
         }
         
-        bool processNormal(const TPnLAuditTrailInfos& infos, const tw::common::Settings& settings, std::ofstream& file) {
-            std::string t;
-            std::string stratName;
+        void processNormal(const TPnLAuditTrailInfo& info) {
+            if ( ("ACCOUNT" == info._parentType && tw::common::ePnLAuditMode::kStrat == _mode) ||
+                 ("ACCOUNT" != info._parentType && tw::common::ePnLAuditMode::kAccount == _mode) )
+                return;
             
-            typedef std::map<std::string, double> TStratPeakPnL;
-            TStratPeakPnL stratPeakPnl;            
+            int64_t key = getTimestampKey(info._eventTimestamp);
+            if ( _timestamps.empty() || _timestamps.back().first != key )
+                _timestamps.push_back(TTimestamp(key, info._eventTimestamp.toString()));
             
-            for ( size_t i = 0; i < infos.size(); ++i ) {
-                if ( !_timestamps.empty() )
-                    t = _timestamps.back();
-                
-                TPnLAuditTrailInfo info = infos[i];
-                if ( ("ACCOUNT" == info._parentType && tw::common::ePnLAuditMode::kStrat == settings._pnl_audit_mode) ||
-                     ("ACCOUNT" != info._parentType && tw::common::ePnLAuditMode::kAccount == settings._pnl_audit_mode) )
-                    continue;
-                
-                if ( t != info._eventTimestamp.toString() )
-                    _timestamps.push_back(info._eventTimestamp.toString());
-                
-                stratName = getStratName(info);
-                TStratPeakPnL::iterator iter = stratPeakPnl.find(stratName);
-                if ( iter == stratPeakPnl.end() )
-                    iter = stratPeakPnl.insert(TStratPeakPnL::value_type(stratName, 0.0)).first;
-                
-                if ( iter->second < info._realizedInDollars )
-                    iter->second = info._realizedInDollars;
-                
-                info._peakRealizedInDollars = iter->second;
-                _stratsToPnLAuditTrailInfos[stratName][info._eventTimestamp.toString()] = info;
-            }
+            TStrat& strat = _strats[getStratName(info._accountId, info._strategyId)];
+            if ( strat._peakRealizedInDollars < info._realizedInDollars )
+                strat._peakRealizedInDollars = info._realizedInDollars;
+            
+            TRecord& record = strat._records[key];
+            record._unrealizedInDollars = info._unrealizedInDollars;
+            record._realizedInDollars = info._realizedInDollars;
+            record._peakRealizedInDollars = strat._peakRealizedInDollars;
             
+            // Strat's name suffix comes from its latest record
+            //
+            if ( strat._records.rbegin()->first == key ) {
+                if ( "ACCOUNT" != info._parentType ) {
+                    strat._suffix = "_" + info._displayName1;
+                    if ( !info._displayName2.empty() )
+                        strat._suffix += "_" + info._displayName2;
+                } else {
+                    strat._suffix = "_ACCOUNT";
+                }
+            }
+        }
+        
+        void outputNormal(std::ofstream& file) {
             {
-                TStratsToPnLAuditTrailInfos::iterator iter = _stratsToPnLAuditTrailInfos.begin();
-                TStratsToPnLAuditTrailInfos::iterator end = _stratsToPnLAuditTrailInfos.end();
+                TStrats::iterator iter = _strats.begin();
+                TStrats::iterator end = _strats.end();
                 std::string strats = "strats,";
                 std::string header = "timestamp";
                 for ( ; iter != end; ++iter ) {
                     header += ",$UnR PnL,$Real PnL,Total,Drawdown";
-                    strats += iter->first;
-                    
-                    TTimestampToTPnLAuditTrailInfo::reverse_iterator iter2 = iter->second.rbegin();
-                    if ( iter2 != iter->second.rend() ) {
-                        const TPnLAuditTrailInfo& info = iter2->second;
-                        if ( "ACCOUNT" != info._parentType) {
-                            strats += "_" + info._displayName1;
-                            if ( !info._displayName2.empty() )
-                                strats += "_" + info._displayName2;
-                        } else {
-                            strats += "_ACCOUNT";
-                        }
-                    }
-                    
+                    strats += iter->first + iter->second._suffix;
                     strats += ",,,,";
                 }
                     
@@ -219,38 +260,31 @@ namespace pnl_audit {
                 file << header << "\n";
             }
             
+            // Last values of each strat are carried forward to timestamps
+            // strat has no records for
+            //
+            std::vector<std::string> previous(_strats.size(), ",0,0,0,0");
             std::string r;
-            std::string r2;
-            TStratPreviousInfo stratPreviousInfo;
             for ( size_t i = 0; i < _timestamps.size(); ++i ) {
-                t = r = _timestamps[i];
-                TStratsToPnLAuditTrailInfos::iterator iter = _stratsToPnLAuditTrailInfos.begin();
-                TStratsToPnLAuditTrailInfos::iterator end = _stratsToPnLAuditTrailInfos.end();
-                for ( ; iter != end; ++iter ) {
-                    stratName = iter->first;
-                    TTimestampToTPnLAuditTrailInfo::iterator iter2 = iter->second.find(t);
-                    if ( iter2 != iter->second.end() ) {
-                        const TPnLAuditTrailInfo& info = iter2->second;
-                        r2 = "," 
-                           + boost::lexical_cast<std::string>(info._unrealizedInDollars) + "," 
-                           + boost::lexical_cast<std::string>(info._realizedInDollars) + "," 
-                           + boost::lexical_cast<std::string>(info._unrealizedInDollars + info._realizedInDollars) + "," 
-                           + boost::lexical_cast<std::string>(-1*(info._peakRealizedInDollars-info._realizedInDollars)+info._unrealizedInDollars);
-                        
-                        r += r2;
-                        stratPreviousInfo[stratName] = r2;
-                     } else {
-                        TStratPreviousInfo::iterator iter3 = stratPreviousInfo.find(stratName);
-                        if ( iter3 != stratPreviousInfo.end() )
-                            r += iter3->second;
-                        else
-                            r += ",0,0,0,0";
-                     }
+                r = _timestamps[i].second;
+                
+                TStrats::iterator iter = _strats.begin();
+                TStrats::iterator end = _strats.end();
+                for ( size_t j = 0; iter != end; ++iter, ++j ) {
+                    TRecords::iterator iter2 = iter->second._records.find(_timestamps[i].first);
+                    if ( iter2 != iter->second._records.end() ) {
+                        const TRecord& record = iter2->second;
+                        previous[j] = "," 
+                                    + boost::lexical_cast<std::string>(record._unrealizedInDollars) + "," 
+                                    + boost::lexical_cast<std::string>(record._realizedInDollars) + "," 
+                                    + boost::lexical_cast<std::string>(record._unrealizedInDollars + record._realizedInDollars) + "," 
+                                    + boost::lexical_cast<std::string>(-1*(record._peakRealizedInDollars-record._realizedInDollars)+record._unrealizedInDollars);
+                    }
+                    
+                    r += previous[j];
                 }
                 file << r << "\n";
             }
-            
-            return true;
         }
         
     private:
@@ -265,17 +299,22 @@ namespace pnl_audit {
             return t;
         }
         
-        std::string getFileName(const tw::common::Settings& settings, const std::string account) {
-            std::string fileName = _dirName + "/pnl_audit_";
-            fileName += formatTimestamp(settings._pnl_audit_start_time) + "_" + formatTimestamp(settings._pnl_audit_end_time);
-            fileName += "_" + account + ".csv";
-            return fileName;
-        }
-        
     private:
         std::string getStratName(TPnLAuditTrailInfo& info) {
             setInstruments(info);
-            return boost::lexical_cast<std::string>(info._accountId) + "_" + boost::lexical_cast<std::string>(info._strategyId);            
+            return getStratName(info._accountId, info._strategyId);
+        }
+        
+        static std::string getStratName(tw::channel_or::TAccountId accountId, tw::channel_or::TStrategyId strategyId) {
+            return boost::lexical_cast<std::string>(accountId) + "_" + boost::lexical_cast<std::string>(strategyId);
+        }
+        
+        // Micros since 2000-01-01 - records are keyed by it instead of
+        // timestamp's string
+        //
+        static int64_t getTimestampKey(const tw::common::THighResTime& t) {
+            static const tw::common::THighResTime epoch = tw::common::THighResTime::parse("20000101-00:00:00.000000");
+            return t - epoch;
         }
         
         void setInstruments(TPnLAuditTrailInfo& info) {
@@ -308,13 +347,42 @@ namespace pnl_audit {
         }
         
     private:
-        typedef std::vector<std::string> TTimestamps;
-        typedef std::map<std::string, TPnLAuditTrailInfo> TTimestampToTPnLAuditTrailInfo;
-        typedef std::map<std::string, TTimestampToTPnLAuditTrailInfo> TStratsToPnLAuditTrailInfos;
+        // Aggregates of strat's records by timestamp (in micros, see
+        // getTimestampKey())
+        //
+        struct TRecord {
+            TRecord() : _unrealizedInDollars(0.0),
+                        _realizedInDollars(0.0),
+                        _peakRealizedInDollars(0.0) {
+            }
+            
+            double _unrealizedInDollars;
+            double _realizedInDollars;
+            double _peakRealizedInDollars;
+        };
+        
+        typedef std::map<int64_t, TRecord> TRecords;
+        
+        struct TStrat {
+            TStrat() : _peakRealizedInDollars(0.0) {
+            }
+            
+            double _peakRealizedInDollars;
+            std::string _suffix;
+            TRecords _records;
+        };
+        
+        typedef std::pair<int64_t, std::string> TTimestamp;
+        typedef std::vector<TTimestamp> TTimestamps;
+        typedef std::map<std::string, TStrat> TStrats;
         
         std::string _dirName;
+        std::string _fileName;
+        std::ofstream _file;
+        tw::common::ePnLAuditMode _mode;
+        
         TTimestamps _timestamps;
-        TStratsToPnLAuditTrailInfos _stratsToPnLAuditTrailInfos;
+        TStrats _strats;
         TPnLAuditStratStatsInfos _pnLAuditStratStatsInfos;
     };
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <tw/common/thread_placement.h>
+#include <tw/common_thread/thread_pipe.h>
+
+#include "SelectorPnLAudit.h"
+#include "PnLAudit.h"
+
+#include <boost/bind.hpp>
+
+namespace tw {
+namespace pnl_audit {
+
+    // Runs accounts' audits on a pool of worker threads - each worker has
+    // its own selector (i.e. its own db connection/file handle) and its own
+    // PnLAudit and takes next account from the shared queue when done with
+    // the previous one. Records are streamed from selector to PnLAudit in
+    // chunks of pnl_audit.chunk_size
+    //
+    class PnLAuditRunner {
+        typedef std::vector<TSelectorPnLAuditPtr> TSelectors;
+        typedef tw::common_thread::ThreadPipe<std::string> TAccounts;
+        typedef std::vector<tw::common_thread::ThreadPtr> TThreads;
+        typedef tw::common_thread::Lock TLock;
+
+    public:
+        PnLAuditRunner() : _failed(0) {
+        }
+
+        // Selectors must be already started, one worker is run per selector
+        //
+        void addSelector(const TSelectorPnLAuditPtr& selector) {
+            _selectors.push_back(selector);
+        }
+
+        // Returns number of accounts, which failed to be processed
+        //
+        uint32_t run(const tw::common::Settings& settings, const std::string& dirName, const std::vector<std::string>& accounts) {
+            _failed = 0;
+            if ( _selectors.empty() )
+                return accounts.size();
+
+            _accounts.clear();
+            for ( size_t i = 0; i < accounts.size(); ++i )
+                _accounts.push(accounts[i]);
+
+            // Workers exit once queue is drained
+            //
+            _accounts.stop();
+
+            TThreads threads;
+            for ( size_t i = 0; i < _selectors.size(); ++i )
+                threads.push_back(tw::common::ThreadPlacement::instance().createThread(tw::common::ThreadPlacement::kWorker, boost::bind(&PnLAuditRunner::threadMain, this, boost::cref(settings), boost::cref(dirName), _selectors[i])));
+
+            for ( size_t i = 0; i < threads.size(); ++i )
+                threads[i]->join();
+
+            return _failed;
+        }
+
+        // Accounts without records in settings' time range don't get a
+        // results file
+        //
+        static bool processAccount(ISelectorPnLAudit& selector, PnLAudit& pnlAudit, const tw::common::Settings& settings, const std::string& account) {
+            if ( !selector.openAccount(settings, account) )
+                return false;
+
+            uint32_t chunkSize = (settings._pnl_audit_chunk_size > 0) ? settings._pnl_audit_chunk_size : 1;
+            ISelectorPnLAudit::TPnLAuditTrailInfos infos;
+            if ( !selector.readChunk(chunkSize, infos) )
+                return false;
+
+            if ( infos.empty() ) {
+                LOGGER_ERRO << "PnLAuditTrailInfos are empty for: "
+                            << "account=" << account
+                            << ",start_time=" << settings._pnl_audit_start_time
+                            << ",end_time=" << settings._pnl_audit_end_time
+                            << "\n";
+                return true;
+            }
+
+            if ( !pnlAudit.begin(settings, account) )
+                return false;
+
+            size_t count = 0;
+            while ( !infos.empty() ) {
+                count += infos.size();
+                pnlAudit.process(infos);
+
+                if ( !selector.readChunk(chunkSize, infos) ) {
+                    pnlAudit.end();
+                    return false;
+                }
+            }
+
+            LOGGER_INFO << "PnLAuditTrailInfos number of records for account: " << account << " :: " << count << "\n";
+            return pnlAudit.end();
+        }
+
+    private:
+        void threadMain(const tw::common::Settings& settings, const std::string& dirName, TSelectorPnLAuditPtr selector) {
+            PnLAudit pnlAudit;
+            pnlAudit.setDirName(dirName);
+
+            std::string account;
+            while ( true ) {
+                account.clear();
+                _accounts.read(account);
+                if ( account.empty() )
+                    break;
+
+                if ( !processAccount(*selector, pnlAudit, settings, account) ) {
+                    LOGGER_ERRO << "pnlAudit failed to process records for account: " << account << "\n";
+
+                    tw::common_thread::LockGuard<TLock> lock(_lock);
+                    ++_failed;
+                }
+            }
+        }
+
+    private:
+        TLock _lock;
+        uint32_t _failed;
+        TSelectors _selectors;
+        TAccounts _accounts;
+    };
+
+} // namespace pnl_audit
+} // namespace tw
@@ -5,6 +5,8 @@
 #include <tw/risk/risk_storage.h>
 #include <tw/generated/channel_or_defs.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <vector>
 
 namespace tw {
@@ -50,12 +52,42 @@ namespace pnl_audit {
         std::vector<std::string> _o1;
     };
     
-    class SelectorPnLAudit {
+    // Source of PnLAuditTrailInfo records - records of an account are
+    // read in chunks, so that account's records never have to be all in
+    // memory at once
+    //
+    class ISelectorPnLAudit {
     public:
         typedef std::vector<tw::channel_or::PnLAuditTrailInfo> TPnLAuditTrailInfos;
         
     public:
-        SelectorPnLAudit() {            
+        virtual ~ISelectorPnLAudit() {
+        }
+        
+        virtual bool start(tw::common::Settings& settings) = 0;
+        virtual bool populateAccounts(const tw::common::Settings& settings) = 0;
+        virtual const std::vector<std::string>& getAccounts() const = 0;
+        
+        // Positions selector at the first of account's records within
+        // settings' start/end time
+        //
+        virtual bool openAccount(const tw::common::Settings& settings, const std::string& account) = 0;
+        
+        // Reads up to count next records of opened account in storage's
+        // order - infos are empty when all records were read
+        //
+        virtual bool readChunk(uint32_t count, TPnLAuditTrailInfos& infos) = 0;
+    };
+    
+    typedef boost::shared_ptr<ISelectorPnLAudit> TSelectorPnLAuditPtr;
+    
+    // Keyset scan of account's PnLAuditTrail records: each chunk continues
+    // after the last index of the previous one, so query's cost doesn't
+    // grow with number of records already read
+    //
+    class SelectorPnLAudit : public ISelectorPnLAudit {
+    public:
+        SelectorPnLAudit() : _lastIndex(0) {            
         }
         
         bool start(tw::common::Settings& settings) {
@@ -120,40 +152,43 @@ namespace pnl_audit {
             return true;
         }
         
-        bool populatePnLAuditTrailInfosForAccount(const tw::common::Settings& settings, const std::string& account) {
+        bool openAccount(const tw::common::Settings& settings, const std::string& account) {
+            _account = account;
+            _startTime = settings._pnl_audit_start_time;
+            _endTime = settings._pnl_audit_end_time;
+            _lastIndex = 0;
+            
+            LOGGER_INFO << "Reading PnLAuditTrailInfos for: "
+                        << "account=" << _account
+                        << ",start_time=" << _startTime
+                        << ",end_time=" << _endTime
+                        << "\n";
+            
+            return true;
+        }
+        
+        bool readChunk(uint32_t count, TPnLAuditTrailInfos& infos) {
+            infos.clear();
             try {
-                _pnlAuditTrailInfos.clear();
-                
-                LOGGER_INFO << "Running PnLAuditTrail_GetAllForDate query for: start_time=" << settings._pnl_audit_start_time
-                            << ",end_time=" << settings._pnl_audit_end_time
-                            << "\n";
-
-                tw::channel_or::PnLAuditTrail_GetAllForDate query;
-                if ( !query.execute(_channelDb,  account, settings._pnl_audit_start_time, settings._pnl_audit_end_time) ) {
-                    LOGGER_ERRO << "Failed to execute PnLAuditTrail_GetAllForDate query for: "
-                                << "account=" << account
-                                << ",start_time=" << settings._pnl_audit_start_time
-                                << ",end_time=" << settings._pnl_audit_end_time
+                tw::channel_or::PnLAuditTrail_GetChunkForDate query;
+                if ( !query.execute(_channelDb, _account, _startTime, _endTime, _lastIndex, count) ) {
+                    LOGGER_ERRO << "Failed to execute PnLAuditTrail_GetChunkForDate query for: "
+                                << "account=" << _account
+                                << ",start_time=" << _startTime
+                                << ",end_time=" << _endTime
+                                << ",last_index=" << _lastIndex
                                 << "\n";
                     return false;
                 }
-
-                if ( query._o1.empty() ) {
-                    LOGGER_ERRO << "PnLAuditTrailInfos are empty for: "
-                                << "account=" << account
-                                << ",start_time=" << settings._pnl_audit_start_time
-                                << ",end_time=" << settings._pnl_audit_end_time
-                                << "\n";
-                    return false;
-                }
-                
-                _pnlAuditTrailInfos = query._o1;
                 
-                LOGGER_INFO << "PnLAuditTrailInfos number of records: " << _pnlAuditTrailInfos.size() << "\n";
+                infos.assign(query._o1.begin(), query._o1.end());
+                if ( !query._o1.empty() )
+                    _lastIndex = query._o1.back()._index;
             } catch (sql::SQLException &e) {
                 LOGGER_ERRO << "exception :: " << e.what() << "\n";
                 LOGGER_ERRO << "MySQL error code: " << e.getErrorCode() << "\n";
                 LOGGER_ERRO << "SQLState: " << e.getSQLState() << " )" << "\n";
+                return false;
             } catch(const std::exception& e) {
                 LOGGER_ERRO << "exception :: " << e.what() << "\n" << "\n";      
                 return false;
@@ -170,16 +205,16 @@ namespace pnl_audit {
             return _accounts;
         }            
         
-        const TPnLAuditTrailInfos& getPnLAuditTrailInfos() const {
-            return _pnlAuditTrailInfos;
-        }            
-        
     protected:
         tw::channel_db::ChannelDb _channelDb;
         tw::channel_db::ChannelDb::TConnectionPtr _con;
         
         std::vector<std::string> _accounts;
-        TPnLAuditTrailInfos _pnlAuditTrailInfos;
+        
+        std::string _account;
+        std::string _startTime;
+        std::string _endTime;
+        uint32_t _lastIndex;
     };
 
 } // namespace scalper
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "SelectorPnLAudit.h"
+
+#include <tw/common/column_store.h>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <algorithm>
+
+namespace tw {
+namespace pnl_audit {
+
+    // Reads PnLAuditTrailInfo records from local column store (see
+    // column_store.dir) instead of db. Blocks which can't have records of
+    // the account within settings' start/end time are skipped by their
+    // zone maps without being decoded
+    //
+    class SelectorPnLAuditColumnStore : public ISelectorPnLAudit {
+        static const char* TABLE;
+        static const char* TIME_COLUMN;
+
+    public:
+        SelectorPnLAuditColumnStore() : _startTime(0),
+                                        _endTime(0),
+                                        _index(0) {
+        }
+
+        bool start(tw::common::Settings& settings) {
+            if ( settings._column_store_dir.empty() ) {
+                LOGGER_ERRO << "column_store.dir is not set" << "\n";
+                return false;
+            }
+
+            if ( !_store.open(settings._column_store_dir) )
+                return false;
+
+            if ( settings._pnl_audit_start_time.empty() )
+                settings._pnl_audit_start_time = tw::common::THighResTime::now().sqlString().substr(0, 10);
+
+            if ( settings._pnl_audit_end_time.empty() )
+                settings._pnl_audit_end_time = tw::common::THighResTime::now().sqlString();
+
+            return true;
+        }
+
+        bool populateAccounts(const tw::common::Settings& settings) {
+            _accounts.clear();
+
+            if ( !setTimeRange(settings) )
+                return false;
+
+            tw::common::StoreFilter filter;
+            filter.setTimeRange(TIME_COLUMN, _startTime, _endTime);
+
+            std::vector<int64_t> accountIds;
+            if ( !_store.readColumn(TABLE, filter, "accountId", accountIds) ) {
+                LOGGER_ERRO << "Failed to read accounts from: " << _store.dir() << "\n";
+                return false;
+            }
+
+            std::sort(accountIds.begin(), accountIds.end());
+            accountIds.erase(std::unique(accountIds.begin(), accountIds.end()), accountIds.end());
+            if ( accountIds.empty() ) {
+                LOGGER_ERRO << "Accounts are empty in: " << _store.dir() << "\n";
+                return false;
+            }
+
+            for ( size_t i = 0; i < accountIds.size(); ++i )
+                _accounts.push_back(boost::lexical_cast<std::string>(accountIds[i]));
+
+            LOGGER_INFO << "Accounts number of records: " << _accounts.size() << "\n";
+            return true;
+        }
+
+        const std::vector<std::string>& getAccounts() const {
+            return _accounts;
+        }
+
+        bool openAccount(const tw::common::Settings& settings, const std::string& account) {
+            if ( !setTimeRange(settings) )
+                return false;
+
+            tw::channel_or::TAccountId accountId = 0;
+            try {
+                accountId = boost::lexical_cast<tw::channel_or::TAccountId>(account);
+            } catch(...) {
+                LOGGER_ERRO << "Invalid account: " << account << "\n";
+                return false;
+            }
+
+            tw::common::StoreFilter filter;
+            filter.setTimeRange(TIME_COLUMN, _startTime, _endTime);
+            filter.addEquals("accountId", accountId);
+
+            _scanner.reset(new tw::common::StoreScanner(_store, TABLE, filter));
+            _buffer.clear();
+            _index = 0;
+
+            LOGGER_INFO << "Reading PnLAuditTrailInfos for: "
+                        << "account=" << account
+                        << ",start_time=" << settings._pnl_audit_start_time
+                        << ",end_time=" << settings._pnl_audit_end_time
+                        << "\n";
+
+            return true;
+        }
+
+        bool readChunk(uint32_t count, TPnLAuditTrailInfos& infos) {
+            infos.clear();
+            if ( !_scanner )
+                return false;
+
+            while ( infos.size() < count ) {
+                if ( _index == _buffer.size() ) {
+                    _buffer.clear();
+                    _index = 0;
+
+                    tw::common::TStoreColumns columns;
+                    if ( !_scanner->next(columns) )
+                        break;
+
+                    size_t rows = columns.empty() ? 0 : columns[0].size();
+                    tw::common::StoreRowReader reader(columns);
+                    _buffer.resize(rows);
+                    for ( size_t i = 0; i < rows; ++i ) {
+                        reader.setRow(i);
+                        _buffer[i].visitFields(reader);
+                    }
+
+                    continue;
+                }
+
+                infos.push_back(_buffer[_index++]);
+            }
+
+            return !_scanner->failed();
+        }
+
+    private:
+        bool setTimeRange(const tw::common::Settings& settings) {
+            _startTime = tw::common::StoreTime::fromSqlTime(settings._pnl_audit_start_time);
+            _endTime = tw::common::StoreTime::fromSqlTime(settings._pnl_audit_end_time);
+            if ( tw::common::StoreTime::kNullTime == _startTime || tw::common::StoreTime::kNullTime == _endTime ) {
+                LOGGER_ERRO << "Invalid start/end time: "
+                            << settings._pnl_audit_start_time << " :: "
+                            << settings._pnl_audit_end_time
+                            << "\n";
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+        tw::common::ColumnStore _store;
+        std::vector<std::string> _accounts;
+
+        int64_t _startTime;
+        int64_t _endTime;
+
+        boost::scoped_ptr<tw::common::StoreScanner> _scanner;
+        TPnLAuditTrailInfos _buffer;
+        size_t _index;
+    };
+
+    const char* SelectorPnLAuditColumnStore::TABLE = "PnLAuditTrail";
+    const char* SelectorPnLAuditColumnStore::TIME_COLUMN = "eventTimestamp";
+
+} // namespace pnl_audit
+} // namespace tw
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "SelectorPnLAudit.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <fstream>
+#include <set>
+
+namespace tw {
+namespace pnl_audit {
+
+    // Stand-in for db: reads PnLAuditTrailInfo records from a file, one
+    // record per line in PnLAuditTrailInfo::toString() format. Empty lines
+    // and lines starting with '#' are skipped. Records are filtered by
+    // their eventTimestamp against settings' start/end time (compared as
+    // sql time strings)
+    //
+    class SelectorPnLAuditFile : public ISelectorPnLAudit {
+        typedef std::set<tw::channel_or::TAccountId> TAccountIds;
+
+    public:
+        SelectorPnLAuditFile() : _accountId(0) {
+        }
+
+        bool start(tw::common::Settings& settings) {
+            _fileName = settings._pnl_audit_source_file;
+
+            std::ifstream file(_fileName.c_str());
+            if ( !file.good() ) {
+                LOGGER_ERRO << "Failed to open file: " << _fileName << "\n";
+                return false;
+            }
+
+            if ( settings._pnl_audit_start_time.empty() )
+                settings._pnl_audit_start_time = tw::common::THighResTime::now().sqlString().substr(0, 10);
+
+            if ( settings._pnl_audit_end_time.empty() )
+                settings._pnl_audit_end_time = tw::common::THighResTime::now().sqlString();
+
+            return true;
+        }
+
+        bool populateAccounts(const tw::common::Settings& settings) {
+            _accounts.clear();
+
+            std::ifstream file(_fileName.c_str());
+            if ( !file.good() ) {
+                LOGGER_ERRO << "Failed to open file: " << _fileName << "\n";
+                return false;
+            }
+
+            TAccountIds accountIds;
+            std::string line;
+            tw::channel_or::PnLAuditTrailInfo info;
+            while ( std::getline(file, line) ) {
+                if ( parse(line, info) )
+                    accountIds.insert(info._accountId);
+            }
+
+            if ( accountIds.empty() ) {
+                LOGGER_ERRO << "Accounts are empty in: " << _fileName << "\n";
+                return false;
+            }
+
+            for ( TAccountIds::const_iterator iter = accountIds.begin(); iter != accountIds.end(); ++iter )
+                _accounts.push_back(boost::lexical_cast<std::string>(*iter));
+
+            LOGGER_INFO << "Accounts number of records: " << _accounts.size() << "\n";
+            return true;
+        }
+
+        const std::vector<std::string>& getAccounts() const {
+            return _accounts;
+        }
+
+        bool openAccount(const tw::common::Settings& settings, const std::string& account) {
+            _file.close();
+            _file.clear();
+            _file.open(_fileName.c_str());
+            if ( !_file.good() ) {
+                LOGGER_ERRO << "Failed to open file: " << _fileName << "\n";
+                return false;
+            }
+
+            try {
+                _accountId = boost::lexical_cast<tw::channel_or::TAccountId>(account);
+            } catch(...) {
+                LOGGER_ERRO << "Invalid account: " << account << "\n";
+                return false;
+            }
+
+            _startTime = settings._pnl_audit_start_time;
+            _endTime = settings._pnl_audit_end_time;
+            return true;
+        }
+
+        bool readChunk(uint32_t count, TPnLAuditTrailInfos& infos) {
+            infos.clear();
+            if ( !_file.is_open() )
+                return false;
+
+            std::string line;
+            tw::channel_or::PnLAuditTrailInfo info;
+            while ( infos.size() < count && std::getline(_file, line) ) {
+                if ( !parse(line, info) || info._accountId != _accountId )
+                    continue;
+
+                std::string t = toSqlTime(info._eventTimestamp);
+                if ( t < _startTime || t > _endTime )
+                    continue;
+
+                infos.push_back(info);
+            }
+
+            return true;
+        }
+
+    private:
+        static bool parse(const std::string& line, tw::channel_or::PnLAuditTrailInfo& info) {
+            if ( line.empty() || '#' == line[0] )
+                return false;
+
+            info.clear();
+            try {
+                return info.fromString(line);
+            } catch(...) {
+                LOGGER_ERRO << "Failed to parse: " << line << "\n";
+            }
+
+            return false;
+        }
+
+        // "20120117-14:41:01.548000" => "2012-01-17 14:41:01.548000"
+        //
+        static std::string toSqlTime(const tw::common::THighResTime& t) {
+            std::string s = t.toString();
+            return s.substr(0, 4) + "-" + s.substr(4, 2) + "-" + s.substr(6, 2) + " " + s.substr(9);
+        }
+
+    private:
+        std::string _fileName;
+        std::vector<std::string> _accounts;
+
+        std::ifstream _file;
+        tw::channel_or::TAccountId _accountId;
+        std::string _startTime;
+        std::string _endTime;
+    };
+
+} // namespace pnl_audit
+} // namespace tw
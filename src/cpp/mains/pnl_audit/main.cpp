@@ -6,7 +6,20 @@
 #include <tw/config/settings_cmnd_line.h>
 
 #include "SelectorPnLAudit.h"
+#include "SelectorPnLAuditFile.h"
+#include "SelectorPnLAuditColumnStore.h"
 #include "PnLAudit.h"
+#include "PnLAuditRunner.h"
+
+static tw::pnl_audit::TSelectorPnLAuditPtr createSelector(const tw::common::Settings& settings) {
+    if ( !settings._pnl_audit_source_file.empty() )
+        return tw::pnl_audit::TSelectorPnLAuditPtr(new tw::pnl_audit::SelectorPnLAuditFile());
+    
+    if ( settings._pnl_audit_use_column_store )
+        return tw::pnl_audit::TSelectorPnLAuditPtr(new tw::pnl_audit::SelectorPnLAuditColumnStore());
+    
+    return tw::pnl_audit::TSelectorPnLAuditPtr(new tw::pnl_audit::SelectorPnLAudit());
+}
 
 int main(int argc, char* argv[])
 {
@@ -44,13 +57,13 @@ int main(int argc, char* argv[])
         return -1;
     }
     
-    tw::pnl_audit::SelectorPnLAudit selector;
-    if ( !selector.start(settings) ) {
+    tw::pnl_audit::TSelectorPnLAuditPtr selector = createSelector(settings);
+    if ( !selector->start(settings) ) {
         LOGGER_ERRO << "failed to start selector: " << settings.toStringDescription() << "\n";
         return -1;
     }
     
-    if ( !selector.populateAccounts(settings) ) {
+    if ( !selector->populateAccounts(settings) ) {
         LOGGER_ERRO << "failed to run selector's getAccounts(): " << settings.toStringDescription() << "\n";
         return -1;
     }
@@ -61,14 +74,28 @@ int main(int argc, char* argv[])
         return -1;
     }
     
-    std::vector<std::string> accounts = selector.getAccounts();
-    for ( size_t i = 0; i < accounts.size(); ++i ) {
-        if ( selector.populatePnLAuditTrailInfosForAccount(settings, accounts[i]) ) {
-            if ( !pnlAudit.process(selector.getPnLAuditTrailInfos(), settings, accounts[i]) )
-                LOGGER_ERRO << "pnlAudit failed to process records for account: " << accounts[i] << "\n";
+    // Each worker gets its own selector, accounts' selector is reused
+    // by the first one
+    //
+    const std::vector<std::string>& accounts = selector->getAccounts();
+    uint32_t threads = std::max(1U, std::min(settings._pnl_audit_threads, static_cast<uint32_t>(accounts.size())));
+    
+    tw::pnl_audit::PnLAuditRunner runner;
+    runner.addSelector(selector);
+    for ( uint32_t i = 1; i < threads; ++i ) {
+        tw::pnl_audit::TSelectorPnLAuditPtr workerSelector = createSelector(settings);
+        if ( !workerSelector->start(settings) ) {
+            LOGGER_ERRO << "failed to start worker's selector: " << settings.toStringDescription() << "\n";
+            break;
         }
+        
+        runner.addSelector(workerSelector);
     }
     
+    uint32_t failed = runner.run(settings, pnlAudit.getDirName(), accounts);
+    if ( failed > 0 )
+        LOGGER_ERRO << "pnlAudit failed to process accounts: " << failed << " of " << accounts.size() << "\n";
+    
     tw::log::Logger::instance().stop();
     
     return 0;
@@ -0,0 +1,215 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/common/settings.h>
+#include <tw/instr/instrument_manager.h>
+#include <tw/price/quote_store.h>
+#include <tw/common_trade/bars_manager.h>
+
+#include "unit_test_price_lib/instr_helper.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures start of bars managers of 5 bar lengths on 200 instruments
+// with a day of historical bars each - serial start() of each manager
+// against BarsManagersRestorer on worker threads, and checks both restore
+// the same bars and patterns:
+//
+//  speedtest_bars_restore [threads] [lookback_minutes]
+//
+typedef tw::common_trade::TBar TBar;
+typedef tw::common_trade::TBars TBars;
+typedef tw::common_trade::TBarPatterns TBarPatterns;
+
+class BenchRouter {
+public:
+    typedef tw::common_trade::BarsManagerImpl<BenchRouter> TImpl;
+
+public:
+    static bool registerTimerClient(TImpl* impl, const uint32_t msecs, const bool once, tw::common::TTimerId& id) {
+        return true;
+    }
+
+    static uint32_t getMSecFromMidnight() {
+        return 0;
+    }
+
+public:
+    static void setDbSource(const std::string& source) {
+    }
+
+    static bool outputToDb() {
+        return false;
+    }
+
+    // Random walk, deterministic by instrument and bar length
+    //
+    static bool readBars(uint32_t x, uint32_t barLength, uint32_t lookbackMinutes, uint32_t atrNumOfPeriods, TBars& bars) {
+        uint32_t count = lookbackMinutes*60/barLength;
+        uint32_t seed = x*2654435761U + barLength;
+        int32_t price = 100000;
+
+        bars.reserve(count);
+        for ( uint32_t i = 0; i < count; ++i ) {
+            seed = seed*1103515245U + 12345U;
+            int32_t step = static_cast<int32_t>((seed >> 16) % 9) - 4;
+
+            TBar bar;
+            bar._open.set(price);
+            price += step;
+            bar._close.set(price);
+            bar._high.set(std::max(bar._open.get(), bar._close.get()) + static_cast<int32_t>((seed >> 8) % 3));
+            bar._low.set(std::min(bar._open.get(), bar._close.get()) - static_cast<int32_t>((seed >> 4) % 3));
+            bar._range = bar._high - bar._low;
+            bar._volume.set(1+(seed >> 12) % 100);
+            bar._numOfTrades = 1+(seed >> 20) % 20;
+            bar._duration = barLength;
+            bar._formed = true;
+            bars.push_back(bar);
+        }
+
+        return true;
+    }
+
+    static bool processPatterns() {
+        return true;
+    }
+
+    static bool isValid() {
+        return true;
+    }
+
+    static bool canPersistToDb() {
+        return false;
+    }
+
+    template <typename TItemType>
+    static bool persist(const TItemType& v) {
+        return true;
+    }
+};
+
+typedef boost::shared_ptr<BenchRouter::TImpl> TImplPtr;
+typedef std::vector<TImplPtr> TImpls;
+
+static const uint32_t INSTRUMENTS = 200;
+static const uint32_t BAR_LENGTHS[] = { 30, 60, 120, 300, 900 };
+static const size_t BAR_LENGTHS_COUNT = sizeof(BAR_LENGTHS)/sizeof(BAR_LENGTHS[0]);
+
+static void createManagers(const std::vector<tw::instr::Instrument::TKeyId>& instruments, uint32_t lookbackMinutes, TImpls& impls) {
+    for ( size_t i = 0; i < BAR_LENGTHS_COUNT; ++i ) {
+        impls.push_back(TImplPtr(new BenchRouter::TImpl(BAR_LENGTHS[i], 2, 14)));
+        for ( size_t j = 0; j < instruments.size(); ++j )
+            impls.back()->subscribe(instruments[j], lookbackMinutes);
+    }
+}
+
+static bool isEqual(const TBarPatterns& a, const TBarPatterns& b) {
+    if ( a.size() != b.size() )
+        return false;
+
+    for ( size_t i = 0; i < a.size(); ++i ) {
+        if ( a[i].toString() != b[i].toString() )
+            return false;
+    }
+
+    return true;
+}
+
+static bool isEqual(const BenchRouter::TImpl& a, const BenchRouter::TImpl& b, const tw::instr::Instrument::TKeyId& x) {
+    const TBars& barsA = a.getBars(x);
+    const TBars& barsB = b.getBars(x);
+    if ( barsA.size() != barsB.size() )
+        return false;
+
+    for ( size_t i = 0; i < barsA.size(); ++i ) {
+        if ( barsA[i].toString() != barsB[i].toString() || barsA[i]._atr != barsB[i]._atr )
+            return false;
+    }
+
+    return (isEqual(a.getBarPatternsSimple().getBarPatterns(x), b.getBarPatternsSimple().getBarPatterns(x))
+            && isEqual(a.getBarPatternsSwingLevel1().getBarPatterns(x), b.getBarPatternsSwingLevel1().getBarPatterns(x))
+            && isEqual(a.getBarPatternsSwingLevel2().getBarPatterns(x), b.getBarPatternsSwingLevel2().getBarPatterns(x)));
+}
+
+static void print(const char* name, uint32_t threads, int64_t micros) {
+    printf("%-24s\t%u\t", name, threads);
+    std::cout << micros << "\n";
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t threads = (argc > 1) ? boost::lexical_cast<uint32_t>(argv[1]) : 4;
+    uint32_t lookbackMinutes = (argc > 2) ? boost::lexical_cast<uint32_t>(argv[2]) : 1440;
+
+    tw::instr::InstrumentManager& manager = tw::instr::InstrumentManager::instance();
+    tw::instr::InstrumentPtr base = InstrHelper::getNQH2();
+
+    std::vector<tw::instr::Instrument::TKeyId> instruments;
+    for ( uint32_t i = 0; i < INSTRUMENTS; ++i ) {
+        tw::instr::InstrumentPtr instrument(new tw::instr::Instrument(*base));
+        std::string suffix = boost::lexical_cast<std::string>(i);
+
+        instrument->_keyId = 100000+i;
+        instrument->_keyNum1 = 100000+i;
+        instrument->_keyNum2 = 100000+i;
+        instrument->_keyStr1 = "K1_" + suffix;
+        instrument->_keyStr2 = "K2_" + suffix;
+        instrument->_displayName = "NQ_" + suffix;
+        manager.addInstrument(instrument);
+
+        tw::price::QuoteStore::instance().getQuote(instrument);
+        instruments.push_back(instrument->_keyId);
+    }
+
+    tw::common::Settings settings;
+    settings._bars_manager_bars_restore_mode = tw::common::eBarsRestoreMode::kDb;
+    settings._bars_manager_use_cache = false;
+
+    std::cout << "instruments: " << INSTRUMENTS << ", bar lengths: " << BAR_LENGTHS_COUNT << ", lookback minutes: " << lookbackMinutes << "\n";
+    std::cout << "start                   \tthreads\tmicros\n";
+
+    TImpls serial;
+    createManagers(instruments, lookbackMinutes, serial);
+
+    tw::common::THighResTime t0 = tw::common::THighResTime::now();
+    for ( size_t i = 0; i < serial.size(); ++i ) {
+        if ( !serial[i]->start(settings) ) {
+            std::cout << "Failed to start bars manager: " << BAR_LENGTHS[i] << "\n";
+            return 1;
+        }
+    }
+    print("serial start()", 1, tw::common::THighResTime::now()-t0);
+
+    TImpls parallel;
+    createManagers(instruments, lookbackMinutes, parallel);
+
+    tw::common_trade::BarsManagersRestorer<BenchRouter::TImpl> restorer;
+    for ( size_t i = 0; i < parallel.size(); ++i )
+        restorer.add(parallel[i].get());
+
+    t0 = tw::common::THighResTime::now();
+    if ( !restorer.run(settings, threads) ) {
+        std::cout << "Failed to restore bars managers" << "\n";
+        return 1;
+    }
+    print("BarsManagersRestorer", threads, tw::common::THighResTime::now()-t0);
+
+    for ( size_t i = 0; i < serial.size(); ++i ) {
+        for ( size_t j = 0; j < instruments.size(); ++j ) {
+            if ( !isEqual(*serial[i], *parallel[i], instruments[j]) ) {
+                std::cout << "Restored bars differ for: " << instruments[j] << " of bar length: " << BAR_LENGTHS[i] << "\n";
+                return 1;
+            }
+        }
+    }
+
+    std::cout << "restored bars and patterns are equal" << "\n";
+    return 0;
+}
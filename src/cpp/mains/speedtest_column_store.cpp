@@ -0,0 +1,228 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/common/column_store.h>
+#include <tw/common/uuid.h>
+#include <tw/channel_db/channel_db.h>
+#include <tw/generated/channel_or_defs.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Compares reads of a month of fills from local column store against the
+// same reads from db:
+//
+//  speedtest_column_store <dir> [fills_per_day] [days] [db_connection_str]
+//
+// Column store is (re)created in <dir>/speedtest. Db path is measured only
+// if db_connection_str is given - fills are then also saved to Fills table
+// of that (scratch!) schema, day by day
+//
+typedef std::vector<tw::channel_or::Fill> TFills;
+
+static const char* TABLE = "Fills";
+static const char* TIME_COLUMN = "timestamp1";
+static const uint32_t ACCOUNTS = 20;
+
+static const int64_t FIRST_DAY = 1388534400LL*1000000LL; // 2014-01-01 00:00:00
+
+static void getFills(uint32_t day, uint32_t count, TFills& fills) {
+    tw::common::TUuidGenerator generator;
+    fills.resize(count);
+    for ( uint32_t i = 0; i < count; ++i ) {
+        tw::channel_or::Fill& f = fills[i];
+        f.clear();
+        f._accountId = 1000+(i%ACCOUNTS);
+        f._strategyId = 1+(i%7);
+        f._instrumentId = 1+(i%50);
+        f._orderId = generator.generateUuid();
+        f._fillId = generator.generateUuid();
+        f._side = (i%2) ? tw::channel_or::eOrderSide::kBuy : tw::channel_or::eOrderSide::kSell;
+        f._qty.set(1+i%10);
+        f._price.set(180000+(i%400));
+        f._exPrice = f._price.get()*0.25;
+        f._avgPrice = f._exPrice;
+        f._exchangeFillId = boost::lexical_cast<std::string>(day*count+i);
+
+        // 8 hours' session of each day
+        //
+        int64_t micros = FIRST_DAY + day*tw::common::StoreTime::kMicrosInDay + 14*3600LL*1000000LL + i*(8*3600LL*1000000LL/count);
+        f._timestamp1 = tw::common::StoreTime::fromMicros(micros);
+        f._timestamp2 = f._timestamp1;
+        f._timestamp3 = f._timestamp1;
+        f._timestamp4 = f._timestamp1;
+        f._exTimestamp = f._timestamp1;
+    }
+}
+
+static void print(const char* name, uint64_t rows, int64_t micros) {
+    printf("%-24s\t%lu\t", name, static_cast<unsigned long>(rows));
+    std::cout << micros << "\t" << ((micros > 0) ? static_cast<int64_t>(rows*1000000.0/micros) : 0) << "\n";
+    fflush(stdout);
+}
+
+static std::string sqlDate(uint32_t day) {
+    std::string d = tw::common::StoreTime::dayOf(FIRST_DAY + day*tw::common::StoreTime::kMicrosInDay);
+    return d.substr(0, 4) + "-" + d.substr(4, 2) + "-" + d.substr(6, 2);
+}
+
+static bool runDb(const std::string& connectionStr, uint32_t fillsPerDay, uint32_t days) {
+    tw::channel_db::ChannelDb channelDb;
+    if ( !channelDb.init(connectionStr) ) {
+        std::cout << "Failed to init channelDb with: " << connectionStr << "\n";
+        return false;
+    }
+
+    tw::channel_db::ChannelDb::TConnectionPtr connection = channelDb.getConnection();
+    tw::channel_db::ChannelDb::TStatementPtr statement = channelDb.getStatement(connection);
+    if ( !connection || !statement ) {
+        std::cout << "Failed to connect to: " << connectionStr << "\n";
+        return false;
+    }
+
+    // Fills_GetAllForDate selects by db's insert time, so each day's fills
+    // get their day as insert time
+    //
+    try {
+        connection->setAutoCommit(false);
+
+        TFills fills;
+        int64_t micros = 0;
+        for ( uint32_t day = 0; day < days; ++day ) {
+            getFills(day, fillsPerDay, fills);
+
+            tw::channel_or::Fills_SaveFill query;
+            for ( size_t i = 0; i < fills.size(); ++i )
+                query.add(fills[i]);
+
+            tw::common::THighResTime t0 = tw::common::THighResTime::now();
+            if ( !query.execute(statement) )
+                return false;
+
+            statement->execute("UPDATE Fills SET `timestamp`='" + sqlDate(day) + " 12:00:00' WHERE `timestamp` > '" + sqlDate(days) + "'");
+            connection->commit();
+            micros += (tw::common::THighResTime::now()-t0);
+        }
+
+        print("db write", static_cast<uint64_t>(fillsPerDay)*days, micros);
+    } catch(const std::exception& e) {
+        std::cout << "db write failed: " << e.what() << "\n";
+        return false;
+    }
+
+    uint64_t rows = 0;
+    tw::common::THighResTime t0 = tw::common::THighResTime::now();
+    for ( uint32_t day = 0; day < days; ++day ) {
+        tw::channel_or::Fills_GetAllForDate query;
+        if ( !query.execute(channelDb, sqlDate(day)) )
+            return false;
+
+        rows += query._o1.size();
+    }
+    print("db read all", rows, tw::common::THighResTime::now()-t0);
+
+    rows = 0;
+    t0 = tw::common::THighResTime::now();
+    for ( uint32_t day = 0; day < days; ++day ) {
+        tw::channel_or::Fills_GetAllForDate query;
+        if ( !query.execute(channelDb, sqlDate(day)) )
+            return false;
+
+        for ( size_t i = 0; i < query._o1.size(); ++i ) {
+            if ( 1001 == query._o1[i]._accountId )
+                ++rows;
+        }
+    }
+    print("db read account", rows, tw::common::THighResTime::now()-t0);
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if ( argc < 2 ) {
+        std::cout << "Usage: " << argv[0] << " <dir> [fills_per_day] [days] [db_connection_str]" << "\n";
+        return 1;
+    }
+
+    const std::string dir = std::string(argv[1]) + "/speedtest";
+    uint32_t fillsPerDay = (argc > 2) ? boost::lexical_cast<uint32_t>(argv[2]) : 50000;
+    uint32_t days = (argc > 3) ? boost::lexical_cast<uint32_t>(argv[3]) : 22;
+    std::string connectionStr = (argc > 4) ? argv[4] : "";
+
+    boost::filesystem::remove_all(dir);
+
+    tw::common::ColumnStore store;
+    if ( !store.open(dir) ) {
+        std::cout << "Failed to open: " << dir << "\n";
+        return 1;
+    }
+
+    std::cout << "path                    \trows\tmicros\trows/sec\n";
+
+    // Storage appends fills in batches of its batch_cache_size
+    //
+    static const uint32_t BATCH = 1000;
+
+    TFills fills;
+    int64_t micros = 0;
+    for ( uint32_t day = 0; day < days; ++day ) {
+        getFills(day, fillsPerDay, fills);
+        for ( size_t i = 0; i < fills.size(); i += BATCH ) {
+            TFills batch(fills.begin()+i, fills.begin()+std::min(fills.size(), i+BATCH));
+
+            tw::common::THighResTime t0 = tw::common::THighResTime::now();
+            if ( !store.append(TABLE, TIME_COLUMN, batch) ) {
+                std::cout << "Failed to append to: " << dir << "\n";
+                return 1;
+            }
+            micros += (tw::common::THighResTime::now()-t0);
+        }
+    }
+    print("store write", static_cast<uint64_t>(fillsPerDay)*days, micros);
+
+    uint64_t bytes = 0;
+    std::vector<std::string> partitions = store.getPartitions(TABLE);
+    for ( size_t i = 0; i < partitions.size(); ++i )
+        bytes += boost::filesystem::file_size(partitions[i]);
+
+    std::cout << "store size: " << bytes << " bytes in " << partitions.size() << " partitions" << "\n";
+
+    tw::common::THighResTime t0 = tw::common::THighResTime::now();
+    fills.clear();
+    if ( !store.read(TABLE, tw::common::StoreFilter(), fills) )
+        return 1;
+    print("store read all", fills.size(), tw::common::THighResTime::now()-t0);
+
+    t0 = tw::common::THighResTime::now();
+    fills.clear();
+    tw::common::StoreFilter filter;
+    filter.addEquals("accountId", 1001);
+    if ( !store.read(TABLE, filter, fills) )
+        return 1;
+    print("store read account", fills.size(), tw::common::THighResTime::now()-t0);
+
+    t0 = tw::common::THighResTime::now();
+    fills.clear();
+    tw::common::StoreFilter filterDay;
+    filterDay.setTimeRange(TIME_COLUMN, FIRST_DAY+tw::common::StoreTime::kMicrosInDay*(days/2), FIRST_DAY+tw::common::StoreTime::kMicrosInDay*(days/2+1)-1);
+    if ( !store.read(TABLE, filterDay, fills) )
+        return 1;
+    print("store read day", fills.size(), tw::common::THighResTime::now()-t0);
+
+    t0 = tw::common::THighResTime::now();
+    std::vector<double> prices;
+    if ( !store.readColumn(TABLE, tw::common::StoreFilter(), "exPrice", prices) )
+        return 1;
+    print("store read column", prices.size(), tw::common::THighResTime::now()-t0);
+
+    if ( !connectionStr.empty() && !runDb(connectionStr, fillsPerDay, days) )
+        return 1;
+
+    boost::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <tw/common/defs.h>
+#include <tw/common/command.h>
+#include <tw/common/high_res_time.h>
+
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures Commands/sec per core for msg bus' text ('\n' terminated) and
+// binary (length-prefixed) encodings - both encode and decode sides
+//
+typedef tw::common::THighResTime __prop_clock_t;
+typedef tw::common_comm::BinaryFrame TFrame;
+
+__prop_clock_t __prop_clock() {
+    return __prop_clock_t::now();
+}
+
+static double perSec(uint32_t count, int64_t micros) {
+    return (micros > 0) ? (count*1000000.0/micros) : 0.0;
+}
+
+int main()
+{
+    uint32_t max = 200000;
+    __prop_clock_t t0,t1;
+    uint32_t i;
+    size_t bytes = 0;
+
+    // Typical fill update streamed to monitoring tools
+    //
+    tw::common::Command cmnd;
+    cmnd._type = tw::common::eCommandType::kChannelOr;
+    cmnd._subType = tw::common::eCommandSubType::kOrFill;
+    cmnd.addParams("accountId", 1);
+    cmnd.addParams("strategyId", 12);
+    cmnd.addParams("instrumentId", 3);
+    cmnd.addParams("orderId", "a1b2c3d4-e5f6-a7b8-c9d0-e1f2a3b4c5d6");
+    cmnd.addParams("fillId", "d6c5b4a3-f2e1-d0c9-b8a7-f6e5d4c3b2a1");
+    cmnd.addParams("side", "Buy");
+    cmnd.addParams("qty", 5);
+    cmnd.addParams("price", 125725);
+    cmnd.addParams("exchangeTime", "20130412-13:30:00.123456");
+    cmnd.addParams("posAccount", 10);
+    cmnd.addParams("pnl", 1234.5);
+
+    std::string text = cmnd.toString()+"\n";
+    std::string frame = cmnd.toBinary();
+
+    std::cout << "text size=" << text.size() << "\tbinary size=" << frame.size() << "\n\n";
+    std::cout << "    mode   \tencode/sec\tdecode/sec\n";
+
+    printf("text\t\t");
+    t0 = __prop_clock();
+    for ( i = 0; i < max; ++i ) {
+        std::string message = cmnd.toString()+"\n";
+        bytes += message.size();
+    }
+    t1 = __prop_clock();
+    std::cout << perSec(max, t1-t0) << "\t";
+    fflush(stdout);
+
+    t0 = __prop_clock();
+    for ( i = 0; i < max; ++i ) {
+        tw::common::Command c;
+        c.fromString(text.substr(0, text.size()-1));
+        bytes += c._params.size();
+    }
+    t1 = __prop_clock();
+    std::cout << perSec(max, t1-t0) << "\n";
+    fflush(stdout);
+
+    printf("binary\t\t");
+    t0 = __prop_clock();
+    std::string buffer;
+    for ( i = 0; i < max; ++i ) {
+        buffer.clear();
+        cmnd.toBinary(buffer);
+        bytes += buffer.size();
+    }
+    t1 = __prop_clock();
+    std::cout << perSec(max, t1-t0) << "\t";
+    fflush(stdout);
+
+    t0 = __prop_clock();
+    for ( i = 0; i < max; ++i ) {
+        tw::common::Command c;
+        c.fromBinary(frame.data()+TFrame::HEADER_SIZE, frame.size()-TFrame::HEADER_SIZE);
+        bytes += c._params.size();
+    }
+    t1 = __prop_clock();
+    std::cout << perSec(max, t1-t0) << "\n";
+    fflush(stdout);
+
+    std::cout << "\n(checksum: " << bytes << ")\n";
+
+    return 0;
+}
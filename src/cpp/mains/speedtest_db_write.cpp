@@ -0,0 +1,134 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/channel_db/channel_db.h>
+#include <tw/channel_db/sql_batch.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures throughput of SqlBatch's write modes against a local
+// MySQL-compatible server (e.g. mysqld/mariadb started with
+// --local-infile=1 on a scratch schema):
+//
+//  speedtest_db_write "tcp://127.0.0.1:3306;user;pass;schema" [rows] [batch_rows]
+//
+// Rows resemble fills: a mix of doubles, integers and strings
+//
+typedef tw::channel_db::SqlBatch TSqlBatch;
+
+static const char* TABLE = "SpeedTestDbWrite";
+static const char* COLUMNS = "`orderId`, `accountId`, `price`, `qty`, `side`, `exTimestamp`";
+
+static void fill(TSqlBatch& batch, uint32_t first, uint32_t rows) {
+    for ( uint32_t i = first; i < first+rows; ++i ) {
+        batch.beginRow();
+        batch.bind(boost::lexical_cast<std::string>(i));
+        batch.bind(std::string("1003"));
+        batch.bind(1234.25+(i%100)*0.25);
+        batch.bind(boost::lexical_cast<std::string>(i%10+1));
+        batch.bind(std::string((i%2) ? "Buy" : "Sell"));
+        batch.bind(std::string("2014-01-17 14:41:01.548000"));
+    }
+}
+
+static bool run(tw::channel_db::ChannelDb::TConnectionPtr& connection,
+                tw::channel_db::ChannelDb::TStatementPtr& statement,
+                TSqlBatch::eMode mode,
+                uint32_t rows,
+                uint32_t batchRows) {
+    try {
+        statement->execute(std::string("TRUNCATE TABLE ") + TABLE);
+
+        // REPLACE as only REPLACE queries are bulk loaded
+        //
+        TSqlBatch batch("REPLACE", TABLE, COLUMNS);
+        batch.setMode(mode);
+
+        int64_t micros = 0;
+        for ( uint32_t row = 0; row < rows; row += batchRows ) {
+            uint32_t count = std::min(batchRows, rows-row);
+
+            batch.clear();
+            fill(batch, row, count);
+
+            tw::common::THighResTime t0 = tw::common::THighResTime::now();
+            batch.execute(statement);
+            connection->commit();
+            micros += (tw::common::THighResTime::now()-t0);
+        }
+
+        printf("%-10s\t%u\t%u\t", TSqlBatch::modeToString(mode), rows, batchRows);
+        std::cout << micros << "\t" << ((micros > 0) ? static_cast<int64_t>(rows*1000000.0/micros) : 0) << "\n";
+        fflush(stdout);
+    } catch(const std::exception& e) {
+        std::cout << TSqlBatch::modeToString(mode) << " failed: " << e.what() << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if ( argc < 2 ) {
+        std::cout << "Usage: " << argv[0] << " <db_connection_str> [rows] [batch_rows]" << "\n";
+        return 1;
+    }
+
+    uint32_t rows = (argc > 2) ? boost::lexical_cast<uint32_t>(argv[2]) : 100000;
+    uint32_t batchRows = (argc > 3) ? boost::lexical_cast<uint32_t>(argv[3]) : 10000;
+    if ( 0 == batchRows )
+        batchRows = 1;
+
+    tw::channel_db::ChannelDb channelDb;
+    if ( !channelDb.init(argv[1]) ) {
+        std::cout << "Failed to init channelDb with: " << argv[1] << "\n";
+        return 1;
+    }
+
+    tw::channel_db::ChannelDb::TConnectionPtr connection = channelDb.getConnection();
+    tw::channel_db::ChannelDb::TStatementPtr statement = channelDb.getStatement(connection);
+    if ( !connection || !statement ) {
+        std::cout << "Failed to connect to: " << argv[1] << "\n";
+        return 1;
+    }
+
+    try {
+        statement->execute(std::string("DROP TABLE IF EXISTS ") + TABLE);
+        statement->execute(std::string("CREATE TABLE ") + TABLE + " ("
+                           "`index` int(11) NOT NULL AUTO_INCREMENT,"
+                           "`orderId` varchar(64) NOT NULL,"
+                           "`accountId` varchar(32) NOT NULL,"
+                           "`price` double NOT NULL,"
+                           "`qty` int(11) NOT NULL,"
+                           "`side` varchar(8) NOT NULL,"
+                           "`exTimestamp` datetime(6) NOT NULL,"
+                           "`timestamp` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+                           "PRIMARY KEY (`index`)"
+                           ") ENGINE=InnoDB");
+        connection->setAutoCommit(false);
+    } catch(const std::exception& e) {
+        std::cout << "Failed to create " << TABLE << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    // Bulk load is used for every batch to measure it on its own
+    //
+    TSqlBatch::setDefaults(TSqlBatch::kBulkLoad, 1);
+
+    std::cout << "mode      \trows\tbatch\tmicros\trows/sec\n";
+    run(connection, statement, TSqlBatch::kText, rows, batchRows);
+    run(connection, statement, TSqlBatch::kPrepared, rows, batchRows);
+    run(connection, statement, TSqlBatch::kBulkLoad, rows, batchRows);
+
+    try {
+        statement->execute(std::string("DROP TABLE IF EXISTS ") + TABLE);
+    } catch(...) {
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/channel_or_cme/translator.h>
+#include <tw/channel_or_cme/channel_or_onix.h>
+
+#include "unit_test_channel_or_lib/order_helper.h"
+
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures per order encoding latency of CME order messages: OnixS message
+// translation + serialization vs pre-encoded FIX templates
+//
+typedef tw::common::THighResTime __prop_clock_t;
+
+__prop_clock_t __prop_clock() {
+    return __prop_clock_t::now();
+}
+
+static double perOrder(uint32_t count, int64_t micros) {
+    return (count > 0) ? (micros*1000.0/count) : 0.0;
+}
+
+int main(int argc, char* argv[])
+{
+    tw::channel_or_cme::Settings globalSettings;
+    globalSettings._global_fixDialectDescriptionFile = "/opt/tradework/onix/config/or/dialect_or.xml";
+    globalSettings._global_schedulerSettingsFile = "/opt/tradework/onix/config/or/scheduler_or.xml";
+    globalSettings._global_licenseStore = "/opt/tradework/onix/license/";
+    globalSettings._global_logDirectory = "./";
+
+    if ( !tw::channel_or_cme::ChannelOrOnix::global_init(globalSettings) ) {
+        std::cout << "Can't init OnixS engine" << "\n";
+        return -1;
+    }
+
+    tw::channel_or_cme::TSessionSettingsPtr settings(new tw::channel_or_cme::SessionSettings("7E59Z1"));
+    settings->_senderCompId = "7E59Z1N";
+    settings->_senderSubId = "AMR_TW";
+    settings->_senderLocationId = "US,IL";
+    settings->_password = "7E5";
+    settings->_applicationSystemName = "RosenthalSPOC";
+    settings->_applicationSystemVersion = "1.0";
+    settings->_applicationSystemVendor = "AMRSPOC";
+    settings->_account = "82409802";
+    settings->_customerOrFirm = "1";
+    settings->_ctiCode = "2";
+    settings->_handlInst = "1";
+    settings->_enabled = true;
+
+    tw::channel_or_cme::Translator t;
+    if ( !t.init(settings) ) {
+        std::cout << "Can't init translator" << "\n";
+        return -1;
+    }
+
+    uint32_t max = 100000;
+    __prop_clock_t t0,t1;
+    uint32_t i;
+    size_t bytes = 0;
+    uint32_t seqNum = 1;
+    tw::channel_or::Reject rej;
+
+    std::vector<tw::channel_or::TOrderPtr> orders;
+    orders.reserve(max);
+    for ( i = 0; i < max; ++i )
+        orders.push_back((i%2) ? OrderHelper::getSellLimit(9241+i%10, 1+i%5) : OrderHelper::getBuyLimit(9231+i%10, 1+i%5));
+
+    std::cout << "    mode   \tnanos/order\n";
+
+    printf("onix\t\t");
+    t0 = __prop_clock();
+    for ( i = 0; i < max; ++i ) {
+        if ( !t.translateNew(orders[i], rej) ) {
+            std::cout << "Failed: " << rej.toString() << "\n";
+            return -1;
+        }
+
+        OnixS::FIX::Message& msg = t.getMsgNew();
+        t.setSessionFields(msg, seqNum++, OnixS::FIX::Timestamp::getUtcTimestampWithMilliseconds());
+        bytes += msg.toString(tw::channel_or_cme::FixTemplate::SOH).size();
+    }
+    t1 = __prop_clock();
+    std::cout << perOrder(max, t1-t0) << "\n";
+    fflush(stdout);
+
+    printf("template\t");
+    t0 = __prop_clock();
+    for ( i = 0; i < max; ++i ) {
+        if ( !t.encodeNew(orders[i], seqNum++, rej) ) {
+            std::cout << "Failed: " << rej.toString() << "\n";
+            return -1;
+        }
+
+        bytes += t.getRawNew().size();
+    }
+    t1 = __prop_clock();
+    std::cout << perOrder(max, t1-t0) << "\n";
+    fflush(stdout);
+
+    std::cout << "\n(checksum: " << bytes << ")\n";
+
+    tw::channel_or_cme::ChannelOrOnix::global_shutdown();
+
+    return 0;
+}
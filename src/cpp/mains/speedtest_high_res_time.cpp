@@ -0,0 +1,68 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/common/tsc_clock.h>
+
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Measures cost of reading clocks and formatting timestamps
+//
+typedef tw::common::TscClock TTscClock;
+
+static volatile int64_t sink = 0;
+
+static void print(const char* name, uint32_t count, int64_t nanos) {
+    printf("%-32s\t", name);
+    std::cout << ((count > 0) ? (static_cast<double>(nanos)/count) : 0.0) << "\n";
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t count = 10000000;
+    int64_t start = 0;
+
+    std::cout << "tsc enabled: " << (TTscClock::isEnabled() ? "yes" : "no") << "\n";
+    std::cout << "    clock                       \tnanos/call\n";
+
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < count; ++i )
+        sink += TTscClock::clockNanos(CLOCK_REALTIME);
+    print("clock_gettime(CLOCK_REALTIME)", count, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < count; ++i )
+        sink += TTscClock::clockNanos(CLOCK_MONOTONIC);
+    print("clock_gettime(CLOCK_MONOTONIC)", count, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < count; ++i )
+        sink += TTscClock::ticks();
+    print("TscClock::ticks()", count, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < count; ++i )
+        sink += TTscClock::monotonicNanos();
+    print("TscClock::monotonicNanos()", count, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < count; ++i )
+        sink += TTscClock::nowNanos();
+    print("TscClock::nowNanos()", count, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < count; ++i )
+        sink += tw::common::THighResTime::now().microseconds();
+    print("THighResTime::now()", count, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    const uint32_t formats = count/10;
+    tw::common::THighResTime now = tw::common::THighResTime::now();
+    start = TTscClock::clockNanos(CLOCK_MONOTONIC);
+    for ( uint32_t i = 0; i < formats; ++i )
+        sink += now.toString().length();
+    print("THighResTime::toString()", formats, TTscClock::clockNanos(CLOCK_MONOTONIC)-start);
+
+    return 0;
+}
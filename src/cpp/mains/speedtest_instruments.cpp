@@ -0,0 +1,162 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/instr/instrument_manager.h>
+#include <tw/price/quote_store.h>
+
+#include "unit_test_price_lib/instr_helper.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures cost of resolving instrument by string on 10k instruments
+// universe: InstrumentManager's hashed multi_index, std::map by display
+// name (as in matchers), interned ids and keyId lookups
+//
+typedef tw::common::THighResTime __prop_clock_t;
+
+__prop_clock_t __prop_clock() {
+    return __prop_clock_t::now();
+}
+
+typedef std::map<std::string, tw::instr::InstrumentPtr> TInstrumentsMap;
+
+static double perLookup(uint32_t count, int64_t micros) {
+    return (count > 0) ? (micros*1000.0/count) : 0.0;
+}
+
+static void print(const char* name, uint32_t count, int64_t micros, size_t found) {
+    printf("%-32s\t", name);
+    std::cout << perLookup(count, micros) << "\t\t" << found << "\n";
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t count = 10000;
+    const uint32_t lookups = 1000000;
+    const uint32_t rounds = 10;
+
+    tw::instr::InstrumentManager& manager = tw::instr::InstrumentManager::instance();
+    tw::instr::InstrumentPtr base = InstrHelper::getNQH2();
+
+    std::vector<std::string> displayNames;
+    std::vector<uint32_t> keyIds;
+    TInstrumentsMap instrumentsMap;
+    for ( uint32_t i = 0; i < count; ++i ) {
+        tw::instr::InstrumentPtr instrument(new tw::instr::Instrument(*base));
+        std::string suffix = boost::lexical_cast<std::string>(i);
+
+        instrument->_keyId = 100000+i;
+        instrument->_keyNum1 = 100000+i;
+        instrument->_keyNum2 = 100000+i;
+        instrument->_keyStr1 = "K1_" + suffix;
+        instrument->_keyStr2 = "K2_" + suffix;
+        instrument->_symbol = "S" + boost::lexical_cast<std::string>(i/4);
+        instrument->_displayName = instrument->_symbol + "_" + suffix;
+        manager.addInstrument(instrument);
+
+        instrumentsMap[instrument->_displayName] = instrument;
+        displayNames.push_back(instrument->_displayName);
+        keyIds.push_back(instrument->_keyId);
+
+        tw::price::QuoteStore::instance().getQuote(instrument);
+    }
+
+    // Lookups go in a scattered order, so that a single instrument isn't
+    // always in cache
+    //
+    std::vector<uint32_t> order(lookups);
+    for ( uint32_t i = 0; i < lookups; ++i )
+        order[i] = static_cast<uint32_t>((i*7919ULL) % count);
+
+    __prop_clock_t t0,t1;
+    int64_t micros = 0;
+    size_t found = 0;
+
+    std::cout << "instruments: " << manager.getInternIdsCount() << "\n";
+    std::cout << "    lookup                      \tnanos/lookup\tfound\n";
+
+    micros = 0;
+    found = 0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < lookups; ++i ) {
+            if ( manager.getByDisplayName(displayNames[order[i]]) )
+                ++found;
+        }
+        t1 = __prop_clock();
+        micros += (t1-t0);
+    }
+    print("getByDisplayName()", lookups*rounds, micros, found);
+
+    micros = 0;
+    found = 0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < lookups; ++i ) {
+            if ( instrumentsMap.find(displayNames[order[i]]) != instrumentsMap.end() )
+                ++found;
+        }
+        t1 = __prop_clock();
+        micros += (t1-t0);
+    }
+    print("std::map<displayName>", lookups*rounds, micros, found);
+
+    micros = 0;
+    found = 0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < lookups; ++i ) {
+            if ( manager.getByInternId(manager.getInternId(displayNames[order[i]])) )
+                ++found;
+        }
+        t1 = __prop_clock();
+        micros += (t1-t0);
+    }
+    print("getByInternId(getInternId())", lookups*rounds, micros, found);
+
+    micros = 0;
+    found = 0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < lookups; ++i ) {
+            if ( manager.getByInternId(order[i]) )
+                ++found;
+        }
+        t1 = __prop_clock();
+        micros += (t1-t0);
+    }
+    print("getByInternId()", lookups*rounds, micros, found);
+
+    micros = 0;
+    found = 0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < lookups; ++i ) {
+            if ( manager.getByKeyId(keyIds[order[i]]) )
+                ++found;
+        }
+        t1 = __prop_clock();
+        micros += (t1-t0);
+    }
+    print("getByKeyId()", lookups*rounds, micros, found);
+
+    micros = 0;
+    found = 0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < lookups; ++i ) {
+            if ( tw::price::QuoteStore::instance().getQuoteByDisplayName(displayNames[order[i]]).isValid() )
+                ++found;
+        }
+        t1 = __prop_clock();
+        micros += (t1-t0);
+    }
+    print("getQuoteByDisplayName()", lookups*rounds, micros, found);
+
+    return 0;
+}
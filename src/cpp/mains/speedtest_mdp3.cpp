@@ -0,0 +1,196 @@
+#include <tw/common/defs.h>
+#include <tw/common_comm/pcap.h>
+#include <tw/channel_pf_cme/mdp3_channel.h>
+#include <tw/instr/instrument_manager.h>
+#include <tw/price/quote_store.h>
+
+#include "unit_test_channel_pf_lib_cme/mdp3_encoder.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Measures per packet decode + book build latency of native MDP3 decoder
+//
+// Usage:
+//      speedtest_mdp3                                  - synthetic packets
+//      speedtest_mdp3 <pcap> <port> <securityId>...    - incremental feed's packets from capture
+//
+// Percentiles are printed in the same format as QuoteNotification(stats_onix)
+// statistics of OnixS path (channel_pf_cme_onix.quoteNotificationStatisticsInterval),
+// so both can be compared on the same capture
+//
+typedef tw::channel_pf_cme::Mdp3Channel TChannel;
+typedef tw::channel_pf_cme::mdp3::Entry TEntry;
+
+static uint64_t nowNanos() {
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static tw::instr::InstrumentPtr createInstrument(uint32_t securityId) {
+    tw::instr::InstrumentPtr instrument(new tw::instr::Instrument());
+    std::string instrData = "6,Future,Equity,Cash,USD,20,1,4,2010-12-17 14:30:00.000,2012-03-16 13:30:00.000,2012-03-16 13:30:00.000,NQ,NQ,NQH2,,CME,CME,CME Globex,8870,8870,8870,8870,15,,0.01,5000,0,,0,,0,,0,,0,,,,,,,,,";
+    instrument->fromString(instrData);
+
+    instrument->_keyId = securityId;
+    instrument->_keyNum1 = securityId;
+    instrument->_keyNum2 = securityId;
+    instrument->_displayName = "MDP3_" + boost::lexical_cast<std::string>(securityId);
+
+    tw::instr::InstrumentManager::setTickConverter(instrument);
+    tw::instr::InstrumentManager::setPrecision(instrument);
+    tw::instr::InstrumentManager::instance().addInstrument(instrument);
+
+    tw::price::QuoteStore::instance().getQuote(instrument);
+
+    return instrument;
+}
+
+static void createPackets(const std::vector<uint32_t>& securityIds, uint32_t count, std::vector<std::string>& packets) {
+    using namespace tw::channel_pf_cme::mdp3;
+
+    Encoder encoder;
+    std::vector<TEntry> entries;
+    std::vector<uint32_t> rptSeqs(securityIds.size(), 0);
+
+    // Build up 10 levels per instrument, then random level updates - typical
+    // packet carries 1-3 entries
+    //
+    uint32_t seqNum = 0;
+    for ( size_t s = 0; s < securityIds.size(); ++s ) {
+        for ( uint8_t level = 1; level <= 10; ++level ) {
+            ++seqNum;
+            encoder.beginPacket(seqNum, seqNum);
+            entries.clear();
+            for ( int side = 0; side < 2; ++side ) {
+                TEntry e;
+                e._kind = TEntry::kKindBook;
+                e._securityId = securityIds[s];
+                e._rptSeq = ++rptSeqs[s];
+                e._type = (0 == side) ? kBid : kOffer;
+                e._action = kNew;
+                e._level = level;
+                e._price = (0 == side) ? (2310250000000LL - (level-1)*250000000LL) : (2310500000000LL + (level-1)*250000000LL);
+                e._qty = 10 + level;
+                e._numOrders = level;
+                entries.push_back(e);
+            }
+
+            encoder.addBook(seqNum, entries);
+            packets.push_back(encoder.get());
+        }
+    }
+
+    ::srand(1);
+    while ( packets.size() < count ) {
+        size_t s = ::rand() % securityIds.size();
+        ++seqNum;
+        encoder.beginPacket(seqNum, seqNum);
+        entries.clear();
+
+        uint32_t numEntries = 1 + ::rand() % 3;
+        for ( uint32_t i = 0; i < numEntries; ++i ) {
+            TEntry e;
+            e._kind = TEntry::kKindBook;
+            e._securityId = securityIds[s];
+            e._rptSeq = ++rptSeqs[s];
+            e._type = (::rand() % 2) ? kBid : kOffer;
+            e._action = kChange;
+            e._level = 1 + ::rand() % 5;
+            e._price = (kBid == e._type) ? (2310250000000LL - (e._level-1)*250000000LL) : (2310500000000LL + (e._level-1)*250000000LL);
+            e._qty = 1 + ::rand() % 100;
+            e._numOrders = 1 + ::rand() % 10;
+            entries.push_back(e);
+        }
+
+        encoder.addBook(seqNum, entries);
+        packets.push_back(encoder.get());
+    }
+}
+
+static uint64_t percentile(const std::vector<uint64_t>& values, double p) {
+    if ( values.empty() )
+        return 0;
+
+    size_t index = static_cast<size_t>(p * (values.size()-1));
+    return values[index];
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> packets;
+    std::vector<uint32_t> securityIds;
+
+    if ( argc > 3 ) {
+        uint16_t port = boost::lexical_cast<uint16_t>(argv[2]);
+        for ( int i = 3; i < argc; ++i )
+            securityIds.push_back(boost::lexical_cast<uint32_t>(argv[i]));
+
+        tw::common_comm::PcapReader reader;
+        if ( !reader.open(argv[1]) )
+            return -1;
+
+        tw::common_comm::PcapPacket packet;
+        while ( reader.next(packet) ) {
+            if ( packet._dstPort == port )
+                packets.push_back(std::string(packet._data, packet._size));
+        }
+    } else {
+        securityIds.push_back(8870);
+        securityIds.push_back(8871);
+        securityIds.push_back(8872);
+        createPackets(securityIds, 1000000, packets);
+    }
+
+    TChannel channel;
+    for ( size_t i = 0; i < securityIds.size(); ++i ) {
+        if ( !channel.subscribe(createInstrument(securityIds[i])) )
+            return -1;
+    }
+
+    std::cout << "packets=" << packets.size() << "\tinstruments=" << securityIds.size() << "\n\n";
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve(packets.size());
+
+    uint64_t t0 = nowNanos();
+    for ( size_t i = 0; i < packets.size(); ++i ) {
+        uint64_t t1 = nowNanos();
+        channel.onIncrementalPacket(packets[i].data(), packets[i].size());
+        latencies.push_back(nowNanos() - t1);
+    }
+    uint64_t total = nowNanos() - t0;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    const TChannel::Stats& stats = channel.getStats();
+    std::cout << "{ \"eventName\": \"Mdp3PacketLatency(nanos)\""
+              << ", \"count\": " << latencies.size()
+              << ", \"p010\":" << percentile(latencies, 0.01)
+              << ", \"p100\":" << percentile(latencies, 0.1)
+              << ", \"p250\":" << percentile(latencies, 0.25)
+              << ", \"p500\":" << percentile(latencies, 0.5)
+              << ", \"p750\":" << percentile(latencies, 0.75)
+              << ", \"p900\":" << percentile(latencies, 0.9)
+              << ", \"p990\":" << percentile(latencies, 0.99)
+              << ", \"p999\":" << percentile(latencies, 0.999)
+              << ", \"max\":" << (latencies.empty() ? 0 : latencies.back())
+              << "}\n\n";
+
+    std::cout << "packets/sec=" << (total > 0 ? packets.size()*1000000000.0/total : 0.0)
+              << "\tmessages=" << stats._messages
+              << "\tquotes=" << stats._quotesPublished
+              << "\tgaps=" << stats._gaps
+              << "\tbookGaps=" << stats._bookGaps
+              << "\tdecodeErrors=" << stats._decodeErrors << "\n";
+
+    return 0;
+}
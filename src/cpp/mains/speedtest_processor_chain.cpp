@@ -0,0 +1,125 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/channel_or/processor_orders.h>
+#include <tw/channel_or/processor_risk.h>
+#include <tw/channel_or/processor.h>
+
+#include "unit_test_channel_or_lib/order_helper.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures end-to-end latency of ProcessorOut chain (ProcessorOrders ->
+// ProcessorRisk) per sendNew(), for a growing number of (account, instrument)
+// pairs configured/traded
+//
+typedef tw::common::THighResTime __prop_clock_t;
+
+__prop_clock_t __prop_clock() {
+    return __prop_clock_t::now();
+}
+
+typedef tw::channel_or::ProcessorOrders TProcessorOrders;
+typedef tw::channel_or::ProcessorRisk TProcessorRisk;
+
+typedef tw::channel_or::ProcessorOut<TProcessorRisk> TProcessorOutRisk;
+typedef tw::channel_or::ProcessorOut<TProcessorOrders, TProcessorOutRisk> TProcessorOut;
+
+static double perOrder(uint32_t count, int64_t micros) {
+    return (count > 0) ? (micros*1000.0/count) : 0.0;
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t max = 100000;
+    const uint32_t rounds = 10;
+    const uint32_t instrumentsCounts[] = { 1, 16, 256 };
+
+    TProcessorOrders& p_orders = TProcessorOrders::instance();
+    TProcessorRisk& p_risk = TProcessorRisk::instance();
+
+    TProcessorOutRisk p_out_risk(p_risk);
+    TProcessorOut p_out(p_orders, p_out_risk);
+
+    tw::risk::Account account;
+    account._id = 1;
+    account._name = "speedtest";
+    account._tradeEnabled = true;
+
+    __prop_clock_t t0,t1;
+    tw::channel_or::Reject rej;
+
+    std::cout << "    instruments   \tnanos/sendNew\n";
+
+    for ( size_t n = 0; n < sizeof(instrumentsCounts)/sizeof(instrumentsCounts[0]); ++n ) {
+        const uint32_t count = instrumentsCounts[n];
+
+        std::vector<tw::instr::InstrumentPtr> instruments;
+        std::vector<tw::risk::AccountRiskParams> params;
+        for ( uint32_t i = 0; i < count; ++i ) {
+            tw::instr::InstrumentPtr instrument(new tw::instr::Instrument((i%2) ? *InstrHelper::getNQU2() : *InstrHelper::getNQH2()));
+            instrument->_keyId = 1000+i;
+            instrument->_displayName += boost::lexical_cast<std::string>(i);
+            tw::instr::InstrumentManager::instance().addInstrument(instrument);
+            instruments.push_back(instrument);
+
+            tw::risk::AccountRiskParams param;
+            param._accountId = account._id;
+            param._displayName = instrument->_displayName;
+            param._exchange = instrument->_exchange;
+            param._clipSize = 10;
+            param._maxPos = 10*max;
+            param._tradeEnabled = true;
+            params.push_back(param);
+        }
+
+        p_risk.clear();
+        if ( !p_risk.init(account, params) ) {
+            std::cout << "Can't init risk processor" << "\n";
+            return -1;
+        }
+
+        std::vector<tw::channel_or::TOrderPtr> orders;
+        orders.reserve(max);
+        for ( uint32_t i = 0; i < max; ++i ) {
+            tw::instr::InstrumentPtr instrument = instruments[i%count];
+            tw::channel_or::TOrderPtr order = (i%2) ? OrderHelper::getSellLimit(9241+i%10, 1+i%5, instrument) : OrderHelper::getBuyLimit(9231+i%10, 1+i%5, instrument);
+            order->_accountId = account._id;
+            order->_strategyId = 1;
+            orders.push_back(order);
+        }
+
+        int64_t micros = 0;
+        for ( uint32_t r = 0; r < rounds; ++r ) {
+            for ( uint32_t i = 0; i < max; ++i )
+                orders[i]->_state = tw::channel_or::eOrderState::kUnknown;
+
+            t0 = __prop_clock();
+            for ( uint32_t i = 0; i < max; ++i ) {
+                if ( !p_out.sendNew(orders[i], rej) ) {
+                    std::cout << "Failed: " << rej.toString() << "\n";
+                    return -1;
+                }
+            }
+            t1 = __prop_clock();
+            micros += (t1-t0);
+
+            // Remove orders and their open qtys outside of measured loop
+            //
+            for ( uint32_t i = 0; i < max; ++i )
+                p_orders.onNewRej(orders[i], rej);
+        }
+
+        printf("%u\t\t\t", count);
+        std::cout << perOrder(max*rounds, micros) << "\n";
+        fflush(stdout);
+    }
+
+    p_orders.clear();
+    p_risk.clear();
+
+    return 0;
+}
@@ -0,0 +1,495 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/common/instrumentation.h>
+#include <tw/channel_or/processor_orders.h>
+#include <tw/channel_or/processor_throttle.h>
+#include <tw/channel_or/processor_wtp.h>
+#include <tw/channel_or/processor_risk.h>
+#include <tw/channel_or/processor_pnl.h>
+#include <tw/channel_or/processor_messaging.h>
+#include <tw/channel_or/processor.h>
+#include <tw/channel_or/translator.h>
+#include <tw/channel_or_cme/id_factory.h>
+#include <tw/exchange_sim/matcher.h>
+#include <tw/price/quote.h>
+
+#include "unit_test_channel_or_lib/order_helper.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <limits>
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures tick-to-order and order-to-ack latencies through the same
+// ProcessorOut/ProcessorIn chains StrategyContainer uses, with a loopback
+// exchange built on exchange_sim's Matcher in place of ChannelOrManager
+//
+// Reference strategy alternates on every synthetic quote between a new buy
+// limit resting below the bid and a cancel of it, acks are translated with
+// channel_or's Translator and go through ProcessorIn chain back to strategy
+//
+// NOTE: everything runs on a single thread without network/db - FIX
+// session's encoding/sending is not included
+//
+// Usage: speedtest_round_trip [ticks]
+//
+typedef tw::channel_or::TOrderPtr TOrderPtr;
+typedef tw::channel_or::Reject TReject;
+typedef tw::channel_or::OrderResp TOrderResp;
+typedef tw::common::LatencyHistogram THistogram;
+
+static THistogram& registerStage(const char* name) {
+    return tw::common::Instrumentation::instance().registerStage(std::string("round_trip.") + name);
+}
+
+class LoopbackExchange : public tw::exchange_sim::MatcherEventListener {
+    typedef std::map<std::string, TOrderPtr> TOrders;
+    typedef std::vector<TOrderResp> TOrderResps;
+
+public:
+    LoopbackExchange() : _tickToOrder(registerStage("tick_to_order")),
+                         _ackIn(registerStage("ack_in")),
+                         _tickNanos(0),
+                         _fills(0) {
+    }
+
+    bool init(const tw::instr::InstrumentPtr& instrument) {
+        tw::channel_or::SimulatorMatcherParams params;
+        params._percentCancelFront = 0;
+        params._verbose = false;
+
+        _matcher.reset(new tw::exchange_sim::Matcher(*this, instrument));
+        return _matcher->init(params);
+    }
+
+    void setTickNanos(int64_t v) {
+        _tickNanos = v;
+    }
+
+    uint32_t getFills() const {
+        return _fills;
+    }
+
+    void onQuote(const tw::price::Quote& quote) {
+        _matcher->onQuote(quote);
+    }
+
+public:
+    // ProcessorOut interface
+    //
+    bool init(const tw::common::Settings& settings) { return true; }
+    bool start() { return true; }
+    void stop() {}
+
+    bool sendNew(const TOrderPtr& order, TReject& rej) {
+        if ( _tickToOrder.isEnabled() )
+            _tickToOrder.record(tw::common::nowNanos() - _tickNanos);
+
+        order->_origClOrderId = order->_clOrderId = order->_corrClOrderId = tw::channel_or_cme::IdFactory::instance().get().c_str();
+
+        tw::exchange_sim::TOrderPtr sim = _matcher->createOrder();
+        static_cast<tw::channel_or::Order&>(*sim) = *order;
+
+        _orders[order->_clOrderId] = order;
+        _matcher->sendNew(sim);
+        return true;
+    }
+
+    bool sendMod(const TOrderPtr& order, TReject& rej) {
+        rej = getRej("Modifies are not supported by loopback exchange");
+        return false;
+    }
+
+    bool sendCxl(const TOrderPtr& order, TReject& rej) {
+        tw::exchange_sim::TOrderPtr sim = _matcher->getOrder(order->_exOrderId);
+        if ( !sim ) {
+            rej = getRej("Unknown order: " + order->_exOrderId);
+            return false;
+        }
+
+        order->_clOrderId = tw::channel_or_cme::IdFactory::instance().get().c_str();
+        sim->_clOrderId = order->_clOrderId;
+
+        _matcher->sendCxl(sim);
+        return true;
+    }
+
+    void onCommand(const tw::common::Command& command) {}
+
+    bool rebuildOrder(const TOrderPtr& order, TReject& rej) { return true; }
+    void recordFill(const tw::channel_or::Fill& fill) {}
+    void rebuildPos(const tw::channel_or::PosUpdate& update) {}
+
+    void onRebuildOrderRej(const TOrderPtr& order, const TReject& rej) {}
+    void onNewRej(const TOrderPtr& order, const TReject& rej) {}
+    void onModRej(const TOrderPtr& order, const TReject& rej) {}
+    void onCxlRej(const TOrderPtr& order, const TReject& rej) {}
+
+public:
+    // tw::exchange_sim::MatcherEventListener interface - called
+    // synchronously from within matcher, so acks are only queued here
+    //
+    virtual void onNewAck(const tw::exchange_sim::TOrderPtr& order) {
+        queue(order, tw::channel_or::eOrderRespType::kNewAck);
+    }
+
+    virtual void onModAck(const tw::exchange_sim::TOrderPtr& order) {
+        queue(order, tw::channel_or::eOrderRespType::kModAck);
+    }
+
+    virtual void onCxlAck(const tw::exchange_sim::TOrderPtr& order) {
+        queue(order, tw::channel_or::eOrderRespType::kCxlAck);
+    }
+
+    virtual void onFill(const tw::exchange_sim::TFill& fill) {
+        ++_fills;
+    }
+
+    virtual void onEvent(const tw::exchange_sim::Matcher* matcher) {}
+
+public:
+    // Delivers queued acks the way StrategyContainer::onOrderResp() does:
+    // translate, ProcessorIn chain, strategy
+    //
+    template <typename TProcessorIn, typename TClient>
+    void drain(TProcessorIn& processorIn, TClient& client) {
+        for ( size_t i = 0; i < _resps.size(); ++i ) {
+            tw::common::LatencyScope timer(_ackIn);
+
+            TOrderResp& resp = _resps[i];
+            TOrders::iterator iter = _orders.find(resp._exOrderId);
+            if ( iter == _orders.end() )
+                continue;
+
+            TOrderPtr order = iter->second;
+            switch ( resp._type ) {
+                case tw::channel_or::eOrderRespType::kNewAck:
+                    if ( tw::channel_or::Translator::translateNewAck(resp, order) ) {
+                        processorIn.onNewAck(order);
+                        client.onNewAck(order);
+                    }
+                    break;
+                case tw::channel_or::eOrderRespType::kCxlAck:
+                    _orders.erase(iter);
+                    if ( tw::channel_or::Translator::translateCxlAck(resp, order) ) {
+                        processorIn.onCxlAck(order);
+                        client.onCxlAck(order);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        _resps.clear();
+    }
+
+private:
+    void queue(const tw::exchange_sim::TOrderPtr& order, tw::channel_or::eOrderRespType type) {
+        _resps.resize(_resps.size()+1);
+
+        TOrderResp& resp = _resps.back();
+        resp._timestamp1.setToNow();
+        resp._type = type;
+        resp._clOrderId = order->_clOrderId;
+        resp._origClOrderId = order->_origClOrderId;
+        resp._exOrderId = order->_exOrderId;
+    }
+
+    static TReject getRej(const std::string& text) {
+        TReject rej;
+
+        rej._rejType = tw::channel_or::eRejectType::kInternal;
+        rej._rejSubType = tw::channel_or::eRejectSubType::kConnection;
+        rej._rejReason = tw::channel_or::eRejectReason::kSystemError;
+        rej._text = text;
+
+        return rej;
+    }
+
+private:
+    THistogram& _tickToOrder;
+    THistogram& _ackIn;
+
+    int64_t _tickNanos;
+    uint32_t _fills;
+
+    tw::exchange_sim::TMatcherPtr _matcher;
+    TOrders _orders;
+    TOrderResps _resps;
+};
+
+typedef tw::channel_or::ProcessorOut<LoopbackExchange> TProcessorOutLoopback;
+typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorPnL, TProcessorOutLoopback> TProcessorOutPnL;
+typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorRisk, TProcessorOutPnL> TProcessorOutRisk;
+typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorWTP, TProcessorOutRisk> TProcessorOutWTP;
+typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorThrottle, TProcessorOutWTP> TProcessorOutThrottle;
+typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorOrders, TProcessorOutThrottle> TProcessorOutOrders;
+typedef tw::channel_or::ProcessorOut<tw::channel_or::ProcessorMessaging, TProcessorOutOrders> TProcessorOut;
+
+typedef tw::channel_or::ProcessorIn<tw::channel_or::ProcessorOrders> TProcessorInOrders;
+typedef tw::channel_or::ProcessorIn<tw::channel_or::ProcessorMessaging, TProcessorInOrders> TProcessorInMessaging;
+typedef tw::channel_or::ProcessorIn<tw::channel_or::ProcessorPnL, TProcessorInMessaging> TProcessorIn;
+
+// Keeps at most one order working: places it OFFSET ticks below the bid on
+// one quote and cancels it on the next one
+//
+class ReferenceStrategy {
+public:
+    static const int32_t OFFSET = 10;
+
+public:
+    ReferenceStrategy(TProcessorOut& processorOut,
+                      const tw::instr::InstrumentPtr& instrument,
+                      tw::channel_or::TAccountId accountId,
+                      tw::channel_or::TStrategyId strategyId) : _processorOut(processorOut),
+                                                                _instrument(instrument),
+                                                                _accountId(accountId),
+                                                                _strategyId(strategyId),
+                                                                _orderToAck(registerStage("order_to_ack")),
+                                                                _sentNanos(0),
+                                                                _sent(0),
+                                                                _acked(0),
+                                                                _rejected(0) {
+    }
+
+    uint32_t getSent() const {
+        return _sent;
+    }
+
+    uint32_t getAcked() const {
+        return _acked;
+    }
+
+    uint32_t getRejected() const {
+        return _rejected;
+    }
+
+    bool isPending() const {
+        return (_sent > _acked+_rejected);
+    }
+
+public:
+    void onQuote(const tw::price::Quote& quote) {
+        if ( isPending() )
+            return;
+
+        TReject rej;
+        bool status = true;
+
+        tw::common::LatencyScope chainTimer(tw::common::Instrumentation::instance().getStage(tw::common::Instrumentation::kProcessorChain));
+        _sentNanos = tw::common::nowNanos();
+        ++_sent;
+        if ( !_order ) {
+            _order = OrderHelper::getBuyLimit(quote._book[0]._bid._price.get()-OFFSET, 1, _instrument);
+            _order->_accountId = _accountId;
+            _order->_strategyId = _strategyId;
+
+            status = _processorOut.sendNew(_order, rej);
+        } else {
+            status = _processorOut.sendCxl(_order, rej);
+        }
+
+        if ( !status ) {
+            ++_rejected;
+            std::cout << "Rejected: " << rej.toString() << "\n";
+        }
+    }
+
+    void onNewAck(const TOrderPtr& order) {
+        onAck();
+    }
+
+    void onCxlAck(const TOrderPtr& order) {
+        onAck();
+        _order.reset();
+    }
+
+private:
+    void onAck() {
+        if ( _orderToAck.isEnabled() )
+            _orderToAck.record(tw::common::nowNanos() - _sentNanos);
+
+        ++_acked;
+    }
+
+private:
+    TProcessorOut& _processorOut;
+    tw::instr::InstrumentPtr _instrument;
+    tw::channel_or::TAccountId _accountId;
+    tw::channel_or::TStrategyId _strategyId;
+
+    THistogram& _orderToAck;
+    int64_t _sentNanos;
+
+    uint32_t _sent;
+    uint32_t _acked;
+    uint32_t _rejected;
+
+    TOrderPtr _order;
+};
+
+int main(int argc, char* argv[])
+{
+    uint32_t ticks = 1000000;
+    if ( argc > 1 )
+        ticks = boost::lexical_cast<uint32_t>(argv[1]);
+
+    const uint32_t warmup = ticks/10;
+    const int32_t base = 9240;
+
+    // Limits are set high enough to never reject - throttle's counters
+    // aren't reset as timer server isn't running
+    //
+    tw::risk::Account account;
+    account._id = 1;
+    account._name = "speedtest";
+    account._maxMPSNew = std::numeric_limits<uint32_t>::max();
+    account._maxMPSMod = std::numeric_limits<uint32_t>::max();
+    account._maxMPSCxl = std::numeric_limits<uint32_t>::max();
+    account._maxRealizedDrawdown = 1000000.0;
+    account._maxUnrealizedDrawdown = 1000000.0;
+    account._maxRealizedLoss = 1000000.0;
+    account._maxUnrealizedLoss = 1000000.0;
+    account._maxTotalLoss = 1000000.0;
+    account._tradeEnabled = true;
+
+    tw::risk::Strategy strat;
+    strat._id = 1;
+    strat._name = "speedtest";
+    strat._accountId = account._id;
+    strat._maxRealizedDrawdown = 1000000.0;
+    strat._maxUnrealizedDrawdown = 1000000.0;
+    strat._maxRealizedLoss = 1000000.0;
+    strat._maxUnrealizedLoss = 1000000.0;
+    strat._tradeEnabled = true;
+
+    tw::instr::InstrumentPtr instrument = InstrHelper::getNQH2();
+    tw::instr::InstrumentManager::instance().addInstrument(instrument);
+
+    tw::risk::AccountRiskParams param;
+    param._accountId = account._id;
+    param._displayName = instrument->_displayName;
+    param._exchange = instrument->_exchange;
+    param._clipSize = 10;
+    param._maxPos = 10;
+    param._tradeEnabled = true;
+
+    tw::channel_or::ProcessorOrders& p_orders = tw::channel_or::ProcessorOrders::instance();
+    tw::channel_or::ProcessorThrottle& p_throttle = tw::channel_or::ProcessorThrottle::instance();
+    tw::channel_or::ProcessorWTP& p_wtp = tw::channel_or::ProcessorWTP::instance();
+    tw::channel_or::ProcessorRisk& p_risk = tw::channel_or::ProcessorRisk::instance();
+    tw::channel_or::ProcessorPnL& p_pnl = tw::channel_or::ProcessorPnL::instance();
+    tw::channel_or::ProcessorMessaging& p_messaging = tw::channel_or::ProcessorMessaging::instance();
+
+    if ( !p_throttle.init(account) || !p_throttle.start() ) {
+        std::cout << "Can't init throttle processor" << "\n";
+        return -1;
+    }
+
+    if ( !p_risk.init(account, std::vector<tw::risk::AccountRiskParams>(1, param)) ) {
+        std::cout << "Can't init risk processor" << "\n";
+        return -1;
+    }
+
+    if ( !p_pnl.init(account, std::vector<tw::risk::Strategy>(1, strat)) ) {
+        std::cout << "Can't init pnl processor" << "\n";
+        return -1;
+    }
+
+    if ( !tw::channel_or_cme::IdFactory::instance().start() ) {
+        std::cout << "Can't start id factory" << "\n";
+        return -1;
+    }
+
+    LoopbackExchange exchange;
+    if ( !exchange.init(instrument) ) {
+        std::cout << "Can't init loopback exchange" << "\n";
+        return -1;
+    }
+
+    TProcessorOutLoopback p_out_loopback(exchange, "loopback");
+    TProcessorOutPnL p_out_pnl(p_pnl, p_out_loopback, "pnl");
+    TProcessorOutRisk p_out_risk(p_risk, p_out_pnl, "risk");
+    TProcessorOutWTP p_out_wtp(p_wtp, p_out_risk, "wtp");
+    TProcessorOutThrottle p_out_throttle(p_throttle, p_out_wtp, "throttle");
+    TProcessorOutOrders p_out_orders(p_orders, p_out_throttle, "orders");
+    TProcessorOut p_out(p_messaging, p_out_orders, "messaging");
+
+    TProcessorInOrders p_in_orders(p_orders);
+    TProcessorInMessaging p_in_messaging(p_messaging, p_in_orders);
+    TProcessorIn p_in(p_pnl, p_in_messaging);
+
+    ReferenceStrategy strategy(p_out, instrument, account._id, strat._id);
+
+    tw::common::Instrumentation::instance().setEnabled(true);
+
+    tw::price::Quote quote;
+    quote._instrument = instrument.get();
+    quote._status = tw::price::Quote::kSuccess;
+
+    int64_t t0 = 0;
+    uint32_t acked = 0;
+    for ( uint32_t i = 0; i < ticks+warmup; ++i ) {
+        if ( i == warmup ) {
+            tw::common::Instrumentation::instance().reset();
+            acked = strategy.getAcked();
+            t0 = tw::common::nowNanos();
+        }
+
+        // Synthetic quote - bid oscillates within a few ticks, so that
+        // strategy's orders always rest
+        //
+        int32_t bid = base + static_cast<int32_t>(i%8) - 4;
+
+        quote.clearFlag();
+        quote.setBid(tw::price::Ticks(bid), tw::price::Size(10+i%5), 0, 1);
+        quote.setAsk(tw::price::Ticks(bid+1), tw::price::Size(10+i%3), 0, 1);
+
+        int64_t tickNanos = tw::common::nowNanos();
+        exchange.setTickNanos(tickNanos);
+        exchange.onQuote(quote);
+
+        strategy.onQuote(quote);
+        exchange.drain(p_in, strategy);
+    }
+
+    int64_t nanos = tw::common::nowNanos() - t0;
+    acked = strategy.getAcked() - acked;
+
+    tw::common::Instrumentation::TNamedSnapshots snapshots;
+    tw::common::Instrumentation::instance().getSnapshots(snapshots);
+
+    std::cout << "ticks: " << ticks << ", acked requests: " << acked << ", rejected: " << strategy.getRejected() << ", unexpected fills: " << exchange.getFills() << "\n";
+    std::cout << "requests/sec: " << ((nanos > 0) ? (acked*1000000000.0/nanos) : 0.0) << "\n\n";
+
+    std::cout << "stage\t\t\t\tcount\tp50\tp99\tp999\tmax (nanos)\n";
+    for ( size_t i = 0; i < snapshots.size(); ++i ) {
+        const tw::common::LatencyHistogram::Snapshot& s = snapshots[i].second;
+        if ( 0 == s._count )
+            continue;
+
+        printf("%-32s%lu\t%lu\t%lu\t%lu\t%lu\n", snapshots[i].first.c_str(),
+                                                static_cast<unsigned long>(s._count),
+                                                static_cast<unsigned long>(s.percentile(0.5)),
+                                                static_cast<unsigned long>(s.percentile(0.99)),
+                                                static_cast<unsigned long>(s.percentile(0.999)),
+                                                static_cast<unsigned long>(s._max));
+    }
+    fflush(stdout);
+
+    tw::common::Instrumentation::instance().setEnabled(false);
+    tw::channel_or_cme::IdFactory::instance().stop();
+
+    p_orders.clear();
+    p_throttle.clear();
+    p_wtp.clear();
+    p_risk.clear();
+    p_pnl.clear();
+
+    return (strategy.getRejected() > 0) ? -1 : 0;
+}
@@ -0,0 +1,241 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/price/ticks_converter.h>
+#include <tw/functional/delegate.hpp>
+
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures throughput of ticks <-> exchange price conversions on a mix of
+// CME tick structures: delegates to runtime selected converters (as tick
+// converter used to dispatch), TicksRatio's switch on ratio class,
+// TicksConverter's function objects and converters of ratio class known
+// at compile time
+//
+typedef tw::common::THighResTime __prop_clock_t;
+
+__prop_clock_t __prop_clock() {
+    return __prop_clock_t::now();
+}
+
+typedef tw::price::Ticks TTicks;
+
+// Delegate based dispatch as in tick converter before compile time
+// specialized ratio classes
+//
+class DelegateConverter {
+public:
+    typedef tw::functional::delegate1<TTicks, const double&> TConverterFrom;
+    typedef tw::functional::delegate1<double, const TTicks&> TConverterTo;
+
+public:
+    DelegateConverter(uint32_t num, uint32_t denom) : _num(num),
+                                                      _denom(denom) {
+        if ( num == denom ) {
+            _convertFrom = TConverterFrom::from_method<DelegateConverter, &DelegateConverter::fromNull>(this);
+            _convertTo = TConverterTo::from_method<DelegateConverter, &DelegateConverter::toNull>(this);
+        } else if ( 1 == denom ) {
+            _convertFrom = TConverterFrom::from_method<DelegateConverter, &DelegateConverter::fromNum>(this);
+            _convertTo = TConverterTo::from_method<DelegateConverter, &DelegateConverter::toNum>(this);
+        } else if ( 1 == num ) {
+            _convertFrom = TConverterFrom::from_method<DelegateConverter, &DelegateConverter::fromDenom>(this);
+            _convertTo = TConverterTo::from_method<DelegateConverter, &DelegateConverter::toDenom>(this);
+        } else {
+            _convertFrom = TConverterFrom::from_method<DelegateConverter, &DelegateConverter::fromFull>(this);
+            _convertTo = TConverterTo::from_method<DelegateConverter, &DelegateConverter::toFull>(this);
+        }
+    }
+
+    TTicks fromExchangePrice(const double& price) {
+        return _convertFrom(price);
+    }
+
+    double toExchangePrice(const TTicks& ticks) {
+        return _convertTo(ticks);
+    }
+
+private:
+    TTicks fromNull(const double& price) {
+        return tw::price::TicksRatioNull::fromExchangePrice(price, _num, _denom);
+    }
+
+    TTicks fromNum(const double& price) {
+        return tw::price::TicksRatioNum::fromExchangePrice(price, _num, _denom);
+    }
+
+    TTicks fromDenom(const double& price) {
+        return tw::price::TicksRatioDenom::fromExchangePrice(price, _num, _denom);
+    }
+
+    TTicks fromFull(const double& price) {
+        return tw::price::TicksRatioFull::fromExchangePrice(price, _num, _denom);
+    }
+
+    double toNull(const TTicks& ticks) {
+        return tw::price::TicksRatioNull::toExchangePrice(ticks, _num, _denom);
+    }
+
+    double toNum(const TTicks& ticks) {
+        return tw::price::TicksRatioNum::toExchangePrice(ticks, _num, _denom);
+    }
+
+    double toDenom(const TTicks& ticks) {
+        return tw::price::TicksRatioDenom::toExchangePrice(ticks, _num, _denom);
+    }
+
+    double toFull(const TTicks& ticks) {
+        return tw::price::TicksRatioFull::toExchangePrice(ticks, _num, _denom);
+    }
+
+private:
+    uint32_t _num;
+    uint32_t _denom;
+    TConverterFrom _convertFrom;
+    TConverterTo _convertTo;
+};
+
+struct TickStructure {
+    const char* _name;
+    uint32_t _num;
+    uint32_t _denom;
+};
+
+// Tick numerator/denominator as in CME instruments' settings
+//
+static const TickStructure STRUCTURES[] = {
+    { "ES", 25, 100 },
+    { "NQ", 1, 4 },
+    { "ZN", 1, 64 },
+    { "ZB", 1, 32 },
+    { "CL", 1, 100 },
+    { "GC", 1, 10 },
+    { "SI", 5, 1000 },
+    { "6E", 5, 100000 },
+    { "6J", 5, 10000000 },
+    { "HE", 25, 1000 },
+    { "ZC", 25, 100 },
+    { "IDX", 1, 1 }
+};
+
+static const size_t STRUCTURES_COUNT = sizeof(STRUCTURES)/sizeof(STRUCTURES[0]);
+
+static void print(const char* name, uint64_t count, int64_t micros, double check) {
+    printf("%-28s\t", name);
+    std::cout << ((count > 0) ? (micros*1000.0/count) : 0.0) << "\t\t" << ((micros > 0) ? static_cast<int64_t>(count*1000000.0/micros) : 0) << "\t" << check << "\n";
+    fflush(stdout);
+}
+
+template <typename TRatio>
+static double runCompileTime(const std::vector<TTicks>& ticks, uint32_t num, uint32_t denom, uint32_t rounds) {
+    tw::price::TicksRatioConverter<TRatio> c(num, denom);
+
+    double check = 0.0;
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        for ( size_t i = 0; i < ticks.size(); ++i )
+            check += c.fromExchangePrice(c.toExchangePrice(ticks[i])).get();
+    }
+
+    return check;
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t count = 1000000;
+    const uint32_t rounds = 10;
+
+    // Conversions go in a scattered order of instruments, as quotes of
+    // different instruments do
+    //
+    std::vector<TTicks> ticks(count);
+    std::vector<uint32_t> order(count);
+    for ( uint32_t i = 0; i < count; ++i ) {
+        ticks[i].set(100000+static_cast<int32_t>((i*7919ULL) % 5000));
+        order[i] = static_cast<uint32_t>((i*104729ULL) % STRUCTURES_COUNT);
+    }
+
+    std::vector<DelegateConverter*> delegates;
+    std::vector<tw::price::TicksRatio> ratios(STRUCTURES_COUNT);
+    std::vector<tw::price::TicksConverter::TConverterFrom> froms;
+    std::vector<tw::price::TicksConverter::TConverterTo> tos;
+    for ( size_t i = 0; i < STRUCTURES_COUNT; ++i ) {
+        delegates.push_back(new DelegateConverter(STRUCTURES[i]._num, STRUCTURES[i]._denom));
+        ratios[i].set(STRUCTURES[i]._num, STRUCTURES[i]._denom);
+        froms.push_back(tw::price::TicksConverter::TConverterFrom(ratios[i]));
+        tos.push_back(tw::price::TicksConverter::TConverterTo(ratios[i]));
+    }
+
+    __prop_clock_t t0,t1;
+    double check = 0.0;
+
+    std::cout << "conversions: " << count*rounds << " round trips (ticks -> price -> ticks) on " << STRUCTURES_COUNT << " tick structures" << "\n";
+    std::cout << "    dispatch                \tnanos/trip\ttrips/sec\tcheck\n";
+
+    check = 0.0;
+    t0 = __prop_clock();
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        for ( uint32_t i = 0; i < count; ++i ) {
+            DelegateConverter& c = *delegates[order[i]];
+            check += c.fromExchangePrice(c.toExchangePrice(ticks[i])).get();
+        }
+    }
+    t1 = __prop_clock();
+    print("delegates", static_cast<uint64_t>(count)*rounds, t1-t0, check);
+
+    check = 0.0;
+    t0 = __prop_clock();
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        for ( uint32_t i = 0; i < count; ++i ) {
+            const tw::price::TicksRatio& c = ratios[order[i]];
+            check += c.fromExchangePrice(c.toExchangePrice(ticks[i])).get();
+        }
+    }
+    t1 = __prop_clock();
+    print("TicksRatio", static_cast<uint64_t>(count)*rounds, t1-t0, check);
+
+    check = 0.0;
+    t0 = __prop_clock();
+    for ( uint32_t r = 0; r < rounds; ++r ) {
+        for ( uint32_t i = 0; i < count; ++i )
+            check += froms[order[i]](tos[order[i]](ticks[i])).get();
+    }
+    t1 = __prop_clock();
+    print("TConverterFrom/To", static_cast<uint64_t>(count)*rounds, t1-t0, check);
+
+    // Each instrument's conversions in its own loop - ratio class known at
+    // compile time
+    //
+    std::vector<std::vector<TTicks> > instrumentsTicks(STRUCTURES_COUNT);
+    for ( uint32_t i = 0; i < count; ++i )
+        instrumentsTicks[order[i]].push_back(ticks[i]);
+
+    check = 0.0;
+    t0 = __prop_clock();
+    for ( size_t i = 0; i < STRUCTURES_COUNT; ++i ) {
+        const std::vector<TTicks>& instrumentTicks = instrumentsTicks[i];
+        uint32_t num = STRUCTURES[i]._num;
+        uint32_t denom = STRUCTURES[i]._denom;
+        switch ( ratios[i].getClass() ) {
+            case tw::price::TicksRatio::kNum:
+                check += runCompileTime<tw::price::TicksRatioNum>(instrumentTicks, num, denom, rounds);
+                break;
+            case tw::price::TicksRatio::kDenom:
+                check += runCompileTime<tw::price::TicksRatioDenom>(instrumentTicks, num, denom, rounds);
+                break;
+            case tw::price::TicksRatio::kFull:
+                check += runCompileTime<tw::price::TicksRatioFull>(instrumentTicks, num, denom, rounds);
+                break;
+            default:
+                check += runCompileTime<tw::price::TicksRatioNull>(instrumentTicks, num, denom, rounds);
+                break;
+        }
+    }
+    t1 = __prop_clock();
+    print("TicksRatioConverter<>", static_cast<uint64_t>(count)*rounds, t1-t0, check);
+
+    for ( size_t i = 0; i < delegates.size(); ++i )
+        delete delegates[i];
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <tw/common/defs.h>
+#include <tw/common/high_res_time.h>
+#include <tw/channel_or/processor_wtp.h>
+
+#include "unit_test_channel_or_lib/order_helper.h"
+
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+// Measures ProcessorWTP's wash trade check per order against own resting
+// ladders of growing depth (non crossing orders - worst case, since all
+// resting orders on the other side would have to be considered)
+//
+typedef tw::common::THighResTime __prop_clock_t;
+
+__prop_clock_t __prop_clock() {
+    return __prop_clock_t::now();
+}
+
+typedef tw::channel_or::ProcessorWTP TProcessorWTP;
+
+static double perOrder(uint32_t count, int64_t micros) {
+    return (count > 0) ? (micros*1000.0/count) : 0.0;
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t max = 1000000;
+    const uint32_t depths[] = { 1, 10, 100, 1000 };
+
+    TProcessorWTP& p = TProcessorWTP::instance();
+    tw::instr::InstrumentPtr instrument = InstrHelper::getNQM2();
+
+    __prop_clock_t t0,t1;
+    tw::channel_or::Reject rej;
+
+    std::cout << "    depth   \tnanos/check\n";
+
+    for ( size_t n = 0; n < sizeof(depths)/sizeof(depths[0]); ++n ) {
+        const uint32_t depth = depths[n];
+
+        p.clear();
+
+        // Bids at 1000 and below, asks at 2000 and above
+        //
+        std::vector<tw::channel_or::TOrderPtr> resting;
+        for ( uint32_t i = 0; i < depth; ++i ) {
+            tw::channel_or::TOrderPtr bid = OrderHelper::getBuyLimit(1000-i, 1, instrument);
+            tw::channel_or::TOrderPtr ask = OrderHelper::getSellLimit(2000+i, 1, instrument);
+            if ( !p.sendNew(bid, rej) || !p.sendNew(ask, rej) ) {
+                std::cout << "Failed: " << rej.toString() << "\n";
+                return -1;
+            }
+
+            bid->_state = ask->_state = tw::channel_or::eOrderState::kWorking;
+            resting.push_back(bid);
+            resting.push_back(ask);
+        }
+
+        uint32_t passed = 0;
+        t0 = __prop_clock();
+        for ( uint32_t i = 0; i < max; ++i ) {
+            if ( p.canSend(instrument, (i%2) ? tw::channel_or::eOrderSide::kSell : tw::channel_or::eOrderSide::kBuy, tw::price::Ticks(1001+i%999), rej) )
+                ++passed;
+        }
+        t1 = __prop_clock();
+
+        if ( passed != max ) {
+            std::cout << "Unexpected wash trade rejects: " << (max-passed) << "\n";
+            return -1;
+        }
+
+        printf("%u\t\t", depth);
+        std::cout << perOrder(max, t1-t0) << "\n";
+        fflush(stdout);
+    }
+
+    p.clear();
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include <tw/common/filesystem.h>
+
+#include "../audit_cme/selector_fix_msgs.h"
+#include "../audit_cme/audit_cme_formatter.h"
+#include "../audit_cme/audit_cme_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <fstream>
+#include <sstream>
+
+typedef tw::channel_or::FixSessionCMEMsgForAudit TRecord;
+typedef tw::audit_cme::SelectorFixMsgsFile TSelectorFile;
+
+static const std::string SOURCE_FILE = "audit_cme_test_source.txt";
+
+static std::string getMessage(char type, const std::string& body) {
+    std::string message = "8=FIX.4.2\0019=100\00135=";
+    message += type;
+    message += "\001";
+    message += body;
+    message += "10=000\001";
+    return message;
+}
+
+static TRecord getRecord(uint32_t index, tw::channel_or::eDirection::_ENUM direction, const std::string& message) {
+    TRecord record;
+    record._index = index;
+    record._direction = direction;
+    record._message = message;
+    return record;
+}
+
+// Session of orders on a few instruments: order, acks, fills, cancels and
+// rejects in both directions, interleaved with session level messages,
+// which aren't audited
+//
+static void getRecords(uint32_t count, std::vector<TRecord>& records) {
+    static const char* EXEC_TYPES = "012458CH";
+    static const char* SYMBOLS[] = { "NQH2", "ESH2", "6EH2" };
+
+    for ( uint32_t i = 0; i < count; ++i ) {
+        std::string n = boost::lexical_cast<std::string>(i);
+        std::string common = "49=7E59Z1N\00150=AMR_TW\00152=20120117-14:41:01." + n + "\001142=US,IL\0011028=Y\0011=82409802\001"
+                             "11=ID" + n + "\001107=" + SYMBOLS[i%3] + "\00155=NQ\00138=" + boost::lexical_cast<std::string>(1+i%7) + "\001";
+
+        switch ( i % 7 ) {
+            case 0:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kOutbound, getMessage('D', common + "54=" + ((i%2) ? "1" : "2") + "\00140=2\00144=2449.25\001204=" + ((i%3) ? "0" : "1") + "\001")));
+                break;
+            case 1:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kInbound, getMessage('8', "56=7E59Z1N\00157=AMR_TW\00137=" + n + "\001150=" + EXEC_TYPES[i%8] + "\00132=1\00131=2449.5\001103=0\001" + common)));
+                break;
+            case 2:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kOutbound, getMessage('0', "49=7E59Z1N\001")));
+                break;
+            case 3:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kOutbound, getMessage('G', common + "54=1\00140=1\00159=1\00199=2448\001")));
+                break;
+            case 4:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kOutbound, getMessage('F', common + "9717=C" + n + "\00159=3\001")));
+                break;
+            case 5:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kInbound, getMessage('9', "56=7E59Z1N\001102=1\001" + common)));
+                break;
+            default:
+                records.push_back(getRecord(i+1, tw::channel_or::eDirection::kInbound, getMessage('3', "56=7E59Z1N\00158=Unknown, field\001461=FXXXXS\001200=201203\001205=16\001")));
+                break;
+        }
+    }
+}
+
+static std::string run(const tw::common::Settings& settings, uint32_t threads, uint32_t chunkSize) {
+    TSelectorFile selector;
+    EXPECT_TRUE(selector.start(settings));
+
+    std::stringstream out;
+    tw::audit_cme::AuditCmeWriter writer(threads, chunkSize);
+    EXPECT_TRUE(writer.run(selector, out));
+
+    return out.str();
+}
+
+TEST(AuditCmeTestSuit, formatter)
+{
+    tw::audit_cme::AuditCmeFormatter formatter;
+    tw::channel_or::AuditCme auditRecord;
+
+    // New order to CME - values with commas have them replaced
+    //
+    ASSERT_TRUE(formatter.format(getRecord(12, tw::channel_or::eDirection::kOutbound, getMessage('D', "49=7E59Z1N\00150=AMR_TW\00152=20120117-14:41:01.548\001142=US,IL\0011=82409802\00111=ID1\00154=1\00138=3\001107=ZZH2\00155=ZZ\00140=2\00144=2449.25\001204=0\001461=FXXXXS\001200=201203\001")), auditRecord));
+    ASSERT_EQ(auditRecord._serverTransactionNumber, "12");
+    ASSERT_EQ(auditRecord._serverTimestamp, "20120117-14:41:01.548");
+    ASSERT_EQ(auditRecord._senderLocationID, "US_IL");
+    ASSERT_EQ(auditRecord._messageDirection, "TO CME");
+    ASSERT_EQ(auditRecord._messageType, "NEW ORDER");
+    ASSERT_EQ(auditRecord._sessionID, "7E5");
+    ASSERT_EQ(auditRecord._executingFirmNumber, "9Z1");
+    ASSERT_EQ(auditRecord._tag50, "AMR_TW");
+    ASSERT_EQ(auditRecord._accountNumber, "82409802");
+    ASSERT_EQ(auditRecord._clientOrderID, "ID1");
+    ASSERT_EQ(auditRecord._buyOrSellIndicator, "B");
+    ASSERT_EQ(auditRecord._orderQty, "3");
+    ASSERT_EQ(auditRecord._limitPrice, "2449.25");
+    ASSERT_EQ(auditRecord._orderType, "2");
+    ASSERT_EQ(auditRecord._orderQualifier, "Day");
+    ASSERT_EQ(auditRecord._customerTypeIndicator, "4");
+    ASSERT_EQ(auditRecord._CFICode, "FXXXXS");
+    ASSERT_EQ(auditRecord._maturityDate, "201203 ");
+
+    // Fill from CME
+    //
+    ASSERT_TRUE(formatter.format(getRecord(13, tw::channel_or::eDirection::kInbound, getMessage('8', "56=7E59Z1N\00157=AMR_TW\001150=1\00132=2\00131=2449.5\00154=2\00159=1\001")), auditRecord));
+    ASSERT_EQ(auditRecord._messageDirection, "FROM CME");
+    ASSERT_EQ(auditRecord._messageType, "EXECUTION");
+    ASSERT_EQ(auditRecord._orderStatus, "PARTIAL FILL");
+    ASSERT_EQ(auditRecord._lastShares, "2");
+    ASSERT_EQ(auditRecord._fillPrice, "2449.5");
+    ASSERT_EQ(auditRecord._buyOrSellIndicator, "S");
+    ASSERT_EQ(auditRecord._orderQualifier, "GTC");
+    ASSERT_EQ(auditRecord._orderType, "");
+    ASSERT_EQ(auditRecord._customerTypeIndicator, "");
+
+    // Session level and malformed messages aren't audited
+    //
+    ASSERT_FALSE(formatter.format(getRecord(14, tw::channel_or::eDirection::kOutbound, getMessage('0', "")), auditRecord));
+    ASSERT_FALSE(formatter.format(getRecord(15, tw::channel_or::eDirection::kOutbound, "35=D\001garbage"), auditRecord));
+}
+
+TEST(AuditCmeTestSuit, streaming)
+{
+    std::vector<TRecord> records;
+    getRecords(1000, records);
+
+    {
+        std::ofstream file(SOURCE_FILE.c_str(), std::ios_base::out | std::ios_base::trunc);
+        file << "# index<TAB>direction<TAB>message\n";
+        for ( size_t i = 0; i < records.size(); ++i )
+            file << TSelectorFile::toLine(records[i]) << "\n";
+    }
+
+    tw::common::Settings settings;
+    settings._audit_cme_source_file = SOURCE_FILE;
+
+    // Records are read in chunks in file's order
+    //
+    TSelectorFile selector;
+    ASSERT_TRUE(selector.start(settings));
+
+    tw::audit_cme::TRecords chunk;
+    ASSERT_TRUE(selector.readChunk(600, chunk));
+    ASSERT_EQ(chunk.size(), 600U);
+    ASSERT_EQ(chunk[0]._index, 1U);
+    ASSERT_EQ(chunk[0]._message, records[0]._message);
+    ASSERT_EQ(chunk[1]._direction, tw::channel_or::eDirection::kInbound);
+    ASSERT_TRUE(selector.readChunk(600, chunk));
+    ASSERT_EQ(chunk.size(), 400U);
+    ASSERT_EQ(chunk.back()._index, 1000U);
+    ASSERT_TRUE(selector.readChunk(600, chunk));
+    ASSERT_TRUE(chunk.empty());
+
+    // Expected output - all records formatted serially
+    //
+    std::string expected = tw::channel_or::AuditCme::header() + "\n";
+    tw::audit_cme::AuditCmeFormatter formatter;
+    tw::channel_or::AuditCme auditRecord;
+    size_t audited = 0;
+    for ( size_t i = 0; i < records.size(); ++i ) {
+        if ( formatter.format(records[i], auditRecord) ) {
+            expected += auditRecord.toString() + "\n";
+            ++audited;
+        }
+    }
+
+    ASSERT_EQ(audited, 1000U - 1000U/7 - 1);
+
+    // Same output whatever number of threads and chunk size, including
+    // chunks smaller than number of threads
+    //
+    ASSERT_EQ(run(settings, 1, 100000), expected);
+    ASSERT_EQ(run(settings, 1, 1), expected);
+    ASSERT_EQ(run(settings, 4, 10000), expected);
+    ASSERT_EQ(run(settings, 4, 64), expected);
+    ASSERT_EQ(run(settings, 3, 2), expected);
+    ASSERT_EQ(run(settings, 0, 0), expected);
+
+    // Writer's worker threads are stopped at the end of each run, so the
+    // same writer can run again
+    //
+    tw::audit_cme::AuditCmeWriter writer(4, 64);
+    for ( uint32_t i = 0; i < 2; ++i ) {
+        TSelectorFile selectorAgain;
+        ASSERT_TRUE(selectorAgain.start(settings));
+
+        std::stringstream out;
+        ASSERT_TRUE(writer.run(selectorAgain, out));
+        ASSERT_EQ(out.str(), expected);
+        ASSERT_EQ(writer.getCount(), 1000U);
+    }
+
+    tw::common::Filesystem::remove(SOURCE_FILE);
+}
@@ -0,0 +1,55 @@
+#include <tw/channel_or_cme/fix_message_view.h>
+
+#include <gtest/gtest.h>
+
+TEST(ChannelOrCmeLibTestSuit, fixMessageView)
+{
+    typedef tw::channel_or_cme::FixMessageView TView;
+
+    std::string raw = "8=FIX.4.2\0019=120\00135=D\00149=7E59Z1N\001142=US,IL\00154=1\00158=\00155=NQ\00155=ES\00110=123\001";
+
+    TView view;
+    ASSERT_TRUE(view.parse(raw));
+    ASSERT_EQ(view.getFields().size(), 10U);
+    ASSERT_EQ(view.getType(), 'D');
+
+    // Values point into raw message
+    //
+    const TView::Field* field = view.find(49);
+    ASSERT_TRUE(field != NULL);
+    ASSERT_TRUE(field->_value >= raw.data() && field->_value < raw.data()+raw.size());
+    ASSERT_EQ(field->_length, 7U);
+
+    ASSERT_EQ(view.get(142), "US,IL");
+    ASSERT_EQ(view.get(10), "123");
+    ASSERT_TRUE(view.isEqual(54, "1"));
+    ASSERT_FALSE(view.isEqual(54, "12"));
+    ASSERT_FALSE(view.isEqual(38, ""));
+
+    // Empty value is present, missing tag isn't
+    //
+    ASSERT_TRUE(view.contain(58));
+    ASSERT_EQ(view.get(58), "");
+    ASSERT_EQ(view.getChar(58), '\0');
+    ASSERT_FALSE(view.contain(38));
+    ASSERT_EQ(view.get(38), "");
+    ASSERT_EQ(view.getChar(150), '\0');
+
+    // First occurrence of repeated tag
+    //
+    ASSERT_EQ(view.get(55), "NQ");
+
+    // Trailing SOH is optional
+    //
+    ASSERT_TRUE(view.parse(std::string("35=8\001150=2")));
+    ASSERT_EQ(view.getType(), '8');
+    ASSERT_EQ(view.getChar(150), '2');
+
+    // Malformed messages
+    //
+    ASSERT_FALSE(view.parse(std::string("")));
+    ASSERT_FALSE(view.parse(std::string("35=D\001garbage\001")));
+    ASSERT_TRUE(view.getFields().empty());
+    ASSERT_FALSE(view.parse(std::string("=D\001")));
+    ASSERT_FALSE(view.parse(std::string("35D")));
+}
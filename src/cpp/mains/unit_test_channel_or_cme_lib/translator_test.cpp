@@ -812,3 +812,139 @@ TEST(ChannelOrCmeLibTestSuit, translator_IOC)
     
     tw::channel_or_cme::ChannelOrOnix::global_shutdown();
 }
+
+static std::string getRawField(const std::string& raw, int32_t tag) {
+    std::string prefix = std::string(1, tw::channel_or_cme::FixTemplate::SOH) + boost::lexical_cast<std::string>(tag) + "=";
+    size_t begin = raw.find(prefix);
+    if ( std::string::npos == begin )
+        return "";
+    
+    begin += prefix.size();
+    return raw.substr(begin, raw.find(tw::channel_or_cme::FixTemplate::SOH, begin) - begin);
+}
+
+// Returns message w/o BeginString, BodyLength and CheckSum fields
+//
+static std::string getRawBody(const std::string& raw) {
+    size_t begin = raw.find(std::string(1, tw::channel_or_cme::FixTemplate::SOH) + "35=");
+    size_t end = raw.rfind(std::string(1, tw::channel_or_cme::FixTemplate::SOH) + "10=");
+    if ( std::string::npos == begin || std::string::npos == end )
+        return "";
+    
+    return raw.substr(begin, end-begin);
+}
+
+// Compares pre-encoded message byte-for-byte w/ the one serialized by FIX engine
+// for the same order (ClOrdID and times are taken from pre-encoded message)
+//
+static bool checkEncoded(tw::channel_or_cme::Translator& t, const OnixS::FIX::Message& msg, const std::string& raw, uint32_t seqNum) {
+    OnixS::FIX::Message m(msg);
+    t.setSessionFields(m, seqNum, getRawField(raw, OnixS::FIX::FIX42::Tags::SendingTime));
+    m.set(OnixS::FIX::FIX42::Tags::ClOrdID, getRawField(raw, OnixS::FIX::FIX42::Tags::ClOrdID));
+    m.set(OnixS::FIX::FIX42::Tags::TransactTime, getRawField(raw, OnixS::FIX::FIX42::Tags::TransactTime));
+    
+    std::string expected = m.toString(tw::channel_or_cme::FixTemplate::SOH);
+    
+    EXPECT_TRUE(tw::channel_or_cme::FixTemplate::verify(raw));
+    EXPECT_TRUE(!getRawBody(raw).empty());
+    EXPECT_EQ(getRawBody(raw), getRawBody(expected));
+    
+    return (tw::channel_or_cme::FixTemplate::verify(raw) && !getRawBody(raw).empty() && getRawBody(raw) == getRawBody(expected));
+}
+
+TEST(ChannelOrCmeLibTestSuit, translator_encoded)
+{
+    ASSERT_TRUE(tw::channel_or_cme::ChannelOrOnix::global_init(getGlobalSettings()));
+    
+    tw::channel_or_cme::Translator t;
+    tw::channel_or_cme::TSessionSettingsPtr settings = getSessionSettings();
+    ASSERT_TRUE(t.init(settings));
+    
+    tw::channel_or::Reject rej;
+    
+    // New - first order builds template
+    //
+    tw::channel_or::TOrderPtr order = OrderHelper::getBuyLimit(9241, 2);
+    order->_manual = true;
+    
+    ASSERT_TRUE(t.encodeNew(order, 1, rej));
+    ASSERT_TRUE(checkEncoded(t, t.getMsgNew(), t.getRawNew(), 1));
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::ClOrdID), order->_clOrderId);
+    
+    // New - patched
+    //
+    order = OrderHelper::getSellLimit(9243, 4);
+    order->_manual = false;
+    
+    tw::channel_or::TOrderPtr ref(new tw::channel_or::Order(*order));
+    
+    ASSERT_TRUE(t.encodeNew(order, 2, rej));
+    ASSERT_TRUE(!order->_origClOrderId.empty());
+    ASSERT_TRUE(order->_origClOrderId == order->_clOrderId);
+    ASSERT_TRUE(order->_origClOrderId == order->_corrClOrderId);
+    ASSERT_EQ(order->_exSessionName, settings->_senderCompId);
+    ASSERT_NEAR(order->_exPrice, 2310.75, 0.000001);
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::ClOrdID), order->_clOrderId);
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::Price), "2310.75");
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::Side), "2");
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::OrderQty), "4");
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::MsgSeqNum), "2");
+    
+    ASSERT_TRUE(t.translateNew(ref, rej));
+    ASSERT_TRUE(checkEncoded(t, t.getMsgNew(), t.getRawNew(), 2));
+    
+    // New IOC - separate template
+    //
+    order = OrderHelper::getBuyLimit(9241, 2);
+    order->_timeInForce = tw::channel_or::eTimeInForce::kIOC;
+    
+    ASSERT_TRUE(t.encodeNew(order, 3, rej));
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::TimeInForce), "3");
+    ASSERT_TRUE(checkEncoded(t, t.getMsgNew(), t.getRawNew(), 3));
+    
+    order->_timeInForce = tw::channel_or::eTimeInForce::kUnknown;
+    ASSERT_TRUE(t.encodeNew(order, 4, rej));
+    ASSERT_EQ(getRawField(t.getRawNew(), OnixS::FIX::FIX42::Tags::TimeInForce), "");
+    
+    // Mod
+    //
+    order->_newPrice.set(9242);
+    order->_exOrderId = "1234567";
+    
+    ASSERT_TRUE(t.encodeMod(order, 5, rej));
+    ASSERT_TRUE(checkEncoded(t, t.getMsgMod(), t.getRawMod(), 5));
+    
+    order->_newPrice.set(9244);
+    ref.reset(new tw::channel_or::Order(*order));
+    
+    ASSERT_TRUE(t.encodeMod(order, 6, rej));
+    ASSERT_TRUE(order->_origClOrderId != order->_clOrderId);
+    ASSERT_NEAR(order->_exNewPrice, 2311.0, 0.000001);
+    ASSERT_EQ(getRawField(t.getRawMod(), OnixS::FIX::FIX42::Tags::Price), "2311");
+    ASSERT_EQ(getRawField(t.getRawMod(), OnixS::FIX::FIX42::Tags::OrderID), "1234567");
+    ASSERT_EQ(getRawField(t.getRawMod(), OnixS::FIX::FIX42::Tags::OrigClOrdID), order->_origClOrderId);
+    
+    ASSERT_TRUE(t.translateMod(ref, rej));
+    ASSERT_TRUE(checkEncoded(t, t.getMsgMod(), t.getRawMod(), 6));
+    
+    // Cxl
+    //
+    ASSERT_TRUE(t.encodeCxl(order, 7, rej));
+    ASSERT_TRUE(checkEncoded(t, t.getMsgCxl(), t.getRawCxl(), 7));
+    
+    ref.reset(new tw::channel_or::Order(*order));
+    
+    ASSERT_TRUE(t.encodeCxl(order, 8, rej));
+    ASSERT_EQ(getRawField(t.getRawCxl(), tw::channel_or_cme::CustomTags::CorrelationClOrdID), order->_corrClOrderId);
+    
+    ASSERT_TRUE(t.translateCxl(ref, rej));
+    ASSERT_TRUE(checkEncoded(t, t.getMsgCxl(), t.getRawCxl(), 8));
+    
+    // Market orders are rejected on both paths
+    //
+    order = OrderHelper::getBuyMarket(2);
+    ASSERT_TRUE(!t.encodeNew(order, 9, rej));
+    ASSERT_EQ(rej._rejReason, tw::channel_or::eRejectReason::kType);
+    
+    tw::channel_or_cme::ChannelOrOnix::global_shutdown();
+}
@@ -169,3 +169,69 @@ TEST(ChannelOrLibTestSuit, channelOrStorageFile)
     ASSERT_TRUE(!storage.exists());
     
 }
+
+TEST(ChannelOrLibTestSuit, channelOrStorageEvent)
+{
+    TOrder order1;
+    TOrder order2;
+    TOrderPtr order2_copy = tw::channel_or::ProcessorOrders::instance().createOrder(false);
+    
+    TReject rej;
+    
+    TFill fill1;
+    TFill fill2;
+    TPosUpdate pos;
+    
+    OrderHelper::getOrder(order1);
+    OrderHelper::getOrder(order2);
+    OrderHelper::getRej(rej);
+    OrderHelper::getFill(fill1, pos);
+    OrderHelper::getFill(fill2, pos);
+    
+    *order2_copy = order2;
+    fill2._order = order2_copy;
+    
+    // Items rebuilt from events (reusing the same slot) are the same as
+    // items set directly, so are the rows persisted from them
+    //
+    tw::channel_or::ChannelOrStorageEvent event;
+    TStorageItem expected;
+    TStorageItem item;
+    
+    event.set(fill2);
+    item.clear();
+    event.get(item);
+    expected.clear();
+    expected.set(fill2);
+    ASSERT_EQ(item.toString(), expected.toString());
+    ASSERT_TRUE(item._fill._order == order2_copy);
+    
+    event.release();
+    ASSERT_TRUE(event._fill._order == NULL);
+    
+    event.set(order1);
+    item.clear();
+    event.get(item);
+    expected.clear();
+    expected.set(order1);
+    ASSERT_EQ(item.toString(), expected.toString());
+    ASSERT_EQ(item._rej.toString(), expected._rej.toString());
+    ASSERT_TRUE(item._fill._order == NULL);
+    
+    event.release();
+    event.set(order2, rej);
+    item.clear();
+    event.get(item);
+    expected.clear();
+    expected.set(order2, rej);
+    ASSERT_EQ(item.toString(), expected.toString());
+    
+    event.release();
+    event.set(fill1);
+    item.clear();
+    event.get(item);
+    expected.clear();
+    expected.set(fill1);
+    ASSERT_EQ(item.toString(), expected.toString());
+    ASSERT_EQ(item._order.toString(), expected._order.toString());
+}
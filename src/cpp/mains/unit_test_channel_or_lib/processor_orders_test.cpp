@@ -1,3 +1,4 @@
+#include <tw/channel_or/processor.h>
 #include <tw/channel_or/processor_orders.h>
 #include <tw/common_strat/consumer_proxy.h>
 #include <tw/common_thread/utils.h>
@@ -6,6 +7,8 @@
 
 #include <gtest/gtest.h>
 
+#include <stdexcept>
+
 typedef tw::channel_or::TOrderPtr TOrderPtr;
 typedef tw::channel_or::Reject Reject;
 typedef tw::channel_or::Fill Fill;
@@ -112,6 +115,10 @@ TEST(ChannelOrLibTestSuit, processor_orders)
     p.onNewRej(o2, rej);
     ASSERT_EQ(o2->_state, tw::channel_or::eOrderState::kRejected); 
     ASSERT_EQ(p.getAll().size(), 1U);
+    ASSERT_EQ(p.getAllForAccountStrategy(2, 3).size(), 0U);
+    ASSERT_EQ(p.getAllForAccountStrategyInstr(2, 3, 5).size(), 0U);
+    ASSERT_EQ(p.getAllForAccount(1).size(), 1U);
+    ASSERT_EQ(p.getAllForInstrument(5).size(), 1U);
     ASSERT_EQ(o2->_modCounter, 0U);
     ASSERT_EQ(o2->_action, tw::common::eCommandSubType::kOrNewRej);
     
@@ -1113,6 +1120,67 @@ TEST(ChannelOrLibTestSuit, processor_orders_stuck_orders_w_timeouts)
 }
 
 
+TEST(ChannelOrLibTestSuit, processor_orders_stuck_orders_deadline_on_send)
+{
+    // Callback client to track alerts
+    //
+    CallbackClient c;
+    tw::common_strat::ConsumerProxy::instance().registerCallbackAlert(&c);
+    
+    TOrderPtr o1;
+    Reject rej;
+    
+    TProcessor& p = TProcessor::instance();
+    p.clear();
+    
+    tw::common::Settings settings;
+    settings._strategy_container_stuck_orders_timeout = 500; // 500 ms
+    
+    ASSERT_TRUE(p.init(settings));
+    ASSERT_TRUE(p.start());
+    
+    // Order's _timestamp1 isn't set yet when processors are called (as in
+    // StrategyContainer) - order isn't stuck until timeout since send
+    //
+    o1 = p.createOrder();
+    ASSERT_TRUE(o1.get() != NULL);
+    
+    o1->_qty.set(5);
+    o1->_price.set(10);
+    o1->_accountId = 1;
+    o1->_strategyId = 2;
+    o1->_instrumentId = 5;
+    
+    ASSERT_TRUE(p.sendNew(o1, rej));
+    ASSERT_EQ(p.getAll().size(), 1U);
+    
+    p.onTimeout(1);
+    ASSERT_TRUE(c._alerts.empty());
+    
+    tw::common_thread::sleep(100);
+    
+    p.onTimeout(1);
+    ASSERT_TRUE(c._alerts.empty());
+    
+    // Stuck after timeout
+    //
+    tw::common_thread::sleep(600);
+    
+    p.onTimeout(1);
+    ASSERT_EQ(c._alerts.size(), 1U);
+    ASSERT_EQ(c._alerts.front()._type, tw::channel_or::eAlertType::kStuckOrders);
+    ASSERT_EQ(c._alerts.front()._strategyId, o1->_strategyId);
+    ASSERT_EQ(c._alerts.front()._text, o1->_orderId.toString());
+    
+    c._alerts.clear();
+    p.onNewAck(o1);
+    
+    p.onTimeout(1);
+    ASSERT_TRUE(c._alerts.empty());
+    
+    p.stop();
+}
+
 TEST(ChannelOrLibTestSuit, processor_orders_mod_rej_and_mod_rej_counters)
 {
     // Structs for passing to processor
@@ -1414,3 +1482,69 @@ TEST(ChannelOrLibTestSuit, processor_orders_isOrderLive)
     ASSERT_TRUE(!p.isOrderLive(o1));
     
 }
+
+// Stage after ProcessorOrders which throws on orders of a given qty (e.g.
+// failed send to exchange)
+//
+class ThrowingProcessor : public tw::channel_or::ProcessorOutNull {
+public:
+    ThrowingProcessor(int32_t qty) : _qty(qty) {
+    }
+    
+    bool sendNew(const TOrderPtr& order, Reject& rej) {
+        if ( _qty == order->_qty.get() )
+            throw std::runtime_error("send failed");
+        
+        return true;
+    }
+    
+    void onNewRej(const TOrderPtr& order, const Reject& rej) {
+    }
+    
+private:
+    int32_t _qty;
+};
+
+TEST(ChannelOrLibTestSuit, processor_orders_batch_rollback_on_exception)
+{
+    typedef tw::channel_or::ProcessorOut<ThrowingProcessor> TProcessorOutThrowing;
+    typedef tw::channel_or::ProcessorOut<TProcessor, TProcessorOutThrowing> TProcessorOutOrders;
+    
+    TProcessor& p = TProcessor::instance();
+    p.clear();
+    ASSERT_TRUE(p.start());
+    
+    ThrowingProcessor throwing(3);
+    TProcessorOutThrowing outThrowing(throwing);
+    TProcessorOutOrders out(p, outThrowing);
+    
+    tw::channel_or::OrdersBatch batch;
+    for ( int32_t qty = 2; qty < 5; ++qty ) {
+        TOrderPtr order = p.createOrder();
+        order->_qty.set(qty);
+        order->_price.set(10);
+        order->_accountId = 1;
+        order->_strategyId = 2;
+        order->_instrumentId = 5;
+        batch.add(order);
+    }
+    
+    // Order which throws after ProcessorOrders accepted it is rolled back
+    // and isn't tracked any more - the rest are sent
+    //
+    out.sendNew(batch);
+    ASSERT_FALSE(batch._rejected[0]);
+    ASSERT_TRUE(batch._rejected[1]);
+    ASSERT_EQ(batch._rejs[1]._rejReason, tw::channel_or::eRejectReason::kSystemError);
+    ASSERT_EQ(batch._rejs[1]._text, "Exception: send failed");
+    ASSERT_FALSE(batch._rejected[2]);
+    
+    ASSERT_EQ(batch._orders[1]->_state, tw::channel_or::eOrderState::kRejected);
+    ASSERT_TRUE(p.get(batch._orders[1]->_orderId).get() == NULL);
+    ASSERT_TRUE(p.get(batch._orders[0]->_orderId).get() != NULL);
+    ASSERT_TRUE(p.get(batch._orders[2]->_orderId).get() != NULL);
+    ASSERT_EQ(p.getAll().size(), 2U);
+    ASSERT_EQ(p.getAllForInstrument(5).size(), 2U);
+    
+    p.clear();
+}
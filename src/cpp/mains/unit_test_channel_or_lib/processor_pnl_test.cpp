@@ -2230,3 +2230,151 @@ TEST(ChannelOrLibTestSuit, processor_pnl_realizedPnLBug_strat)
     ASSERT_DOUBLE_EQ(stratPnL1.getMaxRealizedPnL(), 0.0);
     ASSERT_DOUBLE_EQ(stratPnL1.getRealizedDrawdown(), 157.5);
 }
+
+TEST(ChannelOrLibTestSuit, processor_pnl_instrumentsIndex)
+{
+    tw::risk::Account accountParams;
+    
+    accountParams._id = 1;
+    accountParams._name = "acc1";
+    accountParams._maxRealizedLoss = 10000.0;
+    accountParams._maxUnrealizedLoss = 10000.0;
+    accountParams._maxTotalLoss = 10000.0;
+    accountParams._maxRealizedDrawdown = 10000.0;
+    accountParams._maxUnrealizedDrawdown = 10000.0;
+    
+    tw::risk::Strategy stratParams1;
+    
+    stratParams1._id = 11;
+    stratParams1._name = "acc1_strat1";
+    stratParams1._maxRealizedLoss = 10000.0;
+    stratParams1._maxUnrealizedLoss = 10000.0;
+    stratParams1._maxRealizedDrawdown = 10000.0;
+    stratParams1._maxUnrealizedDrawdown = 10000.0;
+    stratParams1._tradeEnabled = true;
+    
+    tw::risk::Strategy stratParams2 = stratParams1;
+    stratParams2._id = 12;
+    stratParams2._name = "acc1_strat2";
+    
+    std::vector<tw::risk::Strategy> stratsParams;
+    stratsParams.push_back(stratParams1);
+    stratsParams.push_back(stratParams2);
+    
+    TProcessorPnL& p_pnl = TProcessorPnL::instance();
+    p_pnl.clear();
+    
+    tw::instr::InstrumentPtr instrNQM2 = InstrHelper::getNQM2();
+    tw::instr::InstrumentPtr instrZNM2 = InstrHelper::getZNM2();
+    
+    tw::common_trade::WboManager::TTv& tv1 = tw::common_trade::WboManager::instance().getOrCreateTv(instrNQM2->_keyId);
+    tw::common_trade::WboManager::TTv& tv2 = tw::common_trade::WboManager::instance().getOrCreateTv(instrZNM2->_keyId);
+    
+    ASSERT_TRUE(p_pnl.init(accountParams, stratsParams));
+    
+    // Strat1 NQM2: 5, strat2 NQM2: -3, strat2 ZNM2: -10
+    //
+    PosUpdate posUpdate;
+    posUpdate._accountId = accountParams._id;
+    posUpdate._strategyId = stratParams1._id;
+    posUpdate._exchange = instrNQM2->_exchange;
+    posUpdate._displayName = instrNQM2->_displayName;
+    posUpdate._pos = 5;
+    posUpdate._avgPrice = 274175;
+    p_pnl.rebuildPos(posUpdate);
+    
+    posUpdate._strategyId = stratParams2._id;
+    posUpdate._pos = -3;
+    p_pnl.rebuildPos(posUpdate);
+    
+    posUpdate._exchange = instrZNM2->_exchange;
+    posUpdate._displayName = instrZNM2->_displayName;
+    posUpdate._pos = -10;
+    posUpdate._avgPrice = 130.984375;
+    p_pnl.rebuildPos(posUpdate);
+    
+    tw::channel_or::StratPnL* stratPnL1 = p_pnl.getStratsPnL(stratParams1._id);
+    tw::channel_or::StratPnL* stratPnL2 = p_pnl.getStratsPnL(stratParams2._id);
+    ASSERT_TRUE(stratPnL1 != NULL);
+    ASSERT_TRUE(stratPnL2 != NULL);
+    
+    tw::channel_or::TPnL* s1_nq = stratPnL1->getInstrumentPnL(instrNQM2->_keyId);
+    tw::channel_or::TPnL* s2_nq = stratPnL2->getInstrumentPnL(instrNQM2->_keyId);
+    tw::channel_or::TPnL* s2_zn = stratPnL2->getInstrumentPnL(instrZNM2->_keyId);
+    ASSERT_TRUE(s1_nq != NULL);
+    ASSERT_TRUE(s2_nq != NULL);
+    ASSERT_TRUE(s2_zn != NULL);
+    
+    // Longs/shorts aggregates
+    //
+    tw::channel_or::TLongsShorts ls;
+    
+    ls = stratPnL1->getLongsShorts();
+    ASSERT_EQ(ls.first, 5);
+    ASSERT_EQ(ls.second, 0);
+    
+    ls = stratPnL2->getLongsShorts();
+    ASSERT_EQ(ls.first, 0);
+    ASSERT_EQ(ls.second, -13);
+    
+    ls = p_pnl.getAccountLongsShorts();
+    ASSERT_EQ(ls.first, 5);
+    ASSERT_EQ(ls.second, -13);
+    
+    // Tv update of NQM2 fans out to both strategies, but not to ZNM2
+    //
+    tv1.setTv(instrNQM2->_tc->toExchangePrice(instrNQM2->_tc->fromExchangePrice(274175)-4));
+    tv2.setTv(130.984375);
+    double s2_zn_unrealized = s2_zn->getUnrealizedPnL();
+    
+    p_pnl.updatePnLForTvForStratInstrument(instrNQM2->_keyId);
+    
+    ASSERT_TRUE(s1_nq->getUnrealizedPnL() < 0.0);
+    ASSERT_TRUE(s2_nq->getUnrealizedPnL() > 0.0);
+    ASSERT_DOUBLE_EQ(s2_zn->getUnrealizedPnL(), s2_zn_unrealized);
+    
+    ASSERT_DOUBLE_EQ(stratPnL1->getUnrealizedPnL(), s1_nq->getUnrealizedPnL());
+    ASSERT_DOUBLE_EQ(stratPnL2->getUnrealizedPnL(), s2_nq->getUnrealizedPnL()+s2_zn->getUnrealizedPnL());
+    ASSERT_DOUBLE_EQ(p_pnl.getAccountPnL().getUnrealizedPnL(), stratPnL1->getUnrealizedPnL()+stratPnL2->getUnrealizedPnL());
+    
+    // Unknown instrument is a no-op
+    //
+    p_pnl.updatePnLForTvForStratInstrument(instrNQM2->_keyId+1000);
+    ASSERT_DOUBLE_EQ(stratPnL1->getUnrealizedPnL(), s1_nq->getUnrealizedPnL());
+    
+    // Flip strat1 from long 5 to short 1
+    //
+    Fill fill;
+    fill._type = tw::channel_or::eFillType::kNormal;
+    fill._subType = tw::channel_or::eFillSubType::kOutright;
+    fill._accountId = accountParams._id;
+    fill._strategyId = stratParams1._id;
+    fill._instrumentId = instrNQM2->_keyId;
+    fill._liqInd = tw::channel_or::eLiqInd::kRem;
+    fill._side = tw::channel_or::eOrderSide::kSell;
+    fill._qty.set(6);
+    fill._price = instrNQM2->_tc->fromExchangePrice(274175)+2;
+    
+    p_pnl.onFill(fill);
+    ASSERT_EQ(fill._posStrategy, -1);
+    
+    ls = stratPnL1->getLongsShorts();
+    ASSERT_EQ(ls.first, 0);
+    ASSERT_EQ(ls.second, -1);
+    
+    ls = p_pnl.getAccountLongsShorts();
+    ASSERT_EQ(ls.first, 0);
+    ASSERT_EQ(ls.second, -14);
+    
+    ASSERT_DOUBLE_EQ(stratPnL1->getRealizedPnL(), s1_nq->getRealizedPnL());
+    ASSERT_DOUBLE_EQ(stratPnL2->getRealizedPnL(), s2_nq->getRealizedPnL()+s2_zn->getRealizedPnL());
+    ASSERT_DOUBLE_EQ(p_pnl.getAccountPnL().getRealizedPnL(), stratPnL1->getRealizedPnL()+stratPnL2->getRealizedPnL());
+    
+    // Index is dropped on clear()
+    //
+    p_pnl.clear();
+    p_pnl.updatePnLForTvForStratInstrument(instrNQM2->_keyId);
+    ls = p_pnl.getAccountLongsShorts();
+    ASSERT_EQ(ls.first, 0);
+    ASSERT_EQ(ls.second, 0);
+}
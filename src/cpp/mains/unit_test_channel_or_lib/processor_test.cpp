@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <stdexcept>
+
 typedef tw::channel_or::TOrderPtr TOrderPtr;
 typedef tw::channel_or::Reject Reject;
 typedef tw::channel_or::Fill Fill;
@@ -527,3 +529,233 @@ TEST(ChannelOrLibTestSuit, processor_base)
     EXPECT_TRUE(checkCounters(impl2._callCounter, 18));
     
 }
+
+TEST(ChannelOrLibTestSuit, processor_batch)
+{
+    tw::channel_or::OrdersBatch batch;
+    
+    TProcessor1 impl1;
+    TProcessor2 impl2;
+    
+    TProcessorOut2 out2(impl2);
+    TProcessorOut1 out1(impl1, out2);
+    
+    for ( uint32_t i = 0; i < 3; ++i )
+        batch.add(TOrderPtr());
+    
+    // All orders sent
+    //
+    out1.sendNew(batch);
+    EXPECT_EQ(impl1._callCounter._counterSendNew, 3U);
+    EXPECT_EQ(impl2._callCounter._counterSendNew, 3U);
+    EXPECT_EQ(impl1._callCounter._counterOnNewRej, 0U);
+    for ( size_t i = 0; i < batch.size(); ++i )
+        EXPECT_FALSE(batch._rejected[i]);
+    
+    // Orders rejected by last processor are rolled back by first one
+    //
+    batch.clear();
+    for ( uint32_t i = 0; i < 3; ++i )
+        batch.add(TOrderPtr());
+    
+    impl1.clear();
+    impl2.clear();
+    impl2._return = false;
+    
+    out1.sendNew(batch);
+    EXPECT_EQ(impl1._callCounter._counterSendNew, 3U);
+    EXPECT_EQ(impl2._callCounter._counterSendNew, 3U);
+    EXPECT_EQ(impl1._callCounter._counterOnNewRej, 3U);
+    EXPECT_EQ(impl2._callCounter._counterOnNewRej, 0U);
+    for ( size_t i = 0; i < batch.size(); ++i )
+        EXPECT_TRUE(batch._rejected[i]);
+    
+    // Orders rejected by first processor never reach last one
+    //
+    batch.clear();
+    for ( uint32_t i = 0; i < 3; ++i )
+        batch.add(TOrderPtr());
+    
+    impl1.clear();
+    impl2.clear();
+    impl1._return = false;
+    
+    out1.sendNew(batch);
+    EXPECT_EQ(impl1._callCounter._counterSendNew, 3U);
+    EXPECT_EQ(impl2._callCounter._counterSendNew, 0U);
+    EXPECT_EQ(impl1._callCounter._counterOnNewRej, 0U);
+    for ( size_t i = 0; i < batch.size(); ++i )
+        EXPECT_TRUE(batch._rejected[i]);
+    
+    // Batched modifies/cancels are rolled back with onModRej()/onCxlRej()
+    //
+    batch.clear();
+    for ( uint32_t i = 0; i < 2; ++i )
+        batch.add(TOrderPtr());
+    
+    impl1.clear();
+    impl2.clear();
+    impl2._return = false;
+    
+    out1.sendMod(batch);
+    EXPECT_EQ(impl1._callCounter._counterSendMod, 2U);
+    EXPECT_EQ(impl2._callCounter._counterSendMod, 2U);
+    EXPECT_EQ(impl1._callCounter._counterOnModRej, 2U);
+    
+    batch.clear();
+    for ( uint32_t i = 0; i < 2; ++i )
+        batch.add(TOrderPtr());
+    
+    impl1.clear();
+    impl2.clear();
+    
+    out1.sendCxl(batch);
+    EXPECT_EQ(impl1._callCounter._counterSendCxl, 2U);
+    EXPECT_EQ(impl2._callCounter._counterSendCxl, 2U);
+    EXPECT_EQ(impl1._callCounter._counterOnCxlRej, 0U);
+    EXPECT_FALSE(batch._rejected[0]);
+    EXPECT_FALSE(batch._rejected[1]);
+}
+
+// Stages modelled after ProcessorOrders/ProcessorRisk: first one adds
+// order's qty to open qty (and removes it on reject), second one rejects
+// orders which would take open qty over max
+//
+struct testOpenQty {
+    testOpenQty() : _openQty(0) {
+    }
+    
+    int32_t _openQty;
+};
+
+class testProcessorOrders : public tw::channel_or::ProcessorOutNull {
+public:
+    testProcessorOrders(testOpenQty& open) : _open(open) {
+    }
+    
+    bool sendNew(const TOrderPtr& order, Reject& rej) {
+        _open._openQty += order->_qty.get();
+        return true;
+    }
+    
+    void onNewRej(const TOrderPtr& order, const Reject& rej) {
+        _open._openQty -= order->_qty.get();
+    }
+    
+private:
+    testOpenQty& _open;
+};
+
+class testProcessorRisk : public tw::channel_or::ProcessorOutNull {
+public:
+    testProcessorRisk(const testOpenQty& open, int32_t maxQty) : _open(open),
+                                                                 _maxQty(maxQty) {
+    }
+    
+    bool sendNew(const TOrderPtr& order, Reject& rej) {
+        if ( order->_qty.get() < 0 )
+            throw std::runtime_error("invalid qty");
+        
+        if ( _open._openQty > _maxQty ) {
+            rej._text = "max qty";
+            return false;
+        }
+        
+        return true;
+    }
+    
+    void onNewRej(const TOrderPtr& order, const Reject& rej) {
+    }
+    
+private:
+    const testOpenQty& _open;
+    int32_t _maxQty;
+};
+
+typedef tw::channel_or::ProcessorOut<testProcessorRisk> TProcessorOutRisk;
+typedef tw::channel_or::ProcessorOut<testProcessorOrders, TProcessorOutRisk> TProcessorOutOrders;
+
+static TOrderPtr getOrder(int32_t qty) {
+    TOrderPtr order(new tw::channel_or::Order());
+    order->_qty.set(qty);
+    return order;
+}
+
+TEST(ChannelOrLibTestSuit, processor_batch_risk_limit)
+{
+    // Two 6 lots with max of 10 - first one is accepted, second rejected,
+    // same as with single order calls
+    //
+    {
+        testOpenQty open;
+        testProcessorOrders orders(open);
+        testProcessorRisk risk(open, 10);
+        TProcessorOutRisk outRisk(risk);
+        TProcessorOutOrders out(orders, outRisk);
+        
+        Reject rej;
+        EXPECT_TRUE(out.sendNew(getOrder(6), rej));
+        EXPECT_FALSE(out.sendNew(getOrder(6), rej));
+        EXPECT_EQ(open._openQty, 6);
+    }
+    
+    testOpenQty open;
+    testProcessorOrders orders(open);
+    testProcessorRisk risk(open, 10);
+    TProcessorOutRisk outRisk(risk);
+    TProcessorOutOrders out(orders, outRisk);
+    
+    tw::channel_or::OrdersBatch batch;
+    batch.add(getOrder(6));
+    batch.add(getOrder(6));
+    batch.add(getOrder(4));
+    
+    out.sendNew(batch);
+    EXPECT_FALSE(batch._rejected[0]);
+    EXPECT_TRUE(batch._rejected[1]);
+    EXPECT_EQ(batch._rejs[1]._text, "max qty");
+    EXPECT_FALSE(batch._rejected[2]);
+    EXPECT_EQ(open._openQty, 10);
+    
+    // Order which throws is rejected and rolled back by stage which
+    // accepted it, rest of the batch is sent
+    //
+    batch.clear();
+    batch.add(getOrder(-1));
+    batch.add(getOrder(0));
+    
+    out.sendNew(batch);
+    EXPECT_TRUE(batch._rejected[0]);
+    EXPECT_EQ(batch._rejs[0]._text, "Exception: invalid qty");
+    EXPECT_FALSE(batch._rejected[1]);
+    EXPECT_EQ(open._openQty, 10);
+}
+
+TEST(ChannelOrLibTestSuit, processor_stage)
+{
+    typedef tw::channel_or::ProcessorOutStage<false, TProcessor1, TProcessorOut2> TStageDisabled;
+    typedef tw::channel_or::ProcessorOutStage<true, TProcessor1, TProcessorOut2> TStageEnabled;
+    
+    TOrderPtr order;
+    Reject rej;
+    
+    TProcessor1 impl1;
+    TProcessor2 impl2;
+    
+    TProcessorOut2 out2(impl2);
+    
+    // Disabled stage is compiled out of the chain
+    //
+    TStageDisabled::TType disabled = TStageDisabled::create(impl1, out2, "disabled");
+    EXPECT_TRUE(disabled.sendNew(order, rej));
+    EXPECT_TRUE(checkCounters(impl1._callCounter));
+    EXPECT_TRUE(checkCounters(impl2._callCounter, 3));
+    
+    impl1.clear();
+    impl2.clear();
+    
+    TStageEnabled::TType enabled = TStageEnabled::create(impl1, out2, "enabled");
+    EXPECT_TRUE(enabled.sendNew(order, rej));
+    EXPECT_TRUE(checkCounters(impl1._callCounter, 3));
+    EXPECT_TRUE(checkCounters(impl2._callCounter, 3));
+}
@@ -562,4 +562,80 @@ TEST(ChannelOrLibTestSuit, processor_wtp_w_quotes)
     
     
     p.stop();
-}
\ No newline at end of file
+}
+
+TEST(ChannelOrLibTestSuit, processor_wtp_orders_ladder)
+{
+    TProcessorWTP::TBids bids;
+    
+    tw::instr::InstrumentPtr instrNQM2 = InstrHelper::getNQM2();
+    
+    TOrderPtr b1 = OrderHelper::getBuyLimit(tw::price::Ticks(1078), 1, instrNQM2);
+    TOrderPtr b2 = OrderHelper::getBuyLimit(tw::price::Ticks(1089), 1, instrNQM2);
+    TOrderPtr b3 = OrderHelper::getBuyLimit(tw::price::Ticks(1067), 1, instrNQM2);
+    TOrderPtr b4 = OrderHelper::getBuyLimit(tw::price::Ticks(1089), 1, instrNQM2);
+    
+    b1->_state = b2->_state = b3->_state = b4->_state = tw::channel_or::eOrderState::kWorking;
+    
+    ASSERT_TRUE(bids.getBest() == NULL);
+    
+    bids.add(b1);
+    bids.add(b2);
+    bids.add(b3);
+    bids.add(b4);
+    ASSERT_EQ(bids.size(), 4U);
+    ASSERT_EQ(b2->_wtpPrice, tw::price::Ticks(1089));
+    
+    // Best level is in time priority
+    //
+    ASSERT_EQ(bids.getBest(), b2);
+    
+    bids.rem(b2);
+    ASSERT_EQ(bids.size(), 3U);
+    ASSERT_TRUE(!b2->_wtpPrice.isValid());
+    ASSERT_EQ(bids.getBest(), b4);
+    
+    // Not live orders are removed when they reach best level
+    //
+    b4->_state = tw::channel_or::eOrderState::kCancelled;
+    ASSERT_EQ(bids.getBest(), b1);
+    ASSERT_EQ(bids.size(), 2U);
+    
+    // Order being modified is indexed at more aggressive price
+    //
+    b3->_newPrice = tw::price::Ticks(1080);
+    bids.add(b3);
+    b3->_state = tw::channel_or::eOrderState::kModifying;
+    ASSERT_EQ(bids.size(), 2U);
+    ASSERT_EQ(bids.getBest(), b3);
+    ASSERT_EQ(b3->_wtpPrice, tw::price::Ticks(1080));
+    
+    b1->_newPrice = tw::price::Ticks(1070);
+    bids.add(b1);
+    b1->_state = tw::channel_or::eOrderState::kModifying;
+    ASSERT_EQ(b1->_wtpPrice, tw::price::Ticks(1078));
+    
+    // Rejected modification - order is re-indexed at its working price
+    //
+    b3->_newPrice.clear();
+    b3->_state = tw::channel_or::eOrderState::kWorking;
+    ASSERT_EQ(bids.getBest(), b1);
+    ASSERT_EQ(b3->_wtpPrice, tw::price::Ticks(1067));
+    ASSERT_EQ(bids.size(), 2U);
+    
+    // Acked modification - order is re-indexed at its new price
+    //
+    b1->_price = b1->_newPrice;
+    b1->_newPrice.clear();
+    b1->_state = tw::channel_or::eOrderState::kWorking;
+    ASSERT_EQ(bids.getBest(), b1);
+    ASSERT_EQ(b1->_wtpPrice, tw::price::Ticks(1070));
+    ASSERT_EQ(bids.size(), 2U);
+    
+    b1->_state = tw::channel_or::eOrderState::kFilled;
+    ASSERT_EQ(bids.getBest(), b3);
+    
+    b3->_state = tw::channel_or::eOrderState::kRejected;
+    ASSERT_TRUE(bids.getBest() == NULL);
+    ASSERT_TRUE(bids.empty());
+}
@@ -0,0 +1,113 @@
+#include <tw/channel_or/risk_slot.h>
+
+#include <gtest/gtest.h>
+
+TEST(ChannelOrLibTestSuit, riskSlots)
+{
+    tw::channel_or::RiskSlots slots;
+    tw::channel_or::RiskSlots::TRiskSlotPtrs v;
+
+    // Test getOrCreate/find
+    //
+    ASSERT_EQ(slots.size(), 0UL);
+    ASSERT_TRUE(slots.find(1, 6) == NULL);
+
+    tw::channel_or::RiskSlot& s1 = slots.getOrCreate(1, 6);
+    ASSERT_EQ(slots.size(), 1UL);
+    ASSERT_EQ(s1._accountId, 1UL);
+    ASSERT_EQ(s1._instrumentId, 6UL);
+    ASSERT_EQ(s1._openOrdersPos._accountId, 1UL);
+    ASSERT_EQ(s1._openOrdersPos._instrumentId, 6UL);
+    ASSERT_TRUE(!s1._isRiskParamsSet);
+    ASSERT_TRUE(!s1._isOpenOrdersPosSet);
+
+    ASSERT_EQ(&slots.getOrCreate(1, 6), &s1);
+    ASSERT_EQ(slots.find(1, 6), &s1);
+    ASSERT_EQ(slots.size(), 1UL);
+
+    // Different account/instrument pairs get different slots,
+    // previously returned references stay valid
+    //
+    tw::channel_or::RiskSlot& s2 = slots.getOrCreate(1, 7);
+    tw::channel_or::RiskSlot& s3 = slots.getOrCreate(2, 6);
+    for ( uint32_t i = 100; i < 1100; ++i )
+        slots.getOrCreate(3, i);
+
+    ASSERT_EQ(slots.size(), 1003UL);
+    ASSERT_EQ(slots.find(1, 6), &s1);
+    ASSERT_EQ(slots.find(1, 7), &s2);
+    ASSERT_EQ(slots.find(2, 6), &s3);
+    ASSERT_TRUE(slots.find(2, 7) == NULL);
+
+    slots.getAllForAccount(1, v);
+    ASSERT_EQ(v.size(), 2UL);
+    ASSERT_EQ(v[0], &s1);
+    ASSERT_EQ(v[1], &s2);
+
+    slots.getAllForAccount(4, v);
+    ASSERT_EQ(v.size(), 0UL);
+
+    // Test risk params set/clear
+    //
+    tw::risk::AccountRiskParams params;
+    params._tradeEnabled = true;
+    params._clipSize = 5;
+    params._maxPos = 10;
+
+    s1.setRiskParams(params);
+    ASSERT_TRUE(s1._isRiskParamsSet);
+    ASSERT_TRUE(s1._tradeEnabled);
+    ASSERT_EQ(s1._clipSize, 5UL);
+    ASSERT_EQ(s1._maxPos, 10UL);
+
+    s1._isOpenOrdersPosSet = true;
+    s1._openOrdersPos._pos = 3;
+    s1._openOrdersPos._bids.set(4);
+    s1._openOrdersPos._asks.set(2);
+
+    slots.clearRiskParams();
+    ASSERT_TRUE(!s1._isRiskParamsSet);
+    ASSERT_TRUE(!s1._tradeEnabled);
+    ASSERT_EQ(s1._clipSize, 0UL);
+    ASSERT_EQ(s1._maxPos, 0UL);
+    ASSERT_TRUE(s1._isOpenOrdersPosSet);
+    ASSERT_EQ(s1._openOrdersPos._pos, 3);
+
+    // Test open orders/pos clear keeps slot's identity
+    //
+    s1.setRiskParams(params);
+    slots.clearOpenOrdersPos();
+    ASSERT_TRUE(s1._isRiskParamsSet);
+    ASSERT_TRUE(!s1._isOpenOrdersPosSet);
+    ASSERT_EQ(s1._openOrdersPos._pos, 0);
+    ASSERT_EQ(s1._openOrdersPos._bids.get(), 0);
+    ASSERT_EQ(s1._openOrdersPos._asks.get(), 0);
+    ASSERT_EQ(s1._openOrdersPos._accountId, 1UL);
+    ASSERT_EQ(s1._openOrdersPos._instrumentId, 6UL);
+    ASSERT_EQ(slots.find(1, 6), &s1);
+
+    // Test order's cached slot
+    //
+    tw::channel_or::TOrderPtr o1(new tw::channel_or::Order());
+    o1->_accountId = 1;
+    o1->_instrumentId = 7;
+    ASSERT_TRUE(o1->_riskSlot == NULL);
+
+    ASSERT_EQ(&slots.get(o1), &s2);
+    ASSERT_EQ(o1->_riskSlot, &s2);
+    ASSERT_EQ(&slots.get(o1), &s2);
+
+    // Cached slot is re-resolved if order's account/instrument changed
+    //
+    o1->_accountId = 2;
+    o1->_instrumentId = 6;
+    ASSERT_EQ(&slots.get(o1), &s3);
+    ASSERT_EQ(o1->_riskSlot, &s3);
+
+    o1->_instrumentId = 8;
+    tw::channel_or::RiskSlot& s4 = slots.get(o1);
+    ASSERT_EQ(s4._accountId, 2UL);
+    ASSERT_EQ(s4._instrumentId, 8UL);
+    ASSERT_EQ(o1->_riskSlot, &s4);
+    ASSERT_EQ(slots.size(), 1004UL);
+}
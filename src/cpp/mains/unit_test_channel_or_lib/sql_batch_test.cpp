@@ -0,0 +1,158 @@
+#include <tw/channel_db/sql_batch.h>
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+typedef tw::channel_db::SqlBatch TSqlBatch;
+
+TEST(ChannelOrLibTestSuit, sqlBatch_modes)
+{
+    TSqlBatch::eMode mode = TSqlBatch::kText;
+
+    ASSERT_TRUE(TSqlBatch::parseMode("prepared", mode));
+    ASSERT_EQ(mode, TSqlBatch::kPrepared);
+
+    ASSERT_TRUE(TSqlBatch::parseMode("BULK", mode));
+    ASSERT_EQ(mode, TSqlBatch::kBulkLoad);
+
+    ASSERT_TRUE(TSqlBatch::parseMode("text", mode));
+    ASSERT_EQ(mode, TSqlBatch::kText);
+
+    ASSERT_FALSE(TSqlBatch::parseMode("batch", mode));
+    ASSERT_EQ(mode, TSqlBatch::kText);
+
+    ASSERT_EQ(std::string("bulk"), TSqlBatch::modeToString(TSqlBatch::kBulkLoad));
+}
+
+TEST(ChannelOrLibTestSuit, sqlBatch_toString)
+{
+    TSqlBatch batch("REPLACE", "Positions", "`accountId`, `pos`, `avgPrice`", "ON DUPLICATE KEY UPDATE pos=pos+VALUES(pos)");
+    ASSERT_EQ(batch.rows(), 0UL);
+
+    batch.beginRow();
+    batch.bind(std::string("100"));
+    batch.bind(std::string("2"));
+    batch.bind(1.5);
+
+    batch.beginRow();
+    batch.bind(std::string("1'01"));
+    batch.bind(std::string("-1"));
+    batch.bind(2.25);
+
+    ASSERT_EQ(batch.rows(), 2UL);
+    ASSERT_EQ(batch.toString(), "REPLACE INTO Positions (`accountId`, `pos`, `avgPrice`) VALUES ('100','2','1.5'),('1\\'01','-1','2.25') ON DUPLICATE KEY UPDATE pos=pos+VALUES(pos)");
+
+    batch.clear();
+    ASSERT_EQ(batch.rows(), 0UL);
+
+    batch.beginRow();
+    batch.bind(std::string("100"));
+    batch.bind(std::string("3"));
+    batch.bind(0.0);
+    ASSERT_EQ(batch.toString(), "REPLACE INTO Positions (`accountId`, `pos`, `avgPrice`) VALUES ('100','3','0') ON DUPLICATE KEY UPDATE pos=pos+VALUES(pos)");
+}
+
+TEST(ChannelOrLibTestSuit, sqlBatch_preparedStatementsRows)
+{
+    TSqlBatch::TStatementsRows statementsRows;
+
+    TSqlBatch::getStatementsRows(0, 10, statementsRows);
+    ASSERT_TRUE(statementsRows.empty());
+
+    // Typical flush is below kMaxRowsPerStatement - it's written with
+    // statements of power of 2 rows
+    //
+    TSqlBatch::getStatementsRows(100, 10, statementsRows);
+    ASSERT_EQ(statementsRows.size(), 3UL);
+    ASSERT_EQ(statementsRows[0], 64UL);
+    ASSERT_EQ(statementsRows[1], 32UL);
+    ASSERT_EQ(statementsRows[2], 4UL);
+
+    TSqlBatch::getStatementsRows(TSqlBatch::kMaxRowsPerStatement, 10, statementsRows);
+    ASSERT_EQ(statementsRows.size(), 1UL);
+    ASSERT_EQ(statementsRows[0], 256UL);
+
+    TSqlBatch::getStatementsRows(600, 10, statementsRows);
+    ASSERT_EQ(statementsRows.size(), 5UL);
+    ASSERT_EQ(statementsRows[0], 256UL);
+    ASSERT_EQ(statementsRows[1], 256UL);
+    ASSERT_EQ(statementsRows[2], 64UL);
+    ASSERT_EQ(statementsRows[3], 16UL);
+    ASSERT_EQ(statementsRows[4], 8UL);
+
+    // Wide rows - statement's rows are limited by number of parameters
+    //
+    TSqlBatch::getStatementsRows(500, 300, statementsRows);
+    ASSERT_EQ(statementsRows.size(), 3UL);
+    ASSERT_EQ(statementsRows[0], 218UL);
+    ASSERT_EQ(statementsRows[1], 218UL);
+    ASSERT_EQ(statementsRows[2], 64UL);
+
+    TSqlBatch::getStatementsRows(3, TSqlBatch::kMaxParamsPerStatement+1, statementsRows);
+    ASSERT_EQ(statementsRows.size(), 3UL);
+    ASSERT_EQ(statementsRows[2], 1UL);
+
+    // Every number of rows is covered exactly and only a few statements'
+    // sizes are ever prepared
+    //
+    std::set<uint32_t> sizes;
+    for ( uint32_t rows = 1; rows <= 2000; ++rows ) {
+        TSqlBatch::getStatementsRows(rows, 10, statementsRows);
+
+        uint32_t total = 0;
+        for ( size_t i = 0; i < statementsRows.size(); ++i ) {
+            ASSERT_TRUE(statementsRows[i] > 0);
+            ASSERT_TRUE(statementsRows[i] <= TSqlBatch::kMaxRowsPerStatement);
+            total += statementsRows[i];
+            sizes.insert(statementsRows[i]);
+        }
+
+        ASSERT_EQ(total, rows);
+    }
+
+    ASSERT_EQ(sizes.size(), 9UL);
+}
+
+TEST(ChannelOrLibTestSuit, sqlBatch_bulkLoadOnlyReplace)
+{
+    TSqlBatch::eMode defaultMode = TSqlBatch::defaultMode();
+    uint32_t defaultBulkLoadMinRows = TSqlBatch::defaultBulkLoadMinRows();
+    TSqlBatch::setDefaults(TSqlBatch::kBulkLoad, 2);
+
+    // LOCAL load skips rows with duplicate keys with warnings, so INSERT
+    // queries (e.g. PnLAuditTrail) aren't bulk loaded to fail on them
+    //
+    TSqlBatch insertBatch("INSERT", "PnLAuditTrail", "`accountId`, `pnl`");
+    TSqlBatch replaceBatch("REPLACE", "Positions", "`accountId`, `pos`");
+    TSqlBatch updateBatch("REPLACE", "Positions", "`accountId`, `pos`", "ON DUPLICATE KEY UPDATE pos=pos+VALUES(pos)");
+    for ( uint32_t i = 0; i < 2; ++i ) {
+        insertBatch.beginRow();
+        insertBatch.bind(std::string("100"));
+        insertBatch.bind(1.5);
+
+        replaceBatch.beginRow();
+        replaceBatch.bind(std::string("100"));
+        replaceBatch.bind(1.5);
+
+        updateBatch.beginRow();
+        updateBatch.bind(std::string("100"));
+        updateBatch.bind(1.5);
+    }
+
+    ASSERT_FALSE(insertBatch.isBulkLoad());
+    ASSERT_TRUE(replaceBatch.isBulkLoad());
+    ASSERT_FALSE(updateBatch.isBulkLoad());
+
+    replaceBatch.setMode(TSqlBatch::kPrepared);
+    ASSERT_FALSE(replaceBatch.isBulkLoad());
+
+    replaceBatch.setMode(TSqlBatch::kBulkLoad);
+    replaceBatch.clear();
+    replaceBatch.beginRow();
+    replaceBatch.bind(std::string("100"));
+    replaceBatch.bind(1.5);
+    ASSERT_FALSE(replaceBatch.isBulkLoad());
+
+    TSqlBatch::setDefaults(defaultMode, defaultBulkLoadMinRows);
+}
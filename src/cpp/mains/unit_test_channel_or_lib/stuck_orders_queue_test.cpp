@@ -0,0 +1,71 @@
+#include <tw/channel_or/stuck_orders_queue.h>
+
+#include <gtest/gtest.h>
+
+TEST(ChannelOrLibTestSuit, stuckOrdersQueue)
+{
+    tw::channel_or::TOrderPtr o1(new tw::channel_or::Order());
+    tw::channel_or::TOrderPtr o2(new tw::channel_or::Order());
+    tw::channel_or::TOrderPtr o3(new tw::channel_or::Order());
+    tw::channel_or::TOrderPtr o4(new tw::channel_or::Order());
+
+    tw::channel_or::StuckOrdersQueue queue;
+    tw::channel_or::TOrders orders;
+
+    // Test add/rem
+    //
+    ASSERT_TRUE(queue.empty());
+
+    queue.add(o1, 300);
+    queue.add(o2, 100);
+    queue.add(o3, 200);
+    queue.add(o4, 200);
+    ASSERT_EQ(queue.size(), 4UL);
+    ASSERT_EQ(o1->_stuckDeadline, 300);
+    ASSERT_EQ(o2->_stuckDeadline, 100);
+
+    queue.rem(o4);
+    ASSERT_EQ(queue.size(), 3UL);
+
+    // Removing order which isn't in queue is no-op
+    //
+    queue.rem(o4);
+    ASSERT_EQ(queue.size(), 3UL);
+
+    // Re-adding order moves it to new deadline
+    //
+    queue.add(o1, 50);
+    ASSERT_EQ(queue.size(), 3UL);
+    ASSERT_EQ(o1->_stuckDeadline, 50);
+
+    // Test popExpired - only orders with deadline before 'now'
+    // are returned in deadline order
+    //
+    queue.popExpired(50, orders);
+    ASSERT_TRUE(orders.empty());
+    ASSERT_EQ(queue.size(), 3UL);
+
+    queue.popExpired(101, orders);
+    ASSERT_EQ(orders.size(), 2UL);
+    ASSERT_EQ(orders[0], o1);
+    ASSERT_EQ(orders[1], o2);
+    ASSERT_EQ(queue.size(), 1UL);
+
+    queue.popExpired(101, orders);
+    ASSERT_TRUE(orders.empty());
+
+    queue.popExpired(1000, orders);
+    ASSERT_EQ(orders.size(), 1UL);
+    ASSERT_EQ(orders[0], o3);
+    ASSERT_TRUE(queue.empty());
+
+    // Test clear
+    //
+    queue.add(o1, 10);
+    queue.add(o2, 20);
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+
+    queue.popExpired(1000, orders);
+    ASSERT_TRUE(orders.empty());
+}
@@ -0,0 +1,144 @@
+#include <tw/channel_pf_shm/channel_pf_shm.h>
+#include <tw/common_strat/consumer_proxy.h>
+#include <tw/common_thread/utils.h>
+
+#include <mains/unit_test_price_lib/instr_helper.h>
+#include <gtest/gtest.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <unistd.h>
+
+typedef tw::channel_pf_shm::ChannelPfShm TChannelPfShm;
+typedef tw::channel_pf_shm::TQuoteShmRing TQuoteShmRing;
+
+// Quotes are only processed for instruments with subscribers in QuoteStore
+//
+class ShmTestSubscriber {
+public:
+    void onQuote(const tw::price::Quote& quote) {
+    }
+};
+
+// Gets quotes from channel through ConsumerProxy
+//
+class ShmTestClient {
+public:
+    ShmTestClient() {
+        clear();
+    }
+
+    void clear() {
+        _instrumentId = tw::instr::Instrument::TKeyId();
+        _countOthers = 0;
+        _quote.clear();
+        _lastBid = 0;
+    }
+
+    void onQuote(const tw::price::QuoteStore::TQuote& quote) {
+        if ( quote._instrumentId != _instrumentId ) {
+            ++_countOthers;
+            return;
+        }
+
+        _quote = quote;
+        _lastBid = quote._book[0]._bid._price.get();
+    }
+
+    tw::instr::Instrument::TKeyId _instrumentId;
+    volatile uint32_t _countOthers;
+    tw::price::Quote _quote;
+    volatile int32_t _lastBid;
+};
+
+static ShmTestClient g_shmClient;
+
+static tw::channel_pf_shm::QuoteShm getQuoteShm(TInstrumentPtr instrument, int32_t bid, int32_t size) {
+    tw::price::Quote quote;
+    quote.clear();
+    quote._instrumentId = instrument->_keyId;
+    quote.setBid(tw::price::Ticks(bid), tw::price::Size(size), 0);
+
+    tw::channel_pf_shm::QuoteShm record;
+    record._timestamp = tw::common::THighResTime::now();
+    record._quoteWire = quote;
+    return record;
+}
+
+static bool waitForBid(int32_t bid) {
+    for ( uint32_t i = 0; i < 5000 && bid != g_shmClient._lastBid; ++i )
+        tw::common_thread::sleep(1);
+
+    return (bid == g_shmClient._lastBid);
+}
+
+// Reader attaches from writer's current position, so publisher keeps
+// publishing until channel is attached to its ring and gets the quote
+//
+static bool publishUntilReceived(TQuoteShmRing& ring, int32_t bid, TInstrumentPtr instrument) {
+    tw::channel_pf_shm::QuoteShm record = getQuoteShm(instrument, bid, 1);
+    for ( uint32_t i = 0; i < 5000 && bid != g_shmClient._lastBid; ++i ) {
+        ring.write(record);
+        tw::common_thread::sleep(1);
+    }
+
+    return (bid == g_shmClient._lastBid);
+}
+
+TEST(ChannelPfLibTestSuit, channelPfShm)
+{
+    const std::string name = "/tw_channel_pf_shm_test_" + boost::lexical_cast<std::string>(::getpid());
+
+    TInstrumentPtr instrument = InstrHelper::getNQH2();
+    TInstrumentPtr instrumentNotSubscribed = InstrHelper::getNQU2();
+    ASSERT_TRUE(instrument->isValid());
+    ASSERT_TRUE(instrumentNotSubscribed->isValid());
+
+    ShmTestSubscriber subscriber;
+    ASSERT_TRUE(tw::price::QuoteStore::instance().subscribe(instrument, &subscriber));
+    tw::price::QuoteStore::instance().getQuote(instrumentNotSubscribed);
+
+    tw::common_strat::ConsumerProxy::instance().registerCallbackQuote(&g_shmClient);
+    g_shmClient.clear();
+    g_shmClient._instrumentId = instrument->_keyId;
+
+    tw::common::Settings settings;
+    TChannelPfShm channel;
+
+    // Ring's name is required
+    //
+    ASSERT_FALSE(channel.init(settings));
+
+    // Publisher isn't up yet - channel keeps trying to attach
+    //
+    settings._channel_pf_shm_name = name;
+    ASSERT_TRUE(channel.init(settings));
+    ASSERT_TRUE(channel.subscribe(instrument));
+    ASSERT_TRUE(channel.start());
+
+    TQuoteShmRing ring;
+    ASSERT_TRUE(ring.create(name, 16));
+    ASSERT_TRUE(publishUntilReceived(ring, 9241, instrument));
+
+    // Quotes of instruments without subscribers are skipped
+    //
+    ring.write(getQuoteShm(instrumentNotSubscribed, 9300, 1));
+    ring.write(getQuoteShm(instrument, 9242, 7));
+    ASSERT_TRUE(waitForBid(9242));
+    ASSERT_EQ(g_shmClient._countOthers, 0U);
+    ASSERT_EQ(g_shmClient._quote._book[0]._bid._size.get(), 7);
+    ASSERT_TRUE(g_shmClient._quote._timestamp1.isValid());
+
+    // Publisher restarted with different capacity - channel re-attaches to
+    // the new ring
+    //
+    ring.close();
+    ASSERT_TRUE(ring.create(name, 4));
+    ASSERT_EQ(ring.capacity(), 4UL);
+    ASSERT_TRUE(publishUntilReceived(ring, 9243, instrument));
+
+    channel.stop();
+    ASSERT_TRUE(tw::price::QuoteStore::instance().unsubscribe(instrument, &subscriber));
+    tw::common_strat::ConsumerProxy::instance().clear();
+    ASSERT_TRUE(TQuoteShmRing::remove(name));
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <tw/channel_pf_cme/mdp3_defs.h>
+
+#include <string>
+#include <vector>
+
+namespace tw {
+namespace channel_pf_cme {
+namespace mdp3 {
+
+// Encoder of MDP3 packets - builds packets of templates decoded by
+// Mdp3Channel for unit tests and benchmarks
+//
+class Encoder {
+public:
+    Encoder() : _messageOffset(0) {
+    }
+
+    const std::string& get() const {
+        return _packet;
+    }
+
+    void beginPacket(uint32_t seqNum, uint64_t sendingTime) {
+        _packet.clear();
+        append(seqNum);
+        append(sendingTime);
+    }
+
+    void addBook(uint64_t transactTime, const std::vector<Entry>& entries, uint8_t matchEventIndicator = END_OF_EVENT) {
+        beginMessage(kIncrementalRefreshBook, IncrementalRefreshLayout::ROOT_SIZE);
+        append(transactTime);
+        append(matchEventIndicator);
+        append(static_cast<uint16_t>(0));
+
+        beginGroup(BookEntryLayout::SIZE, entries.size());
+        for ( size_t i = 0; i < entries.size(); ++i ) {
+            const Entry& e = entries[i];
+            size_t offset = _packet.size();
+            _packet.append(BookEntryLayout::SIZE, '\0');
+
+            char* data = &_packet[offset];
+            put(data+BookEntryLayout::PRICE, e._price);
+            put(data+BookEntryLayout::QTY, e._qty);
+            put(data+BookEntryLayout::SECURITY_ID, e._securityId);
+            put(data+BookEntryLayout::RPT_SEQ, e._rptSeq);
+            put(data+BookEntryLayout::NUM_ORDERS, e._numOrders);
+            put(data+BookEntryLayout::PRICE_LEVEL, e._level);
+            put(data+BookEntryLayout::UPDATE_ACTION, e._action);
+            put(data+BookEntryLayout::ENTRY_TYPE, e._type);
+        }
+
+        // Empty NoOrderIDEntries group (groupSize8Byte)
+        //
+        append(static_cast<uint16_t>(24));
+        _packet.append(5, '\0');
+        append(static_cast<uint8_t>(0));
+
+        finishMessage();
+    }
+
+    void addTrades(uint64_t transactTime, const std::vector<Entry>& entries, uint8_t matchEventIndicator = END_OF_EVENT) {
+        beginMessage(kIncrementalRefreshTradeSummary, IncrementalRefreshLayout::ROOT_SIZE);
+        append(transactTime);
+        append(matchEventIndicator);
+        append(static_cast<uint16_t>(0));
+
+        beginGroup(TradeEntryLayout::SIZE, entries.size());
+        for ( size_t i = 0; i < entries.size(); ++i ) {
+            const Entry& e = entries[i];
+            size_t offset = _packet.size();
+            _packet.append(TradeEntryLayout::SIZE, '\0');
+
+            char* data = &_packet[offset];
+            put(data+TradeEntryLayout::PRICE, e._price);
+            put(data+TradeEntryLayout::QTY, e._qty);
+            put(data+TradeEntryLayout::SECURITY_ID, e._securityId);
+            put(data+TradeEntryLayout::RPT_SEQ, e._rptSeq);
+            put(data+TradeEntryLayout::NUM_ORDERS, e._numOrders);
+            put(data+TradeEntryLayout::AGGRESSOR_SIDE, e._aggressorSide);
+            put(data+TradeEntryLayout::UPDATE_ACTION, e._action);
+        }
+
+        append(static_cast<uint16_t>(16));
+        _packet.append(5, '\0');
+        append(static_cast<uint8_t>(0));
+
+        finishMessage();
+    }
+
+    void addSnapshot(uint32_t lastMsgSeqNumProcessed,
+                     uint32_t totNumReports,
+                     int32_t securityId,
+                     uint32_t rptSeq,
+                     uint64_t transactTime,
+                     const std::vector<Entry>& entries) {
+        beginMessage(kSnapshotFullRefresh, SnapshotLayout::ROOT_SIZE);
+        size_t offset = _packet.size();
+        _packet.append(SnapshotLayout::ROOT_SIZE, '\0');
+
+        char* data = &_packet[offset];
+        put(data+SnapshotLayout::LAST_MSG_SEQ_NUM_PROCESSED, lastMsgSeqNumProcessed);
+        put(data+SnapshotLayout::TOT_NUM_REPORTS, totNumReports);
+        put(data+SnapshotLayout::SECURITY_ID, securityId);
+        put(data+SnapshotLayout::RPT_SEQ, rptSeq);
+        put(data+SnapshotLayout::TRANSACT_TIME, transactTime);
+
+        beginGroup(SnapshotEntryLayout::SIZE, entries.size());
+        for ( size_t i = 0; i < entries.size(); ++i ) {
+            const Entry& e = entries[i];
+            offset = _packet.size();
+            _packet.append(SnapshotEntryLayout::SIZE, '\0');
+
+            data = &_packet[offset];
+            put(data+SnapshotEntryLayout::PRICE, e._price);
+            put(data+SnapshotEntryLayout::QTY, e._qty);
+            put(data+SnapshotEntryLayout::NUM_ORDERS, e._numOrders);
+            put(data+SnapshotEntryLayout::PRICE_LEVEL, e._level);
+            put(data+SnapshotEntryLayout::ENTRY_TYPE, e._type);
+        }
+
+        finishMessage();
+    }
+
+    void addChannelReset(uint64_t transactTime) {
+        beginMessage(kChannelReset, ChannelResetLayout::ROOT_SIZE);
+        append(transactTime);
+        append(END_OF_EVENT);
+
+        beginGroup(ChannelResetLayout::ENTRY_SIZE, 1);
+        append(static_cast<int16_t>(0));
+
+        finishMessage();
+    }
+
+    void addSecurityStatus(uint64_t transactTime, int32_t securityId, uint8_t status) {
+        beginMessage(kSecurityStatus, SecurityStatusLayout::ROOT_SIZE);
+        size_t offset = _packet.size();
+        _packet.append(SecurityStatusLayout::ROOT_SIZE, '\0');
+
+        char* data = &_packet[offset];
+        put(data+SecurityStatusLayout::TRANSACT_TIME, transactTime);
+        put(data+SecurityStatusLayout::SECURITY_ID, securityId);
+        put(data+SecurityStatusLayout::MATCH_EVENT_INDICATOR, END_OF_EVENT);
+        put(data+SecurityStatusLayout::SECURITY_TRADING_STATUS, status);
+
+        finishMessage();
+    }
+
+private:
+    template <typename TValue>
+    void append(TValue value) {
+        _packet.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void beginMessage(uint16_t templateId, uint16_t blockLength) {
+        _messageOffset = _packet.size();
+        append(static_cast<uint16_t>(0));
+        append(blockLength);
+        append(templateId);
+        append(SCHEMA_ID);
+        append(SCHEMA_VERSION);
+    }
+
+    void beginGroup(uint16_t blockLength, size_t numInGroup) {
+        append(blockLength);
+        append(static_cast<uint8_t>(numInGroup));
+    }
+
+    void finishMessage() {
+        put(&_packet[_messageOffset], static_cast<uint16_t>(_packet.size()-_messageOffset));
+    }
+
+private:
+    std::string _packet;
+    size_t _messageOffset;
+};
+
+} // namespace mdp3
+} // namespace channel_pf_cme
+} // namespace tw
@@ -0,0 +1,363 @@
+#include <tw/channel_pf_cme/mdp3_channel.h>
+#include <tw/channel_pf_cme/mdp3_replay.h>
+#include <tw/common_comm/pcap.h>
+#include <tw/common_strat/consumer_proxy.h>
+
+#include <mains/unit_test_price_lib/instr_helper.h>
+#include "mdp3_encoder.h"
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdio.h>
+
+typedef tw::channel_pf_cme::Mdp3Channel TChannel;
+typedef tw::channel_pf_cme::mdp3::Entry TEntry;
+typedef tw::channel_pf_cme::mdp3::Encoder TEncoder;
+typedef std::vector<TEntry> TEntries;
+
+class Mdp3TestClient {
+public:
+    Mdp3TestClient() {
+        clear();
+    }
+
+    void clear() {
+        _count = 0;
+        _statuses.clear();
+        _quote.clear();
+    }
+
+    void onQuote(const tw::price::QuoteStore::TQuote& quote) {
+        ++_count;
+        _statuses.push_back(quote._status);
+        _quote = quote;
+    }
+
+    uint32_t _count;
+    std::vector<tw::price::Quote::eStatus> _statuses;
+    tw::price::Quote _quote;
+};
+
+static Mdp3TestClient g_client;
+
+static int64_t getPx(double price) {
+    return static_cast<int64_t>(::llround(price * 1000000000.0));
+}
+
+static TEntry getBookEntry(int32_t securityId, uint32_t rptSeq, char type, uint8_t action, uint8_t level, double price, int32_t qty, int32_t numOrders = 1) {
+    TEntry e;
+    e._kind = TEntry::kKindBook;
+    e._securityId = securityId;
+    e._rptSeq = rptSeq;
+    e._type = type;
+    e._action = action;
+    e._level = level;
+    e._price = getPx(price);
+    e._qty = qty;
+    e._numOrders = numOrders;
+    return e;
+}
+
+static TEntry getTradeEntry(int32_t securityId, uint32_t rptSeq, double price, int32_t qty, uint8_t aggressorSide) {
+    TEntry e;
+    e._kind = TEntry::kKindTrade;
+    e._securityId = securityId;
+    e._rptSeq = rptSeq;
+    e._action = tw::channel_pf_cme::mdp3::kNew;
+    e._price = getPx(price);
+    e._qty = qty;
+    e._numOrders = 2;
+    e._aggressorSide = aggressorSide;
+    return e;
+}
+
+static TEntry getSnapshotEntry(char type, uint8_t level, double price, int32_t qty) {
+    TEntry e;
+    e._type = type;
+    e._level = level;
+    e._price = getPx(price);
+    e._qty = qty;
+    e._numOrders = 1;
+    return e;
+}
+
+static bool checkLevel(const tw::price::Quote& quote, size_t level, int32_t bid, int32_t bidSize, int32_t ask, int32_t askSize) {
+    EXPECT_EQ(quote._book[level]._bid._price.get(), bid);
+    EXPECT_EQ(quote._book[level]._bid._size.get(), bidSize);
+    EXPECT_EQ(quote._book[level]._ask._price.get(), ask);
+    EXPECT_EQ(quote._book[level]._ask._size.get(), askSize);
+
+    return (quote._book[level]._bid._price.get() == bid &&
+            quote._book[level]._bid._size.get() == bidSize &&
+            quote._book[level]._ask._price.get() == ask &&
+            quote._book[level]._ask._size.get() == askSize);
+}
+
+// Builds the same sequence of packets for both direct and pcap replay tests:
+//      - book build up, duplicate packet, trade, packet/RptSeq gap, snapshot
+//
+static void getPackets(int32_t securityId, std::vector<std::string>& incrementals, std::vector<std::string>& snapshots) {
+    using namespace tw::channel_pf_cme::mdp3;
+
+    TEncoder encoder;
+    TEntries entries;
+
+    // Seq 1: 2310.25 x 2310.50
+    //
+    encoder.beginPacket(1, 1000);
+    entries.push_back(getBookEntry(securityId, 1, kBid, kNew, 1, 2310.25, 5));
+    entries.push_back(getBookEntry(securityId, 2, kOffer, kNew, 1, 2310.50, 7));
+    encoder.addBook(1000, entries);
+    incrementals.push_back(encoder.get());
+
+    // Seq 2: new 2nd bid level, delete top bid
+    //
+    encoder.beginPacket(2, 2000);
+    entries.clear();
+    entries.push_back(getBookEntry(securityId, 3, kBid, kNew, 2, 2310.00, 3));
+    entries.push_back(getBookEntry(securityId, 4, kBid, kDelete, 1, 2310.25, 0));
+    encoder.addBook(2000, entries);
+    incrementals.push_back(encoder.get());
+
+    // Seq 2: duplicate (e.g. from feed B)
+    //
+    incrementals.push_back(encoder.get());
+
+    // Seq 3: trade
+    //
+    encoder.beginPacket(3, 3000);
+    entries.clear();
+    entries.push_back(getTradeEntry(securityId, 5, 2310.50, 2, kAggressorBuy));
+    encoder.addTrades(3000, entries);
+    incrementals.push_back(encoder.get());
+
+    // Seq 5 (packet 4 and RptSeq 6 are lost): change top ask
+    //
+    encoder.beginPacket(5, 5000);
+    entries.clear();
+    entries.push_back(getBookEntry(securityId, 7, kOffer, kChange, 1, 2310.50, 9));
+    encoder.addBook(5000, entries);
+    incrementals.push_back(encoder.get());
+
+    // Snapshot w/ RptSeq 6
+    //
+    encoder.beginPacket(1, 4500);
+    entries.clear();
+    entries.push_back(getSnapshotEntry(kBid, 1, 2310.00, 3));
+    entries.push_back(getSnapshotEntry(kOffer, 1, 2310.50, 5));
+    entries.push_back(getSnapshotEntry(kOffer, 2, 2310.75, 4));
+    encoder.addSnapshot(4, 1, securityId, 6, 4500, entries);
+    snapshots.push_back(encoder.get());
+}
+
+TEST(ChannelPfCmeLibTestSuite, mdp3_book)
+{
+    TInstrumentPtr instrument = InstrHelper::getNQH2();
+    tw::price::QuoteStore::instance().getQuote(instrument);
+    tw::common_strat::ConsumerProxy::instance().registerCallbackQuote(&g_client);
+    g_client.clear();
+
+    int32_t securityId = instrument->_keyNum1;
+
+    std::vector<std::string> incrementals;
+    std::vector<std::string> snapshots;
+    getPackets(securityId, incrementals, snapshots);
+
+    TChannel channel;
+    channel.setChannelId(instrument->_var1);
+    ASSERT_TRUE(channel.subscribe(instrument));
+
+    // Seq 1
+    //
+    ASSERT_TRUE(channel.onIncrementalPacket(incrementals[0].data(), incrementals[0].size()));
+    ASSERT_EQ(g_client._count, 1U);
+    ASSERT_TRUE(g_client._quote.isBookUpdate());
+    ASSERT_TRUE(checkLevel(g_client._quote, 0, 9241, 5, 9242, 7));
+    ASSERT_EQ(channel.getRptSeq(securityId), 2U);
+
+    // Seq 2 - both entries are published as one update
+    //
+    ASSERT_TRUE(channel.onIncrementalPacket(incrementals[1].data(), incrementals[1].size()));
+    ASSERT_EQ(g_client._count, 2U);
+    ASSERT_TRUE(checkLevel(g_client._quote, 0, 9240, 3, 9242, 7));
+    ASSERT_TRUE(!g_client._quote._book[1]._bid._price.isValid());
+    ASSERT_EQ(g_client._quote._book[1]._bid._size.get(), 0);
+
+    // Duplicate
+    //
+    ASSERT_TRUE(channel.onIncrementalPacket(incrementals[2].data(), incrementals[2].size()));
+    ASSERT_EQ(g_client._count, 2U);
+    ASSERT_EQ(channel.getStats()._duplicatePackets, 1U);
+
+    // Trade
+    //
+    ASSERT_TRUE(channel.onIncrementalPacket(incrementals[3].data(), incrementals[3].size()));
+    ASSERT_EQ(g_client._count, 3U);
+    ASSERT_TRUE(g_client._quote.isTrade());
+    ASSERT_EQ(g_client._quote._trade._price.get(), 9242);
+    ASSERT_EQ(g_client._quote._trade._size.get(), 2);
+    ASSERT_EQ(g_client._quote._trade._aggressorSide, tw::price::Trade::kAggressorSideBuy);
+    ASSERT_EQ(channel.getRptSeq(securityId), 5U);
+
+    // Gap
+    //
+    ASSERT_TRUE(channel.onIncrementalPacket(incrementals[4].data(), incrementals[4].size()));
+    ASSERT_EQ(g_client._count, 4U);
+    ASSERT_EQ(g_client._quote._status, tw::price::Quote::kStaleQuote);
+    ASSERT_TRUE(channel.isStale(securityId));
+    ASSERT_EQ(channel.getStats()._gaps, 1U);
+    ASSERT_EQ(channel.getStats()._bookGaps, 1U);
+    ASSERT_EQ(channel.getRptSeq(securityId), 5U);
+
+    // Snapshot recovers book and queued entry is applied on top of it
+    //
+    ASSERT_TRUE(channel.onSnapshotPacket(snapshots[0].data(), snapshots[0].size()));
+    ASSERT_EQ(g_client._count, 6U);
+    ASSERT_EQ(g_client._statuses[4], tw::price::Quote::kDataRecoveryFinish);
+    ASSERT_EQ(g_client._quote._status, tw::price::Quote::kSuccess);
+    ASSERT_TRUE(!channel.isStale(securityId));
+    ASSERT_EQ(channel.getRptSeq(securityId), 7U);
+    ASSERT_EQ(channel.getStats()._snapshotsApplied, 1U);
+    ASSERT_TRUE(checkLevel(g_client._quote, 0, 9240, 3, 9242, 9));
+    ASSERT_TRUE(checkLevel(g_client._quote, 1, tw::price::Ticks().get(), 0, 9243, 4));
+
+    // Snapshot is ignored for up to date books
+    //
+    ASSERT_TRUE(channel.onSnapshotPacket(snapshots[0].data(), snapshots[0].size()));
+    ASSERT_EQ(g_client._count, 6U);
+    ASSERT_EQ(channel.getStats()._snapshotsApplied, 1U);
+
+    // Channel reset clears books
+    //
+    TEncoder encoder;
+    encoder.beginPacket(6, 6000);
+    encoder.addChannelReset(6000);
+    ASSERT_TRUE(channel.onIncrementalPacket(encoder.get().data(), encoder.get().size()));
+    ASSERT_EQ(g_client._count, 7U);
+    ASSERT_EQ(channel.getRptSeq(securityId), 0U);
+    ASSERT_TRUE(!g_client._quote._book[0]._bid._price.isValid());
+    ASSERT_TRUE(!g_client._quote._book[0]._ask._price.isValid());
+
+    // Corrupted packet
+    //
+    std::string corrupted = incrementals[0].substr(0, incrementals[0].size()-5);
+    corrupted[0] = 7;
+    ASSERT_TRUE(!channel.onIncrementalPacket(corrupted.data(), corrupted.size()));
+    ASSERT_EQ(channel.getStats()._decodeErrors, 1U);
+}
+
+TEST(ChannelPfCmeLibTestSuite, mdp3_delete_from_thru)
+{
+    using namespace tw::channel_pf_cme::mdp3;
+
+    TInstrumentPtr instrument = InstrHelper::getNQH2();
+    tw::price::QuoteStore::instance().getQuote(instrument);
+    tw::common_strat::ConsumerProxy::instance().registerCallbackQuote(&g_client);
+    g_client.clear();
+
+    int32_t securityId = instrument->_keyNum1;
+
+    TChannel channel;
+    ASSERT_TRUE(channel.subscribe(instrument));
+
+    TEncoder encoder;
+    TEntries entries;
+
+    encoder.beginPacket(1, 1000);
+    for ( uint8_t i = 1; i <= 3; ++i ) {
+        entries.push_back(getBookEntry(securityId, entries.size()+1, kBid, kNew, i, 2310.25-0.25*(i-1), i));
+        entries.push_back(getBookEntry(securityId, entries.size()+1, kOffer, kNew, i, 2310.50+0.25*(i-1), i));
+    }
+    encoder.addBook(1000, entries);
+    ASSERT_TRUE(channel.onIncrementalPacket(encoder.get().data(), encoder.get().size()));
+    ASSERT_TRUE(checkLevel(g_client._quote, 0, 9241, 1, 9242, 1));
+    ASSERT_TRUE(checkLevel(g_client._quote, 2, 9239, 3, 9244, 3));
+
+    // Delete 2 top bid levels, delete all ask levels
+    //
+    encoder.beginPacket(2, 2000);
+    entries.clear();
+    entries.push_back(getBookEntry(securityId, 7, kBid, kDeleteFrom, 2, 0, 0));
+    entries.push_back(getBookEntry(securityId, 8, kOffer, kDeleteThru, 1, 0, 0));
+    encoder.addBook(2000, entries);
+    ASSERT_TRUE(channel.onIncrementalPacket(encoder.get().data(), encoder.get().size()));
+    ASSERT_EQ(g_client._quote._book[0]._bid._price.get(), 9239);
+    ASSERT_EQ(g_client._quote._book[0]._bid._size.get(), 3);
+    ASSERT_TRUE(!g_client._quote._book[1]._bid._price.isValid());
+    ASSERT_TRUE(!g_client._quote._book[0]._ask._price.isValid());
+    ASSERT_TRUE(!g_client._quote._book[2]._ask._price.isValid());
+}
+
+TEST(ChannelPfCmeLibTestSuite, mdp3_pcap_replay)
+{
+    TInstrumentPtr instrument = InstrHelper::getNQH2();
+    tw::price::QuoteStore::instance().getQuote(instrument);
+    tw::common_strat::ConsumerProxy::instance().registerCallbackQuote(&g_client);
+    g_client.clear();
+
+    int32_t securityId = instrument->_keyNum1;
+
+    std::vector<std::string> incrementals;
+    std::vector<std::string> snapshots;
+    getPackets(securityId, incrementals, snapshots);
+
+    const std::string fileName = "./mdp3_test.pcap";
+    const uint32_t srcIp = tw::common_comm::PcapReader::parseIp("10.0.0.1");
+    const uint32_t incrementalIp = tw::common_comm::PcapReader::parseIp("224.0.31.1");
+    const uint32_t snapshotIp = tw::common_comm::PcapReader::parseIp("224.0.31.22");
+
+    // Write capture: A/B incremental feeds, snapshot after the gap
+    //
+    {
+        tw::common_comm::PcapWriter writer;
+        ASSERT_TRUE(writer.open(fileName));
+
+        uint64_t timestamp = 1400000000000000000ULL;
+        for ( size_t i = 0; i < incrementals.size(); ++i ) {
+            ASSERT_TRUE(writer.writeUdp(++timestamp, srcIp, 5000, incrementalIp, 14310, incrementals[i].data(), incrementals[i].size()));
+            ASSERT_TRUE(writer.writeUdp(++timestamp, srcIp, 5000, incrementalIp, 15310, incrementals[i].data(), incrementals[i].size()));
+        }
+
+        ASSERT_TRUE(writer.writeUdp(++timestamp, srcIp, 5000, incrementalIp, 9999, "ignored", 7));
+        ASSERT_TRUE(writer.writeUdp(++timestamp, srcIp, 5000, snapshotIp, 16310, snapshots[0].data(), snapshots[0].size()));
+    }
+
+    // Read capture back
+    //
+    {
+        tw::common_comm::PcapReader reader;
+        ASSERT_TRUE(reader.open(fileName));
+
+        tw::common_comm::PcapPacket packet;
+        ASSERT_TRUE(reader.next(packet));
+        ASSERT_EQ(packet._timestamp, 1400000000000000001ULL);
+        ASSERT_EQ(packet._srcIp, srcIp);
+        ASSERT_EQ(packet._dstIp, incrementalIp);
+        ASSERT_EQ(packet._dstPort, 14310);
+        ASSERT_EQ(std::string(packet._data, packet._size), incrementals[0]);
+        ASSERT_EQ(tw::common_comm::PcapReader::ipToString(packet._dstIp), "224.0.31.1");
+    }
+
+    TChannel channel;
+    channel.setChannelId(instrument->_var1);
+    ASSERT_TRUE(channel.subscribe(instrument));
+
+    tw::channel_pf_cme::Mdp3Replay replay;
+    ASSERT_TRUE(replay.addFeed("224.0.31.1", 14310, tw::channel_pf_cme::Mdp3Replay::kIncremental, &channel));
+    ASSERT_TRUE(replay.addFeed("224.0.31.1", 15310, tw::channel_pf_cme::Mdp3Replay::kIncremental, &channel));
+    ASSERT_TRUE(replay.addFeed("", 16310, tw::channel_pf_cme::Mdp3Replay::kSnapshot, &channel));
+    ASSERT_TRUE(!replay.addFeed("", 16311, tw::channel_pf_cme::Mdp3Replay::kSnapshot, NULL));
+
+    ASSERT_TRUE(replay.replay(fileName));
+    ASSERT_EQ(replay.getStats()._packets, 2*incrementals.size()+1);
+    ASSERT_EQ(replay.getStats()._unmatchedPackets, 1U);
+    ASSERT_EQ(replay.getStats()._failedPackets, 0U);
+
+    ASSERT_EQ(channel.getStats()._duplicatePackets, incrementals.size()+1);
+    ASSERT_EQ(channel.getStats()._snapshotsApplied, 1U);
+    ASSERT_TRUE(!channel.isStale(securityId));
+    ASSERT_EQ(channel.getRptSeq(securityId), 7U);
+    ASSERT_TRUE(checkLevel(g_client._quote, 0, 9240, 3, 9242, 9));
+
+    ::remove(fileName.c_str());
+}
@@ -0,0 +1,285 @@
+#include <tw/common/column_store.h>
+#include <tw/common/filesystem.h>
+#include <tw/price/defs.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+// Mirrors shape of generated serializable structs
+//
+struct ColumnStoreTestRecord {
+    ColumnStoreTestRecord() : _accountId(0),
+                              _price(0),
+                              _qty(0),
+                              _avgPrice(0.0),
+                              _pickOff(false) {
+    }
+
+    template <typename TVisitor>
+    void visitFields(TVisitor& visitor) const {
+        visitor("accountId", _accountId);
+        visitor("displayName", _displayName);
+        visitor("price", _price);
+        visitor("qty", _qty);
+        visitor("avgPrice", _avgPrice);
+        visitor("pickOff", _pickOff);
+        visitor("timestamp", _timestamp);
+    }
+
+    template <typename TVisitor>
+    void visitFields(TVisitor& visitor) {
+        visitor("accountId", _accountId);
+        visitor("displayName", _displayName);
+        visitor("price", _price);
+        visitor("qty", _qty);
+        visitor("avgPrice", _avgPrice);
+        visitor("pickOff", _pickOff);
+        visitor("timestamp", _timestamp);
+    }
+
+    uint32_t _accountId;
+    std::string _displayName;
+    tw::price::Ticks _price;
+    tw::price::Size _qty;
+    double _avgPrice;
+    bool _pickOff;
+    tw::common::THighResTime _timestamp;
+};
+
+typedef std::vector<ColumnStoreTestRecord> TRecords;
+
+static const int64_t DAY1 = 1390003200LL*1000000LL; // 2014-01-18 00:00:00
+static const int64_t DAY2 = DAY1+tw::common::StoreTime::kMicrosInDay;
+
+static ColumnStoreTestRecord getRecord(uint32_t i, int64_t day) {
+    ColumnStoreTestRecord r;
+    r._accountId = 1000+(i%3);
+    r._displayName = (i%2) ? "ESH4" : "NQH4";
+    r._price.set(180000+i);
+    r._qty.set(i%5+1);
+    r._avgPrice = 1800.25+i*0.25;
+    r._pickOff = (0 == i%7);
+    r._timestamp = tw::common::StoreTime::fromMicros(day+i*1000000LL+i);
+    return r;
+}
+
+static void checkEqual(const ColumnStoreTestRecord& a, const ColumnStoreTestRecord& b) {
+    ASSERT_EQ(a._accountId, b._accountId);
+    ASSERT_EQ(a._displayName, b._displayName);
+    ASSERT_EQ(a._price, b._price);
+    ASSERT_EQ(a._qty, b._qty);
+    ASSERT_EQ(a._avgPrice, b._avgPrice);
+    ASSERT_EQ(a._pickOff, b._pickOff);
+    ASSERT_EQ(tw::common::StoreTime::toMicros(a._timestamp), tw::common::StoreTime::toMicros(b._timestamp));
+}
+
+TEST(CommonLibTestSuit, column_store_time)
+{
+    ASSERT_EQ(tw::common::StoreTime::dayOf(DAY1), "20140118");
+    ASSERT_EQ(tw::common::StoreTime::dayOf(DAY2-1), "20140118");
+    ASSERT_EQ(tw::common::StoreTime::dayOf(DAY2), "20140119");
+    ASSERT_EQ(tw::common::StoreTime::fromSqlTime("2014-01-18"), DAY1);
+    ASSERT_EQ(tw::common::StoreTime::fromSqlTime("2014-01-18 00:00:01.000002"), DAY1+1000002);
+
+    ASSERT_EQ(tw::common::StoreTime::toMicros(tw::common::StoreTime::fromMicros(DAY1+123456)), DAY1+123456);
+    ASSERT_EQ(tw::common::StoreTime::toMicros(tw::common::THighResTime()), tw::common::StoreTime::kNullTime);
+    ASSERT_TRUE(!tw::common::StoreTime::fromMicros(tw::common::StoreTime::kNullTime).isValid());
+}
+
+TEST(CommonLibTestSuit, column_store)
+{
+    const std::string dir = "/tmp/tw_column_store_test_" + boost::lexical_cast<std::string>(::getpid());
+    boost::filesystem::remove_all(dir);
+
+    tw::common::ColumnStore store;
+    ASSERT_FALSE(store.isOpen());
+    ASSERT_TRUE(store.open(dir));
+    ASSERT_TRUE(store.isOpen());
+
+    // Two blocks of day1 and one block spanning both days
+    //
+    TRecords records1;
+    TRecords records2;
+    TRecords records3;
+    for ( uint32_t i = 0; i < 100; ++i ) {
+        records1.push_back(getRecord(i, DAY1));
+        records2.push_back(getRecord(i+100, DAY1));
+    }
+
+    for ( uint32_t i = 0; i < 10; ++i )
+        records3.push_back(getRecord(i, (i%2) ? DAY2 : DAY1+5000*1000000LL));
+
+    ASSERT_TRUE(store.append("Test", "timestamp", records1));
+    ASSERT_TRUE(store.append("Test", "timestamp", records2));
+    ASSERT_TRUE(store.append("Test", "timestamp", records3));
+    ASSERT_TRUE(store.append("Test", "timestamp", TRecords()));
+    ASSERT_FALSE(store.append("Test", "noSuchColumn", records1));
+
+    std::vector<std::string> partitions = store.getPartitions("Test");
+    ASSERT_EQ(partitions.size(), 2UL);
+    ASSERT_EQ(tw::common::Filesystem::TPath(partitions[0]).filename().string(), "20140118.tcs");
+    ASSERT_EQ(tw::common::Filesystem::TPath(partitions[1]).filename().string(), "20140119.tcs");
+    ASSERT_EQ(store.getPartitions("Test", "20140119").size(), 1UL);
+    ASSERT_EQ(store.getPartitions("Test", "", "20140118").size(), 1UL);
+    ASSERT_TRUE(store.getPartitions("NoSuchTable").empty());
+
+    // Everything - in order of days and then of appends
+    //
+    TRecords results;
+    ASSERT_TRUE(store.read("Test", tw::common::StoreFilter(), results));
+    ASSERT_EQ(results.size(), 210UL);
+    for ( uint32_t i = 0; i < 100; ++i ) {
+        checkEqual(results[i], records1[i]);
+        checkEqual(results[i+100], records2[i]);
+    }
+
+    for ( uint32_t i = 0; i < 5; ++i ) {
+        checkEqual(results[200+i], records3[i*2]);
+        checkEqual(results[205+i], records3[i*2+1]);
+    }
+
+    // Time range and equality filters
+    //
+    tw::common::StoreFilter filter;
+    filter.setTimeRange("timestamp", DAY1+10*1000000LL, DAY1+20*1000000LL+20);
+    results.clear();
+    ASSERT_TRUE(store.read("Test", filter, results));
+    ASSERT_EQ(results.size(), 11UL);
+    checkEqual(results[0], records1[10]);
+    checkEqual(results[10], records1[20]);
+
+    filter.addEquals("accountId", 1001).addEquals("displayName", "ESH4");
+    results.clear();
+    ASSERT_TRUE(store.read("Test", filter, results));
+    ASSERT_EQ(results.size(), 2UL);
+    checkEqual(results[0], records1[13]);
+    checkEqual(results[1], records1[19]);
+
+    // Zone maps skip blocks out of time range and blocks without the value
+    //
+    tw::common::StoreFilter filter2;
+    filter2.setTimeRange("timestamp", DAY1+150*1000000LL, DAY2);
+    filter2.addEquals("displayName", "NQH4");
+    tw::common::StoreScanner scanner(store, "Test", filter2);
+    tw::common::TStoreColumns columns;
+    uint32_t rows = 0;
+    while ( scanner.next(columns) )
+        rows += columns[0].size();
+
+    ASSERT_FALSE(scanner.failed());
+    ASSERT_EQ(rows, 25U+5U);
+    ASSERT_EQ(scanner.blocksScanned(), 4UL);
+    ASSERT_EQ(scanner.blocksSkipped(), 2UL);
+
+    tw::common::StoreFilter filter3;
+    filter3.addEquals("accountId", 999);
+    results.clear();
+    ASSERT_TRUE(store.read("Test", filter3, results));
+    ASSERT_TRUE(results.empty());
+
+    // Single column
+    //
+    std::vector<int64_t> accountIds;
+    ASSERT_TRUE(store.readColumn("Test", filter, "accountId", accountIds));
+    ASSERT_EQ(accountIds.size(), 2UL);
+    ASSERT_EQ(accountIds[0], 1001);
+
+    std::vector<std::string> names;
+    ASSERT_TRUE(store.readColumn("Test", tw::common::StoreFilter(), "displayName", names));
+    ASSERT_EQ(names.size(), 210UL);
+
+    std::vector<double> wrongType;
+    ASSERT_FALSE(store.readColumn("Test", tw::common::StoreFilter(), "displayName", wrongType));
+
+    // Partially written block at the end of file is ignored
+    //
+    FILE* file = ::fopen(partitions[1].c_str(), "ab");
+    ASSERT_TRUE(file != NULL);
+    ::fwrite("TWCS\x40\x00", 1, 6, file);
+    ::fclose(file);
+
+    results.clear();
+    ASSERT_TRUE(store.read("Test", tw::common::StoreFilter(), results));
+    ASSERT_EQ(results.size(), 210UL);
+
+    boost::filesystem::remove_all(dir);
+}
+
+TEST(CommonLibTestSuit, column_store_torn_tail)
+{
+    const std::string dir = "/tmp/tw_column_store_test_torn_" + boost::lexical_cast<std::string>(::getpid());
+    boost::filesystem::remove_all(dir);
+
+    TRecords records1;
+    TRecords records2;
+    TRecords records3;
+    for ( uint32_t i = 0; i < 100; ++i ) {
+        records1.push_back(getRecord(i, DAY1));
+        records2.push_back(getRecord(i+100, DAY1));
+        records3.push_back(getRecord(i+200, DAY1));
+    }
+
+    {
+        tw::common::ColumnStore store;
+        ASSERT_TRUE(store.open(dir));
+        ASSERT_TRUE(store.append("Test", "timestamp", records1));
+    }
+
+    // Crash in the middle of append leaves incomplete block behind
+    //
+    std::vector<std::string> partitions;
+    {
+        tw::common::ColumnStore store;
+        ASSERT_TRUE(store.open(dir));
+        partitions = store.getPartitions("Test");
+        ASSERT_EQ(partitions.size(), 1UL);
+    }
+
+    FILE* file = ::fopen(partitions[0].c_str(), "ab");
+    ASSERT_TRUE(file != NULL);
+    ::fwrite("TWCS\x40\x00\x00\x00\x01\x64", 1, 10, file);
+    ::fclose(file);
+
+    // Restarted writer truncates it before its first append, so that
+    // the new block isn't hidden behind the torn one
+    //
+    tw::common::ColumnStore store;
+    ASSERT_TRUE(store.open(dir));
+
+    TRecords results;
+    ASSERT_TRUE(store.read("Test", tw::common::StoreFilter(), results));
+    ASSERT_EQ(results.size(), 100UL);
+
+    ASSERT_TRUE(store.append("Test", "timestamp", records2));
+
+    results.clear();
+    ASSERT_TRUE(store.read("Test", tw::common::StoreFilter(), results));
+    ASSERT_EQ(results.size(), 200UL);
+    checkEqual(results[100], records2[0]);
+    checkEqual(results[199], records2[99]);
+
+    // Scanner reads file up to its length when it was opened - blocks
+    // appended during the scan aren't seen by it
+    //
+    tw::common::StoreScanner scanner(store, "Test", tw::common::StoreFilter());
+    tw::common::TStoreColumns columns;
+    ASSERT_TRUE(scanner.next(columns));
+    ASSERT_EQ(columns[0].size(), 100UL);
+
+    ASSERT_TRUE(store.append("Test", "timestamp", records3));
+
+    ASSERT_TRUE(scanner.next(columns));
+    ASSERT_EQ(columns[0].size(), 100UL);
+    ASSERT_FALSE(scanner.next(columns));
+    ASSERT_FALSE(scanner.failed());
+
+    results.clear();
+    ASSERT_TRUE(store.read("Test", tw::common::StoreFilter(), results));
+    ASSERT_EQ(results.size(), 300UL);
+
+    boost::filesystem::remove_all(dir);
+}
@@ -125,3 +125,111 @@ TEST(CommonLibTestSuit, command_type_subtype_only)
     ASSERT_EQ(c._type, tw::common::eCommandType::kChannelOr);
     ASSERT_EQ(c._subType, tw::common::eCommandSubType::kLogon);
 }
+
+TEST(CommonLibTestSuit, command_binary)
+{   
+    typedef tw::common_comm::BinaryFrame TFrame;
+    
+    tw::common::Command c;
+    tw::common::Command c2;
+    std::string message;
+    std::string temp;
+    
+    message = "ChannelOr,Logon,user=test;passwd=1234;token1=5;token2=6.5";
+    ASSERT_TRUE(c.fromString(message));
+    
+    std::string frame = c.toBinary();
+    ASSERT_TRUE(frame.size() > TFrame::HEADER_SIZE);
+    ASSERT_EQ(TFrame::readLength(frame.data()), frame.size()-TFrame::HEADER_SIZE);
+    
+    ASSERT_TRUE(c2.fromBinary(frame.data()+TFrame::HEADER_SIZE, frame.size()-TFrame::HEADER_SIZE));
+    ASSERT_EQ(c2._type, tw::common::eCommandType::kChannelOr);
+    ASSERT_EQ(c2._subType, tw::common::eCommandSubType::kLogon);
+    ASSERT_EQ(c2._params.size(), 4U);
+    ASSERT_EQ(c2.toString(), c.toString());
+    
+    // Case insensitive compare
+    //
+    ASSERT_TRUE(c2.get("uSeR", temp));
+    ASSERT_EQ(temp, "test");
+    
+    // Values with text delimiters are preserved
+    //
+    c.clear();
+    c._type = tw::common::eCommandType::kProcessorPnL;
+    c._subType = tw::common::eCommandSubType::kList;
+    c.addParams("results", std::string("a=1;b,2\nc=3"));
+    
+    frame.clear();
+    c.toBinary(frame);
+    
+    c2.clear();
+    ASSERT_TRUE(c2.fromBinary(frame.data()+TFrame::HEADER_SIZE, frame.size()-TFrame::HEADER_SIZE));
+    ASSERT_EQ(c2._type, tw::common::eCommandType::kProcessorPnL);
+    ASSERT_EQ(c2._subType, tw::common::eCommandSubType::kList);
+    ASSERT_TRUE(c2.get("results", temp));
+    ASSERT_EQ(temp, "a=1;b,2\nc=3");
+}
+
+TEST(CommonLibTestSuit, command_binary_text_frame)
+{   
+    typedef tw::common_comm::BinaryFrame TFrame;
+    
+    tw::common::Command c;
+    std::string frame;
+    std::string temp;
+    
+    TFrame::encodeText("ChannelOr,Logon,user=test\r\n", frame);
+    ASSERT_EQ(TFrame::readLength(frame.data()), frame.size()-TFrame::HEADER_SIZE);
+    
+    ASSERT_TRUE(c.fromBinary(frame.data()+TFrame::HEADER_SIZE, frame.size()-TFrame::HEADER_SIZE));
+    ASSERT_EQ(c._type, tw::common::eCommandType::kChannelOr);
+    ASSERT_EQ(c._subType, tw::common::eCommandSubType::kLogon);
+    ASSERT_TRUE(c.get("user", temp));
+    ASSERT_EQ(temp, "test");
+}
+
+TEST(CommonLibTestSuit, command_binary_corrupted)
+{   
+    typedef tw::common_comm::BinaryFrame TFrame;
+    
+    tw::common::Command c;
+    tw::common::Command c2;
+    
+    c._type = tw::common::eCommandType::kStrat;
+    c._subType = tw::common::eCommandSubType::kParams;
+    c.addParams("name", "value");
+    
+    std::string frame = c.toBinary();
+    const char* payload = frame.data()+TFrame::HEADER_SIZE;
+    size_t size = frame.size()-TFrame::HEADER_SIZE;
+    
+    // Truncated
+    //
+    for ( size_t i = 0; i < size; ++i ) {
+        c2.clear();
+        ASSERT_FALSE(c2.fromBinary(payload, i));
+    }
+    
+    // Trailing bytes
+    //
+    std::string longer(payload, size);
+    longer.push_back('x');
+    c2.clear();
+    ASSERT_FALSE(c2.fromBinary(longer.data(), longer.size()));
+    
+    // Unknown kind
+    //
+    std::string unknown(payload, size);
+    unknown[0] = 0x7F;
+    c2.clear();
+    ASSERT_FALSE(c2.fromBinary(unknown.data(), unknown.size()));
+    
+    // Unknown type's value
+    //
+    std::string badType(payload, size);
+    badType[1] = 0x7F;
+    c2.clear();
+    ASSERT_TRUE(c2.fromBinary(badType.data(), badType.size()));
+    ASSERT_EQ(c2._type, tw::common::eCommandType::kUnknown);
+}
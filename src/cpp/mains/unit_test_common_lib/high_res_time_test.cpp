@@ -0,0 +1,81 @@
+#include <tw/common/high_res_time.h>
+#include <tw/common/tsc_clock.h>
+
+#include <gtest/gtest.h>
+
+typedef tw::common::THighResTime THighResTime;
+typedef tw::common::TscClock TTscClock;
+
+TEST(CommonLibTestSuit, tsc_clock)
+{
+    int64_t m1 = TTscClock::monotonicNanos();
+    int64_t m2 = TTscClock::monotonicNanos();
+    ASSERT_TRUE(m2 >= m1);
+
+    // Extrapolated realtime stays close to realtime clock
+    //
+    for ( uint32_t i = 0; i < 100; ++i ) {
+        int64_t t1 = TTscClock::clockNanos(CLOCK_REALTIME);
+        int64_t now = TTscClock::nowNanos();
+        int64_t t2 = TTscClock::clockNanos(CLOCK_REALTIME);
+
+        ASSERT_TRUE(now > t1-1000000LL);
+        ASSERT_TRUE(now < t2+1000000LL);
+    }
+}
+
+// Native implementation is only compiled in with HIGH_RES_TIME=native -
+// including it next to Onix's one would define THighResTime twice
+//
+#if defined(TW_HIGH_RES_TIME_NATIVE)
+TEST(CommonLibTestSuit, high_res_time_native)
+{
+    THighResTime t;
+    ASSERT_FALSE(t.isValid());
+    ASSERT_TRUE(t.isBad());
+    ASSERT_EQ(t.toString(), tw::common::INVALID_TIME);
+    ASSERT_EQ(t.getImpl().year(), 1U);
+
+    t = THighResTime::parse("20111222-13:55:21.154378");
+    ASSERT_TRUE(t.isValid());
+    ASSERT_EQ(t.toString(), "20111222-13:55:21.154378");
+    ASSERT_EQ(t.nanos(), 1324562121154378000LL);
+    ASSERT_EQ(t.getImpl().year(), 2011U);
+    ASSERT_EQ(t.getImpl().month(), 12U);
+    ASSERT_EQ(t.getImpl().day(), 22U);
+    ASSERT_EQ(t.hour(), 13U);
+    ASSERT_EQ(t.minute(), 55U);
+    ASSERT_EQ(t.seconds(), 21U);
+    ASSERT_EQ(t.microseconds(), 154378U);
+    ASSERT_EQ(t.getUsecsFromMidnight(), 50121154378ULL);
+
+    // Leap day and formatting of consecutive timestamps within the
+    // same second (cached prefix)
+    //
+    THighResTime t2 = THighResTime::parse("20120229-23:59:59.000001");
+    ASSERT_EQ(t2.toString(), "20120229-23:59:59.000001");
+    ASSERT_EQ(THighResTime::fromNanos(t2.nanos()+999998000LL).toString(), "20120229-23:59:59.999999");
+    ASSERT_EQ(THighResTime::fromNanos(t2.nanos()+999999000LL).toString(), "20120301-00:00:00.000000");
+
+    ASSERT_EQ(THighResTime::parseSqlTime("2012-01-17 14:41:01.548").toString(), "20120117-14:41:01.548000");
+    ASSERT_EQ(THighResTime::parseCMETime("20120117144101548").toString(), "20120117-14:41:01.548000");
+
+    ASSERT_TRUE(t < t2);
+    ASSERT_EQ(t2-t2, 0);
+    ASSERT_EQ(THighResTime::fromNanos(t.nanos()+1500000LL)-t, 1500);
+    ASSERT_EQ(THighResTime::fromNanos(t.nanos()+61000000000LL).deltaSeconds(t), 61);
+
+    tw::common::THighResTimeImpl impl(t.getImpl());
+    impl += THighResTime::fromNanos(2000).getImpl()-THighResTime::fromNanos(1000).getImpl();
+    ASSERT_EQ(THighResTime(impl)-t, 1);
+    impl -= THighResTime::fromNanos(2000).getImpl()-THighResTime::fromNanos(1000).getImpl();
+    ASSERT_TRUE(THighResTime(impl) == t);
+
+    ASSERT_THROW(THighResTime::parse("2011122-13:55:21.154378x"), std::invalid_argument);
+    ASSERT_THROW(THighResTime::parse("20111222 13:55:21.154378"), std::invalid_argument);
+
+    THighResTime now = THighResTime::now();
+    ASSERT_TRUE(now.isValid());
+    ASSERT_EQ(THighResTime::parse(now.toString()).toString(), now.toString());
+}
+#endif
@@ -0,0 +1,182 @@
+#include <tw/common/instrumentation.h>
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+
+typedef tw::common::LatencyHistogram THistogram;
+typedef tw::common::Instrumentation TInstrumentation;
+
+TEST(CommonLibTestSuit, latency_histogram_buckets)
+{
+    // Exact values below SUB_BUCKETS
+    //
+    for ( uint64_t i = 0; i < THistogram::SUB_BUCKETS; ++i ) {
+        ASSERT_EQ(THistogram::bucketIndex(i), i);
+        ASSERT_EQ(THistogram::bucketLowValue(i), i);
+        ASSERT_EQ(THistogram::bucketHighValue(i), i);
+    }
+
+    // Buckets are contiguous and every value falls within its bucket's range
+    //
+    for ( uint32_t i = 0; i < THistogram::BUCKETS-1; ++i ) {
+        ASSERT_EQ(THistogram::bucketHighValue(i)+1, THistogram::bucketLowValue(i+1));
+        ASSERT_EQ(THistogram::bucketIndex(THistogram::bucketLowValue(i)), i);
+        ASSERT_EQ(THistogram::bucketIndex(THistogram::bucketHighValue(i)), i);
+    }
+
+    // Relative precision
+    //
+    uint64_t values[] = { 100, 1000, 12345, 1000000, 123456789 };
+    for ( size_t i = 0; i < sizeof(values)/sizeof(values[0]); ++i ) {
+        uint32_t index = THistogram::bucketIndex(values[i]);
+        ASSERT_TRUE(THistogram::bucketLowValue(index) <= values[i]);
+        ASSERT_TRUE(THistogram::bucketHighValue(index) >= values[i]);
+        ASSERT_TRUE(THistogram::bucketHighValue(index) - THistogram::bucketLowValue(index) <= values[i] / THistogram::SUB_BUCKETS);
+    }
+
+    // Overflow and negative values
+    //
+    ASSERT_EQ(THistogram::bucketIndex(static_cast<uint64_t>(1) << 50), THistogram::BUCKETS-1);
+
+    THistogram h;
+    h.record(-5);
+
+    THistogram::Snapshot s;
+    h.snapshot(s);
+    ASSERT_EQ(s._count, 1U);
+    ASSERT_EQ(s._buckets[0], 1U);
+}
+
+TEST(CommonLibTestSuit, latency_histogram_percentiles)
+{
+    THistogram h;
+    for ( int64_t i = 1; i <= 10000; ++i )
+        h.record(i);
+
+    THistogram::Snapshot s;
+    h.snapshot(s);
+
+    ASSERT_EQ(s._count, 10000U);
+    ASSERT_EQ(s._max, 10000U);
+    ASSERT_EQ(s.mean(), 5000U);
+
+    double probs[] = { 0.01, 0.1, 0.5, 0.9, 0.99, 0.999 };
+    for ( size_t i = 0; i < sizeof(probs)/sizeof(probs[0]); ++i ) {
+        double expected = probs[i] * 10000;
+        double actual = s.percentile(probs[i]);
+        ASSERT_TRUE(actual >= expected) << probs[i] << " :: " << actual;
+        ASSERT_TRUE(actual <= expected * (1.0 + 1.0/THistogram::SUB_BUCKETS)) << probs[i] << " :: " << actual;
+    }
+
+    ASSERT_EQ(s.percentile(1.0), 10000U);
+
+    // Deltas from baseline
+    //
+    THistogram::Snapshot baseline = s;
+    for ( int64_t i = 0; i < 100; ++i )
+        h.record(50);
+
+    h.snapshot(s);
+    s -= baseline;
+    ASSERT_EQ(s._count, 100U);
+    ASSERT_EQ(s._sum, 5000U);
+    ASSERT_EQ(s.percentile(0.5), 50U);
+    ASSERT_EQ(s.percentile(0.999), 50U);
+    ASSERT_EQ(s._max, 50U);
+}
+
+TEST(CommonLibTestSuit, instrumentation)
+{
+    TInstrumentation& instrumentation = TInstrumentation::instance();
+
+    THistogram& stage = instrumentation.registerStage("test.stage");
+    ASSERT_EQ(&stage, &(instrumentation.registerStage("test.stage")));
+
+    // Disabled stages don't record
+    //
+    instrumentation.setEnabled(false);
+    {
+        tw::common::LatencyScope timer(stage);
+    }
+
+    TInstrumentation::TNamedSnapshots snapshots;
+    instrumentation.getSnapshots(snapshots);
+    ASSERT_TRUE(snapshots.empty());
+
+    instrumentation.setEnabled(true);
+    ASSERT_TRUE(stage.isEnabled());
+    ASSERT_TRUE(instrumentation.getStage(TInstrumentation::kAck).isEnabled());
+
+    {
+        tw::common::LatencyScope timer(stage);
+    }
+    {
+        tw::common::LatencyScope timer(static_cast<THistogram*>(NULL));
+    }
+    instrumentation.getStage(TInstrumentation::kFixSend).record(1500);
+    instrumentation.getStage(TInstrumentation::kFixSend).record(2500);
+
+    instrumentation.getSnapshots(snapshots);
+    ASSERT_EQ(snapshots.size(), 2U);
+    ASSERT_EQ(snapshots[0].first, "fix_send");
+    ASSERT_EQ(snapshots[0].second._count, 2U);
+    ASSERT_EQ(snapshots[1].first, "test.stage");
+    ASSERT_EQ(snapshots[1].second._count, 1U);
+
+    // Msg bus command
+    //
+    tw::common::Command cmnd;
+    cmnd._type = tw::common::eCommandType::kInstrumentation;
+    cmnd._subType = tw::common::eCommandSubType::kStatus;
+    cmnd.addParams("stage", "fix_send");
+
+    ASSERT_TRUE(instrumentation.processCommand(cmnd));
+
+    uint64_t value = 0;
+    ASSERT_TRUE(cmnd.get("fix_send.count", value));
+    ASSERT_EQ(value, 2U);
+    ASSERT_TRUE(cmnd.get("fix_send.max", value));
+    ASSERT_EQ(value, 2500U);
+    ASSERT_TRUE(!cmnd.has("test.stage.count"));
+
+    // Binary dump
+    //
+    std::string fileName = "./instrumentation_test.bin";
+    ASSERT_TRUE(instrumentation.dump(fileName));
+
+    TInstrumentation::TNamedSnapshots loaded;
+    ASSERT_TRUE(TInstrumentation::readDump(fileName, loaded));
+    ASSERT_EQ(loaded.size(), snapshots.size());
+    for ( size_t i = 0; i < loaded.size(); ++i ) {
+        ASSERT_EQ(loaded[i].first, snapshots[i].first);
+        ASSERT_EQ(loaded[i].second._count, snapshots[i].second._count);
+        ASSERT_EQ(loaded[i].second._max, snapshots[i].second._max);
+        ASSERT_TRUE(loaded[i].second._buckets == snapshots[i].second._buckets);
+    }
+    ::remove(fileName.c_str());
+
+    // Reset starts new interval
+    //
+    cmnd.clear();
+    cmnd._type = tw::common::eCommandType::kInstrumentation;
+    cmnd._subType = tw::common::eCommandSubType::kStatus;
+    cmnd.addParams("reset", "true");
+    ASSERT_TRUE(instrumentation.processCommand(cmnd));
+    ASSERT_TRUE(cmnd.has("fix_send.count"));
+
+    instrumentation.getSnapshots(snapshots);
+    ASSERT_TRUE(snapshots.empty());
+
+    instrumentation.getStage(TInstrumentation::kFixSend).record(700);
+    instrumentation.getSnapshots(snapshots);
+    ASSERT_EQ(snapshots.size(), 1U);
+    ASSERT_EQ(snapshots[0].second._count, 1U);
+    
+    // Max within interval is estimated from bucket
+    //
+    ASSERT_TRUE(snapshots[0].second.percentile(0.5) >= 700U);
+    ASSERT_TRUE(snapshots[0].second.percentile(0.5) <= 700U + 700U/THistogram::SUB_BUCKETS);
+
+    instrumentation.setEnabled(false);
+}
@@ -0,0 +1,121 @@
+#include <tw/common_thread/ring_buffer.h>
+
+#include <boost/bind.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+typedef tw::common_thread::RingBuffer<uint32_t> TRing;
+
+typedef tw::common_thread::Thread TThread;
+typedef tw::common_thread::ThreadPtr TThreadPtr;
+
+TEST(CommonLibTestSuit, ring_buffer)
+{
+    TRing ring;
+    uint64_t pos = 0;
+
+    // Capacity is rounded up to power of 2
+    //
+    ring.init(3);
+    ASSERT_EQ(ring.capacity(), 4UL);
+    ASSERT_TRUE(ring.empty());
+    ASSERT_TRUE(ring.front() == NULL);
+
+    // Fill the ring
+    //
+    for ( uint32_t i = 0; i < 4; ++i ) {
+        uint32_t* slot = ring.claim(pos);
+        ASSERT_TRUE(slot != NULL);
+        ASSERT_EQ(pos, i);
+        *slot = i;
+        ring.publish(pos);
+    }
+
+    ASSERT_EQ(ring.size(), 4UL);
+    ASSERT_TRUE(ring.claim(pos) == NULL);
+
+    // Claimed, but not published slot isn't visible to consumer
+    //
+    ASSERT_EQ(*ring.front(), 0U);
+    ring.pop();
+
+    uint32_t* slot = ring.claim(pos);
+    ASSERT_TRUE(slot != NULL);
+    *slot = 4;
+
+    for ( uint32_t i = 1; i < 4; ++i ) {
+        ASSERT_EQ(*ring.front(), i);
+        ring.pop();
+    }
+
+    ASSERT_TRUE(ring.front() == NULL);
+
+    ring.publish(pos);
+    ASSERT_EQ(*ring.front(), 4U);
+    ring.pop();
+
+    ASSERT_TRUE(ring.empty());
+}
+
+class RingBufferTester {
+public:
+    RingBufferTester(TRing& ring, uint32_t count) : _ring(ring),
+                                                    _count(count) {
+    }
+
+    void write() {
+        for ( uint32_t i = 0; i < _count; ++i ) {
+            uint64_t pos = 0;
+            uint32_t* slot = NULL;
+            while ( NULL == (slot = _ring.claim(pos)) )
+                tw::common_thread::cpuRelax();
+
+            *slot = i;
+            _ring.publish(pos);
+        }
+    }
+
+    TRing& _ring;
+    uint32_t _count;
+};
+
+TEST(CommonLibTestSuit, ring_buffer_multiple_producers)
+{
+    const uint32_t producers = 4;
+    const uint32_t count = 10000;
+
+    TRing ring;
+    ring.init(1024);
+
+    RingBufferTester t(ring, count);
+    std::vector<TThreadPtr> threads;
+    for ( uint32_t i = 0; i < producers; ++i )
+        threads.push_back(TThreadPtr(new TThread(boost::bind(&RingBufferTester::write, &t))));
+
+    // Every producer's value is read exactly once
+    //
+    std::vector<uint32_t> counts(count, 0);
+    uint32_t total = 0;
+    while ( total < producers*count ) {
+        uint32_t* slot = ring.front();
+        if ( NULL == slot ) {
+            tw::common_thread::cpuRelax();
+            continue;
+        }
+
+        ASSERT_TRUE(*slot < count);
+        ++counts[*slot];
+        ring.pop();
+        ++total;
+    }
+
+    for ( uint32_t i = 0; i < producers; ++i )
+        threads[i]->join();
+
+    for ( uint32_t i = 0; i < count; ++i )
+        ASSERT_EQ(counts[i], producers);
+
+    ASSERT_TRUE(ring.empty());
+}
@@ -0,0 +1,151 @@
+#include <tw/common_thread/shm_ring.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+struct ShmRingTestValue {
+    uint64_t _id;
+    char _data[48];
+};
+
+typedef tw::common_thread::ShmRing<ShmRingTestValue> TShmRing;
+
+TEST(CommonLibTestSuit, shm_ring)
+{
+    const std::string name = "/tw_shm_ring_test_" + boost::lexical_cast<std::string>(::getpid());
+
+    TShmRing writer;
+    TShmRing reader1;
+    TShmRing reader2;
+    ShmRingTestValue value;
+    ::memset(&value, 0, sizeof(value));
+
+    // Nothing to attach to yet
+    //
+    ASSERT_FALSE(reader1.attach(name));
+
+    // Capacity is rounded up to power of 2
+    //
+    ASSERT_TRUE(writer.create(name, 3));
+    ASSERT_EQ(writer.capacity(), 4UL);
+
+    // Readers start from writer's current position
+    //
+    value._id = 100;
+    writer.write(value);
+
+    ASSERT_TRUE(reader1.attach(name));
+    ASSERT_TRUE(reader2.attach(name));
+    ASSERT_EQ(reader1.capacity(), 4UL);
+    ASSERT_EQ(reader1.read(value), TShmRing::kEmpty);
+
+    // Every reader gets every record
+    //
+    for ( uint64_t i = 0; i < 3; ++i ) {
+        value._id = i;
+        writer.write(value);
+    }
+
+    ASSERT_EQ(reader1.lag(), 3UL);
+    for ( uint64_t i = 0; i < 3; ++i ) {
+        ASSERT_EQ(reader1.read(value), TShmRing::kSuccess);
+        ASSERT_EQ(value._id, i);
+        ASSERT_EQ(reader2.read(value), TShmRing::kSuccess);
+        ASSERT_EQ(value._id, i);
+    }
+
+    ASSERT_EQ(reader1.read(value), TShmRing::kEmpty);
+    ASSERT_EQ(reader1.lag(), 0UL);
+
+    // Lapped reader skips to writer's position and reports lost records
+    //
+    for ( uint64_t i = 3; i < 9; ++i ) {
+        value._id = i;
+        writer.write(value);
+    }
+
+    ASSERT_EQ(reader1.read(value), TShmRing::kOverrun);
+    ASSERT_EQ(reader1.overruns(), 6UL);
+    ASSERT_EQ(reader1.read(value), TShmRing::kEmpty);
+
+    value._id = 9;
+    writer.write(value);
+    ASSERT_EQ(reader1.read(value), TShmRing::kSuccess);
+    ASSERT_EQ(value._id, 9UL);
+
+    // Reopened writer continues from the same position
+    //
+    writer.close();
+    ASSERT_TRUE(writer.create(name, 4));
+
+    value._id = 10;
+    writer.write(value);
+    ASSERT_EQ(reader1.read(value), TShmRing::kSuccess);
+    ASSERT_EQ(value._id, 10UL);
+
+    // Writer with different geometry replaces the segment - readers
+    // re-attach to the new one
+    //
+    writer.close();
+    ASSERT_TRUE(writer.create(name, 8));
+    writer.write(value);
+    ASSERT_EQ(reader1.read(value), TShmRing::kOverrun);
+    ASSERT_EQ(reader1.capacity(), 8UL);
+    ASSERT_EQ(reader1.read(value), TShmRing::kEmpty);
+
+    ASSERT_TRUE(reader1.attach(name));
+    ASSERT_EQ(reader1.capacity(), 8UL);
+    ASSERT_EQ(reader1.read(value), TShmRing::kEmpty);
+
+    // Shrunk segment isn't truncated under readers, which still have
+    // the old one mapped
+    //
+    writer.close();
+    ASSERT_TRUE(writer.create(name, 2));
+    ASSERT_EQ(writer.capacity(), 2UL);
+    ASSERT_EQ(reader1.capacity(), 8UL);
+    ASSERT_EQ(reader1.read(value), TShmRing::kOverrun);
+    ASSERT_EQ(reader1.capacity(), 2UL);
+
+    value._id = 11;
+    writer.write(value);
+    ASSERT_EQ(reader1.read(value), TShmRing::kSuccess);
+    ASSERT_EQ(value._id, 11UL);
+
+    ASSERT_TRUE(TShmRing::remove(name));
+}
+
+TEST(CommonLibTestSuit, shm_ring_attach_retries)
+{
+    const std::string name = "/tw_shm_ring_test_retries_" + boost::lexical_cast<std::string>(::getpid());
+
+    TShmRing writer;
+    TShmRing reader;
+    ShmRingTestValue value;
+    ::memset(&value, 0, sizeof(value));
+
+    ASSERT_FALSE(reader.attach(name));
+    ASSERT_EQ(reader.read(value), TShmRing::kEmpty);
+    ASSERT_FALSE(reader.isOpen());
+
+    // Detached reader retries to attach once per ATTACH_RETRY_READS reads
+    //
+    ASSERT_TRUE(writer.create(name, 4));
+    for ( uint32_t i = 1; i < TShmRing::ATTACH_RETRY_READS; ++i ) {
+        ASSERT_EQ(reader.read(value), TShmRing::kEmpty);
+        ASSERT_FALSE(reader.isOpen());
+    }
+
+    ASSERT_EQ(reader.read(value), TShmRing::kEmpty);
+    ASSERT_TRUE(reader.isOpen());
+
+    value._id = 1;
+    writer.write(value);
+    ASSERT_EQ(reader.read(value), TShmRing::kSuccess);
+    ASSERT_EQ(value._id, 1UL);
+
+    ASSERT_TRUE(TShmRing::remove(name));
+}
@@ -0,0 +1,45 @@
+#include <tw/common/string_intern.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gtest/gtest.h>
+
+typedef tw::common::StringIntern TStringIntern;
+
+TEST(CommonLibTestSuit, string_intern)
+{
+    TStringIntern intern;
+    ASSERT_EQ(intern.size(), 0UL);
+    ASSERT_TRUE(TStringIntern::NULL_ID == intern.find("ESZ2"));
+
+    ASSERT_TRUE(intern.add("ESZ2", 0));
+    ASSERT_TRUE(intern.add("NQH2", 1));
+    ASSERT_EQ(intern.size(), 2UL);
+
+    ASSERT_EQ(intern.find("ESZ2"), 0U);
+    ASSERT_EQ(intern.find(std::string("NQH2")), 1U);
+    ASSERT_EQ(intern.find("NQH2xx", 4), 1U);
+    ASSERT_TRUE(TStringIntern::NULL_ID == intern.find("NQH"));
+    ASSERT_TRUE(TStringIntern::NULL_ID == intern.find(""));
+
+    // Already interned keys keep their ids
+    //
+    ASSERT_FALSE(intern.add("ESZ2", 5));
+    ASSERT_EQ(intern.find("ESZ2"), 0U);
+    ASSERT_FALSE(intern.add("ESU2", TStringIntern::NULL_ID));
+
+    // Table grows past initial capacity
+    //
+    for ( uint32_t i = 2; i < 10000; ++i )
+        ASSERT_TRUE(intern.add("I" + boost::lexical_cast<std::string>(i), i));
+
+    ASSERT_EQ(intern.size(), 10000UL);
+    for ( uint32_t i = 2; i < 10000; ++i )
+        ASSERT_EQ(intern.find("I" + boost::lexical_cast<std::string>(i)), i);
+
+    ASSERT_EQ(intern.find("ESZ2"), 0U);
+
+    intern.clear();
+    ASSERT_EQ(intern.size(), 0UL);
+    ASSERT_TRUE(TStringIntern::NULL_ID == intern.find("ESZ2"));
+}
@@ -0,0 +1,188 @@
+#include <tw/common_comm/tcp_ip_reactor.h>
+#include <tw/common_thread/utils.h>
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <fcntl.h>
+
+typedef tw::common_comm::TcpIpReactorSendQueue TSendQueue;
+typedef tw::common_comm::TSharedBuffer TSharedBuffer;
+
+static std::string readAll(int socket) {
+    std::string result;
+    char buffer[1024];
+
+    ssize_t bytes = 0;
+    while ( (bytes = ::recv(socket, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0 )
+        result.append(buffer, bytes);
+
+    return result;
+}
+
+static void setNonBlocking(int socket) {
+    ::fcntl(socket, F_SETFL, ::fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+}
+
+TEST(CommonLibTestSuit, tcp_ip_reactor_send_queue)
+{
+    int sockets[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    setNonBlocking(sockets[0]);
+
+    TSendQueue queue;
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(queue.bytes(), 0U);
+
+    // Same shared buffer queued twice isn't copied
+    //
+    TSharedBuffer m1 = tw::common_comm::makeSharedBuffer("msg1\n");
+    TSharedBuffer m2 = tw::common_comm::makeSharedBuffer("message2\n");
+
+    queue.push(m1);
+    queue.push(m2);
+    queue.push(m1);
+    queue.push(TSharedBuffer());
+    queue.push(tw::common_comm::makeSharedBuffer(""));
+
+    ASSERT_EQ(queue.size(), 3U);
+    ASSERT_EQ(queue.bytes(), 19U);
+    ASSERT_EQ(m1.use_count(), 3);
+
+    ASSERT_EQ(queue.flush(sockets[0]), TSendQueue::kFlushDone);
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(queue.bytes(), 0U);
+    ASSERT_EQ(m1.use_count(), 1);
+
+    ASSERT_EQ(readAll(sockets[1]), "msg1\nmessage2\nmsg1\n");
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
+TEST(CommonLibTestSuit, tcp_ip_reactor_send_queue_partial)
+{
+    int sockets[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    setNonBlocking(sockets[0]);
+
+    int size = 4*1024;
+    ::setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    // Queue more than socket can accept without blocking
+    //
+    TSendQueue queue;
+    std::string expected;
+    for ( size_t i = 0; i < 1000; ++i ) {
+        std::string message = std::string(100, static_cast<char>('a' + i%26)) + "\n";
+        expected += message;
+        queue.push(tw::common_comm::makeSharedBuffer(message));
+    }
+
+    ASSERT_EQ(queue.bytes(), expected.size());
+    ASSERT_EQ(queue.flush(sockets[0]), TSendQueue::kFlushPartial);
+    ASSERT_FALSE(queue.empty());
+    ASSERT_TRUE(queue.bytes() < expected.size());
+
+    // Drain peer and keep flushing - data must arrive intact and in order
+    //
+    std::string received;
+    while ( !queue.empty() ) {
+        received += readAll(sockets[1]);
+        ASSERT_NE(queue.flush(sockets[0]), TSendQueue::kFlushError);
+    }
+    received += readAll(sockets[1]);
+
+    ASSERT_EQ(queue.bytes(), 0U);
+    ASSERT_EQ(received, expected);
+
+    // Peer closed
+    //
+    ::close(sockets[1]);
+    queue.push(tw::common_comm::makeSharedBuffer("msg\n"));
+    ASSERT_EQ(queue.flush(sockets[0]), TSendQueue::kFlushError);
+
+    ::close(sockets[0]);
+}
+
+class TestReactorHandler : public tw::common_comm::TcpIpReactorHandler {
+public:
+    TestReactorHandler(int socket) : _socket(socket),
+                                     _errors(0) {
+    }
+
+public:
+    virtual void onReactorRead() {
+        char buffer[1024];
+        ssize_t bytes = 0;
+        while ( (bytes = ::recv(_socket, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0 )
+            _data.append(buffer, bytes);
+
+        if ( 0 == bytes )
+            onReactorError("Connection closed by peer");
+    }
+
+    virtual void onReactorWrite() {
+        _queue.flush(_socket);
+        if ( _queue.empty() )
+            tw::common_comm::TcpIpReactor::instance().setWriteInterest(_socket, false);
+    }
+
+    virtual void onReactorError(const std::string& reason) {
+        ++_errors;
+        tw::common_comm::TcpIpReactor::instance().remove(_socket);
+    }
+
+public:
+    int _socket;
+    uint32_t _errors;
+    std::string _data;
+    TSendQueue _queue;
+};
+
+TEST(CommonLibTestSuit, tcp_ip_reactor)
+{
+    int sockets[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+    tw::common_comm::TcpIpReactor& reactor = tw::common_comm::TcpIpReactor::instance();
+
+    TestReactorHandler handler(sockets[0]);
+    ASSERT_TRUE(reactor.add(sockets[0], &handler));
+
+    // Inbound
+    //
+    std::string message = "msg1\n";
+    ASSERT_EQ(::send(sockets[1], message.c_str(), message.size(), 0), static_cast<ssize_t>(message.size()));
+
+    for ( uint32_t i = 0; i < 100 && handler._data.empty(); ++i )
+        tw::common_thread::sleep(10);
+
+    ASSERT_EQ(handler._data, message);
+
+    // Outbound
+    //
+    handler._queue.push(tw::common_comm::makeSharedBuffer("msg2\n"));
+    ASSERT_TRUE(reactor.setWriteInterest(sockets[0], true));
+
+    std::string received;
+    for ( uint32_t i = 0; i < 100 && received.empty(); ++i ) {
+        tw::common_thread::sleep(10);
+        received = readAll(sockets[1]);
+    }
+
+    ASSERT_EQ(received, "msg2\n");
+
+    // Peer close
+    //
+    ::close(sockets[1]);
+    for ( uint32_t i = 0; i < 100 && 0 == handler._errors; ++i )
+        tw::common_thread::sleep(10);
+
+    ASSERT_EQ(handler._errors, 1U);
+
+    reactor.remove(sockets[0]);
+    reactor.stop();
+
+    ::close(sockets[0]);
+}
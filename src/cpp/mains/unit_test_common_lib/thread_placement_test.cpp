@@ -0,0 +1,143 @@
+#include <tw/common/thread_placement.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/bind.hpp>
+
+typedef tw::common::ThreadPlacement TThreadPlacement;
+
+TEST(CommonLibTestSuit, thread_placement_parse)
+{
+    std::vector<int32_t> cpus;
+    int32_t policy = 0;
+    int32_t priority = 0;
+
+    // Cpus in taskset format
+    //
+    ASSERT_TRUE(TThreadPlacement::parseCpus("3", cpus));
+    ASSERT_EQ(cpus.size(), 1UL);
+    ASSERT_EQ(cpus[0], 3);
+
+    ASSERT_TRUE(TThreadPlacement::parseCpus("0-2,6", cpus));
+    ASSERT_EQ(cpus.size(), 4UL);
+    ASSERT_EQ(cpus[0], 0);
+    ASSERT_EQ(cpus[2], 2);
+    ASSERT_EQ(cpus[3], 6);
+
+    ASSERT_FALSE(TThreadPlacement::parseCpus("", cpus));
+    ASSERT_FALSE(TThreadPlacement::parseCpus("2-1", cpus));
+    ASSERT_FALSE(TThreadPlacement::parseCpus("a", cpus));
+
+    // Scheduler policies
+    //
+    ASSERT_TRUE(TThreadPlacement::parsePolicy("fifo:80", policy, priority));
+    ASSERT_EQ(policy, SCHED_FIFO);
+    ASSERT_EQ(priority, 80);
+
+    ASSERT_TRUE(TThreadPlacement::parsePolicy("other", policy, priority));
+    ASSERT_EQ(policy, SCHED_OTHER);
+    ASSERT_EQ(priority, 0);
+
+    ASSERT_FALSE(TThreadPlacement::parsePolicy("fifo:1000", policy, priority));
+    ASSERT_FALSE(TThreadPlacement::parsePolicy("realtime", policy, priority));
+
+    // Settings
+    //
+    std::vector<TThreadPlacement::RoleSettings> roles;
+    tw::common::Settings settings;
+
+    ASSERT_TRUE(TThreadPlacement::parse(settings, roles));
+    ASSERT_EQ(roles.size(), static_cast<size_t>(TThreadPlacement::kRolesCount));
+    for ( size_t i = 0; i < roles.size(); ++i )
+        ASSERT_FALSE(roles[i].isSet());
+
+    settings._threads_affinity = "strategy_container=3 logger=0-1";
+    settings._threads_scheduler = "strategy_container=fifo:80";
+    settings._threads_numa_local = "strategy_container quote_store";
+    settings._threads_busy_poll = "quote_store";
+    settings._threads_scheduler += " worker=batch";
+
+    ASSERT_TRUE(TThreadPlacement::parse(settings, roles));
+
+    const TThreadPlacement::RoleSettings& container = roles[TThreadPlacement::kStrategyContainer];
+    ASSERT_EQ(container._cpus.size(), 1UL);
+    ASSERT_EQ(container._cpus[0], 3);
+    ASSERT_TRUE(container._isSchedulerSet);
+    ASSERT_EQ(container._policy, SCHED_FIFO);
+    ASSERT_EQ(container._priority, 80);
+    ASSERT_TRUE(container._numaLocal);
+    ASSERT_FALSE(container._busyPoll);
+
+    ASSERT_EQ(roles[TThreadPlacement::kLogger]._cpus.size(), 2UL);
+    ASSERT_FALSE(roles[TThreadPlacement::kLogger]._isSchedulerSet);
+
+    ASSERT_TRUE(roles[TThreadPlacement::kQuoteStore]._numaLocal);
+    ASSERT_TRUE(roles[TThreadPlacement::kQuoteStore]._busyPoll);
+    ASSERT_TRUE(roles[TThreadPlacement::kQuoteStore]._cpus.empty());
+
+    ASSERT_FALSE(roles[TThreadPlacement::kTimerServer].isSet());
+    ASSERT_TRUE(roles[TThreadPlacement::kWorker]._isSchedulerSet);
+    ASSERT_EQ(roles[TThreadPlacement::kWorker]._policy, SCHED_BATCH);
+    ASSERT_FALSE(roles[TThreadPlacement::kStorage].isSet());
+
+    // Unknown roles/invalid values
+    //
+    settings._threads_busy_poll = "quote_stor";
+    ASSERT_FALSE(TThreadPlacement::parse(settings, roles));
+
+    settings._threads_busy_poll = "";
+    settings._threads_affinity = "strategy_container";
+    ASSERT_FALSE(TThreadPlacement::parse(settings, roles));
+}
+
+static size_t countThreads(TThreadPlacement::eRole role) {
+    std::string report = TThreadPlacement::instance().toString();
+    std::string name = std::string("role=") + TThreadPlacement::toString(role) + ",";
+
+    size_t count = 0;
+    for ( size_t pos = report.find(name); pos != std::string::npos; pos = report.find(name, pos+1) )
+        ++count;
+
+    return count;
+}
+
+static void threadMainSleep() {
+    boost::this_thread::sleep(boost::posix_time::seconds(10));
+}
+
+static void threadMainRegister(bool unregister) {
+    TThreadPlacement::instance().registerCurrentThread(TThreadPlacement::kExchangeSim);
+    TThreadPlacement::instance().registerCurrentThread(TThreadPlacement::kExchangeSim);
+    if ( unregister ) {
+        TThreadPlacement::instance().unregisterCurrentThread();
+        TThreadPlacement::instance().unregisterCurrentThread();
+    }
+}
+
+TEST(CommonLibTestSuit, thread_placement_registry)
+{
+    ASSERT_EQ(countThreads(TThreadPlacement::kExchangeSim), 0UL);
+
+    // Created thread is removed from registry when its main throws
+    // (interrupted)
+    //
+    tw::common_thread::ThreadPtr thread = TThreadPlacement::instance().createThread(TThreadPlacement::kExchangeSim, &threadMainSleep);
+    while ( 0 == countThreads(TThreadPlacement::kExchangeSim) )
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+
+    ASSERT_EQ(countThreads(TThreadPlacement::kExchangeSim), 1UL);
+    thread->interrupt();
+    thread->join();
+    ASSERT_EQ(countThreads(TThreadPlacement::kExchangeSim), 0UL);
+
+    // Registered external threads are removed when they exit or
+    // unregister, registering/unregistering twice is a no-op
+    //
+    tw::common_thread::Thread external1(boost::bind(&threadMainRegister, false));
+    external1.join();
+    ASSERT_EQ(countThreads(TThreadPlacement::kExchangeSim), 0UL);
+
+    tw::common_thread::Thread external2(boost::bind(&threadMainRegister, true));
+    external2.join();
+    ASSERT_EQ(countThreads(TThreadPlacement::kExchangeSim), 0UL);
+}
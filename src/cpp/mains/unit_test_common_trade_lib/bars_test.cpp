@@ -5,6 +5,11 @@
 
 #include <gtest/gtest.h>
 
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <unistd.h>
+#include <algorithm>
 #include <vector>
 
 const double EPSILON = 0.0001;
@@ -22,6 +27,7 @@ public:
     static void clear() {
         _timerClientInfos.clear();
         _barPatterns.clear();
+        _history.clear();
     }
     
 public:    
@@ -50,7 +56,40 @@ public:
         return true;
     }
     
-    static bool readBars(uint32_t x, uint32_t barLength, uint32_t lookbackMinutes, TBars& bars) {
+    // Bars of _history within lookbackMinutes if it's set, otherwise
+    // deterministic historical bars which differ by instrument and bar
+    // length
+    //
+    static bool readBars(uint32_t x, uint32_t barLength, uint32_t lookbackMinutes, uint32_t atrNumOfPeriods, TBars& bars) {
+        if ( !_history.empty() ) {
+            tw::common::THighResTime now = tw::common::THighResTime::now();
+            for ( size_t i = 0; i < _history.size(); ++i ) {
+                if ( (now-_history[i]._open_timestamp) <= static_cast<int64_t>(lookbackMinutes)*60000000LL )
+                    bars.push_back(_history[i]);
+            }
+            
+            return true;
+        }
+        
+        uint32_t count = lookbackMinutes*60/barLength;
+        int32_t price = 1000;
+        for ( uint32_t i = 0; i < count; ++i ) {
+            int32_t step = static_cast<int32_t>((i*7919U + x*104729U + barLength) % 7) - 3;
+            
+            TBar bar;
+            bar._open.set(price);
+            price += step;
+            bar._close.set(price);
+            bar._high.set(std::max(bar._open.get(), bar._close.get()) + static_cast<int32_t>(i%3));
+            bar._low.set(std::min(bar._open.get(), bar._close.get()) - static_cast<int32_t>((i+x)%2));
+            bar._range = bar._high - bar._low;
+            bar._volume.set(10+i%5);
+            bar._numOfTrades = 1+i%4;
+            bar._duration = barLength;
+            bar._formed = true;
+            bars.push_back(bar);
+        }
+        
         return true;
     }
     
@@ -102,6 +141,7 @@ public:
     static TTimerClientInfos _timerClientInfos;
     static uint32_t _msecFromMidnight;
     static TBarPatterns _barPatterns;
+    static TBars _history;
     
 };
 
@@ -109,6 +149,7 @@ public:
 TestRouter::TTimerClientInfos TestRouter::_timerClientInfos;
 uint32_t TestRouter::_msecFromMidnight = 0;
 TestRouter::TBarPatterns TestRouter::_barPatterns;
+TBars TestRouter::_history;
 
 void clearProcessors() {
     // Clear router
@@ -2701,4 +2742,248 @@ TEST(CommonTradeLibTestSuit, bars_impl_test_vol_per_price)
     
     
     
-}
\ No newline at end of file
+}
+
+
+
+void checkEqualBarPatterns(const TBarPatterns& a, const TBarPatterns& b) {
+    ASSERT_EQ(a.size(), b.size());
+    for ( size_t i = 0; i < a.size(); ++i ) {
+        ASSERT_EQ(a[i].toString(), b[i].toString());
+        ASSERT_EQ(a[i]._simpleHitchCount, b[i]._simpleHitchCount);
+        ASSERT_EQ(a[i]._simpleSwingLastBarIndex, b[i]._simpleSwingLastBarIndex);
+        ASSERT_TRUE(a[i]._trendSwingIndexes == b[i]._trendSwingIndexes);
+        ASSERT_TRUE(a[i]._counterTrendSwingIndexes == b[i]._counterTrendSwingIndexes);
+        ASSERT_TRUE(b[i]._instrument);
+        ASSERT_EQ(a[i]._instrument->_keyId, b[i]._instrument->_keyId);
+    }
+}
+
+void checkEqualBarsManagers(const TestRouter::TImpl& a, const TestRouter::TImpl& b, const tw::instr::Instrument::TKeyId& x) {
+    checkEqualBarPatterns(a.getBarPatternsSimple().getBarPatterns(x), b.getBarPatternsSimple().getBarPatterns(x));
+    checkEqualBarPatterns(a.getBarPatternsSwingLevel1().getBarPatterns(x), b.getBarPatternsSwingLevel1().getBarPatterns(x));
+    checkEqualBarPatterns(a.getBarPatternsSwingLevel2().getBarPatterns(x), b.getBarPatternsSwingLevel2().getBarPatterns(x));
+}
+
+TEST(CommonTradeLibTestSuit, bars_impl_test_cache)
+{
+    const std::string dir = "/tmp/tw_bars_cache_test_" + boost::lexical_cast<std::string>(::getpid());
+    boost::filesystem::remove_all(dir);
+    
+    tw::common::Settings settings;
+    settings._bars_manager_bars_restore_mode = tw::common::eBarsRestoreMode::kUnknown;
+    settings._bars_manager_use_cache = true;
+    settings._bars_manager_cache_checkpoint_bars = 3;
+    settings._column_store_dir = dir;
+    
+    clearProcessors();
+    
+    tw::price::QuoteStore::TQuote quoteNQM2;
+    tw::instr::InstrumentPtr instrNQM2 = InstrHelper::getNQM2();
+    quoteNQM2.setInstrument(instrNQM2);
+    
+    // Bars manager which checkpoints bars as they close
+    //
+    TestRouter::TImpl barsManager(60, -1, 4);
+    ASSERT_TRUE(barsManager.subscribe(instrNQM2->_keyId));
+    ASSERT_TRUE(barsManager.start(settings));
+    
+    formBar(TPrice(105), TPrice(101), TPrice(102), TPrice(104), quoteNQM2, barsManager, true);
+    formBar(TPrice(106), TPrice(102), TPrice(103), TPrice(105), quoteNQM2, barsManager, true);
+    formBar(TPrice(105), TPrice(100), TPrice(104), TPrice(101), quoteNQM2, barsManager, true);
+    formBar(TPrice(103), TPrice(99), TPrice(101), TPrice(100), quoteNQM2, barsManager, true);
+    formBar(TPrice(), TPrice(), TPrice(), TPrice(), quoteNQM2, barsManager, true);
+    formBar(TPrice(104), TPrice(100), TPrice(100), TPrice(103), quoteNQM2, barsManager, true);
+    formBar(TPrice(108), TPrice(103), TPrice(103), TPrice(107), quoteNQM2, barsManager, true);
+    formBar(TPrice(107), TPrice(104), TPrice(107), TPrice(105), quoteNQM2, barsManager, true);
+    
+    const TBars& bars = barsManager.getBars(instrNQM2->_keyId);
+    ASSERT_EQ(bars.size(), 9UL);
+    
+    // Restarted bars manager restores bars from cache and patterns from
+    // checkpoint of the 6th bar - only the last 2 bars are reprocessed
+    //
+    TestRouter::TImpl barsManagerRestored(60, -1, 4);
+    ASSERT_TRUE(barsManagerRestored.subscribe(instrNQM2->_keyId));
+    ASSERT_TRUE(barsManagerRestored.start(settings));
+    
+    const TBars& barsRestored = barsManagerRestored.getBars(instrNQM2->_keyId);
+    ASSERT_EQ(barsRestored.size(), bars.size());
+    for ( size_t i = 0; i < bars.size()-1; ++i ) {
+        ASSERT_EQ(barsRestored[i].toString(), bars[i].toString());
+        ASSERT_NEAR(barsRestored[i]._atr, bars[i]._atr, EPSILON);
+        ASSERT_TRUE(barsRestored[i]._formed);
+    }
+    
+    ASSERT_FALSE(barsRestored.back()._formed);
+    ASSERT_EQ(barsRestored.back()._index, bars.size());
+    
+    checkEqualBarsManagers(barsManager, barsManagerRestored, instrNQM2->_keyId);
+    
+    // Both continue the same way
+    //
+    formBar(TPrice(106), TPrice(101), TPrice(105), TPrice(102), quoteNQM2, barsManager);
+    barsManager.onTimeout(TestRouter::_timerClientInfos.back()._timerId);
+    
+    formBar(TPrice(106), TPrice(101), TPrice(105), TPrice(102), quoteNQM2, barsManagerRestored);
+    barsManagerRestored.onTimeout(TestRouter::_timerClientInfos.back()._timerId);
+    
+    ASSERT_EQ(barsRestored.size(), bars.size());
+    checkEqualBarsManagers(barsManager, barsManagerRestored, instrNQM2->_keyId);
+    
+    // Restart without cache starts from scratch
+    //
+    settings._bars_manager_use_cache = false;
+    TestRouter::TImpl barsManagerNotCached(60, -1, 4);
+    ASSERT_TRUE(barsManagerNotCached.subscribe(instrNQM2->_keyId));
+    ASSERT_TRUE(barsManagerNotCached.start(settings));
+    ASSERT_EQ(barsManagerNotCached.getBars(instrNQM2->_keyId).size(), 1UL);
+    ASSERT_TRUE(barsManagerNotCached.getBarPatternsSimple().getBarPatterns(instrNQM2->_keyId).empty());
+    
+    boost::filesystem::remove_all(dir);
+}
+
+TEST(CommonTradeLibTestSuit, bars_impl_test_cache_lookback)
+{
+    const std::string dir = "/tmp/tw_bars_cache_lookback_test_" + boost::lexical_cast<std::string>(::getpid());
+    boost::filesystem::remove_all(dir);
+    
+    tw::common::Settings settings;
+    settings._bars_manager_bars_restore_mode = tw::common::eBarsRestoreMode::kDb;
+    settings._bars_manager_use_cache = true;
+    settings._bars_manager_cache_checkpoint_bars = 0;
+    settings._column_store_dir = dir;
+    
+    clearProcessors();
+    
+    tw::instr::InstrumentPtr instrNQM2 = InstrHelper::getNQM2();
+    const tw::instr::Instrument::TKeyId& x = instrNQM2->_keyId;
+    
+    // 4 hours of minute bars, which open in the middle of minutes, so that
+    // lookback's boundary doesn't depend on test's timing
+    //
+    TBars history;
+    ASSERT_TRUE(TestRouter::readBars(x, 60, 240, 4, history));
+    ASSERT_EQ(history.size(), 240UL);
+    
+    int64_t now = tw::common::StoreTime::toMicros(tw::common::THighResTime::now());
+    for ( size_t i = 0; i < history.size(); ++i ) {
+        history[i]._open_timestamp = tw::common::StoreTime::fromMicros(now - static_cast<int64_t>(history.size()-i)*60000000LL + 30000000LL);
+        history[i]._index = i+1;
+        history[i]._instrument = instrNQM2;
+        history[i]._displayName = instrNQM2->_displayName;
+        history[i]._exchange = instrNQM2->_exchange;
+    }
+    
+    // Previous run cached all of them with checkpoint of the last bar
+    //
+    {
+        tw::common_trade::BarsCache cache;
+        ASSERT_TRUE(cache.open(dir, 60, 2, 4));
+        for ( size_t i = 0; i < history.size(); ++i )
+            cache.add(x, history[i]);
+        
+        cache.addCheckpoint(x, history.size(), TBarPatterns(), TBarPatterns(), TBarPatterns());
+        ASSERT_TRUE(cache.flush());
+    }
+    
+    TestRouter::_history = history;
+    
+    // Not cached restore with lookback of 2 hours
+    //
+    settings._bars_manager_use_cache = false;
+    TestRouter::TImpl barsManagerNotCached(60, 2, 4);
+    ASSERT_TRUE(barsManagerNotCached.subscribe(x, 120));
+    ASSERT_TRUE(barsManagerNotCached.start(settings));
+    
+    const TBars& bars = barsManagerNotCached.getBars(x);
+    ASSERT_EQ(bars.size(), 120UL);
+    ASSERT_FALSE(barsManagerNotCached.getBarPatternsSimple().getBarPatterns(x).empty());
+    
+    // Cached restore gets the same bars and patterns (and a new bar after
+    // formed cached ones) - bars beyond lookback and checkpoint which
+    // refers to them are dropped
+    //
+    settings._bars_manager_use_cache = true;
+    TestRouter::TImpl barsManagerCached(60, 2, 4);
+    ASSERT_TRUE(barsManagerCached.subscribe(x, 120));
+    ASSERT_TRUE(barsManagerCached.start(settings));
+    
+    const TBars& barsCached = barsManagerCached.getBars(x);
+    ASSERT_EQ(barsCached.size(), bars.size()+1);
+    ASSERT_FALSE(barsCached.back()._formed);
+    for ( size_t i = 0; i < bars.size(); ++i ) {
+        ASSERT_EQ(barsCached[i].toString(), bars[i].toString());
+        ASSERT_NEAR(barsCached[i]._atr, bars[i]._atr, EPSILON);
+    }
+    
+    checkEqualBarsManagers(barsManagerNotCached, barsManagerCached, x);
+    
+    // Only trimmed bars are written to the new run - restart with longer
+    // lookback doesn't get bars beyond the previous one
+    //
+    TestRouter::TImpl barsManagerRestarted(60, 2, 4);
+    ASSERT_TRUE(barsManagerRestarted.subscribe(x, 240));
+    ASSERT_TRUE(barsManagerRestarted.start(settings));
+    ASSERT_EQ(barsManagerRestarted.getBars(x).size(), barsCached.size());
+    checkEqualBarsManagers(barsManagerNotCached, barsManagerRestarted, x);
+    
+    TestRouter::_history.clear();
+    boost::filesystem::remove_all(dir);
+}
+
+TEST(CommonTradeLibTestSuit, bars_impl_test_parallel_restore)
+{
+    tw::common::Settings settings;
+    settings._bars_manager_bars_restore_mode = tw::common::eBarsRestoreMode::kDb;
+    settings._bars_manager_use_cache = false;
+    
+    clearProcessors();
+    
+    std::vector<tw::instr::InstrumentPtr> instruments;
+    instruments.push_back(InstrHelper::getNQH2());
+    instruments.push_back(InstrHelper::getNQU2());
+    instruments.push_back(InstrHelper::getNQM2());
+    instruments.push_back(InstrHelper::get6CU2());
+    
+    const uint32_t barLengths[] = { 60, 120, 300 };
+    const size_t barLengthsCount = sizeof(barLengths)/sizeof(barLengths[0]);
+    
+    // Managers restored serially by start() and managers restored by
+    // restorer on worker threads
+    //
+    std::vector<boost::shared_ptr<TestRouter::TImpl> > serial;
+    std::vector<boost::shared_ptr<TestRouter::TImpl> > parallel;
+    tw::common_trade::BarsManagersRestorer<TestRouter::TImpl> restorer;
+    for ( size_t i = 0; i < barLengthsCount; ++i ) {
+        serial.push_back(boost::shared_ptr<TestRouter::TImpl>(new TestRouter::TImpl(barLengths[i], 2, 4)));
+        parallel.push_back(boost::shared_ptr<TestRouter::TImpl>(new TestRouter::TImpl(barLengths[i], 2, 4)));
+        for ( size_t j = 0; j < instruments.size(); ++j ) {
+            ASSERT_TRUE(serial.back()->subscribe(instruments[j]->_keyId, 240));
+            ASSERT_TRUE(parallel.back()->subscribe(instruments[j]->_keyId, 240));
+        }
+        
+        ASSERT_TRUE(serial.back()->start(settings));
+        restorer.add(parallel.back().get());
+    }
+    
+    ASSERT_TRUE(restorer.run(settings, 4));
+    
+    for ( size_t i = 0; i < barLengthsCount; ++i ) {
+        for ( size_t j = 0; j < instruments.size(); ++j ) {
+            const tw::instr::Instrument::TKeyId& x = instruments[j]->_keyId;
+            const TBars& bars = serial[i]->getBars(x);
+            const TBars& barsParallel = parallel[i]->getBars(x);
+            
+            ASSERT_EQ(bars.size(), 240*60/barLengths[i]);
+            ASSERT_EQ(barsParallel.size(), bars.size());
+            for ( size_t k = 0; k < bars.size(); ++k ) {
+                ASSERT_EQ(barsParallel[k].toString(), bars[k].toString());
+                ASSERT_NEAR(barsParallel[k]._atr, bars[k]._atr, EPSILON);
+            }
+            
+            ASSERT_FALSE(serial[i]->getBarPatternsSimple().getBarPatterns(x).empty());
+            checkEqualBarsManagers(*serial[i], *parallel[i], x);
+        }
+    }
+}
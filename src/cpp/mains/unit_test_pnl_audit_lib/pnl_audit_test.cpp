@@ -0,0 +1,146 @@
+#include <tw/common/filesystem.h>
+
+#include "../pnl_audit/SelectorPnLAuditFile.h"
+#include "../pnl_audit/PnLAudit.h"
+#include "../pnl_audit/PnLAuditRunner.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+typedef tw::channel_or::PnLAuditTrailInfo TPnLAuditTrailInfo;
+typedef tw::pnl_audit::ISelectorPnLAudit::TPnLAuditTrailInfos TPnLAuditTrailInfos;
+typedef tw::pnl_audit::SelectorPnLAuditFile TSelectorFile;
+typedef tw::pnl_audit::TSelectorPnLAuditPtr TSelectorPtr;
+
+static const std::string SOURCE_FILE = "pnl_audit_test_source.csv";
+static const std::string DIR_SINGLE = "pnl_audit_test_single";
+static const std::string DIR_WORKERS = "pnl_audit_test_workers";
+
+static TPnLAuditTrailInfo getInfo(uint32_t accountId, uint32_t strategyId, const std::string& parentType, const std::string& timestamp, double unrealized, double realized) {
+    TPnLAuditTrailInfo info;
+    info._accountId = accountId;
+    info._strategyId = strategyId;
+    info._parentType = parentType;
+    info._displayName1 = ("ACCOUNT" == parentType) ? "" : "ESH4";
+    info._unrealizedInDollars = unrealized;
+    info._realizedInDollars = realized;
+    info._eventTimestamp = tw::common::THighResTime::parse(timestamp);
+    return info;
+}
+
+static std::string readFile(const std::string& fileName) {
+    std::ifstream file(fileName.c_str());
+    std::stringstream s;
+    s << file.rdbuf();
+    return s.str();
+}
+
+static std::string getFileName(const std::string& dirName, const tw::common::Settings& settings, const std::string& account) {
+    tw::pnl_audit::PnLAudit pnlAudit;
+    pnlAudit.setDirName(dirName);
+    return pnlAudit.getFileName(settings, account);
+}
+
+TEST(PnLAuditTestSuit, pnl_audit_streaming)
+{
+    tw::common::Settings settings;
+    settings._pnl_audit_mode = tw::common::ePnLAuditMode::kBoth;
+    settings._pnl_audit_start_time = "2014-01-02";
+    settings._pnl_audit_end_time = "2014-01-02 23:59:59";
+    settings._pnl_audit_source_file = SOURCE_FILE;
+    settings._pnl_audit_chunk_size = 2;
+    settings._pnl_audit_threads = 2;
+    
+    std::vector<TPnLAuditTrailInfo> records;
+    records.push_back(getInfo(2, 10, "STRAT", "20140102-09:30:00.000001", 10.0, 0.0));
+    records.push_back(getInfo(1, 1, "STRAT", "20140101-09:30:00.000000", 1.0, 0.0));
+    records.push_back(getInfo(2, 10, "ACCOUNT", "20140102-09:30:00.000001", 10.0, 0.0));
+    records.push_back(getInfo(2, 2, "STRAT", "20140102-09:30:01.000000", 0.0, 25.0));
+    records.push_back(getInfo(2, 10, "STRAT", "20140102-09:30:02.500000", -5.0, 12.5));
+    records.push_back(getInfo(10, 1, "STRAT", "20140102-10:00:00.000000", 1.0, 1.0));
+    records.push_back(getInfo(2, 2, "STRAT", "20140102-09:30:02.500000", 2.0, 20.0));
+    records.push_back(getInfo(2, 10, "STRAT", "20140103-09:30:00.000000", 3.0, 3.0));
+    
+    {
+        std::ofstream file(SOURCE_FILE.c_str(), std::ios_base::out | std::ios_base::trunc);
+        file << "# accountId,strategyId,...\n";
+        for ( size_t i = 0; i < records.size(); ++i )
+            file << records[i].toString() << "\n";
+    }
+    
+    // Accounts are ordered numerically
+    //
+    TSelectorFile selector;
+    ASSERT_TRUE(selector.start(settings));
+    ASSERT_TRUE(selector.populateAccounts(settings));
+    ASSERT_EQ(selector.getAccounts().size(), 3U);
+    ASSERT_EQ(selector.getAccounts()[0], "1");
+    ASSERT_EQ(selector.getAccounts()[1], "2");
+    ASSERT_EQ(selector.getAccounts()[2], "10");
+    
+    // Records are read in chunks in file's order, filtered by account
+    // and time range
+    //
+    TPnLAuditTrailInfos infos;
+    ASSERT_TRUE(selector.openAccount(settings, "2"));
+    ASSERT_TRUE(selector.readChunk(2, infos));
+    ASSERT_EQ(infos.size(), 2U);
+    ASSERT_EQ(infos[0]._strategyId, 10U);
+    ASSERT_EQ(infos[1]._parentType, "ACCOUNT");
+    ASSERT_TRUE(selector.readChunk(2, infos));
+    ASSERT_EQ(infos.size(), 2U);
+    ASSERT_EQ(infos[0]._strategyId, 2U);
+    ASSERT_EQ(infos[1]._eventTimestamp.toString(), "20140102-09:30:02.500000");
+    ASSERT_TRUE(selector.readChunk(2, infos));
+    ASSERT_EQ(infos.size(), 1U);
+    ASSERT_TRUE(selector.readChunk(2, infos));
+    ASSERT_TRUE(infos.empty());
+    
+    ASSERT_TRUE(selector.openAccount(settings, "1"));
+    ASSERT_TRUE(selector.readChunk(2, infos));
+    ASSERT_TRUE(infos.empty());
+    
+    // Whole account in one go
+    //
+    ASSERT_TRUE(tw::common::Filesystem::create_dir(DIR_SINGLE));
+    tw::pnl_audit::PnLAudit pnlAudit;
+    pnlAudit.setDirName(DIR_SINGLE);
+    
+    ASSERT_TRUE(selector.openAccount(settings, "2"));
+    ASSERT_TRUE(selector.readChunk(100, infos));
+    ASSERT_EQ(infos.size(), 5U);
+    ASSERT_TRUE(pnlAudit.process(infos, settings, "2"));
+    
+    std::string expected = "strats,2_10_ESH4,,,,2_2_ESH4,,,,\n"
+                           "timestamp,$UnR PnL,$Real PnL,Total,Drawdown,$UnR PnL,$Real PnL,Total,Drawdown\n"
+                           "20140102-09:30:00.000001,10,0,10,10,0,0,0,0\n"
+                           "20140102-09:30:01.000000,10,0,10,10,0,25,25,0\n"
+                           "20140102-09:30:02.500000,-5,12.5,7.5,-5,2,20,22,-3\n";
+    
+    ASSERT_EQ(readFile(getFileName(DIR_SINGLE, settings, "2")), expected);
+    
+    // Streamed by workers in chunks - same results, no file for account
+    // without records in time range
+    //
+    ASSERT_TRUE(tw::common::Filesystem::create_dir(DIR_WORKERS));
+    tw::pnl_audit::PnLAuditRunner runner;
+    for ( uint32_t i = 0; i < settings._pnl_audit_threads; ++i ) {
+        TSelectorPtr workerSelector(new TSelectorFile());
+        ASSERT_TRUE(workerSelector->start(settings));
+        runner.addSelector(workerSelector);
+    }
+    
+    ASSERT_EQ(runner.run(settings, DIR_WORKERS, selector.getAccounts()), 0U);
+    ASSERT_EQ(readFile(getFileName(DIR_WORKERS, settings, "2")), expected);
+    ASSERT_FALSE(tw::common::Filesystem::exists(getFileName(DIR_WORKERS, settings, "1")));
+    ASSERT_TRUE(tw::common::Filesystem::exists(getFileName(DIR_WORKERS, settings, "10")));
+    
+    tw::common::Filesystem::remove(getFileName(DIR_SINGLE, settings, "2"));
+    tw::common::Filesystem::remove(getFileName(DIR_WORKERS, settings, "2"));
+    tw::common::Filesystem::remove(getFileName(DIR_WORKERS, settings, "10"));
+    tw::common::Filesystem::remove(DIR_SINGLE);
+    tw::common::Filesystem::remove(DIR_WORKERS);
+    tw::common::Filesystem::remove(SOURCE_FILE);
+}
@@ -2,6 +2,8 @@
 
 #include "instr_helper.h"
 
+#include <tw/price/ticks_converter.h>
+
 TEST(PriceLibTestSuit, tickConverter)
 {   
     TInstrumentPtr instrument = InstrHelper::getNQH2();
@@ -220,3 +222,95 @@ TEST(PriceLibTestSuit, tickConverter)
     EXPECT_EQ(tc.nearestTick(fp, -.75), TTicks(5044));   // bid
     EXPECT_EQ(tc.nearestTick(fp, .75), TTicks(5046));    // ask   
 }
+
+TEST(PriceLibTestSuit, ticksRatioNotional)
+{
+    TInstrumentPtr instrument = InstrHelper::getNQH2();
+    ASSERT_TRUE(instrument->isValid());
+    
+    TTickConverter tc(instrument);
+    
+    // Ticks as ratio are converted the same way as ticks for each of
+    // numerator/denominator combos
+    //
+    const uint32_t ratios[][2] = { { 1, 1 }, { 25, 1 }, { 1, 4 }, { 5, 32 }, { 25, 100 } };
+    for ( size_t i = 0; i < sizeof(ratios)/sizeof(ratios[0]); ++i ) {
+        instrument->_tickNumerator = ratios[i][0];
+        instrument->_tickDenominator = ratios[i][1];
+        tc.resetWithNewInstrument(instrument);
+        
+        const tw::price::TicksRatio& ratio = tc.getRatio();
+        for ( int32_t t = -5; t < 5050; t += 7 ) {
+            EXPECT_EQ(ratio.toExchangePrice(t, 1), tc.toExchangePrice(TTicks(t)));
+            EXPECT_NEAR(ratio.toFractionalTicks(tc.toExchangePrice(TTicks(t))), t, 0.0001);
+        }
+    }
+    
+    // Fractional ticks as ratio are converted with a single rounding
+    //
+    tw::price::TicksRatio ratio(1, 4);
+    EXPECT_EQ(ratio.toExchangePrice(10, 4), 0.625);
+    EXPECT_EQ(ratio.toExchangePrice(1, 3), 1.0/12.0);
+    
+    // Notional stays exact however many prices are added
+    //
+    tw::price::TicksNotional notional;
+    EXPECT_EQ(notional.getAvgPrice(ratio), 0.0);
+    
+    for ( uint32_t i = 0; i < 1000000; ++i )
+        notional.add(TTicks(5046+i%3), tw::price::Size(1+i%2));
+    
+    EXPECT_EQ(notional.getSize(), 1500000);
+    EXPECT_EQ(notional.getTicks(), 5046LL*1500000LL + 1499998LL);
+    EXPECT_EQ(notional.getAvgPrice(ratio), ratio.toExchangePrice(notional.getTicks(), notional.getSize()));
+    
+    notional.clear();
+    EXPECT_EQ(notional.getSize(), 0);
+}
+
+template <typename TRatio>
+static void checkTicksRatioConverter(const tw::price::TicksRatio& ratio, uint32_t num, uint32_t denom)
+{
+    tw::price::TicksRatioConverter<TRatio> c(num, denom);
+    for ( int32_t t = 1; t < 5050; t += 7 ) {
+        double p = ratio.toExchangePrice(TTicks(t));
+        EXPECT_EQ(c.toExchangePrice(TTicks(t)), p);
+        EXPECT_EQ(c.fromExchangePrice(p), ratio.fromExchangePrice(p));
+        EXPECT_EQ(c.fromExchangePrice(p), TTicks(t));
+        EXPECT_EQ(c.toFractionalTicks(p), ratio.toFractionalTicks(p));
+        EXPECT_EQ(c.toFractionalExchangePrice(t+0.5), ratio.toFractionalExchangePrice(t+0.5));
+    }
+}
+
+TEST(PriceLibTestSuit, ticksRatio)
+{
+    tw::price::TicksRatio ratio;
+    EXPECT_EQ(ratio.getClass(), tw::price::TicksRatio::kNull);
+    
+    ratio.set(25, 1);
+    EXPECT_EQ(ratio.getClass(), tw::price::TicksRatio::kNum);
+    checkTicksRatioConverter<tw::price::TicksRatioNum>(ratio, 25, 1);
+    
+    ratio.set(1, 64);
+    EXPECT_EQ(ratio.getClass(), tw::price::TicksRatio::kDenom);
+    checkTicksRatioConverter<tw::price::TicksRatioDenom>(ratio, 1, 64);
+    
+    ratio.set(5, 1000);
+    EXPECT_EQ(ratio.getClass(), tw::price::TicksRatio::kFull);
+    checkTicksRatioConverter<tw::price::TicksRatioFull>(ratio, 5, 1000);
+    
+    ratio.set(4, 4);
+    EXPECT_EQ(ratio.getClass(), tw::price::TicksRatio::kNull);
+    checkTicksRatioConverter<tw::price::TicksRatioNull>(ratio, 4, 4);
+    
+    // Function objects held by quotes convert the same way and default to
+    // null converters
+    //
+    ratio.set(1, 4);
+    tw::price::TicksConverter::TConverterFrom from(ratio);
+    tw::price::TicksConverter::TConverterTo to(ratio);
+    EXPECT_EQ(to(TTicks(5046)), 1261.5);
+    EXPECT_EQ(from(1261.5), TTicks(5046));
+    EXPECT_EQ(tw::price::TicksConverter::createTo()(TTicks(5046)), 5046.0);
+    EXPECT_EQ(tw::price::TicksConverter::createFrom()(5046.0), TTicks(5046));
+}
@@ -22,6 +22,7 @@
 #include &lt;tw/log/defs.h&gt;
 #include &lt;tw/functional/delegate.hpp&gt;
 #include &lt;tw/channel_db/channel_db.h&gt;
+#include &lt;tw/channel_db/sql_batch.h&gt;
 
 #include &lt;tw/generated/enums_common.h&gt;
 #include &lt;tw/generated/instrument.h&gt;
@@ -44,6 +45,11 @@ typedef tw::risk::TAccountId TAccountId;
 typedef tw::common::TUuidBuffer TOrderId;
 typedef tw::common::TUuidBuffer TFillId;
 
+// Defined in tw/channel_or/risk_slot.h
+//
+struct RiskSlot;
+typedef RiskSlot* TRiskSlotPtr;
+
 // Enums 
 //
 <xsl:apply-templates select="." mode="enum"/>
@@ -335,6 +341,30 @@ struct <xsl:value-of select="name()"/><xsl:if test="@parent!=''"> : public <xsl:
         return out.str();
     }
     
+    // Calls visitor(name, field) for each serializable field (parent's first)
+    //
+    template &lt;typename TVisitor&gt;
+    void visitFields(TVisitor&amp; visitor) const {
+<xsl:if test="@parent!=''">
+        TParent::visitFields(visitor);
+</xsl:if>
+<xsl:for-each select="*">
+        <xsl:if test="not(@serializable='false')">        visitor("<xsl:value-of select="name()"/>", _<xsl:value-of select="name()"/>);
+</xsl:if>
+</xsl:for-each>
+    }
+
+    template &lt;typename TVisitor&gt;
+    void visitFields(TVisitor&amp; visitor) {
+<xsl:if test="@parent!=''">
+        TParent::visitFields(visitor);
+</xsl:if>
+<xsl:for-each select="*">
+        <xsl:if test="not(@serializable='false')">        visitor("<xsl:value-of select="name()"/>", _<xsl:value-of select="name()"/>);
+</xsl:if>
+</xsl:for-each>
+    }
+    
     std::string toStringVerbose() const {
         std::stringstream out;
 <xsl:if test="@parent!=''">
@@ -519,27 +549,27 @@ struct  <xsl:value-of select="name()"/> {
         </xsl:when>
         <xsl:otherwise>
     uint32_t _count;
-    std::stringstream _sql;
+    tw::channel_db::SqlBatch _batch;
     
-    <xsl:value-of select="name()"/>() {
-        clear();
-    }
-    
-    void clear() {
-        _count = 0;
-        _sql.str("");        
-        <xsl:text>&#10;&#9;_sql &lt;&lt; "</xsl:text>
+    <xsl:value-of select="name()"/>() : _batch(<xsl:text>"</xsl:text>
         <xsl:if test="Type/@value='REPLACE'">
             <xsl:text>REPLACE</xsl:text>
         </xsl:if>
         <xsl:if test="Type/@value='INSERT'">
             <xsl:text>INSERT</xsl:text>
         </xsl:if>
-        <xsl:text> INTO </xsl:text>
+        <xsl:text>", "</xsl:text>
         <xsl:value-of select="Source/@value"/>
-        <xsl:text> (</xsl:text>
+        <xsl:text>", "</xsl:text>
         <xsl:apply-templates select="Params/*" mode="paramFields"/>
-        <xsl:text>) VALUES ";</xsl:text>
+        <xsl:text>"</xsl:text>
+        <xsl:if test="UpdateStatement">, "<xsl:value-of select="UpdateStatement/@value"/>"</xsl:if>) {
+        clear();
+    }
+    
+    void clear() {
+        _count = 0;
+        _batch.clear();
     }
     
     uint32_t count() const {
@@ -547,11 +577,8 @@ struct  <xsl:value-of select="name()"/> {
     }
     
     void add(<xsl:apply-templates select="Params/*" mode="paramList"/>) {
-        if ( ++_count > 1 )
-            _sql &lt;&lt; ",";
-           
-        _sql &lt;&lt; "("<xsl:apply-templates select="Params/*" mode="paramFieldsSet"/>
-             &lt;&lt; ")";
+        ++_count;
+        _batch.beginRow();<xsl:apply-templates select="Params/*" mode="paramFieldsBind"/>
     }
     
     bool execute(tw::channel_db::ChannelDb::TStatementPtr statement)
@@ -560,8 +587,7 @@ struct  <xsl:value-of select="name()"/> {
         try {
             if ( _count == 0 )
                 return false;            
-            <xsl:if test="UpdateStatement">_sql &lt;&lt; "<xsl:value-of select="UpdateStatement/@value"/>";</xsl:if>
-            statement-&gt;execute(_sql.str());
+            _batch.execute(statement);
         } catch(const std::exception&amp; e) {            
             status = false;
             LOGGER_ERRO &lt;&lt; "Exception: "  &lt;&lt; e.what() &lt;&lt; "\n" &lt;&lt; "\n";
@@ -572,7 +598,7 @@ struct  <xsl:value-of select="name()"/> {
         
         if ( !status ) {
             try {
-                LOGGER_ERRO &lt;&lt; "Failed to execute sql: " &lt;&lt; _sql.str() &lt;&lt; "\n" &lt;&lt; "\n";
+                LOGGER_ERRO &lt;&lt; "Failed to execute sql: " &lt;&lt; _batch.toString() &lt;&lt; "\n" &lt;&lt; "\n";
             } catch(...) {
             }
         }
@@ -658,44 +684,38 @@ struct  <xsl:value-of select="name()"/> {
 </xsl:template>
 
 
-<xsl:template match="*" mode="paramFieldsSet">
-    <xsl:call-template name="paramFieldsSet">
+<xsl:template match="*" mode="paramFieldsBind">
+    <xsl:call-template name="paramFieldsBind">
         <xsl:with-param name="item" select="name()" />
         <xsl:with-param name="count" select="position()" />
     </xsl:call-template>
-    <xsl:if test="position() != last()"> &lt;&lt; "," </xsl:if>
 </xsl:template>
 
-<xsl:template name="paramFieldsSet">
+<xsl:template name="paramFieldsBind">
      <xsl:param name="item"/>
      <xsl:param name="count"/>
      
      <xsl:for-each select="/Namespace/OrdersDefs/*">        
         <xsl:if test="$item = name()">
             <xsl:if test="@parent!=''">
-                <xsl:call-template name="paramFieldsSet">
+                <xsl:call-template name="paramFieldsBind">
                     <xsl:with-param name="item" select="@parent" />
                     <xsl:with-param name="count" select="$count" />
                 </xsl:call-template>
-                <xsl:text> &lt;&lt; ","</xsl:text>
             </xsl:if>            
             <xsl:for-each select="*[not(@serializable='false')]">
                 <xsl:choose>
                     <xsl:when test="@type='double' or @type='float'">
-                        <xsl:text>&#10;&#9;&#9;&#9; &lt;&lt; "'" &lt;&lt; std::replace_all(tw::common_str_util::to_string(p</xsl:text>
+                        <xsl:text>&#10;&#9;&#9;_batch.bind(static_cast&lt;double&gt;(p</xsl:text>
                     </xsl:when>
                     <xsl:otherwise>
-                        <xsl:text>&#10;&#9;&#9;&#9; &lt;&lt; "'" &lt;&lt; std::replace_all(boost::lexical_cast&lt;std::string&gt;(p</xsl:text>
+                        <xsl:text>&#10;&#9;&#9;_batch.bind(boost::lexical_cast&lt;std::string&gt;(p</xsl:text>
                     </xsl:otherwise>    
                 </xsl:choose>
                 <xsl:value-of select="$count"/>
                 <xsl:text>._</xsl:text>
                 <xsl:value-of select="name()"/>
-                <xsl:text>)</xsl:text>
-                <xsl:text>, "'", "\\'") &lt;&lt; "'"</xsl:text>
-                <xsl:if test="position() != last()">
-                    <xsl:text> &lt;&lt; ","</xsl:text>
-                </xsl:if>
+                <xsl:text>));</xsl:text>
             </xsl:for-each>
         </xsl:if>
     </xsl:for-each>        
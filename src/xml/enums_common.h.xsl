@@ -93,7 +93,21 @@ struct <xsl:value-of select="name()"/> {
 </xsl:for-each>
         _enum = kUnknown;
     }
-    
+
+    // Converts from numeric (wire) value, e.g. for binary encoded messages
+    //
+    void fromValue(uint32_t value) {
+        switch (value) {
+<xsl:for-each select="*">
+            case k<xsl:value-of select="name()"/>:</xsl:for-each>
+                _enum = static_cast&lt;_ENUM&gt;(value);
+                return;
+            default:
+                _enum = kUnknown;
+                return;
+        }
+    }
+
     friend tw::log::StreamDecorator&amp; operator&lt;&lt;(tw::log::StreamDecorator&amp; os, const <xsl:value-of select="name()"/>&amp; x) {
         return os &lt;&lt; x.toString();
     }
@@ -147,7 +147,7 @@ struct <xsl:value-of select="name()"/> {
 
     void clear() {
 <xsl:for-each select="*">
-       _<xsl:value-of select="name()"/>=<xsl:value-of select="@type"/>(); </xsl:for-each>
+       _<xsl:value-of select="name()"/>=<xsl:choose><xsl:when test="@default"><xsl:value-of select="@default"/></xsl:when><xsl:otherwise><xsl:value-of select="@type"/>()</xsl:otherwise></xsl:choose>; </xsl:for-each>
     }
 
     bool isValid() const {